@@ -0,0 +1,201 @@
+/*
+ * XTS mode glue for the asm optimized version of the AES Cipher Algorithm
+ *
+ * Unlike the generic xts template, which goes through an indirect
+ * cipher call and a table-driven GF(2^128) multiplication per block,
+ * this walks the data with direct calls into the assembler AES core
+ * and computes the tweak sequence with two shifts and a conditional
+ * xor. The main consumer is dm-crypt on aes-xts-plain64 volumes.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ */
+
+#include <linux/module.h>
+#include <linux/crypto.h>
+#include <crypto/aes.h>
+#include <crypto/algapi.h>
+
+#define AES_MAXNR 14
+
+typedef struct {
+	unsigned int rd_key[4 * (AES_MAXNR + 1)];
+	int rounds;
+} AES_KEY;
+
+struct aes_xts_ctx {
+	AES_KEY enc_key;
+	AES_KEY dec_key;
+	AES_KEY tweak_key;
+};
+
+asmlinkage void AES_encrypt(const u8 *in, u8 *out, AES_KEY *ctx);
+asmlinkage void AES_decrypt(const u8 *in, u8 *out, AES_KEY *ctx);
+asmlinkage int private_AES_set_encrypt_key(const unsigned char *userKey,
+					   const int bits, AES_KEY *key);
+asmlinkage int private_AES_set_decrypt_key(const unsigned char *userKey,
+					   const int bits, AES_KEY *key);
+
+struct xts_tweak {
+	__le64 lo, hi;
+};
+
+/* Multiply the tweak by x in GF(2^128), little endian as per IEEE 1619 */
+static void xts_tweak_next(struct xts_tweak *t)
+{
+	u64 lo = le64_to_cpu(t->lo);
+	u64 hi = le64_to_cpu(t->hi);
+	u64 carry = hi >> 63;
+
+	hi = (hi << 1) | (lo >> 63);
+	lo <<= 1;
+	if (carry)
+		lo ^= 0x87;
+
+	t->lo = cpu_to_le64(lo);
+	t->hi = cpu_to_le64(hi);
+}
+
+static int xts_aes_setkey(struct crypto_tfm *tfm, const u8 *in_key,
+			  unsigned int key_len)
+{
+	struct aes_xts_ctx *ctx = crypto_tfm_ctx(tfm);
+	unsigned int bits;
+
+	switch (key_len) {
+	case 2 * AES_KEYSIZE_128:
+		bits = 128;
+		break;
+	case 2 * AES_KEYSIZE_192:
+		bits = 192;
+		break;
+	case 2 * AES_KEYSIZE_256:
+		bits = 256;
+		break;
+	default:
+		tfm->crt_flags |= CRYPTO_TFM_RES_BAD_KEY_LEN;
+		return -EINVAL;
+	}
+
+	if (private_AES_set_encrypt_key(in_key, bits, &ctx->enc_key) == -1) {
+		tfm->crt_flags |= CRYPTO_TFM_RES_BAD_KEY_LEN;
+		return -EINVAL;
+	}
+	/* private_AES_set_decrypt_key expects an encryption key as input */
+	ctx->dec_key = ctx->enc_key;
+	if (private_AES_set_decrypt_key(in_key, bits, &ctx->dec_key) == -1) {
+		tfm->crt_flags |= CRYPTO_TFM_RES_BAD_KEY_LEN;
+		return -EINVAL;
+	}
+	/* the second half of the key encrypts the tweak */
+	if (private_AES_set_encrypt_key(in_key + key_len / 2, bits,
+					&ctx->tweak_key) == -1) {
+		tfm->crt_flags |= CRYPTO_TFM_RES_BAD_KEY_LEN;
+		return -EINVAL;
+	}
+	return 0;
+}
+
+static int xts_aes_crypt(struct blkcipher_desc *desc, struct scatterlist *dst,
+			 struct scatterlist *src, unsigned int nbytes,
+			 void (*crypt)(const u8 *, u8 *, AES_KEY *),
+			 AES_KEY *key)
+{
+	struct aes_xts_ctx *ctx = crypto_blkcipher_ctx(desc->tfm);
+	struct blkcipher_walk walk;
+	struct xts_tweak tweak;
+	u8 buf[AES_BLOCK_SIZE];
+	int err;
+
+	blkcipher_walk_init(&walk, dst, src, nbytes);
+	err = blkcipher_walk_virt(desc, &walk);
+	if (!walk.nbytes)
+		return err;
+
+	/* T_0 = E_K2(IV) */
+	AES_encrypt(walk.iv, (u8 *)&tweak, &ctx->tweak_key);
+
+	while (walk.nbytes) {
+		const u8 *s = walk.src.virt.addr;
+		u8 *d = walk.dst.virt.addr;
+		unsigned int n = walk.nbytes;
+
+		while (n >= AES_BLOCK_SIZE) {
+			memcpy(buf, s, AES_BLOCK_SIZE);
+			crypto_xor(buf, (u8 *)&tweak, AES_BLOCK_SIZE);
+			crypt(buf, buf, key);
+			crypto_xor(buf, (u8 *)&tweak, AES_BLOCK_SIZE);
+			memcpy(d, buf, AES_BLOCK_SIZE);
+
+			xts_tweak_next(&tweak);
+			s += AES_BLOCK_SIZE;
+			d += AES_BLOCK_SIZE;
+			n -= AES_BLOCK_SIZE;
+		}
+
+		err = blkcipher_walk_done(desc, &walk, n);
+	}
+
+	memset(buf, 0, sizeof(buf));
+	return err;
+}
+
+static int xts_aes_encrypt(struct blkcipher_desc *desc,
+			   struct scatterlist *dst, struct scatterlist *src,
+			   unsigned int nbytes)
+{
+	struct aes_xts_ctx *ctx = crypto_blkcipher_ctx(desc->tfm);
+
+	return xts_aes_crypt(desc, dst, src, nbytes, AES_encrypt,
+			     &ctx->enc_key);
+}
+
+static int xts_aes_decrypt(struct blkcipher_desc *desc,
+			   struct scatterlist *dst, struct scatterlist *src,
+			   unsigned int nbytes)
+{
+	struct aes_xts_ctx *ctx = crypto_blkcipher_ctx(desc->tfm);
+
+	return xts_aes_crypt(desc, dst, src, nbytes, AES_decrypt,
+			     &ctx->dec_key);
+}
+
+static struct crypto_alg xts_aes_alg = {
+	.cra_name		= "xts(aes)",
+	.cra_driver_name	= "xts-aes-asm",
+	.cra_priority		= 300,
+	.cra_flags		= CRYPTO_ALG_TYPE_BLKCIPHER,
+	.cra_blocksize		= AES_BLOCK_SIZE,
+	.cra_ctxsize		= sizeof(struct aes_xts_ctx),
+	.cra_type		= &crypto_blkcipher_type,
+	.cra_module		= THIS_MODULE,
+	.cra_u	= {
+		.blkcipher = {
+			.min_keysize	= 2 * AES_MIN_KEY_SIZE,
+			.max_keysize	= 2 * AES_MAX_KEY_SIZE,
+			.ivsize		= AES_BLOCK_SIZE,
+			.setkey		= xts_aes_setkey,
+			.encrypt	= xts_aes_encrypt,
+			.decrypt	= xts_aes_decrypt,
+		}
+	}
+};
+
+static int __init xts_aes_init(void)
+{
+	return crypto_register_alg(&xts_aes_alg);
+}
+
+static void __exit xts_aes_fini(void)
+{
+	crypto_unregister_alg(&xts_aes_alg);
+}
+
+module_init(xts_aes_init);
+module_exit(xts_aes_fini);
+
+MODULE_DESCRIPTION("XTS mode of the Rijndael (AES) Cipher Algorithm (ASM)");
+MODULE_LICENSE("GPL");
+MODULE_ALIAS("xts(aes)");
@@ -8,6 +8,9 @@
 
 struct dev_archdata {
 	struct dma_map_ops	*dma_ops;
+#ifdef CONFIG_MMU
+	struct arm_dma_arena	*arena;	/* per-device coherent arena */
+#endif
 #ifdef CONFIG_DMABOUNCE
 	struct dmabounce_device_info *dmabounce;
 #endif
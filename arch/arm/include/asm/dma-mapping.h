@@ -114,6 +114,23 @@ extern int dma_supported(struct device *dev, u64 mask);
 
 extern int arm_dma_set_mask(struct device *dev, u64 dma_mask);
 
+/*
+ * Declare/release a pre-mapped uncached per-device arena out of which
+ * dma_alloc_coherent() for this device is served by a bitmap allocator,
+ * avoiding the per-buffer remap and TLB flushing of the regular paths.
+ * Allocations that don't fit fall back to the regular paths.
+ */
+#ifdef CONFIG_MMU
+extern int arm_dma_arena_declare(struct device *dev, size_t size);
+extern void arm_dma_arena_release(struct device *dev);
+#else
+static inline int arm_dma_arena_declare(struct device *dev, size_t size)
+{
+	return -ENOSYS;
+}
+static inline void arm_dma_arena_release(struct device *dev) { }
+#endif
+
 /**
  * arm_dma_alloc - allocate consistent memory for DMA
  * @dev: valid struct device pointer, or NULL for ISA and EISA-like devices
@@ -33,6 +33,13 @@
 #define L2X0_EVENT_CNT0_CFG		0x208
 #define L2X0_EVENT_CNT1_VAL		0x20C
 #define L2X0_EVENT_CNT0_VAL		0x210
+
+#define L2X0_EVENT_CNT_CTRL_ENABLE	(1 << 0)
+
+#define L2X0_EVENT_CNT_CFG_SRC_SHIFT	2
+#define L2X0_EVENT_CNT_CFG_SRC_MASK	0xf
+#define L2X0_EVENT_CNT_CFG_SRC_DISABLED	0
+#define L2X0_EVENT_CNT_CFG_INT_DISABLED	0
 #define L2X0_INTR_MASK			0x214
 #define L2X0_MASKED_INTR_STAT		0x218
 #define L2X0_RAW_INTR_STAT		0x21C
@@ -135,6 +142,14 @@ struct l2x0_regs {
 
 extern struct l2x0_regs l2x0_saved_regs;
 
+#ifdef CONFIG_CACHE_L2X0_PMU
+extern void __init l2x0_pmu_register(void __iomem *base, u32 part);
+#else
+static inline void l2x0_pmu_register(void __iomem *base, u32 part)
+{
+}
+#endif
+
 #endif /* __ASSEMBLY__ */
 
 #endif
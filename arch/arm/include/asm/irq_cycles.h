@@ -0,0 +1,31 @@
+/*
+ * arch/arm/include/asm/irq_cycles.h
+ *
+ * PMU cycle counter access for per-IRQ cycle accounting.
+ *
+ * The counter is started at boot by arch/arm/kernel/irq_cycles.c and
+ * left free running.  It is the same counter perf uses for hardware
+ * cycle events, so the two must not be relied on at the same time.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+#ifndef __ASM_ARM_IRQ_CYCLES_H
+#define __ASM_ARM_IRQ_CYCLES_H
+
+#include <linux/types.h>
+
+/*
+ * PMCCNTR is 32 bits wide and wraps in a few seconds at CPU clock;
+ * callers must only form deltas between nearby reads.
+ */
+static inline u32 arch_irq_cycle_count(void)
+{
+	u32 ccnt;
+
+	asm volatile("mrc p15, 0, %0, c9, c13, 0" : "=r" (ccnt));
+	return ccnt;
+}
+
+#endif /* __ASM_ARM_IRQ_CYCLES_H */
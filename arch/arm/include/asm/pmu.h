@@ -81,6 +81,7 @@ struct arm_pmu {
 	int		(*request_irq)(struct arm_pmu *, irq_handler_t handler);
 	void		(*free_irq)(struct arm_pmu *);
 	int		(*map_event)(struct perf_event *event);
+	const struct attribute_group **attr_groups;
 	int		num_events;
 	atomic_t	active_events;
 	struct mutex	reserve_mutex;
@@ -0,0 +1,37 @@
+#ifndef __ASM_VDSO_H
+#define __ASM_VDSO_H
+
+#ifdef __KERNEL__
+
+#ifndef __ASSEMBLY__
+
+#include <linux/types.h>
+
+struct clocksource;
+
+#ifdef CONFIG_VDSO
+
+/*
+ * Export a memory mapped counter register to the VDSO.  @addr is the
+ * physical address of the register backing @cs; the page containing it
+ * is mapped read-only into every process so that clock_gettime() can
+ * be resolved without entering the kernel.
+ */
+void vdso_register_mmio_counter(struct clocksource *cs, phys_addr_t addr);
+
+extern char vdso_start, vdso_end;
+
+#else /* CONFIG_VDSO */
+
+static inline void vdso_register_mmio_counter(struct clocksource *cs,
+					      phys_addr_t addr)
+{
+}
+
+#endif /* CONFIG_VDSO */
+
+#endif /* __ASSEMBLY__ */
+
+#endif /* __KERNEL__ */
+
+#endif /* __ASM_VDSO_H */
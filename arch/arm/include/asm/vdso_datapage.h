@@ -0,0 +1,46 @@
+#ifndef __ASM_VDSO_DATAPAGE_H
+#define __ASM_VDSO_DATAPAGE_H
+
+#ifdef __KERNEL__
+
+#ifndef __ASSEMBLY__
+
+#include <linux/types.h>
+#include <asm/page.h>
+
+/*
+ * The VDSO data page, shared read-only with userspace.  The layout
+ * follows the timekeeper: the fine-grained fields are snapshots of the
+ * current clocksource state and are only valid while use_syscall is
+ * zero; the coarse fields and the timezone are always valid.
+ */
+struct vdso_data {
+	u32 seq_count;		/* sequence count - odd during updates */
+	u16 use_syscall;	/* no user readable counter, use syscall */
+	u16 cs_shift;		/* clocksource shift */
+	u32 cntr_off;		/* counter register offset in counter page */
+	u32 cs_mult;		/* clocksource multiplier (NTP adjusted) */
+	u64 cs_cycle_last;	/* last cycle value at update */
+	u64 cs_mask;		/* clocksource mask */
+
+	u64 xtime_clock_sec;	/* CLOCK_REALTIME - seconds */
+	u64 xtime_clock_snsec;	/* CLOCK_REALTIME sub-ns base (shifted) */
+	u32 xtime_coarse_sec;	/* coarse time */
+	u32 xtime_coarse_nsec;
+
+	u32 wtm_clock_sec;	/* wall to monotonic offset */
+	u32 wtm_clock_nsec;
+	u32 tz_minuteswest;	/* timezone info for gettimeofday(2) */
+	u32 tz_dsttime;
+};
+
+union vdso_data_store {
+	struct vdso_data data;
+	u8 page[PAGE_SIZE];
+};
+
+#endif /* !__ASSEMBLY__ */
+
+#endif /* __KERNEL__ */
+
+#endif /* __ASM_VDSO_DATAPAGE_H */
@@ -0,0 +1,51 @@
+/*
+ * arch/arm/kernel/irq_cycles.c
+ *
+ * Start the PMU cycle counter on each CPU for per-IRQ cycle
+ * accounting (kernel/irq/handle.c).  The counter is left free
+ * running; handlers only ever form deltas between nearby reads, so
+ * the 32 bit wrap does not matter.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+#include <linux/cpu.h>
+#include <linux/init.h>
+#include <linux/notifier.h>
+#include <linux/smp.h>
+
+#include <asm/irq_cycles.h>
+
+#define PMCR_E		(1 << 0)	/* enable all counters */
+#define PMCNTENSET_C	(1 << 31)	/* enable cycle counter */
+
+static void irq_cycles_enable_ccnt(void *unused)
+{
+	u32 pmcr;
+
+	asm volatile("mrc p15, 0, %0, c9, c12, 0" : "=r" (pmcr));
+	pmcr |= PMCR_E;
+	asm volatile("mcr p15, 0, %0, c9, c12, 0" : : "r" (pmcr));
+	asm volatile("mcr p15, 0, %0, c9, c12, 1" : : "r" (PMCNTENSET_C));
+}
+
+static int __cpuinit irq_cycles_cpu_notify(struct notifier_block *nb,
+					   unsigned long action, void *hcpu)
+{
+	if ((action & ~CPU_TASKS_FROZEN) == CPU_STARTING)
+		irq_cycles_enable_ccnt(NULL);
+	return NOTIFY_OK;
+}
+
+static struct notifier_block __cpuinitdata irq_cycles_cpu_nb = {
+	.notifier_call = irq_cycles_cpu_notify,
+};
+
+static int __init irq_cycles_init(void)
+{
+	on_each_cpu(irq_cycles_enable_ccnt, NULL, 1);
+	register_cpu_notifier(&irq_cycles_cpu_nb);
+	return 0;
+}
+early_initcall(irq_cycles_init);
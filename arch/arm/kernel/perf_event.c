@@ -493,6 +493,7 @@ static void armpmu_init(struct arm_pmu *armpmu)
 	mutex_init(&armpmu->reserve_mutex);
 
 	armpmu->pmu = (struct pmu) {
+		.attr_groups	= armpmu->attr_groups,
 		.pmu_enable	= armpmu_enable,
 		.pmu_disable	= armpmu_disable,
 		.event_init	= armpmu_event_init,
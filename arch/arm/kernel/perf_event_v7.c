@@ -82,7 +82,12 @@ enum armv7_a8_perf_types {
 enum armv7_a9_perf_types {
 	ARMV7_A9_PERFCTR_INSTR_CORE_RENAME		= 0x68,
 	ARMV7_A9_PERFCTR_STALL_ICACHE			= 0x60,
+	ARMV7_A9_PERFCTR_STALL_DCACHE			= 0x61,
 	ARMV7_A9_PERFCTR_STALL_DISPATCH			= 0x66,
+	ARMV7_A9_PERFCTR_STREX_FAILED			= 0x64,
+	ARMV7_A9_PERFCTR_INSTR_FP			= 0x73,
+	ARMV7_A9_PERFCTR_INSTR_NEON			= 0x74,
+	ARMV7_A9_PERFCTR_NEON_BUSY			= 0x8B,
 };
 
 /* ARMv7 Cortex-A5 specific event types */
@@ -1237,10 +1242,87 @@ static u32 armv7_read_num_pmnc_events(void)
 	return nb_cnt + 1;
 }
 
+static ssize_t armv7pmu_events_sysfs_show(struct device *dev,
+					  struct device_attribute *attr,
+					  char *page)
+{
+	struct perf_pmu_events_attr *pmu_attr =
+		container_of(attr, struct perf_pmu_events_attr, attr);
+
+	return sprintf(page, "event=0x%02llx\n", pmu_attr->id);
+}
+
+#define ARMV7_EVENT_ATTR(_name, _config)				\
+	PMU_EVENT_ATTR(_name, armv7_event_attr_##_name,			\
+		       _config, armv7pmu_events_sysfs_show)
+
+/*
+ * Named events for the Cortex-A9, so that tools can use something
+ * better than raw rNN encodings.  Only events the A9 TRM documents as
+ * implemented are listed.
+ */
+ARMV7_EVENT_ATTR(l1i_miss, ARMV7_PERFCTR_L1_ICACHE_REFILL);
+ARMV7_EVENT_ATTR(itlb_miss, ARMV7_PERFCTR_ITLB_REFILL);
+ARMV7_EVENT_ATTR(l1d_miss, ARMV7_PERFCTR_L1_DCACHE_REFILL);
+ARMV7_EVENT_ATTR(l1d_access, ARMV7_PERFCTR_L1_DCACHE_ACCESS);
+ARMV7_EVENT_ATTR(dtlb_miss, ARMV7_PERFCTR_DTLB_REFILL);
+ARMV7_EVENT_ATTR(branch_mispred, ARMV7_PERFCTR_PC_BRANCH_MIS_PRED);
+ARMV7_EVENT_ATTR(branch_pred, ARMV7_PERFCTR_PC_BRANCH_PRED);
+ARMV7_EVENT_ATTR(stall_icache, ARMV7_A9_PERFCTR_STALL_ICACHE);
+ARMV7_EVENT_ATTR(stall_dcache, ARMV7_A9_PERFCTR_STALL_DCACHE);
+ARMV7_EVENT_ATTR(stall_dispatch, ARMV7_A9_PERFCTR_STALL_DISPATCH);
+ARMV7_EVENT_ATTR(strex_failed, ARMV7_A9_PERFCTR_STREX_FAILED);
+ARMV7_EVENT_ATTR(instr_renamed, ARMV7_A9_PERFCTR_INSTR_CORE_RENAME);
+ARMV7_EVENT_ATTR(fp_instr, ARMV7_A9_PERFCTR_INSTR_FP);
+ARMV7_EVENT_ATTR(neon_instr, ARMV7_A9_PERFCTR_INSTR_NEON);
+ARMV7_EVENT_ATTR(neon_busy, ARMV7_A9_PERFCTR_NEON_BUSY);
+
+static struct attribute *armv7_a9_event_attrs[] = {
+	&armv7_event_attr_l1i_miss.attr.attr,
+	&armv7_event_attr_itlb_miss.attr.attr,
+	&armv7_event_attr_l1d_miss.attr.attr,
+	&armv7_event_attr_l1d_access.attr.attr,
+	&armv7_event_attr_dtlb_miss.attr.attr,
+	&armv7_event_attr_branch_mispred.attr.attr,
+	&armv7_event_attr_branch_pred.attr.attr,
+	&armv7_event_attr_stall_icache.attr.attr,
+	&armv7_event_attr_stall_dcache.attr.attr,
+	&armv7_event_attr_stall_dispatch.attr.attr,
+	&armv7_event_attr_strex_failed.attr.attr,
+	&armv7_event_attr_instr_renamed.attr.attr,
+	&armv7_event_attr_fp_instr.attr.attr,
+	&armv7_event_attr_neon_instr.attr.attr,
+	&armv7_event_attr_neon_busy.attr.attr,
+	NULL,
+};
+
+static struct attribute_group armv7_a9_pmu_events_group = {
+	.name = "events",
+	.attrs = armv7_a9_event_attrs,
+};
+
+PMU_FORMAT_ATTR(event, "config:0-7");
+
+static struct attribute *armv7_pmu_format_attrs[] = {
+	&format_attr_event.attr,
+	NULL,
+};
+
+static struct attribute_group armv7_pmu_format_group = {
+	.name = "format",
+	.attrs = armv7_pmu_format_attrs,
+};
+
+static const struct attribute_group *armv7_a9_pmu_attr_groups[] = {
+	&armv7_a9_pmu_events_group,
+	&armv7_pmu_format_group,
+	NULL,
+};
+
 static int armv7_a8_pmu_init(struct arm_pmu *cpu_pmu)
 {
 	armv7pmu_init(cpu_pmu);
-	cpu_pmu->name		= "ARMv7 Cortex-A8";
+	cpu_pmu->name		= "armv7_cortex_a8";
 	cpu_pmu->map_event	= armv7_a8_map_event;
 	cpu_pmu->num_events	= armv7_read_num_pmnc_events();
 	return 0;
@@ -1249,16 +1331,17 @@ static int armv7_a8_pmu_init(struct arm_pmu *cpu_pmu)
 static int armv7_a9_pmu_init(struct arm_pmu *cpu_pmu)
 {
 	armv7pmu_init(cpu_pmu);
-	cpu_pmu->name		= "ARMv7 Cortex-A9";
+	cpu_pmu->name		= "armv7_cortex_a9";
 	cpu_pmu->map_event	= armv7_a9_map_event;
 	cpu_pmu->num_events	= armv7_read_num_pmnc_events();
+	cpu_pmu->attr_groups	= armv7_a9_pmu_attr_groups;
 	return 0;
 }
 
 static int armv7_a5_pmu_init(struct arm_pmu *cpu_pmu)
 {
 	armv7pmu_init(cpu_pmu);
-	cpu_pmu->name		= "ARMv7 Cortex-A5";
+	cpu_pmu->name		= "armv7_cortex_a5";
 	cpu_pmu->map_event	= armv7_a5_map_event;
 	cpu_pmu->num_events	= armv7_read_num_pmnc_events();
 	return 0;
@@ -1267,7 +1350,7 @@ static int armv7_a5_pmu_init(struct arm_pmu *cpu_pmu)
 static int armv7_a15_pmu_init(struct arm_pmu *cpu_pmu)
 {
 	armv7pmu_init(cpu_pmu);
-	cpu_pmu->name		= "ARMv7 Cortex-A15";
+	cpu_pmu->name		= "armv7_cortex_a15";
 	cpu_pmu->map_event	= armv7_a15_map_event;
 	cpu_pmu->num_events	= armv7_read_num_pmnc_events();
 	cpu_pmu->set_event_filter = armv7pmu_set_event_filter;
@@ -1277,7 +1360,7 @@ static int armv7_a15_pmu_init(struct arm_pmu *cpu_pmu)
 static int armv7_a7_pmu_init(struct arm_pmu *cpu_pmu)
 {
 	armv7pmu_init(cpu_pmu);
-	cpu_pmu->name		= "ARMv7 Cortex-A7";
+	cpu_pmu->name		= "armv7_cortex_a7";
 	cpu_pmu->map_event	= armv7_a7_map_event;
 	cpu_pmu->num_events	= armv7_read_num_pmnc_events();
 	cpu_pmu->set_event_filter = armv7pmu_set_event_filter;
@@ -406,9 +406,65 @@ void __init set_smp_cross_call(void (*fn)(const struct cpumask *, unsigned int))
 		smp_cross_call = fn;
 }
 
+/*
+ * Each CPU has a pending-work word with one bit per IPI message. A
+ * sender posts its message there and only raises the hardware
+ * interrupt when the word was empty; while an IPI is in flight,
+ * further messages just set their bits and are collected by the same
+ * handler pass. Under heavy cross-call traffic this merges bursts of
+ * reschedule and function-call IPIs into a single GIC round-trip.
+ *
+ * IPI_WAKEUP and IPI_CPU_STOP are kept as direct vectors: the former
+ * targets a core that may still be in the boot holding pen, the
+ * latter must not depend on any state the wedged target shares with
+ * the senders.
+ */
+static DEFINE_PER_CPU(unsigned long, ipi_pending);
+
+#define IPI_COALESCE_MASK			\
+	((1UL << IPI_TIMER) |			\
+	 (1UL << IPI_RESCHEDULE) |		\
+	 (1UL << IPI_CALL_FUNC) |		\
+	 (1UL << IPI_CALL_FUNC_SINGLE))
+
+/*
+ * Post @ipinr to @cpu's pending-work word. Returns true when the word
+ * was empty, i.e. the caller must raise the hardware interrupt.
+ */
+static bool ipi_post(unsigned int cpu, unsigned int ipinr)
+{
+	unsigned long *pending = &per_cpu(ipi_pending, cpu);
+	unsigned long old, new;
+
+	do {
+		old = *pending;
+		new = old | (1UL << ipinr);
+		/* already posted, the IPI in flight collects it */
+		if (new == old)
+			return false;
+	} while (cmpxchg(pending, old, new) != old);
+
+	return old == 0;
+}
+
+static void smp_cross_call_coalesced(const struct cpumask *mask,
+				     unsigned int ipinr)
+{
+	struct cpumask call_mask;
+	unsigned int cpu;
+
+	cpumask_clear(&call_mask);
+	for_each_cpu(cpu, mask)
+		if (ipi_post(cpu, ipinr))
+			cpumask_set_cpu(cpu, &call_mask);
+
+	if (!cpumask_empty(&call_mask))
+		smp_cross_call(&call_mask, ipinr);
+}
+
 void arch_send_call_function_ipi_mask(const struct cpumask *mask)
 {
-	smp_cross_call(mask, IPI_CALL_FUNC);
+	smp_cross_call_coalesced(mask, IPI_CALL_FUNC);
 }
 
 void arch_send_wakeup_ipi_mask(const struct cpumask *mask)
@@ -418,7 +474,7 @@ void arch_send_wakeup_ipi_mask(const struct cpumask *mask)
 
 void arch_send_call_function_single_ipi(int cpu)
 {
-	smp_cross_call(cpumask_of(cpu), IPI_CALL_FUNC_SINGLE);
+	smp_cross_call_coalesced(cpumask_of(cpu), IPI_CALL_FUNC_SINGLE);
 }
 
 struct ipi {
@@ -476,7 +532,7 @@ static DEFINE_PER_CPU(struct clock_event_device, percpu_clockevent);
 #ifdef CONFIG_GENERIC_CLOCKEVENTS_BROADCAST
 void tick_broadcast(const struct cpumask *mask)
 {
-	smp_cross_call(mask, IPI_TIMER);
+	smp_cross_call_coalesced(mask, IPI_TIMER);
 }
 #endif
 
@@ -579,14 +635,31 @@ void handle_IPI(int ipinr, struct pt_regs *regs)
 {
 	unsigned int cpu = smp_processor_id();
 	struct pt_regs *old_regs = set_irq_regs(regs);
+	unsigned long pending;
+	unsigned int nr;
 
-	if (ipi_types[ipinr].handler) {
-		__inc_irq_stat(cpu, ipi_irqs[ipinr]);
-		irq_enter();
-		(*ipi_types[ipinr].handler)();
-		irq_exit();
-	} else
-		pr_debug("CPU%u: Unknown IPI message 0x%x\n", cpu, ipinr);
+	/*
+	 * For coalesced messages, take the whole pending-work word and
+	 * dispatch every message found in it, not just the one the
+	 * vector was raised for. Bits posted after the xchg raise a
+	 * fresh interrupt; an empty word means an earlier pass already
+	 * collected this vector's work.
+	 */
+	if (IPI_COALESCE_MASK & (1UL << ipinr))
+		pending = xchg(&__get_cpu_var(ipi_pending), 0);
+	else
+		pending = 1UL << ipinr;
+
+	for_each_set_bit(nr, &pending, NR_IPI) {
+		if (ipi_types[nr].handler) {
+			__inc_irq_stat(cpu, ipi_irqs[nr]);
+			irq_enter();
+			(*ipi_types[nr].handler)();
+			irq_exit();
+		} else
+			pr_debug("CPU%u: Unknown IPI message 0x%x\n",
+				 cpu, nr);
+	}
 
 	set_irq_regs(old_regs);
 }
@@ -625,7 +698,7 @@ EXPORT_SYMBOL(clear_ipi_handler);
 
 void smp_send_reschedule(int cpu)
 {
-	smp_cross_call(cpumask_of(cpu), IPI_RESCHEDULE);
+	smp_cross_call_coalesced(cpumask_of(cpu), IPI_RESCHEDULE);
 }
 
 #ifdef CONFIG_HOTPLUG_CPU
@@ -0,0 +1,200 @@
+/*
+ * VDSO implementation for ARM, providing fast userspace gettimeofday and
+ * clock_gettime.
+ *
+ * The Cortex-A9 has no CP15 counter readable from userspace, so the
+ * counter of the current clocksource is exported instead: the driver
+ * registers the physical address of its counter register through
+ * vdso_register_mmio_counter() and the page containing it is mapped
+ * read-only into every process, between the data page and the VDSO
+ * text:
+ *
+ *	[ data page | counter page | VDSO text ... ]
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <linux/kernel.h>
+#include <linux/clocksource.h>
+#include <linux/err.h>
+#include <linux/mm.h>
+#include <linux/mman.h>
+#include <linux/sched.h>
+#include <linux/slab.h>
+#include <linux/timekeeper_internal.h>
+#include <linux/vmalloc.h>
+
+#include <asm/page.h>
+#include <asm/vdso.h>
+#include <asm/vdso_datapage.h>
+
+static union vdso_data_store vdso_data_store __page_aligned_data;
+static struct vdso_data *vdso_data = &vdso_data_store.data;
+
+static struct page *vdso_data_pagelist[1];
+static struct page **vdso_text_pagelist;
+static unsigned int vdso_text_pages;
+
+/* User readable counter register exported by the clocksource, if any */
+static struct clocksource *vdso_cntr_cs;
+static unsigned long vdso_cntr_pfn;
+
+void __init vdso_register_mmio_counter(struct clocksource *cs,
+				       phys_addr_t addr)
+{
+	vdso_cntr_cs = cs;
+	vdso_cntr_pfn = addr >> PAGE_SHIFT;
+	vdso_data->cntr_off = offset_in_page(addr);
+}
+
+static int __init vdso_init(void)
+{
+	unsigned int text_pages;
+	int i;
+
+	if (memcmp(&vdso_start, "\177ELF", 4)) {
+		pr_err("VDSO is not a valid ELF object!\n");
+		return -ENOEXEC;
+	}
+
+	text_pages = (&vdso_end - &vdso_start) >> PAGE_SHIFT;
+
+	vdso_text_pagelist = kcalloc(text_pages, sizeof(struct page *),
+				     GFP_KERNEL);
+	if (vdso_text_pagelist == NULL)
+		return -ENOMEM;
+
+	for (i = 0; i < text_pages; i++)
+		vdso_text_pagelist[i] = virt_to_page(&vdso_start +
+						     i * PAGE_SIZE);
+	vdso_data_pagelist[0] = virt_to_page(vdso_data);
+	vdso_text_pages = text_pages;
+
+	return 0;
+}
+arch_initcall(vdso_init);
+
+/*
+ * Map the page holding the clocksource counter register read-only at
+ * @addr.  An MMIO page has no struct page, so this cannot go through
+ * install_special_mapping(); create the vma by hand and remap the pfn
+ * into it.
+ */
+static int install_counter_page(struct mm_struct *mm, unsigned long addr)
+{
+	struct vm_area_struct *vma;
+	unsigned long populate;
+	unsigned long ret;
+
+	ret = do_mmap_pgoff(NULL, addr, PAGE_SIZE, PROT_READ,
+			    MAP_SHARED | MAP_FIXED, 0, &populate);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	vma = find_vma(mm, addr);
+	if (vma == NULL || vma->vm_start > addr)
+		return -ENOMEM;
+
+	vma->vm_flags |= VM_DONTEXPAND | VM_DONTDUMP;
+	return io_remap_pfn_range(vma, addr, vdso_cntr_pfn, PAGE_SIZE,
+				  pgprot_noncached(vma->vm_page_prot));
+}
+
+int arch_setup_additional_pages(struct linux_binprm *bprm, int uses_interp)
+{
+	struct mm_struct *mm = current->mm;
+	unsigned long addr;
+	unsigned long len;
+	int ret;
+
+	if (vdso_text_pagelist == NULL)
+		return 0;
+
+	/* data page + counter page + text */
+	len = (2 + vdso_text_pages) << PAGE_SHIFT;
+
+	down_write(&mm->mmap_sem);
+	addr = get_unmapped_area(NULL, 0, len, 0, 0);
+	if (IS_ERR_VALUE(addr)) {
+		ret = addr;
+		goto out;
+	}
+
+	ret = install_special_mapping(mm, addr, PAGE_SIZE,
+				      VM_READ | VM_MAYREAD,
+				      vdso_data_pagelist);
+	if (ret)
+		goto out;
+
+	if (vdso_cntr_pfn) {
+		ret = install_counter_page(mm, addr + PAGE_SIZE);
+		if (ret)
+			goto out;
+	}
+
+	ret = install_special_mapping(mm, addr + 2 * PAGE_SIZE,
+				      vdso_text_pages << PAGE_SHIFT,
+				      VM_READ | VM_EXEC |
+				      VM_MAYREAD | VM_MAYEXEC,
+				      vdso_text_pagelist);
+	if (ret)
+		goto out;
+
+	mm->context.vdso = addr + 2 * PAGE_SIZE;
+out:
+	up_write(&mm->mmap_sem);
+	return ret;
+}
+
+static void vdso_write_begin(struct vdso_data *vdata)
+{
+	++vdata->seq_count;
+	smp_wmb();
+}
+
+static void vdso_write_end(struct vdso_data *vdata)
+{
+	smp_wmb();
+	++vdata->seq_count;
+}
+
+/*
+ * Update the VDSO data page to keep in sync with kernel timekeeping.
+ * Called with the timekeeper seqlock held for writing.
+ */
+void update_vsyscall(struct timekeeper *tk)
+{
+	struct timespec *wtm = &tk->wall_to_monotonic;
+
+	vdso_write_begin(vdso_data);
+
+	vdso_data->use_syscall = !vdso_cntr_pfn || tk->clock != vdso_cntr_cs;
+	vdso_data->xtime_coarse_sec = tk->xtime_sec;
+	vdso_data->xtime_coarse_nsec = (u32)(tk->xtime_nsec >> tk->shift);
+	vdso_data->wtm_clock_sec = wtm->tv_sec;
+	vdso_data->wtm_clock_nsec = wtm->tv_nsec;
+
+	if (!vdso_data->use_syscall) {
+		vdso_data->cs_cycle_last = tk->clock->cycle_last;
+		vdso_data->cs_mask = tk->clock->mask;
+		vdso_data->cs_mult = tk->mult;
+		vdso_data->cs_shift = tk->shift;
+		vdso_data->xtime_clock_sec = tk->xtime_sec;
+		vdso_data->xtime_clock_snsec = tk->xtime_nsec;
+	}
+
+	vdso_write_end(vdso_data);
+}
+
+void update_vsyscall_tz(void)
+{
+	vdso_data->tz_minuteswest = sys_tz.tz_minuteswest;
+	vdso_data->tz_dsttime = sys_tz.tz_dsttime;
+}
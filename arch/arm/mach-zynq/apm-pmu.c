@@ -0,0 +1,453 @@
+/*
+ * perf PMU driver for the Xilinx AXI Performance Monitor
+ *
+ *  Copyright (C) 2013 Xilinx
+ *
+ * The AXI Performance Monitor is a PL core that snoops up to eight
+ * AXI slots and counts transactions, bytes, beats and latencies per
+ * slot in up to ten 32-bit metric counters. This driver exposes the
+ * metric counters as a system-wide perf PMU, so PL interconnect
+ * bandwidth shows up in the same perf session as the CPU events:
+ *
+ *   perf stat -a -e xilinx_apm_0/event=0x3,slot=0/ sleep 1
+ *
+ * The event encoding matches the hardware metric selector byte:
+ * bits [4:0] select the metric (see PG037 for the full table, e.g.
+ * 0x2/0x3 are write/read byte counts) and bits [7:5] the slot.
+ *
+ * The counters count bus activity, not work attributable to an
+ * instruction pointer, so sampling is not supported; use counting
+ * mode. When the core's interrupt is wired up it is used to fold
+ * counter overflows into the 64-bit software count, otherwise the
+ * counters must be read at least once per wrap period.
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <linux/bitops.h>
+#include <linux/interrupt.h>
+#include <linux/io.h>
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/of.h>
+#include <linux/perf_event.h>
+#include <linux/platform_device.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+
+/* register offsets */
+#define XAPM_GCC_HIGH_OFFSET		0x0000	/* global clock counter */
+#define XAPM_GCC_LOW_OFFSET		0x0004
+#define XAPM_MSR0_OFFSET		0x0044	/* metric selectors 0-3 */
+#define XAPM_MSR1_OFFSET		0x0048	/* metric selectors 4-7 */
+#define XAPM_MSR2_OFFSET		0x004C	/* metric selectors 8-9 */
+#define XAPM_GIE_OFFSET			0x0030	/* global irq enable */
+#define XAPM_IE_OFFSET			0x0034	/* irq enable */
+#define XAPM_IS_OFFSET			0x0038	/* irq status, w1c */
+#define XAPM_MC_OFFSET(n)		(0x0100 + (n) * 0x10)
+#define XAPM_CTL_OFFSET			0x0300
+
+/* control register */
+#define XAPM_CR_GCC_RESET_MASK		0x00020000
+#define XAPM_CR_GCC_ENABLE_MASK		0x00010000
+#define XAPM_CR_MCNTR_RESET_MASK	0x00000002
+#define XAPM_CR_MCNTR_ENABLE_MASK	0x00000001
+
+/* irq status/enable register: bits 2-11 are metric counter overflows */
+#define XAPM_IXR_MC_OVERFLOW_SHIFT	2
+#define XAPM_IXR_MC_OVERFLOW_MASK(n)	\
+	(1 << (XAPM_IXR_MC_OVERFLOW_SHIFT + (n)))
+
+#define XAPM_MAX_COUNTERS		10
+#define XAPM_EVENT_MASK			0xff	/* metric selector byte */
+
+/**
+ * struct xapm_pmu - AXI Performance Monitor PMU instance
+ * @pmu:	perf PMU glue
+ * @base:	register base of the monitor core
+ * @dev:	backing platform device, for diagnostics
+ * @num_counters: metric counters implemented in this PL build
+ * @lock:	protects counter allocation and selector updates
+ * @used_mask:	bitmap of busy metric counters
+ * @events:	back pointers for the overflow interrupt handler
+ * @name:	registered PMU name, xilinx_apm_<instance>
+ */
+struct xapm_pmu {
+	struct pmu pmu;
+	void __iomem *base;
+	struct device *dev;
+	int num_counters;
+	raw_spinlock_t lock;
+	unsigned long used_mask;
+	struct perf_event *events[XAPM_MAX_COUNTERS];
+	char name[16];
+};
+
+#define to_xapm_pmu(p)	(container_of(p, struct xapm_pmu, pmu))
+
+static int xapm_instance;
+
+/*
+ * Write the metric selector byte of one counter. Each selector
+ * register packs four counters, eight bits each.
+ */
+static void xapm_set_selector(struct xapm_pmu *apm, int idx, u32 val)
+{
+	u32 offset = XAPM_MSR0_OFFSET + (idx / 4) * 4;
+	int shift = (idx % 4) * 8;
+	u32 msr;
+
+	msr = readl(apm->base + offset);
+	msr &= ~(XAPM_EVENT_MASK << shift);
+	msr |= val << shift;
+	writel(msr, apm->base + offset);
+}
+
+/*
+ * The metric counters free run and cannot be reset one at a time, so
+ * the events accumulate deltas against the last snapshot. The 32-bit
+ * masking makes a single wrap between updates come out right; the
+ * overflow interrupt forces an update so wraps are never missed.
+ */
+static void xapm_event_update(struct perf_event *event)
+{
+	struct xapm_pmu *apm = to_xapm_pmu(event->pmu);
+	struct hw_perf_event *hwc = &event->hw;
+	u64 prev, now;
+
+	do {
+		prev = local64_read(&hwc->prev_count);
+		now = readl(apm->base + XAPM_MC_OFFSET(hwc->idx));
+	} while (local64_cmpxchg(&hwc->prev_count, prev, now) != prev);
+
+	local64_add((now - prev) & 0xffffffff, &event->count);
+}
+
+static void xapm_event_start(struct perf_event *event, int flags)
+{
+	struct xapm_pmu *apm = to_xapm_pmu(event->pmu);
+	struct hw_perf_event *hwc = &event->hw;
+
+	local64_set(&hwc->prev_count,
+			readl(apm->base + XAPM_MC_OFFSET(hwc->idx)));
+	hwc->state = 0;
+}
+
+static void xapm_event_stop(struct perf_event *event, int flags)
+{
+	struct hw_perf_event *hwc = &event->hw;
+
+	if (hwc->state & PERF_HES_STOPPED)
+		return;
+	xapm_event_update(event);
+	hwc->state |= PERF_HES_STOPPED | PERF_HES_UPTODATE;
+}
+
+static int xapm_event_add(struct perf_event *event, int flags)
+{
+	struct xapm_pmu *apm = to_xapm_pmu(event->pmu);
+	struct hw_perf_event *hwc = &event->hw;
+	unsigned long irqflags;
+	u32 ie;
+	int idx;
+
+	raw_spin_lock_irqsave(&apm->lock, irqflags);
+	idx = find_first_zero_bit(&apm->used_mask, apm->num_counters);
+	if (idx == apm->num_counters) {
+		raw_spin_unlock_irqrestore(&apm->lock, irqflags);
+		return -EAGAIN;
+	}
+	set_bit(idx, &apm->used_mask);
+	apm->events[idx] = event;
+	hwc->idx = idx;
+
+	xapm_set_selector(apm, idx, event->attr.config & XAPM_EVENT_MASK);
+	ie = readl(apm->base + XAPM_IE_OFFSET);
+	writel(ie | XAPM_IXR_MC_OVERFLOW_MASK(idx),
+			apm->base + XAPM_IE_OFFSET);
+	raw_spin_unlock_irqrestore(&apm->lock, irqflags);
+
+	hwc->state = PERF_HES_STOPPED | PERF_HES_UPTODATE;
+	if (flags & PERF_EF_START)
+		xapm_event_start(event, 0);
+
+	return 0;
+}
+
+static void xapm_event_del(struct perf_event *event, int flags)
+{
+	struct xapm_pmu *apm = to_xapm_pmu(event->pmu);
+	struct hw_perf_event *hwc = &event->hw;
+	unsigned long irqflags;
+	u32 ie;
+
+	xapm_event_stop(event, PERF_EF_UPDATE);
+
+	raw_spin_lock_irqsave(&apm->lock, irqflags);
+	ie = readl(apm->base + XAPM_IE_OFFSET);
+	writel(ie & ~XAPM_IXR_MC_OVERFLOW_MASK(hwc->idx),
+			apm->base + XAPM_IE_OFFSET);
+	apm->events[hwc->idx] = NULL;
+	clear_bit(hwc->idx, &apm->used_mask);
+	raw_spin_unlock_irqrestore(&apm->lock, irqflags);
+
+	hwc->idx = -1;
+}
+
+static void xapm_event_read(struct perf_event *event)
+{
+	xapm_event_update(event);
+}
+
+static int xapm_event_init(struct perf_event *event)
+{
+	struct xapm_pmu *apm;
+
+	if (event->attr.type != event->pmu->type)
+		return -ENOENT;
+
+	/* bus counters have no instruction pointer to sample */
+	if (is_sampling_event(event))
+		return -EOPNOTSUPP;
+
+	/* no filtering capability whatsoever */
+	if (event->attr.exclude_user || event->attr.exclude_kernel ||
+	    event->attr.exclude_hv || event->attr.exclude_idle ||
+	    event->attr.exclude_host || event->attr.exclude_guest)
+		return -EINVAL;
+
+	if (event->cpu < 0)
+		return -EINVAL;
+
+	apm = to_xapm_pmu(event->pmu);
+	if ((event->attr.config & ~(u64)XAPM_EVENT_MASK) != 0)
+		return -EINVAL;
+
+	event->hw.idx = -1;
+
+	return 0;
+}
+
+static irqreturn_t xapm_irq_handler(int irq, void *dev_id)
+{
+	struct xapm_pmu *apm = dev_id;
+	u32 is;
+	int i;
+
+	is = readl(apm->base + XAPM_IS_OFFSET);
+	if (!is)
+		return IRQ_NONE;
+	writel(is, apm->base + XAPM_IS_OFFSET);
+
+	for (i = 0; i < apm->num_counters; i++) {
+		if (!(is & XAPM_IXR_MC_OVERFLOW_MASK(i)))
+			continue;
+		if (apm->events[i])
+			xapm_event_update(apm->events[i]);
+	}
+
+	return IRQ_HANDLED;
+}
+
+PMU_FORMAT_ATTR(event, "config:0-4");
+PMU_FORMAT_ATTR(slot, "config:5-7");
+
+static struct attribute *xapm_format_attrs[] = {
+	&format_attr_event.attr,
+	&format_attr_slot.attr,
+	NULL,
+};
+
+static struct attribute_group xapm_format_attr_group = {
+	.name = "format",
+	.attrs = xapm_format_attrs,
+};
+
+struct xapm_event_attr {
+	struct device_attribute attr;
+	u8 config;
+};
+
+static ssize_t xapm_event_attr_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	struct xapm_event_attr *ea =
+		container_of(attr, struct xapm_event_attr, attr);
+
+	return sprintf(buf, "event=0x%02x\n", ea->config);
+}
+
+#define XAPM_EVENT_ATTR(_name, _config)				\
+static struct xapm_event_attr xapm_event_attr_##_name = {	\
+	.attr = __ATTR(_name, 0444, xapm_event_attr_show, NULL),\
+	.config = _config,					\
+}
+
+/* the common metrics; combine with slot=N, full table in PG037 */
+XAPM_EVENT_ATTR(wr_tx_count, 0x00);
+XAPM_EVENT_ATTR(rd_tx_count, 0x01);
+XAPM_EVENT_ATTR(wr_byte_count, 0x02);
+XAPM_EVENT_ATTR(rd_byte_count, 0x03);
+XAPM_EVENT_ATTR(wr_beat_count, 0x04);
+XAPM_EVENT_ATTR(total_rd_latency, 0x05);
+XAPM_EVENT_ATTR(total_wr_latency, 0x06);
+
+static struct attribute *xapm_event_attrs[] = {
+	&xapm_event_attr_wr_tx_count.attr.attr,
+	&xapm_event_attr_rd_tx_count.attr.attr,
+	&xapm_event_attr_wr_byte_count.attr.attr,
+	&xapm_event_attr_rd_byte_count.attr.attr,
+	&xapm_event_attr_wr_beat_count.attr.attr,
+	&xapm_event_attr_total_rd_latency.attr.attr,
+	&xapm_event_attr_total_wr_latency.attr.attr,
+	NULL,
+};
+
+static struct attribute_group xapm_events_attr_group = {
+	.name = "events",
+	.attrs = xapm_event_attrs,
+};
+
+/*
+ * The counters are bus-global, so let the perf tool open each event
+ * on one CPU only instead of once per CPU.
+ */
+static ssize_t xapm_cpumask_show(struct device *dev,
+		struct device_attribute *attr, char *buf)
+{
+	return sprintf(buf, "0\n");
+}
+
+static DEVICE_ATTR(cpumask, 0444, xapm_cpumask_show, NULL);
+
+static struct attribute *xapm_cpumask_attrs[] = {
+	&dev_attr_cpumask.attr,
+	NULL,
+};
+
+static struct attribute_group xapm_cpumask_attr_group = {
+	.attrs = xapm_cpumask_attrs,
+};
+
+static const struct attribute_group *xapm_attr_groups[] = {
+	&xapm_format_attr_group,
+	&xapm_events_attr_group,
+	&xapm_cpumask_attr_group,
+	NULL,
+};
+
+static int xapm_pmu_probe(struct platform_device *pdev)
+{
+	struct xapm_pmu *apm;
+	struct resource *res;
+	u32 num_counters = XAPM_MAX_COUNTERS;
+	int irq;
+	int err;
+
+	apm = devm_kzalloc(&pdev->dev, sizeof(*apm), GFP_KERNEL);
+	if (!apm)
+		return -ENOMEM;
+
+	res = platform_get_resource(pdev, IORESOURCE_MEM, 0);
+	apm->base = devm_ioremap_resource(&pdev->dev, res);
+	if (IS_ERR(apm->base))
+		return PTR_ERR(apm->base);
+
+	of_property_read_u32(pdev->dev.of_node, "xlnx,num-of-counters",
+				&num_counters);
+	if (!num_counters || num_counters > XAPM_MAX_COUNTERS) {
+		dev_err(&pdev->dev, "invalid counter count %u\n",
+				num_counters);
+		return -EINVAL;
+	}
+	apm->num_counters = num_counters;
+	apm->dev = &pdev->dev;
+	raw_spin_lock_init(&apm->lock);
+
+	/* quiesce, then start the counters free running */
+	writel(0x0, apm->base + XAPM_GIE_OFFSET);
+	writel(0x0, apm->base + XAPM_IE_OFFSET);
+	writel(XAPM_CR_MCNTR_RESET_MASK | XAPM_CR_GCC_RESET_MASK,
+			apm->base + XAPM_CTL_OFFSET);
+	writel(XAPM_CR_MCNTR_ENABLE_MASK | XAPM_CR_GCC_ENABLE_MASK,
+			apm->base + XAPM_CTL_OFFSET);
+
+	irq = platform_get_irq(pdev, 0);
+	if (irq >= 0) {
+		err = devm_request_irq(&pdev->dev, irq, xapm_irq_handler,
+					0, "xilinx-apm", apm);
+		if (err) {
+			dev_err(&pdev->dev, "unable to request irq %d\n",
+					irq);
+			return err;
+		}
+		writel(0x1, apm->base + XAPM_GIE_OFFSET);
+	} else {
+		dev_info(&pdev->dev,
+			"no overflow irq, counters wrap at 2^32\n");
+	}
+
+	apm->pmu = (struct pmu) {
+		.task_ctx_nr	= perf_invalid_context,
+		.attr_groups	= xapm_attr_groups,
+		.event_init	= xapm_event_init,
+		.add		= xapm_event_add,
+		.del		= xapm_event_del,
+		.start		= xapm_event_start,
+		.stop		= xapm_event_stop,
+		.read		= xapm_event_read,
+	};
+
+	snprintf(apm->name, sizeof(apm->name), "xilinx_apm_%d",
+			xapm_instance++);
+	err = perf_pmu_register(&apm->pmu, apm->name, -1);
+	if (err) {
+		dev_err(&pdev->dev, "could not register PMU\n");
+		return err;
+	}
+
+	platform_set_drvdata(pdev, apm);
+	dev_info(&pdev->dev, "%s: %d counters%s\n", apm->name,
+			apm->num_counters, irq >= 0 ? ", overflow irq" : "");
+
+	return 0;
+}
+
+static int xapm_pmu_remove(struct platform_device *pdev)
+{
+	struct xapm_pmu *apm = platform_get_drvdata(pdev);
+
+	perf_pmu_unregister(&apm->pmu);
+	writel(0x0, apm->base + XAPM_GIE_OFFSET);
+	writel(0x0, apm->base + XAPM_CTL_OFFSET);
+
+	return 0;
+}
+
+static const struct of_device_id xapm_pmu_of_match[] = {
+	{ .compatible = "xlnx,axi-perf-monitor" },
+	{ /* end of table */ }
+};
+
+static struct platform_driver xapm_pmu_driver = {
+	.driver = {
+		.name = "xilinx-apm-pmu",
+		.owner = THIS_MODULE,
+		.of_match_table = xapm_pmu_of_match,
+	},
+	.probe = xapm_pmu_probe,
+	.remove = xapm_pmu_remove,
+};
+
+static int __init xapm_pmu_init(void)
+{
+	return platform_driver_register(&xapm_pmu_driver);
+}
+device_initcall(xapm_pmu_init);
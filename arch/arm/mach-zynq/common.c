@@ -14,6 +14,7 @@
  * GNU General Public License for more details.
  */
 
+#include <linux/arm_global_timer.h>
 #include <linux/init.h>
 #include <linux/kernel.h>
 #include <linux/cpu.h>
@@ -29,6 +30,16 @@
 #include <linux/of.h>
 #include <linux/memblock.h>
 #include <linux/irqchip.h>
+#include <linux/pstore_ram.h>
+#include <linux/dma-mapping.h>
+#include <linux/genalloc.h>
+#include <linux/io.h>
+#include <linux/kobject.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/sysfs.h>
+#include <linux/vmalloc.h>
+#include <linux/zynq_ocm.h>
 
 #include <asm/mach/arch.h>
 #include <asm/mach/map.h>
@@ -61,8 +72,13 @@ static void __init zynq_memory_init(void)
 
 #ifdef CONFIG_CPU_FREQ
 #define CPUFREQ_MIN_FREQ_HZ	200000000
+/*
+ * All of these map onto the CPU_MASTER_CLK divisor, so every listed
+ * point is reachable without re-locking the ARM PLL; divisors whose
+ * resulting frequency falls below CPUFREQ_MIN_FREQ_HZ are skipped.
+ */
 static unsigned int freq_divs[] __initdata = {
-	2, 3
+	2, 3, 4
 };
 
 /**
@@ -112,19 +128,359 @@ device_initcall(zynq_opp_init);
 #endif
 
 #ifdef CONFIG_CACHE_L2X0
+/*
+ * PL310 prefetch control register bits that are safe to change at
+ * runtime with the cache enabled: double linefill (bit 30),
+ * instruction prefetch (bit 29), data prefetch (bit 28) and the
+ * prefetch offset (bits 4:0). Everything else in the register either
+ * requires the cache to be disabled or is reserved.
+ */
+#define ZYNQ_L2C_PREFETCH_SAFE_MASK	0x7000001f
+
+static void __iomem *zynq_l2c_base;
+static DEFINE_SPINLOCK(zynq_l2c_lock);
+
+/* Boot-time overrides, ~0 means "leave the l2x0 defaults alone" */
+static u32 zynq_l2c_prefetch_boot = ~0;
+static bool zynq_l2c_ebresp_boot;
+
+static int __init zynq_l2c_prefetch_setup(char *str)
+{
+	return kstrtouint(str, 0, &zynq_l2c_prefetch_boot);
+}
+early_param("l2c_prefetch", zynq_l2c_prefetch_setup);
+
+static int __init zynq_l2c_ebresp_setup(char *str)
+{
+	zynq_l2c_ebresp_boot = true;
+	return 0;
+}
+early_param("l2c_ebresp", zynq_l2c_ebresp_setup);
+
+static void zynq_l2c_prefetch_set(u32 val)
+{
+	unsigned long flags;
+	u32 tmp;
+
+	spin_lock_irqsave(&zynq_l2c_lock, flags);
+	tmp = readl_relaxed(zynq_l2c_base + L2X0_PREFETCH_CTRL);
+	tmp &= ~ZYNQ_L2C_PREFETCH_SAFE_MASK;
+	tmp |= val & ZYNQ_L2C_PREFETCH_SAFE_MASK;
+	writel_relaxed(tmp, zynq_l2c_base + L2X0_PREFETCH_CTRL);
+	spin_unlock_irqrestore(&zynq_l2c_lock, flags);
+}
+
+/**
+ * zynq_l2c_standby_enable() - Let the L2 clock gate while contents are kept
+ *
+ * Enables dynamic clock gating and standby mode in the PL310 power
+ * control register. With both bits set the controller stops its clock
+ * whenever all masters are in WFI, retaining the cache contents, and
+ * restarts it transparently on the first access. Used by cpuidle for
+ * the retention states; the bits are safe to set with the cache
+ * enabled.
+ */
+void zynq_l2c_standby_enable(void)
+{
+	if (!zynq_l2c_base)
+		return;
+
+	writel_relaxed(L2X0_DYNAMIC_CLK_GATING_EN | L2X0_STNDBY_MODE_EN,
+		       zynq_l2c_base + L2X0_POWER_CTRL);
+}
+
 static int __init zynq_l2c_init(void)
 {
+	struct device_node *np;
+	u32 aux_val = 0x02060000;
+	int ret;
+
 	/* 64KB way size, 8-way associativity, parity disabled,
 	 * prefetching option */
-#ifndef	CONFIG_XILINX_L2_PREFETCH
-	return l2x0_of_init(0x02060000, 0xF0F0FFFF);
-#else
-	return l2x0_of_init(0x72060000, 0xF0F0FFFF);
+#ifdef	CONFIG_XILINX_L2_PREFETCH
+	aux_val |= 0x70000000;
 #endif
+	/*
+	 * Early write response can only be set up while the cache is
+	 * still disabled, so it is boot-time configurable only.
+	 */
+	if (zynq_l2c_ebresp_boot)
+		aux_val |= 1 << L2X0_AUX_CTRL_EARLY_BRESP_SHIFT;
+
+	ret = l2x0_of_init(aux_val, 0xF0F0FFFF);
+	if (ret)
+		return ret;
+
+	np = of_find_compatible_node(NULL, NULL, "arm,pl310-cache");
+	if (np) {
+		zynq_l2c_base = of_iomap(np, 0);
+		of_node_put(np);
+	}
+
+	if (zynq_l2c_base && zynq_l2c_prefetch_boot != ~0)
+		zynq_l2c_prefetch_set(zynq_l2c_prefetch_boot);
+
+	return 0;
 }
 early_initcall(zynq_l2c_init);
+
+/* Large enough to overflow the 512 KB L2, so DDR bandwidth dominates */
+#define ZYNQ_L2C_BENCH_SIZE	SZ_1M
+#define ZYNQ_L2C_BENCH_PASSES	16
+
+/**
+ * zynq_l2c_membench() - Measure achieved memcpy bandwidth
+ * Returns the bandwidth in KB/s, or 0 if the buffers could not be
+ * allocated.
+ *
+ * Copies a buffer twice the L2 size so the runs measure the memory
+ * system rather than the cache, making the effect of the prefetch and
+ * early write response settings directly visible.
+ */
+static u32 zynq_l2c_membench(void)
+{
+	void *src, *dst;
+	ktime_t start;
+	u64 ns;
+	u32 kbps = 0;
+	int i;
+
+	src = vmalloc(ZYNQ_L2C_BENCH_SIZE);
+	dst = vmalloc(ZYNQ_L2C_BENCH_SIZE);
+	if (src && dst) {
+		memset(src, 0x5a, ZYNQ_L2C_BENCH_SIZE);
+		/* Fault in the destination outside the timed region */
+		memset(dst, 0, ZYNQ_L2C_BENCH_SIZE);
+		start = ktime_get();
+		for (i = 0; i < ZYNQ_L2C_BENCH_PASSES; i++)
+			memcpy(dst, src, ZYNQ_L2C_BENCH_SIZE);
+		ns = ktime_to_ns(ktime_sub(ktime_get(), start));
+		if (ns)
+			kbps = div64_u64((u64)ZYNQ_L2C_BENCH_PASSES *
+					ZYNQ_L2C_BENCH_SIZE * NSEC_PER_SEC,
+					ns * SZ_1K);
+	}
+	vfree(dst);
+	vfree(src);
+
+	return kbps;
+}
+
+static ssize_t zynq_l2c_prefetch_show(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	u32 val = readl_relaxed(zynq_l2c_base + L2X0_PREFETCH_CTRL);
+
+	return sprintf(buf, "0x%08x\n", val & ZYNQ_L2C_PREFETCH_SAFE_MASK);
+}
+
+static ssize_t zynq_l2c_prefetch_store(struct kobject *kobj,
+		struct kobj_attribute *attr, const char *buf, size_t count)
+{
+	u32 val;
+	int ret;
+
+	ret = kstrtouint(buf, 0, &val);
+	if (ret)
+		return ret;
+
+	if (val & ~ZYNQ_L2C_PREFETCH_SAFE_MASK)
+		return -EINVAL;
+
+	zynq_l2c_prefetch_set(val);
+
+	return count;
+}
+
+static ssize_t zynq_l2c_aux_show(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "0x%08x\n",
+			readl_relaxed(zynq_l2c_base + L2X0_AUX_CTRL));
+}
+
+static ssize_t zynq_l2c_membench_show(struct kobject *kobj,
+		struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u KB/s\n", zynq_l2c_membench());
+}
+
+static struct kobj_attribute zynq_l2c_prefetch_attr =
+	__ATTR(prefetch, 0644, zynq_l2c_prefetch_show,
+			zynq_l2c_prefetch_store);
+static struct kobj_attribute zynq_l2c_aux_attr =
+	__ATTR(aux, 0444, zynq_l2c_aux_show, NULL);
+static struct kobj_attribute zynq_l2c_membench_attr =
+	__ATTR(membench, 0444, zynq_l2c_membench_show, NULL);
+
+static struct attribute *zynq_l2c_attrs[] = {
+	&zynq_l2c_prefetch_attr.attr,
+	&zynq_l2c_aux_attr.attr,
+	&zynq_l2c_membench_attr.attr,
+	NULL,
+};
+
+static struct attribute_group zynq_l2c_attr_group = {
+	.attrs = zynq_l2c_attrs,
+};
+
+static int __init zynq_l2c_sysfs_init(void)
+{
+	struct kobject *kobj;
+	int ret;
+
+	if (!zynq_l2c_base)
+		return 0;
+
+	kobj = kobject_create_and_add("zynq_l2c", kernel_kobj);
+	if (!kobj)
+		return -ENOMEM;
+
+	ret = sysfs_create_group(kobj, &zynq_l2c_attr_group);
+	if (ret) {
+		kobject_put(kobj);
+		return ret;
+	}
+
+	pr_info("zynq: L2C memcpy bandwidth %u KB/s (prefetch 0x%08x)\n",
+		zynq_l2c_membench(),
+		readl_relaxed(zynq_l2c_base + L2X0_PREFETCH_CTRL));
+
+	return 0;
+}
+late_initcall(zynq_l2c_sysfs_init);
+#endif
+
+#ifdef CONFIG_ZYNQ_OCM_RAMOOPS
+/*
+ * Persistent kernel log at the top of the OCM. Unlike DRAM the OCM
+ * keeps its contents across warm and watchdog resets, so oops/panic
+ * dumps and the console and ftrace tails written there by ramoops can
+ * be read back from /sys/fs/pstore after the reboot.
+ */
+static struct ramoops_platform_data zynq_ramoops_data = {
+	.mem_size	= ZYNQ_RAMOOPS_SIZE,
+	.record_size	= SZ_16K,
+	.console_size	= SZ_16K,
+	.ftrace_size	= SZ_16K,
+	.dump_oops	= 1,
+};
+
+static struct platform_device zynq_ramoops_device = {
+	.name	= "ramoops",
+	.id	= -1,
+	.dev	= {
+		.platform_data = &zynq_ramoops_data,
+	},
+};
+
+static void __init zynq_ramoops_init(const struct resource *res)
+{
+	zynq_ramoops_data.mem_address = res->end + 1 - ZYNQ_RAMOOPS_SIZE;
+
+	if (platform_device_register(&zynq_ramoops_device)) {
+		pr_warn("%s: unable to register ramoops device\n", __func__);
+		return;
+	}
+
+	pr_info("zynq: %u KB ramoops area at 0x%x\n",
+		(u32)(ZYNQ_RAMOOPS_SIZE / SZ_1K),
+		(u32)zynq_ramoops_data.mem_address);
+}
+#else
+static inline void zynq_ramoops_init(const struct resource *res) { }
 #endif
 
+/*
+ * The bottom of the OCM is borrowed by the suspend code in pm.c, which
+ * copies itself there while DRAM is unavailable. Keep that area out of
+ * the pool so no DMA buffer can live where it would be overwritten.
+ */
+#define ZYNQ_OCM_RESERVED	SZ_4K
+
+/* Hand out cache line sized chunks at minimum */
+#define ZYNQ_OCM_MIN_ORDER	5
+
+static struct gen_pool *zynq_ocm_pool;
+
+/**
+ * zynq_ocm_pool_get() - Get the allocation pool for the on-chip memory
+ * Returns the gen_pool backing the OCM, or NULL if it is unavailable.
+ *
+ * The OCM has a far lower access latency than DDR for both the A9 and
+ * the PS DMA masters. Drivers can opt in to placing small latency
+ * critical buffers, such as DMA descriptor rings, in OCM by allocating
+ * from this pool and translating the returned address with
+ * gen_pool_virt_to_phys(). The pool memory is mapped uncached, so no
+ * cache maintenance is needed around DMA.
+ */
+struct gen_pool *zynq_ocm_pool_get(void)
+{
+	return zynq_ocm_pool;
+}
+EXPORT_SYMBOL_GPL(zynq_ocm_pool_get);
+
+static int __init zynq_ocm_pool_init(void)
+{
+	struct device_node *np;
+	struct resource res;
+	struct gen_pool *pool;
+	void __iomem *base;
+	int ret;
+
+	np = of_find_compatible_node(NULL, NULL, "xlnx,ps7-ocm");
+	if (!np)
+		return 0;
+
+	ret = of_address_to_resource(np, 0, &res);
+	of_node_put(np);
+	if (ret)
+		return ret;
+
+	if (resource_size(&res) <
+			ZYNQ_OCM_RESERVED + ZYNQ_RAMOOPS_SIZE + SZ_4K) {
+		pr_warn("%s: OCM too small\n", __func__);
+		return 0;
+	}
+
+	zynq_ramoops_init(&res);
+
+	base = ioremap_nocache(res.start, resource_size(&res));
+	if (!base) {
+		pr_warn("%s: Unable to map OCM.\n", __func__);
+		return -ENOMEM;
+	}
+
+	pool = gen_pool_create(ZYNQ_OCM_MIN_ORDER, -1);
+	if (!pool) {
+		iounmap(base);
+		return -ENOMEM;
+	}
+
+	/* Skip the suspend area at the bottom and the ramoops carve-out
+	 * at the top.
+	 */
+	ret = gen_pool_add_virt(pool,
+			(unsigned long)base + ZYNQ_OCM_RESERVED,
+			res.start + ZYNQ_OCM_RESERVED,
+			resource_size(&res) - ZYNQ_OCM_RESERVED -
+			ZYNQ_RAMOOPS_SIZE, -1);
+	if (ret) {
+		gen_pool_destroy(pool);
+		iounmap(base);
+		return ret;
+	}
+
+	zynq_ocm_pool = pool;
+	pr_info("zynq: %u KB OCM pool at 0x%x\n",
+		(u32)(resource_size(&res) - ZYNQ_OCM_RESERVED -
+		      ZYNQ_RAMOOPS_SIZE) / SZ_1K,
+		(u32)(res.start + ZYNQ_OCM_RESERVED));
+
+	return 0;
+}
+core_initcall(zynq_ocm_pool_init);
+
 
 #ifdef CONFIG_XILINX_L1_PREFETCH
 static void __init zynq_data_prefetch_enable(void *info)
@@ -149,21 +505,110 @@ static void __init zynq_init_late(void)
 #endif
 }
 
+/*
+ * PL masters attached through the ACP snoop the A9 caches, so the
+ * streaming DMA API must not spend time on cache maintenance for
+ * their transfers. A device declares an ACP attachment with the
+ * "dma-coherent" property on its node; switch such devices to the
+ * coherent DMA ops before any driver binds and maps buffers.
+ */
+static int zynq_dma_coherent_notifier(struct notifier_block *nb,
+		unsigned long action, void *data)
+{
+	struct device *dev = data;
+
+	if (action != BUS_NOTIFY_ADD_DEVICE)
+		return NOTIFY_DONE;
+
+	if (dev->of_node &&
+	    of_get_property(dev->of_node, "dma-coherent", NULL))
+		set_dma_ops(dev, &arm_coherent_dma_ops);
+
+	return NOTIFY_OK;
+}
+
+static struct notifier_block zynq_dma_coherent_nb = {
+	.notifier_call = zynq_dma_coherent_notifier,
+};
+
 /**
  * zynq_init_machine - System specific initialization, intended to be
  *		       called from board specific initialization.
  */
 static void __init zynq_init_machine(void)
 {
+	bus_register_notifier(&platform_bus_type, &zynq_dma_coherent_nb);
 	of_platform_populate(NULL, of_default_bus_match_table, NULL, NULL);
 }
 
+/**
+ * zynq_global_timer_init - Register the A9 global timer
+ *
+ * Device trees in the field predate the global timer binding, so when
+ * no node is present the timer is set up from the architecturally
+ * defined offset from the SCU (CBAR + 0x200). It shares PERIPHCLK
+ * with the TWD.
+ */
+static void __init zynq_global_timer_init(void)
+{
+	phys_addr_t phys;
+	void __iomem *base;
+	struct clk *clk;
+
+	if (of_find_compatible_node(NULL, NULL, "arm,cortex-a9-global-timer"))
+		return;	/* handled by clocksource_of_init() */
+
+	phys = scu_a9_get_base() + 0x200;
+	base = ioremap(phys, SZ_256);
+	if (WARN_ON(!base))
+		return;
+
+	clk = clk_get_sys("smp_twd", NULL);
+	if (WARN_ON(IS_ERR(clk))) {
+		iounmap(base);
+		return;
+	}
+
+	arm_global_timer_init(base, phys, clk);
+}
+
 static void __init zynq_timer_init(void)
 {
 	zynq_slcr_init();
+	zynq_global_timer_init();
 	clocksource_of_init();
 }
 
+/*
+ * Section-mapped windows over the PS peripherals. ioremap() reuses
+ * static mappings of the same type, so every driver mapping a register
+ * block inside these windows gets a pointer into them instead of a new
+ * page-mapped vmalloc area: all peripheral MMIO is then covered by a
+ * handful of 1MB TLB entries that don't thrash against application
+ * pages. The virtual addresses only need to be fixed, unused and
+ * below VMALLOC_END.
+ */
+#define ZYNQ_IOP_PHYS		0xe0000000	/* UART, GEM, SDIO, SPI, ... */
+#define ZYNQ_IOP_VIRT		0xfe000000
+#define ZYNQ_IOP_SIZE		SZ_2M		/* covers 0xe00xxxxx and 0xe01xxxxx */
+#define ZYNQ_SYSREGS_PHYS	0xf8000000	/* SLCR, TTC, DMAC, SWDT, devcfg */
+#define ZYNQ_SYSREGS_VIRT	0xfe200000
+#define ZYNQ_SYSREGS_SIZE	SZ_1M
+
+static struct map_desc zynq_io_map[] __initdata = {
+	{
+		.virtual	= ZYNQ_IOP_VIRT,
+		.pfn		= __phys_to_pfn(ZYNQ_IOP_PHYS),
+		.length		= ZYNQ_IOP_SIZE,
+		.type		= MT_DEVICE,
+	}, {
+		.virtual	= ZYNQ_SYSREGS_VIRT,
+		.pfn		= __phys_to_pfn(ZYNQ_SYSREGS_PHYS),
+		.length		= ZYNQ_SYSREGS_SIZE,
+		.type		= MT_DEVICE,
+	},
+};
+
 static struct map_desc zynq_cortex_a9_scu_map __initdata = {
 	.length	= SZ_256,
 	.type	= MT_DEVICE,
@@ -188,6 +633,7 @@ static void __init zynq_scu_map_io(void)
 static void __init zynq_map_io(void)
 {
 	debug_ll_io_init();
+	iotable_init(zynq_io_map, ARRAY_SIZE(zynq_io_map));
 	zynq_scu_map_io();
 }
 
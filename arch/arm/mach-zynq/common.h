@@ -17,6 +17,18 @@
 #ifndef __MACH_ZYNQ_COMMON_H__
 #define __MACH_ZYNQ_COMMON_H__
 
+#include <linux/sizes.h>
+
+/*
+ * Size of the ramoops carve-out at the top of the OCM. The rest of the
+ * OCM (allocation pool, suspend code) must keep clear of it.
+ */
+#ifdef CONFIG_ZYNQ_OCM_RAMOOPS
+#define ZYNQ_RAMOOPS_SIZE	SZ_64K
+#else
+#define ZYNQ_RAMOOPS_SIZE	0
+#endif
+
 extern void xslcr_write(u32 val, u32 offset);
 extern u32 xslcr_read(u32 offset);
 
@@ -43,6 +55,17 @@ extern void __iomem *zynq_scu_base;
 /* Hotplug */
 extern void zynq_platform_cpu_die(unsigned int cpu);
 
+extern void zynq_l2c_standby_enable(void);
+
+#ifdef CONFIG_SUSPEND
+int zynq_pm_ddrc_selfrefresh(bool enable);
+#else
+static inline int zynq_pm_ddrc_selfrefresh(bool enable)
+{
+	return -ENODEV;
+}
+#endif
+
 #ifdef CONFIG_SUSPEND
 int zynq_pm_late_init(void);
 #else
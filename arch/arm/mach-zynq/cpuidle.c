@@ -7,15 +7,19 @@
  * License version 2.  This program is licensed "as is" without any
  * warranty of any kind, whether express or implied.
  *
- * The cpu idle uses wait-for-interrupt and RAM self refresh in order
- * to implement two idle states -
+ * The cpu idle uses wait-for-interrupt, L2 standby and RAM self
+ * refresh in order to implement three idle states -
  * #1 wait-for-interrupt
- * #2 wait-for-interrupt and RAM self refresh
+ * #2 wait-for-interrupt with L2 retention (PL310 standby mode gates
+ *    the L2 clock while both CPUs sleep, contents are kept)
+ * #3 like #2, with the DDR controller additionally allowed to put the
+ *    DRAM into self-refresh and stop its clock while it is idle
  *
- * Note that this code is only intended as a prototype and is not tested
- * well yet, or tuned for the Xilinx Cortex A9. Also note that for a
- * tickless kernel, high res timers must not be turned on. The cpuidle
- * framework must also be turned on in the kernel.
+ * The states carry honest exit latencies: the retention states pay
+ * for the cpu_pm notifier chain (GIC and VFP state) on top of the
+ * wakeup itself, and leaving self-refresh includes the DRAM DLL
+ * relock. The actual time spent in a state is measured and reported
+ * through last_residency, so the governor's picture stays accurate.
  */
 
 #include <linux/kernel.h>
@@ -29,8 +33,9 @@
 #include <linux/clk.h>
 #include <linux/err.h>
 #include <asm/proc-fns.h>
+#include "common.h"
 
-#define XILINX_MAX_STATES	1
+#define XILINX_MAX_STATES	3
 
 static DEFINE_PER_CPU(struct cpuidle_device, xilinx_cpuidle_device);
 
@@ -44,24 +49,40 @@ static int xilinx_enter_idle(struct cpuidle_device *dev,
 	local_irq_disable();
 	do_gettimeofday(&before);
 
-	if (index == 0)
+	if (index == 0) {
 		/* Wait for interrupt state */
 		cpu_do_idle();
-
-	else if (index == 1) {
+	} else {
 		unsigned int cpu_id = smp_processor_id();
+		bool ddr_sr = false;
 
 		clockevents_notify(CLOCK_EVT_NOTIFY_BROADCAST_ENTER, &cpu_id);
 
 		/* Devices must be stopped here */
 		cpu_pm_enter();
 
-		/* Add code for DDR self refresh start */
-
+		/*
+		 * The self-refresh mode is hardware-managed: the DDRC
+		 * enters it when no master has outstanding requests
+		 * and leaves it on the next access, so it is safe even
+		 * while the other CPU or PL masters are still running.
+		 * When the DDRC is not mapped (suspend support came up
+		 * without it) the state silently demotes to retention.
+		 */
+		if (index == 2)
+			ddr_sr = !zynq_pm_ddrc_selfrefresh(true);
+
+		/*
+		 * With PL310 standby mode enabled at init time the L2
+		 * clock gates as soon as both CPUs are in WFI; the
+		 * cache keeps its contents, so nothing needs flushing.
+		 */
 		cpu_do_idle();
-		/*cpu_suspend(foo, bar);*/
 
-		/* Add code for DDR self refresh stop */
+		if (ddr_sr)
+			zynq_pm_ddrc_selfrefresh(false);
+		else if (index == 2)
+			index = 1;
 
 		cpu_pm_exit();
 
@@ -85,19 +106,37 @@ static struct cpuidle_driver xilinx_idle_driver = {
 	.states[0] = {
 		.enter = xilinx_enter_idle,
 		.exit_latency = 1,
-		.target_residency = 10000,
+		.target_residency = 10,
 		.flags = CPUIDLE_FLAG_TIME_VALID,
 		.name = "WFI",
 		.desc = "Wait for interrupt",
 	},
-	/* Wait for interrupt and RAM self refresh state */
+	/*
+	 * Exit pays for the cpu_pm notifier chain restoring GIC and
+	 * VFP state on top of the wakeup itself; the residency is set
+	 * where that overhead amortizes against the gated L2 clock.
+	 */
 	.states[1] = {
 		.enter = xilinx_enter_idle,
-		.exit_latency = 10,
-		.target_residency = 10000,
+		.exit_latency = 30,
+		.target_residency = 300,
+		.flags = CPUIDLE_FLAG_TIME_VALID,
+		.name = "L2_RET",
+		.desc = "WFI with L2 retention",
+	},
+	/*
+	 * On top of the retention exit the first DRAM access after
+	 * wakeup stalls for self-refresh exit and the DLL relock
+	 * (tXSRD, around 200 memory clocks), so this state only pays
+	 * off for sleeps in the millisecond range.
+	 */
+	.states[2] = {
+		.enter = xilinx_enter_idle,
+		.exit_latency = 150,
+		.target_residency = 3000,
 		.flags = CPUIDLE_FLAG_TIME_VALID,
-		.name = "RAM_SR",
-		.desc = "WFI and RAM Self Refresh",
+		.name = "DDR_SR",
+		.desc = "WFI with L2 retention and DDR self refresh",
 	},
 };
 
@@ -108,6 +147,12 @@ static int xilinx_init_cpuidle(void)
 	struct cpuidle_device *device;
 	int ret;
 
+	/*
+	 * Let the L2 clock gate whenever both CPUs sleep; this is what
+	 * makes the retention states save power beyond plain WFI.
+	 */
+	zynq_l2c_standby_enable();
+
 	ret = cpuidle_register_driver(&xilinx_idle_driver);
 	if (ret) {
 		pr_err("Registering Xilinx CpuIdle Driver failed.\n");
@@ -0,0 +1,324 @@
+/*
+ * DDR controller port arbitration tuning for Zynq
+ *
+ *  Copyright (C) 2013 Xilinx
+ *
+ * The DDRC arbitrates between four AXI ports:
+ *
+ *	port 0	CPUs and ACP (through the SCU/L2)
+ *	port 1	central interconnect masters (GEM, USB, peripherals)
+ *	port 2	AXI_HP0 and AXI_HP1 from the PL
+ *	port 3	AXI_HP2 and AXI_HP3 from the PL
+ *
+ * Each port has a per-direction arbitration priority in the DDRC, and
+ * each AXI_HP interface additionally has per-direction outstanding
+ * transaction limits in its AFI block. Both are exposed through sysfs
+ * so latency-critical masters (a display VDMA read channel, for
+ * instance) can be guaranteed bandwidth under CPU load, with optional
+ * device tree properties providing boot-time defaults.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <linux/init.h>
+#include <linux/io.h>
+#include <linux/kernel.h>
+#include <linux/of.h>
+#include <linux/platform_device.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include "common.h"
+
+/* DDRC arbiter registers */
+#define DDRC_PAGE_MASK_OFFSET		0x200
+#define DDRC_AXI_PRI_WR_PORT_OFFSET(n)	(0x204 + 4 * (n))
+#define DDRC_AXI_PRI_RD_PORT_OFFSET(n)	(0x214 + 4 * (n))
+
+#define DDRC_AXI_PRI_MASK		0x3ff
+#define DDRC_NUM_PORTS			4
+
+/* AFI (AXI_HP) registers */
+#define AFI_RDCHAN_ISSUINGCAP_OFFSET	0x04
+#define AFI_WRCHAN_ISSUINGCAP_OFFSET	0x18
+
+#define AFI_ISSUINGCAP_MASK		0x7
+
+/**
+ * struct ddrc_qos - driver data for one DDRC or AFI instance.
+ * @regs:	base address of the block.
+ * @lock:	protects read-modify-write of the QoS registers.
+ */
+struct ddrc_qos {
+	void __iomem	*regs;
+	spinlock_t	lock;
+};
+
+/**
+ * struct ddrc_qos_attr - a sysfs attribute tied to one register field.
+ * @attr:	embedded device attribute.
+ * @offset:	register offset of the field.
+ * @mask:	field mask, field occupies the low bits.
+ */
+struct ddrc_qos_attr {
+	struct device_attribute	attr;
+	u32			offset;
+	u32			mask;
+};
+
+#define to_qos_attr(a) container_of(a, struct ddrc_qos_attr, attr)
+
+static ssize_t ddrc_qos_show(struct device *dev,
+			     struct device_attribute *attr, char *buf)
+{
+	struct ddrc_qos *qos = dev_get_drvdata(dev);
+	struct ddrc_qos_attr *qattr = to_qos_attr(attr);
+	u32 reg = readl(qos->regs + qattr->offset);
+
+	return sprintf(buf, "%u\n", reg & qattr->mask);
+}
+
+static ssize_t ddrc_qos_store(struct device *dev,
+			      struct device_attribute *attr,
+			      const char *buf, size_t size)
+{
+	struct ddrc_qos *qos = dev_get_drvdata(dev);
+	struct ddrc_qos_attr *qattr = to_qos_attr(attr);
+	unsigned long flags;
+	unsigned int val;
+	u32 reg;
+	int ret;
+
+	ret = kstrtouint(buf, 0, &val);
+	if (ret)
+		return ret;
+	if (val > qattr->mask)
+		return -EINVAL;
+
+	spin_lock_irqsave(&qos->lock, flags);
+	reg = readl(qos->regs + qattr->offset);
+	reg = (reg & ~qattr->mask) | val;
+	writel(reg, qos->regs + qattr->offset);
+	spin_unlock_irqrestore(&qos->lock, flags);
+
+	return size;
+}
+
+#define DDRC_QOS_ATTR(_name, _offset, _mask)				\
+	struct ddrc_qos_attr dev_attr_##_name = {			\
+		__ATTR(_name, 0644, ddrc_qos_show, ddrc_qos_store),	\
+		_offset, _mask }
+
+/*
+ * DDRC arbitration priorities, one per port and direction. Lower
+ * values win arbitration; the hardware default is 0x3ff (lowest).
+ */
+static DDRC_QOS_ATTR(rd_port0_priority,
+		     DDRC_AXI_PRI_RD_PORT_OFFSET(0), DDRC_AXI_PRI_MASK);
+static DDRC_QOS_ATTR(rd_port1_priority,
+		     DDRC_AXI_PRI_RD_PORT_OFFSET(1), DDRC_AXI_PRI_MASK);
+static DDRC_QOS_ATTR(rd_port2_priority,
+		     DDRC_AXI_PRI_RD_PORT_OFFSET(2), DDRC_AXI_PRI_MASK);
+static DDRC_QOS_ATTR(rd_port3_priority,
+		     DDRC_AXI_PRI_RD_PORT_OFFSET(3), DDRC_AXI_PRI_MASK);
+static DDRC_QOS_ATTR(wr_port0_priority,
+		     DDRC_AXI_PRI_WR_PORT_OFFSET(0), DDRC_AXI_PRI_MASK);
+static DDRC_QOS_ATTR(wr_port1_priority,
+		     DDRC_AXI_PRI_WR_PORT_OFFSET(1), DDRC_AXI_PRI_MASK);
+static DDRC_QOS_ATTR(wr_port2_priority,
+		     DDRC_AXI_PRI_WR_PORT_OFFSET(2), DDRC_AXI_PRI_MASK);
+static DDRC_QOS_ATTR(wr_port3_priority,
+		     DDRC_AXI_PRI_WR_PORT_OFFSET(3), DDRC_AXI_PRI_MASK);
+
+static struct attribute *ddrc_qos_attrs[] = {
+	&dev_attr_rd_port0_priority.attr.attr,
+	&dev_attr_rd_port1_priority.attr.attr,
+	&dev_attr_rd_port2_priority.attr.attr,
+	&dev_attr_rd_port3_priority.attr.attr,
+	&dev_attr_wr_port0_priority.attr.attr,
+	&dev_attr_wr_port1_priority.attr.attr,
+	&dev_attr_wr_port2_priority.attr.attr,
+	&dev_attr_wr_port3_priority.attr.attr,
+	NULL,
+};
+
+static const struct attribute_group ddrc_qos_attr_group = {
+	.name = "qos",
+	.attrs = ddrc_qos_attrs,
+};
+
+/*
+ * AFI outstanding transaction limits, one pair per AXI_HP interface.
+ * The issuing capability encoding is defined by the TRM; smaller
+ * values allow fewer commands in flight and reduce the worst-case
+ * queueing delay the port can impose on others.
+ */
+static DDRC_QOS_ATTR(rd_issuing_cap,
+		     AFI_RDCHAN_ISSUINGCAP_OFFSET, AFI_ISSUINGCAP_MASK);
+static DDRC_QOS_ATTR(wr_issuing_cap,
+		     AFI_WRCHAN_ISSUINGCAP_OFFSET, AFI_ISSUINGCAP_MASK);
+
+static struct attribute *afi_qos_attrs[] = {
+	&dev_attr_rd_issuing_cap.attr.attr,
+	&dev_attr_wr_issuing_cap.attr.attr,
+	NULL,
+};
+
+static const struct attribute_group afi_qos_attr_group = {
+	.name = "qos",
+	.attrs = afi_qos_attrs,
+};
+
+/**
+ * ddrc_qos_apply_dt_field - Apply one optional device tree default.
+ *
+ * @qos:	instance to program.
+ * @np:		device node carrying the property.
+ * @propname:	name of an optional u32 property.
+ * @offset:	register offset of the field.
+ * @mask:	field mask.
+ **/
+static void ddrc_qos_apply_dt_field(struct ddrc_qos *qos,
+				    struct device_node *np,
+				    const char *propname, u32 offset, u32 mask)
+{
+	u32 val;
+
+	if (of_property_read_u32(np, propname, &val))
+		return;
+	if (val > mask)
+		return;
+
+	writel((readl(qos->regs + offset) & ~mask) | val, qos->regs + offset);
+}
+
+static int ddrc_qos_probe(struct platform_device *pdev)
+{
+	static const char * const rd_props[DDRC_NUM_PORTS] = {
+		"xlnx,arb-pri-rd-port0", "xlnx,arb-pri-rd-port1",
+		"xlnx,arb-pri-rd-port2", "xlnx,arb-pri-rd-port3",
+	};
+	static const char * const wr_props[DDRC_NUM_PORTS] = {
+		"xlnx,arb-pri-wr-port0", "xlnx,arb-pri-wr-port1",
+		"xlnx,arb-pri-wr-port2", "xlnx,arb-pri-wr-port3",
+	};
+	struct ddrc_qos *qos;
+	struct resource *res;
+	int i;
+
+	qos = devm_kzalloc(&pdev->dev, sizeof(*qos), GFP_KERNEL);
+	if (!qos)
+		return -ENOMEM;
+
+	res = platform_get_resource(pdev, IORESOURCE_MEM, 0);
+	qos->regs = devm_ioremap_resource(&pdev->dev, res);
+	if (IS_ERR(qos->regs))
+		return PTR_ERR(qos->regs);
+
+	spin_lock_init(&qos->lock);
+	platform_set_drvdata(pdev, qos);
+
+	for (i = 0; i < DDRC_NUM_PORTS; i++) {
+		ddrc_qos_apply_dt_field(qos, pdev->dev.of_node, rd_props[i],
+					DDRC_AXI_PRI_RD_PORT_OFFSET(i),
+					DDRC_AXI_PRI_MASK);
+		ddrc_qos_apply_dt_field(qos, pdev->dev.of_node, wr_props[i],
+					DDRC_AXI_PRI_WR_PORT_OFFSET(i),
+					DDRC_AXI_PRI_MASK);
+	}
+
+	return sysfs_create_group(&pdev->dev.kobj, &ddrc_qos_attr_group);
+}
+
+static int ddrc_qos_remove(struct platform_device *pdev)
+{
+	sysfs_remove_group(&pdev->dev.kobj, &ddrc_qos_attr_group);
+	return 0;
+}
+
+static const struct of_device_id ddrc_qos_of_match[] = {
+	{ .compatible = "xlnx,ps7-ddrc" },
+	{ .compatible = "xlnx,ps7-ddrc-1.00.a" },
+	{ /* end of table */ }
+};
+
+static struct platform_driver ddrc_qos_driver = {
+	.probe	= ddrc_qos_probe,
+	.remove	= ddrc_qos_remove,
+	.driver	= {
+		.name		= "zynq-ddrc-qos",
+		.owner		= THIS_MODULE,
+		.of_match_table	= ddrc_qos_of_match,
+	},
+};
+
+static int afi_qos_probe(struct platform_device *pdev)
+{
+	struct ddrc_qos *qos;
+	struct resource *res;
+
+	qos = devm_kzalloc(&pdev->dev, sizeof(*qos), GFP_KERNEL);
+	if (!qos)
+		return -ENOMEM;
+
+	res = platform_get_resource(pdev, IORESOURCE_MEM, 0);
+	qos->regs = devm_ioremap_resource(&pdev->dev, res);
+	if (IS_ERR(qos->regs))
+		return PTR_ERR(qos->regs);
+
+	spin_lock_init(&qos->lock);
+	platform_set_drvdata(pdev, qos);
+
+	ddrc_qos_apply_dt_field(qos, pdev->dev.of_node, "xlnx,rd-issuing-cap",
+				AFI_RDCHAN_ISSUINGCAP_OFFSET,
+				AFI_ISSUINGCAP_MASK);
+	ddrc_qos_apply_dt_field(qos, pdev->dev.of_node, "xlnx,wr-issuing-cap",
+				AFI_WRCHAN_ISSUINGCAP_OFFSET,
+				AFI_ISSUINGCAP_MASK);
+
+	return sysfs_create_group(&pdev->dev.kobj, &afi_qos_attr_group);
+}
+
+static int afi_qos_remove(struct platform_device *pdev)
+{
+	sysfs_remove_group(&pdev->dev.kobj, &afi_qos_attr_group);
+	return 0;
+}
+
+static const struct of_device_id afi_qos_of_match[] = {
+	{ .compatible = "xlnx,ps7-afi" },
+	{ .compatible = "xlnx,ps7-afi-1.00.a" },
+	{ /* end of table */ }
+};
+
+static struct platform_driver afi_qos_driver = {
+	.probe	= afi_qos_probe,
+	.remove	= afi_qos_remove,
+	.driver	= {
+		.name		= "zynq-afi-qos",
+		.owner		= THIS_MODULE,
+		.of_match_table	= afi_qos_of_match,
+	},
+};
+
+static int __init ddrc_qos_init(void)
+{
+	int ret;
+
+	ret = platform_driver_register(&ddrc_qos_driver);
+	if (ret)
+		return ret;
+
+	ret = platform_driver_register(&afi_qos_driver);
+	if (ret)
+		platform_driver_unregister(&ddrc_qos_driver);
+	return ret;
+}
+device_initcall(ddrc_qos_init);
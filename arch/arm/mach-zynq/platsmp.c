@@ -34,6 +34,16 @@
  */
 static int ncores;
 
+/*
+ * Mapping of the jump vectors at physical address 0x0 and whether the
+ * trampoline code has already been copied there. Both survive across
+ * CPU starts, so repeated stop/start cycles (AMP/SMP repurposing of
+ * CPU1) only rewrite the 4-byte jump address instead of remapping and
+ * recopying everything and flushing the whole cache each time.
+ */
+static u8 __iomem *zynq_boot_vectors;
+static bool zynq_trampoline_cached;
+
 /* Secondary CPU kernel startup is a 2 step process. The primary CPU
  * starts the secondary CPU by giving it the address of the kernel and
  * then sending it an event to wake it up. The secondary CPU then
@@ -62,21 +72,23 @@ int __cpuinit zynq_cpun_start(u32 address, int cpu)
 	/* MS: Expectation that SLCR are directly map and accessible */
 	/* Not possible to jump to non aligned address */
 	if (!(address & 3) && (!address || (address >= trampoline_code_size))) {
-		/* Store pointer to ioremap area which points to address 0x0 */
-		static u8 __iomem *zero;
 		u32 trampoline_size = &zynq_secondary_trampoline_jump -
 						&zynq_secondary_trampoline;
 
 		zynq_slcr_cpu_stop(cpu);
 		if (address) {
-			if (__pa(PAGE_OFFSET)) {
-				zero = ioremap(0, trampoline_code_size);
-				if (!zero) {
-					pr_warn("BOOTUP jump vectors not accessible\n");
-					return -1;
+			if (!zynq_boot_vectors) {
+				if (__pa(PAGE_OFFSET)) {
+					zynq_boot_vectors = ioremap(0,
+							trampoline_code_size);
+					if (!zynq_boot_vectors) {
+						pr_warn("BOOTUP jump vectors not accessible\n");
+						return -1;
+					}
+				} else {
+					zynq_boot_vectors =
+						(__force u8 __iomem *)PAGE_OFFSET;
 				}
-			} else {
-				zero = (__force u8 __iomem *)PAGE_OFFSET;
 			}
 
 			/*
@@ -85,16 +97,25 @@ int __cpuinit zynq_cpun_start(u32 address, int cpu)
 			* 0x4: Jump by mov instruction
 			* 0x8: Jumping address
 			*/
-			memcpy((__force void *)zero, &zynq_secondary_trampoline,
-							trampoline_size);
-			writel(address, zero + trampoline_size);
+			if (!zynq_trampoline_cached) {
+				memcpy((__force void *)zynq_boot_vectors,
+				       &zynq_secondary_trampoline,
+				       trampoline_size);
+				zynq_trampoline_cached = true;
+			}
+			writel(address, zynq_boot_vectors + trampoline_size);
 
-			flush_cache_all();
+			/*
+			 * Push the trampoline out to memory. Only the jump
+			 * address changes on repeat starts, so a ranged
+			 * clean is enough; flushing all of L1 here cost
+			 * milliseconds on every CPU1 mode switch.
+			 */
+			__cpuc_flush_dcache_area(
+				(__force void *)zynq_boot_vectors,
+				trampoline_code_size);
 			outer_flush_range(0, trampoline_code_size);
 			smp_wmb();
-
-			if (__pa(PAGE_OFFSET))
-				iounmap(zero);
 		}
 		zynq_slcr_cpu_start(cpu);
 
@@ -48,6 +48,42 @@ static struct clk *cpupll;
 static void __iomem *ddrc_base;
 static void __iomem *ocm_base;
 
+/**
+ * zynq_pm_ddrc_selfrefresh() - Let the DDRC drop into self-refresh when idle
+ * @enable:	enable or disable the mode
+ * Returns 0 on success, -ENODEV when the DDRC is not mapped.
+ *
+ * With the bits set the controller enters self-refresh and stops the
+ * DRAM clock on its own whenever it has no pending transactions and
+ * leaves the mode transparently on the next access, so this is safe
+ * while other masters (the second CPU, PL logic) are still running;
+ * they simply keep the controller busy. Used by both suspend and the
+ * deepest cpuidle state.
+ */
+int zynq_pm_ddrc_selfrefresh(bool enable)
+{
+	u32 reg;
+
+	if (!ddrc_base)
+		return -ENODEV;
+
+	reg = readl(ddrc_base + DDRC_CTRL_REG1_OFFS);
+	if (enable)
+		reg |= DDRC_SELFREFRESH_MASK;
+	else
+		reg &= ~DDRC_SELFREFRESH_MASK;
+	writel(reg, ddrc_base + DDRC_CTRL_REG1_OFFS);
+
+	reg = readl(ddrc_base + DDRC_DRAM_PARAM_REG3_OFFS);
+	if (enable)
+		reg |= DDRC_CLOCKSTOP_MASK;
+	else
+		reg &= ~DDRC_CLOCKSTOP_MASK;
+	writel(reg, ddrc_base + DDRC_DRAM_PARAM_REG3_OFFS);
+
+	return 0;
+}
+
 static int zynq_pm_suspend(unsigned long arg)
 {
 	u32 reg;
@@ -61,17 +97,8 @@ static int zynq_pm_suspend(unsigned long arg)
 		do_ddrpll_bypass = 0;
 
 	/* Enable DDR self-refresh and clock stop */
-	if (ddrc_base) {
-		reg = readl(ddrc_base + DDRC_CTRL_REG1_OFFS);
-		reg |= DDRC_SELFREFRESH_MASK;
-		writel(reg, ddrc_base + DDRC_CTRL_REG1_OFFS);
-
-		reg = readl(ddrc_base + DDRC_DRAM_PARAM_REG3_OFFS);
-		reg |= DDRC_CLOCKSTOP_MASK;
-		writel(reg, ddrc_base + DDRC_DRAM_PARAM_REG3_OFFS);
-	} else {
+	if (zynq_pm_ddrc_selfrefresh(true))
 		do_ddrpll_bypass = 0;
-	}
 
 	/* SCU standby mode */
 	if (zynq_scu_base) {
@@ -177,15 +204,7 @@ static int zynq_pm_suspend(unsigned long arg)
 		      : "r12");
 
 	/* Disable DDR self-refresh and clock stop */
-	if (ddrc_base) {
-		reg = readl(ddrc_base + DDRC_CTRL_REG1_OFFS);
-		reg &= ~DDRC_SELFREFRESH_MASK;
-		writel(reg, ddrc_base + DDRC_CTRL_REG1_OFFS);
-
-		reg = readl(ddrc_base + DDRC_DRAM_PARAM_REG3_OFFS);
-		reg &= ~DDRC_CLOCKSTOP_MASK;
-		writel(reg, ddrc_base + DDRC_DRAM_PARAM_REG3_OFFS);
-	}
+	zynq_pm_ddrc_selfrefresh(false);
 
 	return 0;
 }
@@ -250,11 +269,16 @@ static void __iomem *zynq_pm_remap_ocm(void)
 
 	np = of_find_compatible_node(NULL, NULL, comp);
 	if (np) {
+		resource_size_t size;
+
 		if (of_address_to_resource(np, 0, &res))
 			return NULL;
-		WARN_ON(!request_mem_region(res.start, resource_size(&res),
-					"OCM"));
-		base = __arm_ioremap(res.start, resource_size(&res), MT_MEMORY);
+		/* The ramoops carve-out at the top of the OCM is claimed
+		 * by the persistent ram code; keep off it.
+		 */
+		size = resource_size(&res) - ZYNQ_RAMOOPS_SIZE;
+		WARN_ON(!request_mem_region(res.start, size, "OCM"));
+		base = __arm_ioremap(res.start, size, MT_MEMORY);
 		of_node_put(np);
 	} else {
 		pr_warn("%s: no compatible node found for '%s'\n", __func__,
@@ -14,6 +14,7 @@
  * 02139, USA.
  */
 
+#include <linux/delay.h>
 #include <linux/export.h>
 #include <linux/io.h>
 #include <linux/fs.h>
@@ -27,6 +28,7 @@
 #include <linux/slab.h>
 #include <linux/string.h>
 #include <linux/clk/zynq.h>
+#include <linux/zynq_fpga_reset.h>
 #include "common.h"
 
 #define DRIVER_NAME "xslcr"
@@ -1378,6 +1380,145 @@ void xslcr_init_postload_fpga(void)
 }
 EXPORT_SYMBOL(xslcr_init_postload_fpga);
 
+/* Bits of XSLCR_FPGA_RST_CTRL which are wired to PL reset lines */
+#define XSLCR_FPGA_RST_VALID_MASK	0x01F33F0F
+
+/* Bitmap of FPGA reset lines currently claimed by a driver */
+static u32 fpga_rst_claimed;
+
+/**
+ * zynq_fpga_reset_request - Claim one FPGA reset line for exclusive use.
+ *
+ * @line:	Bit position in FPGA_RST_CTRL (ZYNQ_FPGA_RST_*)
+ *
+ * Drivers must claim a line before asserting it, so that independent PL
+ * partitions cannot reset each other.
+ *
+ * return:	0 on success, -EINVAL for an invalid line or -EBUSY if the
+ *		line is already claimed.
+ **/
+int zynq_fpga_reset_request(unsigned int line)
+{
+	unsigned long flags;
+	int ret = 0;
+
+	if (line > 31 || !(XSLCR_FPGA_RST_VALID_MASK & (1 << line)))
+		return -EINVAL;
+
+	spin_lock_irqsave(&slcr->io_lock, flags);
+	if (fpga_rst_claimed & (1 << line))
+		ret = -EBUSY;
+	else
+		fpga_rst_claimed |= (1 << line);
+	spin_unlock_irqrestore(&slcr->io_lock, flags);
+
+	return ret;
+}
+EXPORT_SYMBOL(zynq_fpga_reset_request);
+
+/**
+ * zynq_fpga_reset_release - Release a claimed FPGA reset line.
+ *
+ * @line:	Bit position in FPGA_RST_CTRL (ZYNQ_FPGA_RST_*)
+ **/
+void zynq_fpga_reset_release(unsigned int line)
+{
+	unsigned long flags;
+
+	if (line > 31 || !(XSLCR_FPGA_RST_VALID_MASK & (1 << line)))
+		return;
+
+	spin_lock_irqsave(&slcr->io_lock, flags);
+	fpga_rst_claimed &= ~(1 << line);
+	spin_unlock_irqrestore(&slcr->io_lock, flags);
+}
+EXPORT_SYMBOL(zynq_fpga_reset_release);
+
+/**
+ * zynq_fpga_reset_ctrl - Assert or deassert one claimed FPGA reset line.
+ *
+ * @line:	Bit position in FPGA_RST_CTRL (ZYNQ_FPGA_RST_*)
+ * @assert:	Non-zero to put the line in reset, zero to release it
+ *
+ * Only the specified bit of FPGA_RST_CTRL is modified, so the rest of
+ * the PL is not disturbed.
+ *
+ * return:	0 on success, -EINVAL for an invalid line or -EPERM if the
+ *		line has not been claimed.
+ **/
+static int zynq_fpga_reset_ctrl(unsigned int line, int assert)
+{
+	unsigned long flags;
+	u32 reg;
+
+	if (line > 31 || !(XSLCR_FPGA_RST_VALID_MASK & (1 << line)))
+		return -EINVAL;
+
+	spin_lock_irqsave(&slcr->io_lock, flags);
+	if (!(fpga_rst_claimed & (1 << line))) {
+		spin_unlock_irqrestore(&slcr->io_lock, flags);
+		return -EPERM;
+	}
+
+	reg = xslcr_readreg(slcr->regs + XSLCR_FPGA_RST_CTRL_OFFSET);
+	if (assert)
+		reg |= (1 << line);
+	else
+		reg &= ~(1 << line);
+	xslcr_writereg(slcr->regs + XSLCR_FPGA_RST_CTRL_OFFSET, reg);
+	spin_unlock_irqrestore(&slcr->io_lock, flags);
+
+	return 0;
+}
+
+/**
+ * zynq_fpga_reset_assert - Put one claimed FPGA reset line in reset.
+ *
+ * @line:	Bit position in FPGA_RST_CTRL (ZYNQ_FPGA_RST_*)
+ *
+ * return:	0 on success or a negative error.
+ **/
+int zynq_fpga_reset_assert(unsigned int line)
+{
+	return zynq_fpga_reset_ctrl(line, 1);
+}
+EXPORT_SYMBOL(zynq_fpga_reset_assert);
+
+/**
+ * zynq_fpga_reset_deassert - Take one claimed FPGA reset line out of reset.
+ *
+ * @line:	Bit position in FPGA_RST_CTRL (ZYNQ_FPGA_RST_*)
+ *
+ * return:	0 on success or a negative error.
+ **/
+int zynq_fpga_reset_deassert(unsigned int line)
+{
+	return zynq_fpga_reset_ctrl(line, 0);
+}
+EXPORT_SYMBOL(zynq_fpga_reset_deassert);
+
+/**
+ * zynq_fpga_reset_pulse - Hard-reset the partition behind one reset line.
+ *
+ * @line:	Bit position in FPGA_RST_CTRL (ZYNQ_FPGA_RST_*)
+ *
+ * Asserts the line, holds it long enough for the reset to propagate
+ * through the PL fabric and deasserts it again.
+ *
+ * return:	0 on success or a negative error.
+ **/
+int zynq_fpga_reset_pulse(unsigned int line)
+{
+	int ret;
+
+	ret = zynq_fpga_reset_assert(line);
+	if (ret)
+		return ret;
+	udelay(1);
+	return zynq_fpga_reset_deassert(line);
+}
+EXPORT_SYMBOL(zynq_fpga_reset_pulse);
+
 /**
  * xslcr_set_bit - Set a bit
  *
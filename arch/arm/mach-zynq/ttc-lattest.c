@@ -0,0 +1,382 @@
+/*
+ * Interrupt latency self-test on the spare TTC channel
+ *
+ *  Copyright (C) 2013 Xilinx
+ *
+ * The Cadence TTC driver uses channels 1 and 2 of the first triple
+ * timer block for the clocksource and clockevent and leaves channel 3
+ * unused. This driver programs that channel as a periodic interrupt
+ * source and measures, for every expiry, how long the hard interrupt
+ * handler and the threaded handler took to run. The hard-IRQ delay is
+ * read straight off the channel counter, which restarts from zero at
+ * the moment the interval interrupt fires, so it is accurate to one
+ * timer tick and needs no calibration.
+ *
+ * The results are published as log2 histograms in debugfs:
+ *
+ *   zynq_ttc_lattest/period_us	test period; write 0 to stop
+ *   zynq_ttc_lattest/histogram	hard-IRQ and thread wakeup latencies
+ *
+ * Writing a new period restarts the test and clears the statistics.
+ * The cost while running is one interrupt plus one thread wakeup per
+ * period, small enough to leave enabled on production units as a
+ * permanent latency canary.
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <linux/clk.h>
+#include <linux/debugfs.h>
+#include <linux/interrupt.h>
+#include <linux/io.h>
+#include <linux/kernel.h>
+#include <linux/math64.h>
+#include <linux/mutex.h>
+#include <linux/of_address.h>
+#include <linux/of_irq.h>
+#include <linux/sched.h>
+#include <linux/seq_file.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/uaccess.h>
+
+/*
+ * Register offsets of the third timer channel. The channels are
+ * interleaved with a 4 byte stride, so these are the offsets used by
+ * cadence_ttc_timer.c plus 8.
+ */
+#define TTC3_CLK_CNTRL_OFFSET		0x08
+#define TTC3_CNT_CNTRL_OFFSET		0x14
+#define TTC3_COUNT_VAL_OFFSET		0x20
+#define TTC3_INTR_VAL_OFFSET		0x2C
+#define TTC3_ISR_OFFSET			0x5C
+#define TTC3_IER_OFFSET			0x68
+
+#define TTC3_CLK_CNTRL_PRESCALE_EN	0x1
+#define TTC3_CNT_CNTRL_DISABLE		0x1
+#define TTC3_CNT_CNTRL_INTERVAL		0x2
+#define TTC3_CNT_CNTRL_RESET		0x10
+#define TTC3_CNT_CNTRL_WAVE_DISABLE	0x20
+#define TTC3_IER_INTERVAL		0x1
+
+#define TTC_LATTEST_BUCKETS		16
+#define TTC_LATTEST_DEFAULT_US		1000
+
+/**
+ * struct ttc_lattest - latency self-test state
+ * @base:	base address of the TTC block, channel 3 registers used
+ * @clk:	input clock of the timer block
+ * @irq:	interval interrupt of channel 3
+ * @period_us:	current test period, 0 while the test is stopped
+ * @tick_rate:	channel tick rate after prescaling, in Hz
+ * @irq_ticks:	channel count sampled at hard-IRQ entry
+ * @irq_stamp:	local_clock() sampled at hard-IRQ entry
+ * @cfg_lock:	serializes start/stop against the debugfs writers
+ * @lock:	protects the statistics against concurrent readers
+ * @samples:	number of expiries recorded since the last restart
+ * @hardirq_max: worst hard-IRQ entry delay seen, in usecs
+ * @thread_max:	worst thread wakeup delay seen, in usecs
+ * @hardirq_hist: log2 histogram of hard-IRQ entry delays
+ * @thread_hist: log2 histogram of thread wakeup delays
+ */
+struct ttc_lattest {
+	void __iomem *base;
+	struct clk *clk;
+	int irq;
+	u32 period_us;
+	unsigned long tick_rate;
+	u32 irq_ticks;
+	u64 irq_stamp;
+	struct mutex cfg_lock;
+	spinlock_t lock;
+	u64 samples;
+	u32 hardirq_max;
+	u32 thread_max;
+	unsigned int hardirq_hist[TTC_LATTEST_BUCKETS];
+	unsigned int thread_hist[TTC_LATTEST_BUCKETS];
+};
+
+static unsigned int ttc_lattest_bucket(u32 us)
+{
+	unsigned int bucket = us ? fls(us) : 0;
+
+	return min_t(unsigned int, bucket, TTC_LATTEST_BUCKETS - 1);
+}
+
+static irqreturn_t ttc_lattest_isr(int irq, void *dev_id)
+{
+	struct ttc_lattest *lt = dev_id;
+
+	/*
+	 * The counter restarted from zero when the interval fired, so
+	 * its current value is the entry delay in timer ticks.
+	 */
+	lt->irq_ticks = __raw_readl(lt->base + TTC3_COUNT_VAL_OFFSET);
+	lt->irq_stamp = local_clock();
+	__raw_readl(lt->base + TTC3_ISR_OFFSET);	/* clears on read */
+
+	return IRQ_WAKE_THREAD;
+}
+
+static irqreturn_t ttc_lattest_thread(int irq, void *dev_id)
+{
+	struct ttc_lattest *lt = dev_id;
+	u64 thread_ns = local_clock() - lt->irq_stamp;
+	u32 hardirq_us, thread_us;
+
+	hardirq_us = div_u64((u64)lt->irq_ticks * USEC_PER_SEC,
+				lt->tick_rate);
+	thread_us = div_u64(thread_ns, NSEC_PER_USEC);
+
+	spin_lock_irq(&lt->lock);
+	lt->samples++;
+	lt->hardirq_hist[ttc_lattest_bucket(hardirq_us)]++;
+	lt->thread_hist[ttc_lattest_bucket(thread_us)]++;
+	if (hardirq_us > lt->hardirq_max)
+		lt->hardirq_max = hardirq_us;
+	if (thread_us > lt->thread_max)
+		lt->thread_max = thread_us;
+	spin_unlock_irq(&lt->lock);
+
+	return IRQ_HANDLED;
+}
+
+/* Called with cfg_lock held */
+static void ttc_lattest_stop(struct ttc_lattest *lt)
+{
+	u32 reg;
+
+	__raw_writel(0x0, lt->base + TTC3_IER_OFFSET);
+	reg = __raw_readl(lt->base + TTC3_CNT_CNTRL_OFFSET);
+	reg |= TTC3_CNT_CNTRL_DISABLE;
+	__raw_writel(reg, lt->base + TTC3_CNT_CNTRL_OFFSET);
+	lt->period_us = 0;
+}
+
+/* Called with cfg_lock held */
+static int ttc_lattest_start(struct ttc_lattest *lt, u32 period_us)
+{
+	unsigned long rate = clk_get_rate(lt->clk);
+	u64 ticks = div_u64((u64)rate * period_us, USEC_PER_SEC);
+	unsigned int exp = 0;
+
+	/*
+	 * The counter is 16 bits wide and the prescaler divides the
+	 * input clock by up to 2^16, picking the smallest divider that
+	 * makes the interval fit keeps the tick resolution as fine as
+	 * the requested period allows.
+	 */
+	while (ticks > 0xffff && exp < 16) {
+		ticks >>= 1;
+		exp++;
+	}
+	if (!ticks || ticks > 0xffff)
+		return -EINVAL;
+
+	ttc_lattest_stop(lt);
+
+	spin_lock_irq(&lt->lock);
+	lt->samples = 0;
+	lt->hardirq_max = 0;
+	lt->thread_max = 0;
+	memset(lt->hardirq_hist, 0, sizeof(lt->hardirq_hist));
+	memset(lt->thread_hist, 0, sizeof(lt->thread_hist));
+	spin_unlock_irq(&lt->lock);
+
+	lt->tick_rate = rate >> exp;
+
+	if (exp)
+		__raw_writel(((exp - 1) << 1) | TTC3_CLK_CNTRL_PRESCALE_EN,
+				lt->base + TTC3_CLK_CNTRL_OFFSET);
+	else
+		__raw_writel(0x0, lt->base + TTC3_CLK_CNTRL_OFFSET);
+	__raw_writel(ticks, lt->base + TTC3_INTR_VAL_OFFSET);
+	__raw_readl(lt->base + TTC3_ISR_OFFSET);	/* drop stale status */
+	__raw_writel(TTC3_IER_INTERVAL, lt->base + TTC3_IER_OFFSET);
+	__raw_writel(TTC3_CNT_CNTRL_INTERVAL | TTC3_CNT_CNTRL_RESET |
+			TTC3_CNT_CNTRL_WAVE_DISABLE,
+			lt->base + TTC3_CNT_CNTRL_OFFSET);
+
+	lt->period_us = period_us;
+
+	return 0;
+}
+
+static int ttc_lattest_period_show(struct seq_file *s, void *unused)
+{
+	struct ttc_lattest *lt = s->private;
+
+	seq_printf(s, "%u\n", lt->period_us);
+	return 0;
+}
+
+static int ttc_lattest_period_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ttc_lattest_period_show, inode->i_private);
+}
+
+static ssize_t ttc_lattest_period_write(struct file *file,
+		const char __user *buffer, size_t count, loff_t *ppos)
+{
+	struct ttc_lattest *lt =
+		((struct seq_file *)file->private_data)->private;
+	unsigned int period_us;
+	int err;
+
+	err = kstrtouint_from_user(buffer, count, 0, &period_us);
+	if (err)
+		return err;
+
+	mutex_lock(&lt->cfg_lock);
+	if (period_us)
+		err = ttc_lattest_start(lt, period_us);
+	else
+		ttc_lattest_stop(lt);
+	mutex_unlock(&lt->cfg_lock);
+
+	return err ? err : count;
+}
+
+static const struct file_operations ttc_lattest_period_fops = {
+	.open		= ttc_lattest_period_open,
+	.read		= seq_read,
+	.write		= ttc_lattest_period_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int ttc_lattest_hist_show(struct seq_file *s, void *unused)
+{
+	struct ttc_lattest *lt = s->private;
+	unsigned int hardirq_hist[TTC_LATTEST_BUCKETS];
+	unsigned int thread_hist[TTC_LATTEST_BUCKETS];
+	u32 hardirq_max, thread_max;
+	u64 samples;
+	int i;
+
+	spin_lock_irq(&lt->lock);
+	samples = lt->samples;
+	hardirq_max = lt->hardirq_max;
+	thread_max = lt->thread_max;
+	memcpy(hardirq_hist, lt->hardirq_hist, sizeof(hardirq_hist));
+	memcpy(thread_hist, lt->thread_hist, sizeof(thread_hist));
+	spin_unlock_irq(&lt->lock);
+
+	seq_printf(s, "samples: %llu\n", samples);
+	seq_printf(s, "hardirq_max_us: %u\n", hardirq_max);
+	seq_printf(s, "thread_max_us: %u\n", thread_max);
+	seq_printf(s, "%8s %10s %10s\n", "us<", "hardirq", "thread");
+	for (i = 0; i < TTC_LATTEST_BUCKETS; i++)
+		seq_printf(s, "%8u %10u %10u\n", 1U << i,
+				hardirq_hist[i], thread_hist[i]);
+
+	return 0;
+}
+
+static int ttc_lattest_hist_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, ttc_lattest_hist_show, inode->i_private);
+}
+
+static const struct file_operations ttc_lattest_hist_fops = {
+	.open		= ttc_lattest_hist_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init ttc_lattest_init(void)
+{
+	struct device_node *np;
+	struct ttc_lattest *lt;
+	struct dentry *dir;
+	int err;
+
+	/*
+	 * Use the same TTC block as the clocksource driver, which
+	 * consumes the first matching node and only channels 1 and 2
+	 * of it.
+	 */
+	np = of_find_compatible_node(NULL, NULL, "cdns,ttc");
+	if (!np)
+		np = of_find_compatible_node(NULL, NULL,
+						"xlnx,ps7-ttc-1.00.a");
+	if (!np)
+		return -ENODEV;
+
+	lt = kzalloc(sizeof(*lt), GFP_KERNEL);
+	if (!lt) {
+		of_node_put(np);
+		return -ENOMEM;
+	}
+
+	lt->base = of_iomap(np, 0);
+	lt->irq = irq_of_parse_and_map(np, 2);
+	of_node_put(np);
+	if (!lt->base || lt->irq <= 0) {
+		pr_err("ttc_lattest: channel 3 resources not available\n");
+		err = -ENODEV;
+		goto err_unmap;
+	}
+
+	lt->clk = clk_get_sys("CPU_1X_CLK", NULL);
+	if (IS_ERR(lt->clk)) {
+		pr_err("ttc_lattest: timer input clock not found\n");
+		err = PTR_ERR(lt->clk);
+		goto err_unmap;
+	}
+	err = clk_prepare_enable(lt->clk);
+	if (err)
+		goto err_clk_put;
+
+	mutex_init(&lt->cfg_lock);
+	spin_lock_init(&lt->lock);
+
+	/* make sure the channel is quiet before taking its interrupt */
+	ttc_lattest_stop(lt);
+
+	err = request_threaded_irq(lt->irq, ttc_lattest_isr,
+			ttc_lattest_thread, 0, "ttc_lattest", lt);
+	if (err)
+		goto err_clk_dis;
+
+	dir = debugfs_create_dir("zynq_ttc_lattest", NULL);
+	if (!dir) {
+		err = -ENOMEM;
+		goto err_free_irq;
+	}
+	debugfs_create_file("period_us", 0600, dir, lt,
+				&ttc_lattest_period_fops);
+	debugfs_create_file("histogram", 0400, dir, lt,
+				&ttc_lattest_hist_fops);
+
+	mutex_lock(&lt->cfg_lock);
+	err = ttc_lattest_start(lt, TTC_LATTEST_DEFAULT_US);
+	mutex_unlock(&lt->cfg_lock);
+	if (err)
+		pr_warn("ttc_lattest: not started, write period_us to arm\n");
+
+	pr_info("ttc_lattest: latency self-test on irq %d\n", lt->irq);
+
+	return 0;
+
+err_free_irq:
+	free_irq(lt->irq, lt);
+err_clk_dis:
+	clk_disable_unprepare(lt->clk);
+err_clk_put:
+	clk_put(lt->clk);
+err_unmap:
+	if (lt->base)
+		iounmap(lt->base);
+	kfree(lt);
+	return err;
+}
+device_initcall(ttc_lattest_init);
@@ -26,6 +26,7 @@
 #include <linux/msi.h>
 #include <linux/irq.h>
 #include <linux/irqdomain.h>
+#include <linux/interrupt.h>
 #include <linux/module.h>
 
 #define XILINX_NUM_MSI_IRQS	128
@@ -35,6 +36,22 @@ static DECLARE_BITMAP(msi_irq_in_use, XILINX_NUM_MSI_IRQS);
 static unsigned long xaxipcie_msg_addr;
 static struct irq_domain *xaxipcie_irq_domain;
 static int xaxipcie_msi_irq_base;
+static unsigned int xaxipcie_msi_parent_irq;
+
+/**
+ * xaxipcie_msi_set_parent_irq- Record the upstream decode interrupt
+ * @irq: Interrupt number of the root port's shared interrupt
+ *
+ * @return: None
+ *
+ * @note: Every MSI of the port is decoded from this line, so per-MSI
+ * affinity requests are applied to it
+ */
+void xaxipcie_msi_set_parent_irq(unsigned int irq)
+{
+	xaxipcie_msi_parent_irq = irq;
+}
+EXPORT_SYMBOL(xaxipcie_msi_set_parent_irq);
 
 /* Dynamic irq allocate and deallocation */
 
@@ -51,6 +68,8 @@ int create_irq(void)
 	int irq, pos;
 again:
 	pos = find_first_zero_bit(msi_irq_in_use, XILINX_NUM_MSI_IRQS);
+	if (pos >= XILINX_NUM_MSI_IRQS)
+		return -ENOSPC;
 
 	irq = irq_find_mapping(xaxipcie_irq_domain, pos);
 
@@ -107,6 +126,36 @@ static void xilinx_msi_nop(struct irq_data *d)
 	return;
 }
 
+#ifdef CONFIG_SMP
+/**
+ * xilinx_msi_set_affinity-Steer an MSI to a set of CPUs
+ * @d: Pointer to the irq data of the MSI
+ * @mask: Requested CPU mask
+ * @force: Whether the request may ignore the online mask
+ *
+ * @return: IRQ_SET_MASK_OK/ error
+ *
+ * @note: The root port decodes every MSI from a single upstream
+ * interrupt, so steering one MSI moves that line and with it all MSIs
+ * of the port. With one line per port this still spreads multi-port
+ * setups across cores.
+ */
+static int xilinx_msi_set_affinity(struct irq_data *d,
+			const struct cpumask *mask, bool force)
+{
+	int err;
+
+	if (!xaxipcie_msi_parent_irq)
+		return -EINVAL;
+
+	err = irq_set_affinity(xaxipcie_msi_parent_irq, mask);
+	if (err)
+		return err;
+
+	return IRQ_SET_MASK_OK;
+}
+#endif
+
 static struct irq_chip xilinx_msi_chip = {
 		.name = "PCIe-MSI",
 		.irq_ack = xilinx_msi_nop,
@@ -114,6 +163,9 @@ static struct irq_chip xilinx_msi_chip = {
 		.irq_disable = mask_msi_irq,
 		.irq_mask = mask_msi_irq,
 		.irq_unmask = unmask_msi_irq,
+#ifdef CONFIG_SMP
+		.irq_set_affinity = xilinx_msi_set_affinity,
+#endif
 };
 
 /**
@@ -182,6 +182,7 @@ static int xaxipcie_msi_irq_base;
 
 int xaxipcie_alloc_msi_irqdescs(struct device_node *node,
 				unsigned long msg_addr);
+void xaxipcie_msi_set_parent_irq(unsigned int irq);
 #endif
 
 /**
@@ -870,6 +871,11 @@ static int xaxi_pcie_init_port(struct xaxi_pcie_port *port)
 		return err;
 	}
 
+#ifdef CONFIG_PCI_MSI
+	/* MSI affinity requests are applied to this decode interrupt */
+	xaxipcie_msi_set_parent_irq(port->irq_num);
+#endif
+
 	return 0;
 }
 
@@ -0,0 +1,504 @@
+/*
+ * L220/PL310 external cache controller event counter PMU
+ *
+ *  Copyright (C) 2013 Xilinx
+ *
+ * The cache controller has two 32-bit event counters that can each be
+ * pointed at one of the transaction or hit/miss event sources. They
+ * are exposed here as an uncore-style perf PMU, so
+ * `perf stat -e l2x0/drreq/,l2x0/drhit/` attributes L2 traffic
+ * without external trace hardware.
+ *
+ * The counters saturate at 0xffffffff instead of wrapping and have no
+ * usable overflow interrupt on this SoC, so a pinned hrtimer drains
+ * them well before they can fill.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+#include <linux/cpu.h>
+#include <linux/errno.h>
+#include <linux/hrtimer.h>
+#include <linux/io.h>
+#include <linux/list.h>
+#include <linux/perf_event.h>
+#include <linux/printk.h>
+
+#include <asm/hardware/cache-l2x0.h>
+
+#define PMU_NR_COUNTERS 2
+
+#define L2X0_EVENT_CNT_VAL(idx)	(L2X0_EVENT_CNT0_VAL - 4 * (idx))
+#define L2X0_EVENT_CNT_CFG(idx)	(L2X0_EVENT_CNT0_CFG - 4 * (idx))
+
+static void __iomem *l2x0_pmu_base;
+static u32 l2x0_pmu_cache_id;
+
+static struct pmu l2x0_pmu;
+static cpumask_t l2x0_pmu_cpumask;
+
+static struct perf_event *events[PMU_NR_COUNTERS];
+
+static struct hrtimer l2x0_pmu_hrtimer;
+static ktime_t l2x0_pmu_poll_period;
+
+static int l2x0_pmu_find_idx(void)
+{
+	int i;
+
+	for (i = 0; i < PMU_NR_COUNTERS; i++) {
+		if (!events[i])
+			return i;
+	}
+
+	return -1;
+}
+
+static int l2x0_pmu_num_active_events(void)
+{
+	int i, n = 0;
+
+	for (i = 0; i < PMU_NR_COUNTERS; i++) {
+		if (events[i])
+			n++;
+	}
+
+	return n;
+}
+
+static u32 l2x0_pmu_counter_read(int idx)
+{
+	return readl_relaxed(l2x0_pmu_base + L2X0_EVENT_CNT_VAL(idx));
+}
+
+static void l2x0_pmu_counter_write(int idx, u32 val)
+{
+	writel_relaxed(val, l2x0_pmu_base + L2X0_EVENT_CNT_VAL(idx));
+}
+
+static void __l2x0_pmu_enable(void)
+{
+	u32 val = readl_relaxed(l2x0_pmu_base + L2X0_EVENT_CNT_CTRL);
+
+	val |= L2X0_EVENT_CNT_CTRL_ENABLE;
+	writel_relaxed(val, l2x0_pmu_base + L2X0_EVENT_CNT_CTRL);
+}
+
+static void __l2x0_pmu_disable(void)
+{
+	u32 val = readl_relaxed(l2x0_pmu_base + L2X0_EVENT_CNT_CTRL);
+
+	val &= ~L2X0_EVENT_CNT_CTRL_ENABLE;
+	writel_relaxed(val, l2x0_pmu_base + L2X0_EVENT_CNT_CTRL);
+}
+
+static void l2x0_pmu_enable(struct pmu *pmu)
+{
+	if (l2x0_pmu_num_active_events() == 0)
+		return;
+
+	__l2x0_pmu_enable();
+}
+
+static void l2x0_pmu_disable(struct pmu *pmu)
+{
+	if (l2x0_pmu_num_active_events() == 0)
+		return;
+
+	__l2x0_pmu_disable();
+}
+
+static void warn_if_saturated(u32 count)
+{
+	if (count != 0xffffffff)
+		return;
+
+	pr_warn_ratelimited("L2X0 counter saturated. Poll period too long\n");
+}
+
+static void l2x0_pmu_event_read(struct perf_event *event)
+{
+	struct hw_perf_event *hw = &event->hw;
+	u64 prev_count, new_count;
+
+	do {
+		prev_count = local64_read(&hw->prev_count);
+		new_count = l2x0_pmu_counter_read(hw->idx);
+	} while (local64_xchg(&hw->prev_count, new_count) != prev_count);
+
+	local64_add((u32)(new_count - prev_count), &event->count);
+
+	warn_if_saturated(new_count);
+}
+
+static void l2x0_pmu_event_configure(struct perf_event *event)
+{
+	struct hw_perf_event *hw = &event->hw;
+
+	/*
+	 * The counters saturate rather than wrap, and there is no way
+	 * to tell how many events were lost once one has pegged. Start
+	 * every period from zero to maximize the headroom the hrtimer
+	 * poll has to drain the counter.
+	 */
+	local64_set(&hw->prev_count, 0);
+	l2x0_pmu_counter_write(hw->idx, 0);
+}
+
+static enum hrtimer_restart l2x0_pmu_poll(struct hrtimer *hrtimer)
+{
+	unsigned long flags;
+	int i;
+
+	local_irq_save(flags);
+	__l2x0_pmu_disable();
+
+	for (i = 0; i < PMU_NR_COUNTERS; i++) {
+		struct perf_event *event = events[i];
+
+		if (!event)
+			continue;
+
+		l2x0_pmu_event_read(event);
+		l2x0_pmu_event_configure(event);
+	}
+
+	__l2x0_pmu_enable();
+	local_irq_restore(flags);
+
+	hrtimer_forward_now(hrtimer, l2x0_pmu_poll_period);
+	return HRTIMER_RESTART;
+}
+
+static void __l2x0_pmu_event_enable(int idx, u32 event)
+{
+	u32 val;
+
+	val = event << L2X0_EVENT_CNT_CFG_SRC_SHIFT;
+	val |= L2X0_EVENT_CNT_CFG_INT_DISABLED;
+	writel_relaxed(val, l2x0_pmu_base + L2X0_EVENT_CNT_CFG(idx));
+}
+
+static void l2x0_pmu_event_start(struct perf_event *event, int flags)
+{
+	struct hw_perf_event *hw = &event->hw;
+
+	if (WARN_ON_ONCE(!(hw->state & PERF_HES_STOPPED)))
+		return;
+
+	if (flags & PERF_EF_RELOAD) {
+		WARN_ON_ONCE(!(hw->state & PERF_HES_UPTODATE));
+		l2x0_pmu_event_configure(event);
+	}
+
+	hw->state = 0;
+
+	__l2x0_pmu_event_enable(hw->idx, hw->config_base);
+}
+
+static void __l2x0_pmu_event_disable(int idx)
+{
+	u32 val;
+
+	val = L2X0_EVENT_CNT_CFG_SRC_DISABLED << L2X0_EVENT_CNT_CFG_SRC_SHIFT;
+	val |= L2X0_EVENT_CNT_CFG_INT_DISABLED;
+	writel_relaxed(val, l2x0_pmu_base + L2X0_EVENT_CNT_CFG(idx));
+}
+
+static void l2x0_pmu_event_stop(struct perf_event *event, int flags)
+{
+	struct hw_perf_event *hw = &event->hw;
+
+	if (WARN_ON_ONCE(event->hw.state & PERF_HES_STOPPED))
+		return;
+
+	__l2x0_pmu_event_disable(hw->idx);
+
+	hw->state |= PERF_HES_STOPPED;
+
+	if (flags & PERF_EF_UPDATE) {
+		l2x0_pmu_event_read(event);
+		hw->state |= PERF_HES_UPTODATE;
+	}
+}
+
+static int l2x0_pmu_event_add(struct perf_event *event, int flags)
+{
+	struct hw_perf_event *hw = &event->hw;
+	int idx = l2x0_pmu_find_idx();
+
+	if (idx == -1)
+		return -EAGAIN;
+
+	/*
+	 * Pin the timer to the CPU handed out in the cpumask attribute,
+	 * so the drained counts are accounted where perf expects them.
+	 */
+	if (l2x0_pmu_num_active_events() == 0)
+		hrtimer_start(&l2x0_pmu_hrtimer, l2x0_pmu_poll_period,
+			      HRTIMER_MODE_REL_PINNED);
+
+	events[idx] = event;
+	hw->idx = idx;
+
+	l2x0_pmu_event_configure(event);
+
+	hw->state = PERF_HES_STOPPED | PERF_HES_UPTODATE;
+
+	if (flags & PERF_EF_START)
+		l2x0_pmu_event_start(event, 0);
+
+	return 0;
+}
+
+static void l2x0_pmu_event_del(struct perf_event *event, int flags)
+{
+	struct hw_perf_event *hw = &event->hw;
+
+	l2x0_pmu_event_stop(event, PERF_EF_UPDATE);
+
+	events[hw->idx] = NULL;
+	hw->idx = -1;
+
+	if (l2x0_pmu_num_active_events() == 0)
+		hrtimer_cancel(&l2x0_pmu_hrtimer);
+}
+
+static bool l2x0_pmu_group_is_valid(struct perf_event *event)
+{
+	struct pmu *pmu = event->pmu;
+	struct perf_event *leader = event->group_leader;
+	struct perf_event *sibling;
+	int num_hw = 0;
+
+	if (leader->pmu == pmu)
+		num_hw++;
+	else if (!is_software_event(leader))
+		return false;
+
+	list_for_each_entry(sibling, &leader->sibling_list, group_entry) {
+		if (sibling->pmu == pmu)
+			num_hw++;
+		else if (!is_software_event(sibling))
+			return false;
+	}
+
+	return num_hw <= PMU_NR_COUNTERS;
+}
+
+static int l2x0_pmu_event_init(struct perf_event *event)
+{
+	struct hw_perf_event *hw = &event->hw;
+
+	if (event->attr.type != l2x0_pmu.type)
+		return -ENOENT;
+
+	if (is_sampling_event(event) ||
+	    event->attach_state & PERF_ATTACH_TASK)
+		return -EINVAL;
+
+	if (event->cpu < 0)
+		return -EINVAL;
+
+	/* The counters see all masters; they cannot filter by mode */
+	if (event->attr.exclude_user   ||
+	    event->attr.exclude_kernel ||
+	    event->attr.exclude_hv     ||
+	    event->attr.exclude_idle   ||
+	    event->attr.exclude_host   ||
+	    event->attr.exclude_guest)
+		return -EINVAL;
+
+	if (event->attr.config & ~L2X0_EVENT_CNT_CFG_SRC_MASK)
+		return -EINVAL;
+
+	hw->config_base = event->attr.config;
+
+	if (!l2x0_pmu_group_is_valid(event))
+		return -EINVAL;
+
+	event->cpu = cpumask_first(&l2x0_pmu_cpumask);
+
+	return 0;
+}
+
+static ssize_t l2x0_pmu_event_show(struct device *dev,
+				   struct device_attribute *attr, char *buf)
+{
+	struct perf_pmu_events_attr *pmu_attr;
+
+	pmu_attr = container_of(attr, struct perf_pmu_events_attr, attr);
+	return sprintf(buf, "event=0x%llx\n", pmu_attr->id);
+}
+
+#define L2X0_EVENT_ATTR(_name, _id)					\
+	PMU_EVENT_ATTR(_name, l2x0_pmu_event_attr_##_name, _id,		\
+		       l2x0_pmu_event_show)
+
+L2X0_EVENT_ATTR(co, 0x1);
+L2X0_EVENT_ATTR(drhit, 0x2);
+L2X0_EVENT_ATTR(drreq, 0x3);
+L2X0_EVENT_ATTR(dwhit, 0x4);
+L2X0_EVENT_ATTR(dwreq, 0x5);
+L2X0_EVENT_ATTR(dwtreq, 0x6);
+L2X0_EVENT_ATTR(irhit, 0x7);
+L2X0_EVENT_ATTR(irreq, 0x8);
+L2X0_EVENT_ATTR(wa, 0x9);
+L2X0_EVENT_ATTR(ipfalloc, 0xa);
+L2X0_EVENT_ATTR(epfhit, 0xb);
+L2X0_EVENT_ATTR(epfalloc, 0xc);
+L2X0_EVENT_ATTR(srrcvd, 0xd);
+L2X0_EVENT_ATTR(srconf, 0xe);
+L2X0_EVENT_ATTR(epfrcvd, 0xf);
+
+static struct attribute *l2x0_pmu_event_attrs[] = {
+	&l2x0_pmu_event_attr_co.attr.attr,
+	&l2x0_pmu_event_attr_drhit.attr.attr,
+	&l2x0_pmu_event_attr_drreq.attr.attr,
+	&l2x0_pmu_event_attr_dwhit.attr.attr,
+	&l2x0_pmu_event_attr_dwreq.attr.attr,
+	&l2x0_pmu_event_attr_dwtreq.attr.attr,
+	&l2x0_pmu_event_attr_irhit.attr.attr,
+	&l2x0_pmu_event_attr_irreq.attr.attr,
+	&l2x0_pmu_event_attr_wa.attr.attr,
+	&l2x0_pmu_event_attr_ipfalloc.attr.attr,
+	&l2x0_pmu_event_attr_epfhit.attr.attr,
+	&l2x0_pmu_event_attr_epfalloc.attr.attr,
+	&l2x0_pmu_event_attr_srrcvd.attr.attr,
+	&l2x0_pmu_event_attr_srconf.attr.attr,
+	&l2x0_pmu_event_attr_epfrcvd.attr.attr,
+	NULL,
+};
+
+static struct attribute_group l2x0_pmu_event_group = {
+	.name	= "events",
+	.attrs	= l2x0_pmu_event_attrs,
+};
+
+PMU_FORMAT_ATTR(event, "config:0-3");
+
+static struct attribute *l2x0_pmu_format_attrs[] = {
+	&format_attr_event.attr,
+	NULL,
+};
+
+static struct attribute_group l2x0_pmu_format_group = {
+	.name	= "format",
+	.attrs	= l2x0_pmu_format_attrs,
+};
+
+static ssize_t l2x0_pmu_cpumask_show(struct device *dev,
+				     struct device_attribute *attr, char *buf)
+{
+	int n = cpulist_scnprintf(buf, PAGE_SIZE - 2, &l2x0_pmu_cpumask);
+
+	buf[n++] = '\n';
+	buf[n] = '\0';
+	return n;
+}
+
+static DEVICE_ATTR(cpumask, S_IRUGO, l2x0_pmu_cpumask_show, NULL);
+
+static struct attribute *l2x0_pmu_cpumask_attrs[] = {
+	&dev_attr_cpumask.attr,
+	NULL,
+};
+
+static struct attribute_group l2x0_pmu_cpumask_group = {
+	.attrs	= l2x0_pmu_cpumask_attrs,
+};
+
+static const struct attribute_group *l2x0_pmu_attr_groups[] = {
+	&l2x0_pmu_event_group,
+	&l2x0_pmu_format_group,
+	&l2x0_pmu_cpumask_group,
+	NULL,
+};
+
+static struct pmu l2x0_pmu = {
+	.task_ctx_nr	= perf_invalid_context,
+	.attr_groups	= l2x0_pmu_attr_groups,
+	.pmu_enable	= l2x0_pmu_enable,
+	.pmu_disable	= l2x0_pmu_disable,
+	.event_init	= l2x0_pmu_event_init,
+	.add		= l2x0_pmu_event_add,
+	.del		= l2x0_pmu_event_del,
+	.start		= l2x0_pmu_event_start,
+	.stop		= l2x0_pmu_event_stop,
+	.read		= l2x0_pmu_event_read,
+};
+
+static int __cpuinit l2x0_pmu_cpu_notify(struct notifier_block *nb,
+					 unsigned long action, void *hcpu)
+{
+	unsigned int cpu = (unsigned long)hcpu;
+	unsigned int target;
+
+	if ((action & ~CPU_TASKS_FROZEN) != CPU_DOWN_PREPARE)
+		return NOTIFY_OK;
+
+	if (!cpumask_test_and_clear_cpu(cpu, &l2x0_pmu_cpumask))
+		return NOTIFY_OK;
+
+	target = cpumask_any_but(cpu_online_mask, cpu);
+	if (target >= nr_cpu_ids)
+		return NOTIFY_OK;
+
+	perf_pmu_migrate_context(&l2x0_pmu, cpu, target);
+	cpumask_set_cpu(target, &l2x0_pmu_cpumask);
+
+	return NOTIFY_OK;
+}
+
+static struct notifier_block l2x0_pmu_cpu_nb __cpuinitdata = {
+	.notifier_call = l2x0_pmu_cpu_notify,
+};
+
+void __init l2x0_pmu_register(void __iomem *base, u32 part)
+{
+	/*
+	 * The initcall below does the real work; l2x0_init runs far
+	 * too early to talk to the perf core.
+	 */
+	l2x0_pmu_base = base;
+	l2x0_pmu_cache_id = part;
+}
+
+static __init int l2x0_pmu_init(void)
+{
+	int ret;
+
+	if (!l2x0_pmu_base)
+		return 0;
+
+	switch (l2x0_pmu_cache_id & L2X0_CACHE_ID_PART_MASK) {
+	case L2X0_CACHE_ID_PART_L310:
+	case L2X0_CACHE_ID_PART_L210:
+		break;
+	default:
+		return 0;
+	}
+
+	/*
+	 * The fastest event source is one count per L2 clock. At the
+	 * rates this SoC runs, a 32-bit counter takes over ten seconds
+	 * to saturate; polling once a second leaves a wide margin.
+	 */
+	l2x0_pmu_poll_period = ktime_set(1, 0);
+	hrtimer_init(&l2x0_pmu_hrtimer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	l2x0_pmu_hrtimer.function = l2x0_pmu_poll;
+
+	cpumask_set_cpu(smp_processor_id(), &l2x0_pmu_cpumask);
+
+	ret = register_cpu_notifier(&l2x0_pmu_cpu_nb);
+	if (ret)
+		return ret;
+
+	ret = perf_pmu_register(&l2x0_pmu, "l2x0", -1);
+	if (ret)
+		unregister_cpu_notifier(&l2x0_pmu_cpu_nb);
+
+	return ret;
+}
+device_initcall(l2x0_pmu_init);
@@ -594,6 +594,162 @@ static void __free_from_contiguous(struct device *dev, struct page *page,
 	dma_release_from_contiguous(dev, page, size >> PAGE_SHIFT);
 }
 
+/*
+ * Per-device coherent arenas.
+ *
+ * The regular paths here build a fresh uncached mapping in vmalloc
+ * space (or rewrite the linear map of a CMA chunk) for every coherent
+ * buffer and zero it page by page, which is far too expensive for
+ * drivers cycling through buffers at a high rate.  A driver may instead
+ * declare an arena for its device: one contiguous, pre-mapped uncached
+ * window out of which its coherent allocations are served by a bitmap
+ * allocator, exactly like the atomic pool.  Requests that do not fit
+ * fall back to the regular paths.
+ */
+struct arm_dma_arena {
+	size_t size;
+	spinlock_t lock;
+	unsigned long *bitmap;
+	unsigned long nr_pages;
+	void *vaddr;
+	struct page *page;
+};
+
+/**
+ * arm_dma_arena_declare - set up a coherent arena for a device
+ * @dev: device to serve from the arena
+ * @size: arena size in bytes
+ *
+ * Subsequent dma_alloc_coherent() calls for @dev that fit are carved
+ * out of the arena instead of being individually remapped.  Must be
+ * called from sleepable context, typically at probe time.
+ */
+int arm_dma_arena_declare(struct device *dev, size_t size)
+{
+	pgprot_t prot = pgprot_dmacoherent(pgprot_kernel);
+	gfp_t gfp = GFP_KERNEL | GFP_DMA;
+	struct arm_dma_arena *arena;
+	unsigned long nr_pages;
+	struct page *page;
+	void *ptr;
+
+	if (WARN_ON(dev->archdata.arena))
+		return -EBUSY;
+
+	size = PAGE_ALIGN(size);
+	nr_pages = size >> PAGE_SHIFT;
+
+	arena = kzalloc(sizeof(*arena), GFP_KERNEL);
+	if (!arena)
+		return -ENOMEM;
+
+	arena->bitmap = kzalloc(BITS_TO_LONGS(nr_pages) * sizeof(long),
+				GFP_KERNEL);
+	if (!arena->bitmap)
+		goto no_bitmap;
+
+	if (IS_ENABLED(CONFIG_CMA))
+		ptr = __alloc_from_contiguous(dev, size, prot, &page,
+					      __builtin_return_address(0));
+	else
+		ptr = __alloc_remap_buffer(dev, size, gfp, prot, &page,
+					   __builtin_return_address(0));
+	if (!ptr)
+		goto no_buffer;
+
+	spin_lock_init(&arena->lock);
+	arena->size = size;
+	arena->nr_pages = nr_pages;
+	arena->vaddr = ptr;
+	arena->page = page;
+	dev->archdata.arena = arena;
+
+	dev_info(dev, "DMA: %zu KiB coherent arena\n", size / 1024);
+	return 0;
+
+no_buffer:
+	kfree(arena->bitmap);
+no_bitmap:
+	kfree(arena);
+	return -ENOMEM;
+}
+EXPORT_SYMBOL_GPL(arm_dma_arena_declare);
+
+/**
+ * arm_dma_arena_release - tear down a device's coherent arena
+ * @dev: device the arena was declared for
+ *
+ * All allocations served from the arena must have been freed.
+ */
+void arm_dma_arena_release(struct device *dev)
+{
+	struct arm_dma_arena *arena = dev->archdata.arena;
+
+	if (!arena)
+		return;
+
+	WARN_ON(!bitmap_empty(arena->bitmap, arena->nr_pages));
+
+	dev->archdata.arena = NULL;
+	if (IS_ENABLED(CONFIG_CMA)) {
+		__free_from_contiguous(dev, arena->page, arena->vaddr,
+				       arena->size);
+	} else {
+		__dma_free_remap(arena->vaddr, arena->size);
+		__dma_free_buffer(arena->page, arena->size);
+	}
+	kfree(arena->bitmap);
+	kfree(arena);
+}
+EXPORT_SYMBOL_GPL(arm_dma_arena_release);
+
+static void *__alloc_from_arena(struct device *dev, size_t size,
+				struct page **ret_page)
+{
+	struct arm_dma_arena *arena = dev ? dev->archdata.arena : NULL;
+	unsigned int count = size >> PAGE_SHIFT;
+	unsigned int pageno;
+	unsigned long flags;
+	void *ptr = NULL;
+
+	if (!arena || size > arena->size)
+		return NULL;
+
+	spin_lock_irqsave(&arena->lock, flags);
+	pageno = bitmap_find_next_zero_area(arena->bitmap, arena->nr_pages,
+					    0, count,
+					    (1 << get_order(size)) - 1);
+	if (pageno < arena->nr_pages) {
+		bitmap_set(arena->bitmap, pageno, count);
+		ptr = arena->vaddr + PAGE_SIZE * pageno;
+		*ret_page = arena->page + pageno;
+	}
+	spin_unlock_irqrestore(&arena->lock, flags);
+
+	/* The window is uncached, so plain memset needs no maintenance */
+	if (ptr)
+		memset(ptr, 0, size);
+
+	return ptr;
+}
+
+static int __free_to_arena(struct device *dev, void *start, size_t size)
+{
+	struct arm_dma_arena *arena = dev ? dev->archdata.arena : NULL;
+	unsigned long flags;
+
+	if (!arena || start < arena->vaddr ||
+	    start + size > arena->vaddr + arena->size)
+		return 0;
+
+	spin_lock_irqsave(&arena->lock, flags);
+	bitmap_clear(arena->bitmap, (start - arena->vaddr) >> PAGE_SHIFT,
+		     size >> PAGE_SHIFT);
+	spin_unlock_irqrestore(&arena->lock, flags);
+
+	return 1;
+}
+
 static inline pgprot_t __get_dma_pgprot(struct dma_attrs *attrs, pgprot_t prot)
 {
 	prot = dma_get_attr(DMA_ATTR_WRITE_COMBINE, attrs) ?
@@ -612,7 +768,9 @@ static inline pgprot_t __get_dma_pgprot(struct dma_attrs *attrs, pgprot_t prot)
 #define __alloc_remap_buffer(dev, size, gfp, prot, ret, c)	NULL
 #define __alloc_from_pool(size, ret_page)			NULL
 #define __alloc_from_contiguous(dev, size, prot, ret, c)	NULL
+#define __alloc_from_arena(dev, size, ret_page)			NULL
 #define __free_from_pool(cpu_addr, size)			0
+#define __free_to_arena(dev, cpu_addr, size)			0
 #define __free_from_contiguous(dev, page, cpu_addr, size)	do { } while (0)
 #define __dma_free_remap(cpu_addr, size)			do { } while (0)
 
@@ -666,6 +824,19 @@ static void *__dma_alloc(struct device *dev, size_t size, dma_addr_t *handle,
 	*handle = DMA_ERROR_CODE;
 	size = PAGE_ALIGN(size);
 
+	/*
+	 * A device with a declared arena is served from its pre-mapped
+	 * uncached window whenever the request fits; coherent devices
+	 * want a cached mapping and keep using the simple path.
+	 */
+	if (!is_coherent && !nommu()) {
+		addr = __alloc_from_arena(dev, size, &page);
+		if (addr) {
+			*handle = pfn_to_dma(dev, page_to_pfn(page));
+			return addr;
+		}
+	}
+
 	if (is_coherent || nommu())
 		addr = __alloc_simple_buffer(dev, size, gfp, &page);
 	else if (!(gfp & __GFP_WAIT))
@@ -755,6 +926,9 @@ static void __arm_dma_free(struct device *dev, size_t size, void *cpu_addr,
 
 	size = PAGE_ALIGN(size);
 
+	if (!is_coherent && __free_to_arena(dev, cpu_addr, size))
+		return;
+
 	if (is_coherent || nommu()) {
 		__dma_free_buffer(page, size);
 	} else if (__free_from_pool(cpu_addr, size)) {
@@ -879,10 +1053,49 @@ static void __dma_page_dev_to_cpu(struct page *page, unsigned long off,
 	dma_cache_maint_page(page, off, size, dir, dmac_unmap_area);
 
 	/*
-	 * Mark the D-cache clean for this page to avoid extra flushing.
+	 * Mark the D-cache clean for these pages to avoid extra flushing.
 	 */
-	if (dir != DMA_TO_DEVICE && off == 0 && size >= PAGE_SIZE)
-		set_bit(PG_dcache_clean, &page->flags);
+	if (dir != DMA_TO_DEVICE && off == 0 && size >= PAGE_SIZE) {
+		unsigned long pfn = page_to_pfn(page);
+		size_t left = size;
+
+		while (left >= PAGE_SIZE) {
+			set_bit(PG_dcache_clean, &pfn_to_page(pfn)->flags);
+			pfn++;
+			left -= PAGE_SIZE;
+		}
+	}
+}
+
+/*
+ * Perform cache maintenance for a scatterlist, merging physically
+ * contiguous elements into one ranged operation each.  Capture-style
+ * sglists are often hundreds of 4K pages allocated back to back; doing
+ * the clean/invalidate per element costs a function call and a barrier
+ * per page, which a ranged operation amortizes over the whole run.
+ */
+static void arm_dma_sg_maint(struct scatterlist *sg, int nents,
+			     enum dma_data_direction dir,
+			     void (*maint)(struct page *, unsigned long,
+					   size_t, enum dma_data_direction))
+{
+	struct scatterlist *s, *run = NULL;
+	size_t run_len = 0;
+	int i;
+
+	for_each_sg(sg, s, nents, i) {
+		if (run && sg_phys(run) + run_len == sg_phys(s)) {
+			run_len += s->length;
+			continue;
+		}
+
+		if (run)
+			maint(sg_page(run), run->offset, run_len, dir);
+		run = s;
+		run_len = s->length;
+	}
+	if (run)
+		maint(sg_page(run), run->offset, run_len, dir);
 }
 
 /**
@@ -908,6 +1121,26 @@ int arm_dma_map_sg(struct device *dev, struct scatterlist *sg, int nents,
 	struct scatterlist *s;
 	int i, j;
 
+	/*
+	 * The plain streaming ops cannot fail, so the translation can be
+	 * done element by element while the cache maintenance is batched
+	 * over contiguous runs.  Everything else (dmabounce, coherent
+	 * devices, IOMMUs) keeps the generic per-element loop.
+	 */
+	if (ops == &arm_dma_ops &&
+	    !dma_get_attr(DMA_ATTR_SKIP_CPU_SYNC, attrs)) {
+		for_each_sg(sg, s, nents, i) {
+#ifdef CONFIG_NEED_SG_DMA_LENGTH
+			s->dma_length = s->length;
+#endif
+			s->dma_address = pfn_to_dma(dev,
+						page_to_pfn(sg_page(s))) +
+					 s->offset;
+		}
+		arm_dma_sg_maint(sg, nents, dir, __dma_page_cpu_to_dev);
+		return nents;
+	}
+
 	for_each_sg(sg, s, nents, i) {
 #ifdef CONFIG_NEED_SG_DMA_LENGTH
 		s->dma_length = s->length;
@@ -943,6 +1176,12 @@ void arm_dma_unmap_sg(struct device *dev, struct scatterlist *sg, int nents,
 
 	int i;
 
+	if (ops == &arm_dma_ops &&
+	    !dma_get_attr(DMA_ATTR_SKIP_CPU_SYNC, attrs)) {
+		arm_dma_sg_maint(sg, nents, dir, __dma_page_dev_to_cpu);
+		return;
+	}
+
 	for_each_sg(sg, s, nents, i)
 		ops->unmap_page(dev, sg_dma_address(s), sg_dma_len(s), dir, attrs);
 }
@@ -961,6 +1200,11 @@ void arm_dma_sync_sg_for_cpu(struct device *dev, struct scatterlist *sg,
 	struct scatterlist *s;
 	int i;
 
+	if (ops == &arm_dma_ops) {
+		arm_dma_sg_maint(sg, nents, dir, __dma_page_dev_to_cpu);
+		return;
+	}
+
 	for_each_sg(sg, s, nents, i)
 		ops->sync_single_for_cpu(dev, sg_dma_address(s), s->length,
 					 dir);
@@ -980,6 +1224,11 @@ void arm_dma_sync_sg_for_device(struct device *dev, struct scatterlist *sg,
 	struct scatterlist *s;
 	int i;
 
+	if (ops == &arm_dma_ops) {
+		arm_dma_sg_maint(sg, nents, dir, __dma_page_cpu_to_dev);
+		return;
+	}
+
 	for_each_sg(sg, s, nents, i)
 		ops->sync_single_for_device(dev, sg_dma_address(s), s->length,
 					    dir);
@@ -0,0 +1,239 @@
+/*
+ * Userspace implementations of gettimeofday() and clock_gettime().
+ *
+ * The counter of the current clocksource is exported by the kernel as a
+ * read-only page mapped just below the VDSO text (see
+ * arch/arm/kernel/vdso.c); everything else needed to turn a counter
+ * value into a timespec is read from the data page under the usual
+ * sequence count protocol.  Whenever the data page says the counter is
+ * not usable, fall back to the real system call.
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <linux/compiler.h>
+#include <linux/time.h>
+#include <linux/types.h>
+
+#include <asm/barrier.h>
+#include <asm/unistd.h>
+#include <asm/vdso_datapage.h>
+
+extern struct vdso_data _vdso_data __attribute__((visibility("hidden")));
+extern u8 _vdso_cntr[] __attribute__((visibility("hidden")));
+
+static notrace u32 vdso_read_begin(const struct vdso_data *vdata)
+{
+	u32 seq;
+
+	do {
+		seq = ACCESS_ONCE(vdata->seq_count);
+	} while (seq & 1);
+
+	smp_rmb();
+	return seq;
+}
+
+static notrace int vdso_read_retry(const struct vdso_data *vdata, u32 start)
+{
+	smp_rmb();
+	return vdata->seq_count != start;
+}
+
+static notrace u64 vdso_read_cycles(const struct vdso_data *vdata)
+{
+	return *(volatile u32 *)(_vdso_cntr + vdata->cntr_off);
+}
+
+static notrace long clock_gettime_fallback(clockid_t _clkid,
+					   struct timespec *_ts)
+{
+	register struct timespec *ts asm("r1") = _ts;
+	register clockid_t clkid asm("r0") = _clkid;
+	register long ret asm("r0");
+	register long nr asm("r7") = __NR_clock_gettime;
+
+	asm volatile(
+	"	swi #0\n"
+	: "=r" (ret)
+	: "r" (clkid), "r" (ts), "r" (nr)
+	: "memory");
+
+	return ret;
+}
+
+static notrace long gettimeofday_fallback(struct timeval *_tv,
+					  struct timezone *_tz)
+{
+	register struct timezone *tz asm("r1") = _tz;
+	register struct timeval *tv asm("r0") = _tv;
+	register long ret asm("r0");
+	register long nr asm("r7") = __NR_gettimeofday;
+
+	asm volatile(
+	"	swi #0\n"
+	: "=r" (ret)
+	: "r" (tv), "r" (tz), "r" (nr)
+	: "memory");
+
+	return ret;
+}
+
+static notrace void do_realtime_coarse(const struct vdso_data *vdata,
+				       struct timespec *ts)
+{
+	u32 seq;
+
+	do {
+		seq = vdso_read_begin(vdata);
+
+		ts->tv_sec = vdata->xtime_coarse_sec;
+		ts->tv_nsec = vdata->xtime_coarse_nsec;
+
+	} while (vdso_read_retry(vdata, seq));
+}
+
+static notrace void do_monotonic_coarse(const struct vdso_data *vdata,
+					struct timespec *ts)
+{
+	struct timespec tomono;
+	u32 seq;
+
+	do {
+		seq = vdso_read_begin(vdata);
+
+		ts->tv_sec = vdata->xtime_coarse_sec;
+		ts->tv_nsec = vdata->xtime_coarse_nsec;
+
+		tomono.tv_sec = vdata->wtm_clock_sec;
+		tomono.tv_nsec = vdata->wtm_clock_nsec;
+
+	} while (vdso_read_retry(vdata, seq));
+
+	ts->tv_sec += tomono.tv_sec;
+	timespec_add_ns(ts, tomono.tv_nsec);
+}
+
+static notrace int do_realtime(const struct vdso_data *vdata,
+			       struct timespec *ts)
+{
+	u64 cycle_last, cycle_now, mask, nsec;
+	u32 seq, mult, shift;
+
+	do {
+		seq = vdso_read_begin(vdata);
+
+		if (vdata->use_syscall)
+			return -1;
+
+		cycle_last = vdata->cs_cycle_last;
+		mask = vdata->cs_mask;
+		mult = vdata->cs_mult;
+		shift = vdata->cs_shift;
+
+		ts->tv_sec = vdata->xtime_clock_sec;
+		nsec = vdata->xtime_clock_snsec;
+
+		cycle_now = vdso_read_cycles(vdata);
+
+	} while (vdso_read_retry(vdata, seq));
+
+	nsec += ((cycle_now - cycle_last) & mask) * mult;
+	ts->tv_nsec = 0;
+	timespec_add_ns(ts, nsec >> shift);
+
+	return 0;
+}
+
+static notrace int do_monotonic(const struct vdso_data *vdata,
+				struct timespec *ts)
+{
+	u64 cycle_last, cycle_now, mask, nsec;
+	u32 seq, mult, shift;
+	struct timespec tomono;
+
+	do {
+		seq = vdso_read_begin(vdata);
+
+		if (vdata->use_syscall)
+			return -1;
+
+		cycle_last = vdata->cs_cycle_last;
+		mask = vdata->cs_mask;
+		mult = vdata->cs_mult;
+		shift = vdata->cs_shift;
+
+		ts->tv_sec = vdata->xtime_clock_sec;
+		nsec = vdata->xtime_clock_snsec;
+
+		tomono.tv_sec = vdata->wtm_clock_sec;
+		tomono.tv_nsec = vdata->wtm_clock_nsec;
+
+		cycle_now = vdso_read_cycles(vdata);
+
+	} while (vdso_read_retry(vdata, seq));
+
+	nsec += ((cycle_now - cycle_last) & mask) * mult;
+	ts->tv_sec += tomono.tv_sec;
+	ts->tv_nsec = 0;
+	timespec_add_ns(ts, (nsec >> shift) + tomono.tv_nsec);
+
+	return 0;
+}
+
+notrace int __vdso_clock_gettime(clockid_t clkid, struct timespec *ts)
+{
+	const struct vdso_data *vdata = &_vdso_data;
+	int ret = -1;
+
+	switch (clkid) {
+	case CLOCK_REALTIME_COARSE:
+		do_realtime_coarse(vdata, ts);
+		ret = 0;
+		break;
+	case CLOCK_MONOTONIC_COARSE:
+		do_monotonic_coarse(vdata, ts);
+		ret = 0;
+		break;
+	case CLOCK_REALTIME:
+		ret = do_realtime(vdata, ts);
+		break;
+	case CLOCK_MONOTONIC:
+		ret = do_monotonic(vdata, ts);
+		break;
+	default:
+		break;
+	}
+
+	if (ret)
+		ret = clock_gettime_fallback(clkid, ts);
+
+	return ret;
+}
+
+notrace int __vdso_gettimeofday(struct timeval *tv, struct timezone *tz)
+{
+	const struct vdso_data *vdata = &_vdso_data;
+	struct timespec ts;
+
+	if (do_realtime(vdata, &ts))
+		return gettimeofday_fallback(tv, tz);
+
+	if (tv) {
+		tv->tv_sec = ts.tv_sec;
+		tv->tv_usec = ts.tv_nsec / 1000;
+	}
+	if (tz) {
+		tz->tz_minuteswest = vdata->tz_minuteswest;
+		tz->tz_dsttime = vdata->tz_dsttime;
+	}
+
+	return 0;
+}
@@ -0,0 +1,447 @@
+/*
+ *  Flash i/o scheduler.
+ *
+ *  An i/o scheduler for flash based storage (eMMC, SD) where seek time is
+ *  constant and small, so sorting requests by sector buys nothing, but where
+ *  writes are much more expensive than reads and profit from being issued in
+ *  long runs which the low-level driver can coalesce into aligned,
+ *  write-block sized transfers.
+ *
+ *  Requests are kept in four FIFOs - sync/async crossed with read/write -
+ *  and served strictly in priority order (sync reads, sync writes, async
+ *  reads, async writes) with per-FIFO deadlines and a starvation guard so
+ *  that background writeback still makes progress. Synchronous writes
+ *  (O_SYNC, fsync) therefore overtake any amount of queued writeback. There
+ *  is no idling: a request is handed to the driver as soon as it asks for
+ *  one. A sector-sorted tree is kept per data direction purely to make
+ *  front merges work, keeping the scheduler merge-aggressive.
+ */
+#include <linux/kernel.h>
+#include <linux/fs.h>
+#include <linux/blkdev.h>
+#include <linux/elevator.h>
+#include <linux/bio.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/init.h>
+#include <linux/compiler.h>
+#include <linux/rbtree.h>
+
+static const int sync_read_expire = HZ / 4;	/* max time before a sync read is submitted. */
+static const int sync_write_expire = HZ / 2;	/* ditto for sync writes */
+static const int async_read_expire = HZ / 2;	/* ditto for async reads (readahead) */
+static const int async_write_expire = 5 * HZ;	/* ditto for async writes, SOFT! */
+static const int writes_starved = 4;	/* max times async writes can be passed over */
+static const int fifo_batch = 16;	/* # of requests dispatched from one fifo in a
+					   row. Long write batches help the driver build
+					   write-block aligned transfers. */
+
+/*
+ * Dispatched request sizes are binned by power of two from 512 bytes up,
+ * one histogram per data direction, so that the merging and batching
+ * behaviour can be verified on a production workload.
+ */
+#define FLASH_HIST_BUCKETS	13	/* 512 bytes .. 2 MB and larger */
+
+struct flash_data {
+	/*
+	 * requests are present on both sort_list and one of the fifo_lists
+	 */
+	struct rb_root sort_list[2];
+	struct list_head fifo_list[2][2];	/* [sync][data_dir] */
+
+	/*
+	 * the fifo the current batch is served from, and its progress
+	 */
+	struct list_head *batch_fifo;
+	unsigned int batching;
+	unsigned int starved;		/* times async writes were passed over */
+
+	unsigned int size_hist[2][FLASH_HIST_BUCKETS];
+
+	/*
+	 * settings that change how the i/o scheduler behaves
+	 */
+	int fifo_expire[2][2];
+	int fifo_batch;
+	int writes_starved;
+	int front_merges;
+};
+
+static inline struct rb_root *
+flash_rb_root(struct flash_data *fd, struct request *rq)
+{
+	return &fd->sort_list[rq_data_dir(rq)];
+}
+
+static inline struct list_head *
+flash_fifo(struct flash_data *fd, struct request *rq)
+{
+	return &fd->fifo_list[rq_is_sync(rq)][rq_data_dir(rq)];
+}
+
+/*
+ * add rq to rbtree and fifo
+ */
+static void
+flash_add_request(struct request_queue *q, struct request *rq)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+	const int sync = rq_is_sync(rq);
+	const int data_dir = rq_data_dir(rq);
+
+	elv_rb_add(flash_rb_root(fd, rq), rq);
+
+	rq_set_fifo_time(rq, jiffies + fd->fifo_expire[sync][data_dir]);
+	list_add_tail(&rq->queuelist, &fd->fifo_list[sync][data_dir]);
+}
+
+/*
+ * remove rq from rbtree and fifo.
+ */
+static void flash_remove_request(struct request_queue *q, struct request *rq)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+
+	rq_fifo_clear(rq);
+	elv_rb_del(flash_rb_root(fd, rq), rq);
+}
+
+static int
+flash_merge(struct request_queue *q, struct request **req, struct bio *bio)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+	struct request *__rq;
+
+	/*
+	 * check for front merge
+	 */
+	if (fd->front_merges) {
+		sector_t sector = bio->bi_sector + bio_sectors(bio);
+
+		__rq = elv_rb_find(&fd->sort_list[bio_data_dir(bio)], sector);
+		if (__rq) {
+			BUG_ON(sector != blk_rq_pos(__rq));
+
+			if (elv_rq_merge_ok(__rq, bio)) {
+				*req = __rq;
+				return ELEVATOR_FRONT_MERGE;
+			}
+		}
+	}
+
+	return ELEVATOR_NO_MERGE;
+}
+
+static void flash_merged_request(struct request_queue *q,
+				 struct request *req, int type)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+
+	/*
+	 * if the merge was a front merge, we need to reposition request
+	 */
+	if (type == ELEVATOR_FRONT_MERGE) {
+		elv_rb_del(flash_rb_root(fd, req), req);
+		elv_rb_add(flash_rb_root(fd, req), req);
+	}
+}
+
+static void
+flash_merged_requests(struct request_queue *q, struct request *req,
+		      struct request *next)
+{
+	/*
+	 * if next expires before rq, assign its expire time to rq
+	 * and move into next position (next will be deleted) in fifo
+	 */
+	if (!list_empty(&req->queuelist) && !list_empty(&next->queuelist)) {
+		if (time_before(rq_fifo_time(next), rq_fifo_time(req))) {
+			list_move(&req->queuelist, &next->queuelist);
+			rq_set_fifo_time(req, rq_fifo_time(next));
+		}
+	}
+
+	/*
+	 * kill knowledge of next, this one is a goner
+	 */
+	flash_remove_request(q, next);
+}
+
+static void flash_record_size(struct flash_data *fd, struct request *rq)
+{
+	unsigned int bytes = blk_rq_bytes(rq);
+	int bucket = bytes ? ilog2(bytes) - 9 : 0;
+
+	bucket = clamp(bucket, 0, FLASH_HIST_BUCKETS - 1);
+	fd->size_hist[rq_data_dir(rq)][bucket]++;
+}
+
+/*
+ * flash_choose_fifo selects the fifo to serve the next batch from, or
+ * returns NULL if there is nothing to do.
+ */
+static struct list_head *flash_choose_fifo(struct flash_data *fd)
+{
+	/* fifos in dispatch priority order */
+	static const int prio[4][2] = {
+		{ 1, READ }, { 1, WRITE }, { 0, READ }, { 0, WRITE }
+	};
+	struct list_head *fifo, *expired = NULL;
+	unsigned long oldest = 0;
+	struct request *rq;
+	int i;
+
+	/*
+	 * A fifo whose head request has outlived its deadline is served
+	 * first, oldest deadline wins.
+	 */
+	for (i = 0; i < 4; i++) {
+		fifo = &fd->fifo_list[prio[i][0]][prio[i][1]];
+		if (list_empty(fifo))
+			continue;
+
+		rq = rq_entry_fifo(fifo->next);
+		if (time_after_eq(jiffies, rq_fifo_time(rq)) &&
+		    (!expired || time_before(rq_fifo_time(rq), oldest))) {
+			expired = fifo;
+			oldest = rq_fifo_time(rq);
+		}
+	}
+	if (expired)
+		return expired;
+
+	/*
+	 * No deadline pressure: serve in priority order, but do not let
+	 * async writes be passed over forever.
+	 */
+	fifo = &fd->fifo_list[0][WRITE];
+	if (!list_empty(fifo) && fd->starved >= fd->writes_starved)
+		return fifo;
+
+	for (i = 0; i < 4; i++) {
+		fifo = &fd->fifo_list[prio[i][0]][prio[i][1]];
+		if (!list_empty(fifo)) {
+			if (!list_empty(&fd->fifo_list[0][WRITE]) &&
+			    fifo != &fd->fifo_list[0][WRITE])
+				fd->starved++;
+			return fifo;
+		}
+	}
+
+	return NULL;
+}
+
+static int flash_dispatch_requests(struct request_queue *q, int force)
+{
+	struct flash_data *fd = q->elevator->elevator_data;
+	struct list_head *fifo = fd->batch_fifo;
+	struct request *rq;
+
+	/*
+	 * keep feeding the current batch while it lasts - batches of
+	 * contiguous writes are what the driver can coalesce into aligned
+	 * write-block sized transfers
+	 */
+	if (!fifo || list_empty(fifo) || fd->batching >= fd->fifo_batch) {
+		fifo = flash_choose_fifo(fd);
+		if (!fifo)
+			return 0;
+
+		if (fifo == &fd->fifo_list[0][WRITE])
+			fd->starved = 0;
+		fd->batch_fifo = fifo;
+		fd->batching = 0;
+	}
+
+	rq = rq_entry_fifo(fifo->next);
+	fd->batching++;
+	flash_record_size(fd, rq);
+	flash_remove_request(q, rq);
+	elv_dispatch_add_tail(q, rq);
+
+	return 1;
+}
+
+static void flash_exit_queue(struct elevator_queue *e)
+{
+	struct flash_data *fd = e->elevator_data;
+	int sync, data_dir;
+
+	for (sync = 0; sync <= 1; sync++)
+		for (data_dir = READ; data_dir <= WRITE; data_dir++)
+			BUG_ON(!list_empty(&fd->fifo_list[sync][data_dir]));
+
+	kfree(fd);
+}
+
+/*
+ * initialize elevator private data (flash_data).
+ */
+static int flash_init_queue(struct request_queue *q)
+{
+	struct flash_data *fd;
+	int sync, data_dir;
+
+	fd = kmalloc_node(sizeof(*fd), GFP_KERNEL | __GFP_ZERO, q->node);
+	if (!fd)
+		return -ENOMEM;
+
+	for (sync = 0; sync <= 1; sync++)
+		for (data_dir = READ; data_dir <= WRITE; data_dir++)
+			INIT_LIST_HEAD(&fd->fifo_list[sync][data_dir]);
+
+	fd->sort_list[READ] = RB_ROOT;
+	fd->sort_list[WRITE] = RB_ROOT;
+	fd->fifo_expire[1][READ] = sync_read_expire;
+	fd->fifo_expire[1][WRITE] = sync_write_expire;
+	fd->fifo_expire[0][READ] = async_read_expire;
+	fd->fifo_expire[0][WRITE] = async_write_expire;
+	fd->writes_starved = writes_starved;
+	fd->front_merges = 1;
+	fd->fifo_batch = fifo_batch;
+
+	q->elevator->elevator_data = fd;
+	return 0;
+}
+
+/*
+ * sysfs parts below
+ */
+
+static ssize_t
+flash_var_show(int var, char *page)
+{
+	return sprintf(page, "%d\n", var);
+}
+
+static ssize_t
+flash_var_store(int *var, const char *page, size_t count)
+{
+	char *p = (char *) page;
+
+	*var = simple_strtol(p, &p, 10);
+	return count;
+}
+
+#define SHOW_FUNCTION(__FUNC, __VAR, __CONV)				\
+static ssize_t __FUNC(struct elevator_queue *e, char *page)		\
+{									\
+	struct flash_data *fd = e->elevator_data;			\
+	int __data = __VAR;						\
+	if (__CONV)							\
+		__data = jiffies_to_msecs(__data);			\
+	return flash_var_show(__data, (page));				\
+}
+SHOW_FUNCTION(flash_sync_read_expire_show, fd->fifo_expire[1][READ], 1);
+SHOW_FUNCTION(flash_sync_write_expire_show, fd->fifo_expire[1][WRITE], 1);
+SHOW_FUNCTION(flash_async_read_expire_show, fd->fifo_expire[0][READ], 1);
+SHOW_FUNCTION(flash_async_write_expire_show, fd->fifo_expire[0][WRITE], 1);
+SHOW_FUNCTION(flash_writes_starved_show, fd->writes_starved, 0);
+SHOW_FUNCTION(flash_front_merges_show, fd->front_merges, 0);
+SHOW_FUNCTION(flash_fifo_batch_show, fd->fifo_batch, 0);
+#undef SHOW_FUNCTION
+
+#define STORE_FUNCTION(__FUNC, __PTR, MIN, MAX, __CONV)			\
+static ssize_t __FUNC(struct elevator_queue *e, const char *page, size_t count)	\
+{									\
+	struct flash_data *fd = e->elevator_data;			\
+	int __data;							\
+	int ret = flash_var_store(&__data, (page), count);		\
+	if (__data < (MIN))						\
+		__data = (MIN);						\
+	else if (__data > (MAX))					\
+		__data = (MAX);						\
+	if (__CONV)							\
+		*(__PTR) = msecs_to_jiffies(__data);			\
+	else								\
+		*(__PTR) = __data;					\
+	return ret;							\
+}
+STORE_FUNCTION(flash_sync_read_expire_store, &fd->fifo_expire[1][READ], 0, INT_MAX, 1);
+STORE_FUNCTION(flash_sync_write_expire_store, &fd->fifo_expire[1][WRITE], 0, INT_MAX, 1);
+STORE_FUNCTION(flash_async_read_expire_store, &fd->fifo_expire[0][READ], 0, INT_MAX, 1);
+STORE_FUNCTION(flash_async_write_expire_store, &fd->fifo_expire[0][WRITE], 0, INT_MAX, 1);
+STORE_FUNCTION(flash_writes_starved_store, &fd->writes_starved, 0, INT_MAX, 0);
+STORE_FUNCTION(flash_front_merges_store, &fd->front_merges, 0, 1, 0);
+STORE_FUNCTION(flash_fifo_batch_store, &fd->fifo_batch, 1, INT_MAX, 0);
+#undef STORE_FUNCTION
+
+/*
+ * Histogram of dispatched request sizes, one bucket per power of two.
+ * Writing anything to the attribute resets the counters, so a measurement
+ * interval can be bracketed.
+ */
+static ssize_t flash_size_hist_show(struct elevator_queue *e, char *page)
+{
+	struct flash_data *fd = e->elevator_data;
+	ssize_t len = 0;
+	int i;
+
+	len += sprintf(page + len, "%10s %10s %10s\n",
+		       "bytes", "reads", "writes");
+	for (i = 0; i < FLASH_HIST_BUCKETS; i++)
+		len += sprintf(page + len, "%10u %10u %10u\n", 512U << i,
+			       fd->size_hist[READ][i],
+			       fd->size_hist[WRITE][i]);
+	return len;
+}
+
+static ssize_t flash_size_hist_store(struct elevator_queue *e,
+				     const char *page, size_t count)
+{
+	struct flash_data *fd = e->elevator_data;
+
+	memset(fd->size_hist, 0, sizeof(fd->size_hist));
+	return count;
+}
+
+#define FD_ATTR(name) \
+	__ATTR(name, S_IRUGO|S_IWUSR, flash_##name##_show, \
+				      flash_##name##_store)
+
+static struct elv_fs_entry flash_attrs[] = {
+	FD_ATTR(sync_read_expire),
+	FD_ATTR(sync_write_expire),
+	FD_ATTR(async_read_expire),
+	FD_ATTR(async_write_expire),
+	FD_ATTR(writes_starved),
+	FD_ATTR(front_merges),
+	FD_ATTR(fifo_batch),
+	FD_ATTR(size_hist),
+	__ATTR_NULL
+};
+
+static struct elevator_type iosched_flash = {
+	.ops = {
+		.elevator_merge_fn =		flash_merge,
+		.elevator_merged_fn =		flash_merged_request,
+		.elevator_merge_req_fn =	flash_merged_requests,
+		.elevator_dispatch_fn =		flash_dispatch_requests,
+		.elevator_add_req_fn =		flash_add_request,
+		.elevator_former_req_fn =	elv_rb_former_request,
+		.elevator_latter_req_fn =	elv_rb_latter_request,
+		.elevator_init_fn =		flash_init_queue,
+		.elevator_exit_fn =		flash_exit_queue,
+	},
+
+	.elevator_attrs = flash_attrs,
+	.elevator_name = "flash",
+	.elevator_owner = THIS_MODULE,
+};
+
+static int __init flash_iosched_init(void)
+{
+	return elv_register(&iosched_flash);
+}
+
+static void __exit flash_iosched_exit(void)
+{
+	elv_unregister(&iosched_flash);
+}
+
+module_init(flash_iosched_init);
+module_exit(flash_iosched_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("flash IO scheduler");
@@ -14,6 +14,7 @@
 
 #include <linux/atomic.h>
 #include <crypto/if_alg.h>
+#include <crypto/scatterwalk.h>
 #include <linux/crypto.h>
 #include <linux/init.h>
 #include <linux/kernel.h>
@@ -365,6 +366,7 @@ int af_alg_make_sg(struct af_alg_sgl *sgl, void __user *addr, int len,
 
 	err = 0;
 
+	sgl->npages = npages;
 	sg_init_table(sgl->sg, npages);
 
 	for (i = 0; i < npages; i++) {
@@ -382,14 +384,25 @@ out:
 }
 EXPORT_SYMBOL_GPL(af_alg_make_sg);
 
+void af_alg_link_sg(struct af_alg_sgl *sgl_prev, struct af_alg_sgl *sgl_new)
+{
+	/*
+	 * sg_init_table() set the end marker on the last data entry;
+	 * clear it (there is no sg_unmark_end()) or the walk stops
+	 * there instead of following the chain entry after it.
+	 */
+	sgl_prev->sg[sgl_prev->npages - 1].page_link &= ~0x02;
+	scatterwalk_sg_chain(sgl_prev->sg, sgl_prev->npages + 1, sgl_new->sg);
+}
+EXPORT_SYMBOL_GPL(af_alg_link_sg);
+
 void af_alg_free_sg(struct af_alg_sgl *sgl)
 {
 	int i;
 
-	i = 0;
-	do {
+	/* can't rely on the end marker, it is cleared when sgls are linked */
+	for (i = 0; i < sgl->npages; i++)
 		put_page(sgl->pages[i]);
-	} while (!sg_is_last(sgl->sg + (i++)));
 }
 EXPORT_SYMBOL_GPL(af_alg_free_sg);
 
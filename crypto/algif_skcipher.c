@@ -31,9 +31,14 @@ struct skcipher_sg_list {
 	struct scatterlist sg[0];
 };
 
+struct skcipher_rsgl {
+	struct list_head list;
+	struct af_alg_sgl sgl;
+};
+
 struct skcipher_ctx {
 	struct list_head tsgl;
-	struct af_alg_sgl rsgl;
+	struct list_head rsgl_list;
 
 	void *iv;
 
@@ -423,9 +428,12 @@ static int skcipher_recvmsg(struct kiocb *unused, struct socket *sock,
 	struct skcipher_ctx *ctx = ask->private;
 	unsigned bs = crypto_ablkcipher_blocksize(crypto_ablkcipher_reqtfm(
 		&ctx->req));
+	struct skcipher_rsgl *rsgl, *tmp;
+	struct af_alg_sgl *last_sgl = NULL;
 	struct skcipher_sg_list *sgl;
 	struct scatterlist *sg;
 	unsigned long iovlen;
+	unsigned long len = 0;
 	struct iovec *iov;
 	int err = -EAGAIN;
 	int used;
@@ -433,64 +441,85 @@ static int skcipher_recvmsg(struct kiocb *unused, struct socket *sock,
 
 	lock_sock(sk);
 	msg->msg_namelen = 0;
-	for (iov = msg->msg_iov, iovlen = msg->msg_iovlen; iovlen > 0;
-	     iovlen--, iov++) {
+
+	if (!ctx->used) {
+		err = skcipher_wait_for_data(sk, flags);
+		if (err)
+			goto unlock;
+	}
+
+	/*
+	 * Pin the whole destination up front and chain the pinned pages
+	 * into one scatterlist, so a single request covering every iovec
+	 * goes to the cipher and a multi-segment read costs one trip
+	 * through the driver instead of one per segment.
+	 */
+	for (iov = msg->msg_iov, iovlen = msg->msg_iovlen;
+	     iovlen > 0 && len < ctx->used; iovlen--, iov++) {
 		unsigned long seglen = iov->iov_len;
 		char __user *from = iov->iov_base;
 
-		while (seglen) {
-			sgl = list_first_entry(&ctx->tsgl,
-					       struct skcipher_sg_list, list);
-			sg = sgl->sg;
+		while (seglen && len < ctx->used) {
+			rsgl = sock_kmalloc(sk, sizeof(*rsgl), GFP_KERNEL);
+			if (!rsgl) {
+				err = -ENOMEM;
+				goto free;
+			}
 
-			while (!sg->length)
-				sg++;
+			used = min_t(unsigned long, seglen, ctx->used - len);
 
-			used = ctx->used;
-			if (!used) {
-				err = skcipher_wait_for_data(sk, flags);
-				if (err)
-					goto unlock;
+			used = af_alg_make_sg(&rsgl->sgl, from, used, 1);
+			if (used < 0) {
+				err = used;
+				sock_kfree_s(sk, rsgl, sizeof(*rsgl));
+				goto free;
 			}
 
-			used = min_t(unsigned long, used, seglen);
+			list_add_tail(&rsgl->list, &ctx->rsgl_list);
+			if (last_sgl)
+				af_alg_link_sg(last_sgl, &rsgl->sgl);
+			last_sgl = &rsgl->sgl;
 
-			used = af_alg_make_sg(&ctx->rsgl, from, used, 1);
-			err = used;
-			if (err < 0)
-				goto unlock;
+			len += used;
+			from += used;
+			seglen -= used;
+		}
+	}
 
-			if (ctx->more || used < ctx->used)
-				used -= used % bs;
+	if (ctx->more || len < ctx->used)
+		len -= len % bs;
 
-			err = -EINVAL;
-			if (!used)
-				goto free;
+	err = -EINVAL;
+	if (!len)
+		goto free;
 
-			ablkcipher_request_set_crypt(&ctx->req, sg,
-						     ctx->rsgl.sg, used,
-						     ctx->iv);
+	sgl = list_first_entry(&ctx->tsgl, struct skcipher_sg_list, list);
+	sg = sgl->sg;
 
-			err = af_alg_wait_for_completion(
-				ctx->enc ?
-					crypto_ablkcipher_encrypt(&ctx->req) :
-					crypto_ablkcipher_decrypt(&ctx->req),
-				&ctx->completion);
+	while (!sg->length)
+		sg++;
 
-free:
-			af_alg_free_sg(&ctx->rsgl);
+	rsgl = list_first_entry(&ctx->rsgl_list, struct skcipher_rsgl, list);
+	ablkcipher_request_set_crypt(&ctx->req, sg, rsgl->sgl.sg, len,
+				     ctx->iv);
 
-			if (err)
-				goto unlock;
+	err = af_alg_wait_for_completion(
+		ctx->enc ?
+			crypto_ablkcipher_encrypt(&ctx->req) :
+			crypto_ablkcipher_decrypt(&ctx->req),
+		&ctx->completion);
 
-			copied += used;
-			from += used;
-			seglen -= used;
-			skcipher_pull_sgl(sk, used);
-		}
+	if (!err) {
+		copied = len;
+		skcipher_pull_sgl(sk, len);
 	}
 
-	err = 0;
+free:
+	list_for_each_entry_safe(rsgl, tmp, &ctx->rsgl_list, list) {
+		af_alg_free_sg(&rsgl->sgl);
+		list_del(&rsgl->list);
+		sock_kfree_s(sk, rsgl, sizeof(*rsgl));
+	}
 
 unlock:
 	skcipher_wmem_wakeup(sk);
@@ -589,6 +618,7 @@ static int skcipher_accept_parent(void *private, struct sock *sk)
 	memset(ctx->iv, 0, crypto_ablkcipher_ivsize(private));
 
 	INIT_LIST_HEAD(&ctx->tsgl);
+	INIT_LIST_HEAD(&ctx->rsgl_list);
 	ctx->len = len;
 	ctx->used = 0;
 	ctx->more = 0;
@@ -436,6 +436,21 @@ out_unlock:
 }
 EXPORT_SYMBOL_GPL(device_attach);
 
+static void __driver_attach_async_helper(void *_dev, async_cookie_t cookie)
+{
+	struct device *dev = _dev;
+	struct device_driver *drv;
+
+	device_lock(dev);
+	drv = dev->p->async_driver;
+	dev->p->async_driver = NULL;
+	if (drv && !dev->driver)
+		driver_probe_device(drv, dev);
+	device_unlock(dev);
+
+	put_device(dev);
+}
+
 static int __driver_attach(struct device *dev, void *data)
 {
 	struct device_driver *drv = data;
@@ -453,6 +468,23 @@ static int __driver_attach(struct device *dev, void *data)
 	if (!driver_match_device(drv, dev))
 		return 0;
 
+	/*
+	 * Probe the device on an async_schedule() thread instead if the
+	 * driver asked for it.  The device reference pins the device until
+	 * the helper has run; wait_for_device_probe() and driver_detach()
+	 * synchronize against the outstanding probes.
+	 */
+	if (drv->probe_async) {
+		device_lock(dev);
+		if (!dev->driver && !dev->p->async_driver) {
+			get_device(dev);
+			dev->p->async_driver = drv;
+			async_schedule(__driver_attach_async_helper, dev);
+		}
+		device_unlock(dev);
+		return 0;
+	}
+
 	if (dev->parent)	/* Needed for USB */
 		device_lock(dev->parent);
 	device_lock(dev);
@@ -546,6 +578,10 @@ void driver_detach(struct device_driver *drv)
 	struct device_private *dev_prv;
 	struct device *dev;
 
+	/* wait for any probes this driver may still have in flight */
+	if (drv->probe_async)
+		async_synchronize_full();
+
 	for (;;) {
 		spin_lock(&drv->p->klist_devices.k_lock);
 		if (list_empty(&drv->p->klist_devices.k_list)) {
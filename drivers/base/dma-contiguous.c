@@ -24,9 +24,11 @@
 
 #include <linux/memblock.h>
 #include <linux/err.h>
+#include <linux/math64.h>
 #include <linux/mm.h>
 #include <linux/mutex.h>
 #include <linux/page-isolation.h>
+#include <linux/sched.h>
 #include <linux/sizes.h>
 #include <linux/slab.h>
 #include <linux/swap.h>
@@ -309,6 +311,8 @@ struct page *dma_alloc_from_contiguous(struct device *dev, int count,
 	unsigned long mask, pfn, pageno, start = 0;
 	struct cma *cma = dev_get_cma_area(dev);
 	struct page *page = NULL;
+	unsigned int retries = 0;
+	u64 stall_start;
 	int ret;
 
 	if (!cma || !cma->count)
@@ -325,6 +329,7 @@ struct page *dma_alloc_from_contiguous(struct device *dev, int count,
 
 	mask = (1 << align) - 1;
 
+	stall_start = local_clock();
 	mutex_lock(&cma_mutex);
 
 	for (;;) {
@@ -346,9 +351,19 @@ struct page *dma_alloc_from_contiguous(struct device *dev, int count,
 			 __func__, pfn_to_page(pfn));
 		/* try again with a bit different memory target */
 		start = pageno + mask + 1;
+		retries++;
 	}
 
 	mutex_unlock(&cma_mutex);
+	/*
+	 * Every allocation here migrates pages out of the contiguous
+	 * range, so account them all; the compaction count doubles as
+	 * the number of contig-range attempts.
+	 */
+	alloc_stall_account(_RET_IP_, get_order(count << PAGE_SHIFT),
+			    div_u64(local_clock() - stall_start,
+				    NSEC_PER_USEC),
+			    retries, retries + 1);
 	pr_debug("%s(): returned %p\n", __func__, page);
 	return page;
 }
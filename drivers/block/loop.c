@@ -69,6 +69,7 @@
 #include <linux/freezer.h>
 #include <linux/mutex.h>
 #include <linux/writeback.h>
+#include <linux/pagemap.h>
 #include <linux/completion.h>
 #include <linux/highmem.h>
 #include <linux/kthread.h>
@@ -408,6 +409,39 @@ lo_receive(struct loop_device *lo, struct bio *bio, int bsize, loff_t pos)
 	return 0;
 }
 
+/*
+ * Emulated direct I/O.  This kernel's direct-IO engine can only target
+ * user pages, so bio pages cannot be handed to it from here.  Instead
+ * LO_FLAGS_DIRECT_IO keeps the backing file's page cache from retaining
+ * the image: once a request's bytes have been copied into (or out of)
+ * the bio, the backing pages behind it are dropped, so a loop-mounted
+ * image is no longer cached twice.  Readahead on the backing file still
+ * runs ahead of the drop point, preserving streaming throughput.
+ * Partially covered edge pages are kept for the neighbouring request,
+ * and dirty pages are skipped by invalidate_mapping_pages() anyway.
+ */
+static void loop_drop_behind(struct loop_device *lo, loff_t pos,
+			     unsigned int len)
+{
+	pgoff_t first = pos >> PAGE_CACHE_SHIFT;
+	pgoff_t last = (pos + len - 1) >> PAGE_CACHE_SHIFT;
+
+	if (!(lo->lo_flags & LO_FLAGS_DIRECT_IO) || !len)
+		return;
+
+	if (pos & (PAGE_CACHE_SIZE - 1))
+		first++;
+	if ((pos + len) & (PAGE_CACHE_SIZE - 1)) {
+		if (!last)
+			return;
+		last--;
+	}
+	if (first > last)
+		return;
+
+	invalidate_mapping_pages(lo->lo_backing_file->f_mapping, first, last);
+}
+
 static int do_bio_filebacked(struct loop_device *lo, struct bio *bio)
 {
 	loff_t pos;
@@ -456,8 +490,13 @@ static int do_bio_filebacked(struct loop_device *lo, struct bio *bio)
 			if (unlikely(ret && ret != -EINVAL))
 				ret = -EIO;
 		}
-	} else
+		if (!ret)
+			loop_drop_behind(lo, pos, bio->bi_size);
+	} else {
 		ret = lo_receive(lo, bio, lo->lo_blocksize, pos);
+		if (!ret)
+			loop_drop_behind(lo, pos, bio->bi_size);
+	}
 
 out:
 	return ret;
@@ -1123,6 +1162,10 @@ loop_set_status(struct loop_device *lo, const struct loop_info64 *info)
 	     (info->lo_flags & LO_FLAGS_AUTOCLEAR))
 		lo->lo_flags ^= LO_FLAGS_AUTOCLEAR;
 
+	if ((lo->lo_flags & LO_FLAGS_DIRECT_IO) !=
+	     (info->lo_flags & LO_FLAGS_DIRECT_IO))
+		lo->lo_flags ^= LO_FLAGS_DIRECT_IO;
+
 	if ((info->lo_flags & LO_FLAGS_PARTSCAN) &&
 	     !(lo->lo_flags & LO_FLAGS_PARTSCAN)) {
 		lo->lo_flags |= LO_FLAGS_PARTSCAN;
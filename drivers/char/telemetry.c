@@ -0,0 +1,196 @@
+/*
+ * Batched binary system statistics snapshot device.
+ *
+ * Monitoring agents that scrape /proc/stat, /proc/meminfo and a set of
+ * /proc/<pid>/stat files pay for text formatting plus one open/read/close
+ * round trip per file on every poll.  /dev/telemetry hands the same
+ * counters over in a single ioctl: a versioned header followed by
+ * caller-sized arrays of per-CPU and per-task records, filled straight
+ * from the per-CPU accounting the proc files are formatted from.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/fs.h>
+#include <linux/miscdevice.h>
+#include <linux/kernel_stat.h>
+#include <linux/mm.h>
+#include <linux/mmzone.h>
+#include <linux/swap.h>
+#include <linux/sched.h>
+#include <linux/uaccess.h>
+#include <linux/telemetry.h>
+#include <asm/cputime.h>
+
+static int telemetry_fill_cpus(void __user *uptr, __u32 *nr)
+{
+	struct telemetry_cpu tc;
+	__u32 filled = 0;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		u64 *cs = kcpustat_cpu(cpu).cpustat;
+
+		if (filled >= *nr)
+			break;
+
+		tc.user = cputime64_to_clock_t(cs[CPUTIME_USER]);
+		tc.nice = cputime64_to_clock_t(cs[CPUTIME_NICE]);
+		tc.system = cputime64_to_clock_t(cs[CPUTIME_SYSTEM]);
+		tc.idle = cputime64_to_clock_t(cs[CPUTIME_IDLE]);
+		tc.iowait = cputime64_to_clock_t(cs[CPUTIME_IOWAIT]);
+		tc.irq = cputime64_to_clock_t(cs[CPUTIME_IRQ]);
+		tc.softirq = cputime64_to_clock_t(cs[CPUTIME_SOFTIRQ]);
+
+		if (copy_to_user(uptr + filled * sizeof(tc), &tc, sizeof(tc)))
+			return -EFAULT;
+		filled++;
+	}
+	*nr = filled;
+	return 0;
+}
+
+static void telemetry_fill_mem(struct telemetry_mem *mem)
+{
+	struct sysinfo i;
+	long cached;
+
+	si_meminfo(&i);
+	si_swapinfo(&i);
+
+	cached = global_page_state(NR_FILE_PAGES) -
+			total_swapcache_pages() - i.bufferram;
+	if (cached < 0)
+		cached = 0;
+
+/* report in kilobytes, like /proc/meminfo */
+#define K(x) ((__u64)(x) << (PAGE_SHIFT - 10))
+	mem->total = K(i.totalram);
+	mem->free = K(i.freeram);
+	mem->buffers = K(i.bufferram);
+	mem->cached = K(cached);
+	mem->swap_total = K(i.totalswap);
+	mem->swap_free = K(i.freeswap);
+#undef K
+}
+
+static void telemetry_fill_task(struct telemetry_task *tt)
+{
+	struct task_struct *task;
+	struct mm_struct *mm;
+	cputime_t utime, stime;
+
+	rcu_read_lock();
+	task = find_task_by_vpid(tt->pid);
+	if (task)
+		get_task_struct(task);
+	rcu_read_unlock();
+
+	if (!task) {
+		tt->state = (__u32)-1;
+		tt->utime = 0;
+		tt->stime = 0;
+		tt->vsize = 0;
+		tt->rss = 0;
+		return;
+	}
+
+	task_cputime_adjusted(task, &utime, &stime);
+	tt->utime = cputime_to_clock_t(utime);
+	tt->stime = cputime_to_clock_t(stime);
+	tt->state = (__u32)task->state;
+
+	mm = get_task_mm(task);
+	if (mm) {
+		tt->vsize = (__u64)mm->total_vm << PAGE_SHIFT;
+		tt->rss = get_mm_rss(mm);
+		mmput(mm);
+	} else {
+		tt->vsize = 0;
+		tt->rss = 0;
+	}
+	put_task_struct(task);
+}
+
+static long telemetry_ioctl(struct file *file, unsigned int cmd,
+			    unsigned long arg)
+{
+	void __user *argp = (void __user *)arg;
+	struct telemetry_snap snap;
+	void __user *tasks;
+	__u32 cpu_cap, i;
+	int err;
+
+	if (cmd != TELEMETRY_IOC_SNAP)
+		return -ENOTTY;
+
+	if (copy_from_user(&snap, argp, sizeof(snap)))
+		return -EFAULT;
+	if (snap.version != TELEMETRY_VERSION)
+		return -EINVAL;
+	if (snap.nr_task > TELEMETRY_MAX_TASKS)
+		return -EINVAL;
+
+	/*
+	 * The caller's capacities fix the buffer layout, so remember the
+	 * CPU array size before clamping the fill count to what exists.
+	 */
+	cpu_cap = snap.nr_cpu;
+	if (snap.nr_cpu > num_possible_cpus())
+		snap.nr_cpu = num_possible_cpus();
+
+	telemetry_fill_mem(&snap.mem);
+
+	err = telemetry_fill_cpus(argp + sizeof(snap), &snap.nr_cpu);
+	if (err)
+		return err;
+
+	tasks = argp + sizeof(snap) +
+		cpu_cap * sizeof(struct telemetry_cpu);
+	for (i = 0; i < snap.nr_task; i++) {
+		struct telemetry_task tt;
+		void __user *uptr = tasks + i * sizeof(tt);
+
+		if (copy_from_user(&tt, uptr, sizeof(tt)))
+			return -EFAULT;
+		telemetry_fill_task(&tt);
+		if (copy_to_user(uptr, &tt, sizeof(tt)))
+			return -EFAULT;
+	}
+
+	if (copy_to_user(argp, &snap, sizeof(snap)))
+		return -EFAULT;
+	return 0;
+}
+
+static const struct file_operations telemetry_fops = {
+	.owner		= THIS_MODULE,
+	.unlocked_ioctl	= telemetry_ioctl,
+	.llseek		= noop_llseek,
+};
+
+static struct miscdevice telemetry_misc = {
+	.minor	= MISC_DYNAMIC_MINOR,
+	.name	= "telemetry",
+	.fops	= &telemetry_fops,
+};
+
+static int __init telemetry_init(void)
+{
+	return misc_register(&telemetry_misc);
+}
+
+static void __exit telemetry_exit(void)
+{
+	misc_deregister(&telemetry_misc);
+}
+
+module_init(telemetry_init);
+module_exit(telemetry_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Batched binary system statistics snapshot device");
@@ -16,6 +16,7 @@
 
 #include <linux/cdev.h>
 #include <linux/clk.h>
+#include <linux/crc32.h>
 #include <linux/dma-mapping.h>
 #include <linux/fs.h>
 #include <linux/init.h>
@@ -23,15 +24,19 @@
 #include <linux/io.h>
 #include <linux/ioport.h>
 #include <linux/kernel.h>
+#include <linux/mm.h>
 #include <linux/module.h>
 #include <linux/mutex.h>
 #include <linux/of.h>
+#include <linux/pagemap.h>
 #include <linux/platform_device.h>
+#include <linux/sched.h>
 #include <linux/slab.h>
 #include <linux/string.h>
 #include <linux/sysctl.h>
 #include <linux/types.h>
 #include <linux/uaccess.h>
+#include <linux/xilinx_devcfg.h>
 
 extern void xslcr_init_preload_fpga(void);
 extern void xslcr_init_postload_fpga(void);
@@ -39,6 +44,9 @@ extern void xslcr_init_postload_fpga(void);
 #define DRIVER_NAME "xdevcfg"
 #define XDEVCFG_DEVICES 1
 
+/* Bounce buffer size for the in-kernel CRC readback */
+#define XDEVCFG_CRC_CHUNK	(64 * 1024)
+
 /* An array, which is set to true when the device is registered. */
 static DEFINE_MUTEX(xdevcfg_mutex);
 
@@ -103,6 +111,18 @@ static const char * const fclk_name[] = {
 };
 #define NUMFCLKS ARRAY_SIZE(fclk_name)
 
+/**
+ * struct xdevcfg_slot_buf - Cached bitstream slot
+ * @kbuf: Kernel virtual address of the slot DMA buffer
+ * @dma_addr: Bus address of the slot DMA buffer
+ * @len: Length of the cached bitstream in bytes, 0 when the slot is free
+ */
+struct xdevcfg_slot_buf {
+	u32 *kbuf;
+	dma_addr_t dma_addr;
+	u32 len;
+};
+
 /**
  * struct xdevcfg_drvdata - Device Configuration driver structure
  *
@@ -122,6 +142,7 @@ static const char * const fclk_name[] = {
  * @lock: Instance of spinlock
  * @base_address: The virtual device base address of the device registers
  * @is_partial_bitstream: Status bit to indicate partial/full bitstream
+ * @slots: Cached bitstream slots registered through the ioctl interface
  */
 struct xdevcfg_drvdata {
 	struct device *dev;
@@ -141,6 +162,7 @@ struct xdevcfg_drvdata {
 	void __iomem *base_address;
 	int ep107;
 	bool is_partial_bitstream;
+	struct xdevcfg_slot_buf slots[XDEVCFG_MAX_SLOTS];
 };
 
 /**
@@ -227,50 +249,22 @@ static irqreturn_t xdevcfg_irq(int irq, void *data)
 }
 
 /**
- * xdevcfg_write() - The is the driver write function.
+ * xdevcfg_dma_start() - Kick one PCAP DMA write transfer.
  *
- * @file:	Pointer to the file structure.
- * @buf:	Pointer to the bitstream location.
- * @count:	The number of bytes to be written.
- * @ppos:	Pointer to the offset value
- * returns:	Success or error status.
+ * @drvdata:	Pointer to the driver data structure.
+ * @dma_addr:	Bus address of the source data.
+ * @words:	Transfer length in words.
+ *
+ * Clears stale status, unmasks the DMA done and error interrupts and
+ * programs the PCAP DMA registers. The transfer runs asynchronously;
+ * the caller collects it with xdevcfg_dma_wait().
  **/
-static ssize_t
-xdevcfg_write(struct file *file, const char __user *buf, size_t count,
-		loff_t *ppos)
+static void xdevcfg_dma_start(struct xdevcfg_drvdata *drvdata,
+		dma_addr_t dma_addr, u32 words)
 {
-	u32 *kbuf;
-	int status;
-	unsigned long timeout;
-	u32 intr_reg;
-	dma_addr_t dma_addr;
-	u32 transfer_length = 0;
-	struct xdevcfg_drvdata *drvdata = file->private_data;
-
-	status = clk_enable(drvdata->clk);
-	if (status)
-		return status;
-
-	status = mutex_lock_interruptible(&drvdata->sem);
-
-	if (status)
-		goto err_clk;
-
-	kbuf = dma_alloc_coherent(drvdata->dev, count, &dma_addr, GFP_KERNEL);
-	if (!kbuf) {
-		status = -ENOMEM;
-		goto err_unlock;
-	}
-
-	if (copy_from_user(kbuf, buf, count)) {
-		status = -EFAULT;
-		goto error;
-	}
-	/* Enable DMA and error interrupts */
 	xdevcfg_writereg(drvdata->base_address + XDCFG_INT_STS_OFFSET,
 				XDCFG_IXR_ALL_MASK);
 
-
 	xdevcfg_writereg(drvdata->base_address + XDCFG_INT_MASK_OFFSET,
 				(u32) (~(XDCFG_IXR_DMA_DONE_MASK |
 				XDCFG_IXR_ERROR_FLAGS_MASK)));
@@ -279,34 +273,69 @@ xdevcfg_write(struct file *file, const char __user *buf, size_t count,
 	drvdata->error_status = 0;
 
 	/* Initiate DMA write command */
-	if (count < 0x1000)
-		xdevcfg_writereg(drvdata->base_address +
-			XDCFG_DMA_SRC_ADDR_OFFSET, (u32)(dma_addr + 1));
-	else
-		xdevcfg_writereg(drvdata->base_address +
-			XDCFG_DMA_SRC_ADDR_OFFSET, (u32) dma_addr);
-
+	xdevcfg_writereg(drvdata->base_address + XDCFG_DMA_SRC_ADDR_OFFSET,
+				(u32) dma_addr);
 	xdevcfg_writereg(drvdata->base_address + XDCFG_DMA_DEST_ADDR_OFFSET,
 				(u32)XDCFG_DMA_INVALID_ADDRESS);
-	/* Convert number of bytes to number of words.  */
-	if (count % 4)
-		transfer_length	= (count / 4 + 1);
-	else
-		transfer_length	= count / 4;
 	xdevcfg_writereg(drvdata->base_address + XDCFG_DMA_SRC_LEN_OFFSET,
-				transfer_length);
+				words);
 	xdevcfg_writereg(drvdata->base_address + XDCFG_DMA_DEST_LEN_OFFSET, 0);
+}
+
+/**
+ * xdevcfg_dma_start_read() - Kick one PCAP DMA readback transfer.
+ *
+ * @drvdata:	Pointer to the driver data structure.
+ * @dma_addr:	Bus address of the destination buffer.
+ * @words:	Transfer length in words.
+ *
+ * Counterpart of xdevcfg_dma_start() for the readback direction; the
+ * caller collects the transfer with xdevcfg_dma_wait().
+ **/
+static void xdevcfg_dma_start_read(struct xdevcfg_drvdata *drvdata,
+		dma_addr_t dma_addr, u32 words)
+{
+	xdevcfg_writereg(drvdata->base_address + XDCFG_INT_STS_OFFSET,
+				XDCFG_IXR_ALL_MASK);
+
+	xdevcfg_writereg(drvdata->base_address + XDCFG_INT_MASK_OFFSET,
+				(u32) (~(XDCFG_IXR_DMA_DONE_MASK |
+				XDCFG_IXR_ERROR_FLAGS_MASK)));
+
+	drvdata->dma_done = 0;
+	drvdata->error_status = 0;
 
-	timeout = jiffies + msecs_to_jiffies(1000);
+	/* Initiate DMA read command */
+	xdevcfg_writereg(drvdata->base_address + XDCFG_DMA_SRC_ADDR_OFFSET,
+				(u32)XDCFG_DMA_INVALID_ADDRESS);
+	xdevcfg_writereg(drvdata->base_address + XDCFG_DMA_DEST_ADDR_OFFSET,
+				(u32) dma_addr);
+	xdevcfg_writereg(drvdata->base_address + XDCFG_DMA_SRC_LEN_OFFSET, 0);
+	xdevcfg_writereg(drvdata->base_address + XDCFG_DMA_DEST_LEN_OFFSET,
+				words);
+}
+
+/**
+ * xdevcfg_dma_wait() - Wait for the transfer started with xdevcfg_dma_start.
+ *
+ * @drvdata:	Pointer to the driver data structure.
+ * returns:	0 on success, -ETIMEDOUT or the captured error status on
+ *		failure.
+ **/
+static int xdevcfg_dma_wait(struct xdevcfg_drvdata *drvdata)
+{
+	unsigned long timeout = jiffies + msecs_to_jiffies(1000);
+	u32 intr_reg;
+	int status = 0;
 
 	while (!drvdata->dma_done) {
 		if (time_after(jiffies, timeout)) {
-				status = -ETIMEDOUT;
-				goto error;
+			status = -ETIMEDOUT;
+			break;
 		}
 	}
 
-	if (drvdata->error_status)
+	if (!status && drvdata->error_status)
 		status = drvdata->error_status;
 
 	/* Disable the DMA and error interrupts */
@@ -316,101 +345,355 @@ xdevcfg_write(struct file *file, const char __user *buf, size_t count,
 				intr_reg | (XDCFG_IXR_DMA_DONE_MASK |
 				XDCFG_IXR_ERROR_FLAGS_MASK));
 
-	/* If we didn't write correctly, then bail out. */
-	if (status) {
+	return status;
+}
+
+/**
+ * xdevcfg_map_run() - DMA-map the next physically contiguous run of pages.
+ *
+ * @drvdata:	Pointer to the driver data structure.
+ * @pages:	Array of pinned user pages.
+ * @nr_pages:	Size of the page array.
+ * @idx:	In/out index of the first unconsumed page.
+ * @offset:	Byte offset into the first page of the run.
+ * @remaining:	Bytes of the bitstream still to be transferred.
+ * @dma_addr:	Output bus address of the mapped run.
+ * @dir:	DMA direction of the transfer.
+ * returns:	Length of the mapped run in bytes, 0 on mapping error.
+ *
+ * The PCAP DMA has no scatter gather support, so the pinned user buffer
+ * is fed to it as runs of physically contiguous pages.
+ **/
+static size_t xdevcfg_map_run(struct xdevcfg_drvdata *drvdata,
+		struct page **pages, int nr_pages, int *idx,
+		unsigned int offset, size_t remaining, dma_addr_t *dma_addr,
+		enum dma_data_direction dir)
+{
+	int first = *idx;
+	int i = first;
+	size_t avail = PAGE_SIZE - offset;
+
+	while (i + 1 < nr_pages && avail < remaining &&
+			page_to_pfn(pages[i + 1]) ==
+			page_to_pfn(pages[i]) + 1) {
+		i++;
+		avail += PAGE_SIZE;
+	}
+	*idx = i + 1;
+
+	if (avail > remaining)
+		avail = remaining;
+
+	*dma_addr = dma_map_page(drvdata->dev, pages[first], offset, avail,
+				dir);
+	if (dma_mapping_error(drvdata->dev, *dma_addr))
+		return 0;
+
+	return avail;
+}
+
+/**
+ * xdevcfg_write_direct() - Stream pinned user pages into the PCAP.
+ *
+ * @drvdata:	Pointer to the driver data structure.
+ * @buf:	Pointer to the bitstream location.
+ * @count:	The number of bytes to be written.
+ * returns:	Number of bytes written, -EAGAIN if the pages could not be
+ *		pinned (caller falls back to the bounce buffer), or an
+ *		error status.
+ *
+ * Pins the user buffer and feeds it to the PCAP DMA run by run without
+ * copying it. While one run is in flight the next one is DMA-mapped, so
+ * the cache maintenance of run N+1 overlaps the configuration transfer
+ * of run N.
+ **/
+static ssize_t xdevcfg_write_direct(struct xdevcfg_drvdata *drvdata,
+		const char __user *buf, size_t count)
+{
+	struct page **pages;
+	dma_addr_t cur_addr, next_addr;
+	size_t cur_len, next_len;
+	size_t remaining = count;
+	unsigned long first_page = (unsigned long)buf >> PAGE_SHIFT;
+	unsigned long last_page = ((unsigned long)buf + count - 1) >>
+					PAGE_SHIFT;
+	int nr_pages = last_page - first_page + 1;
+	int pinned, idx, i;
+	int status = 0;
+
+	pages = kmalloc(nr_pages * sizeof(*pages), GFP_KERNEL);
+	if (!pages)
+		return -EAGAIN;
+
+	down_read(&current->mm->mmap_sem);
+	pinned = get_user_pages(current, current->mm, (unsigned long)buf,
+				nr_pages, 0, 0, pages, NULL);
+	up_read(&current->mm->mmap_sem);
+
+	if (pinned < nr_pages) {
+		for (i = 0; i < pinned; i++)
+			page_cache_release(pages[i]);
+		kfree(pages);
+		return -EAGAIN;
+	}
+
+	idx = 0;
+	cur_len = xdevcfg_map_run(drvdata, pages, nr_pages, &idx,
+				offset_in_page(buf), remaining, &cur_addr,
+				DMA_TO_DEVICE);
+	if (!cur_len) {
+		status = -ENOMEM;
+		goto out_release;
+	}
+
+	while (cur_len) {
+		next_len = 0;
+		next_addr = 0;
+
+		/*
+		 * Round a trailing partial word up; it cannot cross the
+		 * end of the pinned page since page ends are word aligned.
+		 */
+		xdevcfg_dma_start(drvdata, cur_addr, (cur_len + 3) / 4);
+
+		/* Map the next run while this one configures the PL */
+		remaining -= cur_len;
+		if (remaining)
+			next_len = xdevcfg_map_run(drvdata, pages, nr_pages,
+						&idx, 0, remaining,
+						&next_addr, DMA_TO_DEVICE);
+
+		status = xdevcfg_dma_wait(drvdata);
+		if (status > 0)
+			status = -EFAULT;
+		dma_unmap_page(drvdata->dev, cur_addr, cur_len,
+				DMA_TO_DEVICE);
+
+		if (status) {
+			if (next_len)
+				dma_unmap_page(drvdata->dev, next_addr,
+						next_len, DMA_TO_DEVICE);
+			break;
+		}
+
+		if (remaining && !next_len) {
+			status = -ENOMEM;
+			break;
+		}
+
+		cur_len = next_len;
+		cur_addr = next_addr;
+	}
+
+out_release:
+	for (i = 0; i < nr_pages; i++)
+		page_cache_release(pages[i]);
+	kfree(pages);
+
+	return status ? status : count;
+}
+
+/**
+ * xdevcfg_write_bounce() - Copy the bitstream and write it with one DMA.
+ *
+ * @drvdata:	Pointer to the driver data structure.
+ * @buf:	Pointer to the bitstream location.
+ * @count:	The number of bytes to be written.
+ * returns:	Number of bytes written or error status.
+ **/
+static ssize_t xdevcfg_write_bounce(struct xdevcfg_drvdata *drvdata,
+		const char __user *buf, size_t count)
+{
+	u32 *kbuf;
+	int status;
+	dma_addr_t dma_addr;
+	u32 transfer_length = 0;
+
+	kbuf = dma_alloc_coherent(drvdata->dev, count, &dma_addr, GFP_KERNEL);
+	if (!kbuf)
+		return -ENOMEM;
+
+	if (copy_from_user(kbuf, buf, count)) {
 		status = -EFAULT;
 		goto error;
 	}
 
-	status = count;
+	/* Convert number of bytes to number of words.  */
+	if (count % 4)
+		transfer_length	= (count / 4 + 1);
+	else
+		transfer_length	= count / 4;
+
+	if (count < 0x1000)
+		xdevcfg_dma_start(drvdata, dma_addr + 1, transfer_length);
+	else
+		xdevcfg_dma_start(drvdata, dma_addr, transfer_length);
+
+	status = xdevcfg_dma_wait(drvdata);
+
+	/* If we didn't write correctly, then bail out. */
+	if (status > 0)
+		status = -EFAULT;
+
+	if (!status)
+		status = count;
 
 error:
 	dma_free_coherent(drvdata->dev, count, kbuf, dma_addr);
-err_unlock:
-	mutex_unlock(&drvdata->sem);
-err_clk:
-	clk_disable(drvdata->clk);
 	return status;
 }
 
-
 /**
- * xdevcfg_read() - The is the driver read function.
+ * xdevcfg_write() - The is the driver write function.
+ *
  * @file:	Pointer to the file structure.
  * @buf:	Pointer to the bitstream location.
- * @count:	The number of bytes read.
- * @ppos:	Pointer to the offsetvalue
+ * @count:	The number of bytes to be written.
+ * @ppos:	Pointer to the offset value
  * returns:	Success or error status.
- */
+ **/
 static ssize_t
-xdevcfg_read(struct file *file, char __user *buf, size_t count, loff_t *ppos)
+xdevcfg_write(struct file *file, const char __user *buf, size_t count,
+		loff_t *ppos)
 {
-	u32 *kbuf;
 	int status;
-	unsigned long timeout;
-	dma_addr_t dma_addr;
 	struct xdevcfg_drvdata *drvdata = file->private_data;
-	u32 intr_reg;
 
 	status = clk_enable(drvdata->clk);
 	if (status)
 		return status;
 
 	status = mutex_lock_interruptible(&drvdata->sem);
+
 	if (status)
 		goto err_clk;
 
-	/* Get new data from the ICAP, and return was requested. */
-	kbuf = dma_alloc_coherent(drvdata->dev, count, &dma_addr, GFP_KERNEL);
-	if (!kbuf) {
-		status = -ENOMEM;
-		goto err_unlock;
+	/*
+	 * Large word-aligned bitstreams are streamed into the PCAP
+	 * straight from the pinned user pages; copying a full bitstream
+	 * into a bounce buffer costs more than the configuration DMA
+	 * itself. Small or misaligned writes keep the bounce buffer,
+	 * which also preserves the short-transfer source address quirk.
+	 */
+	if (count >= 0x1000 && !((unsigned long)buf & 3)) {
+		status = xdevcfg_write_direct(drvdata, buf, count);
+		if (status != -EAGAIN)
+			goto out_unlock;
 	}
 
-	drvdata->dma_done = 0;
-	drvdata->error_status = 0;
+	status = xdevcfg_write_bounce(drvdata, buf, count);
 
-	/* Enable DMA and error interrupts */
-	xdevcfg_writereg(drvdata->base_address + XDCFG_INT_STS_OFFSET,
-				XDCFG_IXR_ALL_MASK);
+out_unlock:
+	mutex_unlock(&drvdata->sem);
+err_clk:
+	clk_disable(drvdata->clk);
+	return status;
+}
 
-	xdevcfg_writereg(drvdata->base_address + XDCFG_INT_MASK_OFFSET,
-				(u32) (~(XDCFG_IXR_DMA_DONE_MASK |
-				XDCFG_IXR_ERROR_FLAGS_MASK)));
-	/* Initiate DMA read command */
-	xdevcfg_writereg(drvdata->base_address + XDCFG_DMA_SRC_ADDR_OFFSET,
-				(u32)XDCFG_DMA_INVALID_ADDRESS);
-	xdevcfg_writereg(drvdata->base_address + XDCFG_DMA_DEST_ADDR_OFFSET,
-				(u32)dma_addr);
-	xdevcfg_writereg(drvdata->base_address + XDCFG_DMA_SRC_LEN_OFFSET, 0);
-	xdevcfg_writereg(drvdata->base_address + XDCFG_DMA_DEST_LEN_OFFSET,
-				count / 4);
 
-	timeout = jiffies + msecs_to_jiffies(1000);
+/**
+ * xdevcfg_read_direct() - Read configuration back into pinned user pages.
+ *
+ * @drvdata:	Pointer to the driver data structure.
+ * @buf:	Pointer to the readback destination.
+ * @count:	The number of bytes to read.
+ * returns:	Number of bytes read, -EAGAIN if the pages could not be
+ *		pinned (caller falls back to the bounce buffer), or an
+ *		error status.
+ *
+ * Pins the user buffer and lets the PCAP DMA deposit the readback data
+ * straight into it, run by run. Unlike the write side there is no
+ * point in mapping the next run ahead of time: invalidating a run is
+ * only legal once the readback data has landed in it.
+ **/
+static ssize_t xdevcfg_read_direct(struct xdevcfg_drvdata *drvdata,
+		char __user *buf, size_t count)
+{
+	struct page **pages;
+	dma_addr_t cur_addr;
+	size_t cur_len;
+	size_t remaining = count;
+	unsigned long first_page = (unsigned long)buf >> PAGE_SHIFT;
+	unsigned long last_page = ((unsigned long)buf + count - 1) >>
+					PAGE_SHIFT;
+	int nr_pages = last_page - first_page + 1;
+	int pinned, idx, i;
+	int status = 0;
+
+	pages = kmalloc(nr_pages * sizeof(*pages), GFP_KERNEL);
+	if (!pages)
+		return -EAGAIN;
+
+	down_read(&current->mm->mmap_sem);
+	pinned = get_user_pages(current, current->mm, (unsigned long)buf,
+				nr_pages, 1, 0, pages, NULL);
+	up_read(&current->mm->mmap_sem);
+
+	if (pinned < nr_pages) {
+		for (i = 0; i < pinned; i++)
+			page_cache_release(pages[i]);
+		kfree(pages);
+		return -EAGAIN;
+	}
 
-	while (!drvdata->dma_done) {
-		if (time_after(jiffies, timeout)) {
-			status = -ETIMEDOUT;
-			goto error;
+	idx = 0;
+	while (remaining && !status) {
+		cur_len = xdevcfg_map_run(drvdata, pages, nr_pages, &idx,
+					remaining == count ?
+						offset_in_page(buf) : 0,
+					remaining, &cur_addr,
+					DMA_FROM_DEVICE);
+		if (!cur_len) {
+			status = -ENOMEM;
+			break;
 		}
+
+		xdevcfg_dma_start_read(drvdata, cur_addr, cur_len / 4);
+		status = xdevcfg_dma_wait(drvdata);
+		if (status > 0)
+			status = -EFAULT;
+		dma_unmap_page(drvdata->dev, cur_addr, cur_len,
+				DMA_FROM_DEVICE);
+		remaining -= cur_len;
 	}
 
-	if (drvdata->error_status)
-		status = drvdata->error_status;
+	for (i = 0; i < nr_pages; i++) {
+		set_page_dirty_lock(pages[i]);
+		page_cache_release(pages[i]);
+	}
+	kfree(pages);
 
-	/* Disable and clear DMA and error interrupts */
-	intr_reg = xdevcfg_readreg(drvdata->base_address +
-					XDCFG_INT_MASK_OFFSET);
-	xdevcfg_writereg(drvdata->base_address + XDCFG_INT_MASK_OFFSET,
-				intr_reg | (XDCFG_IXR_DMA_DONE_MASK |
-				XDCFG_IXR_ERROR_FLAGS_MASK));
+	return status ? status : count;
+}
 
+/**
+ * xdevcfg_read_bounce() - Read configuration back through a bounce buffer.
+ *
+ * @drvdata:	Pointer to the driver data structure.
+ * @buf:	Pointer to the readback destination.
+ * @count:	The number of bytes to read.
+ * returns:	Number of bytes read or error status.
+ **/
+static ssize_t xdevcfg_read_bounce(struct xdevcfg_drvdata *drvdata,
+		char __user *buf, size_t count)
+{
+	u32 *kbuf;
+	int status;
+	dma_addr_t dma_addr;
+
+	kbuf = dma_alloc_coherent(drvdata->dev, count, &dma_addr, GFP_KERNEL);
+	if (!kbuf)
+		return -ENOMEM;
+
+	xdevcfg_dma_start_read(drvdata, dma_addr, count / 4);
+
+	status = xdevcfg_dma_wait(drvdata);
 
 	/* If we didn't read correctly, then bail out. */
-	if (status) {
+	if (status > 0)
 		status = -EFAULT;
+	if (status)
 		goto error;
-	}
 
 	/* If we fail to return the data to the user, then bail out. */
 	if (copy_to_user(buf, kbuf, count)) {
@@ -421,7 +704,278 @@ xdevcfg_read(struct file *file, char __user *buf, size_t count, loff_t *ppos)
 	status = count;
 error:
 	dma_free_coherent(drvdata->dev, count, kbuf, dma_addr);
-err_unlock:
+	return status;
+}
+
+/**
+ * xdevcfg_read() - The is the driver read function.
+ * @file:	Pointer to the file structure.
+ * @buf:	Pointer to the bitstream location.
+ * @count:	The number of bytes read.
+ * @ppos:	Pointer to the offsetvalue
+ * returns:	Success or error status.
+ */
+static ssize_t
+xdevcfg_read(struct file *file, char __user *buf, size_t count, loff_t *ppos)
+{
+	int status;
+	struct xdevcfg_drvdata *drvdata = file->private_data;
+
+	status = clk_enable(drvdata->clk);
+	if (status)
+		return status;
+
+	status = mutex_lock_interruptible(&drvdata->sem);
+	if (status)
+		goto err_clk;
+
+	/*
+	 * Large word-sized reads land straight in the pinned user
+	 * buffer; bouncing a full-device readback costs more than the
+	 * readback DMA itself. Small or misaligned reads keep the
+	 * bounce buffer.
+	 */
+	if (count >= 0x1000 && !((unsigned long)buf & 3) && !(count & 3)) {
+		status = xdevcfg_read_direct(drvdata, buf, count);
+		if (status != -EAGAIN)
+			goto out_unlock;
+	}
+
+	status = xdevcfg_read_bounce(drvdata, buf, count);
+
+out_unlock:
+	mutex_unlock(&drvdata->sem);
+err_clk:
+	clk_disable(drvdata->clk);
+
+	return status;
+}
+
+/**
+ * xdevcfg_register_slot() - Cache a bitstream in a DMA-ready slot.
+ * @drvdata:	Pointer to the driver data structure.
+ * @arg:	Userspace pointer to the slot registration structure.
+ * returns:	Success or error status.
+ *
+ * The bitstream is copied from userspace into a coherent DMA buffer
+ * once, so later loads of the slot skip the copy and buffer setup
+ * entirely. The buffer is held until the slot is unregistered or the
+ * driver is removed.
+ **/
+static int xdevcfg_register_slot(struct xdevcfg_drvdata *drvdata,
+		const struct xdevcfg_slot __user *arg)
+{
+	struct xdevcfg_slot reg;
+	struct xdevcfg_slot_buf *slot;
+	dma_addr_t dma_addr;
+	u32 *kbuf;
+
+	if (copy_from_user(&reg, arg, sizeof(reg)))
+		return -EFAULT;
+
+	if (reg.slot >= XDEVCFG_MAX_SLOTS || !reg.len)
+		return -EINVAL;
+
+	slot = &drvdata->slots[reg.slot];
+	if (slot->len)
+		return -EBUSY;
+
+	kbuf = dma_alloc_coherent(drvdata->dev, reg.len, &dma_addr,
+				GFP_KERNEL);
+	if (!kbuf)
+		return -ENOMEM;
+
+	if (copy_from_user(kbuf, (const void __user *)(unsigned long)reg.addr,
+				reg.len)) {
+		dma_free_coherent(drvdata->dev, reg.len, kbuf, dma_addr);
+		return -EFAULT;
+	}
+
+	slot->kbuf = kbuf;
+	slot->dma_addr = dma_addr;
+	slot->len = reg.len;
+
+	return 0;
+}
+
+/**
+ * xdevcfg_free_slot() - Release the DMA buffer held by a slot.
+ * @drvdata:	Pointer to the driver data structure.
+ * @slot:	Pointer to the slot to be freed.
+ **/
+static void xdevcfg_free_slot(struct xdevcfg_drvdata *drvdata,
+		struct xdevcfg_slot_buf *slot)
+{
+	dma_free_coherent(drvdata->dev, slot->len, slot->kbuf,
+			slot->dma_addr);
+	slot->kbuf = NULL;
+	slot->len = 0;
+}
+
+/**
+ * xdevcfg_load_slot() - Configure the PL from a cached bitstream slot.
+ * @drvdata:	Pointer to the driver data structure.
+ * @index:	Index of the slot to be loaded.
+ * returns:	Success or error status.
+ *
+ * Runs the same PL sequencing an open/write/release cycle would run,
+ * but transfers the bitstream straight out of the cached DMA buffer.
+ **/
+static int xdevcfg_load_slot(struct xdevcfg_drvdata *drvdata, u32 index)
+{
+	struct xdevcfg_slot_buf *slot;
+	u32 transfer_length;
+	int status;
+
+	if (index >= XDEVCFG_MAX_SLOTS)
+		return -EINVAL;
+
+	slot = &drvdata->slots[index];
+	if (!slot->len)
+		return -ENXIO;
+
+	if (!drvdata->is_partial_bitstream)
+		xslcr_init_preload_fpga();
+
+	if ((!drvdata->ep107) && (!drvdata->is_partial_bitstream))
+		xdevcfg_reset_pl(drvdata->base_address);
+
+	xdevcfg_writereg(drvdata->base_address + XDCFG_INT_STS_OFFSET,
+			XDCFG_IXR_PCFG_DONE_MASK);
+
+	transfer_length = (slot->len + 3) / 4;
+	if (slot->len < 0x1000)
+		xdevcfg_dma_start(drvdata, slot->dma_addr + 1,
+				transfer_length);
+	else
+		xdevcfg_dma_start(drvdata, slot->dma_addr, transfer_length);
+
+	status = xdevcfg_dma_wait(drvdata);
+	if (status > 0)
+		status = -EFAULT;
+
+	if (!drvdata->is_partial_bitstream)
+		xslcr_init_postload_fpga();
+
+	return status;
+}
+
+/**
+ * xdevcfg_readback_crc() - Read configuration back and accumulate a CRC.
+ * @drvdata:	Pointer to the driver data structure.
+ * @arg:	Userspace pointer to the readback structure.
+ * returns:	Success or error status.
+ *
+ * Streams the requested amount of readback data through one reusable
+ * bounce buffer and folds it into a CRC-32 without ever copying it to
+ * userspace, so a full-device verification costs one pass of PCAP DMA
+ * plus the checksum arithmetic. Must be called with the device mutex
+ * held and the clock enabled.
+ **/
+static int xdevcfg_readback_crc(struct xdevcfg_drvdata *drvdata,
+		struct xdevcfg_readback __user *arg)
+{
+	struct xdevcfg_readback rb;
+	dma_addr_t dma_addr;
+	u32 *kbuf;
+	u32 crc = ~0;
+	u64 remaining;
+	u32 len;
+	int status = 0;
+
+	if (copy_from_user(&rb, arg, sizeof(rb)))
+		return -EFAULT;
+
+	if (!rb.len || rb.len % 4)
+		return -EINVAL;
+
+	kbuf = dma_alloc_coherent(drvdata->dev, XDEVCFG_CRC_CHUNK, &dma_addr,
+				GFP_KERNEL);
+	if (!kbuf)
+		return -ENOMEM;
+
+	remaining = rb.len;
+	while (remaining) {
+		len = min_t(u64, remaining, XDEVCFG_CRC_CHUNK);
+
+		xdevcfg_dma_start_read(drvdata, dma_addr, len / 4);
+		status = xdevcfg_dma_wait(drvdata);
+		if (status > 0)
+			status = -EFAULT;
+		if (status)
+			break;
+
+		crc = crc32_le(crc, (u8 *)kbuf, len);
+		remaining -= len;
+	}
+
+	dma_free_coherent(drvdata->dev, XDEVCFG_CRC_CHUNK, kbuf, dma_addr);
+
+	if (status)
+		return status;
+
+	rb.crc = ~crc;
+	if (copy_to_user(arg, &rb, sizeof(rb)))
+		return -EFAULT;
+
+	return 0;
+}
+
+/**
+ * xdevcfg_ioctl() - The ioctl function for the bitstream slot cache.
+ * @file:	Pointer to the file structure.
+ * @cmd:	The ioctl command to be executed.
+ * @arg:	Userspace argument of the command.
+ * returns:	Success or error status.
+ **/
+static long xdevcfg_ioctl(struct file *file, unsigned int cmd,
+		unsigned long arg)
+{
+	struct xdevcfg_drvdata *drvdata = file->private_data;
+	u32 index;
+	long status;
+
+	status = clk_enable(drvdata->clk);
+	if (status)
+		return status;
+
+	status = mutex_lock_interruptible(&drvdata->sem);
+	if (status)
+		goto err_clk;
+
+	switch (cmd) {
+	case XDEVCFG_IOC_REGISTER_SLOT:
+		status = xdevcfg_register_slot(drvdata,
+				(const struct xdevcfg_slot __user *)arg);
+		break;
+	case XDEVCFG_IOC_UNREGISTER_SLOT:
+		if (get_user(index, (u32 __user *)arg)) {
+			status = -EFAULT;
+			break;
+		}
+		if (index >= XDEVCFG_MAX_SLOTS ||
+				!drvdata->slots[index].len) {
+			status = -EINVAL;
+			break;
+		}
+		xdevcfg_free_slot(drvdata, &drvdata->slots[index]);
+		break;
+	case XDEVCFG_IOC_LOAD_SLOT:
+		if (get_user(index, (u32 __user *)arg)) {
+			status = -EFAULT;
+			break;
+		}
+		status = xdevcfg_load_slot(drvdata, index);
+		break;
+	case XDEVCFG_IOC_READBACK_CRC:
+		status = xdevcfg_readback_crc(drvdata,
+				(struct xdevcfg_readback __user *)arg);
+		break;
+	default:
+		status = -ENOTTY;
+		break;
+	}
+
 	mutex_unlock(&drvdata->sem);
 err_clk:
 	clk_disable(drvdata->clk);
@@ -508,6 +1062,7 @@ static const struct file_operations xdevcfg_fops = {
 	.owner = THIS_MODULE,
 	.write = xdevcfg_write,
 	.read = xdevcfg_read,
+	.unlocked_ioctl = xdevcfg_ioctl,
 	.open = xdevcfg_open,
 	.release = xdevcfg_release,
 };
@@ -2029,12 +2584,17 @@ static int xdevcfg_drv_remove(struct platform_device *pdev)
 {
 	struct xdevcfg_drvdata *drvdata;
 	struct resource *res = platform_get_resource(pdev, IORESOURCE_MEM, 0);
+	int i;
 
 	drvdata = dev_get_drvdata(&pdev->dev);
 
 	if (!drvdata)
 		return -ENODEV;
 
+	for (i = 0; i < XDEVCFG_MAX_SLOTS; i++)
+		if (drvdata->slots[i].len)
+			xdevcfg_free_slot(drvdata, &drvdata->slots[i]);
+
 	unregister_chrdev_region(drvdata->devt, XDEVCFG_DEVICES);
 
 	sysfs_remove_group(&pdev->dev.kobj, &xdevcfg_attr_group);
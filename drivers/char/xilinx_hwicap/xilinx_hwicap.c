@@ -86,6 +86,8 @@
 #include <linux/cdev.h>
 #include <linux/platform_device.h>
 #include <linux/slab.h>
+#include <linux/lzo.h>
+#include <linux/vmalloc.h>
 
 #include <asm/io.h>
 #include <asm/uaccess.h>
@@ -433,6 +435,119 @@ hwicap_read(struct file *file, char __user *buf, size_t count, loff_t *ppos)
 	return status;
 }
 
+/*
+ * Compressed write mode. A stream whose first word is
+ * HWICAP_COMP_MAGIC is a sequence of independently compressed chunks,
+ * each framed as two native-endian u32s {uncompressed length,
+ * compressed length} followed by the LZO1X compressed payload. The
+ * uncompressed length must be a multiple of 4 and no larger than
+ * HWICAP_COMP_CHUNK_MAX. Storing bitstreams compressed both shrinks
+ * the flash footprint and cuts reconfiguration time, since far fewer
+ * bytes cross the flash and copy_from_user path per configuration
+ * word fed to the ICAP.
+ */
+#define HWICAP_COMP_MAGIC	0x4c5a4f01	/* "LZO" + format version */
+#define HWICAP_COMP_CHUNK_MAX	(64 * 1024)
+
+static int hwicap_comp_start(struct hwicap_drvdata *drvdata)
+{
+	drvdata->comp_buf =
+		vmalloc(lzo1x_worst_compress(HWICAP_COMP_CHUNK_MAX));
+	drvdata->comp_out = vmalloc(HWICAP_COMP_CHUNK_MAX);
+	if (!drvdata->comp_buf || !drvdata->comp_out) {
+		vfree(drvdata->comp_buf);
+		vfree(drvdata->comp_out);
+		drvdata->comp_buf = NULL;
+		drvdata->comp_out = NULL;
+		return -ENOMEM;
+	}
+
+	drvdata->comp_mode = true;
+	drvdata->comp_hdr_len = 0;
+	drvdata->comp_len = 0;
+
+	return 0;
+}
+
+static void hwicap_comp_end(struct hwicap_drvdata *drvdata)
+{
+	vfree(drvdata->comp_buf);
+	vfree(drvdata->comp_out);
+	drvdata->comp_buf = NULL;
+	drvdata->comp_out = NULL;
+	drvdata->comp_mode = false;
+}
+
+/*
+ * Gather chunk headers and payloads across arbitrarily split writes;
+ * as soon as a chunk is complete, decompress it and stream it to the
+ * ICAP before touching the next one.
+ */
+static ssize_t hwicap_write_compressed(struct hwicap_drvdata *drvdata,
+		const char __user *buf, size_t count)
+{
+	size_t written = 0;
+	size_t out_len;
+	size_t len;
+	int status;
+
+	while (written < count) {
+		u32 dst_len = drvdata->comp_hdr[0];
+		u32 src_len = drvdata->comp_hdr[1];
+
+		if (drvdata->comp_hdr_len < sizeof(drvdata->comp_hdr)) {
+			len = min_t(size_t, count - written,
+					sizeof(drvdata->comp_hdr) -
+						drvdata->comp_hdr_len);
+			if (copy_from_user((u8 *)drvdata->comp_hdr +
+						drvdata->comp_hdr_len,
+					buf + written, len))
+				return written ? written : -EFAULT;
+			drvdata->comp_hdr_len += len;
+			written += len;
+
+			if (drvdata->comp_hdr_len < sizeof(drvdata->comp_hdr))
+				break;
+
+			dst_len = drvdata->comp_hdr[0];
+			src_len = drvdata->comp_hdr[1];
+			if (!dst_len || (dst_len & 3) ||
+			    dst_len > HWICAP_COMP_CHUNK_MAX ||
+			    !src_len || src_len >
+			    lzo1x_worst_compress(HWICAP_COMP_CHUNK_MAX))
+				return -EINVAL;
+			continue;
+		}
+
+		len = min_t(size_t, count - written,
+				src_len - drvdata->comp_len);
+		if (copy_from_user(drvdata->comp_buf + drvdata->comp_len,
+				buf + written, len))
+			return written ? written : -EFAULT;
+		drvdata->comp_len += len;
+		written += len;
+
+		if (drvdata->comp_len < src_len)
+			break;
+
+		out_len = HWICAP_COMP_CHUNK_MAX;
+		status = lzo1x_decompress_safe(drvdata->comp_buf, src_len,
+				(u8 *)drvdata->comp_out, &out_len);
+		if (status != LZO_E_OK || out_len != dst_len)
+			return -EINVAL;
+
+		status = drvdata->config->set_configuration(drvdata,
+				drvdata->comp_out, dst_len >> 2);
+		if (status)
+			return -EFAULT;
+
+		drvdata->comp_hdr_len = 0;
+		drvdata->comp_len = 0;
+	}
+
+	return written;
+}
+
 static ssize_t
 hwicap_write(struct file *file, const char __user *buf,
 		size_t count, loff_t *ppos)
@@ -448,6 +563,32 @@ hwicap_write(struct file *file, const char __user *buf,
 	if (status)
 		return status;
 
+	/* The first word of a stream selects between the raw and the
+	 * compressed write path for the rest of this open */
+	if (!drvdata->comp_checked && count >= sizeof(u32)) {
+		u32 magic;
+
+		drvdata->comp_checked = true;
+		if (copy_from_user(&magic, buf, sizeof(magic))) {
+			status = -EFAULT;
+			goto error;
+		}
+		if (magic == HWICAP_COMP_MAGIC) {
+			status = hwicap_comp_start(drvdata);
+			if (status)
+				goto error;
+			written = sizeof(magic);
+		}
+	}
+
+	if (drvdata->comp_mode) {
+		status = hwicap_write_compressed(drvdata, buf + written,
+				count - written);
+		if (status >= 0)
+			status += written;
+		goto error;
+	}
+
 	left += drvdata->write_buffer_in_use;
 
 	/* Only write multiples of 4 bytes. */
@@ -548,6 +689,7 @@ static int hwicap_open(struct inode *inode, struct file *file)
 	file->private_data = drvdata;
 	drvdata->write_buffer_in_use = 0;
 	drvdata->read_buffer_in_use = 0;
+	drvdata->comp_checked = false;
 	drvdata->is_open = 1;
 
  error:
@@ -565,6 +707,13 @@ static int hwicap_release(struct inode *inode, struct file *file)
 
 	mutex_lock(&drvdata->sem);
 
+	if (drvdata->comp_mode) {
+		if (drvdata->comp_hdr_len || drvdata->comp_len)
+			dev_warn(drvdata->dev,
+				"compressed stream truncated mid-chunk\n");
+		hwicap_comp_end(drvdata);
+	}
+
 	if (drvdata->write_buffer_in_use) {
 		/* Flush write buffer. */
 		for (i = drvdata->write_buffer_in_use; i < 4; i++)
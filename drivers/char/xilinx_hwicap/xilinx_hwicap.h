@@ -58,6 +58,15 @@ struct hwicap_drvdata {
 	void *private_data;
 	bool is_open;
 	struct mutex sem;
+
+	/* Compressed write mode (see hwicap_write_compressed) */
+	bool comp_checked;	/* Magic detection done for this open */
+	bool comp_mode;		/* Stream is LZO compressed */
+	u32 comp_hdr[2];	/* Chunk header: {dst_len, src_len} */
+	u32 comp_hdr_len;	/* Header bytes gathered so far */
+	u8 *comp_buf;		/* Gathers one compressed chunk */
+	u32 comp_len;		/* Chunk bytes gathered so far */
+	u32 *comp_out;		/* Decompressed chunk, fed to the ICAP */
 };
 
 struct hwicap_driver_config {
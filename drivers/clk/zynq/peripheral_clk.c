@@ -20,10 +20,14 @@
  * GNU General Public License for more details.
  */
 
+#include <linux/clk.h>
 #include <linux/clk-provider.h>
 #include <linux/err.h>
+#include <linux/export.h>
 #include <linux/io.h>
 #include <linux/kernel.h>
+#include <linux/list.h>
+#include <linux/mutex.h>
 #include <linux/slab.h>
 #include <linux/clk/zynq.h>
 
@@ -32,11 +36,13 @@
  * @hw:		handle between common and hardware-specific interfaces
  * @clkctrl:	CLK control register
  * @lock:	register lock
+ * @gated:	entry in the list of gateable leaf clocks
  */
 struct zynq_periph_clk {
 	struct clk_hw	hw;
 	void __iomem	*clkctrl;
 	spinlock_t	*lock;
+	struct list_head gated;
 };
 #define to_zynq_periph_clk(_hw)\
 	container_of(_hw, struct zynq_periph_clk, hw)
@@ -327,6 +333,155 @@ static unsigned long zynq_periphclk_div2_recalc_rate(struct clk_hw *hw,
 	return (parent_rate / div1) / div2;
 }
 
+/*
+ * Fast gate groups.
+ *
+ * clk_prepare_enable() serializes on the global prepare mutex, so a
+ * duty-cycled consumer gating its clocks per frame contends with every
+ * other prepare/unprepare in the system.  The gates of the peripheral
+ * leaf clocks only ever need their register spinlock, so a consumer can
+ * pre-resolve a group of them and toggle all gate bits of the group
+ * with one atomic-context-safe call.
+ *
+ * The framework is bypassed on purpose: a group holds a regular
+ * clk_prepare_enable() reference on every member for its lifetime, so
+ * the framework never gates a parent away underneath the group, and the
+ * fast path merely toggles gate bits the framework believes to be on.
+ */
+static LIST_HEAD(zynq_periphclk_gated);
+static DEFINE_MUTEX(zynq_periphclk_gated_lock);
+
+struct zynq_clk_group {
+	unsigned int num;
+	struct clk *clks[ZYNQ_CLK_GROUP_MAX];
+	struct zynq_periph_clk *gates[ZYNQ_CLK_GROUP_MAX];
+};
+
+/**
+ * zynq_clk_group_get() - Resolve clocks into a fast gate group
+ * @clks:	Clocks to gate together, all gateable leaf clocks
+ * @num:	Number of clocks, at most ZYNQ_CLK_GROUP_MAX
+ * Returns a group handle or an errpointer.
+ *
+ * Takes a prepare_enable reference on every clock; the hardware gates
+ * can then be toggled with zynq_clk_group_enable/disable() from any
+ * context.
+ */
+struct zynq_clk_group *zynq_clk_group_get(struct clk **clks, unsigned int num)
+{
+	struct zynq_clk_group *grp;
+	struct zynq_periph_clk *pclk;
+	unsigned int i;
+	int ret;
+
+	if (!num || num > ZYNQ_CLK_GROUP_MAX)
+		return ERR_PTR(-EINVAL);
+
+	grp = kzalloc(sizeof(*grp), GFP_KERNEL);
+	if (!grp)
+		return ERR_PTR(-ENOMEM);
+
+	mutex_lock(&zynq_periphclk_gated_lock);
+	for (i = 0; i < num; i++) {
+		struct clk_hw *hw = __clk_get_hw(clks[i]);
+
+		list_for_each_entry(pclk, &zynq_periphclk_gated, gated) {
+			if (&pclk->hw == hw)
+				break;
+		}
+		if (&pclk->gated == &zynq_periphclk_gated) {
+			ret = -EINVAL;
+			goto err_unlock;
+		}
+		grp->gates[i] = pclk;
+	}
+	mutex_unlock(&zynq_periphclk_gated_lock);
+
+	for (i = 0; i < num; i++) {
+		ret = clk_prepare_enable(clks[i]);
+		if (ret) {
+			while (i--)
+				clk_disable_unprepare(clks[i]);
+			goto err_free;
+		}
+		grp->clks[i] = clks[i];
+	}
+	grp->num = num;
+
+	return grp;
+
+err_unlock:
+	mutex_unlock(&zynq_periphclk_gated_lock);
+err_free:
+	kfree(grp);
+	return ERR_PTR(ret);
+}
+EXPORT_SYMBOL_GPL(zynq_clk_group_get);
+
+/**
+ * zynq_clk_group_put() - Release a fast gate group
+ * @grp:	Group handle from zynq_clk_group_get()
+ *
+ * Drops the prepare_enable references.  The group must be left enabled.
+ */
+void zynq_clk_group_put(struct zynq_clk_group *grp)
+{
+	unsigned int i;
+
+	for (i = 0; i < grp->num; i++)
+		clk_disable_unprepare(grp->clks[i]);
+	kfree(grp);
+}
+EXPORT_SYMBOL_GPL(zynq_clk_group_put);
+
+/**
+ * zynq_clk_group_enable() - Open all hardware gates of a group
+ * @grp:	Group handle from zynq_clk_group_get()
+ *
+ * Safe from atomic context; only the register spinlocks are taken.
+ */
+void zynq_clk_group_enable(struct zynq_clk_group *grp)
+{
+	unsigned long flags;
+	unsigned int i;
+	u32 reg;
+
+	for (i = 0; i < grp->num; i++) {
+		struct zynq_periph_clk *clk = grp->gates[i];
+
+		spin_lock_irqsave(clk->lock, flags);
+		reg = readl(clk->clkctrl);
+		reg |= CLKCTRL_ENABLE_MASK;
+		writel(reg, clk->clkctrl);
+		spin_unlock_irqrestore(clk->lock, flags);
+	}
+}
+EXPORT_SYMBOL_GPL(zynq_clk_group_enable);
+
+/**
+ * zynq_clk_group_disable() - Close all hardware gates of a group
+ * @grp:	Group handle from zynq_clk_group_get()
+ *
+ * Safe from atomic context; only the register spinlocks are taken.
+ */
+void zynq_clk_group_disable(struct zynq_clk_group *grp)
+{
+	unsigned long flags;
+	unsigned int i;
+	u32 reg;
+
+	for (i = 0; i < grp->num; i++) {
+		struct zynq_periph_clk *clk = grp->gates[grp->num - 1 - i];
+
+		spin_lock_irqsave(clk->lock, flags);
+		reg = readl(clk->clkctrl);
+		reg &= ~CLKCTRL_ENABLE_MASK;
+		writel(reg, clk->clkctrl);
+		spin_unlock_irqrestore(clk->lock, flags);
+	}
+}
+EXPORT_SYMBOL_GPL(zynq_clk_group_disable);
+
 /* Muxing functions for peripheral clocks */
 /**
  * zynq_periphclk_set_parent() - Reparent clock
@@ -376,11 +531,13 @@ static u8 zynq_periphclk_get_parent(struct clk_hw *hw)
  * @pnames:	Array of names of clock parents
  * @num_parents:Number of parents
  * @lock:	Register lock
+ * @gateable:	Clock has a gate usable through the fast gate groups
  * Returns clk_register() return value or errpointer.
  */
 static struct clk *clk_register_zynq_common(const char *name,
 		void __iomem *clkctrl, const struct clk_ops *ops,
-		const char **pnames, u8 num_parents, spinlock_t *lock)
+		const char **pnames, u8 num_parents, spinlock_t *lock,
+		bool gateable)
 {
 	struct clk *ret;
 	struct zynq_periph_clk *clk;
@@ -404,8 +561,16 @@ static struct clk *clk_register_zynq_common(const char *name,
 	clk->lock = lock;
 
 	ret = clk_register(NULL, &clk->hw);
-	if (IS_ERR(ret))
+	if (IS_ERR(ret)) {
 		kfree(clk);
+		return ret;
+	}
+
+	if (gateable) {
+		mutex_lock(&zynq_periphclk_gated_lock);
+		list_add_tail(&clk->gated, &zynq_periphclk_gated);
+		mutex_unlock(&zynq_periphclk_gated_lock);
+	}
 
 	return ret;
 }
@@ -462,7 +627,7 @@ struct clk *clk_register_zynq_gd1m(const char *name,
 		void __iomem *clkctrl, const char **pnames, spinlock_t *lock)
 {
 	return clk_register_zynq_common(name, clkctrl, &zynq_periphclk_gd1m_ops,
-			pnames, 4, lock);
+			pnames, 4, lock, true);
 }
 
 /**
@@ -479,7 +644,7 @@ struct clk *clk_register_zynq_gd2m(const char *name,
 		spinlock_t *lock)
 {
 	return clk_register_zynq_common(name, clkctrl, &zynq_periphclk_gd2m_ops,
-			pnames, num_parents, lock);
+			pnames, num_parents, lock, true);
 }
 
 /**
@@ -494,7 +659,7 @@ struct clk *clk_register_zynq_d2m(const char *name,
 		void __iomem *clkctrl, const char **pnames, spinlock_t *lock)
 {
 	return clk_register_zynq_common(name, clkctrl, &zynq_periphclk_d2m_ops,
-			pnames, 4, lock);
+			pnames, 4, lock, false);
 }
 
 /**
@@ -511,5 +676,5 @@ struct clk *clk_register_zynq_d1m(const char *name,
 		spinlock_t *lock)
 {
 	return clk_register_zynq_common(name, clkctrl, &zynq_periphclk_d1m_ops,
-			pnames, num_parents, lock);
+			pnames, num_parents, lock, false);
 }
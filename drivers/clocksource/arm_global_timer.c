@@ -0,0 +1,191 @@
+/*
+ * Clocksource driver for the Cortex-A9 MPCore global timer
+ *
+ *  Copyright (C) 2013 Xilinx
+ *
+ * The global timer is a 64-bit incrementing counter in the private
+ * CPU peripheral block, clocked by PERIPHCLK. Unlike timers behind
+ * the APB bus it reads in a few CPU cycles, which makes it the
+ * preferred source for the high-frequency consumers: sched_clock,
+ * the timekeeping clocksource and the timer-based delay loop.
+ *
+ * Only the lower 32 bits of the counter are used, so every read is a
+ * single bus access and the counter can be exported to the VDSO. The
+ * comparator/event features of the timer are left untouched.
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <linux/arm_global_timer.h>
+#include <linux/clk.h>
+#include <linux/clk-provider.h>
+#include <linux/clocksource.h>
+#include <linux/err.h>
+#include <linux/of_address.h>
+
+#include <asm/delay.h>
+#include <asm/sched_clock.h>
+#include <asm/vdso.h>
+
+#define GT_COUNTER0	0x00	/* counter low word */
+#define GT_COUNTER1	0x04	/* counter high word */
+#define GT_CONTROL	0x08
+
+#define GT_CONTROL_TIMER_ENABLE	(1 << 0)
+
+static void __iomem *gt_base;
+static bool gt_is_sched_clock;
+
+static cycle_t gt_clocksource_read(struct clocksource *cs)
+{
+	return (cycle_t)__raw_readl(gt_base + GT_COUNTER0);
+}
+
+static u32 notrace gt_sched_clock_read(void)
+{
+	return __raw_readl(gt_base + GT_COUNTER0);
+}
+
+static unsigned long gt_read_current_timer(void)
+{
+	return __raw_readl(gt_base + GT_COUNTER0);
+}
+
+static struct clocksource gt_clocksource = {
+	.name	= "arm_global_timer",
+	.rating	= 300,
+	.read	= gt_clocksource_read,
+	.mask	= CLOCKSOURCE_MASK(32),
+	.flags	= CLOCK_SOURCE_IS_CONTINUOUS,
+};
+
+static struct delay_timer gt_delay_timer = {
+	.read_current_timer = gt_read_current_timer,
+};
+
+static struct clk *gt_clk;
+
+static int gt_rate_change_cb(struct notifier_block *nb, unsigned long event,
+			     void *data)
+{
+	struct clk_notifier_data *ndata = data;
+
+	switch (event) {
+	case POST_RATE_CHANGE:
+		/*
+		 * Same approach as the TTC: re-register the clocksource
+		 * at the new rate. sched_clock and the delay timer keep
+		 * the rate they were set up with; their error is the
+		 * same one the TTC-based setup already accepted.
+		 */
+		clocksource_unregister(&gt_clocksource);
+		clocksource_register_hz(&gt_clocksource, ndata->new_rate);
+		/* fall through */
+	case PRE_RATE_CHANGE:
+	case ABORT_RATE_CHANGE:
+	default:
+		return NOTIFY_DONE;
+	}
+}
+
+static struct notifier_block gt_clk_rate_change_nb = {
+	.notifier_call = gt_rate_change_cb,
+};
+
+bool arm_global_timer_is_sched_clock(void)
+{
+	return gt_is_sched_clock;
+}
+
+/**
+ * arm_global_timer_init - register the global timer
+ * @base:	virtual address of the timer
+ * @phys:	physical address of the timer, 0 when unknown
+ * @clk:	PERIPHCLK feeding the timer
+ *
+ * Start the counter and register it as clocksource, sched_clock and
+ * delay timer. The physical address, when given, is handed to the
+ * VDSO so that userspace reads the counter without a syscall.
+ */
+void __init arm_global_timer_init(void __iomem *base, phys_addr_t phys,
+				  struct clk *clk)
+{
+	unsigned long rate;
+	int err;
+	static int initialized;
+
+	if (initialized)
+		return;
+	initialized = 1;
+
+	err = clk_prepare_enable(clk);
+	if (WARN_ON(err))
+		return;
+	rate = clk_get_rate(clk);
+
+	gt_base = base;
+	gt_clk = clk;
+
+	if (clk_notifier_register(clk, &gt_clk_rate_change_nb))
+		pr_warn("Unable to register clock notifier.\n");
+
+	/* Start counting from zero, comparator disabled */
+	__raw_writel(0, base + GT_CONTROL);
+	__raw_writel(0, base + GT_COUNTER0);
+	__raw_writel(0, base + GT_COUNTER1);
+	__raw_writel(GT_CONTROL_TIMER_ENABLE, base + GT_CONTROL);
+
+	err = clocksource_register_hz(&gt_clocksource, rate);
+	if (WARN_ON(err))
+		return;
+
+	setup_sched_clock(gt_sched_clock_read, 32, rate);
+	gt_is_sched_clock = true;
+
+	gt_delay_timer.freq = rate;
+	register_current_timer_delay(&gt_delay_timer);
+
+	/*
+	 * The page also contains the SCU and private timer registers,
+	 * none of which are destructive to read; the same trade-off
+	 * the TTC driver makes.
+	 */
+	if (phys)
+		vdso_register_mmio_counter(&gt_clocksource,
+					   phys + GT_COUNTER0);
+
+	pr_info("arm_global_timer: %lu.%03lu MHz\n",
+		rate / 1000000, (rate / 1000) % 1000);
+}
+
+#ifdef CONFIG_CLKSRC_OF
+static void __init gt_of_init(struct device_node *np)
+{
+	void __iomem *base;
+	struct resource res;
+	struct clk *clk;
+
+	base = of_iomap(np, 0);
+	if (WARN_ON(!base))
+		return;
+
+	if (of_address_to_resource(np, 0, &res))
+		res.start = 0;
+
+	clk = of_clk_get(np, 0);
+	if (IS_ERR(clk))
+		clk = clk_get_sys("smp_twd", NULL);
+	if (WARN_ON(IS_ERR(clk)))
+		return;
+
+	arm_global_timer_init(base, res.start, clk);
+}
+CLOCKSOURCE_OF_DECLARE(arm_gt, "arm,cortex-a9-global-timer", gt_of_init);
+#endif
@@ -15,6 +15,7 @@
  * GNU General Public License for more details.
  */
 
+#include <linux/arm_global_timer.h>
 #include <linux/clk.h>
 #include <linux/interrupt.h>
 #include <linux/clockchips.h>
@@ -24,6 +25,7 @@
 #include <linux/clk-provider.h>
 
 #include <asm/sched_clock.h>
+#include <asm/vdso.h>
 
 /*
  * This driver configures the 2 16-bit count-up timers as follows:
@@ -256,7 +258,8 @@ static int ttc_rate_change_clocksource_cb(struct notifier_block *nb,
 	}
 }
 
-static void __init ttc_setup_clocksource(struct clk *clk, void __iomem *base)
+static void __init ttc_setup_clocksource(struct clk *clk, void __iomem *base,
+					 phys_addr_t phys)
 {
 	struct ttc_timer_clocksource *ttccs;
 	int err;
@@ -305,9 +308,25 @@ static void __init ttc_setup_clocksource(struct clk *clk, void __iomem *base)
 		return;
 	}
 
+	/* The A9 global timer, when present, is the better sched_clock */
+	if (arm_global_timer_is_sched_clock())
+		return;
+
 	ttc_sched_clock_val_reg = base + TTC_COUNT_VAL_OFFSET;
 	setup_sched_clock(ttc_sched_clock_read , 16,
 			clk_get_rate(ttccs->ttc.clk) / PRESCALE);
+
+	/*
+	 * Export the counter register to the VDSO. Note that this maps
+	 * the whole TTC register page read-only into every process, and
+	 * the interrupt status registers of the other timer channels
+	 * (which clear on read) live in the same page, so a stray read
+	 * can eat a clockevent interrupt. Acceptable on Zynq systems,
+	 * which run a trusted userspace.
+	 */
+	if (phys)
+		vdso_register_mmio_counter(&ttccs->cs,
+					   phys + TTC_COUNT_VAL_OFFSET);
 }
 
 static int ttc_rate_change_clockevent_cb(struct notifier_block *nb,
@@ -409,6 +428,7 @@ static void __init ttc_timer_init(struct device_node *timer)
 {
 	unsigned int irq;
 	void __iomem *timer_baseaddr;
+	struct resource res;
 	struct clk *clk;
 	static int initialized;
 
@@ -428,6 +448,9 @@ static void __init ttc_timer_init(struct device_node *timer)
 		BUG();
 	}
 
+	if (of_address_to_resource(timer, 0, &res))
+		res.start = 0;
+
 	irq = irq_of_parse_and_map(timer, 1);
 	if (irq <= 0) {
 		pr_err("ERROR: invalid interrupt number\n");
@@ -440,7 +463,7 @@ static void __init ttc_timer_init(struct device_node *timer)
 		BUG();
 	}
 
-	ttc_setup_clocksource(clk, timer_baseaddr);
+	ttc_setup_clocksource(clk, timer_baseaddr, res.start);
 	ttc_setup_clockevent(clk, timer_baseaddr + 4, irq);
 
 	pr_info("%s #0 at %p, irq=%d\n", timer->name, timer_baseaddr, irq);
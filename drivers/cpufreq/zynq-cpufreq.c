@@ -162,8 +162,17 @@ static int __cpuinit zynq_cpu_init(struct cpufreq_policy *policy)
 		cpumask_setall(policy->cpus);
 	}
 
-	/* FIXME: what's the actual transition time? */
-	policy->cpuinfo.transition_latency = 300 * 1000;
+	/*
+	 * A transition only rewrites the CPU_MASTER_CLK divisor in
+	 * ARM_CLK_CTRL: clk_set_rate() propagates through the
+	 * CLK_SET_RATE_PARENT gate to the divider and stops there, so
+	 * the ARM PLL is never re-locked and the switch is handled
+	 * glitch-free by the clock ramp hardware. The cost is the
+	 * clock framework walk plus one SLCR write, comfortably below
+	 * this bound, which is low enough for ondemand to sample at a
+	 * useful rate instead of being throttled into uselessness.
+	 */
+	policy->cpuinfo.transition_latency = 20 * 1000;
 
 	return 0;
 
@@ -463,6 +463,17 @@ struct _pl330_req {
 	/* Number of bytes taken to setup MC for the req */
 	u32 mc_len;
 	struct pl330_req *r;
+	/*
+	 * Shape of the program last generated into the MC buffer.
+	 * A request of identical shape reuses the program body with
+	 * just the DMAMOV immediates patched. tmpl_len is 0 if the
+	 * buffer holds no reusable program.
+	 */
+	u32 tmpl_ccr;
+	u32 tmpl_bytes;
+	u32 tmpl_len;
+	enum pl330_reqtype tmpl_rqtype;
+	u8 tmpl_peri;
 };
 
 /* ToBeDone for tasklet */
@@ -1478,6 +1489,45 @@ static int _setup_req(unsigned dry_run, struct pl330_thread *thrd,
 	return off;
 }
 
+/*
+ * The body of a generated program is a function of the transfer
+ * shape only - its CCR, length, request type and peripheral. The
+ * addresses appear solely as immediates of the DMAMOV SAR/DAR that
+ * follow the leading DMAMOV CCR, i.e. at fixed offsets. So if the
+ * program last emitted into this MC buffer had the same shape, just
+ * patch the three DMAMOVs and reuse the loop body, skipping both
+ * _setup_req() passes. Clients like audio and UART resubmit the
+ * same few-byte transfer endlessly, where generating the program
+ * costs far more than moving the data.
+ *
+ * Returns the number of MC bytes of the reused program, or 0 if the
+ * cached program is not applicable.
+ */
+static int _setup_req_cached(struct pl330_thread *thrd,
+		unsigned index, struct _xfer_spec *pxs)
+{
+	struct _pl330_req *req = &thrd->req[index];
+	struct pl330_xfer *x = pxs->r->x;
+	u8 *buf = req->mc_cpu;
+
+	/* Only a lone xfer has its DMAMOVs at fixed offsets */
+	if (!x || x->next)
+		return 0;
+
+	if (!req->tmpl_len || req->tmpl_ccr != pxs->ccr
+			|| req->tmpl_bytes != x->bytes
+			|| req->tmpl_rqtype != pxs->r->rqtype
+			|| req->tmpl_peri != pxs->r->peri)
+		return 0;
+
+	/* Rewriting DMAMOV CCR also un-marks the slot free */
+	_emit_MOV(0, &buf[0], CCR, pxs->ccr);
+	_emit_MOV(0, &buf[SZ_DMAMOV], SAR, x->src_addr);
+	_emit_MOV(0, &buf[2 * SZ_DMAMOV], DAR, x->dst_addr);
+
+	return req->tmpl_len;
+}
+
 static inline u32 _prepare_ccr(const struct pl330_reqcfg *rqc)
 {
 	u32 ccr = 0;
@@ -1599,22 +1649,39 @@ static int pl330_submit_req(void *ch_id, struct pl330_req *r)
 	xs.ccr = ccr;
 	xs.r = r;
 
-	/* First dry run to check if req is acceptable */
-	ret = _setup_req(1, thrd, idx, &xs);
-	if (ret < 0)
-		goto xfer_exit;
+	/* Reuse the last program if only the addresses changed */
+	ret = _setup_req_cached(thrd, idx, &xs);
+	if (!ret) {
+		/* First dry run to check if req is acceptable */
+		ret = _setup_req(1, thrd, idx, &xs);
+		if (ret < 0)
+			goto xfer_exit;
+
+		if (ret > pi->mcbufsz / 2) {
+			dev_info(thrd->dmac->pinfo->dev,
+				"%s:%d Trying increasing mcbufsz\n",
+					__func__, __LINE__);
+			ret = -ENOMEM;
+			goto xfer_exit;
+		}
 
-	if (ret > pi->mcbufsz / 2) {
-		dev_info(thrd->dmac->pinfo->dev,
-			"%s:%d Trying increasing mcbufsz\n",
-				__func__, __LINE__);
-		ret = -ENOMEM;
-		goto xfer_exit;
+		ret = _setup_req(0, thrd, idx, &xs);
+
+		/* Remember the shape for back-to-back resubmissions */
+		if (!r->x->next) {
+			thrd->req[idx].tmpl_ccr = ccr;
+			thrd->req[idx].tmpl_bytes = r->x->bytes;
+			thrd->req[idx].tmpl_rqtype = r->rqtype;
+			thrd->req[idx].tmpl_peri = r->peri;
+			thrd->req[idx].tmpl_len = ret;
+		} else {
+			thrd->req[idx].tmpl_len = 0;
+		}
 	}
 
 	/* Hook the request */
 	thrd->lstenq = idx;
-	thrd->req[idx].mc_len = _setup_req(0, thrd, idx, &xs);
+	thrd->req[idx].mc_len = ret;
 	thrd->req[idx].r = r;
 
 	ret = 0;
@@ -2002,6 +2069,7 @@ static inline void _reset_thread(struct pl330_thread *thrd)
 	thrd->req[0].mc_bus = pl330->mcode_bus
 				+ (thrd->id * pi->mcbufsz);
 	thrd->req[0].r = NULL;
+	thrd->req[0].tmpl_len = 0;
 	mark_free(thrd, 0);
 
 	thrd->req[1].mc_cpu = thrd->req[0].mc_cpu
@@ -2009,6 +2077,7 @@ static inline void _reset_thread(struct pl330_thread *thrd)
 	thrd->req[1].mc_bus = thrd->req[0].mc_bus
 				+ pi->mcbufsz / 2;
 	thrd->req[1].r = NULL;
+	thrd->req[1].tmpl_len = 0;
 	mark_free(thrd, 1);
 }
 
@@ -2780,8 +2849,13 @@ pl330_prep_dma_memcpy(struct dma_chan *chan, dma_addr_t dst,
 	/* Select max possible burst size */
 	burst = pi->pcfg.data_bus_width / 8;
 
+	/*
+	 * The DMAC aborts on a SAR/DAR not aligned at the burst size,
+	 * so pick the widest burst that matches the alignment of both
+	 * addresses as well as the length.
+	 */
 	while (burst > 1) {
-		if (!(len % burst))
+		if (!((src | dst | len) & (burst - 1)))
 			break;
 		burst /= 2;
 	}
@@ -19,6 +19,8 @@
 #include <linux/wait.h>
 #include <linux/amba/xilinx_dma.h>
 
+#include "dmatest_bench.h"
+
 static unsigned int test_buf_size = 64;
 module_param(test_buf_size, uint, S_IRUGO);
 MODULE_PARM_DESC(test_buf_size, "Size of the memcpy test buffer");
@@ -28,6 +30,24 @@ module_param(iterations, uint, S_IRUGO);
 MODULE_PARM_DESC(iterations,
 		"Iterations before stopping test (default: infinite)");
 
+static bool benchmark;
+module_param(benchmark, bool, S_IRUGO);
+MODULE_PARM_DESC(benchmark,
+		"Measure throughput/latency instead of verifying data");
+
+static unsigned int bench_buf_size = 16384;
+module_param(bench_buf_size, uint, S_IRUGO);
+MODULE_PARM_DESC(bench_buf_size, "Size of each benchmark transfer in bytes");
+
+static unsigned int bench_depth = 4;
+module_param(bench_depth, uint, S_IRUGO);
+MODULE_PARM_DESC(bench_depth,
+		"Transfers kept in flight during the benchmark (default: 4)");
+
+static unsigned int bench_secs = 10;
+module_param(bench_secs, uint, S_IRUGO);
+MODULE_PARM_DESC(bench_secs, "Benchmark duration in seconds (default: 10)");
+
 /*
  * Initialization patterns. All bytes in the source buffer has bit 7
  * set, all bytes in the destination buffer has bit 7 cleared.
@@ -68,6 +88,11 @@ struct dmatest_chan {
 static LIST_HEAD(dmatest_channels);
 static unsigned int nr_channels;
 
+/* Benchmark results, readable from debugfs at axidmatest/results */
+static struct xdmatest_bench_stats bench_stats;
+static struct dentry *bench_debugfs;
+static atomic_t bench_irqs;
+
 static unsigned long dmatest_random(void)
 {
 	unsigned long buf;
@@ -178,6 +203,12 @@ static void dmatest_slave_rx_callback(void *completion)
 	complete(completion);
 }
 
+static void dmatest_bench_callback(void *completion)
+{
+	atomic_inc(&bench_irqs);
+	complete(completion);
+}
+
 /* Function for slave transfers
  * Each thread requires 2 channels, one for transmit, and one for receive
  */
@@ -482,6 +513,222 @@ err_srcs:
 	return ret;
 }
 
+/* One in-flight benchmark transfer, loopback through tx and rx */
+struct dmatest_bench_slot {
+	struct completion tx_cmp;
+	struct completion rx_cmp;
+	ktime_t start;
+};
+
+static int dmatest_bench_submit(struct dmatest_slave_thread *thread,
+			struct dmatest_bench_slot *slot,
+			dma_addr_t dma_src, dma_addr_t dma_dst,
+			unsigned int len)
+{
+	struct dma_device *tx_dev = thread->tx_chan->device;
+	struct dma_device *rx_dev = thread->rx_chan->device;
+	struct dma_async_tx_descriptor *txd;
+	struct dma_async_tx_descriptor *rxd;
+	enum dma_ctrl_flags flags = DMA_CTRL_ACK | DMA_COMPL_SKIP_DEST_UNMAP |
+			DMA_COMPL_SKIP_SRC_UNMAP | DMA_PREP_INTERRUPT;
+	struct scatterlist tx_sg[1];
+	struct scatterlist rx_sg[1];
+
+	sg_init_table(tx_sg, 1);
+	sg_init_table(rx_sg, 1);
+
+	sg_dma_address(&tx_sg[0]) = dma_src;
+	sg_dma_address(&rx_sg[0]) = dma_dst;
+	sg_dma_len(&tx_sg[0]) = len;
+	sg_dma_len(&rx_sg[0]) = len;
+
+	rxd = rx_dev->device_prep_slave_sg(thread->rx_chan, rx_sg, 1,
+			DMA_DEV_TO_MEM, flags, NULL);
+	txd = tx_dev->device_prep_slave_sg(thread->tx_chan, tx_sg, 1,
+			DMA_MEM_TO_DEV, flags, NULL);
+	if (!rxd || !txd)
+		return -EIO;
+
+	init_completion(&slot->rx_cmp);
+	rxd->callback = dmatest_bench_callback;
+	rxd->callback_param = &slot->rx_cmp;
+
+	init_completion(&slot->tx_cmp);
+	txd->callback = dmatest_bench_callback;
+	txd->callback_param = &slot->tx_cmp;
+
+	slot->start = ktime_get();
+
+	if (dma_submit_error(rxd->tx_submit(rxd)) ||
+			dma_submit_error(txd->tx_submit(txd)))
+		return -EIO;
+
+	dma_async_issue_pending(thread->tx_chan);
+	dma_async_issue_pending(thread->rx_chan);
+
+	return 0;
+}
+
+/*
+ * Benchmark thread.  Keeps bench_depth loopback transfers of
+ * bench_buf_size bytes in flight for bench_secs seconds and records
+ * throughput and per-transfer latency into bench_stats.  The buffers
+ * are mapped once and recycled, and no data verification is done.
+ */
+static int dmatest_bench_func(void *data)
+{
+	struct dmatest_slave_thread *thread = data;
+	struct dma_device *tx_dev = thread->tx_chan->device;
+	struct dma_device *rx_dev = thread->rx_chan->device;
+	struct dmatest_bench_slot *slots;
+	struct xilinx_dma_config config;
+	const char *thread_name = current->comm;
+	dma_addr_t *dma_srcs;
+	dma_addr_t *dma_dsts;
+	unsigned long deadline;
+	unsigned int depth, len, inflight = 0;
+	ktime_t start;
+	u8 align;
+	int ret = -ENOMEM;
+	int i;
+
+	smp_rmb();
+
+	depth = clamp(bench_depth, 1u, 64u);
+
+	align = tx_dev->copy_align;
+	if (rx_dev->copy_align > align)
+		align = rx_dev->copy_align;
+
+	len = (bench_buf_size >> align) << align;
+	if (!len)
+		len = 1 << align;
+
+	thread->srcs = kcalloc(depth + 1, sizeof(u8 *), GFP_KERNEL);
+	if (!thread->srcs)
+		goto err_srcs;
+	for (i = 0; i < depth; i++) {
+		thread->srcs[i] = kmalloc(len, GFP_KERNEL);
+		if (!thread->srcs[i])
+			goto err_srcbuf;
+	}
+	thread->srcs[i] = NULL;
+
+	thread->dsts = kcalloc(depth + 1, sizeof(u8 *), GFP_KERNEL);
+	if (!thread->dsts)
+		goto err_dsts;
+	for (i = 0; i < depth; i++) {
+		thread->dsts[i] = kmalloc(len, GFP_KERNEL);
+		if (!thread->dsts[i])
+			goto err_dstbuf;
+	}
+	thread->dsts[i] = NULL;
+
+	slots = kcalloc(depth, sizeof(*slots), GFP_KERNEL);
+	dma_srcs = kcalloc(depth, sizeof(*dma_srcs), GFP_KERNEL);
+	dma_dsts = kcalloc(depth, sizeof(*dma_dsts), GFP_KERNEL);
+	if (!slots || !dma_srcs || !dma_dsts)
+		goto err_slots;
+
+	/* Map once; the CPU does not touch the buffers during the run */
+	for (i = 0; i < depth; i++) {
+		dma_srcs[i] = dma_map_single(tx_dev->dev, thread->srcs[i],
+						len, DMA_MEM_TO_DEV);
+		dma_dsts[i] = dma_map_single(rx_dev->dev, thread->dsts[i],
+						len, DMA_DEV_TO_MEM);
+	}
+
+	/* One interrupt per transfer, so the IRQ count is meaningful */
+	config.coalesc = 1;
+	config.delay = 0;
+	rx_dev->device_control(thread->rx_chan, DMA_SLAVE_CONFIG,
+			(unsigned long)&config);
+	tx_dev->device_control(thread->tx_chan, DMA_SLAVE_CONFIG,
+			(unsigned long)&config);
+
+	memset(&bench_stats, 0, sizeof(bench_stats));
+	atomic_set(&bench_irqs, 0);
+
+	ret = 0;
+	start = ktime_get();
+	deadline = jiffies + bench_secs * HZ;
+
+	for (i = 0; i < depth; i++) {
+		if (dmatest_bench_submit(thread, &slots[i], dma_srcs[i],
+					dma_dsts[i], len)) {
+			pr_warn("%s: benchmark submit failed\n", thread_name);
+			break;
+		}
+		inflight++;
+	}
+
+	i = 0;
+	while (inflight) {
+		unsigned long tmo = msecs_to_jiffies(30000);
+
+		if (!wait_for_completion_timeout(&slots[i].tx_cmp, tmo) ||
+			!wait_for_completion_timeout(&slots[i].rx_cmp, tmo)) {
+			pr_warn("%s: benchmark transfer timed out\n",
+					thread_name);
+			ret = -ETIMEDOUT;
+			break;
+		}
+
+		xdmatest_bench_record(&bench_stats,
+			ktime_us_delta(ktime_get(), slots[i].start), len);
+
+		if (!kthread_should_stop() && time_before(jiffies, deadline)) {
+			if (dmatest_bench_submit(thread, &slots[i],
+						dma_srcs[i], dma_dsts[i],
+						len)) {
+				pr_warn("%s: benchmark resubmit failed\n",
+						thread_name);
+				deadline = jiffies;	/* drain and stop */
+				inflight--;
+			}
+		} else {
+			inflight--;
+		}
+
+		i = (i + 1) % depth;
+	}
+
+	bench_stats.usecs = ktime_us_delta(ktime_get(), start);
+	bench_stats.irqs = atomic_read(&bench_irqs);
+
+	for (i = 0; i < depth; i++) {
+		dma_unmap_single(tx_dev->dev, dma_srcs[i], len,
+				DMA_MEM_TO_DEV);
+		dma_unmap_single(rx_dev->dev, dma_dsts[i], len,
+				DMA_DEV_TO_MEM);
+	}
+
+err_slots:
+	kfree(dma_dsts);
+	kfree(dma_srcs);
+	kfree(slots);
+	for (i = 0; thread->dsts[i]; i++)
+		kfree(thread->dsts[i]);
+err_dstbuf:
+	kfree(thread->dsts);
+err_dsts:
+	for (i = 0; thread->srcs[i]; i++)
+		kfree(thread->srcs[i]);
+err_srcbuf:
+	kfree(thread->srcs);
+err_srcs:
+	pr_notice("%s: benchmark done: %llu transfers of %u bytes in %llu us (status %d)\n",
+			thread_name, bench_stats.transfers, len,
+			bench_stats.usecs, ret);
+
+	while (!kthread_should_stop()) {
+		DECLARE_WAIT_QUEUE_HEAD_ONSTACK(wait_dmatest_exit);
+		interruptible_sleep_on(&wait_dmatest_exit);
+	}
+
+	return ret;
+}
+
 static void dmatest_cleanup_channel(struct dmatest_chan *dtc)
 {
 	struct dmatest_slave_thread *thread;
@@ -516,7 +763,8 @@ static int dmatest_add_slave_threads(struct dmatest_chan *tx_dtc,
 	thread->rx_chan = rx_chan;
 	thread->type = (enum dma_transaction_type)DMA_SLAVE;
 	smp_wmb();
-	thread->task = kthread_run(dmatest_slave_func, thread, "%s-%s",
+	thread->task = kthread_run(benchmark ? dmatest_bench_func :
+			dmatest_slave_func, thread, "%s-%s",
 		dma_chan_name(tx_chan), dma_chan_name(rx_chan));
 	if (IS_ERR(thread->task)) {
 		pr_warn("dmatest: Failed to run thread %s-%s\n",
@@ -623,6 +871,10 @@ static int __init dmatest_init(void)
 		}
 	}
 
+	if (!err)
+		bench_debugfs = xdmatest_bench_debugfs_init("axidmatest",
+							&bench_stats);
+
 	return err;
 }
 /* when compiled-in wait for drivers to load first */
@@ -633,6 +885,8 @@ static void __exit dmatest_exit(void)
 	struct dmatest_chan *dtc, *_dtc;
 	struct dma_chan *chan;
 
+	debugfs_remove_recursive(bench_debugfs);
+
 	list_for_each_entry_safe(dtc, _dtc, &dmatest_channels, node) {
 		list_del(&dtc->node);
 		chan = dtc->chan;
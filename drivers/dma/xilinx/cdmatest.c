@@ -19,6 +19,8 @@
 #include <linux/wait.h>
 #include <linux/amba/xilinx_dma.h>
 
+#include "dmatest_bench.h"
+
 static unsigned int test_buf_size = 64;
 module_param(test_buf_size, uint, S_IRUGO);
 MODULE_PARM_DESC(test_buf_size, "Size of the memcpy test buffer");
@@ -56,6 +58,24 @@ module_param(pq_sources, uint, S_IRUGO);
 MODULE_PARM_DESC(pq_sources,
 		"Number of p+q source buffers (default: 3)");
 
+static bool benchmark;
+module_param(benchmark, bool, S_IRUGO);
+MODULE_PARM_DESC(benchmark,
+		"Measure throughput/latency instead of verifying data");
+
+static unsigned int bench_buf_size = 16384;
+module_param(bench_buf_size, uint, S_IRUGO);
+MODULE_PARM_DESC(bench_buf_size, "Size of each benchmark transfer in bytes");
+
+static unsigned int bench_depth = 4;
+module_param(bench_depth, uint, S_IRUGO);
+MODULE_PARM_DESC(bench_depth,
+		"Transfers kept in flight during the benchmark (default: 4)");
+
+static unsigned int bench_secs = 10;
+module_param(bench_secs, uint, S_IRUGO);
+MODULE_PARM_DESC(bench_secs, "Benchmark duration in seconds (default: 10)");
+
 /*
  * Initialization patterns. All bytes in the source buffer has bit 7
  * set, all bytes in the destination buffer has bit 7 cleared.
@@ -95,6 +115,11 @@ struct cdmatest_chan {
 static LIST_HEAD(cdmatest_channels);
 static unsigned int nr_channels;
 
+/* Benchmark results, readable from debugfs at cdmatest/results */
+static struct xdmatest_bench_stats bench_stats;
+static struct dentry *bench_debugfs;
+static atomic_t bench_irqs;
+
 static bool cdmatest_match_channel(struct dma_chan *chan)
 {
 	if (test_channel[0] == '\0')
@@ -214,6 +239,12 @@ static void cdmatest_callback(void *completion)
 	complete(completion);
 }
 
+static void cdmatest_bench_callback(void *completion)
+{
+	atomic_inc(&bench_irqs);
+	complete(completion);
+}
+
 /*
  * This function repeatedly tests DMA transfers of various lengths and
  * offsets for a given operation type until it is told to exit by
@@ -487,6 +518,185 @@ err_srcs:
 	return ret;
 }
 
+/* One in-flight benchmark memcpy */
+struct cdmatest_bench_slot {
+	struct completion cmp;
+	ktime_t start;
+};
+
+static int cdmatest_bench_submit(struct cdmatest_thread *thread,
+			struct cdmatest_bench_slot *slot,
+			dma_addr_t dma_src, dma_addr_t dma_dst,
+			unsigned int len)
+{
+	struct dma_device *dev = thread->chan->device;
+	struct dma_async_tx_descriptor *tx;
+	enum dma_ctrl_flags flags = DMA_CTRL_ACK | DMA_COMPL_SKIP_DEST_UNMAP |
+			DMA_COMPL_SKIP_SRC_UNMAP | DMA_PREP_INTERRUPT;
+
+	tx = dev->device_prep_dma_memcpy(thread->chan, dma_dst, dma_src,
+						len, flags);
+	if (!tx)
+		return -EIO;
+
+	init_completion(&slot->cmp);
+	tx->callback = cdmatest_bench_callback;
+	tx->callback_param = &slot->cmp;
+
+	slot->start = ktime_get();
+
+	if (dma_submit_error(tx->tx_submit(tx)))
+		return -EIO;
+
+	dma_async_issue_pending(thread->chan);
+
+	return 0;
+}
+
+/*
+ * Benchmark thread.  Keeps bench_depth memcpy transfers of
+ * bench_buf_size bytes in flight for bench_secs seconds and records
+ * throughput and per-transfer latency into bench_stats.  The buffers
+ * are mapped once and recycled, and no data verification is done.
+ */
+static int cdmatest_bench_func(void *data)
+{
+	struct cdmatest_thread *thread = data;
+	struct dma_device *dev = thread->chan->device;
+	struct cdmatest_bench_slot *slots;
+	const char *thread_name = current->comm;
+	dma_addr_t *dma_srcs;
+	dma_addr_t *dma_dsts;
+	unsigned long deadline;
+	unsigned int depth, len, inflight = 0;
+	ktime_t start;
+	u8 align;
+	int ret = -ENOMEM;
+	int i;
+
+	smp_rmb();
+
+	depth = clamp(bench_depth, 1u, 64u);
+
+	align = dev->copy_align;
+	len = (bench_buf_size >> align) << align;
+	if (!len)
+		len = 1 << align;
+
+	thread->srcs = kcalloc(depth + 1, sizeof(u8 *), GFP_KERNEL);
+	if (!thread->srcs)
+		goto err_srcs;
+	for (i = 0; i < depth; i++) {
+		thread->srcs[i] = kmalloc(len, GFP_KERNEL);
+		if (!thread->srcs[i])
+			goto err_srcbuf;
+	}
+	thread->srcs[i] = NULL;
+
+	thread->dsts = kcalloc(depth + 1, sizeof(u8 *), GFP_KERNEL);
+	if (!thread->dsts)
+		goto err_dsts;
+	for (i = 0; i < depth; i++) {
+		thread->dsts[i] = kmalloc(len, GFP_KERNEL);
+		if (!thread->dsts[i])
+			goto err_dstbuf;
+	}
+	thread->dsts[i] = NULL;
+
+	slots = kcalloc(depth, sizeof(*slots), GFP_KERNEL);
+	dma_srcs = kcalloc(depth, sizeof(*dma_srcs), GFP_KERNEL);
+	dma_dsts = kcalloc(depth, sizeof(*dma_dsts), GFP_KERNEL);
+	if (!slots || !dma_srcs || !dma_dsts)
+		goto err_slots;
+
+	/* Map once; the CPU does not touch the buffers during the run */
+	for (i = 0; i < depth; i++) {
+		dma_srcs[i] = dma_map_single(dev->dev, thread->srcs[i],
+						len, DMA_TO_DEVICE);
+		dma_dsts[i] = dma_map_single(dev->dev, thread->dsts[i],
+						len, DMA_FROM_DEVICE);
+	}
+
+	memset(&bench_stats, 0, sizeof(bench_stats));
+	atomic_set(&bench_irqs, 0);
+
+	ret = 0;
+	start = ktime_get();
+	deadline = jiffies + bench_secs * HZ;
+
+	for (i = 0; i < depth; i++) {
+		if (cdmatest_bench_submit(thread, &slots[i], dma_srcs[i],
+					dma_dsts[i], len)) {
+			pr_warn("%s: benchmark submit failed\n", thread_name);
+			break;
+		}
+		inflight++;
+	}
+
+	i = 0;
+	while (inflight) {
+		unsigned long tmo = msecs_to_jiffies(30000);
+
+		if (!wait_for_completion_timeout(&slots[i].cmp, tmo)) {
+			pr_warn("%s: benchmark transfer timed out\n",
+					thread_name);
+			ret = -ETIMEDOUT;
+			break;
+		}
+
+		xdmatest_bench_record(&bench_stats,
+			ktime_us_delta(ktime_get(), slots[i].start), len);
+
+		if (!kthread_should_stop() && time_before(jiffies, deadline)) {
+			if (cdmatest_bench_submit(thread, &slots[i],
+						dma_srcs[i], dma_dsts[i],
+						len)) {
+				pr_warn("%s: benchmark resubmit failed\n",
+						thread_name);
+				deadline = jiffies;	/* drain and stop */
+				inflight--;
+			}
+		} else {
+			inflight--;
+		}
+
+		i = (i + 1) % depth;
+	}
+
+	bench_stats.usecs = ktime_us_delta(ktime_get(), start);
+	bench_stats.irqs = atomic_read(&bench_irqs);
+
+	for (i = 0; i < depth; i++) {
+		dma_unmap_single(dev->dev, dma_srcs[i], len, DMA_TO_DEVICE);
+		dma_unmap_single(dev->dev, dma_dsts[i], len, DMA_FROM_DEVICE);
+	}
+
+err_slots:
+	kfree(dma_dsts);
+	kfree(dma_srcs);
+	kfree(slots);
+	for (i = 0; thread->dsts[i]; i++)
+		kfree(thread->dsts[i]);
+err_dstbuf:
+	kfree(thread->dsts);
+err_dsts:
+	for (i = 0; thread->srcs[i]; i++)
+		kfree(thread->srcs[i]);
+err_srcbuf:
+	kfree(thread->srcs);
+err_srcs:
+	pr_notice("%s: benchmark done: %llu transfers of %u bytes in %llu us (status %d)\n",
+			thread_name, bench_stats.transfers, len,
+			bench_stats.usecs, ret);
+
+	while (!kthread_should_stop()) {
+		DECLARE_WAIT_QUEUE_HEAD_ONSTACK(wait_cdmatest_exit);
+		interruptible_sleep_on(&wait_cdmatest_exit);
+	}
+
+	return ret;
+}
+
 static void cdmatest_cleanup_channel(struct cdmatest_chan *dtc)
 {
 	struct cdmatest_thread *thread;
@@ -531,7 +741,9 @@ static int cdmatest_add_threads(struct cdmatest_chan *dtc,
 		thread->chan = dtc->chan;
 		thread->type = type;
 		smp_wmb();
-		thread->task = kthread_run(cdmatest_func, thread, "%s-%s%u",
+		thread->task = kthread_run(benchmark && type == DMA_MEMCPY ?
+				cdmatest_bench_func : cdmatest_func,
+				thread, "%s-%s%u",
 				dma_chan_name(chan), op, i);
 		if (IS_ERR(thread->task)) {
 			pr_warn("cdmatest: Failed to run thread %s-%s%u\n",
@@ -618,6 +830,10 @@ static int __init cdmatest_init(void)
 			break; /* we have all we need */
 	}
 
+	if (!err)
+		bench_debugfs = xdmatest_bench_debugfs_init("cdmatest",
+							&bench_stats);
+
 	return err;
 }
 /* when compiled-in wait for drivers to load first */
@@ -628,6 +844,8 @@ static void __exit cdmatest_exit(void)
 	struct cdmatest_chan *dtc, *_dtc;
 	struct dma_chan *chan;
 
+	debugfs_remove_recursive(bench_debugfs);
+
 	list_for_each_entry_safe(dtc, _dtc, &cdmatest_channels, node) {
 		list_del(&dtc->node);
 		chan = dtc->chan;
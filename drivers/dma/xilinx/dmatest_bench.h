@@ -0,0 +1,152 @@
+/*
+ * Benchmark support shared by the Xilinx DMA test clients
+ *
+ * Copyright (C) 2013 Xilinx, Inc. All rights reserved.
+ *
+ * Collects throughput and per-transfer latency statistics for the
+ * axidmatest, cdmatest and vdmatest modules and reports them through
+ * debugfs, so a new PL bitstream can be qualified without userspace
+ * tooling.  The transfer mechanics stay in each test module; only the
+ * bookkeeping lives here.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+#ifndef __XILINX_DMATEST_BENCH_H
+#define __XILINX_DMATEST_BENCH_H
+
+#include <linux/debugfs.h>
+#include <linux/fs.h>
+#include <linux/ktime.h>
+#include <linux/log2.h>
+#include <linux/math64.h>
+#include <linux/seq_file.h>
+
+/*
+ * Latencies are kept in power-of-two microsecond buckets; the last
+ * bucket collects everything from ~4 seconds up
+ */
+#define XDMATEST_BENCH_BUCKETS	23
+
+struct xdmatest_bench_stats {
+	u64 bytes;			/* Payload moved */
+	u64 transfers;			/* Completed transfers */
+	u64 irqs;			/* Completion callbacks seen */
+	u64 usecs;			/* Wall clock for the whole run */
+	u64 lat_min;			/* Per-transfer latency, usecs */
+	u64 lat_max;
+	u64 lat_sum;
+	u64 lat_hist[XDMATEST_BENCH_BUCKETS];
+};
+
+static void xdmatest_bench_record(struct xdmatest_bench_stats *st,
+				u64 usecs, unsigned int bytes)
+{
+	int bucket = 0;
+
+	if (usecs)
+		bucket = min(ilog2(usecs) + 1, XDMATEST_BENCH_BUCKETS - 1);
+
+	if (!st->transfers || usecs < st->lat_min)
+		st->lat_min = usecs;
+	if (usecs > st->lat_max)
+		st->lat_max = usecs;
+
+	st->lat_hist[bucket]++;
+	st->lat_sum += usecs;
+	st->transfers++;
+	st->bytes += bytes;
+}
+
+/*
+ * Upper bound in usecs of the bucket holding the requested percentile.
+ * Good enough to spot outliers; the exact values are in the histogram.
+ */
+static u64 xdmatest_bench_percentile(struct xdmatest_bench_stats *st,
+				unsigned int pct)
+{
+	u64 target = div_u64(st->transfers * pct + 99, 100);
+	u64 seen = 0;
+	int i;
+
+	for (i = 0; i < XDMATEST_BENCH_BUCKETS; i++) {
+		seen += st->lat_hist[i];
+		if (seen >= target)
+			return i ? 1ULL << i : 1;
+	}
+
+	return st->lat_max;
+}
+
+static int xdmatest_bench_show(struct seq_file *s, void *unused)
+{
+	struct xdmatest_bench_stats *st = s->private;
+	u64 tput, cb;
+	int i;
+
+	if (!st->transfers) {
+		seq_puts(s, "no results, reload with benchmark=1\n");
+		return 0;
+	}
+
+	/* bytes/usec is MB/s; scale by 1000 to keep three decimals */
+	tput = st->usecs ? div64_u64(st->bytes * 1000, st->usecs) : 0;
+	cb = div_u64(st->irqs * 100, st->transfers);
+
+	seq_printf(s, "transfers: %llu\n", st->transfers);
+	seq_printf(s, "bytes: %llu\n", st->bytes);
+	seq_printf(s, "elapsed_us: %llu\n", st->usecs);
+	seq_printf(s, "throughput_mb_per_s: %llu.%03llu\n",
+			tput / 1000, tput % 1000);
+	seq_printf(s, "callbacks_per_transfer: %llu.%02llu\n",
+			cb / 100, cb % 100);
+	seq_printf(s, "latency_min_us: %llu\n", st->lat_min);
+	seq_printf(s, "latency_avg_us: %llu\n",
+			div_u64(st->lat_sum, st->transfers));
+	seq_printf(s, "latency_p50_us: %llu\n",
+			xdmatest_bench_percentile(st, 50));
+	seq_printf(s, "latency_p90_us: %llu\n",
+			xdmatest_bench_percentile(st, 90));
+	seq_printf(s, "latency_p99_us: %llu\n",
+			xdmatest_bench_percentile(st, 99));
+	seq_printf(s, "latency_max_us: %llu\n", st->lat_max);
+
+	for (i = 0; i < XDMATEST_BENCH_BUCKETS; i++) {
+		if (!st->lat_hist[i])
+			continue;
+		seq_printf(s, "latency_hist_le_%llu_us: %llu\n",
+				i ? 1ULL << i : 1, st->lat_hist[i]);
+	}
+
+	return 0;
+}
+
+static int xdmatest_bench_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, xdmatest_bench_show, inode->i_private);
+}
+
+static const struct file_operations xdmatest_bench_fops = {
+	.owner		= THIS_MODULE,
+	.open		= xdmatest_bench_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+/* Expose <name>/results; debugfs being unavailable is not an error */
+static struct dentry *xdmatest_bench_debugfs_init(const char *name,
+				struct xdmatest_bench_stats *st)
+{
+	struct dentry *dir;
+
+	dir = debugfs_create_dir(name, NULL);
+	if (!IS_ERR_OR_NULL(dir))
+		debugfs_create_file("results", S_IRUGO, dir, st,
+					&xdmatest_bench_fops);
+
+	return dir;
+}
+
+#endif
@@ -19,6 +19,8 @@
 #include <linux/wait.h>
 #include <linux/amba/xilinx_dma.h>
 
+#include "dmatest_bench.h"
+
 static unsigned int test_buf_size = 64;
 module_param(test_buf_size, uint, S_IRUGO);
 MODULE_PARM_DESC(test_buf_size, "Size of the memcpy test buffer");
@@ -28,6 +30,23 @@ module_param(iterations, uint, S_IRUGO);
 MODULE_PARM_DESC(iterations,
 		"Iterations before stopping test (default: infinite)");
 
+static bool benchmark;
+module_param(benchmark, bool, S_IRUGO);
+MODULE_PARM_DESC(benchmark,
+		"Measure throughput/latency instead of verifying data");
+
+static unsigned int bench_hsize = 256;
+module_param(bench_hsize, uint, S_IRUGO);
+MODULE_PARM_DESC(bench_hsize, "Benchmark frame line length in bytes");
+
+static unsigned int bench_vsize = 256;
+module_param(bench_vsize, uint, S_IRUGO);
+MODULE_PARM_DESC(bench_vsize, "Benchmark lines per frame");
+
+static unsigned int bench_secs = 10;
+module_param(bench_secs, uint, S_IRUGO);
+MODULE_PARM_DESC(bench_secs, "Benchmark duration in seconds (default: 10)");
+
 /*
  * Initialization patterns. All bytes in the source buffer has bit 7
  * set, all bytes in the destination buffer has bit 7 cleared.
@@ -68,6 +87,11 @@ struct vdmatest_chan {
 static LIST_HEAD(vdmatest_channels);
 static unsigned int nr_channels;
 
+/* Benchmark results, readable from debugfs at vdmatest/results */
+static struct xdmatest_bench_stats bench_stats;
+static struct dentry *bench_debugfs;
+static atomic_t bench_irqs;
+
 static void vdmatest_init_srcs(u8 **bufs, unsigned int start, unsigned int len)
 {
 	unsigned int i;
@@ -172,6 +196,12 @@ static void vdmatest_slave_rx_callback(void *completion)
 	complete(completion);
 }
 
+static void vdmatest_bench_callback(void *completion)
+{
+	atomic_inc(&bench_irqs);
+	complete(completion);
+}
+
 /*
  * Function for slave transfers
  * Each thread requires 2 channels, one for transmit, and one for receive
@@ -456,6 +486,190 @@ err_srcs:
 	return ret;
 }
 
+/*
+ * Benchmark thread.  Moves rings of frm_cnt frames of bench_hsize x
+ * bench_vsize bytes through the loopback for bench_secs seconds and
+ * records throughput and per-ring latency into bench_stats.  One ring
+ * of frames is in flight at a time, matching how the engine owns all
+ * frame stores per transaction; the buffers are mapped once and
+ * recycled, and no data verification is done.
+ */
+static int vdmatest_bench_func(void *data)
+{
+	struct vdmatest_slave_thread *thread = data;
+	struct dma_chan *tx_chan = thread->tx_chan;
+	struct dma_chan *rx_chan = thread->rx_chan;
+	struct dma_device *tx_dev = tx_chan->device;
+	struct dma_device *rx_dev = rx_chan->device;
+	struct xilinx_vdma_config config;
+	const char *thread_name = current->comm;
+	unsigned long deadline;
+	unsigned int frm_size, hsize, vsize;
+	ktime_t start;
+	int frm_cnt = 8;
+	int ret = -ENOMEM;
+	int i;
+	dma_addr_t dma_srcs[8];
+	dma_addr_t dma_dsts[8];
+	struct scatterlist tx_sg[8];
+	struct scatterlist rx_sg[8];
+
+	smp_rmb();
+
+	hsize = bench_hsize ? bench_hsize : 256;
+	vsize = bench_vsize ? bench_vsize : 256;
+	frm_size = hsize * vsize;
+
+	thread->srcs = kcalloc(frm_cnt + 1, sizeof(u8 *), GFP_KERNEL);
+	if (!thread->srcs)
+		goto err_srcs;
+	for (i = 0; i < frm_cnt; i++) {
+		thread->srcs[i] = kmalloc(frm_size, GFP_KERNEL);
+		if (!thread->srcs[i])
+			goto err_srcbuf;
+	}
+	thread->srcs[i] = NULL;
+
+	thread->dsts = kcalloc(frm_cnt + 1, sizeof(u8 *), GFP_KERNEL);
+	if (!thread->dsts)
+		goto err_dsts;
+	for (i = 0; i < frm_cnt; i++) {
+		thread->dsts[i] = kmalloc(frm_size, GFP_KERNEL);
+		if (!thread->dsts[i])
+			goto err_dstbuf;
+	}
+	thread->dsts[i] = NULL;
+
+	/* Map once; the CPU does not touch the frames during the run */
+	sg_init_table(tx_sg, frm_cnt);
+	sg_init_table(rx_sg, frm_cnt);
+	for (i = 0; i < frm_cnt; i++) {
+		dma_srcs[i] = dma_map_single(tx_dev->dev, thread->srcs[i],
+						frm_size, DMA_MEM_TO_DEV);
+		dma_dsts[i] = dma_map_single(rx_dev->dev, thread->dsts[i],
+						frm_size, DMA_DEV_TO_MEM);
+		sg_dma_address(&tx_sg[i]) = dma_srcs[i];
+		sg_dma_address(&rx_sg[i]) = dma_dsts[i];
+		sg_dma_len(&tx_sg[i]) = frm_size;
+		sg_dma_len(&rx_sg[i]) = frm_size;
+	}
+
+	/* Set up hardware configuration information */
+	config.direction = DMA_MEM_TO_DEV;
+	config.vsize = vsize;
+	config.hsize = hsize;
+	config.stride = hsize;
+	config.frm_cnt_en = 1;
+	config.coalesc = frm_cnt;	/* One callback per completed ring */
+	config.delay = 0;
+	config.frm_dly = 0;
+	config.park = 1;
+	config.gen_lock = 0;
+	config.master = 0;
+	config.park_frm = 0;
+	config.disable_intr = 0;
+	tx_dev->device_control(tx_chan, DMA_SLAVE_CONFIG,
+				(unsigned long)&config);
+
+	config.direction = DMA_DEV_TO_MEM;
+	config.park = 0;
+	rx_dev->device_control(rx_chan, DMA_SLAVE_CONFIG,
+				(unsigned long)&config);
+
+	memset(&bench_stats, 0, sizeof(bench_stats));
+	atomic_set(&bench_irqs, 0);
+
+	ret = 0;
+	start = ktime_get();
+	deadline = jiffies + bench_secs * HZ;
+
+	while (!kthread_should_stop() && time_before(jiffies, deadline)) {
+		struct dma_async_tx_descriptor *txd;
+		struct dma_async_tx_descriptor *rxd;
+		struct completion rx_cmp;
+		struct completion tx_cmp;
+		enum dma_ctrl_flags flags = DMA_CTRL_ACK |
+				DMA_COMPL_SKIP_DEST_UNMAP |
+				DMA_COMPL_SKIP_SRC_UNMAP |
+				DMA_PREP_INTERRUPT;
+		unsigned long tmo = msecs_to_jiffies(30000);
+		ktime_t submitted;
+
+		rxd = rx_dev->device_prep_slave_sg(rx_chan, rx_sg, frm_cnt,
+				DMA_DEV_TO_MEM, flags, NULL);
+		txd = tx_dev->device_prep_slave_sg(tx_chan, tx_sg, frm_cnt,
+				DMA_MEM_TO_DEV, flags, NULL);
+		if (!rxd || !txd) {
+			pr_warn("%s: benchmark prep failed\n", thread_name);
+			ret = -EIO;
+			break;
+		}
+
+		init_completion(&rx_cmp);
+		rxd->callback = vdmatest_bench_callback;
+		rxd->callback_param = &rx_cmp;
+
+		init_completion(&tx_cmp);
+		txd->callback = vdmatest_bench_callback;
+		txd->callback_param = &tx_cmp;
+
+		submitted = ktime_get();
+
+		if (dma_submit_error(rxd->tx_submit(rxd)) ||
+				dma_submit_error(txd->tx_submit(txd))) {
+			pr_warn("%s: benchmark submit failed\n", thread_name);
+			ret = -EIO;
+			break;
+		}
+
+		dma_async_issue_pending(tx_chan);
+		dma_async_issue_pending(rx_chan);
+
+		if (!wait_for_completion_timeout(&tx_cmp, tmo) ||
+			!wait_for_completion_timeout(&rx_cmp, tmo)) {
+			pr_warn("%s: benchmark transfer timed out\n",
+					thread_name);
+			ret = -ETIMEDOUT;
+			break;
+		}
+
+		xdmatest_bench_record(&bench_stats,
+			ktime_us_delta(ktime_get(), submitted),
+			frm_cnt * frm_size);
+	}
+
+	bench_stats.usecs = ktime_us_delta(ktime_get(), start);
+	bench_stats.irqs = atomic_read(&bench_irqs);
+
+	for (i = 0; i < frm_cnt; i++) {
+		dma_unmap_single(tx_dev->dev, dma_srcs[i], frm_size,
+				DMA_MEM_TO_DEV);
+		dma_unmap_single(rx_dev->dev, dma_dsts[i], frm_size,
+				DMA_DEV_TO_MEM);
+	}
+
+	for (i = 0; thread->dsts[i]; i++)
+		kfree(thread->dsts[i]);
+err_dstbuf:
+	kfree(thread->dsts);
+err_dsts:
+	for (i = 0; thread->srcs[i]; i++)
+		kfree(thread->srcs[i]);
+err_srcbuf:
+	kfree(thread->srcs);
+err_srcs:
+	pr_notice("%s: benchmark done: %llu rings of %d %ux%u frames in %llu us (status %d)\n",
+			thread_name, bench_stats.transfers, frm_cnt,
+			hsize, vsize, bench_stats.usecs, ret);
+
+	while (!kthread_should_stop()) {
+		DECLARE_WAIT_QUEUE_HEAD_ONSTACK(wait_vdmatest_exit);
+		interruptible_sleep_on(&wait_vdmatest_exit);
+	}
+
+	return ret;
+}
+
 static void vdmatest_cleanup_channel(struct vdmatest_chan *dtc)
 {
 	struct vdmatest_slave_thread *thread;
@@ -491,7 +705,8 @@ static int vdmatest_add_slave_threads(struct vdmatest_chan *tx_dtc,
 	thread->rx_chan = rx_chan;
 	thread->type = (enum dma_transaction_type)DMA_SLAVE;
 	smp_wmb();
-	thread->task = kthread_run(vdmatest_slave_func, thread, "%s-%s",
+	thread->task = kthread_run(benchmark ? vdmatest_bench_func :
+			vdmatest_slave_func, thread, "%s-%s",
 		dma_chan_name(tx_chan), dma_chan_name(rx_chan));
 	if (IS_ERR(thread->task)) {
 		pr_warn("vdmatest: Failed to run thread %s-%s\n",
@@ -594,6 +809,11 @@ static int __init vdmatest_init(void)
 			dma_release_channel(rx_chan);
 		}
 	}
+
+	if (!err)
+		bench_debugfs = xdmatest_bench_debugfs_init("vdmatest",
+							&bench_stats);
+
 	return err;
 }
 /* when compiled-in wait for drivers to load first */
@@ -604,6 +824,8 @@ static void __exit vdmatest_exit(void)
 	struct vdmatest_chan *dtc, *_dtc;
 	struct dma_chan *chan;
 
+	debugfs_remove_recursive(bench_debugfs);
+
 	list_for_each_entry_safe(dtc, _dtc, &vdmatest_channels, node) {
 		list_del(&dtc->node);
 		chan = dtc->chan;
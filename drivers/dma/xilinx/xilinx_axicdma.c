@@ -372,12 +372,38 @@ static void xilinx_cdma_start_transfer(struct xilinx_cdma_chan *chan)
 			struct xilinx_cdma_desc_sw, node);
 
 	if (chan->has_sg) {
+		struct xilinx_cdma_desc_sw *desc;
+		LIST_HEAD(batch);
+		int num_bds = 0;
+		u32 reg;
 
-		/* If hybrid mode, append pending list to active list */
-		desct = container_of(chan->pending_list.prev,
-				struct xilinx_cdma_desc_sw, node);
+		/*
+		 * Batch up to the coalescing limit of pending BDs behind a
+		 * single kick; the hardware stops at the tail pointer and
+		 * the completion interrupt of one batch starts the next.
+		 */
+		desct = desch;
+		list_for_each_entry(desc, &chan->pending_list, node) {
+			desct = desc;
+			if (++num_bds == XILINX_CDMA_COALESCE_MAX)
+				break;
+		}
+
+		/*
+		 * Match the IOC threshold to the batch size, so the whole
+		 * BD chain completes with one interrupt instead of one per
+		 * BD. Skip this when the client asked for a specific
+		 * coalescing count via DMA_SLAVE_CONFIG.
+		 */
+		if (chan->config.coalesc <= 1) {
+			reg = CDMA_IN(&chan->regs->cr);
+			reg &= ~XILINX_CDMA_XR_COALESCE_MASK;
+			reg |= num_bds << XILINX_CDMA_COALESCE_SHIFT;
+			CDMA_OUT(&chan->regs->cr, reg);
+		}
 
-		list_splice_tail_init(&chan->pending_list, &chan->active_list);
+		list_cut_position(&batch, &chan->pending_list, &desct->node);
+		list_splice_tail(&batch, &chan->active_list);
 
 		/*
 		 * If hardware is idle, then all descriptors on the active list
@@ -1065,6 +1091,28 @@ static int xilinx_cdma_of_remove(struct platform_device *op)
 	return 0;
 }
 
+/*
+ * Quiesce the engine on reboot/kexec: the CDMA has no run/stop bit, so
+ * reset the core outright, which aborts any outstanding transfer and
+ * clears the interrupt enables, before the next kernel takes over
+ * without a DDR reset in between.
+ */
+static void xilinx_cdma_of_shutdown(struct platform_device *op)
+{
+	struct xilinx_cdma_device *xdev = dev_get_drvdata(&op->dev);
+	int i;
+
+	for (i = 0; i < XILINX_CDMA_MAX_CHANS_PER_DEVICE; i++) {
+		struct xilinx_cdma_chan *chan = xdev->chan[i];
+
+		if (!chan)
+			continue;
+
+		cdma_init(chan);
+		tasklet_kill(&chan->tasklet);
+	}
+}
+
 static const struct of_device_id xilinx_cdma_of_ids[] = {
 	{ .compatible = "xlnx,axi-cdma",},
 	{}
@@ -1078,6 +1126,7 @@ static struct platform_driver xilinx_cdma_of_driver = {
 	},
 	.probe = xilinx_cdma_of_probe,
 	.remove = xilinx_cdma_of_remove,
+	.shutdown = xilinx_cdma_of_shutdown,
 };
 
 module_platform_driver(xilinx_cdma_of_driver);
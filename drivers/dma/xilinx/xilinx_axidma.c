@@ -23,6 +23,7 @@
 #include <linux/slab.h>
 #include <linux/interrupt.h>
 #include <linux/dmapool.h>
+#include <linux/llist.h>
 #include <linux/io.h>
 #include <linux/of.h>
 #include <linux/of_platform.h>
@@ -31,6 +32,9 @@
 #include <linux/of_irq.h>
 #include <linux/amba/xilinx_dma.h>
 
+#define CREATE_TRACE_POINTS
+#include <trace/events/xilinx_dma.h>
+
 /* Hw specific definitions */
 #define XILINX_DMA_MAX_CHANS_PER_DEVICE	0x2
 #define XILINX_DMA_MAX_TRANS_LEN	0x7FFFFF
@@ -90,6 +94,8 @@
 #define XILINX_DMA_BD_STS_COMPL_MASK	0x80000000
 #define XILINX_DMA_BD_STS_ERR_MASK	0x70000000
 #define XILINX_DMA_BD_STS_ALL_MASK	0xF0000000
+#define XILINX_DMA_BD_STS_XFER_LEN_MASK	0x007FFFFF
+					/* Bytes the hw moved for this BD */
 
 /* Axi DMA BD special bits definitions */
 #define XILINX_DMA_BD_SOP	0x08000000	/* Start of packet bit */
@@ -109,8 +115,8 @@
 #define XILINX_DMA_RESET_LOOP		1000000
 #define XILINX_DMA_HALT_LOOP		1000000
 
-/* Device Id in the private structure */
-#define XILINX_DMA_DEVICE_ID_SHIFT	28
+/* Descriptors carved out of the DMA pool up front per channel */
+#define XILINX_DMA_DESC_PREALLOC	64
 
 /* IO accessors */
 #define DMA_OUT(addr, val)	(iowrite32(val, addr))
@@ -142,6 +148,7 @@ struct xilinx_dma_desc_sw {
 	struct xilinx_dma_desc_hw hw;
 	struct list_head node;
 	struct list_head tx_list;
+	struct llist_node llnode;
 	struct dma_async_tx_descriptor async_tx;
 } __aligned(64);
 
@@ -169,6 +176,7 @@ struct xilinx_dma_chan {
 	bool sg_waiting;		/* Scatter gather transfer waiting */
 	struct list_head active_list;	/* Active descriptors */
 	struct list_head pending_list;	/* Descriptors waiting */
+	struct llist_head free_descs;	/* Lock-free recycled descriptors */
 	struct dma_chan common;		/* DMA common channel */
 	struct dma_pool *desc_pool;	/* Descriptors pool */
 	struct device *dev;		/* The dma device */
@@ -180,6 +188,7 @@ struct xilinx_dma_chan {
 	int is_lite;			/* Whether is light build */
 	int has_sg;			/* Support scatter transfers */
 	int has_dre;			/* Support unaligned transfers */
+	int cyclic;			/* Channel runs a cyclic transfer */
 	int err;			/* Channel has errors */
 	struct tasklet_struct tasklet;	/* Cleanup work after irq */
 	u32 feature;			/* IP feature */
@@ -207,6 +216,9 @@ struct xilinx_dma_device {
 static int xilinx_dma_alloc_chan_resources(struct dma_chan *dchan)
 {
 	struct xilinx_dma_chan *chan = to_xilinx_chan(dchan);
+	struct xilinx_dma_desc_sw *desc;
+	dma_addr_t pdesc;
+	int i;
 
 	/* Has this channel already been allocated? */
 	if (chan->desc_pool)
@@ -227,6 +239,19 @@ static int xilinx_dma_alloc_chan_resources(struct dma_chan *dchan)
 		return -ENOMEM;
 	}
 
+	/*
+	 * Carve a working set of descriptors out of the pool up front and
+	 * park them on the lock-free free stack, so the prep fast path
+	 * normally never has to call into the DMA pool at all.
+	 */
+	for (i = 0; i < XILINX_DMA_DESC_PREALLOC; i++) {
+		desc = dma_pool_alloc(chan->desc_pool, GFP_KERNEL, &pdesc);
+		if (!desc)
+			break;
+		desc->async_tx.phys = pdesc;
+		llist_add(&desc->llnode, &chan->free_descs);
+	}
+
 	chan->completed_cookie = 1;
 	chan->cookie = 1;
 
@@ -256,9 +281,22 @@ static void xilinx_dma_free_desc_list_reverse(struct xilinx_dma_chan *chan,
 	}
 }
 
+/*
+ * Hand a descriptor back to the lock-free free stack for reuse. Safe to
+ * call from any context; pushes never contend with the single popping
+ * (prep) thread.
+ */
+static void xilinx_dma_recycle_descriptor(struct xilinx_dma_chan *chan,
+					struct xilinx_dma_desc_sw *desc)
+{
+	llist_add(&desc->llnode, &chan->free_descs);
+}
+
 static void xilinx_dma_free_chan_resources(struct dma_chan *dchan)
 {
 	struct xilinx_dma_chan *chan = to_xilinx_chan(dchan);
+	struct xilinx_dma_desc_sw *desc;
+	struct llist_node *node;
 	unsigned long flags;
 
 	dev_dbg(chan->dev, "Free all channel resources.\n");
@@ -267,6 +305,14 @@ static void xilinx_dma_free_chan_resources(struct dma_chan *dchan)
 	xilinx_dma_free_desc_list(chan, &chan->pending_list);
 	spin_unlock_irqrestore(&chan->lock, flags);
 
+	/* Return the recycled descriptors to the pool before killing it */
+	node = llist_del_all(&chan->free_descs);
+	while (node) {
+		desc = llist_entry(node, struct xilinx_dma_desc_sw, llnode);
+		node = node->next;
+		dma_pool_free(chan->desc_pool, desc, desc->async_tx.phys);
+	}
+
 	dma_pool_destroy(chan->desc_pool);
 	chan->desc_pool = NULL;
 }
@@ -282,35 +328,117 @@ static enum dma_status xilinx_dma_desc_status(struct xilinx_dma_chan *chan,
 static void xilinx_chan_desc_cleanup(struct xilinx_dma_chan *chan)
 {
 	struct xilinx_dma_desc_sw *desc, *_desc;
+	unsigned int count = 0;
+	LIST_HEAD(done_list);
 	unsigned long flags;
 
 	spin_lock_irqsave(&chan->lock, flags);
 
-	list_for_each_entry_safe(desc, _desc, &chan->active_list, node) {
-		dma_async_tx_callback callback;
-		void *callback_param;
+	if (chan->cyclic) {
+		/*
+		 * In cyclic mode the BD ring is reused forever; just report
+		 * each period the hardware has finished and hand the BD
+		 * straight back by clearing its status word.
+		 */
+		list_for_each_entry(desc, &chan->active_list, node) {
+			dma_async_tx_callback callback;
+			void *callback_param;
+
+			if (!(desc->hw.status & XILINX_DMA_BD_STS_COMPL_MASK))
+				continue;
 
+			desc->hw.status &= ~XILINX_DMA_BD_STS_ALL_MASK;
+
+			callback = desc->async_tx.callback;
+			callback_param = desc->async_tx.callback_param;
+			if (callback) {
+				spin_unlock_irqrestore(&chan->lock, flags);
+				callback(callback_param);
+				spin_lock_irqsave(&chan->lock, flags);
+			}
+		}
+
+		spin_unlock_irqrestore(&chan->lock, flags);
+		return;
+	}
+
+	/*
+	 * Move everything that is done onto a private list while holding
+	 * the lock, then drop it once for the whole batch, so callbacks
+	 * and descriptor recycling never run under chan->lock and a
+	 * submitting thread is not held off by completion work.
+	 */
+	list_for_each_entry_safe(desc, _desc, &chan->active_list, node) {
 		if (xilinx_dma_desc_status(chan, desc) == DMA_IN_PROGRESS)
 			break;
 
 		/* Remove from the list of running transactions */
+		list_move_tail(&desc->node, &done_list);
+		count++;
+	}
+
+	spin_unlock_irqrestore(&chan->lock, flags);
+
+	trace_xilinx_chan_desc_cleanup(chan->id, count);
+
+	list_for_each_entry_safe(desc, _desc, &done_list, node) {
+		dma_async_tx_callback callback;
+		void *callback_param;
+
 		list_del(&desc->node);
 
 		/* Run the link descriptor callback function */
 		callback = desc->async_tx.callback;
 		callback_param = desc->async_tx.callback_param;
-		if (callback) {
-			spin_unlock_irqrestore(&chan->lock, flags);
+		if (callback)
 			callback(callback_param);
-			spin_lock_irqsave(&chan->lock, flags);
-		}
 
-		/* Run any dependencies, then free the descriptor */
+		/* Run any dependencies, then recycle the descriptor */
 		dma_run_dependencies(&desc->async_tx);
-		dma_pool_free(chan->desc_pool, desc, desc->async_tx.phys);
+		xilinx_dma_recycle_descriptor(chan, desc);
 	}
+}
 
-	spin_unlock_irqrestore(&chan->lock, flags);
+/**
+ * xilinx_dma_desc_residue - Bytes still owed for a transaction
+ * @chan: xilinx DMA channel
+ * @cookie: cookie of the transaction, i.e. of its last BD
+ *
+ * CONTEXT: must be called with chan->lock held
+ *
+ * Adds up the unfilled part of every BD up to and including @cookie on
+ * the active and pending lists. The hardware writes the number of bytes
+ * it actually moved into the BD status word when it retires a BD, so a
+ * receive buffer the stream left early (EOP before the buffer filled)
+ * is charged at its real length; BDs the hardware has not written back
+ * yet are charged in full.
+ */
+static u32 xilinx_dma_desc_residue(struct xilinx_dma_chan *chan,
+					dma_cookie_t cookie)
+{
+	struct xilinx_dma_desc_sw *desc;
+	u32 len, done;
+	u32 residue = 0;
+
+	list_for_each_entry(desc, &chan->active_list, node) {
+		struct xilinx_dma_desc_hw *hw = &desc->hw;
+
+		if (desc->async_tx.cookie > cookie)
+			break;
+
+		len = hw->control & XILINX_DMA_MAX_TRANS_LEN;
+		done = hw->status & XILINX_DMA_BD_STS_XFER_LEN_MASK;
+		residue += len - min(done, len);
+	}
+
+	list_for_each_entry(desc, &chan->pending_list, node) {
+		if (desc->async_tx.cookie > cookie)
+			break;
+
+		residue += desc->hw.control & XILINX_DMA_MAX_TRANS_LEN;
+	}
+
+	return residue;
 }
 
 static enum dma_status xilinx_tx_status(struct dma_chan *dchan,
@@ -320,15 +448,33 @@ static enum dma_status xilinx_tx_status(struct dma_chan *dchan,
 	struct xilinx_dma_chan *chan = to_xilinx_chan(dchan);
 	dma_cookie_t last_used;
 	dma_cookie_t last_complete;
+	enum dma_status ret;
+	unsigned long flags;
+	u32 residue = 0;
 
 	xilinx_chan_desc_cleanup(chan);
 
 	last_used = dchan->cookie;
 	last_complete = chan->completed_cookie;
 
-	dma_set_tx_state(txstate, last_complete, last_used, 0);
+	ret = dma_async_is_complete(cookie, last_complete, last_used);
+
+	/*
+	 * Report how much of the transaction is still outstanding, so a
+	 * consumer that times out can harvest the partially filled buffer
+	 * (tx_status, memcpy out the received part, terminate) instead of
+	 * waiting for the full buffer to complete. Cyclic transfers never
+	 * complete, residue is meaningless for them.
+	 */
+	if (ret == DMA_IN_PROGRESS && !chan->cyclic) {
+		spin_lock_irqsave(&chan->lock, flags);
+		residue = xilinx_dma_desc_residue(chan, cookie);
+		spin_unlock_irqrestore(&chan->lock, flags);
+	}
+
+	dma_set_tx_state(txstate, last_complete, last_used, residue);
 
-	return dma_async_is_complete(cookie, last_complete, last_used);
+	return ret;
 }
 
 static int dma_is_running(struct xilinx_dma_chan *chan)
@@ -449,6 +595,9 @@ static void xilinx_dma_start_transfer(struct xilinx_dma_chan *chan)
 
 		DMA_OUT(&chan->regs->cdr, desch->async_tx.phys);
 
+		trace_xilinx_dma_start_transfer(chan->id, chan->direction,
+						desch->async_tx.phys);
+
 		dma_start(chan);
 
 		if (chan->err)
@@ -459,8 +608,17 @@ static void xilinx_dma_start_transfer(struct xilinx_dma_chan *chan)
 		DMA_OUT(&chan->regs->cr,
 			DMA_IN(&chan->regs->cr) | XILINX_DMA_XR_IRQ_ALL_MASK);
 
-		/* Update tail ptr register and start the transfer */
-		DMA_OUT(&chan->regs->tdr, desct->async_tx.phys);
+		/* Update tail ptr register and start the transfer. For a
+		 * cyclic transfer the BD ring is closed on itself, so park
+		 * the tail pointer on a pad address inside the last
+		 * descriptor: the hardware never matches it and keeps
+		 * circulating the ring without software re-arming.
+		 */
+		if (chan->cyclic)
+			DMA_OUT(&chan->regs->tdr, desct->async_tx.phys +
+				sizeof(struct xilinx_dma_desc_hw));
+		else
+			DMA_OUT(&chan->regs->tdr, desct->async_tx.phys);
 		goto out_unlock;
 	}
 
@@ -485,6 +643,9 @@ static void xilinx_dma_start_transfer(struct xilinx_dma_chan *chan)
 
 	hw = &desch->hw;
 
+	trace_xilinx_dma_start_transfer(chan->id, chan->direction,
+					desch->async_tx.phys);
+
 	/* Enable interrupts */
 	DMA_OUT(&chan->regs->cr,
 		DMA_IN(&chan->regs->cr) | XILINX_DMA_XR_IRQ_ALL_MASK);
@@ -579,6 +740,29 @@ static int dma_init(struct xilinx_dma_chan *chan)
 	return 0;
 }
 
+/*
+ * Program the interrupt coalescing threshold and delay counter saved
+ * in chan->config into the control register.  A reset returns the
+ * hardware to a threshold of one BD, so this must be repeated after
+ * every successful dma_init() on a configured channel.
+ */
+static void dma_set_coalesce(struct xilinx_dma_chan *chan)
+{
+	u32 reg = DMA_IN(&chan->regs->cr);
+
+	if (chan->config.coalesc <= XILINX_DMA_COALESCE_MAX) {
+		reg &= ~XILINX_DMA_XR_COALESCE_MASK;
+		reg |= chan->config.coalesc << XILINX_DMA_COALESCE_SHIFT;
+	}
+
+	if (chan->config.delay <= XILINX_DMA_DELAY_MAX) {
+		reg &= ~XILINX_DMA_XR_DELAY_MASK;
+		reg |= chan->config.delay << XILINX_DMA_DELAY_SHIFT;
+	}
+
+	DMA_OUT(&chan->regs->cr, reg);
+}
+
 
 static irqreturn_t dma_intr_handler(int irq, void *data)
 {
@@ -617,12 +801,23 @@ static irqreturn_t dma_intr_handler(int irq, void *data)
 	 * Device takes too long to do the transfer when user requires
 	 * responsiveness
 	 */
-	if (stat & XILINX_DMA_XR_IRQ_DELAY_MASK)
+	if (stat & XILINX_DMA_XR_IRQ_DELAY_MASK) {
+		/*
+		 * The delay timer fired with fewer completions than the
+		 * coalescing threshold; harvest the partial batch so a
+		 * stalled stream does not sit on finished BDs.
+		 */
 		dev_dbg(chan->dev, "Inter-packet latency too long\n");
+		update_cookie = !chan->cyclic;
+		to_transfer = !chan->cyclic;
+	}
 
 	if (stat & XILINX_DMA_XR_IRQ_IOC_MASK) {
-		update_cookie = 1;
-		to_transfer = 1;
+		/* A cyclic channel neither completes cookies nor needs
+		 * re-arming, the hardware keeps walking the closed BD ring.
+		 */
+		update_cookie = !chan->cyclic;
+		to_transfer = !chan->cyclic;
 	}
 
 	if (update_cookie)
@@ -687,10 +882,12 @@ static dma_cookie_t xilinx_dma_tx_submit(struct dma_async_tx_descriptor *tx)
 		 * If reset fails, need to hard reset the system.
 		 * Channel is no longer functional
 		 */
-		if (!dma_init(chan))
+		if (!dma_init(chan)) {
+			dma_set_coalesce(chan);
 			chan->err = 0;
-		else
+		} else {
 			return cookie;
+		}
 	}
 
 	spin_lock_irqsave(&chan->lock, flags);
@@ -722,12 +919,24 @@ static struct xilinx_dma_desc_sw *xilinx_dma_alloc_descriptor(
 					struct xilinx_dma_chan *chan)
 {
 	struct xilinx_dma_desc_sw *desc;
+	struct llist_node *node;
 	dma_addr_t pdesc;
 
-	desc = dma_pool_alloc(chan->desc_pool, GFP_ATOMIC, &pdesc);
-	if (!desc) {
-		dev_dbg(chan->dev, "out of memory for desc\n");
-		return NULL;
+	/*
+	 * Fast path: pop a recycled descriptor off the lock-free stack.
+	 * Prep routines are the only consumer, completion is the producer,
+	 * so the single-consumer llist_del_first() contract holds.
+	 */
+	node = llist_del_first(&chan->free_descs);
+	if (node) {
+		desc = llist_entry(node, struct xilinx_dma_desc_sw, llnode);
+		pdesc = desc->async_tx.phys;
+	} else {
+		desc = dma_pool_alloc(chan->desc_pool, GFP_ATOMIC, &pdesc);
+		if (!desc) {
+			dev_dbg(chan->dev, "out of memory for desc\n");
+			return NULL;
+		}
 	}
 
 	memset(desc, 0, sizeof(*desc));
@@ -877,6 +1086,109 @@ fail:
 	return NULL;
 }
 
+/**
+ * xilinx_dma_prep_dma_cyclic - prepare descriptors for a cyclic DMA transfer
+ * @dchan: DMA channel
+ * @buf_addr: physical address of the circular buffer
+ * @buf_len: total size of the circular buffer
+ * @period_len: size of one period; a callback fires per completed period
+ * @direction: DMA direction
+ * @flags: transfer ack flags
+ *
+ * The BD chain built here is closed on itself, so once started the
+ * hardware streams continuously into (or out of) the ring buffer with no
+ * per-buffer re-arming from interrupt context.
+ */
+static struct dma_async_tx_descriptor *xilinx_dma_prep_dma_cyclic(
+	struct dma_chan *dchan, dma_addr_t buf_addr, size_t buf_len,
+	size_t period_len, enum dma_transfer_direction direction,
+	unsigned long flags, void *context)
+{
+	struct xilinx_dma_chan *chan;
+	struct xilinx_dma_desc_sw *first = NULL, *prev = NULL, *new = NULL;
+	struct xilinx_dma_desc_hw *hw = NULL, *prev_hw = NULL;
+	size_t offset, copy, period_used;
+
+	if (!dchan)
+		return NULL;
+
+	if (!period_len || (buf_len % period_len))
+		return NULL;
+
+	chan = to_xilinx_chan(dchan);
+
+	if (chan->direction != direction)
+		return NULL;
+
+	if (!chan->has_sg)
+		return NULL;
+
+	/* Build one BD sub-chain per period */
+	for (offset = 0; offset < buf_len; offset += period_len) {
+		period_used = 0;
+
+		while (period_used < period_len) {
+			/* Allocate the link descriptor from DMA pool */
+			new = xilinx_dma_alloc_descriptor(chan);
+			if (!new) {
+				dev_err(chan->dev,
+					"No free memory for link descriptor\n");
+				goto fail;
+			}
+
+			copy = min((size_t)(period_len - period_used),
+				(size_t)chan->max_len);
+			hw = &(new->hw);
+
+			hw->buf_addr = buf_addr + offset + period_used;
+			hw->control = copy;
+
+			if ((direction == DMA_MEM_TO_DEV) && !period_used)
+				hw->control |= XILINX_DMA_BD_SOP;
+
+			if (!first) {
+				first = new;
+			} else {
+				prev_hw = &(prev->hw);
+				prev_hw->next_desc = new->async_tx.phys;
+			}
+
+			new->async_tx.cookie = 0;
+			async_tx_ack(&new->async_tx);
+
+			prev = new;
+			period_used += copy;
+
+			if ((direction == DMA_MEM_TO_DEV) &&
+				(period_used >= period_len))
+				hw->control |= XILINX_DMA_BD_EOP;
+
+			/* Insert the link descriptor into the LD ring */
+			list_add_tail(&new->node, &first->tx_list);
+		}
+	}
+
+	if (!first || !new)
+		return NULL;
+
+	/* Close the BD ring on itself so the hardware re-circulates */
+	hw->next_desc = first->async_tx.phys;
+
+	chan->cyclic = 1;
+	new->async_tx.flags = flags;
+	new->async_tx.cookie = -EBUSY;
+
+	return &first->async_tx;
+
+fail:
+	if (!first)
+		return NULL;
+
+	xilinx_dma_free_desc_list_reverse(chan, &first->tx_list);
+
+	return NULL;
+}
+
 /* Run-time device configuration for Axi DMA */
 static int xilinx_dma_device_control(struct dma_chan *dchan,
 				enum dma_ctrl_cmd cmd, unsigned long arg)
@@ -893,6 +1205,8 @@ static int xilinx_dma_device_control(struct dma_chan *dchan,
 		/* Halt the DMA engine */
 		dma_halt(chan);
 
+		chan->cyclic = 0;
+
 		spin_lock_irqsave(&chan->lock, flags);
 
 		/* Remove and free all of the descriptors in the lists */
@@ -907,22 +1221,14 @@ static int xilinx_dma_device_control(struct dma_chan *dchan,
 		 * Use value XILINX_DMA_NO_CHANGE to signal no change
 		 */
 		struct xilinx_dma_config *cfg = (struct xilinx_dma_config *)arg;
-		u32 reg = DMA_IN(&chan->regs->cr);
-
-		if (cfg->coalesc <= XILINX_DMA_COALESCE_MAX) {
-			reg &= ~XILINX_DMA_XR_COALESCE_MASK;
-			reg |= cfg->coalesc << XILINX_DMA_COALESCE_SHIFT;
 
+		if (cfg->coalesc <= XILINX_DMA_COALESCE_MAX)
 			chan->config.coalesc = cfg->coalesc;
-		}
 
-		if (cfg->delay <= XILINX_DMA_DELAY_MAX) {
-			reg &= ~XILINX_DMA_XR_DELAY_MASK;
-			reg |= cfg->delay << XILINX_DMA_DELAY_SHIFT;
+		if (cfg->delay <= XILINX_DMA_DELAY_MAX)
 			chan->config.delay = cfg->delay;
-		}
 
-		DMA_OUT(&chan->regs->cr, reg);
+		dma_set_coalesce(chan);
 
 		return 0;
 	} else
@@ -979,6 +1285,10 @@ static int xilinx_dma_chan_probe(struct xilinx_dma_device *xdev,
 	chan->feature = feature;
 	chan->max_len = XILINX_DMA_MAX_TRANS_LEN;
 
+	/* hardware reset defaults: interrupt per BD, delay timer off */
+	chan->config.coalesc = 1;
+	chan->config.delay = 0;
+
 	value = of_get_property(node, "xlnx,include-dre", NULL);
 	if (value)
 		chan->has_dre = be32_to_cpup(value);
@@ -1049,6 +1359,7 @@ static int xilinx_dma_chan_probe(struct xilinx_dma_device *xdev,
 	spin_lock_init(&chan->lock);
 	INIT_LIST_HEAD(&chan->pending_list);
 	INIT_LIST_HEAD(&chan->active_list);
+	init_llist_head(&chan->free_descs);
 
 	chan->common.device = &xdev->common;
 
@@ -1097,6 +1408,16 @@ static int xilinx_dma_of_probe(struct platform_device *op)
 	node = op->dev.of_node;
 	xdev->feature = 0;
 
+	/*
+	 * The platform switches "dma-coherent" devices to coherent DMA
+	 * ops before probe, so clients mapping against this device get
+	 * no cache maintenance. Worth a note in the log as transfers
+	 * are silently corrupted if the ACP attachment is missing.
+	 */
+	if (of_get_property(node, "dma-coherent", NULL))
+		dev_info(&op->dev,
+			 "ACP attached, eliding cache maintenance\n");
+
 	/* iomap registers */
 	xdev->regs = of_iomap(node, 0);
 	if (!xdev->regs) {
@@ -1123,7 +1444,9 @@ static int xilinx_dma_of_probe(struct platform_device *op)
 
 		dma_cap_set(DMA_SLAVE, xdev->common.cap_mask);
 		dma_cap_set(DMA_PRIVATE, xdev->common.cap_mask);
+		dma_cap_set(DMA_CYCLIC, xdev->common.cap_mask);
 		xdev->common.device_prep_slave_sg = xilinx_dma_prep_slave_sg;
+		xdev->common.device_prep_dma_cyclic = xilinx_dma_prep_dma_cyclic;
 		xdev->common.device_control = xilinx_dma_device_control;
 		xdev->common.device_issue_pending = xilinx_dma_issue_pending;
 	}
@@ -1172,6 +1495,29 @@ static int xilinx_dma_of_remove(struct platform_device *op)
 	return 0;
 }
 
+/*
+ * Quiesce the engine on reboot/kexec: halt BD fetching on every channel
+ * and mask its interrupts so the PL stops touching memory before the
+ * next kernel takes over without a DDR reset in between.
+ */
+static void xilinx_dma_of_shutdown(struct platform_device *op)
+{
+	struct xilinx_dma_device *xdev = dev_get_drvdata(&op->dev);
+	int i;
+
+	for (i = 0; i < XILINX_DMA_MAX_CHANS_PER_DEVICE; i++) {
+		struct xilinx_dma_chan *chan = xdev->chan[i];
+
+		if (!chan)
+			continue;
+
+		dma_halt(chan);
+		DMA_OUT(&chan->regs->cr, DMA_IN(&chan->regs->cr) &
+			~XILINX_DMA_XR_IRQ_ALL_MASK);
+		tasklet_kill(&chan->tasklet);
+	}
+}
+
 static const struct of_device_id xilinx_dma_of_ids[] = {
 	{ .compatible = "xlnx,axi-dma",},
 	{}
@@ -1185,6 +1531,7 @@ static struct platform_driver xilinx_dma_of_driver = {
 	},
 	.probe = xilinx_dma_of_probe,
 	.remove = xilinx_dma_of_remove,
+	.shutdown = xilinx_dma_of_shutdown,
 };
 
 module_platform_driver(xilinx_dma_of_driver);
@@ -29,6 +29,15 @@
 #include <linux/platform_device.h>
 #include <linux/of_address.h>
 #include <linux/of_irq.h>
+#include <linux/fs.h>
+#include <linux/miscdevice.h>
+#include <linux/mm.h>
+#include <linux/mutex.h>
+#include <linux/poll.h>
+#include <linux/sched.h>
+#include <linux/shrinker.h>
+#include <linux/uaccess.h>
+#include <linux/wait.h>
 #include <linux/amba/xilinx_dma.h>
 
 
@@ -142,6 +151,11 @@
 /* Device Id in the private structure */
 #define XILINX_VDMA_DEVICE_ID_SHIFT	28
 
+/* Maximum frames in an exported frame ring, limited by the frame
+ * store address registers in direct register mode
+ */
+#define XILINX_VDMA_FRMRING_MAX_FRMS	16
+
 /* IO accessors */
 #define VDMA_OUT(addr, val)	(iowrite32(val, addr))
 #define VDMA_IN(addr)		(ioread32(addr))
@@ -180,6 +194,8 @@ struct vdma_addr_regs {
 	u32 buf_addr[16];	/* 0xC - 0x48 Src addresses */
 };
 
+struct xilinx_vdma_frmring;
+
 /* Per DMA specific operations should be embedded in the channel structure */
 struct xilinx_vdma_chan {
 	struct xvdma_regs __iomem *regs;	/* Control status registers */
@@ -210,6 +226,31 @@ struct xilinx_vdma_chan {
 	void (*start_transfer)(struct xilinx_vdma_chan *chan);
 	struct xilinx_vdma_config config;	/* Device configuration info */
 	u32 flush_fsync;			/* Flush on Fsync */
+	int frame_skip;				/* Park-follow every Nth frame */
+	int skip_count;				/* Frame syncs since last move */
+	struct xilinx_vdma_frmring *frmring;	/* Exported frame ring */
+};
+
+/*
+ * Zero-copy frame ring exported through a misc device by S2MM channels
+ * in direct register mode.  The frames are carved out of one contiguous
+ * coherent allocation so userspace can mmap the whole ring in one go,
+ * and the hardware circulates through the frame stores on its own while
+ * each completion interrupt bumps the sequence counter.
+ */
+struct xilinx_vdma_frmring {
+	struct xilinx_vdma_chan *chan;		/* Owning S2MM channel */
+	struct miscdevice miscdev;		/* /dev/xvdma_frmN */
+	char name[16];				/* Misc device name */
+	struct mutex mutex;			/* Serializes setup/teardown */
+	wait_queue_head_t frm_wait;		/* Woken per completed frame */
+	unsigned long in_use;			/* Single opener flag */
+	void *buf_virt;				/* Ring buffer, NULL if idle */
+	dma_addr_t buf_phys;			/* Ring buffer bus address */
+	u32 frm_size;				/* Page aligned bytes/frame */
+	u32 num_frms;				/* Frames in the ring */
+	u32 seq;				/* Completed frame counter */
+	u32 seen;				/* Last counter read by user */
 };
 
 struct xilinx_vdma_device {
@@ -433,13 +474,32 @@ static void vdma_start(struct xilinx_vdma_chan *chan)
 	return;
 }
 
+/*
+ * Write the park frame reference for this channel.  The register is
+ * shared between the read and write sides, the write reference living
+ * in the upper byte.
+ */
+static void vdma_write_park_frm(struct xilinx_vdma_chan *chan, int frm)
+{
+	char *chan_base;
+
+	if (chan->direction == DMA_MEM_TO_DEV) {
+		chan_base = (char *)chan->regs;
+		VDMA_OUT((chan_base + XILINX_VDMA_PARK_REG_OFFSET), frm);
+	} else {
+		chan_base = ((char *)chan->regs -
+				XILINX_VDMA_RX_CHANNEL_OFFSET);
+		VDMA_OUT((chan_base + XILINX_VDMA_PARK_REG_OFFSET),
+			frm << XILINX_VDMA_WR_REF_SHIFT);
+	}
+}
+
 static void xilinx_vdma_start_transfer(struct xilinx_vdma_chan *chan)
 {
 	unsigned long flags;
 	struct xilinx_vdma_desc_sw *desch, *desct = NULL;
 	struct xilinx_vdma_config *config;
 	u32 reg;
-	u8 *chan_base;
 
 	if (chan->err)
 		return;
@@ -494,18 +554,8 @@ static void xilinx_vdma_start_transfer(struct xilinx_vdma_chan *chan)
 	VDMA_OUT(&chan->regs->cr, reg);
 
 	if (config->park && (config->park_frm >= 0)
-			&& (config->park_frm < chan->num_frms)) {
-		if (config->direction == DMA_MEM_TO_DEV) {
-			chan_base = (char *)chan->regs;
-			VDMA_OUT((chan_base + XILINX_VDMA_PARK_REG_OFFSET),
-					config->park_frm);
-		} else {
-			chan_base = ((char *)chan->regs -
-					XILINX_VDMA_RX_CHANNEL_OFFSET);
-			VDMA_OUT((chan_base + XILINX_VDMA_PARK_REG_OFFSET),
-				config->park_frm << XILINX_VDMA_WR_REF_SHIFT);
-		}
-	}
+			&& (config->park_frm < chan->num_frms))
+		vdma_write_park_frm(chan, config->park_frm);
 
 	/* Start the hardware */
 	vdma_start(chan);
@@ -664,6 +714,39 @@ static irqreturn_t vdma_intr_handler(int irq, void *data)
 	if (stat & XILINX_VDMA_XR_IRQ_IOC_MASK) {
 		update_cookie = 1;
 		to_transfer = 1;
+
+		/*
+		 * Half-rate consumers: a parked channel repeats its park
+		 * frame on every sync, so stepping the park reference
+		 * forward by N frames every N syncs follows the source at
+		 * 1/N rate without any software copies.
+		 */
+		if (chan->frame_skip && chan->config.park) {
+			spin_lock(&chan->lock);
+			if (++chan->skip_count >= chan->frame_skip) {
+				chan->skip_count = 0;
+				chan->config.park_frm =
+					(chan->config.park_frm +
+						chan->frame_skip) %
+							chan->num_frms;
+				vdma_write_park_frm(chan,
+						chan->config.park_frm);
+			}
+			spin_unlock(&chan->lock);
+		}
+
+		/*
+		 * A frame ring runs without descriptors, so no new transfer
+		 * re-enables the interrupts masked above; do it here after
+		 * publishing the completed frame
+		 */
+		if (chan->frmring && chan->frmring->buf_virt) {
+			chan->frmring->seq++;
+			wake_up_interruptible(&chan->frmring->frm_wait);
+			VDMA_OUT(&chan->regs->cr,
+				VDMA_IN(&chan->regs->cr) |
+					XILINX_VDMA_XR_IRQ_ALL_MASK);
+		}
 	}
 
 	if (update_cookie)
@@ -683,6 +766,393 @@ static void dma_do_tasklet(unsigned long data)
 	xilinx_chan_desc_cleanup(chan);
 }
 
+/*
+ * Keep-alive cache for ring buffers.  The buffers come out of CMA and
+ * a fresh dma_alloc_coherent() of several video frames can stall for
+ * hundreds of milliseconds migrating pages out of the region, so a
+ * pipeline restart pays that full cost for a buffer it only just gave
+ * back.  Instead of returning a ring buffer to CMA on teardown, park
+ * it here and hand it straight back to the next setup of the same
+ * size.  One buffer is kept per (device, size) pair, and a shrinker
+ * releases the parked buffers when the system wants the memory back.
+ */
+struct xilinx_vdma_parked_buf {
+	struct list_head node;
+	struct device *dev;
+	void *virt;
+	dma_addr_t phys;
+	size_t size;
+};
+
+static LIST_HEAD(xilinx_vdma_parked_bufs);
+static DEFINE_MUTEX(xilinx_vdma_parked_lock);
+
+static void *xilinx_vdma_buf_get(struct device *dev, size_t size,
+				dma_addr_t *phys)
+{
+	struct xilinx_vdma_parked_buf *buf;
+	void *virt;
+
+	mutex_lock(&xilinx_vdma_parked_lock);
+	list_for_each_entry(buf, &xilinx_vdma_parked_bufs, node) {
+		if (buf->dev == dev && buf->size == size) {
+			list_del(&buf->node);
+			mutex_unlock(&xilinx_vdma_parked_lock);
+			*phys = buf->phys;
+			virt = buf->virt;
+			kfree(buf);
+			return virt;
+		}
+	}
+	mutex_unlock(&xilinx_vdma_parked_lock);
+
+	return dma_alloc_coherent(dev, size, phys, GFP_KERNEL);
+}
+
+static void xilinx_vdma_buf_put(struct device *dev, size_t size,
+				void *virt, dma_addr_t phys)
+{
+	struct xilinx_vdma_parked_buf *buf, *b;
+
+	buf = kmalloc(sizeof(*buf), GFP_KERNEL);
+	if (!buf)
+		goto free;
+
+	buf->dev = dev;
+	buf->virt = virt;
+	buf->phys = phys;
+	buf->size = size;
+
+	mutex_lock(&xilinx_vdma_parked_lock);
+	list_for_each_entry(b, &xilinx_vdma_parked_bufs, node) {
+		if (b->dev == dev && b->size == size) {
+			mutex_unlock(&xilinx_vdma_parked_lock);
+			kfree(buf);
+			goto free;
+		}
+	}
+	list_add(&buf->node, &xilinx_vdma_parked_bufs);
+	mutex_unlock(&xilinx_vdma_parked_lock);
+
+	return;
+
+free:
+	dma_free_coherent(dev, size, virt, phys);
+}
+
+/* Drop parked buffers of a departing device, or all of them if !dev */
+static void xilinx_vdma_buf_drain(struct device *dev)
+{
+	struct xilinx_vdma_parked_buf *buf, *tmp;
+
+	mutex_lock(&xilinx_vdma_parked_lock);
+	list_for_each_entry_safe(buf, tmp, &xilinx_vdma_parked_bufs, node) {
+		if (dev && buf->dev != dev)
+			continue;
+		list_del(&buf->node);
+		dma_free_coherent(buf->dev, buf->size, buf->virt, buf->phys);
+		kfree(buf);
+	}
+	mutex_unlock(&xilinx_vdma_parked_lock);
+}
+
+static int xilinx_vdma_buf_shrink(struct shrinker *shrink,
+				struct shrink_control *sc)
+{
+	struct xilinx_vdma_parked_buf *buf, *tmp;
+	unsigned long nr = sc->nr_to_scan;
+	unsigned long pages = 0;
+
+	/* Releasing to CMA can sleep */
+	if (nr && !(sc->gfp_mask & __GFP_WAIT))
+		return -1;
+
+	if (!mutex_trylock(&xilinx_vdma_parked_lock))
+		return -1;
+
+	list_for_each_entry_safe(buf, tmp, &xilinx_vdma_parked_bufs, node) {
+		if (nr) {
+			list_del(&buf->node);
+			dma_free_coherent(buf->dev, buf->size, buf->virt,
+						buf->phys);
+			nr -= min(nr, (unsigned long)
+					(buf->size >> PAGE_SHIFT));
+			kfree(buf);
+		} else {
+			pages += buf->size >> PAGE_SHIFT;
+		}
+	}
+	mutex_unlock(&xilinx_vdma_parked_lock);
+
+	return pages;
+}
+
+static struct shrinker xilinx_vdma_buf_shrinker = {
+	.shrink = xilinx_vdma_buf_shrink,
+	.seeks = DEFAULT_SEEKS,
+};
+
+/*
+ * Allocate the ring buffer, program the frame stores and start the
+ * channel circulating.  Must be called with the ring mutex held.
+ */
+static int xilinx_vdma_frmring_setup(struct xilinx_vdma_frmring *ring,
+				struct xilinx_vdma_frmring_config *cfg)
+{
+	struct xilinx_vdma_chan *chan = ring->chan;
+	unsigned long flags;
+	size_t size;
+	u32 reg;
+	int i;
+
+	if (ring->buf_virt)
+		return -EBUSY;
+
+	if (!cfg->hsize || cfg->hsize > chan->max_len || !cfg->vsize)
+		return -EINVAL;
+
+	if (!cfg->num_frms || cfg->num_frms > chan->num_frms ||
+			cfg->num_frms > XILINX_VDMA_FRMRING_MAX_FRMS)
+		return -EINVAL;
+
+	/* Frames are page aligned so each can be mapped on its own */
+	ring->frm_size = PAGE_ALIGN(cfg->hsize * cfg->vsize);
+	ring->num_frms = cfg->num_frms;
+	size = (size_t)ring->frm_size * ring->num_frms;
+
+	ring->buf_virt = xilinx_vdma_buf_get(chan->dev, size,
+						&ring->buf_phys);
+	if (!ring->buf_virt) {
+		dev_err(chan->dev, "unable to allocate %d frame stores\n",
+			ring->num_frms);
+		return -ENOMEM;
+	}
+
+	ring->seq = 0;
+	ring->seen = 0;
+
+	spin_lock_irqsave(&chan->lock, flags);
+
+	VDMA_OUT(&chan->addr_regs->hsize, cfg->hsize);
+	VDMA_OUT(&chan->addr_regs->frmdly_stride, cfg->hsize);
+	for (i = 0; i < ring->num_frms; i++)
+		VDMA_OUT(&chan->addr_regs->buf_addr[i],
+			ring->buf_phys + i * ring->frm_size);
+
+	/* Circulate through the frame stores, interrupt per frame */
+	reg = VDMA_IN(&chan->regs->cr);
+	reg |= XILINX_VDMA_CIRC_EN;
+	reg &= ~(XILINX_VDMA_XR_COALESCE_MASK | XILINX_VDMA_XR_DELAY_MASK);
+	reg |= 1 << XILINX_VDMA_COALESCE_SHIFT;
+	reg |= XILINX_VDMA_XR_IRQ_ALL_MASK;
+	VDMA_OUT(&chan->regs->cr, reg);
+
+	vdma_start(chan);
+	if (chan->err) {
+		spin_unlock_irqrestore(&chan->lock, flags);
+		xilinx_vdma_buf_put(chan->dev, size, ring->buf_virt,
+					ring->buf_phys);
+		ring->buf_virt = NULL;
+		return -EIO;
+	}
+
+	/* Writing vsize starts the transfer */
+	VDMA_OUT(&chan->addr_regs->vsize, cfg->vsize);
+
+	spin_unlock_irqrestore(&chan->lock, flags);
+
+	cfg->frm_size = ring->frm_size;
+
+	return 0;
+}
+
+/* Halt the channel and release the ring buffer */
+static void xilinx_vdma_frmring_teardown(struct xilinx_vdma_frmring *ring)
+{
+	struct xilinx_vdma_chan *chan = ring->chan;
+
+	if (!ring->buf_virt)
+		return;
+
+	vdma_halt(chan);
+
+	xilinx_vdma_buf_put(chan->dev,
+			(size_t)ring->frm_size * ring->num_frms,
+			ring->buf_virt, ring->buf_phys);
+	ring->buf_virt = NULL;
+}
+
+static int xilinx_vdma_frmring_open(struct inode *inode, struct file *file)
+{
+	struct xilinx_vdma_frmring *ring = container_of(file->private_data,
+				struct xilinx_vdma_frmring, miscdev);
+
+	/* One consumer owns the ring and its mapping at a time */
+	if (test_and_set_bit(0, &ring->in_use))
+		return -EBUSY;
+
+	file->private_data = ring;
+
+	return 0;
+}
+
+static int xilinx_vdma_frmring_release(struct inode *inode, struct file *file)
+{
+	struct xilinx_vdma_frmring *ring = file->private_data;
+
+	mutex_lock(&ring->mutex);
+	xilinx_vdma_frmring_teardown(ring);
+	mutex_unlock(&ring->mutex);
+
+	clear_bit(0, &ring->in_use);
+
+	return 0;
+}
+
+static long xilinx_vdma_frmring_ioctl(struct file *file, unsigned int cmd,
+				unsigned long arg)
+{
+	struct xilinx_vdma_frmring *ring = file->private_data;
+	struct xilinx_vdma_frmring_config cfg;
+	int err;
+
+	switch (cmd) {
+	case XILINX_VDMA_FRMRING_SETUP:
+		if (copy_from_user(&cfg, (void __user *)arg, sizeof(cfg)))
+			return -EFAULT;
+
+		mutex_lock(&ring->mutex);
+		err = xilinx_vdma_frmring_setup(ring, &cfg);
+		mutex_unlock(&ring->mutex);
+		if (err)
+			return err;
+
+		if (copy_to_user((void __user *)arg, &cfg, sizeof(cfg)))
+			return -EFAULT;
+
+		return 0;
+	default:
+		return -ENOTTY;
+	}
+}
+
+static int xilinx_vdma_frmring_mmap(struct file *file,
+				struct vm_area_struct *vma)
+{
+	struct xilinx_vdma_frmring *ring = file->private_data;
+	size_t size = vma->vm_end - vma->vm_start;
+
+	if (!ring->buf_virt)
+		return -EINVAL;
+
+	if (size > (size_t)ring->frm_size * ring->num_frms)
+		return -EINVAL;
+
+	return dma_mmap_coherent(ring->chan->dev, vma, ring->buf_virt,
+				ring->buf_phys, size);
+}
+
+static unsigned int xilinx_vdma_frmring_poll(struct file *file,
+					poll_table *wait)
+{
+	struct xilinx_vdma_frmring *ring = file->private_data;
+	unsigned int mask = 0;
+
+	poll_wait(file, &ring->frm_wait, wait);
+
+	if (ring->seq != ring->seen)
+		mask |= POLLIN | POLLRDNORM;
+
+	return mask;
+}
+
+/*
+ * Reading returns the sequence number of the newest completed frame;
+ * the frame itself is at ring offset ((seq - 1) % num_frms) * frm_size
+ */
+static ssize_t xilinx_vdma_frmring_read(struct file *file, char __user *buf,
+				size_t count, loff_t *ppos)
+{
+	struct xilinx_vdma_frmring *ring = file->private_data;
+	u32 seq;
+
+	if (count < sizeof(seq))
+		return -EINVAL;
+
+	if (ring->seq == ring->seen) {
+		if (file->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+
+		if (wait_event_interruptible(ring->frm_wait,
+				ring->seq != ring->seen))
+			return -ERESTARTSYS;
+	}
+
+	seq = ring->seq;
+	ring->seen = seq;
+
+	if (copy_to_user(buf, &seq, sizeof(seq)))
+		return -EFAULT;
+
+	return sizeof(seq);
+}
+
+static const struct file_operations xilinx_vdma_frmring_fops = {
+	.owner		= THIS_MODULE,
+	.open		= xilinx_vdma_frmring_open,
+	.release	= xilinx_vdma_frmring_release,
+	.unlocked_ioctl	= xilinx_vdma_frmring_ioctl,
+	.mmap		= xilinx_vdma_frmring_mmap,
+	.poll		= xilinx_vdma_frmring_poll,
+	.read		= xilinx_vdma_frmring_read,
+	.llseek		= no_llseek,
+};
+
+static int xilinx_vdma_frmring_create(struct xilinx_vdma_chan *chan,
+				u32 device_id)
+{
+	struct xilinx_vdma_frmring *ring;
+	int err;
+
+	ring = kzalloc(sizeof(*ring), GFP_KERNEL);
+	if (!ring)
+		return -ENOMEM;
+
+	ring->chan = chan;
+	mutex_init(&ring->mutex);
+	init_waitqueue_head(&ring->frm_wait);
+	snprintf(ring->name, sizeof(ring->name), "xvdma_frm%d", device_id);
+
+	ring->miscdev.minor = MISC_DYNAMIC_MINOR;
+	ring->miscdev.name = ring->name;
+	ring->miscdev.fops = &xilinx_vdma_frmring_fops;
+	ring->miscdev.parent = chan->dev;
+
+	err = misc_register(&ring->miscdev);
+	if (err) {
+		dev_err(chan->dev, "unable to register frame ring device\n");
+		kfree(ring);
+		return err;
+	}
+
+	chan->frmring = ring;
+
+	return 0;
+}
+
+static void xilinx_vdma_frmring_destroy(struct xilinx_vdma_chan *chan)
+{
+	struct xilinx_vdma_frmring *ring = chan->frmring;
+
+	if (!ring)
+		return;
+
+	xilinx_vdma_frmring_teardown(ring);
+	misc_deregister(&ring->miscdev);
+	chan->frmring = NULL;
+	kfree(ring);
+}
+
 /* Append the descriptor list to the pending list */
 static void append_desc_queue(struct xilinx_vdma_chan *chan,
 			struct xilinx_vdma_desc_sw *desc)
@@ -942,12 +1412,52 @@ static int xilinx_vdma_device_control(struct dma_chan *dchan,
 
 		reg = VDMA_IN(&chan->regs->cr);
 
-		/* If vsize is -1, it is park-related operations */
+		/*
+		 * If vsize is -1, it is a live mode switch: park/resume,
+		 * park frame moves, genlock master changes and frame-skip
+		 * setup all take effect without halting the channel, so a
+		 * frame can be frozen for inspection and the pipeline
+		 * resumed without blanking the display.
+		 */
 		if (cfg->vsize == -1) {
-			if (cfg->park)
+			chan->config.park = cfg->park;
+			if (cfg->park) {
+				if (cfg->park_frm >= 0 &&
+				    cfg->park_frm < chan->num_frms) {
+					chan->config.park_frm = cfg->park_frm;
+					vdma_write_park_frm(chan,
+							cfg->park_frm);
+				}
 				reg &= ~XILINX_VDMA_CIRC_EN;
-			else
+			} else {
 				reg |= XILINX_VDMA_CIRC_EN;
+			}
+
+			/*
+			 * gen_lock > 0 switches to the given master,
+			 * gen_lock < 0 drops out of genlock, 0 leaves
+			 * the sync configuration alone.
+			 */
+			if (cfg->gen_lock && chan->genlock) {
+				reg &= ~XILINX_VDMA_MSTR_MASK;
+				if (cfg->gen_lock > 0) {
+					chan->config.gen_lock = 1;
+					chan->config.master = cfg->master;
+					reg |= XILINX_VDMA_SYNC_EN;
+					reg |= cfg->master <<
+						XILINX_VDMA_MSTR_SHIFT;
+				} else {
+					chan->config.gen_lock = 0;
+					reg &= ~XILINX_VDMA_SYNC_EN;
+				}
+			}
+
+			spin_lock_irqsave(&chan->lock, flags);
+			chan->frame_skip = cfg->frame_skip;
+			chan->skip_count = 0;
+			if (chan->frame_skip && chan->config.park_frm < 0)
+				chan->config.park_frm = 0;
+			spin_unlock_irqrestore(&chan->lock, flags);
 
 			VDMA_OUT(&chan->regs->cr, reg);
 			return 0;
@@ -1041,6 +1551,7 @@ static int my_log(int value)
 
 static void xilinx_vdma_chan_remove(struct xilinx_vdma_chan *chan)
 {
+	xilinx_vdma_frmring_destroy(chan);
 	irq_dispose_mapping(chan->irq);
 	list_del(&chan->common.device_node);
 	kfree(chan);
@@ -1176,6 +1687,13 @@ static int xilinx_vdma_chan_probe(struct xilinx_vdma_device *xdev,
 		goto out_free_irq;
 	}
 
+	/*
+	 * S2MM channels in direct register mode export the zero-copy frame
+	 * ring interface; failing to do so is not fatal for the channel
+	 */
+	if (chan->direction == DMA_DEV_TO_MEM && !chan->has_sg)
+		xilinx_vdma_frmring_create(chan, device_id);
+
 	/* Add the channel to DMA device channel list */
 	list_add_tail(&chan->common.device_node, &xdev->common.channels);
 	xdev->common.chancnt++;
@@ -1289,6 +1807,8 @@ static int xilinx_vdma_of_remove(struct platform_device *op)
 			xilinx_vdma_chan_remove(xdev->chan[i]);
 	}
 
+	xilinx_vdma_buf_drain(&op->dev);
+
 	iounmap(xdev->regs);
 	dev_set_drvdata(&op->dev, NULL);
 	kfree(xdev);
@@ -1296,6 +1816,29 @@ static int xilinx_vdma_of_remove(struct platform_device *op)
 	return 0;
 }
 
+/*
+ * Quiesce the engine on reboot/kexec: halt frame fetching on both
+ * channels and mask their interrupts so the PL stops touching memory
+ * before the next kernel takes over without a DDR reset in between.
+ */
+static void xilinx_vdma_of_shutdown(struct platform_device *op)
+{
+	struct xilinx_vdma_device *xdev = dev_get_drvdata(&op->dev);
+	int i;
+
+	for (i = 0; i < XILINX_VDMA_MAX_CHANS_PER_DEVICE; i++) {
+		struct xilinx_vdma_chan *chan = xdev->chan[i];
+
+		if (!chan)
+			continue;
+
+		vdma_halt(chan);
+		VDMA_OUT(&chan->regs->cr, VDMA_IN(&chan->regs->cr) &
+			~XILINX_VDMA_XR_IRQ_ALL_MASK);
+		tasklet_kill(&chan->tasklet);
+	}
+}
+
 static const struct of_device_id xilinx_vdma_of_ids[] = {
 	{ .compatible = "xlnx,axi-vdma",},
 	{}
@@ -1309,9 +1852,30 @@ static struct platform_driver xilinx_vdma_of_driver = {
 	},
 	.probe = xilinx_vdma_of_probe,
 	.remove = xilinx_vdma_of_remove,
+	.shutdown = xilinx_vdma_of_shutdown,
 };
 
-module_platform_driver(xilinx_vdma_of_driver);
+static int __init xilinx_vdma_init(void)
+{
+	int err;
+
+	register_shrinker(&xilinx_vdma_buf_shrinker);
+
+	err = platform_driver_register(&xilinx_vdma_of_driver);
+	if (err)
+		unregister_shrinker(&xilinx_vdma_buf_shrinker);
+
+	return err;
+}
+module_init(xilinx_vdma_init);
+
+static void __exit xilinx_vdma_exit(void)
+{
+	platform_driver_unregister(&xilinx_vdma_of_driver);
+	unregister_shrinker(&xilinx_vdma_buf_shrinker);
+	xilinx_vdma_buf_drain(NULL);
+}
+module_exit(xilinx_vdma_exit);
 
 MODULE_AUTHOR("Xilinx, Inc.");
 MODULE_DESCRIPTION("Xilinx VDMA driver");
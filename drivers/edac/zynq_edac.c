@@ -18,9 +18,13 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <linux/debugfs.h>
 #include <linux/edac.h>
 #include <linux/module.h>
 #include <linux/platform_device.h>
+#include <linux/seq_file.h>
+#include <linux/spinlock.h>
+#include <linux/workqueue.h>
 
 #include "edac_core.h"
 
@@ -35,6 +39,26 @@
 
 #define ZYNQ_EDAC_MESSAGE_SIZE	256
 
+/* Number of DDR banks distinguished in the error histogram */
+#define ZYNQ_EDAC_HIST_BANKS	8
+
+/* Number of individual rows tracked in the error histogram */
+#define ZYNQ_EDAC_HIST_ROWS	32
+
+/*
+ * The DDRC has no ECC interrupt line, so error capture is polling
+ * only. The default edac_mc period (once a second) is too coarse to
+ * resolve the correctable-error bursts that precede module failure,
+ * so the driver runs its own sampling tick when this is non-zero.
+ * Each tick costs a single status register read unless an error is
+ * actually pending. Writable at runtime; 0 falls back to a dormant
+ * once-a-second re-check of the parameter.
+ */
+static unsigned int fast_poll_msec;
+module_param(fast_poll_msec, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(fast_poll_msec,
+		 "High-frequency error sampling period in ms (0 = off)");
+
 /* Zynq DDR memory controller registers that are relevant to ECC */
 #define ZYNQ_DDRC_CONTROL_REG_OFFSET	0x0 /* Control regsieter */
 #define ZYNQ_DDRC_T_ZQ_REG_OFFSET	0xA4 /* ZQ register */
@@ -121,16 +145,44 @@ struct zynq_ecc_status {
 	struct ecc_error_info ueinfo;
 };
 
+/**
+ * struct zynq_edac_row_stat - Per-row correctable error counter
+ * @row:	Row number
+ * @bank:	Bank number
+ * @count:	Correctable errors seen on this row
+ */
+struct zynq_edac_row_stat {
+	u32 row;
+	u32 bank;
+	u32 count;
+};
+
 /**
  * struct zynq_edac_priv - Zynq DDR memory controller private instance data
  * @baseaddr:		Base address of the DDR controller
+ * @mci:		Back pointer to the controller instance
+ * @lock:		Serializes error capture between the edac_mc poll
+ *			thread and the fast sampling tick
  * @ce_count:		Correctable Error count
  * @ue_count:		Uncorrectable Error count
+ * @ce_bank_count:	Correctable errors per bank
+ * @rows:		Most frequently hit rows; when full, the coldest
+ *			entry is evicted for a newly seen row
+ * @nr_rows:		Number of valid entries in @rows
+ * @fast_work:		High-frequency sampling tick
+ * @debugfs:		Instance debugfs directory
  */
 struct zynq_edac_priv {
 	void __iomem *baseaddr;
+	struct mem_ctl_info *mci;
+	spinlock_t lock;
 	u32 ce_count;
 	u32 ue_count;
+	u32 ce_bank_count[ZYNQ_EDAC_HIST_BANKS];
+	struct zynq_edac_row_stat rows[ZYNQ_EDAC_HIST_ROWS];
+	unsigned int nr_rows;
+	struct delayed_work fast_work;
+	struct dentry *debugfs;
 };
 
 /**
@@ -265,24 +317,76 @@ static void zynq_edac_handle_error(struct mem_ctl_info *mci,
 				     &message[0], "");
 }
 
+/**
+ * zynq_edac_record_ce - Fold a correctable error into the histogram
+ * @priv:	Pointer to the driver private instance data
+ * @info:	Pointer to the decoded error log information
+ * @count:	Number of errors to account
+ *
+ * Accounts the error per bank and per row. The row table is small and
+ * bounded; when it is full the coldest entry is evicted, so the rows
+ * that misbehave repeatedly - the ones that predict module failure -
+ * are the ones that stay visible. Must be called with priv->lock held.
+ */
+static void zynq_edac_record_ce(struct zynq_edac_priv *priv,
+		struct ecc_error_info *info, u32 count)
+{
+	struct zynq_edac_row_stat *slot;
+	unsigned int i;
+
+	if (info->bank < ZYNQ_EDAC_HIST_BANKS)
+		priv->ce_bank_count[info->bank] += count;
+
+	for (i = 0; i < priv->nr_rows; i++) {
+		if (priv->rows[i].row == info->row &&
+				priv->rows[i].bank == info->bank) {
+			priv->rows[i].count += count;
+			return;
+		}
+	}
+
+	if (priv->nr_rows < ZYNQ_EDAC_HIST_ROWS) {
+		slot = &priv->rows[priv->nr_rows++];
+	} else {
+		slot = &priv->rows[0];
+		for (i = 1; i < ZYNQ_EDAC_HIST_ROWS; i++)
+			if (priv->rows[i].count < slot->count)
+				slot = &priv->rows[i];
+		slot->count = 0;
+	}
+
+	slot->row = info->row;
+	slot->bank = info->bank;
+	slot->count += count;
+}
+
 /**
  * zynq_edac_check - Check controller for ECC errors
  * @mci:	Pointer to the edac memory controller instance
  *
  * This routine is used to check and post ECC errors and is called by
- * the EDAC polling thread
+ * the EDAC polling thread and by the driver's own sampling tick; the
+ * instance lock keeps the read-and-clear of the error logs atomic
+ * between the two.
  */
 static void zynq_edac_check(struct mem_ctl_info *mci)
 {
 	struct zynq_edac_priv *priv = mci->pvt_info;
 	struct zynq_ecc_status errstatus;
+	unsigned long flags;
 	int status;
 
+	spin_lock_irqsave(&priv->lock, flags);
+
 	status = zynq_edac_geterror_info(priv->baseaddr, &errstatus);
 	if (status) {
 		priv->ce_count += errstatus.ce_count;
 		priv->ue_count += errstatus.ue_count;
 
+		if (errstatus.ce_count)
+			zynq_edac_record_ce(priv, &errstatus.ceinfo,
+					errstatus.ce_count);
+
 		if (errstatus.ce_count) {
 			zynq_edac_handle_error(mci, &errstatus);
 			errstatus.ce_count = 0;
@@ -294,8 +398,83 @@ static void zynq_edac_check(struct mem_ctl_info *mci)
 		edac_dbg(3, "total error count ce %d ue %d\n",
 			 priv->ce_count, priv->ue_count);
 	}
+
+	spin_unlock_irqrestore(&priv->lock, flags);
+}
+
+/**
+ * zynq_edac_fast_poll - High-frequency error sampling tick
+ * @work:	Pointer to the embedded delayed work
+ *
+ * Costs one status register read per tick; the full log decode only
+ * runs when an error is actually pending. With fast_poll_msec at zero
+ * the tick stays dormant and merely re-checks the parameter once a
+ * second so it can be enabled at runtime.
+ */
+static void zynq_edac_fast_poll(struct work_struct *work)
+{
+	struct zynq_edac_priv *priv = container_of(to_delayed_work(work),
+			struct zynq_edac_priv, fast_work);
+	unsigned long delay = msecs_to_jiffies(1000);
+	u32 regval;
+
+	if (fast_poll_msec) {
+		regval = readl(priv->baseaddr +
+				ZYNQ_DDRC_ECC_STAT_REG_OFFSET) &
+				(ZYNQ_DDRC_ECC_STATREG_UECOUNT_MASK |
+				ZYNQ_DDRC_ECC_STATREG_CECOUNT_MASK);
+		if (regval)
+			zynq_edac_check(priv->mci);
+		delay = msecs_to_jiffies(fast_poll_msec);
+	}
+
+	schedule_delayed_work(&priv->fast_work, delay);
+}
+
+/**
+ * zynq_edac_hist_show - Emit the error histogram to debugfs
+ * @s:		Pointer to the seq_file
+ * @unused:	Unused iterator
+ *
+ * Returns 0 always.
+ */
+static int zynq_edac_hist_show(struct seq_file *s, void *unused)
+{
+	struct mem_ctl_info *mci = s->private;
+	struct zynq_edac_priv *priv = mci->pvt_info;
+	unsigned long flags;
+	unsigned int i;
+
+	spin_lock_irqsave(&priv->lock, flags);
+
+	seq_printf(s, "CE total: %u\nUE total: %u\n",
+			priv->ce_count, priv->ue_count);
+
+	for (i = 0; i < ZYNQ_EDAC_HIST_BANKS; i++)
+		seq_printf(s, "CE bank %u: %u\n", i, priv->ce_bank_count[i]);
+
+	for (i = 0; i < priv->nr_rows; i++)
+		seq_printf(s, "CE row %u bank %u: %u\n", priv->rows[i].row,
+				priv->rows[i].bank, priv->rows[i].count);
+
+	spin_unlock_irqrestore(&priv->lock, flags);
+
+	return 0;
+}
+
+static int zynq_edac_hist_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, zynq_edac_hist_show, inode->i_private);
 }
 
+static const struct file_operations zynq_edac_hist_fops = {
+	.owner = THIS_MODULE,
+	.open = zynq_edac_hist_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
 /**
  * zynq_edac_get_dtype - Return the controller memory width
  * @base:	Pointer to the ddr memory contoller base address
@@ -549,6 +728,9 @@ static int zynq_edac_mc_probe(struct platform_device *pdev)
 
 	priv = mci->pvt_info;
 	priv->baseaddr = baseaddr;
+	priv->mci = mci;
+	spin_lock_init(&priv->lock);
+	INIT_DELAYED_WORK(&priv->fast_work, zynq_edac_fast_poll);
 	rc = zynq_edac_mc_init(mci, pdev);
 	if (rc) {
 		pr_err("Failed to initialize instance!\n");
@@ -565,6 +747,13 @@ static int zynq_edac_mc_probe(struct platform_device *pdev)
 		goto del_edac_mc;
 	}
 
+	priv->debugfs = debugfs_create_dir(dev_name(&pdev->dev), NULL);
+	if (!IS_ERR_OR_NULL(priv->debugfs))
+		debugfs_create_file("ce_histogram", S_IRUGO, priv->debugfs,
+				mci, &zynq_edac_hist_fops);
+
+	schedule_delayed_work(&priv->fast_work, msecs_to_jiffies(1000));
+
 	devres_close_group(&pdev->dev, NULL);
 
 	return rc;
@@ -592,6 +781,11 @@ iounmap:
 static int zynq_edac_mc_remove(struct platform_device *pdev)
 {
 	struct mem_ctl_info *mci = platform_get_drvdata(pdev);
+	struct zynq_edac_priv *priv = mci->pvt_info;
+
+	cancel_delayed_work_sync(&priv->fast_work);
+	if (!IS_ERR_OR_NULL(priv->debugfs))
+		debugfs_remove_recursive(priv->debugfs);
 
 	edac_mc_del_mc(&pdev->dev);
 	edac_mc_free(mci);
@@ -15,20 +15,40 @@
 #include <linux/bitops.h>
 #include <linux/init.h>
 #include <linux/errno.h>
+#include <linux/fs.h>
+#include <linux/interrupt.h>
+#include <linux/irq.h>
+#include <linux/irqdomain.h>
+#include <linux/ktime.h>
+#include <linux/miscdevice.h>
 #include <linux/module.h>
 #include <linux/of_device.h>
+#include <linux/of_irq.h>
 #include <linux/of_platform.h>
 #include <linux/of_gpio.h>
 #include <linux/io.h>
 #include <linux/gpio.h>
+#include <linux/poll.h>
+#include <linux/sched.h>
 #include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/wait.h>
+#include <linux/xilinx_gpio.h>
 
 /* Register Offset Definitions */
 #define XGPIO_DATA_OFFSET   (0x0)	/* Data register  */
 #define XGPIO_TRI_OFFSET    (0x4)	/* I/O direction register  */
+#define XGPIO_GIER_OFFSET   (0x11c)	/* Global interrupt enable register  */
+#define XGPIO_IPISR_OFFSET  (0x120)	/* IP interrupt status register  */
+#define XGPIO_IPIER_OFFSET  (0x128)	/* IP interrupt enable register  */
+
+#define XGPIO_GIER_IE		BIT(31)	/* Master enable for the IP irq */
 
 #define XGPIO_CHANNEL_OFFSET	0x8
 
+/* Records kept per channel for the change-event device */
+#define XGPIO_EVENT_RING	256
+
 /* Read/Write access to the GPIO registers */
 #ifdef CONFIG_ARCH_ZYNQ
 # define xgpio_readreg(offset)		readl(offset)
@@ -45,6 +65,19 @@
  * gpio_dir: GPIO direction shadow register
  * offset: GPIO channel offset
  * gpio_lock: Lock used for synchronization
+ * irq: board interrupt line of the IP, 0 if not wired up
+ * domain: per-line interrupt domain
+ * irq_enabled: lines with their per-line interrupt unmasked
+ * rising_edge: lines reporting rising edges
+ * falling_edge: lines reporting falling edges
+ * input_state: input lines as of the last change interrupt
+ * ring: change-event records, oldest dropped on overflow
+ * ring_head: producer index into the event ring
+ * ring_tail: consumer index into the event ring
+ * ev_open: the change-event device is held open
+ * ev_wait: readers blocked on an empty event ring
+ * misc: misc device for the change-event interface
+ * misc_name: name of the misc device, unique per channel
  */
 struct xgpio_instance {
 	struct of_mm_gpio_chip mmchip;
@@ -52,6 +85,19 @@ struct xgpio_instance {
 	u32 gpio_dir;
 	u32 offset;
 	spinlock_t gpio_lock;
+	int irq;
+	struct irq_domain *domain;
+	u32 irq_enabled;
+	u32 rising_edge;
+	u32 falling_edge;
+	u32 input_state;
+	struct xgpio_event ring[XGPIO_EVENT_RING];
+	unsigned int ring_head;
+	unsigned int ring_tail;
+	bool ev_open;
+	wait_queue_head_t ev_wait;
+	struct miscdevice misc;
+	char misc_name[24];
 };
 
 /**
@@ -184,6 +230,344 @@ static void xgpio_save_regs(struct of_mm_gpio_chip *mm_gc)
 							 chip->gpio_dir);
 }
 
+/**
+ * xgpio_to_irq - Translate a GPIO signal to its per-line interrupt
+ * @gc:     Pointer to gpio_chip device structure.
+ * @offset: GPIO signal number.
+ *
+ * This function returns the virtual interrupt of the specified GPIO signal,
+ * creating the mapping on first use, or a negative error value if the IP
+ * has no interrupt line.
+ */
+static int xgpio_to_irq(struct gpio_chip *gc, unsigned int offset)
+{
+	struct of_mm_gpio_chip *mm_gc = to_of_mm_gpio_chip(gc);
+	struct xgpio_instance *chip =
+	    container_of(mm_gc, struct xgpio_instance, mmchip);
+
+	if (!chip->domain)
+		return -ENXIO;
+
+	return irq_create_mapping(chip->domain, offset);
+}
+
+static void xgpio_irq_mask(struct irq_data *d)
+{
+	struct xgpio_instance *chip = irq_data_get_irq_chip_data(d);
+	unsigned long flags;
+
+	spin_lock_irqsave(&chip->gpio_lock, flags);
+	chip->irq_enabled &= ~BIT(d->hwirq);
+	spin_unlock_irqrestore(&chip->gpio_lock, flags);
+}
+
+static void xgpio_irq_unmask(struct irq_data *d)
+{
+	struct xgpio_instance *chip = irq_data_get_irq_chip_data(d);
+	unsigned long flags;
+
+	spin_lock_irqsave(&chip->gpio_lock, flags);
+	chip->irq_enabled |= BIT(d->hwirq);
+	spin_unlock_irqrestore(&chip->gpio_lock, flags);
+}
+
+/**
+ * xgpio_irq_set_type - Set the trigger type of a per-line interrupt
+ * @d:      Per-line irq data
+ * @type:   Requested trigger type
+ *
+ * The IP raises one interrupt per channel whenever any input changes, so
+ * edge selection is done in software by the demux handler. Level triggers
+ * cannot be emulated that way and are rejected.
+ */
+static int xgpio_irq_set_type(struct irq_data *d, unsigned int type)
+{
+	struct xgpio_instance *chip = irq_data_get_irq_chip_data(d);
+	unsigned long flags;
+	u32 mask = BIT(d->hwirq);
+
+	if (!(type & IRQ_TYPE_EDGE_BOTH) || (type & ~IRQ_TYPE_EDGE_BOTH))
+		return -EINVAL;
+
+	spin_lock_irqsave(&chip->gpio_lock, flags);
+	if (type & IRQ_TYPE_EDGE_RISING)
+		chip->rising_edge |= mask;
+	else
+		chip->rising_edge &= ~mask;
+	if (type & IRQ_TYPE_EDGE_FALLING)
+		chip->falling_edge |= mask;
+	else
+		chip->falling_edge &= ~mask;
+	spin_unlock_irqrestore(&chip->gpio_lock, flags);
+
+	return 0;
+}
+
+static struct irq_chip xgpio_irq_chip = {
+	.name		= "xilinx-gpio",
+	.irq_mask	= xgpio_irq_mask,
+	.irq_unmask	= xgpio_irq_unmask,
+	.irq_set_type	= xgpio_irq_set_type,
+};
+
+static int xgpio_irq_domain_map(struct irq_domain *h, unsigned int virq,
+				irq_hw_number_t hwirq)
+{
+	struct xgpio_instance *chip = h->host_data;
+
+	irq_set_chip_data(virq, chip);
+	irq_set_chip_and_handler(virq, &xgpio_irq_chip, handle_simple_irq);
+#ifdef CONFIG_ARM
+	set_irq_flags(virq, IRQF_VALID);
+#else
+	irq_set_noprobe(virq);
+#endif
+
+	return 0;
+}
+
+static struct irq_domain_ops xgpio_irq_domain_ops = {
+	.map	= xgpio_irq_domain_map,
+};
+
+/**
+ * xgpio_ev_push - Append one record to the change-event ring
+ * @chip:      Instance the change was seen on
+ * @timestamp: Time of the change interrupt, in nanoseconds
+ * @state:     Input lines after the change
+ * @changed:   Lines that changed since the last record
+ *
+ * Must be called with gpio_lock held. On overflow the oldest record is
+ * dropped so the newest record always reflects the current line state.
+ */
+static void xgpio_ev_push(struct xgpio_instance *chip, u64 timestamp,
+			  u32 state, u32 changed)
+{
+	struct xgpio_event *ev = &chip->ring[chip->ring_head];
+
+	ev->timestamp = timestamp;
+	ev->values = state;
+	ev->changed = changed;
+	chip->ring_head = (chip->ring_head + 1) % XGPIO_EVENT_RING;
+	if (chip->ring_head == chip->ring_tail)
+		chip->ring_tail = (chip->ring_tail + 1) % XGPIO_EVENT_RING;
+}
+
+/**
+ * xgpio_irqhandler - Demux the channel change interrupt
+ * @irq:    Board interrupt line of the IP
+ * @data:   Pointer to the xgpio_instance of one channel
+ *
+ * The IP signals only "an input of this channel changed", so the handler
+ * diffs the data register against a shadow of the last known state to
+ * recover which lines toggled and in which direction. All edges seen in
+ * one interrupt are logged as a single event record and dispatched to the
+ * per-line interrupts in one pass. Pulses shorter than the interrupt
+ * latency that end on their starting level are invisible to the IP and
+ * cannot be reported.
+ */
+static irqreturn_t xgpio_irqhandler(int irq, void *data)
+{
+	struct xgpio_instance *chip = data;
+	void __iomem *regs = chip->mmchip.regs;
+	u32 chanbit = chip->offset ? BIT(1) : BIT(0);
+	unsigned long pending, flags;
+	u64 timestamp;
+	u32 state, changed;
+	int bit;
+
+	if (!(xgpio_readreg(regs + XGPIO_IPISR_OFFSET) & chanbit))
+		return IRQ_NONE;
+
+	/* Ack before reading so edges arriving while we scan re-trigger */
+	xgpio_writereg(regs + XGPIO_IPISR_OFFSET, chanbit);
+
+	timestamp = ktime_to_ns(ktime_get());
+	state = xgpio_readreg(regs + chip->offset + XGPIO_DATA_OFFSET);
+
+	spin_lock_irqsave(&chip->gpio_lock, flags);
+	changed = (state ^ chip->input_state) & chip->gpio_dir;
+	chip->input_state = state;
+	pending = chip->irq_enabled &
+		  ((changed & state & chip->rising_edge) |
+		   (changed & ~state & chip->falling_edge));
+	if (changed && chip->ev_open)
+		xgpio_ev_push(chip, timestamp, state, changed);
+	spin_unlock_irqrestore(&chip->gpio_lock, flags);
+
+	if (changed && chip->ev_open)
+		wake_up_interruptible(&chip->ev_wait);
+
+	for_each_set_bit(bit, &pending, 32)
+		generic_handle_irq(irq_find_mapping(chip->domain, bit));
+
+	return IRQ_HANDLED;
+}
+
+static int xgpio_ev_dev_open(struct inode *inode, struct file *file)
+{
+	struct xgpio_instance *chip = container_of(file->private_data,
+						   struct xgpio_instance, misc);
+	unsigned long flags;
+
+	spin_lock_irqsave(&chip->gpio_lock, flags);
+	if (chip->ev_open) {
+		spin_unlock_irqrestore(&chip->gpio_lock, flags);
+		return -EBUSY;
+	}
+
+	/* Start with an empty ring and a fresh state snapshot */
+	chip->ring_head = 0;
+	chip->ring_tail = 0;
+	chip->input_state = xgpio_readreg(chip->mmchip.regs + chip->offset +
+					  XGPIO_DATA_OFFSET);
+	chip->ev_open = true;
+	spin_unlock_irqrestore(&chip->gpio_lock, flags);
+
+	file->private_data = chip;
+
+	return nonseekable_open(inode, file);
+}
+
+static int xgpio_ev_dev_release(struct inode *inode, struct file *file)
+{
+	struct xgpio_instance *chip = file->private_data;
+	unsigned long flags;
+
+	spin_lock_irqsave(&chip->gpio_lock, flags);
+	chip->ev_open = false;
+	spin_unlock_irqrestore(&chip->gpio_lock, flags);
+
+	return 0;
+}
+
+static ssize_t xgpio_ev_dev_read(struct file *file, char __user *buf,
+				 size_t count, loff_t *ppos)
+{
+	struct xgpio_instance *chip = file->private_data;
+	struct xgpio_event ev;
+	unsigned long flags;
+	size_t copied = 0;
+	int ret;
+
+	if (count < sizeof(ev))
+		return -EINVAL;
+
+	do {
+		spin_lock_irqsave(&chip->gpio_lock, flags);
+		while (copied + sizeof(ev) <= count &&
+		       chip->ring_tail != chip->ring_head) {
+			ev = chip->ring[chip->ring_tail];
+			chip->ring_tail = (chip->ring_tail + 1) %
+					  XGPIO_EVENT_RING;
+			spin_unlock_irqrestore(&chip->gpio_lock, flags);
+
+			if (copy_to_user(buf + copied, &ev, sizeof(ev)))
+				return -EFAULT;
+			copied += sizeof(ev);
+
+			spin_lock_irqsave(&chip->gpio_lock, flags);
+		}
+		spin_unlock_irqrestore(&chip->gpio_lock, flags);
+
+		if (copied)
+			return copied;
+		if (file->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+
+		ret = wait_event_interruptible(chip->ev_wait,
+					chip->ring_tail != chip->ring_head);
+		if (ret)
+			return ret;
+	} while (1);
+}
+
+static unsigned int xgpio_ev_dev_poll(struct file *file, poll_table *wait)
+{
+	struct xgpio_instance *chip = file->private_data;
+	unsigned int mask = 0;
+	unsigned long flags;
+
+	poll_wait(file, &chip->ev_wait, wait);
+
+	spin_lock_irqsave(&chip->gpio_lock, flags);
+	if (chip->ring_tail != chip->ring_head)
+		mask = POLLIN | POLLRDNORM;
+	spin_unlock_irqrestore(&chip->gpio_lock, flags);
+
+	return mask;
+}
+
+static const struct file_operations xgpio_ev_dev_fops = {
+	.owner		= THIS_MODULE,
+	.open		= xgpio_ev_dev_open,
+	.release	= xgpio_ev_dev_release,
+	.read		= xgpio_ev_dev_read,
+	.poll		= xgpio_ev_dev_poll,
+	.llseek		= no_llseek,
+};
+
+/**
+ * xgpio_irq_setup - Set up the change interrupt of one channel
+ * @np:     pointer to device tree node
+ * @chip:   registered xgpio_instance of the channel
+ *
+ * This function hooks up the change interrupt of the IP, if it is wired
+ * up in the device tree: a per-line interrupt domain for gpio_to_irq()
+ * clients and a misc device streaming timestamped change records. Both
+ * channels of a dual device share the interrupt line, so the handler is
+ * installed shared and each instance only handles its own status bit.
+ * The channel interrupt stays enabled for the lifetime of the device;
+ * the handler is cheap and an idle bank generates no edges. A device
+ * without an interrupt keeps the previous, interrupt-less behaviour.
+ */
+static void xgpio_irq_setup(struct device_node *np,
+			    struct xgpio_instance *chip)
+{
+	void __iomem *regs = chip->mmchip.regs;
+	u32 chanbit = chip->offset ? BIT(1) : BIT(0);
+	int status;
+
+	chip->irq = irq_of_parse_and_map(np, 0);
+	if (!chip->irq)
+		return;
+
+	init_waitqueue_head(&chip->ev_wait);
+
+	chip->domain = irq_domain_add_linear(np, chip->mmchip.gc.ngpio,
+					     &xgpio_irq_domain_ops, chip);
+	if (!chip->domain)
+		return;
+
+	chip->input_state = xgpio_readreg(regs + chip->offset +
+					  XGPIO_DATA_OFFSET);
+
+	status = request_irq(chip->irq, xgpio_irqhandler, IRQF_SHARED,
+			     "xilinx-gpio", chip);
+	if (status) {
+		pr_err("%s: could not request irq %d, status %d\n",
+		       np->full_name, chip->irq, status);
+		irq_domain_remove(chip->domain);
+		chip->domain = NULL;
+		return;
+	}
+
+	xgpio_writereg(regs + XGPIO_IPISR_OFFSET, chanbit);
+	xgpio_writereg(regs + XGPIO_IPIER_OFFSET,
+		       xgpio_readreg(regs + XGPIO_IPIER_OFFSET) | chanbit);
+	xgpio_writereg(regs + XGPIO_GIER_OFFSET, XGPIO_GIER_IE);
+
+	snprintf(chip->misc_name, sizeof(chip->misc_name), "xgpio%d-events",
+		 chip->mmchip.gc.base);
+	chip->misc.minor = MISC_DYNAMIC_MINOR;
+	chip->misc.name = chip->misc_name;
+	chip->misc.fops = &xgpio_ev_dev_fops;
+	status = misc_register(&chip->misc);
+	if (status)
+		pr_warn("%s: no change-event device, status %d\n",
+			np->full_name, status);
+}
+
 /**
  * xgpio_of_probe - Probe method for the GPIO device.
  * @np: pointer to device tree node
@@ -224,6 +608,7 @@ static int xgpio_of_probe(struct device_node *np)
 	chip->mmchip.gc.direction_output = xgpio_dir_out;
 	chip->mmchip.gc.get = xgpio_get;
 	chip->mmchip.gc.set = xgpio_set;
+	chip->mmchip.gc.to_irq = xgpio_to_irq;
 
 	chip->mmchip.save_regs = xgpio_save_regs;
 
@@ -236,6 +621,8 @@ static int xgpio_of_probe(struct device_node *np)
 		return status;
 	}
 
+	xgpio_irq_setup(np, chip);
+
 	pr_info("XGpio: %s: registered, base is %d\n", np->full_name,
 							chip->mmchip.gc.base);
 
@@ -271,6 +658,7 @@ static int xgpio_of_probe(struct device_node *np)
 		chip->mmchip.gc.direction_output = xgpio_dir_out;
 		chip->mmchip.gc.get = xgpio_get;
 		chip->mmchip.gc.set = xgpio_set;
+		chip->mmchip.gc.to_irq = xgpio_to_irq;
 
 		chip->mmchip.save_regs = xgpio_save_regs;
 
@@ -282,6 +670,9 @@ static int xgpio_of_probe(struct device_node *np)
 			np->full_name, status);
 			return status;
 		}
+
+		xgpio_irq_setup(np, chip);
+
 		pr_info("XGpio: %s: dual channel registered, base is %d\n",
 					np->full_name, chip->mmchip.gc.base);
 	}
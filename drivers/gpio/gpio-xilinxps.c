@@ -13,19 +13,26 @@
  * Ave, Cambridge, MA 02139, USA.
  */
 
+#include <linux/capability.h>
 #include <linux/clk.h>
 #include <linux/err.h>
 #include <linux/export.h>
+#include <linux/fs.h>
 #include <linux/gpio.h>
 #include <linux/init.h>
 #include <linux/interrupt.h>
 #include <linux/io.h>
 #include <linux/irq.h>
+#include <linux/miscdevice.h>
+#include <linux/mm.h>
 #include <linux/module.h>
 #include <linux/platform_device.h>
 #include <linux/pm_runtime.h>
 #include <linux/pm_wakeup.h>
 #include <linux/slab.h>
+#include <linux/uaccess.h>
+#include <linux/xilinx_devices.h>
+#include <linux/xilinx_gpiops.h>
 #include <asm/mach/irq.h>
 #include <linux/irqdomain.h>
 
@@ -82,17 +89,25 @@ static unsigned int xgpiops_pin_table[] = {
  * struct xgpiops - gpio device private data structure
  * @chip:	instance of the gpio_chip
  * @base_addr:	base address of the GPIO device
+ * @regs_phys:	physical address of the GPIO registers, for mmap
+ * @misc:	misc device for the banked fast-path interface
  * @gpio_lock:	lock used for synchronization
  */
 struct xgpiops {
 	struct gpio_chip chip;
 	void __iomem *base_addr;
+	resource_size_t regs_phys;
+	struct miscdevice misc;
 	unsigned int irq;
 	unsigned int irq_base;
 	struct clk *clk;
 	spinlock_t gpio_lock;
 };
 
+/* The Zynq PS has a single GPIO controller; the banked fast path
+ * addresses it directly */
+static struct xgpiops *xgpiops_dev;
+
 /**
  * xgpiops_get_bank_pin - Get the bank number and pin number within that bank
  * for a given pin in the GPIO device
@@ -180,6 +195,93 @@ static void xgpiops_set_value(struct gpio_chip *chip, unsigned int pin,
 	spin_unlock_irqrestore(&gpio->gpio_lock, flags);
 }
 
+/**
+ * xgpiops_bank_write - Atomically update a set of pins within one bank
+ * @bank:	bank number within the device
+ * @mask:	pins to touch; all other pins keep their state
+ * @value:	new pin states, only bits within @mask are applied
+ *
+ * This function uses the maskable data registers, which apply a 16-bit
+ * mask and data in a single store, so no lock is taken and no register
+ * is read back. It is therefore safe to call from any context,
+ * including hrtimer callbacks, and updates a whole bank in at most two
+ * stores. Returns 0 on success, negative error otherwise.
+ */
+int xgpiops_bank_write(unsigned int bank, u32 mask, u32 value)
+{
+	struct xgpiops *gpio = xgpiops_dev;
+	u32 lsw_mask = mask & 0xFFFF;
+	u32 msw_mask = mask >> 16;
+
+	if (!gpio)
+		return -ENODEV;
+	if (bank >= XGPIOPS_NR_BANKS)
+		return -EINVAL;
+
+	/* Upper 16 bits of a maskable data register flag the pins to
+	 * leave alone, lower 16 bits carry the data */
+	if (lsw_mask)
+		xgpiops_writereg(((~lsw_mask & 0xFFFF) << 16) |
+				  (value & lsw_mask),
+				  gpio->base_addr +
+				  XGPIOPS_DATA_LSW_OFFSET(bank));
+	if (msw_mask)
+		xgpiops_writereg(((~msw_mask & 0xFFFF) << 16) |
+				  ((value >> 16) & msw_mask),
+				  gpio->base_addr +
+				  XGPIOPS_DATA_MSW_OFFSET(bank));
+
+	return 0;
+}
+EXPORT_SYMBOL_GPL(xgpiops_bank_write);
+
+static long xgpiops_dev_ioctl(struct file *file, unsigned int cmd,
+			      unsigned long arg)
+{
+	struct xgpiops_bank_update upd;
+
+	switch (cmd) {
+	case XGPIOPS_IOC_BANK_WRITE:
+		if (copy_from_user(&upd, (void __user *)arg, sizeof(upd)))
+			return -EFAULT;
+		return xgpiops_bank_write(upd.bank, upd.mask, upd.value);
+	default:
+		return -ENOTTY;
+	}
+}
+
+/*
+ * Map the controller register page so userspace can hit the maskable
+ * data registers with plain stores, one atomic 16-pin update each,
+ * with no system call in the loop. The page also holds the direction
+ * and interrupt registers, hence the CAP_SYS_RAWIO check.
+ */
+static int xgpiops_dev_mmap(struct file *file, struct vm_area_struct *vma)
+{
+	struct xgpiops *gpio = container_of(file->private_data,
+					    struct xgpiops, misc);
+
+	if (!capable(CAP_SYS_RAWIO))
+		return -EPERM;
+
+	if (vma->vm_pgoff != 0 ||
+	    (vma->vm_end - vma->vm_start) != PAGE_SIZE)
+		return -EINVAL;
+
+	vma->vm_page_prot = pgprot_noncached(vma->vm_page_prot);
+
+	return remap_pfn_range(vma, vma->vm_start,
+			       gpio->regs_phys >> PAGE_SHIFT,
+			       PAGE_SIZE, vma->vm_page_prot);
+}
+
+static const struct file_operations xgpiops_dev_fops = {
+	.owner		= THIS_MODULE,
+	.unlocked_ioctl	= xgpiops_dev_ioctl,
+	.mmap		= xgpiops_dev_mmap,
+	.llseek		= no_llseek,
+};
+
 /**
  * xgpiops_dir_in - Set the direction of the specified GPIO pin as input
  * @chip:	gpio_chip instance to be worked on
@@ -575,6 +677,7 @@ static int xgpiops_probe(struct platform_device *pdev)
 		goto err_free_gpio;
 	}
 
+	gpio->regs_phys = mem_res->start;
 	gpio->base_addr = ioremap(mem_res->start, remap_size);
 	if (gpio->base_addr == NULL) {
 		dev_err(&pdev->dev, "Couldn't ioremap memory at 0x%08lx\n",
@@ -664,6 +767,18 @@ static int xgpiops_probe(struct platform_device *pdev)
 
 	device_set_wakeup_capable(&pdev->dev, 1);
 
+	/* The banked fast path is optional; the gpiolib interface works
+	 * without it */
+	gpio->misc.minor = MISC_DYNAMIC_MINOR;
+	gpio->misc.name = DRIVER_NAME;
+	gpio->misc.fops = &xgpiops_dev_fops;
+	ret = misc_register(&gpio->misc);
+	if (ret)
+		dev_warn(&pdev->dev,
+			 "could not register banked fast-path device\n");
+	else
+		xgpiops_dev = gpio;
+
 	return 0;
 
 err_clk_put:
@@ -685,6 +800,10 @@ static int xgpiops_remove(struct platform_device *pdev)
 {
 	struct xgpiops *gpio = platform_get_drvdata(pdev);
 
+	if (xgpiops_dev == gpio) {
+		xgpiops_dev = NULL;
+		misc_deregister(&gpio->misc);
+	}
 	clk_disable_unprepare(gpio->clk);
 	clk_put(gpio->clk);
 	device_set_wakeup_capable(&pdev->dev, 0);
@@ -0,0 +1,452 @@
+/*
+ * Xilinx PL display pipeline DRM driver - CRTC
+ *
+ * Copyright (C) 2013 Xilinx, Inc. All rights reserved.
+ *
+ * The scanout engine is an AXI VDMA read channel cycling over a small
+ * ring of frame stores, with the Video Timing Controller (VTC)
+ * generating the sync signals. The frame-store addresses are handed to
+ * the VDMA engine when the transfer is prepared and cannot be rewritten
+ * while it runs, so the CRTC keeps the engine parked on one frame store
+ * and implements page flips by moving the park frame: a flip to a
+ * framebuffer that is already bound to a frame store is a single
+ * register write and takes effect at the next frame boundary, without
+ * tearing. Flipping to a framebuffer the engine has never scanned out
+ * binds it to a frame store first, which needs a full stop/restart of
+ * the channel; that happens once per buffer when a compositor brings up
+ * its flip chain and never again in steady state.
+ *
+ * Vblank events are derived from the VDMA per-frame completion
+ * interrupt (one interrupt per frame scanned out), so there is no
+ * dedicated display IRQ line to own here.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <linux/amba/xilinx_dma.h>
+#include <linux/dmaengine.h>
+#include <linux/platform_device.h>
+
+#include "xilinx_drm_drv.h"
+
+/*
+ * Frame stores bound at a time; matches the depth the VDMA IP is
+ * typically generated with and is enough for a triple-buffered flip
+ * chain.
+ */
+#define XILINX_DRM_NUM_FRMS	3
+
+/* Video Timing Controller, generator register subset */
+#define VTC_CTL			0x000	/* control */
+#define VTC_CTL_GE		(1 << 2)	/* generator enable */
+#define VTC_CTL_RU		(1 << 1)	/* register update */
+#define VTC_CTL_SW		(1 << 0)	/* software enable */
+
+#define VTC_GASIZE		0x060	/* generator active size */
+#define VTC_GPOL		0x06c	/* generator polarities */
+#define VTC_GHSIZE		0x070	/* generator frame hsize */
+#define VTC_GVSIZE		0x074	/* generator frame vsize */
+#define VTC_GHSYNC		0x078	/* generator hsync start/end */
+#define VTC_GVSYNC		0x080	/* generator f0 vsync start/end */
+
+#define VTC_GPOL_FIP		(1 << 0)	/* field id polarity */
+#define VTC_GPOL_VBP		(1 << 1)	/* vblank polarity */
+#define VTC_GPOL_VSP		(1 << 2)	/* vsync polarity */
+#define VTC_GPOL_HBP		(1 << 3)	/* hblank polarity */
+#define VTC_GPOL_HSP		(1 << 4)	/* hsync polarity */
+#define VTC_GPOL_AVP		(1 << 5)	/* active video polarity */
+#define VTC_GPOL_ACP		(1 << 6)	/* active chroma polarity */
+
+struct xilinx_drm_crtc {
+	struct drm_crtc base;
+
+	struct dma_chan *chan;
+	void __iomem *vtc;
+
+	int dpms;
+
+	/* framebuffers bound to VDMA frame stores, in slot order */
+	struct drm_framebuffer *scanout[XILINX_DRM_NUM_FRMS];
+	dma_addr_t paddr[XILINX_DRM_NUM_FRMS];
+	unsigned int nr_frms;
+	unsigned int cur;		/* slot the engine is parked on */
+
+	/* completed on the next frame boundary, under dev->event_lock */
+	struct drm_pending_vblank_event *event;
+};
+#define to_xilinx_crtc(x) container_of(x, struct xilinx_drm_crtc, base)
+
+static void xilinx_drm_crtc_frame_done(void *data)
+{
+	struct xilinx_drm_crtc *xcrtc = data;
+	struct drm_device *dev = xcrtc->base.dev;
+	struct drm_pending_vblank_event *event;
+	unsigned long flags;
+
+	drm_handle_vblank(dev, 0);
+
+	spin_lock_irqsave(&dev->event_lock, flags);
+	event = xcrtc->event;
+	xcrtc->event = NULL;
+	if (event) {
+		drm_send_vblank_event(dev, 0, event);
+		drm_vblank_put(dev, 0);
+	}
+	spin_unlock_irqrestore(&dev->event_lock, flags);
+}
+
+static dma_addr_t xilinx_drm_fb_paddr(struct drm_framebuffer *fb)
+{
+	struct drm_gem_cma_object *gem = drm_fb_cma_get_gem_obj(fb, 0);
+
+	return gem->paddr + fb->offsets[0];
+}
+
+/*
+ * Drop the references pinning framebuffers into frame stores. Only
+ * legal once the engine is halted.
+ */
+static void xilinx_drm_crtc_unbind_all(struct xilinx_drm_crtc *xcrtc)
+{
+	unsigned int i;
+
+	for (i = 0; i < xcrtc->nr_frms; i++) {
+		drm_framebuffer_unreference(xcrtc->scanout[i]);
+		xcrtc->scanout[i] = NULL;
+	}
+	xcrtc->nr_frms = 0;
+	xcrtc->cur = 0;
+}
+
+static int xilinx_drm_crtc_find_slot(struct xilinx_drm_crtc *xcrtc,
+		struct drm_framebuffer *fb)
+{
+	dma_addr_t paddr = xilinx_drm_fb_paddr(fb);
+	unsigned int i;
+
+	for (i = 0; i < xcrtc->nr_frms; i++)
+		if (xcrtc->paddr[i] == paddr)
+			return i;
+	return -1;
+}
+
+/*
+ * Bind @fb to a frame store slot, evicting the oldest binding that is
+ * not being scanned out if the ring is full. The new binding only
+ * reaches the hardware on the next (re)start of the channel.
+ */
+static int xilinx_drm_crtc_bind(struct xilinx_drm_crtc *xcrtc,
+		struct drm_framebuffer *fb)
+{
+	unsigned int slot;
+
+	if (xcrtc->nr_frms < XILINX_DRM_NUM_FRMS) {
+		slot = xcrtc->nr_frms++;
+	} else {
+		slot = (xcrtc->cur + 1) % XILINX_DRM_NUM_FRMS;
+		drm_framebuffer_unreference(xcrtc->scanout[slot]);
+	}
+
+	drm_framebuffer_reference(fb);
+	xcrtc->scanout[slot] = fb;
+	xcrtc->paddr[slot] = xilinx_drm_fb_paddr(fb);
+
+	return slot;
+}
+
+static int xilinx_drm_crtc_dma_start(struct xilinx_drm_crtc *xcrtc)
+{
+	struct drm_crtc *crtc = &xcrtc->base;
+	struct drm_framebuffer *fb = crtc->fb;
+	struct scatterlist sg[XILINX_DRM_NUM_FRMS];
+	struct dma_async_tx_descriptor *desc;
+	struct xilinx_vdma_config config;
+	unsigned int depth, bpp;
+	unsigned int i;
+
+	drm_fb_get_bpp_depth(fb->pixel_format, &depth, &bpp);
+
+	memset(&config, 0, sizeof(config));
+	config.direction = DMA_MEM_TO_DEV;
+	config.vsize = crtc->mode.vdisplay;
+	config.hsize = crtc->mode.hdisplay * bpp / 8;
+	config.stride = fb->pitches[0];
+	config.coalesc = 1;		/* one interrupt per frame, for vblank */
+	config.park = 1;
+	config.park_frm = xcrtc->cur;
+	xcrtc->chan->device->device_control(xcrtc->chan, DMA_SLAVE_CONFIG,
+			(unsigned long)&config);
+
+	sg_init_table(sg, xcrtc->nr_frms);
+	for (i = 0; i < xcrtc->nr_frms; i++) {
+		sg_dma_address(&sg[i]) = xcrtc->paddr[i];
+		sg_dma_len(&sg[i]) = fb->pitches[0] * crtc->mode.vdisplay;
+	}
+
+	desc = dmaengine_prep_slave_sg(xcrtc->chan, sg, xcrtc->nr_frms,
+			DMA_MEM_TO_DEV, DMA_PREP_INTERRUPT);
+	if (!desc) {
+		dev_err(crtc->dev->dev, "failed to prepare scanout descriptor\n");
+		return -ENOMEM;
+	}
+	desc->callback = xilinx_drm_crtc_frame_done;
+	desc->callback_param = xcrtc;
+
+	dmaengine_submit(desc);
+	dma_async_issue_pending(xcrtc->chan);
+
+	return 0;
+}
+
+/* Move the park frame while the engine keeps running: tear-free flip */
+static void xilinx_drm_crtc_park(struct xilinx_drm_crtc *xcrtc,
+		unsigned int slot)
+{
+	struct xilinx_vdma_config config;
+
+	memset(&config, 0, sizeof(config));
+	config.vsize = -1;
+	config.park = 1;
+	config.park_frm = slot;
+	xcrtc->chan->device->device_control(xcrtc->chan, DMA_SLAVE_CONFIG,
+			(unsigned long)&config);
+	xcrtc->cur = slot;
+}
+
+static void xilinx_drm_crtc_dma_stop(struct xilinx_drm_crtc *xcrtc)
+{
+	dmaengine_terminate_all(xcrtc->chan);
+}
+
+static void xilinx_drm_crtc_set_vtc(struct xilinx_drm_crtc *xcrtc,
+		struct drm_display_mode *mode)
+{
+	u32 pol = VTC_GPOL_FIP | VTC_GPOL_VBP | VTC_GPOL_HBP |
+			VTC_GPOL_AVP | VTC_GPOL_ACP;
+
+	if (!(mode->flags & DRM_MODE_FLAG_NHSYNC))
+		pol |= VTC_GPOL_HSP;
+	if (!(mode->flags & DRM_MODE_FLAG_NVSYNC))
+		pol |= VTC_GPOL_VSP;
+
+	writel(mode->htotal, xcrtc->vtc + VTC_GHSIZE);
+	writel(mode->vtotal, xcrtc->vtc + VTC_GVSIZE);
+	writel(mode->hdisplay | (mode->vdisplay << 16),
+			xcrtc->vtc + VTC_GASIZE);
+	writel(mode->hsync_start | (mode->hsync_end << 16),
+			xcrtc->vtc + VTC_GHSYNC);
+	writel(mode->vsync_start | (mode->vsync_end << 16),
+			xcrtc->vtc + VTC_GVSYNC);
+	writel(pol, xcrtc->vtc + VTC_GPOL);
+
+	writel(VTC_CTL_GE | VTC_CTL_RU | VTC_CTL_SW, xcrtc->vtc + VTC_CTL);
+}
+
+static void xilinx_drm_crtc_dpms(struct drm_crtc *crtc, int mode)
+{
+	struct xilinx_drm_crtc *xcrtc = to_xilinx_crtc(crtc);
+	struct drm_device *dev = crtc->dev;
+	struct drm_pending_vblank_event *event;
+	unsigned long flags;
+
+	mode = (mode == DRM_MODE_DPMS_ON) ? DRM_MODE_DPMS_ON :
+			DRM_MODE_DPMS_OFF;
+	if (xcrtc->dpms == mode)
+		return;
+	xcrtc->dpms = mode;
+
+	if (mode == DRM_MODE_DPMS_ON) {
+		xilinx_drm_crtc_set_vtc(xcrtc, &crtc->mode);
+		xilinx_drm_crtc_dma_start(xcrtc);
+	} else {
+		xilinx_drm_crtc_dma_stop(xcrtc);
+		writel(0, xcrtc->vtc + VTC_CTL);
+
+		/* no more frame interrupts; don't strand a flip event */
+		spin_lock_irqsave(&dev->event_lock, flags);
+		event = xcrtc->event;
+		xcrtc->event = NULL;
+		if (event) {
+			drm_send_vblank_event(dev, 0, event);
+			drm_vblank_put(dev, 0);
+		}
+		spin_unlock_irqrestore(&dev->event_lock, flags);
+	}
+}
+
+static bool xilinx_drm_crtc_mode_fixup(struct drm_crtc *crtc,
+		const struct drm_display_mode *mode,
+		struct drm_display_mode *adjusted_mode)
+{
+	return true;
+}
+
+static void xilinx_drm_crtc_prepare(struct drm_crtc *crtc)
+{
+	xilinx_drm_crtc_dpms(crtc, DRM_MODE_DPMS_OFF);
+}
+
+static void xilinx_drm_crtc_commit(struct drm_crtc *crtc)
+{
+	xilinx_drm_crtc_dpms(crtc, DRM_MODE_DPMS_ON);
+}
+
+static int xilinx_drm_crtc_mode_set(struct drm_crtc *crtc,
+		struct drm_display_mode *mode,
+		struct drm_display_mode *adjusted_mode,
+		int x, int y,
+		struct drm_framebuffer *old_fb)
+{
+	struct xilinx_drm_crtc *xcrtc = to_xilinx_crtc(crtc);
+	struct xilinx_drm_private *priv = crtc->dev->dev_private;
+
+	/* geometry changed: all frame store bindings are stale */
+	xilinx_drm_crtc_unbind_all(xcrtc);
+	xcrtc->cur = xilinx_drm_crtc_bind(xcrtc, crtc->fb);
+
+	if (priv->pixel_clk)
+		clk_set_rate(priv->pixel_clk, adjusted_mode->clock * 1000);
+
+	return 0;
+}
+
+static int xilinx_drm_crtc_mode_set_base(struct drm_crtc *crtc, int x, int y,
+		struct drm_framebuffer *old_fb)
+{
+	struct xilinx_drm_crtc *xcrtc = to_xilinx_crtc(crtc);
+	int slot;
+
+	slot = xilinx_drm_crtc_find_slot(xcrtc, crtc->fb);
+
+	if (xcrtc->dpms != DRM_MODE_DPMS_ON) {
+		if (slot < 0)
+			slot = xilinx_drm_crtc_bind(xcrtc, crtc->fb);
+		xcrtc->cur = slot;
+		return 0;
+	}
+
+	if (slot >= 0) {
+		xilinx_drm_crtc_park(xcrtc, slot);
+		return 0;
+	}
+
+	/*
+	 * Never-seen framebuffer: the frame store ring has to be
+	 * rebuilt, which means halting the engine for one restart.
+	 */
+	xilinx_drm_crtc_dma_stop(xcrtc);
+	xcrtc->cur = xilinx_drm_crtc_bind(xcrtc, crtc->fb);
+	return xilinx_drm_crtc_dma_start(xcrtc);
+}
+
+static int xilinx_drm_crtc_page_flip(struct drm_crtc *crtc,
+		struct drm_framebuffer *fb,
+		struct drm_pending_vblank_event *event)
+{
+	struct xilinx_drm_crtc *xcrtc = to_xilinx_crtc(crtc);
+	struct drm_device *dev = crtc->dev;
+	struct drm_framebuffer *old_fb = crtc->fb;
+	unsigned long flags;
+	int ret;
+
+	if (xcrtc->event) {
+		dev_err(dev->dev, "already pending page flip!\n");
+		return -EBUSY;
+	}
+
+	crtc->fb = fb;
+	ret = xilinx_drm_crtc_mode_set_base(crtc, crtc->x, crtc->y, old_fb);
+	if (ret) {
+		crtc->fb = old_fb;
+		return ret;
+	}
+
+	if (event) {
+		if (xcrtc->dpms == DRM_MODE_DPMS_ON) {
+			drm_vblank_get(dev, 0);
+			spin_lock_irqsave(&dev->event_lock, flags);
+			xcrtc->event = event;
+			spin_unlock_irqrestore(&dev->event_lock, flags);
+		} else {
+			/* not scanning out, complete the flip right away */
+			spin_lock_irqsave(&dev->event_lock, flags);
+			drm_send_vblank_event(dev, 0, event);
+			spin_unlock_irqrestore(&dev->event_lock, flags);
+		}
+	}
+
+	return 0;
+}
+
+void xilinx_drm_crtc_cancel_page_flip(struct drm_crtc *crtc,
+		struct drm_file *file)
+{
+	struct xilinx_drm_crtc *xcrtc = to_xilinx_crtc(crtc);
+	struct drm_device *dev = crtc->dev;
+	struct drm_pending_vblank_event *event;
+	unsigned long flags;
+
+	/* destroy the pending vblank event if it belongs to this file */
+	spin_lock_irqsave(&dev->event_lock, flags);
+	event = xcrtc->event;
+	if (event && event->base.file_priv == file) {
+		xcrtc->event = NULL;
+		event->base.destroy(&event->base);
+		drm_vblank_put(dev, 0);
+	}
+	spin_unlock_irqrestore(&dev->event_lock, flags);
+}
+
+static void xilinx_drm_crtc_destroy(struct drm_crtc *crtc)
+{
+	struct xilinx_drm_crtc *xcrtc = to_xilinx_crtc(crtc);
+
+	WARN_ON(xcrtc->dpms == DRM_MODE_DPMS_ON);
+
+	xilinx_drm_crtc_unbind_all(xcrtc);
+	drm_crtc_cleanup(crtc);
+	kfree(xcrtc);
+}
+
+static const struct drm_crtc_funcs xilinx_drm_crtc_funcs = {
+	.destroy	= xilinx_drm_crtc_destroy,
+	.set_config	= drm_crtc_helper_set_config,
+	.page_flip	= xilinx_drm_crtc_page_flip,
+};
+
+static const struct drm_crtc_helper_funcs xilinx_drm_crtc_helper_funcs = {
+	.dpms		= xilinx_drm_crtc_dpms,
+	.mode_fixup	= xilinx_drm_crtc_mode_fixup,
+	.prepare	= xilinx_drm_crtc_prepare,
+	.commit		= xilinx_drm_crtc_commit,
+	.mode_set	= xilinx_drm_crtc_mode_set,
+	.mode_set_base	= xilinx_drm_crtc_mode_set_base,
+};
+
+struct drm_crtc *xilinx_drm_crtc_create(struct drm_device *dev)
+{
+	struct xilinx_drm_private *priv = dev->dev_private;
+	struct xilinx_drm_crtc *xcrtc;
+	int ret;
+
+	xcrtc = kzalloc(sizeof(*xcrtc), GFP_KERNEL);
+	if (!xcrtc)
+		return NULL;
+
+	xcrtc->chan = priv->chan;
+	xcrtc->vtc = priv->vtc;
+	xcrtc->dpms = DRM_MODE_DPMS_OFF;
+
+	ret = drm_crtc_init(dev, &xcrtc->base, &xilinx_drm_crtc_funcs);
+	if (ret < 0) {
+		kfree(xcrtc);
+		return NULL;
+	}
+
+	drm_crtc_helper_add(&xcrtc->base, &xilinx_drm_crtc_helper_funcs);
+
+	return &xcrtc->base;
+}
@@ -0,0 +1,481 @@
+/*
+ * Xilinx PL display pipeline DRM driver
+ *
+ * Copyright (C) 2013 Xilinx, Inc. All rights reserved.
+ *
+ * KMS driver for display pipelines built in the programmable logic
+ * from an AXI VDMA read channel feeding a Video Timing Controller.
+ * Scanout buffers are dumb buffers allocated from CMA, page flips are
+ * synchronized to the VDMA per-frame interrupt (see xilinx_drm_crtc.c),
+ * and the output is a fixed parallel video interface whose modes come
+ * from the display-timings node in the device tree.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <linux/amba/xilinx_dma.h>
+#include <linux/module.h>
+#include <linux/of.h>
+#include <linux/platform_device.h>
+
+#include <video/display_timing.h>
+#include <video/of_display_timing.h>
+#include <video/videomode.h>
+
+#include "xilinx_drm_drv.h"
+
+/*
+ * Encoder/connector: the pipeline ends in a fixed parallel interface
+ * (typically wired to an on-board HDMI transmitter or LCD); there is
+ * nothing to program, so both are stubs around the DT display timings.
+ */
+
+struct xilinx_drm_connector {
+	struct drm_connector base;
+	struct drm_encoder *encoder;
+};
+#define to_xilinx_connector(x) \
+	container_of(x, struct xilinx_drm_connector, base)
+
+static void xilinx_drm_encoder_destroy(struct drm_encoder *encoder)
+{
+	drm_encoder_cleanup(encoder);
+	kfree(encoder);
+}
+
+static void xilinx_drm_encoder_dpms(struct drm_encoder *encoder, int mode)
+{
+}
+
+static bool xilinx_drm_encoder_mode_fixup(struct drm_encoder *encoder,
+		const struct drm_display_mode *mode,
+		struct drm_display_mode *adjusted_mode)
+{
+	return true;
+}
+
+static void xilinx_drm_encoder_prepare(struct drm_encoder *encoder)
+{
+}
+
+static void xilinx_drm_encoder_commit(struct drm_encoder *encoder)
+{
+}
+
+static void xilinx_drm_encoder_mode_set(struct drm_encoder *encoder,
+		struct drm_display_mode *mode,
+		struct drm_display_mode *adjusted_mode)
+{
+}
+
+static const struct drm_encoder_funcs xilinx_drm_encoder_funcs = {
+	.destroy	= xilinx_drm_encoder_destroy,
+};
+
+static const struct drm_encoder_helper_funcs xilinx_drm_encoder_helper_funcs = {
+	.dpms		= xilinx_drm_encoder_dpms,
+	.mode_fixup	= xilinx_drm_encoder_mode_fixup,
+	.prepare	= xilinx_drm_encoder_prepare,
+	.commit		= xilinx_drm_encoder_commit,
+	.mode_set	= xilinx_drm_encoder_mode_set,
+};
+
+static struct drm_encoder *xilinx_drm_encoder_create(struct drm_device *dev)
+{
+	struct xilinx_drm_private *priv = dev->dev_private;
+	struct drm_encoder *encoder;
+	int ret;
+
+	encoder = kzalloc(sizeof(*encoder), GFP_KERNEL);
+	if (!encoder)
+		return NULL;
+
+	encoder->possible_crtcs = 1;
+
+	ret = drm_encoder_init(dev, encoder, &xilinx_drm_encoder_funcs,
+			DRM_MODE_ENCODER_NONE);
+	if (ret < 0) {
+		kfree(encoder);
+		return NULL;
+	}
+
+	drm_encoder_helper_add(encoder, &xilinx_drm_encoder_helper_funcs);
+
+	encoder->crtc = priv->crtc;
+
+	return encoder;
+}
+
+static void xilinx_drm_connector_destroy(struct drm_connector *connector)
+{
+	drm_connector_cleanup(connector);
+	kfree(to_xilinx_connector(connector));
+}
+
+static enum drm_connector_status xilinx_drm_connector_detect(
+		struct drm_connector *connector, bool force)
+{
+	return connector_status_connected;
+}
+
+static int xilinx_drm_connector_get_modes(struct drm_connector *connector)
+{
+	struct drm_device *dev = connector->dev;
+	struct device_node *node = dev->platformdev->dev.of_node;
+	struct display_timings *timings;
+	int i, n = 0;
+
+	timings = of_get_display_timings(node);
+	if (timings) {
+		for (i = 0; i < timings->num_timings; i++) {
+			struct drm_display_mode *mode = drm_mode_create(dev);
+			struct videomode vm;
+
+			if (videomode_from_timing(timings, &vm, i) ||
+			    drm_display_mode_from_videomode(&vm, mode)) {
+				drm_mode_destroy(dev, mode);
+				continue;
+			}
+
+			mode->type = DRM_MODE_TYPE_DRIVER;
+			if (i == timings->native_mode)
+				mode->type |= DRM_MODE_TYPE_PREFERRED;
+			drm_mode_set_name(mode);
+			drm_mode_probed_add(connector, mode);
+			n++;
+		}
+		display_timings_release(timings);
+	}
+
+	if (!n) {
+		/* no timings in DT; assume the common 1080p pipeline */
+		struct drm_display_mode *mode = drm_cvt_mode(dev, 1920, 1080,
+				60, false, false, false);
+
+		mode->type = DRM_MODE_TYPE_DRIVER | DRM_MODE_TYPE_PREFERRED;
+		drm_mode_probed_add(connector, mode);
+		n++;
+	}
+
+	return n;
+}
+
+static int xilinx_drm_connector_mode_valid(struct drm_connector *connector,
+		struct drm_display_mode *mode)
+{
+	return MODE_OK;
+}
+
+static struct drm_encoder *xilinx_drm_connector_best_encoder(
+		struct drm_connector *connector)
+{
+	return to_xilinx_connector(connector)->encoder;
+}
+
+static const struct drm_connector_funcs xilinx_drm_connector_funcs = {
+	.destroy	= xilinx_drm_connector_destroy,
+	.dpms		= drm_helper_connector_dpms,
+	.detect		= xilinx_drm_connector_detect,
+	.fill_modes	= drm_helper_probe_single_connector_modes,
+};
+
+static const struct drm_connector_helper_funcs
+		xilinx_drm_connector_helper_funcs = {
+	.get_modes	= xilinx_drm_connector_get_modes,
+	.mode_valid	= xilinx_drm_connector_mode_valid,
+	.best_encoder	= xilinx_drm_connector_best_encoder,
+};
+
+static struct drm_connector *xilinx_drm_connector_create(
+		struct drm_device *dev, struct drm_encoder *encoder)
+{
+	struct xilinx_drm_connector *xconn;
+	struct drm_connector *connector;
+	int ret;
+
+	xconn = kzalloc(sizeof(*xconn), GFP_KERNEL);
+	if (!xconn)
+		return NULL;
+
+	xconn->encoder = encoder;
+	connector = &xconn->base;
+
+	ret = drm_connector_init(dev, connector, &xilinx_drm_connector_funcs,
+			DRM_MODE_CONNECTOR_Unknown);
+	if (ret < 0) {
+		kfree(xconn);
+		return NULL;
+	}
+
+	drm_connector_helper_add(connector,
+			&xilinx_drm_connector_helper_funcs);
+
+	connector->interlace_allowed = 0;
+	connector->doublescan_allowed = 0;
+
+	ret = drm_mode_connector_attach_encoder(connector, encoder);
+	if (ret < 0) {
+		drm_connector_cleanup(connector);
+		kfree(xconn);
+		return NULL;
+	}
+
+	drm_sysfs_connector_add(connector);
+
+	return connector;
+}
+
+/*
+ * DRM operations:
+ */
+
+static void xilinx_drm_fb_output_poll_changed(struct drm_device *dev)
+{
+	struct xilinx_drm_private *priv = dev->dev_private;
+
+	if (priv->fbdev)
+		drm_fbdev_cma_hotplug_event(priv->fbdev);
+}
+
+static const struct drm_mode_config_funcs mode_config_funcs = {
+	.fb_create		= drm_fb_cma_create,
+	.output_poll_changed	= xilinx_drm_fb_output_poll_changed,
+};
+
+static int modeset_init(struct drm_device *dev)
+{
+	struct xilinx_drm_private *priv = dev->dev_private;
+	struct drm_encoder *encoder;
+
+	drm_mode_config_init(dev);
+
+	priv->crtc = xilinx_drm_crtc_create(dev);
+	if (!priv->crtc)
+		return -ENOMEM;
+
+	encoder = xilinx_drm_encoder_create(dev);
+	if (!encoder)
+		return -ENOMEM;
+
+	if (!xilinx_drm_connector_create(dev, encoder))
+		return -ENOMEM;
+
+	dev->mode_config.min_width = 0;
+	dev->mode_config.min_height = 0;
+	dev->mode_config.max_width = 4096;
+	dev->mode_config.max_height = 4096;
+	dev->mode_config.funcs = &mode_config_funcs;
+
+	return 0;
+}
+
+static bool xilinx_drm_dma_filter(struct dma_chan *chan, void *param)
+{
+	return chan->private && *(u32 *)chan->private == *(u32 *)param;
+}
+
+static int xilinx_drm_unload(struct drm_device *dev)
+{
+	struct xilinx_drm_private *priv = dev->dev_private;
+
+	drm_kms_helper_poll_fini(dev);
+	if (priv->fbdev)
+		drm_fbdev_cma_fini(priv->fbdev);
+	drm_mode_config_cleanup(dev);
+	drm_vblank_cleanup(dev);
+
+	if (priv->chan)
+		dma_release_channel(priv->chan);
+	if (priv->pixel_clk)
+		clk_disable_unprepare(priv->pixel_clk);
+
+	dev->dev_private = NULL;
+	kfree(priv);
+
+	return 0;
+}
+
+static int xilinx_drm_load(struct drm_device *dev, unsigned long flags)
+{
+	struct platform_device *pdev = dev->platformdev;
+	struct device_node *node = pdev->dev.of_node;
+	struct xilinx_drm_private *priv;
+	struct resource *res;
+	dma_cap_mask_t mask;
+	u32 device_id = 0;
+	u32 match;
+	int ret;
+
+	priv = kzalloc(sizeof(*priv), GFP_KERNEL);
+	if (!priv)
+		return -ENOMEM;
+
+	dev->dev_private = priv;
+
+	res = platform_get_resource(pdev, IORESOURCE_MEM, 0);
+	priv->vtc = devm_ioremap_resource(&pdev->dev, res);
+	if (IS_ERR(priv->vtc)) {
+		ret = PTR_ERR(priv->vtc);
+		goto fail;
+	}
+
+	/* the scanout engine is the VDMA read channel with our device id */
+	of_property_read_u32(node, "xlnx,device-id", &device_id);
+	match = (DMA_MEM_TO_DEV & 0xFF) | XILINX_DMA_IP_VDMA |
+			(device_id << XILINX_DMA_DEVICE_ID_SHIFT);
+
+	dma_cap_zero(mask);
+	dma_cap_set(DMA_SLAVE, mask);
+	dma_cap_set(DMA_PRIVATE, mask);
+	priv->chan = dma_request_channel(mask, xilinx_drm_dma_filter, &match);
+	if (!priv->chan) {
+		dev_err(dev->dev, "no VDMA read channel for device id %d\n",
+				device_id);
+		ret = -EPROBE_DEFER;
+		goto fail;
+	}
+
+	/* the pixel clock may be fixed in the PL; only use it if given */
+	priv->pixel_clk = devm_clk_get(&pdev->dev, "pixel_clk");
+	if (IS_ERR(priv->pixel_clk))
+		priv->pixel_clk = NULL;
+	else
+		clk_prepare_enable(priv->pixel_clk);
+
+	ret = modeset_init(dev);
+	if (ret < 0) {
+		dev_err(dev->dev, "failed to initialize mode setting\n");
+		goto fail;
+	}
+
+	ret = drm_vblank_init(dev, 1);
+	if (ret < 0) {
+		dev_err(dev->dev, "failed to initialize vblank\n");
+		goto fail;
+	}
+
+	platform_set_drvdata(pdev, dev);
+
+	priv->fbdev = drm_fbdev_cma_init(dev, 32,
+			dev->mode_config.num_crtc,
+			dev->mode_config.num_connector);
+
+	drm_kms_helper_poll_init(dev);
+
+	return 0;
+
+fail:
+	xilinx_drm_unload(dev);
+	return ret;
+}
+
+static void xilinx_drm_preclose(struct drm_device *dev, struct drm_file *file)
+{
+	struct xilinx_drm_private *priv = dev->dev_private;
+
+	xilinx_drm_crtc_cancel_page_flip(priv->crtc, file);
+}
+
+static void xilinx_drm_lastclose(struct drm_device *dev)
+{
+	struct xilinx_drm_private *priv = dev->dev_private;
+
+	drm_fbdev_cma_restore_mode(priv->fbdev);
+}
+
+/*
+ * The VDMA frame interrupt is the vblank source and has to stay on
+ * while the engine scans out (the CRTC completes flips from it), so
+ * there is nothing to gate here.
+ */
+static int xilinx_drm_enable_vblank(struct drm_device *dev, int crtc)
+{
+	return 0;
+}
+
+static void xilinx_drm_disable_vblank(struct drm_device *dev, int crtc)
+{
+}
+
+static const struct file_operations fops = {
+	.owner              = THIS_MODULE,
+	.open               = drm_open,
+	.release            = drm_release,
+	.unlocked_ioctl     = drm_ioctl,
+#ifdef CONFIG_COMPAT
+	.compat_ioctl       = drm_compat_ioctl,
+#endif
+	.poll               = drm_poll,
+	.read               = drm_read,
+	.fasync             = drm_fasync,
+	.llseek             = no_llseek,
+	.mmap               = drm_gem_cma_mmap,
+};
+
+static struct drm_driver xilinx_drm_driver = {
+	.driver_features    = DRIVER_GEM | DRIVER_MODESET,
+	.load               = xilinx_drm_load,
+	.unload             = xilinx_drm_unload,
+	.preclose           = xilinx_drm_preclose,
+	.lastclose          = xilinx_drm_lastclose,
+	.get_vblank_counter = drm_vblank_count,
+	.enable_vblank      = xilinx_drm_enable_vblank,
+	.disable_vblank     = xilinx_drm_disable_vblank,
+	.gem_free_object    = drm_gem_cma_free_object,
+	.gem_vm_ops         = &drm_gem_cma_vm_ops,
+	.dumb_create        = drm_gem_cma_dumb_create,
+	.dumb_map_offset    = drm_gem_cma_dumb_map_offset,
+	.dumb_destroy       = drm_gem_cma_dumb_destroy,
+	.fops               = &fops,
+	.name               = "xilinx-drm",
+	.desc               = "Xilinx PL display DRM",
+	.date               = "20130722",
+	.major              = 1,
+	.minor              = 0,
+};
+
+/*
+ * Platform driver:
+ */
+
+static int xilinx_drm_pdev_probe(struct platform_device *pdev)
+{
+	if (!pdev->dev.of_node) {
+		dev_err(&pdev->dev, "device-tree data is missing\n");
+		return -ENXIO;
+	}
+
+	return drm_platform_init(&xilinx_drm_driver, pdev);
+}
+
+static int xilinx_drm_pdev_remove(struct platform_device *pdev)
+{
+	drm_platform_exit(&xilinx_drm_driver, pdev);
+
+	return 0;
+}
+
+static struct of_device_id xilinx_drm_of_match[] = {
+	{ .compatible = "xlnx,drm-display-1.00.a", },
+	{ },
+};
+MODULE_DEVICE_TABLE(of, xilinx_drm_of_match);
+
+static struct platform_driver xilinx_drm_platform_driver = {
+	.probe      = xilinx_drm_pdev_probe,
+	.remove     = xilinx_drm_pdev_remove,
+	.driver     = {
+		.owner  = THIS_MODULE,
+		.name   = "xilinx-drm",
+		.of_match_table = xilinx_drm_of_match,
+	},
+};
+
+module_platform_driver(xilinx_drm_platform_driver);
+
+MODULE_AUTHOR("Xilinx, Inc.");
+MODULE_DESCRIPTION("Xilinx PL display pipeline DRM driver");
+MODULE_LICENSE("GPL v2");
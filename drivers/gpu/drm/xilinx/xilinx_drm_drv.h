@@ -0,0 +1,37 @@
+/*
+ * Xilinx PL display pipeline DRM driver
+ *
+ * Copyright (C) 2013 Xilinx, Inc. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#ifndef __XILINX_DRM_DRV_H__
+#define __XILINX_DRM_DRV_H__
+
+#include <linux/clk.h>
+#include <linux/dmaengine.h>
+
+#include <drm/drmP.h>
+#include <drm/drm_crtc.h>
+#include <drm/drm_crtc_helper.h>
+#include <drm/drm_gem_cma_helper.h>
+#include <drm/drm_fb_cma_helper.h>
+
+struct xilinx_drm_private {
+	void __iomem *vtc;		/* video timing controller registers */
+	struct dma_chan *chan;		/* VDMA read (MM2S) channel */
+	struct clk *pixel_clk;		/* optional pixel clock */
+
+	struct drm_fbdev_cma *fbdev;
+	struct drm_crtc *crtc;
+};
+
+struct drm_crtc *xilinx_drm_crtc_create(struct drm_device *dev);
+void xilinx_drm_crtc_cancel_page_flip(struct drm_crtc *crtc,
+		struct drm_file *file);
+
+#endif /* __XILINX_DRM_DRV_H__ */
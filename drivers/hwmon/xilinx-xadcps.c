@@ -20,7 +20,11 @@
 #include <linux/clk.h>
 #include <linux/module.h>
 #include <linux/err.h>
+#include <linux/fs.h>
 #include <linux/kernel.h>
+#include <linux/kfifo.h>
+#include <linux/miscdevice.h>
+#include <linux/poll.h>
 #include <linux/slab.h>
 #include <linux/platform_device.h>
 #include <linux/interrupt.h>
@@ -28,10 +32,17 @@
 #include <linux/kobject.h>
 #include <linux/io.h>
 #include <linux/spinlock.h>
+#include <linux/wait.h>
 
 #include <linux/hwmon.h>
 #include <linux/hwmon-sysfs.h>
 
+#ifdef CONFIG_SENSORS_XADCPS_THERMAL
+#include <linux/workqueue.h>
+#include <linux/thermal.h>
+#include <linux/cpu_cooling.h>
+#endif
+
 /* XADC interface register offsets */
 #define XADC_CONFIG	0x00
 #define XADC_INTSTS	0x04
@@ -58,6 +69,8 @@
 
 #define XADC_INT_CFIFO_LTH		(1 << 9)
 #define XADC_INT_DFIFO_GTH		(1 << 8)
+#define XADC_INT_OT			(1 << 7)
+#define XADC_INT_ALM0			(1 << 0)	/* Temperature alarm */
 
 #define XADC_STATUS_CFIFO_LVL_MSK	0xF
 #define XADC_STATUS_CFIFO_LVL_SHIFT	16
@@ -81,6 +94,7 @@
 #define REG_VCCAUX		0x02
 #define REG_VPVN		0x03
 #define REG_VCCBRAM		0x06
+#define REG_VAUX0		0x10
 
 #define REG_MAX_TEMP		0x20
 #define REG_MAX_VCCINT		0x21
@@ -94,6 +108,9 @@
 #define REG_FLAG		0x3F
 #define REG_CFG1		0x41
 
+#define REG_ALM_TEMP_UPPER	0x50
+#define REG_ALM_TEMP_LOWER	0x54
+
 #define REG_SEQ_SEL0		0x48
 #define REG_SEQ_SEL1		0x49
 #define REG_SEQ_AVG0		0x4A
@@ -141,6 +158,11 @@
 
 #define NOOP (SETFIELD(XADC_FIFO, CMD, XADC_CMD_NOP))
 
+/* Continuous sampling buffer, bytes, must be a power of two */
+#define XADC_SAMPLE_FIFO_SIZE	8192
+/* Wake readers when at least this much data is buffered */
+#define XADC_SAMPLE_WAKEUP	(XADC_SAMPLE_FIFO_SIZE / 2)
+
 struct xadc_op {
 	u32 cmd;
 	u32 res;
@@ -166,9 +188,19 @@ struct xadc_t {
 	spinlock_t slock;
 	struct list_head runq;
 	struct xadc_batch *curr;
+	struct xadc_batch *scan;	/* Self-requeueing sampling batch */
+	int sampling;
+	struct kfifo fifo;		/* Raw u16 samples for the chrdev */
+	wait_queue_head_t wq;
+	struct miscdevice misc;
 	u32 chanmode[17];	/* Channel 0-15 VAUX, 16 is V */
 	#define CHAN_ON		1
 	#define CHAN_BIPOLAR	2
+#ifdef CONFIG_SENSORS_XADCPS_THERMAL
+	struct thermal_zone_device *tz;
+	struct thermal_cooling_device *cool;
+	struct work_struct tz_work;
+#endif
 };
 
 
@@ -277,6 +309,27 @@ static inline unsigned reg2temp(u16 reg)
 	return val;
 }
 
+/* Millidegree variant for the thermal zone; sysfs keeps whole degrees */
+static inline int reg2mtemp(u16 reg)
+{
+	int val;
+
+	val = (reg >> 4) & 0xFFF; /* Use only 12 bits */
+	val = ((val * 503975) / 4096) - 273150;
+	return val;
+}
+
+/* Inverse conversion for the alarm threshold registers, from millidegrees */
+static inline u16 temp2reg(int temp)
+{
+	u32 val;
+
+	val = DIV_ROUND_CLOSEST((u32)(temp + 273150) * 4096, 503975);
+	if (val > 0xFFF)
+		val = 0xFFF;
+	return val << 4;
+}
+
 static inline unsigned reg2vcc(u16 reg)
 {
 	unsigned val;
@@ -486,6 +539,163 @@ static ssize_t xadc_write_vmode(struct device *dev,
 	return count;
 }
 
+/*
+ * Build a scan batch reading every enabled channel once, with a
+ * trailing NOP to flush out the last result, and keep it on the run
+ * queue. The interrupt handler requeues it after every cycle, so the
+ * sequencer output is streamed into the sample fifo continuously
+ * while one-shot sysfs reads still interleave as ordinary batches.
+ */
+static int xadc_sampling_start(struct xadc_t *xadc)
+{
+	struct xadc_batch *b;
+	struct xadc_op *ops;
+	int i, nch = 0;
+
+	for (i = 0; i < ARRAY_SIZE(xadc->chanmode); i++)
+		if (xadc->chanmode[i] & CHAN_ON)
+			nch++;
+	if (!nch)
+		return -EINVAL;
+
+	b = kzalloc(sizeof(*b), GFP_KERNEL);
+	if (!b)
+		return -ENOMEM;
+	ops = kzalloc(sizeof(*ops) * (nch + 1), GFP_KERNEL);
+	if (!ops) {
+		kfree(b);
+		return -ENOMEM;
+	}
+
+	b->count = nch + 1;
+	b->ops = ops;
+	nch = 0;
+	for (i = 0; i < 16; i++)
+		if (xadc->chanmode[i] & CHAN_ON)
+			ops[nch++].cmd = READOP(REG_VAUX0 + i);
+	if (xadc->chanmode[16] & CHAN_ON)
+		ops[nch++].cmd = READOP(REG_VPVN);
+	ops[nch].cmd = NOOP;
+
+	clk_enable(xadc->clk);
+
+	kfifo_reset(&xadc->fifo);
+	xadc->scan = b;
+	xadc->sampling = 1;
+	add_batch(xadc, b);
+
+	return 0;
+}
+
+static void xadc_sampling_stop(struct xadc_t *xadc)
+{
+	/*
+	 * Once the flag is clear the interrupt handler completes the
+	 * scan batch at the end of its current cycle instead of
+	 * requeueing it.
+	 */
+	xadc->sampling = 0;
+	wait_for_completion(&xadc->scan->comp);
+
+	clk_disable(xadc->clk);
+
+	kfree(xadc->scan->ops);
+	kfree(xadc->scan);
+	xadc->scan = NULL;
+
+	/* Release readers blocked on the wakeup threshold */
+	wake_up_interruptible(&xadc->wq);
+}
+
+static ssize_t xadc_read_sampling(struct device *dev,
+		struct device_attribute *devattr, char *buf)
+{
+	struct platform_device *pdev = to_platform_device(dev);
+	struct xadc_t *xadc = platform_get_drvdata(pdev);
+
+	return sprintf(buf, "%d\n", xadc->sampling);
+}
+
+static ssize_t xadc_write_sampling(struct device *dev,
+		struct device_attribute *devattr,
+		const char *buf, size_t count)
+{
+	struct platform_device *pdev = to_platform_device(dev);
+	struct xadc_t *xadc = platform_get_drvdata(pdev);
+	unsigned long val;
+	int ret;
+
+	if (kstrtoul(buf, 0, &val))
+		return -EINVAL;
+
+	if (val) {
+		if (xadc->sampling)
+			return count;
+		ret = xadc_sampling_start(xadc);
+		if (ret)
+			return ret;
+	} else if (xadc->sampling) {
+		xadc_sampling_stop(xadc);
+	}
+
+	return count;
+}
+
+static ssize_t xadc_sample_read(struct file *file, char __user *buf,
+		size_t count, loff_t *ppos)
+{
+	struct xadc_t *xadc = container_of(file->private_data,
+					struct xadc_t, misc);
+	unsigned int copied;
+	int ret;
+
+	if (count < sizeof(u16))
+		return -EINVAL;
+
+	/*
+	 * Block until a fifo's worth of samples has accumulated, so a
+	 * single wakeup hands back hundreds of them, or until sampling
+	 * is stopped and the tail is drained.
+	 */
+	while (kfifo_is_empty(&xadc->fifo)) {
+		if (!xadc->sampling)
+			return 0;
+		if (file->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+		ret = wait_event_interruptible(xadc->wq,
+				kfifo_len(&xadc->fifo) >= XADC_SAMPLE_WAKEUP ||
+				!xadc->sampling);
+		if (ret)
+			return ret;
+	}
+
+	ret = kfifo_to_user(&xadc->fifo, buf, count, &copied);
+	if (ret)
+		return ret;
+
+	return copied;
+}
+
+static unsigned int xadc_sample_poll(struct file *file, poll_table *wait)
+{
+	struct xadc_t *xadc = container_of(file->private_data,
+					struct xadc_t, misc);
+
+	poll_wait(file, &xadc->wq, wait);
+
+	if (kfifo_len(&xadc->fifo) >= XADC_SAMPLE_WAKEUP ||
+			(!xadc->sampling && !kfifo_is_empty(&xadc->fifo)))
+		return POLLIN | POLLRDNORM;
+
+	return 0;
+}
+
+static const struct file_operations xadc_sample_fops = {
+	.owner = THIS_MODULE,
+	.read = xadc_sample_read,
+	.poll = xadc_sample_poll,
+};
+
 static ssize_t show_name(struct device *dev,
 		struct device_attribute *devattr, char *buf)
 {
@@ -527,6 +737,8 @@ static SENSOR_DEVICE_ATTR_2(v, S_IRUGO, xadc_read_v, NULL, 16, REG_VPVN);
  */
 static SENSOR_DEVICE_ATTR_2(v_mode, S_IWUSR|S_IRUGO, xadc_read_vmode,
 		xadc_write_vmode, 16, 0);
+static SENSOR_DEVICE_ATTR(sampling, S_IWUSR|S_IRUGO, xadc_read_sampling,
+		xadc_write_sampling, 0);
 #ifdef DEBUG
 static SENSOR_DEVICE_ATTR(registers, S_IRUGO, xadc_read_registers, NULL, 0);
 #endif
@@ -551,6 +763,7 @@ static struct attribute *xadc_attr[] = {
 	&sensor_dev_attr_vccbram_max.dev_attr.attr,
 	&sensor_dev_attr_v.dev_attr.attr,
 	&sensor_dev_attr_v_mode.dev_attr.attr,
+	&sensor_dev_attr_sampling.dev_attr.attr,
 	NULL
 };
 
@@ -560,6 +773,191 @@ static const struct attribute_group xadc_group = {
 	.attrs = xadc_attr,
 };
 
+#ifdef CONFIG_SENSORS_XADCPS_THERMAL
+/*
+ * Thermal zone on top of the die temperature sensor.
+ *
+ * The passive trip is bound to the CPU frequency cooling device, so
+ * sustained load is throttled gradually well before the die reaches the
+ * point where the hardware over-temperature shutdown would kill the
+ * system. The zone does no time-based polling while the die is cool:
+ * the XADC temperature alarm (ALM0) is programmed to the passive trip
+ * temperature and its interrupt kicks the zone, after which the core's
+ * passive polling takes over until the temperature falls back below the
+ * hysteresis window.
+ */
+#define XADC_TZ_PASSIVE_TEMP	85000	/* millicelsius */
+#define XADC_TZ_PASSIVE_HYST	5000
+#define XADC_TZ_CRITICAL_TEMP	110000
+#define XADC_TZ_PASSIVE_DELAY	250	/* ms between passive updates */
+
+static int xadc_tz_get_temp(struct thermal_zone_device *tz,
+		unsigned long *temp)
+{
+	struct xadc_t *xadc = tz->devdata;
+	u16 regval;
+
+	clk_enable(xadc->clk);
+
+	regval = read_register(xadc, REG_TEMP);
+
+	clk_disable(xadc->clk);
+
+	*temp = reg2mtemp(regval);
+
+	return 0;
+}
+
+static int xadc_tz_get_trip_type(struct thermal_zone_device *tz, int trip,
+		enum thermal_trip_type *type)
+{
+	*type = trip ? THERMAL_TRIP_CRITICAL : THERMAL_TRIP_PASSIVE;
+	return 0;
+}
+
+static int xadc_tz_get_trip_temp(struct thermal_zone_device *tz, int trip,
+		unsigned long *temp)
+{
+	*temp = trip ? XADC_TZ_CRITICAL_TEMP : XADC_TZ_PASSIVE_TEMP;
+	return 0;
+}
+
+static int xadc_tz_get_crit_temp(struct thermal_zone_device *tz,
+		unsigned long *temp)
+{
+	*temp = XADC_TZ_CRITICAL_TEMP;
+	return 0;
+}
+
+static int xadc_tz_bind(struct thermal_zone_device *tz,
+		struct thermal_cooling_device *cdev)
+{
+	struct xadc_t *xadc = tz->devdata;
+
+	if (cdev != xadc->cool)
+		return 0;
+
+	/* Bind the CPU frequency cooling device to the passive trip */
+	return thermal_zone_bind_cooling_device(tz, 0, cdev,
+			THERMAL_NO_LIMIT, THERMAL_NO_LIMIT);
+}
+
+static int xadc_tz_unbind(struct thermal_zone_device *tz,
+		struct thermal_cooling_device *cdev)
+{
+	struct xadc_t *xadc = tz->devdata;
+
+	if (cdev != xadc->cool)
+		return 0;
+
+	return thermal_zone_unbind_cooling_device(tz, 0, cdev);
+}
+
+static const struct thermal_zone_device_ops xadc_tz_ops = {
+	.bind = xadc_tz_bind,
+	.unbind = xadc_tz_unbind,
+	.get_temp = xadc_tz_get_temp,
+	.get_trip_type = xadc_tz_get_trip_type,
+	.get_trip_temp = xadc_tz_get_trip_temp,
+	.get_crit_temp = xadc_tz_get_crit_temp,
+};
+
+/* thermal_zone_device_update() sleeps, so run it from a work */
+static void xadc_tz_update(struct work_struct *work)
+{
+	struct xadc_t *xadc = container_of(work, struct xadc_t, tz_work);
+
+	thermal_zone_device_update(xadc->tz);
+}
+
+static void xadc_tz_kick(struct xadc_t *xadc)
+{
+	if (xadc->tz)
+		schedule_work(&xadc->tz_work);
+}
+
+/* Called from probe with the clock still enabled */
+static void xadc_thermal_init(struct xadc_t *xadc)
+{
+	INIT_WORK(&xadc->tz_work, xadc_tz_update);
+
+	xadc->cool = cpufreq_cooling_register(cpu_present_mask);
+	if (IS_ERR_OR_NULL(xadc->cool)) {
+		dev_warn(xadc->dev, "No cpufreq cooling device\n");
+		xadc->cool = NULL;
+	}
+
+	xadc->tz = thermal_zone_device_register("xadc", 2, 0, xadc,
+			&xadc_tz_ops, NULL, XADC_TZ_PASSIVE_DELAY, 0);
+	if (IS_ERR(xadc->tz)) {
+		dev_warn(xadc->dev, "Failed to register thermal zone\n");
+		xadc->tz = NULL;
+		if (xadc->cool) {
+			cpufreq_cooling_unregister(xadc->cool);
+			xadc->cool = NULL;
+		}
+		return;
+	}
+
+	/* Let the temperature alarm follow the passive trip */
+	write_register(xadc, REG_ALM_TEMP_UPPER,
+			temp2reg(XADC_TZ_PASSIVE_TEMP));
+	write_register(xadc, REG_ALM_TEMP_LOWER,
+			temp2reg(XADC_TZ_PASSIVE_TEMP - XADC_TZ_PASSIVE_HYST));
+
+	/* Unmask the temperature and over-temperature alarms */
+	WRITE(xadc, INTSTS, XADC_INT_ALM0 | XADC_INT_OT);
+	WRITE(xadc, INTMSK, READ(xadc, INTMSK) &
+			~(XADC_INT_ALM0 | XADC_INT_OT));
+}
+
+static void xadc_thermal_remove(struct xadc_t *xadc)
+{
+	if (!xadc->tz)
+		return;
+
+	clk_enable(xadc->clk);
+	WRITE(xadc, INTMSK, READ(xadc, INTMSK) |
+			XADC_INT_ALM0 | XADC_INT_OT);
+	clk_disable(xadc->clk);
+
+	cancel_work_sync(&xadc->tz_work);
+	thermal_zone_device_unregister(xadc->tz);
+	if (xadc->cool)
+		cpufreq_cooling_unregister(xadc->cool);
+}
+#else
+static inline void xadc_tz_kick(struct xadc_t *xadc) {}
+static inline void xadc_thermal_init(struct xadc_t *xadc) {}
+static inline void xadc_thermal_remove(struct xadc_t *xadc) {}
+#endif
+
+/*
+ * Harvest the results of a finished scan cycle into the sample fifo
+ * and queue the batch again. Samples are pushed as raw u16 register
+ * values, enabled channels in ascending order, VPVN last. The fifo is
+ * single producer (this irq) single consumer (chrdev read), so no
+ * locking is needed; new samples are dropped when the reader falls
+ * a whole fifo behind.
+ */
+static void xadc_scan_requeue(struct xadc_t *xadc, struct xadc_batch *b)
+{
+	u16 sample;
+	int i;
+
+	for (i = 1; i < b->count; i++) {
+		sample = GETFIELD(XADC_FIFO, DATA, b->ops[i].res);
+		kfifo_in(&xadc->fifo, &sample, sizeof(sample));
+	}
+
+	if (kfifo_len(&xadc->fifo) >= XADC_SAMPLE_WAKEUP)
+		wake_up_interruptible(&xadc->wq);
+
+	b->writeptr = 0;
+	b->readptr = 0;
+	list_add_tail(&b->q, &xadc->runq);
+}
+
 static irqreturn_t xadc_irq(int irq, void *data)
 {
 	struct xadc_t *xadc = data;
@@ -576,9 +974,14 @@ static irqreturn_t xadc_irq(int irq, void *data)
 			xadc->curr->ops[xadc->curr->readptr++].res =
 				READ(xadc, DFIFO);
 		if ((xadc->curr->readptr) == xadc->curr->count) {
+			struct xadc_batch *b = xadc->curr;
+
 			intmsk |= XADC_INT_DFIFO_GTH;
 			WRITE(xadc, INTMSK, intmsk);
-			complete(&xadc->curr->comp);
+			if (b == xadc->scan && xadc->sampling)
+				xadc_scan_requeue(xadc, b);
+			else
+				complete(&b->comp);
 			run_batch(xadc);
 		} else {
 			u32 config;
@@ -630,6 +1033,11 @@ static irqreturn_t xadc_irq(int irq, void *data)
 		WRITE(xadc, INTSTS, XADC_INT_CFIFO_LTH);
 	}
 
+	if (intsts & ~intmsk & (XADC_INT_ALM0 | XADC_INT_OT)) {
+		xadc_tz_kick(xadc);
+		WRITE(xadc, INTSTS, XADC_INT_ALM0 | XADC_INT_OT);
+	}
+
 	return IRQ_HANDLED;
 }
 
@@ -729,6 +1137,22 @@ static int xadc_probe(struct platform_device *pdev)
 		goto err_group;
 	}
 
+	init_waitqueue_head(&xadc->wq);
+	ret = kfifo_alloc(&xadc->fifo, XADC_SAMPLE_FIFO_SIZE, GFP_KERNEL);
+	if (ret) {
+		dev_err(xadc->dev, "Failed to allocate sample fifo\n");
+		goto err_hwmon;
+	}
+
+	xadc->misc.minor = MISC_DYNAMIC_MINOR;
+	xadc->misc.name = "xadcps";
+	xadc->misc.fops = &xadc_sample_fops;
+	ret = misc_register(&xadc->misc);
+	if (ret) {
+		dev_err(xadc->dev, "Failed to register sample device\n");
+		goto err_fifo;
+	}
+
 	WRITE(xadc, CONFIG, 0);
 	WRITE(xadc, CTL, 0); /* ~RESET */
 
@@ -753,10 +1177,16 @@ static int xadc_probe(struct platform_device *pdev)
 		val & REG_FLAG_DIS ? "no" : "yes",
 		val & REG_FLAG_REF ? "internal" : "external");
 
+	xadc_thermal_init(xadc);
+
 	clk_disable(xadc->clk);
 
 	return 0;
 
+err_fifo:
+	kfifo_free(&xadc->fifo);
+err_hwmon:
+	hwmon_device_unregister(xadc->hwmon);
 err_group:
 	sysfs_remove_group(&pdev->dev.kobj, &xadc_group);
 err_clk_disable:
@@ -778,6 +1208,14 @@ static int xadc_remove(struct platform_device *pdev)
 {
 	struct xadc_t *xadc = platform_get_drvdata(pdev);
 
+	if (xadc->sampling)
+		xadc_sampling_stop(xadc);
+
+	xadc_thermal_remove(xadc);
+
+	misc_deregister(&xadc->misc);
+	kfifo_free(&xadc->fifo);
+
 	hwmon_device_unregister(xadc->hwmon);
 
 	sysfs_remove_group(&pdev->dev.kobj, &xadc_group);
@@ -62,6 +62,7 @@ enum xilinx_i2c_state {
  * @state:	See STATE_
  * @rx_msg:	Current RX message
  * @rx_pos:	Position within current RX message
+ * @rx_burst:	Bytes outstanding in the current dynamic read burst
  */
 struct xiic_i2c {
 	void __iomem		*base;
@@ -74,6 +75,7 @@ struct xiic_i2c {
 	enum xilinx_i2c_state	state;
 	struct i2c_msg		*rx_msg;
 	int			rx_pos;
+	unsigned int		rx_burst;
 };
 
 
@@ -148,6 +150,13 @@ struct xiic_i2c {
 #define XIIC_TX_DYN_START_MASK            0x0100 /* 1 = Set dynamic start */
 #define XIIC_TX_DYN_STOP_MASK             0x0200 /* 1 = Set dynamic stop */
 
+/* Dynamic mode carries the read length in a single byte, so longer reads
+ * are issued as a sequence of length-prefixed bursts with a repeated start
+ * in between; the slave's address auto-increment carries the read on from
+ * where the previous burst stopped.
+ */
+#define XIIC_DYN_READ_MAX                 255
+
 /*
  * The following constants define the register offsets for the Interrupt
  * registers. There are some holes in the memory map for reserved addresses
@@ -280,14 +289,23 @@ static void xiic_read_rx(struct xiic_i2c *i2c)
 
 	if (bytes_in_fifo > xiic_rx_space(i2c))
 		bytes_in_fifo = xiic_rx_space(i2c);
+	if (bytes_in_fifo > i2c->rx_burst)
+		bytes_in_fifo = i2c->rx_burst;
 
 	for (i = 0; i < bytes_in_fifo; i++)
 		i2c->rx_msg->buf[i2c->rx_pos++] =
 			xiic_getreg8(i2c, XIIC_DRR_REG_OFFSET);
 
-	xiic_setreg8(i2c, XIIC_RFD_REG_OFFSET,
-		(xiic_rx_space(i2c) > IIC_RX_FIFO_DEPTH) ?
-		IIC_RX_FIFO_DEPTH - 1 :  xiic_rx_space(i2c) - 1);
+	i2c->rx_burst -= bytes_in_fifo;
+
+	/* Keep the watermark at the full FIFO depth for as long as the
+	 * burst can fill it, so that the FIFO is drained in as few
+	 * interrupts as possible.
+	 */
+	if (i2c->rx_burst)
+		xiic_setreg8(i2c, XIIC_RFD_REG_OFFSET,
+			(i2c->rx_burst > IIC_RX_FIFO_DEPTH) ?
+			IIC_RX_FIFO_DEPTH - 1 : i2c->rx_burst - 1);
 }
 
 static int xiic_tx_fifo_space(struct xiic_i2c *i2c)
@@ -409,6 +427,12 @@ static void xiic_process(struct xiic_i2c *i2c)
 
 				__xiic_start_xfer(i2c);
 			}
+		} else if (!i2c->rx_burst) {
+			/* The current length-prefixed burst is exhausted
+			 * but the message is not; chain the next burst
+			 * with a repeated start
+			 */
+			xiic_dyn_read_burst(i2c);
 		}
 	} else if (pend & XIIC_INTR_BNB_MASK) {
 		/* IIC bus has transitioned to not busy */
@@ -501,13 +525,15 @@ static int xiic_busy(struct xiic_i2c *i2c)
 	return err;
 }
 
-static void xiic_start_recv(struct xiic_i2c *i2c)
+static void xiic_dyn_read_burst(struct xiic_i2c *i2c)
 {
+	struct i2c_msg *msg = i2c->rx_msg;
+	unsigned int burst = msg->len - i2c->rx_pos;
 	u8 rx_watermark;
-	struct i2c_msg *msg = i2c->rx_msg = i2c->tx_msg;
 
-	/* Clear and enable Rx full interrupt. */
-	xiic_irq_clr_en(i2c, XIIC_INTR_RX_FULL_MASK | XIIC_INTR_TX_ERROR_MASK);
+	if (burst > XIIC_DYN_READ_MAX)
+		burst = XIIC_DYN_READ_MAX;
+	i2c->rx_burst = burst;
 
 	/* we want to get all but last byte, because the TX_ERROR IRQ is used
 	 * to inidicate error ACK on the address, and negative ack on the last
@@ -515,24 +541,36 @@ static void xiic_start_recv(struct xiic_i2c *i2c)
 	 * In the case where there is only one byte to receive
 	 * we can check if ERROR and RX full is set at the same time
 	 */
-	rx_watermark = msg->len;
+	rx_watermark = burst;
 	if (rx_watermark > IIC_RX_FIFO_DEPTH)
 		rx_watermark = IIC_RX_FIFO_DEPTH;
 	xiic_setreg8(i2c, XIIC_RFD_REG_OFFSET, rx_watermark - 1);
 
-	if (!(msg->flags & I2C_M_NOSTART))
-		/* write the address */
+	if (i2c->rx_pos || !(msg->flags & I2C_M_NOSTART))
+		/* write the address; on a continuation burst this issues
+		 * a repeated start and the slave resumes at the address
+		 * it auto-incremented to
+		 */
 		xiic_setreg16(i2c, XIIC_DTR_REG_OFFSET,
 			(msg->addr << 1) | XIIC_READ_OPERATION |
 			XIIC_TX_DYN_START_MASK);
 
-	xiic_irq_clr_en(i2c, XIIC_INTR_BNB_MASK);
-
+	/* only the very last burst of the very last message gets a STOP */
 	xiic_setreg16(i2c, XIIC_DTR_REG_OFFSET,
-		msg->len | ((i2c->nmsgs == 1) ? XIIC_TX_DYN_STOP_MASK : 0));
-	if (i2c->nmsgs == 1)
-		/* very last, enable bus not busy as well */
-		xiic_irq_clr_en(i2c, XIIC_INTR_BNB_MASK);
+		burst | ((burst == msg->len - i2c->rx_pos &&
+			i2c->nmsgs == 1) ? XIIC_TX_DYN_STOP_MASK : 0));
+}
+
+static void xiic_start_recv(struct xiic_i2c *i2c)
+{
+	struct i2c_msg *msg = i2c->rx_msg = i2c->tx_msg;
+
+	/* Clear and enable Rx full interrupt. */
+	xiic_irq_clr_en(i2c, XIIC_INTR_RX_FULL_MASK | XIIC_INTR_TX_ERROR_MASK);
+
+	xiic_dyn_read_burst(i2c);
+
+	xiic_irq_clr_en(i2c, XIIC_INTR_BNB_MASK);
 
 	/* the message is tx:ed */
 	i2c->tx_pos = msg->len;
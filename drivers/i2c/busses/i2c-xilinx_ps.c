@@ -116,6 +116,8 @@
  * @p_recv_buf:		Pointer to receive buffer
  * @send_count:		Number of bytes still expected to send
  * @recv_count:		Number of bytes still expected to receive
+ * @msgs_left:		Messages of the current transfer still to run,
+ *			including the one in flight
  * @irq:		IRQ number
  * @cur_timeout:	The current timeout value used by the device
  * @input_clk:		Input clock to I2C controller
@@ -134,6 +136,7 @@ struct xi2cps {
 	unsigned char *p_recv_buf;
 	int send_count;
 	int recv_count;
+	int msgs_left;
 	int irq;
 	int cur_timeout;
 	unsigned int input_clk;
@@ -147,6 +150,8 @@ struct xi2cps {
 		clk_rate_change_nb)
 #define MAX_F_ERR 10000
 
+static void xi2cps_next_msg(struct xi2cps *id);
+
 /**
  * xi2cps_isr - Interrupt handler for the I2C device
  * @irq:	irq number for the I2C device
@@ -162,10 +167,14 @@ static irqreturn_t xi2cps_isr(int irq, void *ptr)
 	unsigned int isr_status, avail_bytes;
 	unsigned int bytes_to_recv, bytes_to_send;
 	unsigned int ctrl_reg = 0;
+	unsigned int send_done;
 	struct xi2cps *id = ptr;
 
 	isr_status = xi2cps_readreg(XI2CPS_ISR_OFFSET);
 
+	/* Update the status for errors */
+	id->err_status = isr_status & 0x000002EC;
+
 	/* Handling Nack interrupt */
 	if (isr_status & 0x00000004)
 		complete(&id->xfer_done);
@@ -234,6 +243,7 @@ static irqreturn_t xi2cps_isr(int irq, void *ptr)
 			 * data to be sent. Calculate the available space
 			 * in FIFO and fill the FIFO with that many bytes.
 			 */
+			send_done = (id->send_count == 0);
 			if (id->send_count > 0) {
 				avail_bytes = XI2CPS_FIFO_DEPTH -
 				xi2cps_readreg(XI2CPS_XFER_SIZE_OFFSET);
@@ -248,12 +258,6 @@ static irqreturn_t xi2cps_isr(int irq, void *ptr)
 						 XI2CPS_DATA_OFFSET);
 					id->send_count--;
 				}
-			} else {
-		/*
-		 * Signal the completion of transaction and clear the hold bus
-		 * bit if there are no further messages to be processed.
-		 */
-				complete(&id->xfer_done);
 			}
 			if (id->send_count == 0) {
 				if (id->bus_hold_flag == 0) {
@@ -268,6 +272,13 @@ static irqreturn_t xi2cps_isr(int irq, void *ptr)
 						XI2CPS_CR_OFFSET);
 				}
 			}
+			/*
+			 * All bytes were out before this interrupt, so the
+			 * message is done; move on to the next one or wake
+			 * the caller.
+			 */
+			if (send_done)
+				xi2cps_next_msg(id);
 		} else {
 			if (id->bus_hold_flag == 0) {
 				/* Clear the hold bus bit */
@@ -291,12 +302,10 @@ static irqreturn_t xi2cps_isr(int irq, void *ptr)
 					xi2cps_readreg(XI2CPS_DATA_OFFSET);
 				id->recv_count--;
 			}
-			complete(&id->xfer_done);
+			xi2cps_next_msg(id);
 		}
 	}
 
-	/* Update the status for errors */
-	id->err_status = isr_status & 0x000002EC;
 	xi2cps_writereg(isr_status, XI2CPS_ISR_OFFSET);
 	return IRQ_HANDLED;
 }
@@ -437,6 +446,65 @@ static void xi2cps_msend(struct xi2cps *id)
 	xi2cps_writereg(XI2CPS_ENABLED_INTR, XI2CPS_IER_OFFSET);
 }
 
+/**
+ * xi2cps_start_msg - Start a single message on the bus
+ * @id:		pointer to the i2c device structure
+ * @msg:	message to be started
+ *
+ * Sets the addressing mode for the message and dispatches it to the
+ * send or receive path. Safe to call from interrupt context, which is
+ * how messages after the first one of a combined transfer are issued.
+ */
+static void xi2cps_start_msg(struct xi2cps *id, struct i2c_msg *msg)
+{
+	id->p_msg = msg;
+
+	/* Check for the TEN Bit mode on each msg */
+	if (msg->flags & I2C_M_TEN) {
+		xi2cps_writereg((xi2cps_readreg(XI2CPS_CR_OFFSET) &
+				(~0x00000004)), XI2CPS_CR_OFFSET);
+	} else {
+		if ((xi2cps_readreg(XI2CPS_CR_OFFSET) & 0x00000004) == 0)
+			xi2cps_writereg(
+				(xi2cps_readreg(XI2CPS_CR_OFFSET) |
+				 (0x00000004)), XI2CPS_CR_OFFSET);
+	}
+
+	/* Check for the R/W flag on each msg */
+	if (msg->flags & I2C_M_RD)
+		xi2cps_mrecv(id);
+	else
+		xi2cps_msend(id);
+}
+
+/**
+ * xi2cps_next_msg - Advance a combined transfer from the ISR
+ * @id:		pointer to the i2c device structure
+ *
+ * Called on a normal transfer complete. While further messages are
+ * queued and no error occurred, the next one is started directly here
+ * under the bus hold, so write-then-read pairs run back to back with a
+ * repeated start and without waking the calling thread in between.
+ * Only the final message, or an error, signals the completion.
+ */
+static void xi2cps_next_msg(struct xi2cps *id)
+{
+	id->msgs_left--;
+	if (id->msgs_left == 0 || id->err_status) {
+		complete(&id->xfer_done);
+		return;
+	}
+
+	/*
+	 * Clear the flag before the last message so the hold bit is
+	 * released when it finishes.
+	 */
+	if (id->msgs_left == 1)
+		id->bus_hold_flag = 0;
+
+	xi2cps_start_msg(id, id->p_msg + 1);
+}
+
 /**
  * xi2cps_master_xfer - The main i2c transfer function
  * @adap:	pointer to the i2c adapter driver instance
@@ -453,7 +521,7 @@ static int xi2cps_master_xfer(struct i2c_adapter *adap, struct i2c_msg *msgs,
 				int num)
 {
 	struct xi2cps *id = adap->algo_data;
-	unsigned int count, retries;
+	unsigned int retries;
 	unsigned long timeout;
 	int ret;
 
@@ -488,63 +556,48 @@ static int xi2cps_master_xfer(struct i2c_adapter *adap, struct i2c_msg *msgs,
 		id->bus_hold_flag = 0;
 	}
 
-	/* Process the msg one by one */
-	for (count = 0; count < num; count++, msgs++) {
-
-		if (count == (num - 1))
-			id->bus_hold_flag = 0;
-		retries = adap->retries;
+	/*
+	 * Hand the whole message chain to the hardware. Only the first
+	 * message is started here; each transfer complete interrupt
+	 * starts the following one directly from the ISR, so combined
+	 * transfers finish with a single wakeup of this thread.
+	 */
+	id->msgs_left = num;
+	id->p_msg = msgs;
+	retries = adap->retries;
 retry:
-		id->err_status = 0;
-		id->p_msg = msgs;
-		init_completion(&id->xfer_done);
-
-		/* Check for the TEN Bit mode on each msg */
-		if (msgs->flags & I2C_M_TEN) {
-			xi2cps_writereg((xi2cps_readreg(XI2CPS_CR_OFFSET) &
-					(~0x00000004)), XI2CPS_CR_OFFSET);
-		} else {
-			if ((xi2cps_readreg(XI2CPS_CR_OFFSET) & 0x00000004)
-								== 0)
-				xi2cps_writereg(
-					(xi2cps_readreg(XI2CPS_CR_OFFSET) |
-					 (0x00000004)), XI2CPS_CR_OFFSET);
-		}
+	id->err_status = 0;
+	init_completion(&id->xfer_done);
 
-		/* Check for the R/W flag on each msg */
-		if (msgs->flags & I2C_M_RD)
-			xi2cps_mrecv(id);
-		else
-			xi2cps_msend(id);
-
-		/* Wait for the signal of completion */
-		ret = wait_for_completion_interruptible_timeout(
-							&id->xfer_done, HZ);
-		if (ret == 0) {
-			dev_err(id->adap.dev.parent,
-				 "timeout waiting on completion\n");
-			return -ETIMEDOUT;
-		}
-		xi2cps_writereg(XI2CPS_IXR_ALL_INTR_MASK, XI2CPS_IDR_OFFSET);
-
-		/* If it is bus arbitration error, try again */
-		if (id->err_status & 0x00000200) {
-			dev_dbg(id->adap.dev.parent,
-				 "Lost ownership on bus, trying again\n");
-			if (retries--) {
-				mdelay(2);
-				goto retry;
-			}
-			dev_err(id->adap.dev.parent,
-					 "Retries completed, exit\n");
-			num = -EREMOTEIO;
-			break;
+	if (id->msgs_left == 1)
+		id->bus_hold_flag = 0;
+
+	xi2cps_start_msg(id, id->p_msg);
+
+	/* Wait for the signal of completion */
+	ret = wait_for_completion_interruptible_timeout(&id->xfer_done,
+							num * HZ);
+	if (ret == 0) {
+		dev_err(id->adap.dev.parent,
+			 "timeout waiting on completion\n");
+		return -ETIMEDOUT;
+	}
+	xi2cps_writereg(XI2CPS_IXR_ALL_INTR_MASK, XI2CPS_IDR_OFFSET);
+
+	/* If it is bus arbitration error, retry from the failed message */
+	if (id->err_status & 0x00000200) {
+		dev_dbg(id->adap.dev.parent,
+			 "Lost ownership on bus, trying again\n");
+		if (retries--) {
+			mdelay(2);
+			goto retry;
 		}
+		dev_err(id->adap.dev.parent,
+				 "Retries completed, exit\n");
+		num = -EREMOTEIO;
+	} else if (id->err_status & 0x000000E4) {
 		/* Report the other error interrupts to application as EIO */
-		if (id->err_status & 0x000000E4) {
-			num = -EIO;
-			break;
-		}
+		num = -EIO;
 	}
 
 	id->p_msg = NULL;
@@ -65,6 +65,7 @@ struct gic_chip_data {
 #endif
 	struct irq_domain *domain;
 	unsigned int gic_irqs;
+	u8 priority[1020];
 #ifdef CONFIG_GIC_NON_BANKED
 	void __iomem *(*get_base)(union gic_base *);
 #endif
@@ -184,6 +185,47 @@ static void gic_eoi_irq(struct irq_data *d)
 	writel_relaxed(gic_irq(d), gic_cpu_base(d) + GIC_CPU_EOI);
 }
 
+/*
+ * Pack the shadow priorities of the four interrupts sharing a
+ * GIC_DIST_PRI register with "irq" (which must be 4-aligned).
+ */
+static u32 gic_priority_word(struct gic_chip_data *gic, unsigned int irq)
+{
+	return gic->priority[irq] |
+	       gic->priority[irq + 1] << 8 |
+	       gic->priority[irq + 2] << 16 |
+	       gic->priority[irq + 3] << 24;
+}
+
+static int gic_set_priority(struct irq_data *d, unsigned int prio)
+{
+	struct gic_chip_data *gic_data = irq_data_get_irq_chip_data(d);
+	unsigned int gicirq = gic_irq(d);
+
+	if (prio > 0xff)
+		return -EINVAL;
+
+	/*
+	 * Note that GIC_DIST_PRI is banked for PPIs and SGIs, so for
+	 * those the write only affects the CPU it executes on.  SPI
+	 * priorities are global.
+	 */
+	raw_spin_lock(&irq_controller_lock);
+	gic_data->priority[gicirq] = prio;
+	writel_relaxed(gic_priority_word(gic_data, gicirq & ~3),
+		       gic_dist_base(d) + GIC_DIST_PRI + (gicirq & ~3));
+	raw_spin_unlock(&irq_controller_lock);
+
+	return 0;
+}
+
+static int gic_get_priority(struct irq_data *d)
+{
+	struct gic_chip_data *gic_data = irq_data_get_irq_chip_data(d);
+
+	return gic_data->priority[gic_irq(d)];
+}
+
 static int gic_set_type(struct irq_data *d, unsigned int type)
 {
 	void __iomem *base = gic_dist_base(d);
@@ -356,6 +398,8 @@ static struct irq_chip gic_chip = {
 	.irq_eoi		= gic_eoi_irq,
 	.irq_set_type		= gic_set_type,
 	.irq_retrigger		= gic_retrigger,
+	.irq_set_priority	= gic_set_priority,
+	.irq_get_priority	= gic_get_priority,
 #ifdef CONFIG_SMP
 	.irq_set_affinity	= gic_set_affinity,
 #endif
@@ -418,7 +462,8 @@ static void __init gic_dist_init(struct gic_chip_data *gic)
 	 * Set priority on all global interrupts.
 	 */
 	for (i = 32; i < gic_irqs; i += 4)
-		writel_relaxed(0xa0a0a0a0, base + GIC_DIST_PRI + i * 4 / 4);
+		writel_relaxed(gic_priority_word(gic, i),
+			       base + GIC_DIST_PRI + i * 4 / 4);
 
 	/*
 	 * Disable all interrupts.  Leave the PPI and SGIs alone
@@ -463,7 +508,8 @@ static void __cpuinit gic_cpu_init(struct gic_chip_data *gic)
 	 * Set priority on PPI and SGI interrupts
 	 */
 	for (i = 0; i < 32; i += 4)
-		writel_relaxed(0xa0a0a0a0, dist_base + GIC_DIST_PRI + i * 4 / 4);
+		writel_relaxed(gic_priority_word(gic, i),
+			       dist_base + GIC_DIST_PRI + i * 4 / 4);
 
 	writel_relaxed(0xf0, base + GIC_CPU_PRIMASK);
 	writel_relaxed(1, base + GIC_CPU_CTRL);
@@ -533,7 +579,7 @@ static void gic_dist_restore(unsigned int gic_nr)
 			dist_base + GIC_DIST_CONFIG + i * 4);
 
 	for (i = 0; i < DIV_ROUND_UP(gic_irqs, 4); i++)
-		writel_relaxed(0xa0a0a0a0,
+		writel_relaxed(gic_priority_word(&gic_data[gic_nr], i * 4),
 			dist_base + GIC_DIST_PRI + i * 4);
 
 	for (i = 0; i < DIV_ROUND_UP(gic_irqs, 4); i++)
@@ -598,7 +644,8 @@ static void gic_cpu_restore(unsigned int gic_nr)
 		writel_relaxed(ptr[i], dist_base + GIC_DIST_CONFIG + i * 4);
 
 	for (i = 0; i < DIV_ROUND_UP(32, 4); i++)
-		writel_relaxed(0xa0a0a0a0, dist_base + GIC_DIST_PRI + i * 4);
+		writel_relaxed(gic_priority_word(&gic_data[gic_nr], i * 4),
+			       dist_base + GIC_DIST_PRI + i * 4);
 
 	writel_relaxed(0xf0, cpu_base + GIC_CPU_PRIMASK);
 	writel_relaxed(1, cpu_base + GIC_CPU_CTRL);
@@ -812,6 +859,31 @@ void __init gic_init_bases(unsigned int gic_nr, int irq_start,
 
 	set_handle_irq(gic_handle_irq);
 
+	/*
+	 * Default all interrupts to the priority the driver has always
+	 * used, then apply any per-interrupt tiers from the device
+	 * tree: "arm,irq-priorities" is a list of <intid priority>
+	 * pairs using GIC interrupt IDs (SPIs start at 32).  Runtime
+	 * changes go through /proc/irq/<n>/priority.
+	 */
+	memset(gic->priority, 0xa0, sizeof(gic->priority));
+	if (node) {
+		struct property *prop;
+		const __be32 *p;
+		u32 intid;
+
+		of_property_for_each_u32(node, "arm,irq-priorities", prop, p,
+					 intid) {
+			u32 prio;
+
+			p = of_prop_next_u32(prop, p, &prio);
+			if (!p)
+				break;
+			if (intid < gic->gic_irqs && prio <= 0xff)
+				gic->priority[intid] = prio;
+		}
+	}
+
 	gic_chip.flags |= gic_arch_extn.flags;
 	gic_dist_init(gic);
 	gic_cpu_init(gic);
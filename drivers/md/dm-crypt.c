@@ -66,6 +66,8 @@ struct dm_crypt_request {
 	struct convert_context *ctx;
 	struct scatterlist sg_in;
 	struct scatterlist sg_out;
+	/* multi-sector scatterlists of a bulk request, NULL otherwise */
+	struct scatterlist *sg_bulk;
 	sector_t iv_sector;
 };
 
@@ -169,6 +171,12 @@ struct crypt_config {
 	 */
 	unsigned int dmreq_start;
 
+	/*
+	 * The cipher driver handles whole-bio requests and derives the
+	 * per-sector IVs itself (CRYPTO_ALG_BULK).
+	 */
+	unsigned int bulk_mode;
+
 	unsigned long flags;
 	unsigned int key_size;
 	unsigned int key_parts;
@@ -692,6 +700,7 @@ static int crypt_convert_block(struct crypt_config *cc,
 
 	dmreq->iv_sector = ctx->cc_sector;
 	dmreq->ctx = ctx;
+	dmreq->sg_bulk = NULL;
 	sg_init_table(&dmreq->sg_in, 1);
 	sg_set_page(&dmreq->sg_in, bv_in->bv_page, 1 << SECTOR_SHIFT,
 		    bv_in->bv_offset + ctx->offset_in);
@@ -750,6 +759,98 @@ static void crypt_alloc_req(struct crypt_config *cc,
 	    kcryptd_async_done, dmreq_of_req(cc, this_cc->req));
 }
 
+/*
+ * Encrypt / decrypt a whole bio with a single request. Only valid when
+ * the cipher driver advertises CRYPTO_ALG_BULK, i.e. re-derives the IV
+ * of every sector after the first one itself.
+ */
+static int crypt_convert_bulk(struct crypt_config *cc,
+			      struct convert_context *ctx)
+{
+	struct crypt_cpu *this_cc = this_crypt_config(cc);
+	struct ablkcipher_request *req;
+	struct dm_crypt_request *dmreq;
+	struct scatterlist *sg_in, *sg_out;
+	unsigned int nents_in, nents_out, bytes = 0;
+	unsigned int i;
+	u8 *iv;
+	int r;
+
+	crypt_alloc_req(cc, ctx);
+	req = this_cc->req;
+	dmreq = dmreq_of_req(cc, req);
+	iv = iv_of_dmreq(cc, dmreq);
+
+	nents_in = ctx->bio_in->bi_vcnt - ctx->idx_in;
+	nents_out = ctx->bio_out->bi_vcnt - ctx->idx_out;
+
+	sg_in = kmalloc((nents_in + nents_out) * sizeof(*sg_in), GFP_NOIO);
+	if (!sg_in)
+		return -ENOMEM;
+	sg_out = sg_in + nents_in;
+
+	sg_init_table(sg_in, nents_in);
+	for (i = 0; i < nents_in; i++) {
+		struct bio_vec *bv = bio_iovec_idx(ctx->bio_in,
+						   ctx->idx_in + i);
+
+		sg_set_page(&sg_in[i], bv->bv_page, bv->bv_len,
+			    bv->bv_offset);
+		bytes += bv->bv_len;
+	}
+
+	sg_init_table(sg_out, nents_out);
+	for (i = 0; i < nents_out; i++) {
+		struct bio_vec *bv = bio_iovec_idx(ctx->bio_out,
+						   ctx->idx_out + i);
+
+		sg_set_page(&sg_out[i], bv->bv_page, bv->bv_len,
+			    bv->bv_offset);
+	}
+
+	dmreq->ctx = ctx;
+	dmreq->iv_sector = ctx->cc_sector;
+	dmreq->sg_bulk = sg_in;
+
+	if (cc->iv_gen_ops) {
+		r = cc->iv_gen_ops->generator(cc, iv, dmreq);
+		if (r < 0) {
+			kfree(sg_in);
+			return r;
+		}
+	}
+
+	ablkcipher_request_set_crypt(req, sg_in, sg_out, bytes, iv);
+
+	atomic_inc(&ctx->cc_pending);
+
+	if (bio_data_dir(ctx->bio_in) == WRITE)
+		r = crypto_ablkcipher_encrypt(req);
+	else
+		r = crypto_ablkcipher_decrypt(req);
+
+	if (r == -EBUSY) {
+		wait_for_completion(&ctx->restart);
+		INIT_COMPLETION(ctx->restart);
+		r = -EINPROGRESS;
+	}
+
+	ctx->idx_in = ctx->bio_in->bi_vcnt;
+	ctx->idx_out = ctx->bio_out->bi_vcnt;
+	ctx->cc_sector += bytes >> SECTOR_SHIFT;
+
+	if (r == -EINPROGRESS) {
+		this_cc->req = NULL;
+		return 0;
+	}
+
+	atomic_dec(&ctx->cc_pending);
+	kfree(sg_in);
+	dmreq->sg_bulk = NULL;
+
+	return r;
+}
+
 /*
  * Encrypt / decrypt data from one bio to another one (can be the same one)
  */
@@ -761,6 +862,9 @@ static int crypt_convert(struct crypt_config *cc,
 
 	atomic_set(&ctx->cc_pending, 1);
 
+	if (cc->bulk_mode)
+		return crypt_convert_bulk(cc, ctx);
+
 	while(ctx->idx_in < ctx->bio_in->bi_vcnt &&
 	      ctx->idx_out < ctx->bio_out->bi_vcnt) {
 
@@ -1181,6 +1285,7 @@ static void kcryptd_async_done(struct crypto_async_request *async_req,
 	if (error < 0)
 		io->error = -EIO;
 
+	kfree(dmreq->sg_bulk);
 	mempool_free(req_of_dmreq(cc, dmreq), cc->req_pool);
 
 	if (!atomic_dec_and_test(&ctx->cc_pending))
@@ -1524,6 +1629,21 @@ static int crypt_ctr_cipher(struct dm_target *ti,
 		}
 	}
 
+	/*
+	 * Hand whole bios to the driver in one request when it derives
+	 * the per-sector IVs itself. That only works when the IV is a
+	 * plain function of the sector number (essiv and friends need
+	 * a cipher or hash call per sector here) and a single key is
+	 * in use across the request.
+	 */
+	if ((crypto_ablkcipher_tfm(any_tfm(cc))->__crt_alg->cra_flags &
+	     CRYPTO_ALG_BULK) &&
+	    cc->tfms_count == 1 &&
+	    (!cc->iv_gen_ops ||
+	     cc->iv_gen_ops == &crypt_iv_plain_ops ||
+	     cc->iv_gen_ops == &crypt_iv_plain64_ops))
+		cc->bulk_mode = 1;
+
 	ret = 0;
 bad:
 	kfree(cipher_api);
@@ -0,0 +1,578 @@
+/*
+ * Xilinx Video DMA capture driver
+ *
+ * Copyright (C) 2013 Xilinx, Inc.
+ *
+ * V4L2 capture interface for video pipelines in the PL that end in an
+ * AXI VDMA write (S2MM) channel. The driver programs the VDMA frame
+ * store ring with the addresses of the queued videobuf2 buffers and the
+ * hardware then rotates over them continuously; every frame completion
+ * interrupt hands the just written buffer to userspace.
+ *
+ * The buffers are allocated with videobuf2-dma-contig so they can be
+ * exported as DMABUF file descriptors and passed to other devices or
+ * processes without copying.
+ *
+ * Note the ownership model follows the hardware: the frame store
+ * addresses are fixed when streaming starts, so a dequeued buffer must
+ * be queued again before the ring wraps around to its slot, otherwise
+ * the next pass of the hardware overwrites it while userspace holds it
+ * (the frame is counted as dropped and not signalled again). With the
+ * usual three or more buffers in flight this never happens in practice.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ */
+
+#include <linux/dma-mapping.h>
+#include <linux/dmaengine.h>
+#include <linux/init.h>
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/of.h>
+#include <linux/platform_device.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+#include <linux/amba/xilinx_dma.h>
+
+#include <media/v4l2-common.h>
+#include <media/v4l2-device.h>
+#include <media/v4l2-ioctl.h>
+#include <media/videobuf2-core.h>
+#include <media/videobuf2-dma-contig.h>
+
+#define DRIVER_NAME		"xilinx-vcap"
+
+#define XVCAP_MAX_FRMS		16	/* Frame stores of the largest VDMA */
+#define XVCAP_MIN_FRMS		3	/* Triple buffering at least */
+
+/**
+ * struct xvcap_format - Pixel format description
+ * @name:	Format description
+ * @fourcc:	V4L2 pixel format FCC identifier
+ * @depth:	Bytes per pixel
+ */
+struct xvcap_format {
+	const char *name;
+	u32 fourcc;
+	unsigned int depth;
+};
+
+static const struct xvcap_format xvcap_formats[] = {
+	{
+		.name	= "4:2:2, packed, YUYV",
+		.fourcc	= V4L2_PIX_FMT_YUYV,
+		.depth	= 2,
+	}, {
+		.name	= "4:2:2, packed, UYVY",
+		.fourcc	= V4L2_PIX_FMT_UYVY,
+		.depth	= 2,
+	}, {
+		.name	= "RGB32",
+		.fourcc	= V4L2_PIX_FMT_RGB32,
+		.depth	= 4,
+	}, {
+		.name	= "Greyscale 8 bpp",
+		.fourcc	= V4L2_PIX_FMT_GREY,
+		.depth	= 1,
+	},
+};
+
+/**
+ * struct xvcap_buffer - Driver state attached to a vb2 buffer
+ * @vb:		The videobuf2 buffer
+ * @armed:	Buffer is queued and may be signalled on frame completion
+ */
+struct xvcap_buffer {
+	struct vb2_buffer vb;
+	bool armed;
+};
+
+/**
+ * struct xvcap_dev - Driver instance state
+ * @v4l2_dev:	Top level v4l2 device
+ * @vdev:	The video device node
+ * @queue:	Videobuf2 queue
+ * @lock:	Serializes the ioctls (vb2 queue lock)
+ * @slot_lock:	Protects the frame store ring against the DMA callback
+ * @chan:	The VDMA S2MM channel
+ * @alloc_ctx:	videobuf2-dma-contig allocation context
+ * @format:	Active pixel format
+ * @fmtinfo:	Entry of @format in the format table
+ * @ring:	Buffers in frame store order
+ * @frm_cnt:	Number of frame stores in use
+ * @slot:	Frame store the hardware writes next
+ * @sequence:	Capture sequence counter
+ * @dropped:	Frames overwritten because userspace was late
+ */
+struct xvcap_dev {
+	struct v4l2_device v4l2_dev;
+	struct video_device vdev;
+	struct vb2_queue queue;
+	struct mutex lock;
+	spinlock_t slot_lock;
+	struct dma_chan *chan;
+	void *alloc_ctx;
+	struct v4l2_pix_format format;
+	const struct xvcap_format *fmtinfo;
+	struct xvcap_buffer *ring[XVCAP_MAX_FRMS];
+	unsigned int frm_cnt;
+	unsigned int slot;
+	unsigned int sequence;
+	unsigned int dropped;
+};
+
+static const struct xvcap_format *xvcap_find_format(u32 fourcc)
+{
+	unsigned int i;
+
+	for (i = 0; i < ARRAY_SIZE(xvcap_formats); i++)
+		if (xvcap_formats[i].fourcc == fourcc)
+			return &xvcap_formats[i];
+
+	return NULL;
+}
+
+/*
+ * Frame completion callback, called once per captured frame from the
+ * VDMA interrupt (with coalescing set to one frame).
+ */
+static void xvcap_frame_done(void *data)
+{
+	struct xvcap_dev *xvcap = data;
+	struct xvcap_buffer *buf;
+	unsigned long flags;
+
+	spin_lock_irqsave(&xvcap->slot_lock, flags);
+
+	buf = xvcap->ring[xvcap->slot];
+	xvcap->slot = (xvcap->slot + 1) % xvcap->frm_cnt;
+
+	if (buf->armed) {
+		buf->armed = false;
+		buf->vb.v4l2_buf.sequence = xvcap->sequence;
+		v4l2_get_timestamp(&buf->vb.v4l2_buf.timestamp);
+		vb2_buffer_done(&buf->vb, VB2_BUF_STATE_DONE);
+	} else {
+		/* Still owned by userspace, frame went into dead air */
+		xvcap->dropped++;
+	}
+	xvcap->sequence++;
+
+	spin_unlock_irqrestore(&xvcap->slot_lock, flags);
+}
+
+/* -----------------------------------------------------------------
+ * Videobuf2 operations
+ */
+
+static int xvcap_queue_setup(struct vb2_queue *vq,
+			const struct v4l2_format *fmt,
+			unsigned int *nbuffers, unsigned int *nplanes,
+			unsigned int sizes[], void *alloc_ctxs[])
+{
+	struct xvcap_dev *xvcap = vb2_get_drv_priv(vq);
+
+	if (*nbuffers < XVCAP_MIN_FRMS)
+		*nbuffers = XVCAP_MIN_FRMS;
+	if (*nbuffers > XVCAP_MAX_FRMS)
+		*nbuffers = XVCAP_MAX_FRMS;
+
+	*nplanes = 1;
+	sizes[0] = xvcap->format.sizeimage;
+	alloc_ctxs[0] = xvcap->alloc_ctx;
+
+	return 0;
+}
+
+static int xvcap_buf_prepare(struct vb2_buffer *vb)
+{
+	struct xvcap_dev *xvcap = vb2_get_drv_priv(vb->vb2_queue);
+
+	if (vb2_plane_size(vb, 0) < xvcap->format.sizeimage)
+		return -EINVAL;
+
+	vb2_set_plane_payload(vb, 0, xvcap->format.sizeimage);
+
+	return 0;
+}
+
+static void xvcap_buf_queue(struct vb2_buffer *vb)
+{
+	struct xvcap_dev *xvcap = vb2_get_drv_priv(vb->vb2_queue);
+	struct xvcap_buffer *buf = container_of(vb, struct xvcap_buffer, vb);
+	unsigned long flags;
+
+	/*
+	 * Before streaming starts the buffer takes the next free frame
+	 * store slot; afterwards its address is already in the ring and
+	 * queueing only re-arms it for completion.
+	 */
+	spin_lock_irqsave(&xvcap->slot_lock, flags);
+
+	if (!vb2_is_streaming(vb->vb2_queue) &&
+	    xvcap->frm_cnt < XVCAP_MAX_FRMS)
+		xvcap->ring[xvcap->frm_cnt++] = buf;
+
+	buf->armed = true;
+
+	spin_unlock_irqrestore(&xvcap->slot_lock, flags);
+}
+
+static int xvcap_start_streaming(struct vb2_queue *vq, unsigned int count)
+{
+	struct xvcap_dev *xvcap = vb2_get_drv_priv(vq);
+	struct dma_async_tx_descriptor *desc;
+	struct xilinx_vdma_config config;
+	struct scatterlist sg[XVCAP_MAX_FRMS];
+	unsigned int i;
+
+	if (count < XVCAP_MIN_FRMS)
+		return -ENOBUFS;
+
+	xvcap->slot = 0;
+	xvcap->sequence = 0;
+	xvcap->dropped = 0;
+
+	/* Hand the frame store ring to the VDMA channel */
+	memset(&config, 0, sizeof(config));
+	config.direction = DMA_DEV_TO_MEM;
+	config.vsize = xvcap->format.height;
+	config.hsize = xvcap->format.width * xvcap->fmtinfo->depth;
+	config.stride = xvcap->format.bytesperline;
+	config.frm_cnt_en = 0;
+	config.coalesc = 1;
+	config.park = 0;
+	xvcap->chan->device->device_control(xvcap->chan, DMA_SLAVE_CONFIG,
+			(unsigned long)&config);
+
+	sg_init_table(sg, xvcap->frm_cnt);
+	for (i = 0; i < xvcap->frm_cnt; i++) {
+		sg_dma_address(&sg[i]) =
+			vb2_dma_contig_plane_dma_addr(&xvcap->ring[i]->vb, 0);
+		sg_dma_len(&sg[i]) = xvcap->format.sizeimage;
+	}
+
+	desc = dmaengine_prep_slave_sg(xvcap->chan, sg, xvcap->frm_cnt,
+			DMA_DEV_TO_MEM,
+			DMA_PREP_INTERRUPT | DMA_CTRL_ACK);
+	if (!desc) {
+		v4l2_err(&xvcap->v4l2_dev, "failed to prepare DMA frame ring\n");
+		return -EIO;
+	}
+
+	desc->callback = xvcap_frame_done;
+	desc->callback_param = xvcap;
+	dmaengine_submit(desc);
+	dma_async_issue_pending(xvcap->chan);
+
+	return 0;
+}
+
+static int xvcap_stop_streaming(struct vb2_queue *vq)
+{
+	struct xvcap_dev *xvcap = vb2_get_drv_priv(vq);
+	unsigned long flags;
+	unsigned int i;
+
+	dmaengine_terminate_all(xvcap->chan);
+
+	spin_lock_irqsave(&xvcap->slot_lock, flags);
+
+	for (i = 0; i < xvcap->frm_cnt; i++) {
+		struct xvcap_buffer *buf = xvcap->ring[i];
+
+		if (buf && buf->armed) {
+			buf->armed = false;
+			vb2_buffer_done(&buf->vb, VB2_BUF_STATE_ERROR);
+		}
+		xvcap->ring[i] = NULL;
+	}
+	xvcap->frm_cnt = 0;
+
+	spin_unlock_irqrestore(&xvcap->slot_lock, flags);
+
+	if (xvcap->dropped)
+		v4l2_info(&xvcap->v4l2_dev, "%u frames dropped\n",
+			  xvcap->dropped);
+
+	return 0;
+}
+
+static struct vb2_ops xvcap_qops = {
+	.queue_setup		= xvcap_queue_setup,
+	.buf_prepare		= xvcap_buf_prepare,
+	.buf_queue		= xvcap_buf_queue,
+	.start_streaming	= xvcap_start_streaming,
+	.stop_streaming		= xvcap_stop_streaming,
+	.wait_prepare		= vb2_ops_wait_prepare,
+	.wait_finish		= vb2_ops_wait_finish,
+};
+
+/* -----------------------------------------------------------------
+ * V4L2 ioctl operations
+ */
+
+static int xvcap_querycap(struct file *file, void *priv,
+			struct v4l2_capability *cap)
+{
+	strlcpy(cap->driver, DRIVER_NAME, sizeof(cap->driver));
+	strlcpy(cap->card, "Xilinx VDMA capture", sizeof(cap->card));
+	strlcpy(cap->bus_info, "platform:" DRIVER_NAME,
+		sizeof(cap->bus_info));
+	cap->device_caps = V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_STREAMING;
+	cap->capabilities = cap->device_caps | V4L2_CAP_DEVICE_CAPS;
+
+	return 0;
+}
+
+static int xvcap_enum_fmt(struct file *file, void *priv,
+			struct v4l2_fmtdesc *f)
+{
+	const struct xvcap_format *fmt;
+
+	if (f->index >= ARRAY_SIZE(xvcap_formats))
+		return -EINVAL;
+
+	fmt = &xvcap_formats[f->index];
+	strlcpy(f->description, fmt->name, sizeof(f->description));
+	f->pixelformat = fmt->fourcc;
+
+	return 0;
+}
+
+static int xvcap_g_fmt(struct file *file, void *priv, struct v4l2_format *f)
+{
+	struct xvcap_dev *xvcap = video_drvdata(file);
+
+	f->fmt.pix = xvcap->format;
+
+	return 0;
+}
+
+static int xvcap_try_fmt(struct file *file, void *priv, struct v4l2_format *f)
+{
+	struct v4l2_pix_format *pix = &f->fmt.pix;
+	const struct xvcap_format *fmt;
+
+	fmt = xvcap_find_format(pix->pixelformat);
+	if (!fmt) {
+		fmt = &xvcap_formats[0];
+		pix->pixelformat = fmt->fourcc;
+	}
+
+	v4l_bound_align_image(&pix->width, 32, 7680, 3,
+			      &pix->height, 32, 7680, 0, 0);
+
+	pix->field = V4L2_FIELD_NONE;
+	pix->bytesperline = pix->width * fmt->depth;
+	pix->sizeimage = pix->bytesperline * pix->height;
+	pix->colorspace = V4L2_COLORSPACE_SRGB;
+
+	return 0;
+}
+
+static int xvcap_s_fmt(struct file *file, void *priv, struct v4l2_format *f)
+{
+	struct xvcap_dev *xvcap = video_drvdata(file);
+	int ret;
+
+	if (vb2_is_busy(&xvcap->queue))
+		return -EBUSY;
+
+	ret = xvcap_try_fmt(file, priv, f);
+	if (ret < 0)
+		return ret;
+
+	xvcap->format = f->fmt.pix;
+	xvcap->fmtinfo = xvcap_find_format(f->fmt.pix.pixelformat);
+
+	return 0;
+}
+
+static int xvcap_enum_input(struct file *file, void *priv,
+			struct v4l2_input *i)
+{
+	if (i->index > 0)
+		return -EINVAL;
+
+	i->type = V4L2_INPUT_TYPE_CAMERA;
+	strlcpy(i->name, "PL video pipeline", sizeof(i->name));
+
+	return 0;
+}
+
+static int xvcap_g_input(struct file *file, void *priv, unsigned int *i)
+{
+	*i = 0;
+
+	return 0;
+}
+
+static int xvcap_s_input(struct file *file, void *priv, unsigned int i)
+{
+	return i ? -EINVAL : 0;
+}
+
+static const struct v4l2_ioctl_ops xvcap_ioctl_ops = {
+	.vidioc_querycap		= xvcap_querycap,
+	.vidioc_enum_fmt_vid_cap	= xvcap_enum_fmt,
+	.vidioc_g_fmt_vid_cap		= xvcap_g_fmt,
+	.vidioc_try_fmt_vid_cap		= xvcap_try_fmt,
+	.vidioc_s_fmt_vid_cap		= xvcap_s_fmt,
+	.vidioc_enum_input		= xvcap_enum_input,
+	.vidioc_g_input			= xvcap_g_input,
+	.vidioc_s_input			= xvcap_s_input,
+	.vidioc_reqbufs			= vb2_ioctl_reqbufs,
+	.vidioc_querybuf		= vb2_ioctl_querybuf,
+	.vidioc_qbuf			= vb2_ioctl_qbuf,
+	.vidioc_dqbuf			= vb2_ioctl_dqbuf,
+	.vidioc_expbuf			= vb2_ioctl_expbuf,
+	.vidioc_streamon		= vb2_ioctl_streamon,
+	.vidioc_streamoff		= vb2_ioctl_streamoff,
+};
+
+static const struct v4l2_file_operations xvcap_fops = {
+	.owner		= THIS_MODULE,
+	.open		= v4l2_fh_open,
+	.release	= vb2_fop_release,
+	.unlocked_ioctl	= video_ioctl2,
+	.mmap		= vb2_fop_mmap,
+	.poll		= vb2_fop_poll,
+};
+
+/* -----------------------------------------------------------------
+ * Platform device
+ */
+
+static bool xvcap_dma_filter(struct dma_chan *chan, void *param)
+{
+	return chan->private && *(u32 *)chan->private == *(u32 *)param;
+}
+
+static int xvcap_probe(struct platform_device *pdev)
+{
+	struct xvcap_dev *xvcap;
+	dma_cap_mask_t mask;
+	u32 device_id = 0;
+	u32 match;
+	int ret;
+
+	xvcap = devm_kzalloc(&pdev->dev, sizeof(*xvcap), GFP_KERNEL);
+	if (!xvcap)
+		return -ENOMEM;
+
+	mutex_init(&xvcap->lock);
+	spin_lock_init(&xvcap->slot_lock);
+
+	/* The write (S2MM) channel of the VDMA at the end of the pipe */
+	of_property_read_u32(pdev->dev.of_node, "xlnx,device-id", &device_id);
+	match = (DMA_DEV_TO_MEM & 0xFF) | XILINX_DMA_IP_VDMA |
+		(device_id << XILINX_DMA_DEVICE_ID_SHIFT);
+
+	dma_cap_zero(mask);
+	dma_cap_set(DMA_SLAVE, mask);
+	dma_cap_set(DMA_PRIVATE, mask);
+	xvcap->chan = dma_request_channel(mask, xvcap_dma_filter, &match);
+	if (!xvcap->chan) {
+		dev_err(&pdev->dev, "no VDMA write channel found\n");
+		return -EPROBE_DEFER;
+	}
+
+	/* Default format until userspace configures the pipe */
+	xvcap->fmtinfo = &xvcap_formats[0];
+	xvcap->format.pixelformat = xvcap->fmtinfo->fourcc;
+	xvcap->format.width = 1920;
+	xvcap->format.height = 1080;
+	xvcap->format.field = V4L2_FIELD_NONE;
+	xvcap->format.colorspace = V4L2_COLORSPACE_SRGB;
+	xvcap->format.bytesperline = xvcap->format.width *
+			xvcap->fmtinfo->depth;
+	xvcap->format.sizeimage = xvcap->format.bytesperline *
+			xvcap->format.height;
+
+	xvcap->alloc_ctx = vb2_dma_contig_init_ctx(&pdev->dev);
+	if (IS_ERR(xvcap->alloc_ctx)) {
+		ret = PTR_ERR(xvcap->alloc_ctx);
+		goto err_dma;
+	}
+
+	ret = v4l2_device_register(&pdev->dev, &xvcap->v4l2_dev);
+	if (ret)
+		goto err_ctx;
+
+	xvcap->queue.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	xvcap->queue.io_modes = VB2_MMAP | VB2_DMABUF;
+	xvcap->queue.drv_priv = xvcap;
+	xvcap->queue.buf_struct_size = sizeof(struct xvcap_buffer);
+	xvcap->queue.ops = &xvcap_qops;
+	xvcap->queue.mem_ops = &vb2_dma_contig_memops;
+	xvcap->queue.lock = &xvcap->lock;
+	ret = vb2_queue_init(&xvcap->queue);
+	if (ret)
+		goto err_v4l2;
+
+	strlcpy(xvcap->vdev.name, DRIVER_NAME, sizeof(xvcap->vdev.name));
+	xvcap->vdev.fops = &xvcap_fops;
+	xvcap->vdev.ioctl_ops = &xvcap_ioctl_ops;
+	xvcap->vdev.release = video_device_release_empty;
+	xvcap->vdev.v4l2_dev = &xvcap->v4l2_dev;
+	xvcap->vdev.queue = &xvcap->queue;
+	xvcap->vdev.lock = &xvcap->lock;
+	video_set_drvdata(&xvcap->vdev, xvcap);
+
+	ret = video_register_device(&xvcap->vdev, VFL_TYPE_GRABBER, -1);
+	if (ret)
+		goto err_v4l2;
+
+	platform_set_drvdata(pdev, xvcap);
+
+	dev_info(&pdev->dev, "registered as %s\n",
+		 video_device_node_name(&xvcap->vdev));
+
+	return 0;
+
+err_v4l2:
+	v4l2_device_unregister(&xvcap->v4l2_dev);
+err_ctx:
+	vb2_dma_contig_cleanup_ctx(xvcap->alloc_ctx);
+err_dma:
+	dma_release_channel(xvcap->chan);
+	return ret;
+}
+
+static int xvcap_remove(struct platform_device *pdev)
+{
+	struct xvcap_dev *xvcap = platform_get_drvdata(pdev);
+
+	video_unregister_device(&xvcap->vdev);
+	v4l2_device_unregister(&xvcap->v4l2_dev);
+	vb2_dma_contig_cleanup_ctx(xvcap->alloc_ctx);
+	dma_release_channel(xvcap->chan);
+
+	return 0;
+}
+
+static const struct of_device_id xvcap_of_match[] = {
+	{ .compatible = "xlnx,vdma-capture-1.00.a", },
+	{},
+};
+MODULE_DEVICE_TABLE(of, xvcap_of_match);
+
+static struct platform_driver xvcap_driver = {
+	.probe = xvcap_probe,
+	.remove = xvcap_remove,
+	.driver = {
+		.name = DRIVER_NAME,
+		.owner = THIS_MODULE,
+		.of_match_table = xvcap_of_match,
+	},
+};
+module_platform_driver(xvcap_driver);
+
+MODULE_AUTHOR("Xilinx Inc");
+MODULE_DESCRIPTION("Xilinx VDMA V4L2 capture driver");
+MODULE_LICENSE("GPL v2");
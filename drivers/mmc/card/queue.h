@@ -55,6 +55,14 @@ struct mmc_queue {
 	struct mmc_queue_req	mqrq[2];
 	struct mmc_queue_req	*mqrq_cur;
 	struct mmc_queue_req	*mqrq_prev;
+	/*
+	 * Adaptive write packing: packing is held off until a run of
+	 * wr_reqs_to_pack consecutive writes has been seen; a read,
+	 * flush or drained queue ends the run.
+	 */
+	int			wr_reqs_to_pack;
+	int			wr_run;
+	bool			wr_packing_on;
 };
 
 extern int mmc_init_queue(struct mmc_queue *, struct mmc_card *, spinlock_t *,
@@ -870,6 +870,22 @@ int __mmc_claim_host(struct mmc_host *host, atomic_t *abort)
 
 	might_sleep();
 
+	/*
+	 * The host is uncontended for almost every claim the block
+	 * driver makes; take it then without arming the waitqueue,
+	 * which costs two more trips through the waitqueue lock.
+	 */
+	spin_lock_irqsave(&host->lock, flags);
+	stop = abort ? atomic_read(abort) : 0;
+	if (!stop && (!host->claimed || host->claimer == current)) {
+		host->claimed = 1;
+		host->claimer = current;
+		host->claim_cnt += 1;
+		spin_unlock_irqrestore(&host->lock, flags);
+		goto claimed;
+	}
+	spin_unlock_irqrestore(&host->lock, flags);
+
 	add_wait_queue(&host->wq, &wait);
 	spin_lock_irqsave(&host->lock, flags);
 	while (1) {
@@ -890,9 +906,12 @@ int __mmc_claim_host(struct mmc_host *host, atomic_t *abort)
 		wake_up(&host->wq);
 	spin_unlock_irqrestore(&host->lock, flags);
 	remove_wait_queue(&host->wq, &wait);
-	if (host->ops->enable && !stop && host->claim_cnt == 1)
+	if (stop)
+		return stop;
+claimed:
+	if (host->ops->enable && host->claim_cnt == 1)
 		host->ops->enable(host);
-	return stop;
+	return 0;
 }
 
 EXPORT_SYMBOL(__mmc_claim_host);
@@ -946,7 +965,13 @@ void mmc_release_host(struct mmc_host *host)
 		host->claimed = 0;
 		host->claimer = NULL;
 		spin_unlock_irqrestore(&host->lock, flags);
-		wake_up(&host->wq);
+		/*
+		 * Waiters recheck ->claimed under host->lock after
+		 * queueing themselves, so no wakeup can be missed
+		 * and an empty queue need not be poked at all.
+		 */
+		if (waitqueue_active(&host->wq))
+			wake_up(&host->wq);
 	}
 }
 EXPORT_SYMBOL(mmc_release_host);
@@ -197,22 +197,61 @@ static int sdhci_zynq_probe(struct platform_device *pdev)
 		dev_warn(&pdev->dev, "Unable to register clock notifier.\n");
 
 
-	ret = sdhci_pltfm_register(pdev, &sdhci_zynq_pdata);
-	if (ret) {
+	host = sdhci_pltfm_init(pdev, &sdhci_zynq_pdata);
+	if (IS_ERR(host)) {
+		ret = PTR_ERR(host);
 		dev_err(&pdev->dev, "Platform registration failed\n");
 		goto clk_notif_unreg;
 	}
 
-	host = platform_get_drvdata(pdev);
 	pltfm_host = sdhci_priv(host);
 	pltfm_host->priv = xsdhcips;
 
+	sdhci_get_of_property(pdev);
+
+	/*
+	 * The controller implements the ADMA2 engine, but the capabilities
+	 * register may be configured not to advertise it, in which case
+	 * every multi-block request falls back to SDMA and takes an
+	 * interrupt at each 512KB boundary.  Report the capability
+	 * ourselves so that large requests complete with one descriptor
+	 * chain and one interrupt.  Zero length descriptors are not
+	 * handled by the engine, let the core split 64KB entries instead.
+	 */
+	host->quirks |= SDHCI_QUIRK_MISSING_CAPS |
+			SDHCI_QUIRK_BROKEN_ADMA_ZEROLEN_DESC;
+	host->caps = sdhci_readl(host, SDHCI_CAPABILITIES) |
+			SDHCI_CAN_DO_ADMA2;
+	host->caps1 = sdhci_readl(host, SDHCI_CAPABILITIES_1);
+
 	prop = of_get_property(np, "xlnx,has-cd", NULL);
 	if (prop == NULL || (!(u32) be32_to_cpup(prop)))
 		host->quirks |= SDHCI_QUIRK_BROKEN_CARD_DETECTION;
 
+	/*
+	 * The controller handles CMD23, which is all a packed write
+	 * needs from the host side; let mmc_blk coalesce small
+	 * writes for eMMC 4.5 cards.
+	 */
+	host->mmc->caps2 |= MMC_CAP2_PACKED_WR;
+
+	ret = sdhci_add_host(host);
+	if (ret) {
+		dev_err(&pdev->dev, "Adding SD host failed\n");
+		goto pltfm_free;
+	}
+
+	/*
+	 * Card re-initialization dominates system resume time; run it
+	 * alongside the rest of the device chain instead of serialized
+	 * within it.
+	 */
+	device_enable_async_suspend(&pdev->dev);
+
 	return 0;
 
+pltfm_free:
+	sdhci_pltfm_free(pdev);
 clk_notif_unreg:
 	clk_notifier_unregister(xsdhcips->devclk,
 			&xsdhcips->clk_rate_change_nb);
@@ -259,6 +298,8 @@ static struct platform_driver sdhci_zynq_driver = {
 		.owner = THIS_MODULE,
 		.of_match_table = sdhci_zynq_of_match,
 		.pm = XSDHCIPS_PM,
+		/* card detect debounce dominates probe time */
+		.probe_async = true,
 	},
 	.probe = sdhci_zynq_probe,
 	.remove = sdhci_zynq_remove,
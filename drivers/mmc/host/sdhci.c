@@ -44,6 +44,16 @@
 
 #define MAX_TUNING_LOOP 40
 
+/*
+ * Segments per request in ADMA mode. The descriptor chain lives in
+ * memory, so the only cost of a higher limit is the table itself:
+ * each segment needs one 8-byte descriptor plus potentially one more
+ * for alignment, and the terminating entry.
+ */
+#define SDHCI_ADMA_MAX_SEGS	512
+#define SDHCI_ADMA_DESC_SZ	((SDHCI_ADMA_MAX_SEGS * 2 + 1) * 8)
+#define SDHCI_ADMA_ALIGN_SZ	(SDHCI_ADMA_MAX_SEGS * 4)
+
 static unsigned int debug_quirks = 0;
 static unsigned int debug_quirks2;
 
@@ -497,15 +507,19 @@ static int sdhci_adma_table_pre(struct sdhci_host *host,
 	 */
 
 	host->align_addr = dma_map_single(mmc_dev(host->mmc),
-		host->align_buffer, 128 * 4, direction);
+		host->align_buffer, SDHCI_ADMA_ALIGN_SZ, direction);
 	if (dma_mapping_error(mmc_dev(host->mmc), host->align_addr))
 		goto fail;
 	BUG_ON(host->align_addr & 0x3);
 
-	host->sg_count = dma_map_sg(mmc_dev(host->mmc),
-		data->sg, data->sg_len, direction);
-	if (host->sg_count == 0)
-		goto unmap_align;
+	if (data->host_cookie) {
+		host->sg_count = data->host_cookie;
+	} else {
+		host->sg_count = dma_map_sg(mmc_dev(host->mmc),
+			data->sg, data->sg_len, direction);
+		if (host->sg_count == 0)
+			goto unmap_align;
+	}
 
 	desc = host->adma_desc;
 	align = host->align_buffer;
@@ -556,7 +570,7 @@ static int sdhci_adma_table_pre(struct sdhci_host *host,
 		 * If this triggers then we have a calculation bug
 		 * somewhere. :/
 		 */
-		WARN_ON((desc - host->adma_desc) > (128 * 2 + 1) * 4);
+		WARN_ON((desc - host->adma_desc) > SDHCI_ADMA_DESC_SZ);
 	}
 
 	if (host->quirks & SDHCI_QUIRK_NO_ENDATTR_IN_NOPDESC) {
@@ -581,11 +595,11 @@ static int sdhci_adma_table_pre(struct sdhci_host *host,
 	 */
 	if (data->flags & MMC_DATA_WRITE) {
 		dma_sync_single_for_device(mmc_dev(host->mmc),
-			host->align_addr, 128 * 4, direction);
+			host->align_addr, SDHCI_ADMA_ALIGN_SZ, direction);
 	}
 
 	host->adma_addr = dma_map_single(mmc_dev(host->mmc),
-		host->adma_desc, (128 * 2 + 1) * 4, DMA_TO_DEVICE);
+		host->adma_desc, SDHCI_ADMA_DESC_SZ, DMA_TO_DEVICE);
 	if (dma_mapping_error(mmc_dev(host->mmc), host->adma_addr))
 		goto unmap_entries;
 	BUG_ON(host->adma_addr & 0x3);
@@ -593,11 +607,12 @@ static int sdhci_adma_table_pre(struct sdhci_host *host,
 	return 0;
 
 unmap_entries:
-	dma_unmap_sg(mmc_dev(host->mmc), data->sg,
-		data->sg_len, direction);
+	if (!data->host_cookie)
+		dma_unmap_sg(mmc_dev(host->mmc), data->sg,
+			data->sg_len, direction);
 unmap_align:
 	dma_unmap_single(mmc_dev(host->mmc), host->align_addr,
-		128 * 4, direction);
+		SDHCI_ADMA_ALIGN_SZ, direction);
 fail:
 	return -EINVAL;
 }
@@ -619,10 +634,10 @@ static void sdhci_adma_table_post(struct sdhci_host *host,
 		direction = DMA_TO_DEVICE;
 
 	dma_unmap_single(mmc_dev(host->mmc), host->adma_addr,
-		(128 * 2 + 1) * 4, DMA_TO_DEVICE);
+		SDHCI_ADMA_DESC_SZ, DMA_TO_DEVICE);
 
 	dma_unmap_single(mmc_dev(host->mmc), host->align_addr,
-		128 * 4, direction);
+		SDHCI_ADMA_ALIGN_SZ, direction);
 
 	if (data->flags & MMC_DATA_READ) {
 		dma_sync_sg_for_cpu(mmc_dev(host->mmc), data->sg,
@@ -644,8 +659,71 @@ static void sdhci_adma_table_post(struct sdhci_host *host,
 		}
 	}
 
-	dma_unmap_sg(mmc_dev(host->mmc), data->sg,
-		data->sg_len, direction);
+	if (!data->host_cookie)
+		dma_unmap_sg(mmc_dev(host->mmc), data->sg,
+			data->sg_len, direction);
+}
+
+/*
+ * Pre-map the data buffers of the next request while the previous one
+ * is still on the bus, so the cache maintenance in dma_map_sg() comes
+ * off the critical path.  Entries mapped here are recognised by
+ * data->host_cookie (the mapped segment count) and left alone by the
+ * per-request map/unmap in sdhci_prepare_data()/sdhci_finish_data().
+ *
+ * Hosts with the 32-bit size/address quirks may still veto DMA for an
+ * individual request at issue time, and misaligned entries take the
+ * ADMA bounce path which fixes buffers up under its own mapping; both
+ * are left to sdhci_prepare_data().
+ */
+static void sdhci_pre_req(struct mmc_host *mmc, struct mmc_request *mrq,
+			bool is_first_req)
+{
+	struct sdhci_host *host = mmc_priv(mmc);
+	struct mmc_data *data = mrq->data;
+	struct scatterlist *sg;
+	int i, sg_count;
+
+	if (!data || !(host->flags & (SDHCI_USE_SDMA | SDHCI_USE_ADMA)))
+		return;
+
+	if (data->host_cookie) {
+		data->host_cookie = 0;
+		return;
+	}
+
+	if (host->quirks & (SDHCI_QUIRK_32BIT_DMA_SIZE |
+				SDHCI_QUIRK_32BIT_DMA_ADDR |
+				SDHCI_QUIRK_32BIT_ADMA_SIZE))
+		return;
+
+	for_each_sg(data->sg, sg, data->sg_len, i)
+		if (sg->offset & 0x3 || sg->length & 0x3)
+			return;
+
+	sg_count = dma_map_sg(mmc_dev(host->mmc), data->sg, data->sg_len,
+				(data->flags & MMC_DATA_READ) ?
+					DMA_FROM_DEVICE : DMA_TO_DEVICE);
+	if (sg_count == 0)
+		return;
+
+	data->host_cookie = sg_count;
+}
+
+static void sdhci_post_req(struct mmc_host *mmc, struct mmc_request *mrq,
+			int err)
+{
+	struct sdhci_host *host = mmc_priv(mmc);
+	struct mmc_data *data = mrq->data;
+
+	if (!data)
+		return;
+
+	if (data->host_cookie)
+		dma_unmap_sg(mmc_dev(host->mmc), data->sg, data->sg_len,
+				(data->flags & MMC_DATA_READ) ?
+					DMA_FROM_DEVICE : DMA_TO_DEVICE);
+	data->host_cookie = 0;
 }
 
 static u8 sdhci_calc_timeout(struct sdhci_host *host, struct mmc_command *cmd)
@@ -818,6 +896,18 @@ static void sdhci_prepare_data(struct sdhci_host *host, struct mmc_command *cmd)
 				 */
 				WARN_ON(1);
 				host->flags &= ~SDHCI_REQ_USE_DMA;
+				/*
+				 * PIO must not touch a buffer that is
+				 * still mapped for DMA.
+				 */
+				if (data->host_cookie) {
+					dma_unmap_sg(mmc_dev(host->mmc),
+						data->sg, data->sg_len,
+						(data->flags & MMC_DATA_READ) ?
+							DMA_FROM_DEVICE :
+							DMA_TO_DEVICE);
+					data->host_cookie = 0;
+				}
 			} else {
 				sdhci_writel(host, host->adma_addr,
 					SDHCI_ADMA_ADDRESS);
@@ -825,11 +915,14 @@ static void sdhci_prepare_data(struct sdhci_host *host, struct mmc_command *cmd)
 		} else {
 			int sg_cnt;
 
-			sg_cnt = dma_map_sg(mmc_dev(host->mmc),
-					data->sg, data->sg_len,
-					(data->flags & MMC_DATA_READ) ?
-						DMA_FROM_DEVICE :
-						DMA_TO_DEVICE);
+			if (data->host_cookie)
+				sg_cnt = data->host_cookie;
+			else
+				sg_cnt = dma_map_sg(mmc_dev(host->mmc),
+						data->sg, data->sg_len,
+						(data->flags & MMC_DATA_READ) ?
+							DMA_FROM_DEVICE :
+							DMA_TO_DEVICE);
 			if (sg_cnt == 0) {
 				/*
 				 * This only happens when someone fed
@@ -927,7 +1020,7 @@ static void sdhci_finish_data(struct sdhci_host *host)
 	if (host->flags & SDHCI_REQ_USE_DMA) {
 		if (host->flags & SDHCI_USE_ADMA)
 			sdhci_adma_table_post(host, data);
-		else {
+		else if (!data->host_cookie) {
 			dma_unmap_sg(mmc_dev(host->mmc), data->sg,
 				data->sg_len, (data->flags & MMC_DATA_READ) ?
 					DMA_FROM_DEVICE : DMA_TO_DEVICE);
@@ -2037,6 +2130,8 @@ static void sdhci_card_event(struct mmc_host *mmc)
 
 static const struct mmc_host_ops sdhci_ops = {
 	.request	= sdhci_request,
+	.pre_req	= sdhci_pre_req,
+	.post_req	= sdhci_post_req,
 	.set_ios	= sdhci_set_ios,
 	.get_ro		= sdhci_get_ro,
 	.hw_reset	= sdhci_hw_reset,
@@ -2768,11 +2863,11 @@ int sdhci_add_host(struct sdhci_host *host)
 	if (host->flags & SDHCI_USE_ADMA) {
 		/*
 		 * We need to allocate descriptors for all sg entries
-		 * (128) and potentially one alignment transfer for
-		 * each of those entries.
+		 * and potentially one alignment transfer for each of
+		 * those entries.
 		 */
-		host->adma_desc = kmalloc((128 * 2 + 1) * 4, GFP_KERNEL);
-		host->align_buffer = kmalloc(128 * 4, GFP_KERNEL);
+		host->adma_desc = kmalloc(SDHCI_ADMA_DESC_SZ, GFP_KERNEL);
+		host->align_buffer = kmalloc(SDHCI_ADMA_ALIGN_SZ, GFP_KERNEL);
 		if (!host->adma_desc || !host->align_buffer) {
 			kfree(host->adma_desc);
 			kfree(host->align_buffer);
@@ -3069,7 +3164,7 @@ int sdhci_add_host(struct sdhci_host *host)
 	 * can do scatter/gather or not.
 	 */
 	if (host->flags & SDHCI_USE_ADMA)
-		mmc->max_segs = 128;
+		mmc->max_segs = SDHCI_ADMA_MAX_SEGS;
 	else if (host->flags & SDHCI_USE_SDMA)
 		mmc->max_segs = 1;
 	else /* PIO */
@@ -20,6 +20,7 @@
  *
  */
 
+#include <linux/err.h>
 #include <linux/fs.h>
 #include <linux/init.h>
 #include <linux/kernel.h>
@@ -28,20 +29,39 @@
 #include <linux/slab.h>
 #include <linux/types.h>
 #include <linux/vmalloc.h>
+#include <linux/workqueue.h>
 
 #include <linux/mtd/mtd.h>
 #include <linux/mtd/blktrans.h>
 #include <linux/mutex.h>
 
 
+/* Number of erase blocks cached per device.  A write that crosses into
+ * an uncached sector only stalls on an erase once all slots hold
+ * distinct dirty sectors.
+ */
+#define MTDBLOCK_CACHE_SLOTS	4
+
+/* How long a dirty erase block may sit in the cache before the
+ * background flush writes it back.
+ */
+#define MTDBLOCK_FLUSH_DELAY	(HZ / 2)
+
+struct mtdblk_cache {
+	unsigned char *data;
+	unsigned long offset;
+	unsigned long age;
+	enum { STATE_EMPTY, STATE_CLEAN, STATE_DIRTY } state;
+};
+
 struct mtdblk_dev {
 	struct mtd_blktrans_dev mbd;
 	int count;
 	struct mutex cache_mutex;
-	unsigned char *cache_data;
-	unsigned long cache_offset;
 	unsigned int cache_size;
-	enum { STATE_EMPTY, STATE_CLEAN, STATE_DIRTY } cache_state;
+	unsigned long cache_age;
+	struct mtdblk_cache cache[MTDBLOCK_CACHE_SLOTS];
+	struct delayed_work flush_work;
 };
 
 static DEFINE_MUTEX(mtdblks_lock);
@@ -52,8 +72,10 @@ static DEFINE_MUTEX(mtdblks_lock);
  * Since typical flash erasable sectors are much larger than what Linux's
  * buffer cache can handle, we must implement read-modify-write on flash
  * sectors for each block write requests.  To avoid over-erasing flash sectors
- * and to speed things up, we locally cache a whole flash sector while it is
- * being written to until a different sector is required.
+ * and to speed things up, we locally cache a few flash sectors while they are
+ * being written to.  Dirty sectors are written back by a delayed worker, so
+ * a burst of small writes that touches several sectors is absorbed in RAM
+ * and each sector is erased once per burst rather than once per crossing.
  */
 
 static void erase_callback(struct erase_info *done)
@@ -111,20 +133,21 @@ static int erase_write (struct mtd_info *mtd, unsigned long pos,
 }
 
 
-static int write_cached_data (struct mtdblk_dev *mtdblk)
+static int write_cached_slot (struct mtdblk_dev *mtdblk,
+			      struct mtdblk_cache *cache)
 {
 	struct mtd_info *mtd = mtdblk->mbd.mtd;
 	int ret;
 
-	if (mtdblk->cache_state != STATE_DIRTY)
+	if (cache->state != STATE_DIRTY)
 		return 0;
 
 	pr_debug("mtdblock: writing cached data for \"%s\" "
 			"at 0x%lx, size 0x%x\n", mtd->name,
-			mtdblk->cache_offset, mtdblk->cache_size);
+			cache->offset, mtdblk->cache_size);
 
-	ret = erase_write (mtd, mtdblk->cache_offset,
-			   mtdblk->cache_size, mtdblk->cache_data);
+	ret = erase_write (mtd, cache->offset,
+			   mtdblk->cache_size, cache->data);
 	if (ret)
 		return ret;
 
@@ -135,10 +158,85 @@ static int write_cached_data (struct mtdblk_dev *mtdblk)
 	 * means.  Let's declare it empty and leave buffering tasks to
 	 * the buffer cache instead.
 	 */
-	mtdblk->cache_state = STATE_EMPTY;
+	cache->state = STATE_EMPTY;
 	return 0;
 }
 
+static int write_cached_data (struct mtdblk_dev *mtdblk)
+{
+	int i, err, ret = 0;
+
+	for (i = 0; i < MTDBLOCK_CACHE_SLOTS; i++) {
+		err = write_cached_slot(mtdblk, &mtdblk->cache[i]);
+		if (err && !ret)
+			ret = err;
+	}
+	return ret;
+}
+
+static void mtdblock_flush_work(struct work_struct *work)
+{
+	struct mtdblk_dev *mtdblk =
+		container_of(work, struct mtdblk_dev, flush_work.work);
+
+	mutex_lock(&mtdblk->cache_mutex);
+	write_cached_data(mtdblk);
+	mutex_unlock(&mtdblk->cache_mutex);
+}
+
+static struct mtdblk_cache *mtdblk_find_cache (struct mtdblk_dev *mtdblk,
+					       unsigned long sect_start)
+{
+	int i;
+
+	for (i = 0; i < MTDBLOCK_CACHE_SLOTS; i++) {
+		struct mtdblk_cache *cache = &mtdblk->cache[i];
+
+		if (cache->state != STATE_EMPTY && cache->offset == sect_start)
+			return cache;
+	}
+	return NULL;
+}
+
+/*
+ * Pick a slot for a new sector: an empty one if available, the least
+ * recently used otherwise.  A dirty victim is written back first.
+ */
+static struct mtdblk_cache *mtdblk_grab_cache (struct mtdblk_dev *mtdblk)
+{
+	struct mtdblk_cache *victim = NULL;
+	int i, ret;
+
+	for (i = 0; i < MTDBLOCK_CACHE_SLOTS; i++) {
+		struct mtdblk_cache *cache = &mtdblk->cache[i];
+
+		if (cache->state == STATE_EMPTY) {
+			victim = cache;
+			break;
+		}
+		if (!victim || cache->age < victim->age)
+			victim = cache;
+	}
+
+	if (victim->state == STATE_DIRTY) {
+		ret = write_cached_slot(mtdblk, victim);
+		if (ret)
+			return ERR_PTR(ret);
+	}
+	victim->state = STATE_EMPTY;
+
+	if (!victim->data) {
+		victim->data = vmalloc(mtdblk->mbd.mtd->erasesize);
+		if (!victim->data)
+			return ERR_PTR(-EINTR);
+		/* -EINTR is not really correct, but it is the best match
+		 * documented in man 2 write for all cases.  We could also
+		 * return -EAGAIN sometimes, but why bother?
+		 */
+	}
+	return victim;
+}
+
 
 static int do_cached_write (struct mtdblk_dev *mtdblk, unsigned long pos,
 			    int len, const char *buf)
@@ -154,10 +252,20 @@ static int do_cached_write (struct mtdblk_dev *mtdblk, unsigned long pos,
 	if (!sect_size)
 		return mtd_write(mtd, pos, len, &retlen, buf);
 
+	/*
+	 * The blktrans dev->lock serializes us against other requests,
+	 * but not against the background flush worker, which only holds
+	 * cache_mutex.  Take it here so the worker cannot empty a slot
+	 * we are dirtying (or vice versa).
+	 */
+	mutex_lock(&mtdblk->cache_mutex);
+
 	while (len > 0) {
 		unsigned long sect_start = (pos/sect_size)*sect_size;
 		unsigned int offset = pos - sect_start;
 		unsigned int size = sect_size - offset;
+		struct mtdblk_cache *cache;
+
 		if( size > len )
 			size = len;
 
@@ -169,44 +277,52 @@ static int do_cached_write (struct mtdblk_dev *mtdblk, unsigned long pos,
 			 */
 			ret = erase_write (mtd, pos, size, buf);
 			if (ret)
-				return ret;
+				goto out;
+			/* don't let a stale copy shadow what we just wrote */
+			cache = mtdblk_find_cache(mtdblk, sect_start);
+			if (cache)
+				cache->state = STATE_EMPTY;
 		} else {
 			/* Partial sector: need to use the cache */
 
-			if (mtdblk->cache_state == STATE_DIRTY &&
-			    mtdblk->cache_offset != sect_start) {
-				ret = write_cached_data(mtdblk);
-				if (ret)
-					return ret;
-			}
+			cache = mtdblk_find_cache(mtdblk, sect_start);
+			if (!cache) {
+				cache = mtdblk_grab_cache(mtdblk);
+				if (IS_ERR(cache)) {
+					ret = PTR_ERR(cache);
+					goto out;
+				}
 
-			if (mtdblk->cache_state == STATE_EMPTY ||
-			    mtdblk->cache_offset != sect_start) {
-				/* fill the cache with the current sector */
-				mtdblk->cache_state = STATE_EMPTY;
+				/* fill the slot with the current sector */
 				ret = mtd_read(mtd, sect_start, sect_size,
-					       &retlen, mtdblk->cache_data);
+					       &retlen, cache->data);
 				if (ret)
-					return ret;
-				if (retlen != sect_size)
-					return -EIO;
-
-				mtdblk->cache_offset = sect_start;
-				mtdblk->cache_size = sect_size;
-				mtdblk->cache_state = STATE_CLEAN;
+					goto out;
+				if (retlen != sect_size) {
+					ret = -EIO;
+					goto out;
+				}
+
+				cache->offset = sect_start;
+				cache->state = STATE_CLEAN;
 			}
 
 			/* write data to our local cache */
-			memcpy (mtdblk->cache_data + offset, buf, size);
-			mtdblk->cache_state = STATE_DIRTY;
+			memcpy (cache->data + offset, buf, size);
+			cache->state = STATE_DIRTY;
+			cache->age = ++mtdblk->cache_age;
+			schedule_delayed_work(&mtdblk->flush_work,
+					      MTDBLOCK_FLUSH_DELAY);
 		}
 
 		buf += size;
 		pos += size;
 		len -= size;
 	}
-
-	return 0;
+	ret = 0;
+out:
+	mutex_unlock(&mtdblk->cache_mutex);
+	return ret;
 }
 
 
@@ -224,10 +340,15 @@ static int do_cached_read (struct mtdblk_dev *mtdblk, unsigned long pos,
 	if (!sect_size)
 		return mtd_read(mtd, pos, len, &retlen, buf);
 
+	/* Keep the flush worker from emptying a slot while we copy from it. */
+	mutex_lock(&mtdblk->cache_mutex);
+
 	while (len > 0) {
 		unsigned long sect_start = (pos/sect_size)*sect_size;
 		unsigned int offset = pos - sect_start;
 		unsigned int size = sect_size - offset;
+		struct mtdblk_cache *cache;
+
 		if (size > len)
 			size = len;
 
@@ -237,23 +358,27 @@ static int do_cached_read (struct mtdblk_dev *mtdblk, unsigned long pos,
 		 * contains what we want, otherwise we read the data directly
 		 * from flash.
 		 */
-		if (mtdblk->cache_state != STATE_EMPTY &&
-		    mtdblk->cache_offset == sect_start) {
-			memcpy (buf, mtdblk->cache_data + offset, size);
+		cache = mtdblk_find_cache(mtdblk, sect_start);
+		if (cache) {
+			memcpy (buf, cache->data + offset, size);
 		} else {
 			ret = mtd_read(mtd, pos, size, &retlen, buf);
 			if (ret)
-				return ret;
-			if (retlen != size)
-				return -EIO;
+				goto out;
+			if (retlen != size) {
+				ret = -EIO;
+				goto out;
+			}
 		}
 
 		buf += size;
 		pos += size;
 		len -= size;
 	}
-
-	return 0;
+	ret = 0;
+out:
+	mutex_unlock(&mtdblk->cache_mutex);
+	return ret;
 }
 
 static int mtdblock_readsect(struct mtd_blktrans_dev *dev,
@@ -267,21 +392,13 @@ static int mtdblock_writesect(struct mtd_blktrans_dev *dev,
 			      unsigned long block, char *buf)
 {
 	struct mtdblk_dev *mtdblk = container_of(dev, struct mtdblk_dev, mbd);
-	if (unlikely(!mtdblk->cache_data && mtdblk->cache_size)) {
-		mtdblk->cache_data = vmalloc(mtdblk->mbd.mtd->erasesize);
-		if (!mtdblk->cache_data)
-			return -EINTR;
-		/* -EINTR is not really correct, but it is the best match
-		 * documented in man 2 write for all cases.  We could also
-		 * return -EAGAIN sometimes, but why bother?
-		 */
-	}
 	return do_cached_write(mtdblk, block<<9, 512, buf);
 }
 
 static int mtdblock_open(struct mtd_blktrans_dev *mbd)
 {
 	struct mtdblk_dev *mtdblk = container_of(mbd, struct mtdblk_dev, mbd);
+	int i;
 
 	pr_debug("mtdblock_open\n");
 
@@ -295,11 +412,11 @@ static int mtdblock_open(struct mtd_blktrans_dev *mbd)
 	/* OK, it's not open. Create cache info for it */
 	mtdblk->count = 1;
 	mutex_init(&mtdblk->cache_mutex);
-	mtdblk->cache_state = STATE_EMPTY;
-	if (!(mbd->mtd->flags & MTD_NO_ERASE) && mbd->mtd->erasesize) {
+	INIT_DELAYED_WORK(&mtdblk->flush_work, mtdblock_flush_work);
+	for (i = 0; i < MTDBLOCK_CACHE_SLOTS; i++)
+		mtdblk->cache[i].state = STATE_EMPTY;
+	if (!(mbd->mtd->flags & MTD_NO_ERASE) && mbd->mtd->erasesize)
 		mtdblk->cache_size = mbd->mtd->erasesize;
-		mtdblk->cache_data = NULL;
-	}
 
 	mutex_unlock(&mtdblks_lock);
 
@@ -311,6 +428,7 @@ static int mtdblock_open(struct mtd_blktrans_dev *mbd)
 static int mtdblock_release(struct mtd_blktrans_dev *mbd)
 {
 	struct mtdblk_dev *mtdblk = container_of(mbd, struct mtdblk_dev, mbd);
+	int i;
 
 	pr_debug("mtdblock_release\n");
 
@@ -323,11 +441,16 @@ static int mtdblock_release(struct mtd_blktrans_dev *mbd)
 	if (!--mtdblk->count) {
 		/*
 		 * It was the last usage. Free the cache, but only sync if
-		 * opened for writing.
+		 * opened for writing.  The flush worker only locks
+		 * cache_mutex, so it is safe to wait for it here.
 		 */
+		cancel_delayed_work_sync(&mtdblk->flush_work);
 		if (mbd->file_mode & FMODE_WRITE)
 			mtd_sync(mbd->mtd);
-		vfree(mtdblk->cache_data);
+		for (i = 0; i < MTDBLOCK_CACHE_SLOTS; i++) {
+			vfree(mtdblk->cache[i].data);
+			mtdblk->cache[i].data = NULL;
+		}
 	}
 
 	mutex_unlock(&mtdblks_lock);
@@ -63,6 +63,10 @@
 
 #define ONDIE_ECC_FEATURE_ADDR	0x90
 
+/* Read cache command set, advertised through the ONFI optional commands */
+#define XNANDPS_CMD_READ_CACHE_SEQ	0x31
+#define XNANDPS_CMD_READ_CACHE_END	0x3f
+
 /* Macros for the NAND controller register read/write */
 #define xnandps_write32(addr, val)	__raw_writel((val), (addr))
 
@@ -89,6 +93,9 @@ struct xnandps_command_format {
  * @nand_base:		Virtual address of the NAND flash device
  * @end_cmd_pending:	End command is pending
  * @end_cmd:		End command
+ * @read_cache:		Flash supports the read cache sequential commands
+ * @cache_page:		Next page the read cache delivers, -1 when inactive
+ * @last_page:		Last page read, used to detect sequential streams
  **/
 struct xnandps_info {
 	struct nand_chip	chip;
@@ -97,6 +104,9 @@ struct xnandps_info {
 	void __iomem		*nand_base;
 	unsigned long		end_cmd_pending;
 	unsigned long		end_cmd;
+	int			read_cache;
+	int			cache_page;
+	int			last_page;
 };
 
 /*
@@ -537,10 +547,6 @@ static int xnandps_read_page_hwecc(struct mtd_info *mtd, struct nand_chip *chip,
 	chip->IO_ADDR_R = (void __iomem *__force)data_phase_addr;
 	chip->read_buf(mtd, p, data_width);
 
-	/* Read the calculated ECC value */
-	p = buf;
-	chip->ecc.calculate(mtd, p, &ecc_calc[0]);
-
 	/* Clear ECC last bit */
 	data_phase_addr = (unsigned long __force)chip->IO_ADDR_R;
 	data_phase_addr &= ~XNANDPS_ECC_LAST;
@@ -558,6 +564,15 @@ static int xnandps_read_page_hwecc(struct mtd_info *mtd, struct nand_chip *chip,
 	oob_ptr += (mtd->oobsize - data_width);
 	chip->read_buf(mtd, oob_ptr, data_width);
 
+	/*
+	 * Read the calculated ECC value.  The spare area transfer above
+	 * gave the ECC block time to digest the last data block, so the
+	 * busy poll in calculate() normally falls straight through and
+	 * the per-page results are collected in one pass.
+	 */
+	p = buf;
+	chip->ecc.calculate(mtd, p, &ecc_calc[0]);
+
 	for (i = 0; i < chip->ecc.total; i++)
 		ecc_code[i] = ~(chip->oob_poi[eccpos[i]]);
 
@@ -629,6 +644,41 @@ static void xnandps_select_chip(struct mtd_info *mtd, int chip)
 	return;
 }
 
+/**
+ * xnandps_read_cache_cmd - Issue a read cache command cycle
+ * @mtd:	Pointer to the mtd_info structure
+ * @cmd:	Read cache command (sequential or end)
+ *
+ * The read cache commands take no address cycles.  The command phase
+ * write is followed by a wait for the ready/busy transition covering
+ * tRCBSY, after which the cached page streams from the plain data
+ * phase address.
+ **/
+static void xnandps_read_cache_cmd(struct mtd_info *mtd, int cmd)
+{
+	struct nand_chip *chip = mtd->priv;
+	struct xnandps_info *xnand =
+		container_of(mtd, struct xnandps_info, mtd);
+	unsigned long cmd_phase_addr;
+
+	/* Clear interrupt */
+	xsmcps_clr_nand_int();
+
+	cmd_phase_addr = (unsigned long __force)xnand->nand_base	|
+			(COMMAND_PHASE)					|
+			(cmd << START_CMD_SHIFT);
+	xnandps_write32((void __iomem * __force)cmd_phase_addr, 0);
+
+	chip->IO_ADDR_R = (void __iomem * __force)
+		((unsigned long __force)xnand->nand_base | DATA_PHASE);
+	chip->IO_ADDR_W = chip->IO_ADDR_R;
+
+	ndelay(100);
+
+	while (!chip->dev_ready(mtd))
+		;
+}
+
 /**
  * xnandps_cmd_function - Send command to NAND device
  * @mtd:	Pointer to the mtd_info structure
@@ -668,6 +718,35 @@ static void xnandps_cmd_function(struct mtd_info *mtd, unsigned int command,
 		command = NAND_CMD_READ0;
 	}
 
+	/*
+	 * Sequential page reads are pipelined with the read cache
+	 * commands: while one page streams out of the cache register the
+	 * array fetches the next one.  Any other command first takes the
+	 * flash out of cache mode.
+	 */
+	if (xnand->cache_page >= 0) {
+		unsigned long blkmask = mtd->erasesize / mtd->writesize - 1;
+
+		if ((command == NAND_CMD_READ0) && (column == 0) &&
+			(page_addr == xnand->cache_page)) {
+			if (((page_addr + 1) & blkmask) == 0) {
+				/* Last page of the block ends the stream */
+				xnandps_read_cache_cmd(mtd,
+						XNANDPS_CMD_READ_CACHE_END);
+				xnand->cache_page = -1;
+			} else {
+				xnandps_read_cache_cmd(mtd,
+						XNANDPS_CMD_READ_CACHE_SEQ);
+				xnand->cache_page = page_addr + 1;
+			}
+			xnand->last_page = page_addr;
+			return;
+		}
+
+		xnandps_read_cache_cmd(mtd, XNANDPS_CMD_READ_CACHE_END);
+		xnand->cache_page = -1;
+	}
+
 	/* Get the command format */
 	for (i = 0; (xnandps_commands[i].start_cmd != NAND_CMD_NONE ||
 		xnandps_commands[i].end_cmd != NAND_CMD_NONE); i++) {
@@ -761,6 +840,23 @@ static void xnandps_cmd_function(struct mtd_info *mtd, unsigned int command,
 
 		while (!chip->dev_ready(mtd))
 			;
+
+		/*
+		 * The second consecutive page of a stream turns cache mode
+		 * on: the page just fetched moves to the cache register and
+		 * the array starts on the next one while it streams out
+		 */
+		if ((command == NAND_CMD_READ0) && (column == 0)) {
+			if (xnand->read_cache &&
+				(page_addr == xnand->last_page + 1) &&
+				(((page_addr + 1) &
+				(mtd->erasesize / mtd->writesize - 1)) != 0)) {
+				xnandps_read_cache_cmd(mtd,
+						XNANDPS_CMD_READ_CACHE_SEQ);
+				xnand->cache_page = page_addr + 1;
+			}
+			xnand->last_page = page_addr;
+		}
 		return;
 	}
 }
@@ -771,16 +867,16 @@ static void xnandps_cmd_function(struct mtd_info *mtd, unsigned int command,
  * @buf:        buffer to store date
  * @len:        number of bytes to read
  *
+ * The data port decodes the command from the AXI address, not from the
+ * data, so the whole burst is read from the same location.  readsl()
+ * issues multi-word loads without a barrier per word, which lets the
+ * interconnect merge the accesses into back-to-back AXI beats.
  */
 static void xnandps_read_buf(struct mtd_info *mtd, uint8_t *buf, int len)
 {
-	int i;
 	struct nand_chip *chip = mtd->priv;
-	unsigned long *ptr = (unsigned long *)buf;
 
-	len >>= 2;
-	for (i = 0; i < len; i++)
-		ptr[i] = readl(chip->IO_ADDR_R);
+	readsl(chip->IO_ADDR_R, buf, len >> 2);
 }
 
 /**
@@ -792,13 +888,9 @@ static void xnandps_read_buf(struct mtd_info *mtd, uint8_t *buf, int len)
  */
 static void xnandps_write_buf(struct mtd_info *mtd, const uint8_t *buf, int len)
 {
-	int i;
 	struct nand_chip *chip = mtd->priv;
-	unsigned long *ptr = (unsigned long *)buf;
-	len >>= 2;
 
-	for (i = 0; i < len; i++)
-		writel(ptr[i], chip->IO_ADDR_W);
+	writesl(chip->IO_ADDR_W, buf, len >> 2);
 }
 
 /**
@@ -912,6 +1004,9 @@ static int xnandps_probe(struct platform_device *pdev)
 	nand_chip->options = options;
 	nand_chip->bbt_options = NAND_BBT_USE_FLASH;
 
+	xnand->cache_page = -1;
+	xnand->last_page = -1;
+
 	platform_set_drvdata(pdev, xnand);
 
 	/* first scan to find the device and get the page size */
@@ -962,6 +1057,14 @@ static int xnandps_probe(struct platform_device *pdev)
 		}
 	}
 
+	/*
+	 * Pipelined page reads need the read cache sequential commands,
+	 * advertised in the ONFI optional command set (bit 1)
+	 */
+	if (nand_chip->onfi_version &&
+			(le16_to_cpu(nand_chip->onfi_params.opt_cmd) & 0x2))
+		xnand->read_cache = 1;
+
 	nand_chip->ecc.mode = NAND_ECC_HW;
 	nand_chip->ecc.read_oob = xnandps_read_oob;
 	nand_chip->ecc.read_page_raw = xnandps_read_page_raw;
@@ -1088,6 +1191,8 @@ static struct platform_driver xnandps_driver = {
 		.name	= XNANDPS_DRIVER_NAME,
 		.owner	= THIS_MODULE,
 		.of_match_table = xnandps_of_match,
+		/* ONFI parameter page reads dominate probe time */
+		.probe_async = true,
 	},
 };
 
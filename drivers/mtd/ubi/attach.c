@@ -83,6 +83,7 @@
  */
 
 #include <linux/err.h>
+#include <linux/kthread.h>
 #include <linux/slab.h>
 #include <linux/crc32.h>
 #include <linux/math64.h>
@@ -800,6 +801,28 @@ out_unlock:
 	return err;
 }
 
+/**
+ * struct scan_slot - header buffers and read results for one PEB.
+ * @ech: buffer for the erase counter header
+ * @vidh: buffer for the volume identifier header
+ * @cached: non-zero if the results below are already valid
+ * @is_bad: result of 'ubi_io_is_bad()'
+ * @ec_ret: return code of 'ubi_io_read_ec_hdr()'
+ * @vid_ret: return code of 'ubi_io_read_vid_hdr()'
+ *
+ * When @cached is zero, only the buffers are meaningful and 'scan_peb()'
+ * reads the headers itself; otherwise the read-ahead thread has already
+ * filled everything in and 'scan_peb()' does no flash I/O on the fast paths.
+ */
+struct scan_slot {
+	struct ubi_ec_hdr *ech;
+	struct ubi_vid_hdr *vidh;
+	int cached;
+	int is_bad;
+	int ec_ret;
+	int vid_ret;
+};
+
 /**
  * scan_peb - scan and process UBI headers of a PEB.
  * @ubi: UBI device description object
@@ -807,6 +830,7 @@ out_unlock:
  * @pnum: the physical eraseblock number
  * @vid: The volume ID of the found volume will be stored in this pointer
  * @sqnum: The sqnum of the found volume will be stored in this pointer
+ * @sl: header buffers to use, possibly pre-filled by the read-ahead thread
  *
  * This function reads UBI headers of PEB @pnum, checks them, and adds
  * information about this PEB to the corresponding list or RB-tree in the
@@ -814,15 +838,18 @@ out_unlock:
  * successfully handled and a negative error code in case of failure.
  */
 static int scan_peb(struct ubi_device *ubi, struct ubi_attach_info *ai,
-		    int pnum, int *vid, unsigned long long *sqnum)
+		    int pnum, int *vid, unsigned long long *sqnum,
+		    struct scan_slot *sl)
 {
 	long long uninitialized_var(ec);
 	int err, bitflips = 0, vol_id = -1, ec_err = 0;
+	struct ubi_ec_hdr *ech = sl->ech;
+	struct ubi_vid_hdr *vidh = sl->vidh;
 
 	dbg_bld("scan PEB %d", pnum);
 
 	/* Skip bad physical eraseblocks */
-	err = ubi_io_is_bad(ubi, pnum);
+	err = sl->cached ? sl->is_bad : ubi_io_is_bad(ubi, pnum);
 	if (err < 0)
 		return err;
 	else if (err) {
@@ -830,7 +857,7 @@ static int scan_peb(struct ubi_device *ubi, struct ubi_attach_info *ai,
 		return 0;
 	}
 
-	err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
+	err = sl->cached ? sl->ec_ret : ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
 	if (err < 0)
 		return err;
 	switch (err) {
@@ -913,7 +940,7 @@ static int scan_peb(struct ubi_device *ubi, struct ubi_attach_info *ai,
 
 	/* OK, we've done with the EC header, let's look at the VID header */
 
-	err = ubi_io_read_vid_hdr(ubi, pnum, vidh, 0);
+	err = sl->cached ? sl->vid_ret : ubi_io_read_vid_hdr(ubi, pnum, vidh, 0);
 	if (err < 0)
 		return err;
 	switch (err) {
@@ -1212,6 +1239,162 @@ static void destroy_ai(struct ubi_attach_info *ai)
 	kfree(ai);
 }
 
+/*
+ * Depth of the header read-ahead pipeline. A handful of PEBs is enough to
+ * keep the flash busy while the attaching thread chews on CRCs and RB-trees.
+ */
+#define SCAN_PIPE_DEPTH 8
+
+/**
+ * struct scan_pipe - header read-ahead pipeline for full scanning.
+ * @ubi: UBI device description object
+ * @thread: the read-ahead thread
+ * @wq: wait queue on which the two threads meet
+ * @head: number of the PEB after the last one which has been read
+ * @tail: number of the PEB after the last one which has been processed
+ * @start: first PEB to read
+ * @slots: ring of per-PEB header buffers
+ *
+ * The read-ahead thread fills @slots in PEB order and advances @head, while
+ * the attaching thread consumes them in the same order and advances @tail.
+ * The distance between the two is bounded by %SCAN_PIPE_DEPTH, which is what
+ * makes the ring indexing safe.
+ */
+struct scan_pipe {
+	struct ubi_device *ubi;
+	struct task_struct *thread;
+	wait_queue_head_t wq;
+	int head;
+	int tail;
+	int start;
+	struct scan_slot slots[SCAN_PIPE_DEPTH];
+};
+
+/**
+ * scan_thread - body of the header read-ahead thread.
+ * @priv: the pipeline to fill
+ *
+ * This function reads the headers of the PEBs being attached into the
+ * pipeline ring, staying at most %SCAN_PIPE_DEPTH PEBs ahead of the
+ * attaching thread, so that on SMP the flash I/O overlaps with the CRC
+ * checking and RB-tree work done on the headers. Always returns zero.
+ */
+static int scan_thread(void *priv)
+{
+	struct scan_pipe *pipe = priv;
+	struct ubi_device *ubi = pipe->ubi;
+	int pnum;
+
+	for (pnum = pipe->start; pnum < ubi->peb_count; pnum++) {
+		struct scan_slot *sl = &pipe->slots[pnum % SCAN_PIPE_DEPTH];
+
+		wait_event(pipe->wq, kthread_should_stop() ||
+			   pnum - pipe->tail < SCAN_PIPE_DEPTH);
+		if (kthread_should_stop())
+			break;
+
+		sl->ec_ret = 0;
+		sl->vid_ret = 0;
+		sl->is_bad = ubi_io_is_bad(ubi, pnum);
+		if (!sl->is_bad) {
+			sl->ec_ret = ubi_io_read_ec_hdr(ubi, pnum, sl->ech, 0);
+			/*
+			 * 'scan_peb()' does not look at the VID header of bad,
+			 * empty or unreadable PEBs, so do not waste a read on
+			 * it.
+			 */
+			if (sl->ec_ret >= 0 && sl->ec_ret != UBI_IO_FF &&
+			    sl->ec_ret != UBI_IO_FF_BITFLIPS)
+				sl->vid_ret = ubi_io_read_vid_hdr(ubi, pnum,
+								  sl->vidh, 0);
+		}
+
+		/* Make the slot contents visible before advancing @head */
+		smp_wmb();
+		pipe->head = pnum + 1;
+		wake_up(&pipe->wq);
+	}
+
+	/* Do not exit before 'kthread_stop()' is called */
+	set_current_state(TASK_INTERRUPTIBLE);
+	while (!kthread_should_stop()) {
+		schedule();
+		set_current_state(TASK_INTERRUPTIBLE);
+	}
+	__set_current_state(TASK_RUNNING);
+	return 0;
+}
+
+/**
+ * scan_pipe_start - set up and start the header read-ahead pipeline.
+ * @ubi: UBI device description object
+ * @start: first PEB to read
+ *
+ * This function returns the running pipeline, or %NULL if it could not be
+ * set up, in which case the caller scans single-threaded as before -
+ * read-ahead is an optimization, not a requirement.
+ */
+static struct scan_pipe *scan_pipe_start(struct ubi_device *ubi, int start)
+{
+	struct scan_pipe *pipe;
+	int i;
+
+	if (num_online_cpus() < 2)
+		return NULL;
+
+	pipe = kzalloc(sizeof(struct scan_pipe), GFP_KERNEL);
+	if (!pipe)
+		return NULL;
+
+	pipe->ubi = ubi;
+	pipe->head = pipe->tail = pipe->start = start;
+	init_waitqueue_head(&pipe->wq);
+
+	for (i = 0; i < SCAN_PIPE_DEPTH; i++) {
+		struct scan_slot *sl = &pipe->slots[i];
+
+		sl->cached = 1;
+		sl->ech = kzalloc(ubi->ec_hdr_alsize, GFP_KERNEL);
+		sl->vidh = ubi_zalloc_vid_hdr(ubi, GFP_KERNEL);
+		if (!sl->ech || !sl->vidh)
+			goto out_free;
+	}
+
+	pipe->thread = kthread_run(scan_thread, pipe, "ubi_scan%d",
+				   ubi->ubi_num);
+	if (IS_ERR(pipe->thread))
+		goto out_free;
+
+	return pipe;
+
+out_free:
+	for (i = 0; i < SCAN_PIPE_DEPTH; i++) {
+		ubi_free_vid_hdr(ubi, pipe->slots[i].vidh);
+		kfree(pipe->slots[i].ech);
+	}
+	kfree(pipe);
+	return NULL;
+}
+
+/**
+ * scan_pipe_stop - stop the header read-ahead pipeline and free it.
+ * @pipe: the pipeline to stop, may be %NULL
+ */
+static void scan_pipe_stop(struct scan_pipe *pipe)
+{
+	int i;
+
+	if (!pipe)
+		return;
+
+	kthread_stop(pipe->thread);
+	for (i = 0; i < SCAN_PIPE_DEPTH; i++) {
+		ubi_free_vid_hdr(pipe->ubi, pipe->slots[i].vidh);
+		kfree(pipe->slots[i].ech);
+	}
+	kfree(pipe);
+}
+
 /**
  * scan_all - scan entire MTD device.
  * @ubi: UBI device description object
@@ -1229,6 +1412,8 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 	struct rb_node *rb1, *rb2;
 	struct ubi_ainf_volume *av;
 	struct ubi_ainf_peb *aeb;
+	struct scan_pipe *pipe;
+	struct scan_slot sl;
 
 	err = -ENOMEM;
 
@@ -1240,15 +1425,38 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 	if (!vidh)
 		goto out_ech;
 
+	sl.ech = ech;
+	sl.vidh = vidh;
+	sl.cached = 0;
+
+	pipe = scan_pipe_start(ubi, start);
+
 	for (pnum = start; pnum < ubi->peb_count; pnum++) {
+		struct scan_slot *slp = &sl;
+
 		cond_resched();
 
+		if (pipe) {
+			wait_event(pipe->wq, pipe->head > pnum);
+			/* Pairs with the barrier in 'scan_thread()' */
+			smp_rmb();
+			slp = &pipe->slots[pnum % SCAN_PIPE_DEPTH];
+		}
+
 		dbg_gen("process PEB %d", pnum);
-		err = scan_peb(ubi, ai, pnum, NULL, NULL);
+		err = scan_peb(ubi, ai, pnum, NULL, NULL, slp);
 		if (err < 0)
-			goto out_vidh;
+			goto out_pipe;
+
+		if (pipe) {
+			pipe->tail = pnum + 1;
+			wake_up(&pipe->wq);
+		}
 	}
 
+	scan_pipe_stop(pipe);
+	pipe = NULL;
+
 	ubi_msg("scanning is finished");
 
 	/* Calculate mean erase counter */
@@ -1291,6 +1499,8 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 
 	return 0;
 
+out_pipe:
+	scan_pipe_stop(pipe);
 out_vidh:
 	ubi_free_vid_hdr(ubi, vidh);
 out_ech:
@@ -1314,6 +1524,7 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info *ai)
 {
 	int err, pnum, fm_anchor = -1;
 	unsigned long long max_sqnum = 0;
+	struct scan_slot sl;
 
 	err = -ENOMEM;
 
@@ -1325,13 +1536,17 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info *ai)
 	if (!vidh)
 		goto out_ech;
 
+	sl.ech = ech;
+	sl.vidh = vidh;
+	sl.cached = 0;
+
 	for (pnum = 0; pnum < UBI_FM_MAX_START; pnum++) {
 		int vol_id = -1;
 		unsigned long long sqnum = -1;
 		cond_resched();
 
 		dbg_gen("process PEB %d", pnum);
-		err = scan_peb(ubi, ai, pnum, &vol_id, &sqnum);
+		err = scan_peb(ubi, ai, pnum, &vol_id, &sqnum, &sl);
 		if (err < 0)
 			goto out_vidh;
 
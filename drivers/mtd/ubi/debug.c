@@ -350,6 +350,35 @@ out:
 	return count;
 }
 
+/* Read handler for the wl_stats debugfs file */
+static ssize_t dfs_wl_stats_read(struct file *file, char __user *user_buf,
+				 size_t count, loff_t *ppos)
+{
+	unsigned long ubi_num = (unsigned long)file->private_data;
+	struct ubi_device *ubi;
+	char buf[128];
+	int len;
+
+	ubi = ubi_get_device(ubi_num);
+	if (!ubi)
+		return -ENODEV;
+
+	len = snprintf(buf, sizeof(buf),
+		       "deferred %lu\nforced %lu\nbusy_work_ms %u\n",
+		       ubi->wl_deferred_cnt, ubi->wl_forced_cnt,
+		       jiffies_to_msecs(ubi->wl_work_time));
+	ubi_put_device(ubi);
+
+	return simple_read_from_buffer(user_buf, count, ppos, buf, len);
+}
+
+static const struct file_operations dfs_wl_stats_fops = {
+	.read   = dfs_wl_stats_read,
+	.open	= simple_open,
+	.llseek = no_llseek,
+	.owner  = THIS_MODULE,
+};
+
 /* File operations for all UBI debugfs files */
 static const struct file_operations dfs_fops = {
 	.read   = dfs_file_read,
@@ -427,6 +456,13 @@ int ubi_debugfs_init_dev(struct ubi_device *ubi)
 		goto out_remove;
 	d->dfs_emulate_io_failures = dent;
 
+	fname = "wl_stats";
+	dent = debugfs_create_file(fname, S_IRUSR, d->dfs_dir, (void *)ubi_num,
+				   &dfs_wl_stats_fops);
+	if (IS_ERR_OR_NULL(dent))
+		goto out_remove;
+	d->dfs_wl_stats = dent;
+
 	return 0;
 
 out_remove:
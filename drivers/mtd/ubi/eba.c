@@ -329,6 +329,9 @@ int ubi_eba_unmap_leb(struct ubi_device *ubi, struct ubi_volume *vol,
 	if (ubi->ro_mode)
 		return -EROFS;
 
+	/* let the WL sub-system know foreground I/O is active */
+	ubi->wl_last_fg_write = jiffies;
+
 	err = leb_write_lock(ubi, vol_id, lnum);
 	if (err)
 		return err;
@@ -603,6 +606,9 @@ int ubi_eba_write_leb(struct ubi_device *ubi, struct ubi_volume *vol, int lnum,
 	if (ubi->ro_mode)
 		return -EROFS;
 
+	/* let the WL sub-system know foreground I/O is active */
+	ubi->wl_last_fg_write = jiffies;
+
 	err = leb_write_lock(ubi, vol_id, lnum);
 	if (err)
 		return err;
@@ -735,6 +741,9 @@ int ubi_eba_write_leb_st(struct ubi_device *ubi, struct ubi_volume *vol,
 	if (ubi->ro_mode)
 		return -EROFS;
 
+	/* let the WL sub-system know foreground I/O is active */
+	ubi->wl_last_fg_write = jiffies;
+
 	if (lnum == used_ebs - 1)
 		/* If this is the last LEB @len may be unaligned */
 		len = ALIGN(data_size, ubi->min_io_size);
@@ -850,6 +859,9 @@ int ubi_eba_atomic_leb_change(struct ubi_device *ubi, struct ubi_volume *vol,
 	if (ubi->ro_mode)
 		return -EROFS;
 
+	/* let the WL sub-system know foreground I/O is active */
+	ubi->wl_last_fg_write = jiffies;
+
 	if (len == 0) {
 		/*
 		 * Special case when data length is zero. In this case the LEB
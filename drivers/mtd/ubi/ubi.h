@@ -363,6 +363,7 @@ struct ubi_wl_entry;
  * @dfs_disable_bgt: debugfs knob to disable the background task
  * @dfs_emulate_bitflips: debugfs knob to emulate bit-flips
  * @dfs_emulate_io_failures: debugfs knob to emulate write/erase failures
+ * @dfs_wl_stats: debugfs file showing wear-leveling deferral statistics
  */
 struct ubi_debug_info {
 	unsigned int chk_gen:1;
@@ -377,6 +378,7 @@ struct ubi_debug_info {
 	struct dentry *dfs_disable_bgt;
 	struct dentry *dfs_emulate_bitflips;
 	struct dentry *dfs_emulate_io_failures;
+	struct dentry *dfs_wl_stats;
 };
 
 /**
@@ -449,6 +451,12 @@ struct ubi_debug_info {
  * @move_to_put: if the "to" PEB was put
  * @works: list of pending works
  * @works_count: count of pending works
+ * @wl_last_fg_write: time (jiffies) of the last foreground LEB write
+ * @wl_deferred_cnt: how many times the background thread held off WL/scrub
+ *                   work because foreground I/O was active
+ * @wl_forced_cnt: how many WL/scrub moves ran while foreground I/O was
+ *                 active (deferral budget exhausted or explicit flush)
+ * @wl_work_time: total time (jiffies) spent in WL/scrub moves
  * @bgt_thread: background thread description object
  * @thread_enabled: if the background thread is enabled
  * @bgt_name: background thread name
@@ -551,6 +559,10 @@ struct ubi_device {
 	int move_to_put;
 	struct list_head works;
 	int works_count;
+	unsigned long wl_last_fg_write;
+	unsigned long wl_deferred_cnt;
+	unsigned long wl_forced_cnt;
+	unsigned long wl_work_time;
 	struct task_struct *bgt_thread;
 	int thread_enabled;
 	char bgt_name[sizeof(UBI_BGT_NAME_PATTERN)+2];
@@ -728,6 +740,9 @@ struct ubi_work {
 	int lnum;
 	int torture;
 	int anchor;
+	/* WL/scrub moves may be held back while foreground I/O is active */
+	int deferrable;
+	unsigned long deadline;
 };
 
 #include "debug.h"
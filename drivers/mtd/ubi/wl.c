@@ -134,6 +134,22 @@
  */
 #define WL_MAX_FAILURES 32
 
+/*
+ * Foreground-idleness gating for wear-leveling and scrubbing.  A WL or
+ * scrub move takes an erase plus a full PEB copy, which is long enough
+ * to show up as a commit latency spike when it lands in the middle of a
+ * foreground write burst.  The background thread therefore holds such
+ * moves back while a foreground LEB write happened within the last
+ * %UBI_WL_IDLE_PERIOD, and bursts them once the device goes idle.  So
+ * that wear-leveling cannot be starved forever on a permanently busy
+ * device, every deferrable work carries a deadline %UBI_WL_MAX_DEFER
+ * after scheduling, past which it runs regardless of foreground load.
+ * Erase works are never deferred - they produce the free PEBs
+ * foreground writes are waiting for.
+ */
+#define UBI_WL_IDLE_PERIOD	(HZ / 4)
+#define UBI_WL_MAX_DEFER	(10 * HZ)
+
 static int self_check_ec(struct ubi_device *ubi, int pnum, int ec);
 static int self_check_in_wl_tree(const struct ubi_device *ubi,
 				 struct ubi_wl_entry *e, struct rb_root *root);
@@ -219,6 +235,52 @@ static void wl_tree_add(struct ubi_wl_entry *e, struct rb_root *root)
  * This function returns zero in case of success and a negative error code in
  * case of failure.
  */
+/**
+ * wl_fg_idle - check whether foreground I/O has gone idle.
+ * @ubi: UBI device description object
+ *
+ * Returns non-zero if no foreground LEB write happened within the last
+ * %UBI_WL_IDLE_PERIOD.
+ */
+static int wl_fg_idle(const struct ubi_device *ubi)
+{
+	return time_after(jiffies, ubi->wl_last_fg_write + UBI_WL_IDLE_PERIOD);
+}
+
+/**
+ * wl_defer_work - decide whether the background thread should hold off.
+ * @ubi: UBI device description object
+ *
+ * Rotates deferrable WL/scrub works to the tail of the work queue while
+ * foreground I/O is active and their deadline has not passed, so that
+ * pending erase works behind them are not starved.  Returns non-zero if
+ * every queued work should be deferred, in which case the background
+ * thread waits for the device to go idle instead of calling do_work().
+ */
+static int wl_defer_work(struct ubi_device *ubi)
+{
+	struct ubi_work *wrk;
+	int rotated = 0, defer = 0;
+
+	if (wl_fg_idle(ubi))
+		return 0;
+
+	spin_lock(&ubi->wl_lock);
+	while (!list_empty(&ubi->works)) {
+		wrk = list_first_entry(&ubi->works, struct ubi_work, list);
+		if (!wrk->deferrable || time_after(jiffies, wrk->deadline))
+			break;
+		list_move_tail(&wrk->list, &ubi->works);
+		if (++rotated >= ubi->works_count) {
+			ubi->wl_deferred_cnt += 1;
+			defer = 1;
+			break;
+		}
+	}
+	spin_unlock(&ubi->wl_lock);
+	return defer;
+}
+
 static int do_work(struct ubi_device *ubi)
 {
 	int err;
@@ -249,9 +311,18 @@ static int do_work(struct ubi_device *ubi)
 	/*
 	 * Call the worker function. Do not touch the work structure
 	 * after this call as it will have been freed or reused by that
-	 * time by the worker function.
+	 * time by the worker function.  The WL statistics are only
+	 * rough indicators, so their unlocked updates are fine.
 	 */
-	err = wrk->func(ubi, wrk, 0);
+	if (wrk->deferrable) {
+		unsigned long start = jiffies;
+
+		if (!wl_fg_idle(ubi))
+			ubi->wl_forced_cnt += 1;
+		err = wrk->func(ubi, wrk, 0);
+		ubi->wl_work_time += jiffies - start;
+	} else
+		err = wrk->func(ubi, wrk, 0);
 	if (err)
 		ubi_err("work failed with error code %d", err);
 	up_read(&ubi->work_sem);
@@ -907,6 +978,7 @@ static int schedule_erase(struct ubi_device *ubi, struct ubi_wl_entry *e,
 	wl_wrk->vol_id = vol_id;
 	wl_wrk->lnum = lnum;
 	wl_wrk->torture = torture;
+	wl_wrk->deferrable = 0;
 
 	schedule_ubi_work(ubi, wl_wrk);
 	return 0;
@@ -1352,6 +1424,8 @@ static int ensure_wear_leveling(struct ubi_device *ubi, int nested)
 
 	wrk->anchor = 0;
 	wrk->func = &wear_leveling_worker;
+	wrk->deferrable = 1;
+	wrk->deadline = jiffies + UBI_WL_MAX_DEFER;
 	if (nested)
 		__schedule_ubi_work(ubi, wrk);
 	else
@@ -1393,6 +1467,8 @@ int ubi_ensure_anchor_pebs(struct ubi_device *ubi)
 
 	wrk->anchor = 1;
 	wrk->func = &wear_leveling_worker;
+	/* fastmap needs the anchor PEB now, do not hold this one back */
+	wrk->deferrable = 0;
 	schedule_ubi_work(ubi, wrk);
 	return 0;
 }
@@ -1814,6 +1890,16 @@ int ubi_thread(void *u)
 		}
 		spin_unlock(&ubi->wl_lock);
 
+		if (wl_defer_work(ubi)) {
+			/*
+			 * Only WL/scrub moves are pending and foreground
+			 * I/O is active - wait for the device to go idle.
+			 * New works wake us up early as usual.
+			 */
+			schedule_timeout_interruptible(UBI_WL_IDLE_PERIOD);
+			continue;
+		}
+
 		err = do_work(ubi);
 		if (err) {
 			ubi_err("%s: work failed with error code %d",
@@ -330,6 +330,7 @@ struct cdmac_bd {
 struct temac_local {
 	struct net_device *ndev;
 	struct device *dev;
+	struct napi_struct napi;
 
 	/* Connection to PHY device */
 	struct phy_device *phy_dev;	/* Pointer to PHY device */
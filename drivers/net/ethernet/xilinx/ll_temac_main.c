@@ -56,6 +56,23 @@
 #define TX_BD_NUM   64
 #define RX_BD_NUM   128
 
+#define TEMAC_NAPI_WEIGHT	64
+
+/* Channel control values, interrupt enables split out so the RX poll
+ * loop can mask packet interrupts while it runs */
+#define TX_CHNL_CTRL_VAL	(0x10220400 |		\
+				 CHNL_CTRL_IRQ_EN |	\
+				 CHNL_CTRL_IRQ_DLY_EN |	\
+				 CHNL_CTRL_IRQ_COAL_EN)
+#define RX_CHNL_CTRL_VAL	(0xff070000 |		\
+				 CHNL_CTRL_IRQ_EN |	\
+				 CHNL_CTRL_IRQ_DLY_EN |	\
+				 CHNL_CTRL_IRQ_COAL_EN |\
+				 CHNL_CTRL_IRQ_IOE)
+#define RX_CHNL_CTRL_MASKED	(RX_CHNL_CTRL_VAL &	\
+				 ~(CHNL_CTRL_IRQ_DLY_EN |\
+				   CHNL_CTRL_IRQ_COAL_EN))
+
 /* ---------------------------------------------------------------------
  * Low level register access functions
  */
@@ -288,17 +305,10 @@ static int temac_dma_bd_init(struct net_device *ndev)
 		lp->rx_bd_v[i].app0 = STS_CTRL_APP0_IRQONEND;
 	}
 
-	lp->dma_out(lp, TX_CHNL_CTRL, 0x10220400 |
-					  CHNL_CTRL_IRQ_EN |
-					  CHNL_CTRL_IRQ_DLY_EN |
-					  CHNL_CTRL_IRQ_COAL_EN);
+	lp->dma_out(lp, TX_CHNL_CTRL, TX_CHNL_CTRL_VAL);
 	/* 0x10220483 */
 	/* 0x00100483 */
-	lp->dma_out(lp, RX_CHNL_CTRL, 0xff070000 |
-					  CHNL_CTRL_IRQ_EN |
-					  CHNL_CTRL_IRQ_DLY_EN |
-					  CHNL_CTRL_IRQ_COAL_EN |
-					  CHNL_CTRL_IRQ_IOE);
+	lp->dma_out(lp, RX_CHNL_CTRL, RX_CHNL_CTRL_VAL);
 	/* 0xff010283 */
 
 	lp->dma_out(lp, RX_CURDESC_PTR,  lp->rx_bd_p);
@@ -741,23 +751,24 @@ static int temac_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 }
 
 
-static void ll_temac_recv(struct net_device *ndev)
+/*
+ * The RX ring is touched only from the NAPI poll loop, which
+ * serializes itself, so no locking is needed here.
+ */
+static int ll_temac_recv(struct net_device *ndev, int budget)
 {
 	struct temac_local *lp = netdev_priv(ndev);
 	struct sk_buff *skb, *new_skb;
 	unsigned int bdstat;
 	struct cdmac_bd *cur_p;
-	dma_addr_t tail_p;
+	dma_addr_t tail_p = 0;
 	int length;
-	unsigned long flags;
-
-	spin_lock_irqsave(&lp->rx_lock, flags);
+	int work_done = 0;
 
-	tail_p = lp->rx_bd_p + sizeof(*lp->rx_bd_v) * lp->rx_bd_ci;
 	cur_p = &lp->rx_bd_v[lp->rx_bd_ci];
 
 	bdstat = cur_p->app0;
-	while ((bdstat & STS_CTRL_APP0_CMPLT)) {
+	while ((bdstat & STS_CTRL_APP0_CMPLT) && work_done < budget) {
 
 		skb = lp->rx_skb[lp->rx_bd_ci];
 		length = cur_p->app4 & 0x3FFF;
@@ -779,18 +790,18 @@ static void ll_temac_recv(struct net_device *ndev)
 		}
 
 		if (!skb_defer_rx_timestamp(skb))
-			netif_rx(skb);
+			netif_receive_skb(skb);
 
 		ndev->stats.rx_packets++;
 		ndev->stats.rx_bytes += length;
+		work_done++;
 
 		new_skb = netdev_alloc_skb_ip_align(ndev,
 						XTE_MAX_JUMBO_FRAME_SIZE);
 
 		if (new_skb == 0) {
 			dev_err(&ndev->dev, "no memory for new sk_buff\n");
-			spin_unlock_irqrestore(&lp->rx_lock, flags);
-			return;
+			break;
 		}
 
 		cur_p->app0 = STS_CTRL_APP0_IRQONEND;
@@ -800,6 +811,10 @@ static void ll_temac_recv(struct net_device *ndev)
 		cur_p->len = XTE_MAX_JUMBO_FRAME_SIZE;
 		lp->rx_skb[lp->rx_bd_ci] = new_skb;
 
+		/* The refilled BDs are handed back to the hardware in
+		 * one batch, below the loop */
+		tail_p = lp->rx_bd_p + sizeof(*lp->rx_bd_v) * lp->rx_bd_ci;
+
 		lp->rx_bd_ci++;
 		if (lp->rx_bd_ci >= RX_BD_NUM)
 			lp->rx_bd_ci = 0;
@@ -807,9 +822,30 @@ static void ll_temac_recv(struct net_device *ndev)
 		cur_p = &lp->rx_bd_v[lp->rx_bd_ci];
 		bdstat = cur_p->app0;
 	}
-	lp->dma_out(lp, RX_TAILDESC_PTR, tail_p);
+	if (tail_p)
+		lp->dma_out(lp, RX_TAILDESC_PTR, tail_p);
 
-	spin_unlock_irqrestore(&lp->rx_lock, flags);
+	return work_done;
+}
+
+static int ll_temac_poll(struct napi_struct *napi, int budget)
+{
+	struct temac_local *lp = container_of(napi, struct temac_local, napi);
+	int work_done;
+
+	work_done = ll_temac_recv(lp->ndev, budget);
+
+	if (work_done < budget) {
+		napi_complete(napi);
+		/* Re-enable packet interrupts, then pick up anything
+		 * that slipped in while they were masked */
+		lp->dma_out(lp, RX_CHNL_CTRL, RX_CHNL_CTRL_VAL);
+		if ((lp->rx_bd_v[lp->rx_bd_ci].app0 & STS_CTRL_APP0_CMPLT) &&
+		    napi_reschedule(napi))
+			lp->dma_out(lp, RX_CHNL_CTRL, RX_CHNL_CTRL_MASKED);
+	}
+
+	return work_done;
 }
 
 static irqreturn_t ll_temac_tx_irq(int irq, void *_ndev)
@@ -839,8 +875,12 @@ static irqreturn_t ll_temac_rx_irq(int irq, void *_ndev)
 	status = lp->dma_in(lp, RX_IRQ_REG);
 	lp->dma_out(lp, RX_IRQ_REG, status);
 
-	if (status & (IRQ_COAL | IRQ_DLY))
-		ll_temac_recv(lp->ndev);
+	if ((status & (IRQ_COAL | IRQ_DLY)) &&
+	    napi_schedule_prep(&lp->napi)) {
+		/* Mask packet interrupts until the poll loop is done */
+		lp->dma_out(lp, RX_CHNL_CTRL, RX_CHNL_CTRL_MASKED);
+		__napi_schedule(&lp->napi);
+	}
 
 	return IRQ_HANDLED;
 }
@@ -865,6 +905,8 @@ static int temac_open(struct net_device *ndev)
 
 	temac_device_reset(ndev);
 
+	napi_enable(&lp->napi);
+
 	rc = request_irq(lp->tx_irq, ll_temac_tx_irq, 0, ndev->name, ndev);
 	if (rc)
 		goto err_tx_irq;
@@ -877,6 +919,7 @@ static int temac_open(struct net_device *ndev)
  err_rx_irq:
 	free_irq(lp->tx_irq, ndev);
  err_tx_irq:
+	napi_disable(&lp->napi);
 	if (lp->phy_dev)
 		phy_disconnect(lp->phy_dev);
 	lp->phy_dev = NULL;
@@ -893,6 +936,8 @@ static int temac_stop(struct net_device *ndev)
 	free_irq(lp->tx_irq, ndev);
 	free_irq(lp->rx_irq, ndev);
 
+	napi_disable(&lp->napi);
+
 	if (lp->phy_dev)
 		phy_disconnect(lp->phy_dev);
 	lp->phy_dev = NULL;
@@ -1042,6 +1087,7 @@ static int temac_of_probe(struct platform_device *op)
 	lp->options = XTE_OPTION_DEFAULTS;
 	spin_lock_init(&lp->rx_lock);
 	mutex_init(&lp->indirect_mutex);
+	netif_napi_add(ndev, &lp->napi, ll_temac_poll, TEMAC_NAPI_WEIGHT);
 
 	/* map device registers */
 	lp->regs = of_iomap(op->dev.of_node, 0);
@@ -13,6 +13,7 @@
 #include <linux/spinlock.h>
 #include <linux/interrupt.h>
 #include <linux/if_vlan.h>
+#include <linux/xilinx_bdring.h>
 
 /* Packet size info */
 #define XAE_HDR_SIZE			14 /* Size of Ethernet header */
@@ -402,6 +403,8 @@ struct axidma_bd {
  * @options:	AxiEthernet option word
  * @last_link:	Phy link state in which the PHY was negotiated earlier
  * @features:	Stores the extended features supported by the axienet hw
+ * @tx_ring:	Shared BD-ring library state of the Tx descriptor ring
+ * @rx_ring:	Shared BD-ring library state of the Rx descriptor ring
  * @tx_bd_v:	Virtual address of the TX buffer descriptor ring
  * @tx_bd_p:	Physical address(start address) of the TX buffer descr. ring
  * @rx_bd_v:	Virtual address of the RX buffer descriptor ring
@@ -413,6 +416,22 @@ struct axidma_bd {
  *		completed.
  * @rx_bd_ci:	Stores the index of the Rx buffer descriptor in the ring being
  *		accessed currently.
+ * @tx_bd_num:	Number of BDs in the Tx ring. Configurable with ethtool -G
+ *		while the interface is down.
+ * @rx_bd_num:	Number of BDs in the Rx ring. Configurable with ethtool -G
+ *		while the interface is down.
+ * @napi:	NAPI instance for the interrupt-driven Rx path. Completed
+ *		frames are handed up with napi_gro_receive so GRO can
+ *		coalesce TCP segments before they hit the stack.
+ * @rx_busy_poll: When set the Rx interrupt is masked and completed Rx BDs
+ *		  are reaped by a spinning kernel thread instead. Set with
+ *		  the rx-busy-poll ethtool private flag.
+ * @rx_poll_thread: Busy-polling thread, only valid while @rx_busy_poll is
+ *		    set on a running interface.
+ * @txreq_skb:	skb whose DMA mapping is cached for the pktgen requeue
+ *		fast path, NULL when nothing is cached.
+ * @txreq_mapping: cached DMA address of the linear data of @txreq_skb
+ * @txreq_len:	mapped length of @txreq_skb
  * @max_frm_size: Stores the maximum size of the frame that can be that
  *		  Txed/Rxed in the existing hardware. If jumbo option is
  *		  supported, the maximum frame size would be 9k. Else it is
@@ -447,7 +466,12 @@ struct axienet_local {
 	u32 last_link;
 	u32 features;
 
-	/* Buffer descriptors */
+	/* Buffer descriptors. The rings are owned by the shared BD-ring
+	 * library; tx_bd_v/tx_bd_p and rx_bd_v/rx_bd_p are views of the
+	 * ring memory for the data path.
+	 */
+	struct xilinx_bdring tx_ring;
+	struct xilinx_bdring rx_ring;
 	struct axidma_bd *tx_bd_v;
 	dma_addr_t tx_bd_p;
 	struct axidma_bd *rx_bd_v;
@@ -455,6 +479,30 @@ struct axienet_local {
 	u32 tx_bd_ci;
 	u32 tx_bd_tail;
 	u32 rx_bd_ci;
+	u32 tx_bd_num;
+	u32 rx_bd_num;
+
+	struct napi_struct napi;
+
+	u32 rx_busy_poll;
+	struct task_struct *rx_poll_thread;
+
+	/* Software multicast filter, used when the groups outnumber the
+	 * four-entry frame filter CAM. The MAC then runs promiscuous and
+	 * the Rx path drops multicast frames whose CRC hash misses
+	 * mc_hash before they are handed to the stack.
+	 */
+	bool mc_sw_filter;
+	u64 mc_hash;
+	u64 rx_mc_filtered;
+
+	/* Cached DMA state for the pktgen requeue fast path. Valid only
+	 * between consecutive ndo_tx_requeue calls; any regular transmit
+	 * invalidates it.
+	 */
+	struct sk_buff *txreq_skb;
+	dma_addr_t txreq_mapping;
+	u32 txreq_len;
 
 	u32 max_frm_size;
 	u32 rxmem;
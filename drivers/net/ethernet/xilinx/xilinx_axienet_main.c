@@ -23,6 +23,7 @@
 #include <linux/delay.h>
 #include <linux/etherdevice.h>
 #include <linux/init.h>
+#include <linux/kthread.h>
 #include <linux/module.h>
 #include <linux/netdevice.h>
 #include <linux/of_mdio.h>
@@ -40,6 +41,16 @@
 #define TX_BD_NUM		64
 #define RX_BD_NUM		128
 
+/* Limits for the ring sizes set at runtime with ethtool -G */
+#define MIN_BD_NUM		32
+#define MAX_BD_NUM		1024
+
+/* Completed TX skbs gathered per dev_kfree_skb_irq_bulk() flush */
+#define XAXIENET_TX_FREE_BATCH	32
+
+/* NAPI budget for the interrupt-driven Rx path */
+#define XAXIENET_NAPI_WEIGHT	64
+
 /* Must be shorter than length of ethtool_drvinfo.driver field to fit */
 #define DRIVER_NAME		"xaxienet"
 #define DRIVER_DESCRIPTION	"Xilinx Axi Ethernet driver"
@@ -154,25 +165,21 @@ static void axienet_dma_bd_release(struct net_device *ndev)
 	int i;
 	struct axienet_local *lp = netdev_priv(ndev);
 
-	for (i = 0; i < RX_BD_NUM; i++) {
-		dma_unmap_single(ndev->dev.parent, lp->rx_bd_v[i].phys,
-				 lp->max_frm_size, DMA_FROM_DEVICE);
-		dev_kfree_skb((struct sk_buff *)
-			      (lp->rx_bd_v[i].sw_id_offset));
-	}
-
 	if (lp->rx_bd_v) {
-		dma_free_coherent(ndev->dev.parent,
-				  sizeof(*lp->rx_bd_v) * RX_BD_NUM,
-				  lp->rx_bd_v,
-				  lp->rx_bd_p);
-	}
-	if (lp->tx_bd_v) {
-		dma_free_coherent(ndev->dev.parent,
-				  sizeof(*lp->tx_bd_v) * TX_BD_NUM,
-				  lp->tx_bd_v,
-				  lp->tx_bd_p);
+		for (i = 0; i < lp->rx_bd_num; i++) {
+			if (!lp->rx_bd_v[i].sw_id_offset)
+				continue;
+			dma_unmap_single(ndev->dev.parent, lp->rx_bd_v[i].phys,
+					 lp->max_frm_size, DMA_FROM_DEVICE);
+			dev_kfree_skb((struct sk_buff *)
+				      (lp->rx_bd_v[i].sw_id_offset));
+		}
 	}
+
+	xilinx_bdring_destroy(&lp->rx_ring);
+	xilinx_bdring_destroy(&lp->tx_ring);
+	lp->rx_bd_v = NULL;
+	lp->tx_bd_v = NULL;
 }
 
 /**
@@ -199,39 +206,28 @@ static int axienet_dma_bd_init(struct net_device *ndev)
 	lp->rx_bd_ci = 0;
 
 	/* Allocate the Tx and Rx buffer descriptors */
-	lp->tx_bd_v = dma_alloc_coherent(ndev->dev.parent,
-					 sizeof(*lp->tx_bd_v) * TX_BD_NUM,
-					 &lp->tx_bd_p,
-					 GFP_KERNEL);
-	if (!lp->tx_bd_v) {
+	if (xilinx_bdring_create(&lp->tx_ring, ndev->dev.parent,
+				 sizeof(*lp->tx_bd_v), lp->tx_bd_num, false)) {
 		dev_err(&ndev->dev,
 			"unable to allocate DMA Tx buffer descriptors");
 		goto out;
 	}
+	lp->tx_bd_v = lp->tx_ring.bd_v;
+	lp->tx_bd_p = lp->tx_ring.bd_p;
 
-	lp->rx_bd_v = dma_alloc_coherent(ndev->dev.parent,
-					 sizeof(*lp->rx_bd_v) * RX_BD_NUM,
-					 &lp->rx_bd_p,
-					 GFP_KERNEL);
-	if (!lp->rx_bd_v) {
+	if (xilinx_bdring_create(&lp->rx_ring, ndev->dev.parent,
+				 sizeof(*lp->rx_bd_v), lp->rx_bd_num, false)) {
 		dev_err(&ndev->dev,
 			"unable to allocate DMA Rx buffer descriptors");
 		goto out;
 	}
+	lp->rx_bd_v = lp->rx_ring.bd_v;
+	lp->rx_bd_p = lp->rx_ring.bd_p;
 
-	memset(lp->tx_bd_v, 0, sizeof(*lp->tx_bd_v) * TX_BD_NUM);
-	for (i = 0; i < TX_BD_NUM; i++) {
-		lp->tx_bd_v[i].next = lp->tx_bd_p +
-				      sizeof(*lp->tx_bd_v) *
-				      ((i + 1) % TX_BD_NUM);
-	}
-
-	memset(lp->rx_bd_v, 0, sizeof(*lp->rx_bd_v) * RX_BD_NUM);
-	for (i = 0; i < RX_BD_NUM; i++) {
-		lp->rx_bd_v[i].next = lp->rx_bd_p +
-				      sizeof(*lp->rx_bd_v) *
-				      ((i + 1) % RX_BD_NUM);
+	xilinx_bdring_link(&lp->tx_ring, offsetof(struct axidma_bd, next));
+	xilinx_bdring_link(&lp->rx_ring, offsetof(struct axidma_bd, next));
 
+	for (i = 0; i < lp->rx_bd_num; i++) {
 		skb = netdev_alloc_skb_ip_align(ndev, lp->max_frm_size);
 		if (!skb) {
 			dev_err(&ndev->dev, "alloc_skb error %d\n", i);
@@ -280,7 +276,7 @@ static int axienet_dma_bd_init(struct net_device *ndev)
 	axienet_dma_out32(lp, XAXIDMA_RX_CR_OFFSET,
 			  cr | XAXIDMA_CR_RUNSTOP_MASK);
 	axienet_dma_out32(lp, XAXIDMA_RX_TDESC_OFFSET, lp->rx_bd_p +
-			  (sizeof(*lp->rx_bd_v) * (RX_BD_NUM - 1)));
+			  (sizeof(*lp->rx_bd_v) * (lp->rx_bd_num - 1)));
 
 	/* Write to the RS (Run-stop) bit in the Tx channel control register.
 	 * Tx channel is now ready to run. But only after we write to the
@@ -355,32 +351,39 @@ static int netdev_set_mac_address(struct net_device *ndev, void *p)
  * goes into the net_device_ops structure entry ndo_set_multicast_list. This
  * means whenever the multicast table entries need to be updated this
  * function gets called.
+ *
+ * When the four CAM entries do not suffice the hardware is put into
+ * promiscuous mode and the Rx path filters by a hash of the joined
+ * groups instead, so IFF_PROMISC is only reported when actually
+ * requested.
  */
 static void axienet_set_multicast_list(struct net_device *ndev)
 {
-	int i;
+	int i = 0;
 	u32 reg, af0reg, af1reg;
 	struct axienet_local *lp = netdev_priv(ndev);
-
-	if (ndev->flags & (IFF_ALLMULTI | IFF_PROMISC) ||
-	    netdev_mc_count(ndev) > XAE_MULTICAST_CAM_TABLE_NUM) {
-		/* We must make the kernel realize we had to move into
-		 * promiscuous mode. If it was a promiscuous mode request
-		 * the flag is already set. If not we set it.
+	bool promisc = false;
+	bool sw_filter = false;
+	u64 hash = 0;
+
+	if (ndev->flags & (IFF_ALLMULTI | IFF_PROMISC)) {
+		promisc = true;
+	} else if (netdev_mc_count(ndev) > XAE_MULTICAST_CAM_TABLE_NUM) {
+		/* More groups than CAM entries. The frame filter has no
+		 * hardware hash, so the MAC must run promiscuous, but a
+		 * CRC hash of the joined groups lets the Rx path drop
+		 * the foreign multicast flood before it costs anything.
 		 */
-		ndev->flags |= IFF_PROMISC;
-		reg = axienet_ior(lp, XAE_FMI_OFFSET);
-		reg |= XAE_FMI_PM_MASK;
-		axienet_iow(lp, XAE_FMI_OFFSET, reg);
-		dev_info(&ndev->dev, "Promiscuous mode enabled.\n");
+		struct netdev_hw_addr *ha;
+
+		netdev_for_each_mc_addr(ha, ndev)
+			hash |= 1ULL << (ether_crc(ETH_ALEN, ha->addr) >> 26);
+		promisc = true;
+		sw_filter = true;
 	} else if (!netdev_mc_empty(ndev)) {
 		struct netdev_hw_addr *ha;
 
-		i = 0;
 		netdev_for_each_mc_addr(ha, ndev) {
-			if (i >= XAE_MULTICAST_CAM_TABLE_NUM)
-				break;
-
 			af0reg = (ha->addr[0]);
 			af0reg |= (ha->addr[1] << 8);
 			af0reg |= (ha->addr[2] << 16);
@@ -397,23 +400,29 @@ static void axienet_set_multicast_list(struct net_device *ndev)
 			axienet_iow(lp, XAE_AF1_OFFSET, af1reg);
 			i++;
 		}
-	} else {
-		reg = axienet_ior(lp, XAE_FMI_OFFSET);
-		reg &= ~XAE_FMI_PM_MASK;
+	}
 
-		axienet_iow(lp, XAE_FMI_OFFSET, reg);
+	/* Clear any stale CAM entries */
+	for (; i < XAE_MULTICAST_CAM_TABLE_NUM; i++) {
+		reg = axienet_ior(lp, XAE_FMI_OFFSET) & 0xFFFFFF00;
+		reg |= i;
 
-		for (i = 0; i < XAE_MULTICAST_CAM_TABLE_NUM; i++) {
-			reg = axienet_ior(lp, XAE_FMI_OFFSET) & 0xFFFFFF00;
-			reg |= i;
+		axienet_iow(lp, XAE_FMI_OFFSET, reg);
+		axienet_iow(lp, XAE_AF0_OFFSET, 0);
+		axienet_iow(lp, XAE_AF1_OFFSET, 0);
+	}
 
-			axienet_iow(lp, XAE_FMI_OFFSET, reg);
-			axienet_iow(lp, XAE_AF0_OFFSET, 0);
-			axienet_iow(lp, XAE_AF1_OFFSET, 0);
-		}
+	/* Publish the hash before the Rx path starts consulting it */
+	lp->mc_hash = hash;
+	wmb();
+	lp->mc_sw_filter = sw_filter;
 
-		dev_info(&ndev->dev, "Promiscuous mode disabled.\n");
-	}
+	reg = axienet_ior(lp, XAE_FMI_OFFSET);
+	if (promisc)
+		reg |= XAE_FMI_PM_MASK;
+	else
+		reg &= ~XAE_FMI_PM_MASK;
+	axienet_iow(lp, XAE_FMI_OFFSET, reg);
 }
 
 /**
@@ -601,15 +610,31 @@ static void axienet_start_xmit_done(struct net_device *ndev)
 	struct axienet_local *lp = netdev_priv(ndev);
 	struct axidma_bd *cur_p;
 	unsigned int status = 0;
+	struct sk_buff *skb_batch[XAXIENET_TX_FREE_BATCH];
+	unsigned int skb_count = 0;
 
 	cur_p = &lp->tx_bd_v[lp->tx_bd_ci];
 	status = cur_p->status;
 	while (status & XAXIDMA_BD_STS_COMPLETE_MASK) {
-		dma_unmap_single(ndev->dev.parent, cur_p->phys,
-				(cur_p->cntrl & XAXIDMA_BD_CTRL_LENGTH_MASK),
-				DMA_TO_DEVICE);
-		if (cur_p->app4)
-			dev_kfree_skb_irq((struct sk_buff *)cur_p->app4);
+		if (cur_p->app3)
+			cur_p->app3 = 0; /* mapping is cached for requeue */
+		else
+			dma_unmap_single(ndev->dev.parent, cur_p->phys,
+					(cur_p->cntrl &
+					 XAXIDMA_BD_CTRL_LENGTH_MASK),
+					DMA_TO_DEVICE);
+		/*
+		 * Completed skbs are handed to the completion queue as
+		 * one batch when the loop is done, rather than taking
+		 * the queue splice cost once per packet.
+		 */
+		if (cur_p->app4) {
+			skb_batch[skb_count++] = (struct sk_buff *)cur_p->app4;
+			if (skb_count == XAXIENET_TX_FREE_BATCH) {
+				dev_kfree_skb_irq_bulk(skb_batch, skb_count);
+				skb_count = 0;
+			}
+		}
 		/*cur_p->phys = 0;*/
 		cur_p->app0 = 0;
 		cur_p->app1 = 0;
@@ -621,11 +646,14 @@ static void axienet_start_xmit_done(struct net_device *ndev)
 		packets++;
 
 		++lp->tx_bd_ci;
-		lp->tx_bd_ci %= TX_BD_NUM;
+		lp->tx_bd_ci %= lp->tx_bd_num;
 		cur_p = &lp->tx_bd_v[lp->tx_bd_ci];
 		status = cur_p->status;
 	}
 
+	if (skb_count)
+		dev_kfree_skb_irq_bulk(skb_batch, skb_count);
+
 	ndev->stats.tx_packets += packets;
 	ndev->stats.tx_bytes += size;
 	netif_wake_queue(ndev);
@@ -648,7 +676,7 @@ static inline int axienet_check_tx_bd_space(struct axienet_local *lp,
 					    int num_frag)
 {
 	struct axidma_bd *cur_p;
-	cur_p = &lp->tx_bd_v[(lp->tx_bd_tail + num_frag) % TX_BD_NUM];
+	cur_p = &lp->tx_bd_v[(lp->tx_bd_tail + num_frag) % lp->tx_bd_num];
 	if (cur_p->status & XAXIDMA_BD_STS_ALL_MASK)
 		return NETDEV_TX_BUSY;
 	return 0;
@@ -687,6 +715,16 @@ static int axienet_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 		return NETDEV_TX_BUSY;
 	}
 
+	/* A regular transmit invalidates the requeue mapping cache so a
+	 * recycled skb address can never alias a stale mapping. The
+	 * generator drains the ring before switching payloads.
+	 */
+	if (unlikely(lp->txreq_skb)) {
+		dma_unmap_single(ndev->dev.parent, lp->txreq_mapping,
+				 lp->txreq_len, DMA_TO_DEVICE);
+		lp->txreq_skb = NULL;
+	}
+
 	if (skb->ip_summed == CHECKSUM_PARTIAL) {
 		if (lp->features & XAE_FEATURE_FULL_TX_CSUM) {
 			/* Tx Full Checksum Offload Enabled */
@@ -708,7 +746,7 @@ static int axienet_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 
 	for (ii = 0; ii < num_frag; ii++) {
 		++lp->tx_bd_tail;
-		lp->tx_bd_tail %= TX_BD_NUM;
+		lp->tx_bd_tail %= lp->tx_bd_num;
 		cur_p = &lp->tx_bd_v[lp->tx_bd_tail];
 		frag = &skb_shinfo(skb)->frags[ii];
 		cur_p->phys = dma_map_single(ndev->dev.parent,
@@ -727,26 +765,93 @@ static int axienet_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 	/* Start the transfer */
 	axienet_dma_out32(lp, XAXIDMA_TX_TDESC_OFFSET, tail_p);
 	++lp->tx_bd_tail;
-	lp->tx_bd_tail %= TX_BD_NUM;
+	lp->tx_bd_tail %= lp->tx_bd_num;
+
+	return NETDEV_TX_OK;
+}
+
+/**
+ * axienet_tx_requeue - Resend a previously transmitted, unmodified skb.
+ * @skb:	sk_buff pointer that contains data to be Txed.
+ * @ndev:	Pointer to net_device structure.
+ *
+ * returns: NETDEV_TX_OK, on success
+ *	    NETDEV_TX_BUSY, if the descriptor ring is full
+ *
+ * pktgen fast path: the payload was cleaned to memory when the buffer was
+ * first mapped and has not been touched since, so requeueing it is reduced
+ * to filling one BD and advancing the tail pointer - no DMA mapping or
+ * cache maintenance per packet. The BD's app3 word flags the cached
+ * mapping so completion does not unmap it. Non-linear skbs and frames
+ * wanting checksum offload take the regular transmit routine.
+ */
+static int axienet_tx_requeue(struct sk_buff *skb, struct net_device *ndev)
+{
+	dma_addr_t tail_p;
+	struct axienet_local *lp = netdev_priv(ndev);
+	struct axidma_bd *cur_p;
+
+	if (skb_shinfo(skb)->nr_frags || skb->ip_summed == CHECKSUM_PARTIAL)
+		return axienet_start_xmit(skb, ndev);
+
+	if (axienet_check_tx_bd_space(lp, 0)) {
+		if (!netif_queue_stopped(ndev))
+			netif_stop_queue(ndev);
+		return NETDEV_TX_BUSY;
+	}
+
+	if (lp->txreq_skb != skb) {
+		/* First pass for this buffer, map it once. The generator
+		 * sent it through the regular transmit routine before, so
+		 * a stale mapping cannot be cached here.
+		 */
+		lp->txreq_len = skb_headlen(skb);
+		lp->txreq_mapping = dma_map_single(ndev->dev.parent,
+						   skb->data, lp->txreq_len,
+						   DMA_TO_DEVICE);
+		lp->txreq_skb = skb;
+	}
+
+	cur_p = &lp->tx_bd_v[lp->tx_bd_tail];
+	cur_p->phys = lp->txreq_mapping;
+	cur_p->cntrl = lp->txreq_len | XAXIDMA_BD_CTRL_TXSOF_MASK |
+		       XAXIDMA_BD_CTRL_TXEOF_MASK;
+	cur_p->app3 = 1;
+	cur_p->app4 = (unsigned long)skb;
+
+	tail_p = lp->tx_bd_p + sizeof(*lp->tx_bd_v) * lp->tx_bd_tail;
+	wmb();
+
+	/* Start the transfer */
+	axienet_dma_out32(lp, XAXIDMA_TX_TDESC_OFFSET, tail_p);
+	++lp->tx_bd_tail;
+	lp->tx_bd_tail %= lp->tx_bd_num;
 
 	return NETDEV_TX_OK;
 }
 
 /**
- * axienet_recv - Is called from Axi DMA Rx Isr to complete the received
- *		  BD processing.
+ * axienet_recv - Complete received BD processing.
  * @ndev:	Pointer to net_device structure.
+ * @budget:	Maximum number of BDs to process before returning.
+ *
+ * returns: Number of BDs processed.
  *
- * This function is invoked from the Axi DMA Rx isr to process the Rx BDs. It
- * does minimal processing and invokes "netif_rx" to complete further
- * processing.
+ * This function is invoked from the NAPI poll routine to process the Rx BDs.
+ * Completed frames are handed up with "napi_gro_receive" so GRO can coalesce
+ * TCP segments before they traverse the stack. In busy-poll mode it is
+ * instead invoked from the Rx polling thread with bottom halves disabled and
+ * hands completed frames straight to the protocol layers with
+ * "netif_receive_skb"; GRO is skipped there because the thread never enters
+ * napi_complete and held segments would linger.
  */
-static void axienet_recv(struct net_device *ndev)
+static int axienet_recv(struct net_device *ndev, int budget)
 {
 	u32 length;
 	u32 csumstatus;
 	u32 size = 0;
-	u32 packets = 0;
+	int packets = 0;
+	int dropped = 0;
 	dma_addr_t tail_p = 0;
 	struct axienet_local *lp = netdev_priv(ndev);
 	struct sk_buff *skb, *new_skb;
@@ -755,7 +860,8 @@ static void axienet_recv(struct net_device *ndev)
 	rmb();
 	cur_p = &lp->rx_bd_v[lp->rx_bd_ci];
 
-	while ((cur_p->status & XAXIDMA_BD_STS_COMPLETE_MASK)) {
+	while ((cur_p->status & XAXIDMA_BD_STS_COMPLETE_MASK) &&
+	       (packets + dropped < budget)) {
 		tail_p = lp->rx_bd_p + sizeof(*lp->rx_bd_v) * lp->rx_bd_ci;
 		skb = (struct sk_buff *) (cur_p->sw_id_offset);
 		length = cur_p->app4 & 0x0000FFFF;
@@ -764,6 +870,33 @@ static void axienet_recv(struct net_device *ndev)
 				 lp->max_frm_size,
 				 DMA_FROM_DEVICE);
 
+		/* Drop foreign multicast early when the CAM overflowed
+		 * and the MAC runs promiscuous. The untouched skb goes
+		 * straight back into the ring, so the flood costs one
+		 * hash check instead of an skb round trip through the
+		 * stack.
+		 */
+		if (lp->mc_sw_filter &&
+		    is_multicast_ether_addr(skb->data) &&
+		    !is_broadcast_ether_addr(skb->data) &&
+		    !(lp->mc_hash &
+		      (1ULL << (ether_crc(ETH_ALEN, skb->data) >> 26)))) {
+			lp->rx_mc_filtered++;
+			dropped++;
+
+			cur_p->phys = dma_map_single(ndev->dev.parent,
+						     skb->data,
+						     lp->max_frm_size,
+						     DMA_FROM_DEVICE);
+			cur_p->cntrl = lp->max_frm_size;
+			cur_p->status = 0;
+
+			++lp->rx_bd_ci;
+			lp->rx_bd_ci %= lp->rx_bd_num;
+			cur_p = &lp->rx_bd_v[lp->rx_bd_ci];
+			continue;
+		}
+
 		skb_put(skb, length);
 		skb->protocol = eth_type_trans(skb, ndev);
 		/*skb_checksum_none_assert(skb);*/
@@ -784,7 +917,10 @@ static void axienet_recv(struct net_device *ndev)
 			skb->ip_summed = CHECKSUM_COMPLETE;
 		}
 
-		netif_rx(skb);
+		if (lp->rx_busy_poll)
+			netif_receive_skb(skb);
+		else
+			napi_gro_receive(&lp->napi, skb);
 
 		size += length;
 		packets++;
@@ -792,7 +928,7 @@ static void axienet_recv(struct net_device *ndev)
 		new_skb = netdev_alloc_skb_ip_align(ndev, lp->max_frm_size);
 		if (!new_skb) {
 			dev_err(&ndev->dev, "no memory for new sk_buff\n");
-			return;
+			return packets;
 		}
 		cur_p->phys = dma_map_single(ndev->dev.parent, new_skb->data,
 					     lp->max_frm_size,
@@ -802,7 +938,7 @@ static void axienet_recv(struct net_device *ndev)
 		cur_p->sw_id_offset = (u32) new_skb;
 
 		++lp->rx_bd_ci;
-		lp->rx_bd_ci %= RX_BD_NUM;
+		lp->rx_bd_ci %= lp->rx_bd_num;
 		cur_p = &lp->rx_bd_v[lp->rx_bd_ci];
 	}
 
@@ -811,6 +947,40 @@ static void axienet_recv(struct net_device *ndev)
 
 	if (tail_p)
 		axienet_dma_out32(lp, XAXIDMA_RX_TDESC_OFFSET, tail_p);
+
+	return packets + dropped;
+}
+
+/**
+ * axienet_rx_napi_poll - NAPI poll routine for the Rx path.
+ * @napi:	Pointer to the NAPI instance embedded in axienet_local
+ * @budget:	NAPI budget
+ *
+ * returns: Number of BDs processed.
+ *
+ * Reaps up to @budget completed Rx BDs. When the ring is drained before the
+ * budget is exhausted, polling is completed and the Rx interrupt unmasked.
+ * A BD that completes in the window before the unmask sets its bit in the
+ * DMA status register, so re-enabling the interrupt raises it immediately
+ * and no completion is lost.
+ */
+static int axienet_rx_napi_poll(struct napi_struct *napi, int budget)
+{
+	struct axienet_local *lp = container_of(napi, struct axienet_local,
+						napi);
+	int work_done;
+	u32 cr;
+
+	work_done = axienet_recv(lp->ndev, budget);
+
+	if (work_done < budget) {
+		napi_complete(napi);
+		cr = axienet_dma_in32(lp, XAXIDMA_RX_CR_OFFSET);
+		cr |= (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_DELAY_MASK);
+		axienet_dma_out32(lp, XAXIDMA_RX_CR_OFFSET, cr);
+	}
+
+	return work_done;
 }
 
 /**
@@ -869,8 +1039,8 @@ out:
  *
  * returns: IRQ_HANDLED for all cases.
  *
- * This is the Axi DMA Rx Isr. It invokes "axienet_recv" to complete the BD
- * processing.
+ * This is the Axi DMA Rx Isr. It masks the Rx completion interrupts and
+ * schedules NAPI; the BDs are reaped in "axienet_rx_napi_poll".
  */
 static irqreturn_t axienet_rx_irq(int irq, void *_ndev)
 {
@@ -882,7 +1052,10 @@ static irqreturn_t axienet_rx_irq(int irq, void *_ndev)
 	status = axienet_dma_in32(lp, XAXIDMA_RX_SR_OFFSET);
 	if (status & (XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_DELAY_MASK)) {
 		axienet_dma_out32(lp, XAXIDMA_RX_SR_OFFSET, status);
-		axienet_recv(lp->ndev);
+		cr = axienet_dma_in32(lp, XAXIDMA_RX_CR_OFFSET);
+		cr &= ~(XAXIDMA_IRQ_IOC_MASK | XAXIDMA_IRQ_DELAY_MASK);
+		axienet_dma_out32(lp, XAXIDMA_RX_CR_OFFSET, cr);
+		napi_schedule(&lp->napi);
 		goto out;
 	}
 	if (!(status & XAXIDMA_IRQ_ALL_MASK))
@@ -913,6 +1086,80 @@ out:
 
 static void axienet_dma_err_handler(unsigned long data);
 
+/**
+ * axienet_rx_poll_thread - Busy-poll the Rx BD ring.
+ * @data:	Pointer to net_device structure
+ *
+ * returns: Always returns 0.
+ *
+ * Kernel thread that replaces the Rx interrupt while the rx-busy-poll
+ * ethtool private flag is set. It spins on the Rx BD ring and reaps
+ * completed BDs as soon as the DMA engine posts them, saving the IRQ and
+ * NET_RX softirq hops of the interrupt path. The thread burns one CPU;
+ * it is meant for dedicated low-latency ports only.
+ */
+static int axienet_rx_poll_thread(void *data)
+{
+	struct net_device *ndev = data;
+	struct axienet_local *lp = netdev_priv(ndev);
+
+	while (!kthread_should_stop()) {
+		local_bh_disable();
+		axienet_recv(ndev, lp->rx_bd_num);
+		local_bh_enable();
+		cond_resched();
+	}
+	return 0;
+}
+
+/**
+ * axienet_rx_busy_poll_start - Switch Rx processing to the polling thread.
+ * @ndev:	Pointer to net_device structure
+ *
+ * returns: 0, on success.
+ *	    non-zero error value on failure to start the thread.
+ *
+ * Masks the Rx interrupt and starts the busy-polling thread. Called with
+ * the rtnl lock held, either when the rx-busy-poll flag is set on a
+ * running interface or from axienet_open when the flag was set earlier.
+ */
+static int axienet_rx_busy_poll_start(struct net_device *ndev)
+{
+	struct axienet_local *lp = netdev_priv(ndev);
+	struct task_struct *thread;
+
+	thread = kthread_create(axienet_rx_poll_thread, ndev, "%s_rx_poll",
+				ndev->name);
+	if (IS_ERR(thread))
+		return PTR_ERR(thread);
+
+	disable_irq(lp->rx_irq);
+	/* Wait out a NAPI poll the masked interrupt may have scheduled, so
+	 * the thread is the only context touching the Rx BD ring.
+	 */
+	napi_disable(&lp->napi);
+	lp->rx_poll_thread = thread;
+	wake_up_process(thread);
+	return 0;
+}
+
+/**
+ * axienet_rx_busy_poll_stop - Switch Rx processing back to the interrupt.
+ * @ndev:	Pointer to net_device structure
+ *
+ * Stops the busy-polling thread and unmasks the Rx interrupt. Any BDs
+ * completed in between are picked up by the pending interrupt.
+ */
+static void axienet_rx_busy_poll_stop(struct net_device *ndev)
+{
+	struct axienet_local *lp = netdev_priv(ndev);
+
+	kthread_stop(lp->rx_poll_thread);
+	lp->rx_poll_thread = NULL;
+	napi_enable(&lp->napi);
+	enable_irq(lp->rx_irq);
+}
+
 /**
  * axienet_open - Driver open routine.
  * @ndev:	Pointer to net_device structure
@@ -972,6 +1219,8 @@ static int axienet_open(struct net_device *ndev)
 	tasklet_init(&lp->dma_err_tasklet, axienet_dma_err_handler,
 		     (unsigned long) lp);
 
+	napi_enable(&lp->napi);
+
 	/* Enable interrupts for Axi DMA Tx */
 	ret = request_irq(lp->tx_irq, axienet_tx_irq, 0, ndev->name, ndev);
 	if (ret)
@@ -981,11 +1230,20 @@ static int axienet_open(struct net_device *ndev)
 	if (ret)
 		goto err_rx_irq;
 
+	if (lp->rx_busy_poll) {
+		ret = axienet_rx_busy_poll_start(ndev);
+		if (ret)
+			goto err_rx_poll;
+	}
+
 	return 0;
 
+err_rx_poll:
+	free_irq(lp->rx_irq, ndev);
 err_rx_irq:
 	free_irq(lp->tx_irq, ndev);
 err_tx_irq:
+	napi_disable(&lp->napi);
 	if (lp->phy_dev)
 		phy_disconnect(lp->phy_dev);
 	lp->phy_dev = NULL;
@@ -1020,6 +1278,11 @@ static int axienet_stop(struct net_device *ndev)
 	axienet_setoptions(ndev, lp->options &
 			   ~(XAE_OPTION_TXEN | XAE_OPTION_RXEN));
 
+	if (lp->rx_poll_thread)
+		axienet_rx_busy_poll_stop(ndev);
+
+	napi_disable(&lp->napi);
+
 	tasklet_kill(&lp->dma_err_tasklet);
 
 	free_irq(lp->tx_irq, ndev);
@@ -1029,6 +1292,12 @@ static int axienet_stop(struct net_device *ndev)
 		phy_disconnect(lp->phy_dev);
 	lp->phy_dev = NULL;
 
+	if (lp->txreq_skb) {
+		dma_unmap_single(ndev->dev.parent, lp->txreq_mapping,
+				 lp->txreq_len, DMA_TO_DEVICE);
+		lp->txreq_skb = NULL;
+	}
+
 	axienet_dma_bd_release(ndev);
 	return 0;
 }
@@ -1038,19 +1307,20 @@ static int axienet_stop(struct net_device *ndev)
  * @ndev:	Pointer to net_device structure
  * @new_mtu:	New mtu value to be applied
  *
- * returns: Always returns 0 (success).
+ * returns: 0 on success, -EINVAL if the new mtu cannot be supported by the
+ *	    hardware.
  *
  * This is the change mtu driver routine. It checks if the Axi Ethernet
- * hardware supports jumbo frames before changing the mtu. This can be
- * called only when the device is not up.
+ * hardware supports jumbo frames before changing the mtu. On a running
+ * interface the hardware is quiesced, the Rx buffers are re-provisioned
+ * for the new frame size and the interface is restarted, so the mtu can
+ * be raised up to XAE_JUMBO_MTU without bringing the link down first.
  */
 static int axienet_change_mtu(struct net_device *ndev, int new_mtu)
 {
+	int mdio_mcreg;
 	struct axienet_local *lp = netdev_priv(ndev);
 
-	if (netif_running(ndev))
-		return -EBUSY;
-
 	if ((new_mtu + VLAN_ETH_HLEN +
 		XAE_TRL_SIZE) > lp->rxmem)
 		return -EINVAL;
@@ -1058,8 +1328,54 @@ static int axienet_change_mtu(struct net_device *ndev, int new_mtu)
 	if ((new_mtu > XAE_JUMBO_MTU) || (new_mtu < 64))
 		return -EINVAL;
 
+	if (!netif_running(ndev)) {
+		ndev->mtu = new_mtu;
+		return 0;
+	}
+
+	netif_stop_queue(ndev);
+	if (lp->rx_poll_thread)
+		axienet_rx_busy_poll_stop(ndev);
+	disable_irq(lp->tx_irq);
+	disable_irq(lp->rx_irq);
+	/* Drain any scheduled NAPI poll before the BD rings go away */
+	napi_disable(&lp->napi);
+
+	axienet_setoptions(ndev, lp->options &
+			   ~(XAE_OPTION_TXEN | XAE_OPTION_RXEN));
+
+	/* Disable the MDIO interface till the reset is completed, as done
+	 * in axienet_dma_err_handler. The Axi DMA reset resets the whole
+	 * Axi Ethernet core including the MDIO.
+	 */
+	mdio_mcreg = axienet_ior(lp, XAE_MDIO_MC_OFFSET);
+	axienet_mdio_wait_until_ready(lp);
+	axienet_iow(lp, XAE_MDIO_MC_OFFSET, (mdio_mcreg &
+		    ~XAE_MDIO_MC_MDIOEN_MASK));
+
+	/* Halt the DMA channels before pulling the BD rings from under
+	 * them, then rebuild the rings with Rx buffers sized for the new
+	 * mtu. axienet_device_reset recomputes max_frm_size and the jumbo
+	 * option from ndev->mtu before calling axienet_dma_bd_init.
+	 */
+	__axienet_device_reset(lp, &ndev->dev, XAXIDMA_TX_CR_OFFSET);
+	__axienet_device_reset(lp, &ndev->dev, XAXIDMA_RX_CR_OFFSET);
+	axienet_dma_bd_release(ndev);
+
 	ndev->mtu = new_mtu;
 
+	axienet_device_reset(ndev);
+
+	axienet_iow(lp, XAE_MDIO_MC_OFFSET, mdio_mcreg);
+	axienet_mdio_wait_until_ready(lp);
+
+	napi_enable(&lp->napi);
+	enable_irq(lp->tx_irq);
+	enable_irq(lp->rx_irq);
+	if (lp->rx_busy_poll)
+		axienet_rx_busy_poll_start(ndev);
+	netif_wake_queue(ndev);
+
 	return 0;
 }
 
@@ -1101,6 +1417,7 @@ static const struct net_device_ops axienet_netdev_ops = {
 	.ndo_open = axienet_open,
 	.ndo_stop = axienet_stop,
 	.ndo_start_xmit = axienet_start_xmit,
+	.ndo_tx_requeue = axienet_tx_requeue,
 	.ndo_change_mtu	= axienet_change_mtu,
 	.ndo_set_mac_address = netdev_set_mac_address,
 	.ndo_validate_addr = eth_validate_addr,
@@ -1368,6 +1685,182 @@ static int axienet_ethtools_set_coalesce(struct net_device *ndev,
 	return 0;
 }
 
+/**
+ * axienet_ethtools_get_ringparam - Get the BD ring sizes.
+ * @ndev:	Pointer to net_device structure
+ * @erp:	Pointer to ethtool_ringparam structure
+ *
+ * This implements ethtool command for getting the DMA BD ring sizes on Tx
+ * and Rx paths. Issue "ethtool -g ethX" under linux prompt to execute this
+ * function.
+ */
+static void axienet_ethtools_get_ringparam(struct net_device *ndev,
+					   struct ethtool_ringparam *erp)
+{
+	struct axienet_local *lp = netdev_priv(ndev);
+
+	memset(erp, 0, sizeof(struct ethtool_ringparam));
+	erp->rx_max_pending = MAX_BD_NUM;
+	erp->tx_max_pending = MAX_BD_NUM;
+	erp->rx_pending = lp->rx_bd_num;
+	erp->tx_pending = lp->tx_bd_num;
+}
+
+/**
+ * axienet_ethtools_set_ringparam - Set the BD ring sizes.
+ * @ndev:	Pointer to net_device structure
+ * @erp:	Pointer to ethtool_ringparam structure
+ *
+ * returns: 0 on success, -EFAULT if the interface is running, -EINVAL for
+ *	    a ring size out of range.
+ *
+ * This implements ethtool command for setting the DMA BD ring sizes on Tx
+ * and Rx paths. The rings are allocated when the interface is brought up,
+ * so the new sizes are recorded here and take effect on the next open.
+ * Issue "ethtool -G ethX rx N tx N" under linux prompt to execute this
+ * function.
+ */
+static int axienet_ethtools_set_ringparam(struct net_device *ndev,
+					  struct ethtool_ringparam *erp)
+{
+	struct axienet_local *lp = netdev_priv(ndev);
+
+	if (netif_running(ndev)) {
+		dev_err(&ndev->dev,
+			"%s: Please stop netif before applying configuration\n",
+			ndev->name);
+		return -EFAULT;
+	}
+
+	if (erp->rx_mini_pending || erp->rx_jumbo_pending)
+		return -EINVAL;
+	if ((erp->rx_pending < MIN_BD_NUM) ||
+	    (erp->rx_pending > MAX_BD_NUM) ||
+	    (erp->tx_pending < MIN_BD_NUM) ||
+	    (erp->tx_pending > MAX_BD_NUM))
+		return -EINVAL;
+
+	lp->rx_bd_num = erp->rx_pending;
+	lp->tx_bd_num = erp->tx_pending;
+
+	return 0;
+}
+
+#define AXIENET_PRIV_FLAG_RX_BUSY_POLL	(1 << 0)
+
+static const char axienet_priv_flags_strings[][ETH_GSTRING_LEN] = {
+	"rx-busy-poll",
+};
+
+static const char axienet_stat_strings[][ETH_GSTRING_LEN] = {
+	"rx_filtered_multicast",
+};
+
+static int axienet_ethtools_get_sset_count(struct net_device *ndev, int sset)
+{
+	switch (sset) {
+	case ETH_SS_PRIV_FLAGS:
+		return ARRAY_SIZE(axienet_priv_flags_strings);
+	case ETH_SS_STATS:
+		return ARRAY_SIZE(axienet_stat_strings);
+	default:
+		return -EOPNOTSUPP;
+	}
+}
+
+static void axienet_ethtools_get_strings(struct net_device *ndev, u32 sset,
+					 u8 *data)
+{
+	if (sset == ETH_SS_PRIV_FLAGS)
+		memcpy(data, axienet_priv_flags_strings,
+		       sizeof(axienet_priv_flags_strings));
+	else if (sset == ETH_SS_STATS)
+		memcpy(data, axienet_stat_strings,
+		       sizeof(axienet_stat_strings));
+}
+
+/**
+ * axienet_ethtools_get_ethtool_stats - Get the driver statistics.
+ * @ndev:	Pointer to net_device structure
+ * @stats:	Pointer to the ethtool stats structure
+ * @data:	Buffer to fill the counter values into
+ *
+ * Reports the number of multicast frames dropped by the software hash
+ * filter while the CAM was overcommitted. Issue "ethtool -S ethX"
+ * under linux prompt to execute this function.
+ */
+static void axienet_ethtools_get_ethtool_stats(struct net_device *ndev,
+					       struct ethtool_stats *stats,
+					       u64 *data)
+{
+	struct axienet_local *lp = netdev_priv(ndev);
+
+	data[0] = lp->rx_mc_filtered;
+}
+
+/**
+ * axienet_ethtools_get_priv_flags - Get the driver private flags.
+ * @ndev:	Pointer to net_device structure
+ *
+ * returns: The currently set private flags.
+ *
+ * This implements ethtool command for getting the driver private flags.
+ * Issue "ethtool --show-priv-flags ethX" under linux prompt to execute
+ * this function.
+ */
+static u32 axienet_ethtools_get_priv_flags(struct net_device *ndev)
+{
+	struct axienet_local *lp = netdev_priv(ndev);
+
+	return lp->rx_busy_poll ? AXIENET_PRIV_FLAG_RX_BUSY_POLL : 0;
+}
+
+/**
+ * axienet_ethtools_set_priv_flags - Set the driver private flags.
+ * @ndev:	Pointer to net_device structure
+ * @flags:	New private flag word
+ *
+ * returns: 0 on success, -EINVAL for an unknown flag, non-zero error value
+ *	    on failure to start the polling thread.
+ *
+ * This implements ethtool command for setting the driver private flags.
+ * Toggling rx-busy-poll on a running interface switches Rx BD processing
+ * between the interrupt handler and the busy-polling thread on the fly.
+ * Issue "ethtool --set-priv-flags ethX rx-busy-poll on" under linux
+ * prompt to execute this function.
+ */
+static int axienet_ethtools_set_priv_flags(struct net_device *ndev, u32 flags)
+{
+	struct axienet_local *lp = netdev_priv(ndev);
+	u32 enable = !!(flags & AXIENET_PRIV_FLAG_RX_BUSY_POLL);
+	int ret;
+
+	if (flags & ~AXIENET_PRIV_FLAG_RX_BUSY_POLL)
+		return -EINVAL;
+
+	if (enable == lp->rx_busy_poll)
+		return 0;
+
+	if (!netif_running(ndev)) {
+		lp->rx_busy_poll = enable;
+		return 0;
+	}
+
+	if (enable) {
+		lp->rx_busy_poll = 1;
+		ret = axienet_rx_busy_poll_start(ndev);
+		if (ret) {
+			lp->rx_busy_poll = 0;
+			return ret;
+		}
+	} else {
+		axienet_rx_busy_poll_stop(ndev);
+		lp->rx_busy_poll = 0;
+	}
+
+	return 0;
+}
+
 static struct ethtool_ops axienet_ethtool_ops = {
 	.get_settings   = axienet_ethtools_get_settings,
 	.set_settings   = axienet_ethtools_set_settings,
@@ -1379,6 +1872,13 @@ static struct ethtool_ops axienet_ethtool_ops = {
 	.set_pauseparam = axienet_ethtools_set_pauseparam,
 	.get_coalesce   = axienet_ethtools_get_coalesce,
 	.set_coalesce   = axienet_ethtools_set_coalesce,
+	.get_ringparam  = axienet_ethtools_get_ringparam,
+	.set_ringparam  = axienet_ethtools_set_ringparam,
+	.get_sset_count = axienet_ethtools_get_sset_count,
+	.get_strings    = axienet_ethtools_get_strings,
+	.get_ethtool_stats = axienet_ethtools_get_ethtool_stats,
+	.get_priv_flags = axienet_ethtools_get_priv_flags,
+	.set_priv_flags = axienet_ethtools_set_priv_flags,
 };
 
 /**
@@ -1415,9 +1915,12 @@ static void axienet_dma_err_handler(unsigned long data)
 	axienet_iow(lp, XAE_MDIO_MC_OFFSET, mdio_mcreg);
 	axienet_mdio_wait_until_ready(lp);
 
-	for (i = 0; i < TX_BD_NUM; i++) {
+	for (i = 0; i < lp->tx_bd_num; i++) {
 		cur_p = &lp->tx_bd_v[i];
-		if (cur_p->phys)
+		/* Cached requeue mappings (app3 set) are unmapped once when
+		 * the cache itself is dropped, not per descriptor.
+		 */
+		if (cur_p->phys && !cur_p->app3)
 			dma_unmap_single(ndev->dev.parent, cur_p->phys,
 					 (cur_p->cntrl &
 					  XAXIDMA_BD_CTRL_LENGTH_MASK),
@@ -1435,7 +1938,7 @@ static void axienet_dma_err_handler(unsigned long data)
 		cur_p->sw_id_offset = 0;
 	}
 
-	for (i = 0; i < RX_BD_NUM; i++) {
+	for (i = 0; i < lp->rx_bd_num; i++) {
 		cur_p = &lp->rx_bd_v[i];
 		cur_p->status = 0;
 		cur_p->app0 = 0;
@@ -1483,7 +1986,7 @@ static void axienet_dma_err_handler(unsigned long data)
 	axienet_dma_out32(lp, XAXIDMA_RX_CR_OFFSET,
 			  cr | XAXIDMA_CR_RUNSTOP_MASK);
 	axienet_dma_out32(lp, XAXIDMA_RX_TDESC_OFFSET, lp->rx_bd_p +
-			  (sizeof(*lp->rx_bd_v) * (RX_BD_NUM - 1)));
+			  (sizeof(*lp->rx_bd_v) * (lp->rx_bd_num - 1)));
 
 	/* Write to the RS (Run-stop) bit in the Tx channel control register.
 	 * Tx channel is now ready to run. But only after we write to the
@@ -1552,6 +2055,8 @@ static int axienet_of_probe(struct platform_device *op)
 	lp->ndev = ndev;
 	lp->dev = &op->dev;
 	lp->options = XAE_OPTION_DEFAULTS;
+	netif_napi_add(ndev, &lp->napi, axienet_rx_napi_poll,
+		       XAXIENET_NAPI_WEIGHT);
 	/* Map device registers */
 	lp->regs = of_iomap(op->dev.of_node, 0);
 	if (!lp->regs) {
@@ -1652,6 +2157,9 @@ static int axienet_of_probe(struct platform_device *op)
 	lp->coalesce_count_rx = XAXIDMA_DFT_RX_THRESHOLD;
 	lp->coalesce_count_tx = XAXIDMA_DFT_TX_THRESHOLD;
 
+	lp->tx_bd_num = TX_BD_NUM;
+	lp->rx_bd_num = RX_BD_NUM;
+
 	lp->phy_node = of_parse_phandle(op->dev.of_node, "phy-handle", 0);
 	if (lp->phy_node)
 		ret = axienet_mdio_setup(lp, op->dev.of_node);
@@ -10,6 +10,7 @@
 #include <linux/of_address.h>
 #include <linux/of_mdio.h>
 #include <linux/jiffies.h>
+#include <linux/delay.h>
 
 #include "xilinx_axienet.h"
 
@@ -31,6 +32,27 @@ int axienet_mdio_wait_until_ready(struct axienet_local *lp)
 	return 0;
 }
 
+/* Sleeping variant for the mii_bus accessors. These always run in
+ * process context with the MDIO bus mutex held, so unlike
+ * axienet_mdio_wait_until_ready() (also called from the DMA error
+ * tasklet) they can yield the CPU while the ~25 usec MDIO frame is on
+ * the wire instead of spinning on the ready bit.
+ */
+static int axienet_mdio_wait_ready_sleeping(struct axienet_local *lp)
+{
+	unsigned long end = jiffies + msecs_to_jiffies(20);
+
+	while (!(axienet_ior(lp, XAE_MDIO_MCR_OFFSET) &
+		 XAE_MDIO_MCR_READY_MASK)) {
+		if (time_after(jiffies, end)) {
+			WARN_ON(1);
+			return -ETIMEDOUT;
+		}
+		usleep_range(5, 20);
+	}
+	return 0;
+}
+
 /**
  * axienet_mdio_read - MDIO interface read function
  * @bus:	Pointer to mii bus structure
@@ -49,7 +71,7 @@ static int axienet_mdio_read(struct mii_bus *bus, int phy_id, int reg)
 	int ret;
 	struct axienet_local *lp = bus->priv;
 
-	ret = axienet_mdio_wait_until_ready(lp);
+	ret = axienet_mdio_wait_ready_sleeping(lp);
 	if (ret < 0)
 		return ret;
 
@@ -61,7 +83,7 @@ static int axienet_mdio_read(struct mii_bus *bus, int phy_id, int reg)
 		     XAE_MDIO_MCR_INITIATE_MASK |
 		     XAE_MDIO_MCR_OP_READ_MASK));
 
-	ret = axienet_mdio_wait_until_ready(lp);
+	ret = axienet_mdio_wait_ready_sleeping(lp);
 	if (ret < 0)
 		return ret;
 
@@ -95,7 +117,7 @@ static int axienet_mdio_write(struct mii_bus *bus, int phy_id, int reg,
 	dev_dbg(lp->dev, "axienet_mdio_write(phy_id=%i, reg=%x, val=%x)\n",
 		phy_id, reg, val);
 
-	ret = axienet_mdio_wait_until_ready(lp);
+	ret = axienet_mdio_wait_ready_sleeping(lp);
 	if (ret < 0)
 		return ret;
 
@@ -108,7 +130,7 @@ static int axienet_mdio_write(struct mii_bus *bus, int phy_id, int reg,
 		     XAE_MDIO_MCR_INITIATE_MASK |
 		     XAE_MDIO_MCR_OP_WRITE_MASK));
 
-	ret = axienet_mdio_wait_until_ready(lp);
+	ret = axienet_mdio_wait_ready_sleeping(lp);
 	if (ret < 0)
 		return ret;
 	return 0;
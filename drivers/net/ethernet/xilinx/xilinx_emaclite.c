@@ -99,6 +99,9 @@
 #define TX_TIMEOUT		(60*HZ)		/* Tx timeout is 60 seconds. */
 #define ALIGNMENT		4
 
+/* NAPI budget; with only two RX buffers the poll loop is short anyway */
+#define XEMACLITE_NAPI_WEIGHT	16
+
 /* BUFFER_ALIGN(adr) calculates the number of bytes to the next alignment. */
 #define BUFFER_ALIGN(adr) ((ALIGNMENT - ((u32) adr)) % ALIGNMENT)
 
@@ -113,6 +116,7 @@
 /**
  * struct net_local - Our private per device data
  * @ndev:		instance of the network device
+ * @napi:		NAPI context for the RX path
  * @tx_ping_pong:	indicates whether Tx Pong buffer is configured in HW
  * @rx_ping_pong:	indicates whether Rx Pong buffer is configured in HW
  * @next_tx_buf_to_use:	next Tx buffer to write to
@@ -131,6 +135,7 @@
 struct net_local {
 
 	struct net_device *ndev;
+	struct napi_struct napi;
 
 	bool tx_ping_pong;
 	bool rx_ping_pong;
@@ -244,6 +249,37 @@ static void xemaclite_disable_interrupts(struct net_local *drvdata)
 	}
 }
 
+/**
+ * xemaclite_set_rx_interrupts - Enable or disable just the Rx interrupts
+ * @drvdata:	Pointer to the Emaclite device private data
+ * @enable:	true to enable the Rx interrupts, false to disable them
+ *
+ * The NAPI poll loop masks only the receive interrupts while it runs so
+ * that Tx completions keep being delivered.
+ */
+static void xemaclite_set_rx_interrupts(struct net_local *drvdata, bool enable)
+{
+	u32 reg_data;
+
+	reg_data = in_be32(drvdata->base_addr + XEL_RSR_OFFSET);
+	if (enable)
+		reg_data |= XEL_RSR_RECV_IE_MASK;
+	else
+		reg_data &= ~XEL_RSR_RECV_IE_MASK;
+	out_be32(drvdata->base_addr + XEL_RSR_OFFSET, reg_data);
+
+	if (drvdata->rx_ping_pong != 0) {
+		reg_data = in_be32(drvdata->base_addr + XEL_BUFFER_OFFSET +
+				   XEL_RSR_OFFSET);
+		if (enable)
+			reg_data |= XEL_RSR_RECV_IE_MASK;
+		else
+			reg_data &= ~XEL_RSR_RECV_IE_MASK;
+		out_be32(drvdata->base_addr + XEL_BUFFER_OFFSET +
+			 XEL_RSR_OFFSET, reg_data);
+	}
+}
+
 /**
  * xemaclite_aligned_write - Write from 16-bit aligned to 32-bit aligned address
  * @src_ptr:	Void pointer to the 16-bit aligned source address
@@ -608,13 +644,18 @@ static void xemaclite_tx_handler(struct net_device *dev)
 }
 
 /**
- * xemaclite_rx_handler- Interrupt handler for frames received
+ * xemaclite_rx_handler- Receive one frame from the device
  * @dev:	Pointer to the network device
  *
  * This function allocates memory for a socket buffer, fills it with data
- * received and hands it over to the TCP/IP stack.
+ * received and hands it over to the TCP/IP stack. It is called from the
+ * NAPI poll loop, which alternates between the ping and pong buffer as
+ * long as frames are pending.
+ *
+ * Return:	true if a frame was passed up, false when no data was
+ *		available
  */
-static void xemaclite_rx_handler(struct net_device *dev)
+static bool xemaclite_rx_handler(struct net_device *dev)
 {
 	struct net_local *lp = netdev_priv(dev);
 	struct sk_buff *skb;
@@ -627,7 +668,7 @@ static void xemaclite_rx_handler(struct net_device *dev)
 		/* Couldn't get memory. */
 		dev->stats.rx_dropped++;
 		dev_err(&lp->ndev->dev, "Could not allocate receive buffer\n");
-		return;
+		return false;
 	}
 
 	/*
@@ -644,9 +685,8 @@ static void xemaclite_rx_handler(struct net_device *dev)
 	len = xemaclite_recv_data(lp, (u8 *) skb->data);
 
 	if (!len) {
-		dev->stats.rx_errors++;
-		dev_kfree_skb_irq(skb);
-		return;
+		dev_kfree_skb(skb);
+		return false;
 	}
 
 	skb_put(skb, len);	/* Tell the skb how much data we got */
@@ -658,7 +698,44 @@ static void xemaclite_rx_handler(struct net_device *dev)
 	dev->stats.rx_bytes += len;
 
 	if (!skb_defer_rx_timestamp(skb))
-		netif_rx(skb);	/* Send the packet upstream */
+		netif_receive_skb(skb);	/* Send the packet upstream */
+
+	return true;
+}
+
+/**
+ * xemaclite_poll - NAPI poll routine
+ * @napi:	Pointer to the NAPI structure
+ * @budget:	Maximum number of frames to process
+ *
+ * Drains the ping and pong receive buffers alternately until both are
+ * empty or the budget is spent, then re-enables the Rx interrupts and
+ * rechecks the buffers for frames that arrived while they were masked.
+ *
+ * Return:	Number of frames processed
+ */
+static int xemaclite_poll(struct napi_struct *napi, int budget)
+{
+	struct net_local *lp = container_of(napi, struct net_local, napi);
+	struct net_device *dev = lp->ndev;
+	int work_done = 0;
+
+	while (work_done < budget && xemaclite_rx_handler(dev))
+		work_done++;
+
+	if (work_done < budget) {
+		napi_complete(napi);
+		xemaclite_set_rx_interrupts(lp, true);
+		if (((in_be32(lp->base_addr + XEL_RSR_OFFSET) &
+				XEL_RSR_RECV_DONE_MASK) ||
+		     (in_be32(lp->base_addr + XEL_BUFFER_OFFSET +
+				XEL_RSR_OFFSET) &
+				XEL_RSR_RECV_DONE_MASK)) &&
+		    napi_reschedule(napi))
+			xemaclite_set_rx_interrupts(lp, false);
+	}
+
+	return work_done;
 }
 
 /**
@@ -680,9 +757,15 @@ static irqreturn_t xemaclite_interrupt(int irq, void *dev_id)
 	/* Check if there is Rx Data available */
 	if ((in_be32(base_addr + XEL_RSR_OFFSET) & XEL_RSR_RECV_DONE_MASK) ||
 			(in_be32(base_addr + XEL_BUFFER_OFFSET + XEL_RSR_OFFSET)
-			 & XEL_RSR_RECV_DONE_MASK))
+			 & XEL_RSR_RECV_DONE_MASK)) {
 
-		xemaclite_rx_handler(dev);
+		if (napi_schedule_prep(&lp->napi)) {
+			/* Mask the Rx interrupts until the poll loop is
+			 * done with both buffers */
+			xemaclite_set_rx_interrupts(lp, false);
+			__napi_schedule(&lp->napi);
+		}
+	}
 
 	/* Check if the Transmission for the first buffer is completed */
 	tx_status = in_be32(base_addr + XEL_TSR_OFFSET);
@@ -996,6 +1079,8 @@ static int xemaclite_open(struct net_device *dev)
 		return retval;
 	}
 
+	napi_enable(&lp->napi);
+
 	/* Enable Interrupts */
 	xemaclite_enable_interrupts(lp);
 
@@ -1020,6 +1105,7 @@ static int xemaclite_close(struct net_device *dev)
 	netif_stop_queue(dev);
 	xemaclite_disable_interrupts(lp);
 	free_irq(dev->irq, dev);
+	napi_disable(&lp->napi);
 
 	if (lp->phy_dev)
 		phy_disconnect(lp->phy_dev);
@@ -1192,6 +1278,7 @@ static int xemaclite_of_probe(struct platform_device *ofdev)
 	}
 
 	spin_lock_init(&lp->reset_lock);
+	netif_napi_add(ndev, &lp->napi, xemaclite_poll, XEMACLITE_NAPI_WEIGHT);
 	lp->next_tx_buf_to_use = 0x0;
 	lp->next_rx_buf_to_use = 0x0;
 	lp->tx_ping_pong = get_bool(ofdev, "xlnx,tx-ping-pong");
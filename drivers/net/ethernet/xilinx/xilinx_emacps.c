@@ -41,13 +41,24 @@
 #include <linux/of.h>
 #include <linux/interrupt.h>
 #include <linux/clocksource.h>
+#include <linux/math64.h>
 #include <linux/net_tstamp.h>
+#include <linux/ptp_clock_kernel.h>
 #include <linux/pm_runtime.h>
 #include <linux/clk.h>
 #include <linux/of_net.h>
 #include <linux/of_address.h>
 #include <linux/of_mdio.h>
 #include <linux/timer.h>
+#include <linux/hrtimer.h>
+#include <linux/completion.h>
+#include <linux/genalloc.h>
+#include <linux/zynq_ocm.h>
+#include <linux/prefetch.h>
+#include <linux/pkt_sched.h>
+
+#define CREATE_TRACE_POINTS
+#include <trace/events/xilinx_emacps.h>
 
 /************************** Constant Definitions *****************************/
 
@@ -77,6 +88,20 @@ MDC_DIV_64, MDC_DIV_96, MDC_DIV_128, MDC_DIV_224 };
 /* Specify the receive buffer size in bytes, 64, 128, 192, 10240 */
 #define XEMACPS_RX_BUF_SIZE		1536
 
+/* Frames at or below this size are copied into a right-sized skb and the
+ * DMA buffer stays armed in the ring, so small-frame bursts never touch
+ * the page allocator and do not pin full-size buffers.
+ */
+#define XEMACPS_RX_COPYBREAK		256
+
+/* Per-buffer allocation backing an RX BD: headroom and frame space for
+ * the GEM to DMA into, plus the trailing shared info build_skb() needs.
+ */
+#define XEMACPS_RX_FRAG_SIZE		(SKB_DATA_ALIGN(NET_SKB_PAD +	\
+						XEMACPS_RX_BUF_SIZE) +	\
+					SKB_DATA_ALIGN(sizeof(struct	\
+						skb_shared_info)))
+
 /* Number of receive buffer bytes as a unit, this is HW setup */
 #define XEMACPS_RX_BUF_UNIT		64
 
@@ -89,8 +114,18 @@ MDC_DIV_64, MDC_DIV_96, MDC_DIV_128, MDC_DIV_224 };
 #define XEMACPS_SEND_BD_CNT		256
 #define XEMACPS_RECV_BD_CNT		256
 
+/* Limits for the runtime ring sizes set with ethtool -G */
+#define XEMACPS_MIN_BD_CNT		32
+#define XEMACPS_MAX_BD_CNT		1024
+
 #define XEMACPS_NAPI_WEIGHT		64
 
+/* Completed TX skbs gathered per consume_skb_bulk() flush */
+#define XEMACPS_TX_FREE_BATCH		32
+
+/* Upper bound on RX interrupt mitigation delay, in microseconds */
+#define XEMACPS_COALESCE_USECS_MAX	1000
+
 /* Register offset definitions. Unless otherwise noted, register access is
  * 32 bit. Names are self explained here.
  */
@@ -124,6 +159,7 @@ MDC_DIV_64, MDC_DIV_96, MDC_DIV_128, MDC_DIV_224 };
 #define XEMACPS_MATCH2_OFFSET		0x000000AC /* Type ID2 Match reg */
 #define XEMACPS_MATCH3_OFFSET		0x000000B0 /* Type ID3 Match reg */
 #define XEMACPS_MATCH4_OFFSET		0x000000B4 /* Type ID4 Match reg */
+#define XEMACPS_NUM_TYPEID		4 /* Number of type ID matchers */
 #define XEMACPS_WOL_OFFSET		0x000000B8 /* Wake on LAN reg */
 #define XEMACPS_STRETCH_OFFSET		0x000000BC /* IPG Stretch reg */
 #define XEMACPS_SVLAN_OFFSET		0x000000C0 /* Stacked VLAN reg */
@@ -458,12 +494,32 @@ MDC_DIV_64, MDC_DIV_96, MDC_DIV_128, MDC_DIV_224 };
 #define XEMACPS_RXBUF_SOF_MASK		0x00004000 /* Start of frame. */
 #define XEMACPS_RXBUF_LEN_MASK		0x00003FFF /* Mask for length field */
 
+/* With RX checksum offload enabled the TypeID match bits instead report
+ * which checksums the GEM has verified on the incoming frame.
+ */
+#define XEMACPS_RXBUF_CSUM_MASK		0x00C00000 /* Checksum status */
+#define XEMACPS_RXBUF_CSUM_SHIFT	22
+#define XEMACPS_RXBUF_CSUM_IPHDR	1 /* IP header checked */
+#define XEMACPS_RXBUF_CSUM_TCP		2 /* IP header and TCP checked */
+#define XEMACPS_RXBUF_CSUM_UDP		3 /* IP header and UDP checked */
+
 #define XEMACPS_RXBUF_WRAP_MASK		0x00000002 /* Wrap bit, last BD */
 #define XEMACPS_RXBUF_NEW_MASK		0x00000001 /* Used bit.. */
 #define XEMACPS_RXBUF_ADD_MASK		0xFFFFFFFC /* Mask for address */
 
 #define XEAMCPS_GEN_PURPOSE_TIMER_LOAD	100 /* timeout value is msecs */
 
+/* Adaptive link speed thresholds, bytes per stats timer tick */
+#define XEMACPS_ECO_DOWN_THRESHOLD	(100 * 1024)
+#define XEMACPS_ECO_UP_THRESHOLD	(512 * 1024)
+/* Ticks below the threshold before downshifting (5 seconds) */
+#define XEMACPS_ECO_IDLE_TICKS		50
+
+static int ecolink;
+module_param(ecolink, int, 0);
+MODULE_PARM_DESC(ecolink,
+		 "Downshift idle links to 100 Mbit to save power (default 0)");
+
 #define XEMACPS_GMII2RGMII_SPEED1000_FD		0x140
 #define XEMACPS_GMII2RGMII_SPEED100_FD		0x2100
 #define XEMACPS_GMII2RGMII_SPEED10_FD		0x100
@@ -477,6 +533,10 @@ MDC_DIV_64, MDC_DIV_96, MDC_DIV_128, MDC_DIV_224 };
 #define NS_PER_SEC			1000000000ULL /* Nanoseconds per
 							second */
 #define PEEP_TSU_CLK			50000000ULL /* PTP TSU CLOCK */
+/* Fixed point shift of the cyclecounter; the TSU counts whole
+ * nanoseconds, so frequency slewing happens in the mult value
+ */
+#define XEMACPS_PTP_CC_SHIFT		31
 #endif
 
 #define xemacps_read(base, reg)						\
@@ -486,8 +546,11 @@ MDC_DIV_64, MDC_DIV_96, MDC_DIV_128, MDC_DIV_224 };
 
 struct ring_info {
 	struct sk_buff *skb;
+	void *frag;		/* page-frag RX buffer, RX ring only */
 	dma_addr_t mapping;
 	size_t len;
+	unsigned int mapped_as_page;
+	unsigned int persistent;	/* cached requeue mapping, no unmap */
 };
 
 /* DMA buffer descriptor structure. Each BD is two words */
@@ -498,6 +561,59 @@ struct xemacps_bd {
 
 
 /* Our private device data. */
+/*
+ * Logical indices of the hardware statistics counters, in register
+ * order from XEMACPS_OCTTXL_OFFSET to XEMACPS_RXUDPCCNT_OFFSET. The
+ * two 48-bit octet counters occupy one slot each even though they are
+ * split over two registers.
+ */
+enum xemacps_hw_stat {
+	XEMACPS_STAT_TXOCT,
+	XEMACPS_STAT_TXCNT,
+	XEMACPS_STAT_TXBCCNT,
+	XEMACPS_STAT_TXMCCNT,
+	XEMACPS_STAT_TXPAUSECNT,
+	XEMACPS_STAT_TX64CNT,
+	XEMACPS_STAT_TX65CNT,
+	XEMACPS_STAT_TX128CNT,
+	XEMACPS_STAT_TX256CNT,
+	XEMACPS_STAT_TX512CNT,
+	XEMACPS_STAT_TX1024CNT,
+	XEMACPS_STAT_TX1519CNT,
+	XEMACPS_STAT_TXURUNCNT,
+	XEMACPS_STAT_SNGLCOLLCNT,
+	XEMACPS_STAT_MULTICOLLCNT,
+	XEMACPS_STAT_EXCESSCOLLCNT,
+	XEMACPS_STAT_LATECOLLCNT,
+	XEMACPS_STAT_TXDEFERCNT,
+	XEMACPS_STAT_CSENSECNT,
+	XEMACPS_STAT_RXOCT,
+	XEMACPS_STAT_RXCNT,
+	XEMACPS_STAT_RXBROADCNT,
+	XEMACPS_STAT_RXMULTICNT,
+	XEMACPS_STAT_RXPAUSECNT,
+	XEMACPS_STAT_RX64CNT,
+	XEMACPS_STAT_RX65CNT,
+	XEMACPS_STAT_RX128CNT,
+	XEMACPS_STAT_RX256CNT,
+	XEMACPS_STAT_RX512CNT,
+	XEMACPS_STAT_RX1024CNT,
+	XEMACPS_STAT_RX1519CNT,
+	XEMACPS_STAT_RXUNDRCNT,
+	XEMACPS_STAT_RXOVRCNT,
+	XEMACPS_STAT_RXJABCNT,
+	XEMACPS_STAT_RXFCSCNT,
+	XEMACPS_STAT_RXLENGTHCNT,
+	XEMACPS_STAT_RXSYMBCNT,
+	XEMACPS_STAT_RXALIGNCNT,
+	XEMACPS_STAT_RXRESERRCNT,
+	XEMACPS_STAT_RXORCNT,
+	XEMACPS_STAT_RXIPCCNT,
+	XEMACPS_STAT_RXTCPCCNT,
+	XEMACPS_STAT_RXUDPCCNT,
+	XEMACPS_NUM_HW_STATS
+};
+
 struct net_local {
 	void __iomem *baseaddr;
 	struct clk *devclk;
@@ -515,32 +631,77 @@ struct net_local {
 	dma_addr_t rx_bd_dma; /* physical address */
 	dma_addr_t tx_bd_dma; /* physical address */
 
+	bool rx_bd_ocm; /* RX BD ring lives in OCM */
+	bool tx_bd_ocm; /* TX BD ring lives in OCM */
+
 	u32 tx_bd_ci;
 	u32 tx_bd_tail;
 	u32 rx_bd_ci;
 
 	u32 tx_bd_freecnt;
 
+	u32 rx_bd_count;
+	u32 tx_bd_count;
+
 	spinlock_t tx_lock;
 	spinlock_t rx_lock;
 	spinlock_t nwctrlreg_lock;
 
 	struct platform_device *pdev;
 	struct net_device *ndev; /* this device */
-	struct tasklet_struct tx_bdreclaim_tasklet;
 	struct workqueue_struct *txtimeout_handler_wq;
 	struct work_struct txtimeout_reinit;
 
 	struct napi_struct napi; /* napi information for device */
 	struct net_device_stats stats; /* Statistics for this device */
 
+	/* 64-bit accumulation of the clear-on-read hardware counters,
+	 * refilled from the stats timer before any register can wrap.
+	 * stats_lock serializes the timer against ethtool and
+	 * ndo_get_stats readers.
+	 */
+	u64 hw_stats[XEMACPS_NUM_HW_STATS];
+	spinlock_t stats_lock;
+
 	struct timer_list gen_purpose_timer; /* Used for stats update */
 
+	/* RX interrupt mitigation: when rx_coalesce_usecs is non-zero the
+	 * frame-received interrupt arms this timer instead of scheduling
+	 * NAPI directly, so a burst is handled by a single poll pass.
+	 */
+	struct hrtimer rx_coalesce_timer;
+	u32 rx_coalesce_usecs;
+
+	/* EtherType classification rules programmed into the GEM type ID
+	 * match registers via ethtool -N. Slot n drives MATCHn+1. Writers
+	 * hold the rtnl lock, the RX path only reads. A cleared register
+	 * never matches since EtherType 0 does not occur on the wire.
+	 */
+	u16 typeid_proto[XEMACPS_NUM_TYPEID]; /* host order */
+	u32 typeid_active; /* bitmap of slots in use */
+
+	/* Cached DMA state for the pktgen requeue fast path. Valid only
+	 * between consecutive ndo_tx_requeue calls; any regular transmit
+	 * invalidates it. Protected by tx_lock.
+	 */
+	struct sk_buff *txreq_skb;
+	dma_addr_t txreq_mapping;
+	size_t txreq_len;
+
 	/* Manage internal timer for packet timestamping */
 	struct cyclecounter cycles;
 	struct timecounter clock;
 	struct hwtstamp_config hwtstamp_config;
 
+	/* MDIO management-done signalling: once the MGMNT interrupt has
+	 * been unmasked (mdio_irq_on) the MDIO accessors sleep on
+	 * mdio_done instead of busy-polling the network status register.
+	 * The MII bus is scanned at probe time with interrupts still
+	 * masked, so the polling fallback must stay functional.
+	 */
+	struct completion mdio_done;
+	bool mdio_irq_on;
+
 	struct mii_bus *mii_bus;
 	struct phy_device *phy_dev;
 	struct phy_device *gmii2rgmii_phy_dev;
@@ -548,12 +709,27 @@ struct net_local {
 	unsigned int link;
 	unsigned int speed;
 	unsigned int duplex;
-	/* RX ip/tcp/udp checksum */
-	unsigned ip_summed;
 	unsigned int enetnum;
 	unsigned int lastrxfrmscntr;
+
+	/* Adaptive link speed: when enabled via the ecolink parameter the
+	 * stats timer downshifts the PHY advertisement to 100 Mbit after
+	 * a sustained idle period and restores the full advertisement on
+	 * traffic buildup; the transmit path requests an immediate
+	 * upshift when the ring fills up. The renegotiation itself runs
+	 * from eco_work since MDIO access sleeps.
+	 */
+	struct work_struct eco_work;
+	u32 eco_full_adv;	/* advertisement to restore on upshift */
+	int eco_down;		/* currently restricted to 100 Mbit */
+	int eco_idle_ticks;
+	unsigned long eco_last_bytes;
 #ifdef CONFIG_XILINX_PS_EMAC_HWTSTAMP
 	unsigned int ptpenetclk;
+	struct ptp_clock *ptp_clock;
+	struct ptp_clock_info ptp_caps;
+	spinlock_t tmreg_lock;
+	u32 ptp_nominal_mult;
 #endif
 };
 #define to_net_local(_nb)	container_of(_nb, struct net_local,\
@@ -561,6 +737,36 @@ struct net_local {
 
 static struct net_device_ops netdev_ops;
 
+/**
+ * xemacps_mdio_wait - wait for a PHY maintenance operation to finish
+ * @lp: local device instance pointer
+ * @return: 0 on completion, -ETIMEDOUT if the bus stays busy
+ *
+ * Sleeps on the management-done interrupt when it is unmasked and falls
+ * back to polling the network status register otherwise. Called with
+ * the MDIO bus mutex held, so sleeping is fine either way; the fallback
+ * yields the CPU between polls instead of spinning for the ~25 usecs a
+ * frame takes on the wire.
+ */
+static int xemacps_mdio_wait(struct net_local *lp)
+{
+	unsigned long timeout = jiffies + msecs_to_jiffies(100);
+
+	if (lp->mdio_irq_on &&
+	    wait_for_completion_timeout(&lp->mdio_done,
+					msecs_to_jiffies(100)))
+		return 0;
+
+	while (!(xemacps_read(lp->baseaddr, XEMACPS_NWSR_OFFSET) &
+			XEMACPS_NWSR_MDIOIDLE_MASK)) {
+		if (time_after(jiffies, timeout))
+			return -ETIMEDOUT;
+		usleep_range(10, 20);
+	}
+
+	return 0;
+}
+
 /**
  * xemacps_mdio_read - Read current value of phy register indicated by
  * phyreg.
@@ -579,20 +785,18 @@ static int xemacps_mdio_read(struct mii_bus *bus, int mii_id, int phyreg)
 	struct net_local *lp = bus->priv;
 	u32 regval;
 	int value;
-	volatile u32 ipisr;
 
 	regval  = XEMACPS_PHYMNTNC_OP_MASK;
 	regval |= XEMACPS_PHYMNTNC_OP_R_MASK;
 	regval |= (mii_id << XEMACPS_PHYMNTNC_PHYAD_SHIFT_MASK);
 	regval |= (phyreg << XEMACPS_PHYMNTNC_PHREG_SHIFT_MASK);
 
+	INIT_COMPLETION(lp->mdio_done);
 	xemacps_write(lp->baseaddr, XEMACPS_PHYMNTNC_OFFSET, regval);
 
 	/* wait for end of transfer */
-	do {
-		cpu_relax();
-		ipisr = xemacps_read(lp->baseaddr, XEMACPS_NWSR_OFFSET);
-	} while ((ipisr & XEMACPS_NWSR_MDIOIDLE_MASK) == 0);
+	if (xemacps_mdio_wait(lp))
+		return -ETIMEDOUT;
 
 	value = xemacps_read(lp->baseaddr, XEMACPS_PHYMNTNC_OFFSET) &
 			XEMACPS_PHYMNTNC_DATA_MASK;
@@ -607,7 +811,7 @@ static int xemacps_mdio_read(struct mii_bus *bus, int mii_id, int phyreg)
  * @mii_id: mii id
  * @phyreg: phy register to be configured.
  * @value: value to be written to phy register.
- * return 0. This API requires to be int type or compile warning generated
+ * return 0 on success, -ETIMEDOUT if the bus stays busy
  *
  * note: This is for 802.3 clause 22 phys access. For 802.3 clause 45 phys
  * access, set bit 30 to be 1. e.g. change XEMACPS_PHYMNTNC_OP_MASK to
@@ -618,7 +822,6 @@ static int xemacps_mdio_write(struct mii_bus *bus, int mii_id, int phyreg,
 {
 	struct net_local *lp = bus->priv;
 	u32 regval;
-	volatile u32 ipisr;
 
 	regval  = XEMACPS_PHYMNTNC_OP_MASK;
 	regval |= XEMACPS_PHYMNTNC_OP_W_MASK;
@@ -626,15 +829,11 @@ static int xemacps_mdio_write(struct mii_bus *bus, int mii_id, int phyreg,
 	regval |= (phyreg << XEMACPS_PHYMNTNC_PHREG_SHIFT_MASK);
 	regval |= value;
 
+	INIT_COMPLETION(lp->mdio_done);
 	xemacps_write(lp->baseaddr, XEMACPS_PHYMNTNC_OFFSET, regval);
 
 	/* wait for end of transfer */
-	do {
-		cpu_relax();
-		ipisr = xemacps_read(lp->baseaddr, XEMACPS_NWSR_OFFSET);
-	} while ((ipisr & XEMACPS_NWSR_MDIOIDLE_MASK) == 0);
-
-	return 0;
+	return xemacps_mdio_wait(lp);
 }
 
 
@@ -983,6 +1182,7 @@ static void xemacps_reset_hw(struct net_local *lp)
 	xemacps_write(lp->baseaddr, XEMACPS_RXSR_OFFSET, ~0UL);
 
 	/* Disable all interrupts */
+	lp->mdio_irq_on = false;
 	xemacps_write(lp->baseaddr, XEMACPS_IDR_OFFSET, ~0UL);
 	regisr = xemacps_read(lp->baseaddr, XEMACPS_ISR_OFFSET);
 	xemacps_write(lp->baseaddr, XEMACPS_ISR_OFFSET, regisr);
@@ -1011,13 +1211,11 @@ static cycle_t xemacps_read_clock(const struct cyclecounter *tc)
 {
 	struct net_local *lp =
 			container_of(tc, struct net_local, cycles);
-	u64 stamp;
 	u64 sec, nsec;
 
 	xemacps_get_hwticks(lp, &sec, &nsec);
-	stamp = (sec << 32) | nsec;
 
-	return stamp;
+	return sec * NS_PER_SEC + nsec;
 }
 
 
@@ -1034,13 +1232,15 @@ static void xemacps_systim_to_hwtstamp(struct net_local *lp,
 				struct skb_shared_hwtstamps *shhwtstamps,
 				u64 regval)
 {
+	unsigned long flags;
 	u64 ns;
 
+	spin_lock_irqsave(&lp->tmreg_lock, flags);
 	ns = timecounter_cyc2time(&lp->clock, regval);
-	timecompare_update(&lp->compare, ns);
+	spin_unlock_irqrestore(&lp->tmreg_lock, flags);
+
 	memset(shhwtstamps, 0, sizeof(struct skb_shared_hwtstamps));
 	shhwtstamps->hwtstamp = ns_to_ktime(ns);
-	shhwtstamps->syststamp = timecompare_transform(&lp->compare, ns);
 }
 
 static void
@@ -1058,7 +1258,7 @@ xemacps_rx_hwtstamp(struct net_local *lp,
 		sec = xemacps_read(lp->baseaddr, XEMACPS_PTPPRXS_OFFSET);
 		nsec = xemacps_read(lp->baseaddr, XEMACPS_PTPPRXNS_OFFSET);
 	}
-	time64 = (sec << 32) | nsec;
+	time64 = sec * NS_PER_SEC + nsec;
 	xemacps_systim_to_hwtstamp(lp, skb_hwtstamps(skb), time64);
 }
 
@@ -1078,13 +1278,167 @@ xemacps_tx_hwtstamp(struct net_local *lp,
 		nsec = xemacps_read(lp->baseaddr, XEMACPS_PTPPTXNS_OFFSET);
 	}
 
-	time64 = (sec << 32) | nsec;
+	time64 = sec * NS_PER_SEC + nsec;
 	xemacps_systim_to_hwtstamp(lp, skb_hwtstamps(skb), time64);
 	skb_tstamp_tx(skb, skb_hwtstamps(skb));
 }
 
+/**
+ * xemacps_ptp_overflow_check - keep the timecounter inside its slew range
+ * @lp: local device instance pointer
+ *
+ * The cyclecounter multiplies nanosecond deltas by a 2^31 scaled mult,
+ * so deltas beyond a few seconds overflow the 64 bit product.  Called
+ * from the periodic timer to fold elapsed time into the counter.
+ **/
+static void xemacps_ptp_overflow_check(struct net_local *lp)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&lp->tmreg_lock, flags);
+	timecounter_read(&lp->clock);
+	spin_unlock_irqrestore(&lp->tmreg_lock, flags);
+}
+
+/*
+ * PTP hardware clock operations.  The TSU increments in whole
+ * nanoseconds only, so fine frequency adjustment is done in software:
+ * the cyclecounter runs at the nominal TSU rate and adjfreq slews the
+ * mult value, the same scheme fixed-increment NICs use elsewhere.
+ */
+static int xemacps_ptp_adjfreq(struct ptp_clock_info *ptp, s32 ppb)
+{
+	struct net_local *lp = container_of(ptp, struct net_local, ptp_caps);
+	unsigned long flags;
+	int neg_adj = 0;
+	u64 diff;
+
+	if (ppb < 0) {
+		neg_adj = 1;
+		ppb = -ppb;
+	}
+
+	diff = lp->ptp_nominal_mult;
+	diff *= ppb;
+	diff = div_u64(diff, NS_PER_SEC);
+
+	spin_lock_irqsave(&lp->tmreg_lock, flags);
+	timecounter_read(&lp->clock);
+	lp->cycles.mult = neg_adj ? lp->ptp_nominal_mult - diff :
+				lp->ptp_nominal_mult + diff;
+	spin_unlock_irqrestore(&lp->tmreg_lock, flags);
+
+	return 0;
+}
+
+static int xemacps_ptp_adjtime(struct ptp_clock_info *ptp, s64 delta)
+{
+	struct net_local *lp = container_of(ptp, struct net_local, ptp_caps);
+	unsigned long flags;
+	u64 now;
+
+	spin_lock_irqsave(&lp->tmreg_lock, flags);
+	now = timecounter_read(&lp->clock);
+	now += delta;
+	timecounter_init(&lp->clock, &lp->cycles, now);
+	spin_unlock_irqrestore(&lp->tmreg_lock, flags);
+
+	return 0;
+}
+
+static int xemacps_ptp_gettime(struct ptp_clock_info *ptp, struct timespec *ts)
+{
+	struct net_local *lp = container_of(ptp, struct net_local, ptp_caps);
+	unsigned long flags;
+	u32 remainder;
+	u64 ns;
+
+	spin_lock_irqsave(&lp->tmreg_lock, flags);
+	ns = timecounter_read(&lp->clock);
+	spin_unlock_irqrestore(&lp->tmreg_lock, flags);
+
+	ts->tv_sec = div_u64_rem(ns, NS_PER_SEC, &remainder);
+	ts->tv_nsec = remainder;
+
+	return 0;
+}
+
+static int xemacps_ptp_settime(struct ptp_clock_info *ptp,
+				const struct timespec *ts)
+{
+	struct net_local *lp = container_of(ptp, struct net_local, ptp_caps);
+	unsigned long flags;
+
+	spin_lock_irqsave(&lp->tmreg_lock, flags);
+	timecounter_init(&lp->clock, &lp->cycles, timespec_to_ns(ts));
+	spin_unlock_irqrestore(&lp->tmreg_lock, flags);
+
+	return 0;
+}
+
+static int xemacps_ptp_enable(struct ptp_clock_info *ptp,
+				struct ptp_clock_request *rq, int on)
+{
+	return -EOPNOTSUPP;
+}
+
+/**
+ * xemacps_ptp_register - expose the TSU as a PTP hardware clock
+ * @lp: local device instance pointer
+ *
+ * Registration failure is not fatal, timestamping keeps working
+ * without the PHC interface.
+ **/
+static void xemacps_ptp_register(struct net_local *lp)
+{
+	spin_lock_init(&lp->tmreg_lock);
+
+	lp->ptp_caps.owner = THIS_MODULE;
+	snprintf(lp->ptp_caps.name, sizeof(lp->ptp_caps.name), "%s",
+			lp->ndev->name);
+	lp->ptp_caps.max_adj = 100000000;
+	lp->ptp_caps.adjfreq = xemacps_ptp_adjfreq;
+	lp->ptp_caps.adjtime = xemacps_ptp_adjtime;
+	lp->ptp_caps.gettime = xemacps_ptp_gettime;
+	lp->ptp_caps.settime = xemacps_ptp_settime;
+	lp->ptp_caps.enable = xemacps_ptp_enable;
+
+	lp->ptp_clock = ptp_clock_register(&lp->ptp_caps, &lp->pdev->dev);
+	if (IS_ERR(lp->ptp_clock)) {
+		lp->ptp_clock = NULL;
+		dev_warn(&lp->pdev->dev, "failed to register PTP clock\n");
+	}
+}
+
 #endif /* CONFIG_XILINX_PS_EMAC_HWTSTAMP */
 
+/**
+ * xemacps_rx_typeid_match - test a frame against the EtherType rules
+ * @lp: local device instance pointer
+ * @bdstat: status word of the frame's RX buffer descriptor
+ * @proto: frame protocol as reported by eth_type_trans
+ * return: true if the frame matches an active rule
+ *
+ * The GEM reports type ID matches in the BD status word, but those bits
+ * are repurposed for checksum status while RX checksum offload is on, so
+ * in that case compare the protocol against the programmed rules instead.
+ **/
+static bool xemacps_rx_typeid_match(struct net_local *lp, u32 bdstat,
+				__be16 proto)
+{
+	int i;
+
+	if (!(lp->ndev->features & NETIF_F_RXCSUM))
+		return !!(bdstat & XEMACPS_RXBUF_IDFOUND_MASK);
+
+	for (i = 0; i < XEMACPS_NUM_TYPEID; i++)
+		if ((lp->typeid_active & (1 << i)) &&
+				lp->typeid_proto[i] == ntohs(proto))
+			return true;
+
+	return false;
+}
+
 /**
  * xemacps_rx - process received packets when napi called
  * @lp: local device instance pointer
@@ -1096,8 +1450,9 @@ static int xemacps_rx(struct net_local *lp, int budget)
 	struct xemacps_bd *cur_p;
 	u32 len;
 	struct sk_buff *skb;
-	struct sk_buff *new_skb;
-	u32 new_skb_baddr;
+	void *frag;
+	void *new_frag;
+	u32 new_frag_baddr;
 	unsigned int numbdfree = 0;
 	u32 size = 0;
 	u32 packets = 0;
@@ -1110,31 +1465,74 @@ static int xemacps_rx(struct net_local *lp, int budget)
 		if (!(regval & XEMACPS_RXBUF_NEW_MASK))
 			break;
 
-		new_skb = netdev_alloc_skb(lp->ndev, XEMACPS_RX_BUF_SIZE);
-		if (new_skb == NULL) {
-			dev_err(&lp->ndev->dev, "no memory for new sk_buff\n");
-			break;
-		}
-		/* Get dma handle of skb->data */
-		new_skb_baddr = (u32) dma_map_single(lp->ndev->dev.parent,
-					new_skb->data,
-					XEMACPS_RX_BUF_SIZE,
-					DMA_FROM_DEVICE);
-
 		/* the packet length */
 		len = cur_p->ctrl & XEMACPS_RXBUF_LEN_MASK;
 		rmb();
-		skb = lp->rx_skb[lp->rx_bd_ci].skb;
-		dma_unmap_single(lp->ndev->dev.parent,
-				lp->rx_skb[lp->rx_bd_ci].mapping,
-				lp->rx_skb[lp->rx_bd_ci].len,
-				DMA_FROM_DEVICE);
-
-		/* setup received skb and send it upstream */
-		skb_put(skb, len);  /* Tell the skb how much data we got. */
+		frag = lp->rx_skb[lp->rx_bd_ci].frag;
+
+		if (len <= XEMACPS_RX_COPYBREAK) {
+			skb = netdev_alloc_skb_ip_align(lp->ndev, len);
+			if (!skb)
+				break;	/* the BD is retried on the next poll */
+
+			dma_sync_single_for_cpu(lp->ndev->dev.parent,
+					lp->rx_skb[lp->rx_bd_ci].mapping,
+					len, DMA_FROM_DEVICE);
+			skb_copy_to_linear_data(skb, frag + NET_SKB_PAD, len);
+			dma_sync_single_for_device(lp->ndev->dev.parent,
+					lp->rx_skb[lp->rx_bd_ci].mapping,
+					len, DMA_FROM_DEVICE);
+			skb_put(skb, len);
+		} else {
+			new_frag = netdev_alloc_frag(XEMACPS_RX_FRAG_SIZE);
+			if (!new_frag) {
+				dev_err(&lp->ndev->dev,
+					"no memory for new RX buffer\n");
+				break;
+			}
+			skb = build_skb(frag, XEMACPS_RX_FRAG_SIZE);
+			if (unlikely(!skb)) {
+				put_page(virt_to_head_page(new_frag));
+				lp->stats.rx_dropped++;
+				/* old buffer is still mapped, re-arm it */
+				goto rearm;
+			}
+			dma_unmap_single(lp->ndev->dev.parent,
+					lp->rx_skb[lp->rx_bd_ci].mapping,
+					lp->rx_skb[lp->rx_bd_ci].len,
+					DMA_FROM_DEVICE);
+			skb_reserve(skb, NET_SKB_PAD);
+			skb_put(skb, len);
+
+			new_frag_baddr = (u32) dma_map_single(
+					lp->ndev->dev.parent,
+					new_frag + NET_SKB_PAD,
+					XEMACPS_RX_BUF_SIZE,
+					DMA_FROM_DEVICE);
+			cur_p->addr = (cur_p->addr & ~XEMACPS_RXBUF_ADD_MASK)
+						| (new_frag_baddr);
+			lp->rx_skb[lp->rx_bd_ci].frag = new_frag;
+			lp->rx_skb[lp->rx_bd_ci].mapping = new_frag_baddr;
+			lp->rx_skb[lp->rx_bd_ci].len = XEMACPS_RX_BUF_SIZE;
+		}
+
+		/* eth_type_trans() and the upper layers touch the headers
+		 * right away, so start pulling them in now.
+		 */
+		prefetch(skb->data);
+
 		skb->protocol = eth_type_trans(skb, lp->ndev);
 
-		skb->ip_summed = lp->ip_summed;
+		skb_checksum_none_assert(skb);
+		if (lp->ndev->features & NETIF_F_RXCSUM) {
+			u32 csum_stat;
+
+			csum_stat = (cur_p->ctrl & XEMACPS_RXBUF_CSUM_MASK) >>
+					XEMACPS_RXBUF_CSUM_SHIFT;
+			if ((csum_stat == XEMACPS_RXBUF_CSUM_TCP) ||
+				(csum_stat == XEMACPS_RXBUF_CSUM_UDP))
+				skb->ip_summed = CHECKSUM_UNNECESSARY;
+		}
 
 #ifdef CONFIG_XILINX_PS_EMAC_HWTSTAMP
 		if ((lp->hwtstamp_config.rx_filter == HWTSTAMP_FILTER_ALL) &&
@@ -1162,20 +1560,26 @@ static int xemacps_rx(struct net_local *lp, int budget)
 #endif /* CONFIG_XILINX_PS_EMAC_HWTSTAMP */
 		size += len;
 		packets++;
-		netif_receive_skb(skb);
-
-		cur_p->addr = (cur_p->addr & ~XEMACPS_RXBUF_ADD_MASK)
-					| (new_skb_baddr);
-		lp->rx_skb[lp->rx_bd_ci].skb = new_skb;
-		lp->rx_skb[lp->rx_bd_ci].mapping = new_skb_baddr;
-		lp->rx_skb[lp->rx_bd_ci].len = XEMACPS_RX_BUF_SIZE;
+		trace_xemacps_rx(lp->ndev, len, lp->rx_bd_ci);
+		/* Frames matching an EtherType rule carry control traffic;
+		 * hand them up immediately at control priority rather than
+		 * queueing them behind coalesced bulk flows in GRO.
+		 */
+		if (unlikely(lp->typeid_active) &&
+		    xemacps_rx_typeid_match(lp, cur_p->ctrl, skb->protocol)) {
+			skb->priority = TC_PRIO_CONTROL;
+			netif_receive_skb(skb);
+		} else {
+			napi_gro_receive(&lp->napi, skb);
+		}
 
+rearm:
 		cur_p->ctrl = 0;
 		cur_p->addr &= (~XEMACPS_RXBUF_NEW_MASK);
 		wmb();
 
 		lp->rx_bd_ci++;
-		lp->rx_bd_ci = lp->rx_bd_ci % XEMACPS_RECV_BD_CNT;
+		lp->rx_bd_ci = lp->rx_bd_ci % lp->rx_bd_count;
 		cur_p = &lp->rx_bd[lp->rx_bd_ci];
 		regval = cur_p->addr;
 		rmb();
@@ -1187,6 +1591,8 @@ static int xemacps_rx(struct net_local *lp, int budget)
 	return numbdfree;
 }
 
+static void xemacps_tx_poll(struct net_local *lp);
+
 /**
  * xemacps_rx_poll - NAPI poll routine
  * napi: pointer to napi struct
@@ -1200,21 +1606,32 @@ static int xemacps_rx_poll(struct napi_struct *napi, int budget)
 
 	spin_lock(&lp->rx_lock);
 	while (1) {
+		/* Recycle completed TX BDs before starting on the RX ring so
+		 * a single poll pass services both directions.
+		 */
+		xemacps_tx_poll(lp);
+
 		regval = xemacps_read(lp->baseaddr, XEMACPS_RXSR_OFFSET);
 		xemacps_write(lp->baseaddr, XEMACPS_RXSR_OFFSET, regval);
+		/* Deferred so a burst of AHB errors cannot stretch the
+		 * rx_lock hold time by the cost of serialized printk.
+		 */
 		if (regval & XEMACPS_RXSR_HRESPNOK_MASK)
-			dev_err(&lp->pdev->dev, "RX error 0x%x\n", regval);
+			printk_deferred(KERN_ERR "%s: RX error 0x%x\n",
+					lp->ndev->name, regval);
 
 		work_done += xemacps_rx(lp, budget - work_done);
 		if (work_done >= budget)
 			break;
 
 		napi_complete(napi);
-		/* We disabled RX interrupts in interrupt service
+		/* We disabled TX/RX interrupts in interrupt service
 		 * routine, now it is time to enable it back.
 		 */
-		xemacps_write(lp->baseaddr,
-			XEMACPS_IER_OFFSET, XEMACPS_IXR_FRAMERX_MASK);
+		xemacps_write(lp->baseaddr, XEMACPS_IER_OFFSET,
+				(XEMACPS_IXR_FRAMERX_MASK |
+				XEMACPS_IXR_TXCOMPL_MASK |
+				XEMACPS_IXR_TX_ERR_MASK));
 
 		/* If a packet has come in between the last check of the BD
 		 * list and unmasking the interrupts, we may have missed the
@@ -1233,13 +1650,16 @@ static int xemacps_rx_poll(struct napi_struct *napi, int budget)
 }
 
 /**
- * xemacps_tx_poll - tx bd reclaim tasklet handler
- * @data: pointer to network interface device structure
+ * xemacps_tx_poll - reclaim completed TX BDs in batches from NAPI context
+ * @lp: local device instance pointer
+ *
+ * Called from the NAPI poll routine so that one softirq pass recycles
+ * all BDs the hardware has finished with, instead of taking the reclaim
+ * cost in hard interrupt context per packet burst.
  **/
-static void xemacps_tx_poll(unsigned long data)
+static void xemacps_tx_poll(struct net_local *lp)
 {
-	struct net_device *ndev = (struct net_device *)data;
-	struct net_local *lp = netdev_priv(ndev);
+	struct net_device *ndev = lp->ndev;
 	u32 regval;
 	u32 len = 0;
 	unsigned int bdcount = 0;
@@ -1251,6 +1671,8 @@ static void xemacps_tx_poll(unsigned long data)
 	u32 numbdsinhw;
 	struct ring_info *rp;
 	struct sk_buff *skb;
+	struct sk_buff *skb_batch[XEMACPS_TX_FREE_BATCH];
+	unsigned int skb_count = 0;
 	unsigned long flags;
 
 	spin_lock(&lp->tx_lock);
@@ -1258,11 +1680,12 @@ static void xemacps_tx_poll(unsigned long data)
 	xemacps_write(lp->baseaddr, XEMACPS_TXSR_OFFSET, regval);
 	dev_dbg(&lp->pdev->dev, "TX status 0x%x\n", regval);
 	if (regval & (XEMACPS_TXSR_HRESPNOK_MASK | XEMACPS_TXSR_BUFEXH_MASK))
-		dev_err(&lp->pdev->dev, "TX error 0x%x\n", regval);
+		printk_deferred(KERN_ERR "%s: TX error 0x%x\n",
+				ndev->name, regval);
 
 	cur_i = lp->tx_bd_ci;
 	cur_p = &lp->tx_bd[cur_i];
-	numbdsinhw = XEMACPS_SEND_BD_CNT - lp->tx_bd_freecnt;
+	numbdsinhw = lp->tx_bd_count - lp->tx_bd_freecnt;
 	while (bdcount < numbdsinhw) {
 		if (sop == 0) {
 			if (cur_p->ctrl & XEMACPS_TXBUF_USED_MASK)
@@ -1284,7 +1707,7 @@ static void xemacps_tx_poll(unsigned long data)
 		}
 
 		cur_i++;
-		cur_i = cur_i % XEMACPS_SEND_BD_CNT;
+		cur_i = cur_i % lp->tx_bd_count;
 		cur_p = &lp->tx_bd[cur_i];
 	}
 	numbdstofree = bdcount - bdpartialcount;
@@ -1301,7 +1724,8 @@ static void xemacps_tx_poll(unsigned long data)
 		len += (cur_p->ctrl & XEMACPS_TXBUF_LEN_MASK);
 
 #ifdef CONFIG_XILINX_PS_EMAC_HWTSTAMP
-		if ((lp->hwtstamp_config.tx_type == HWTSTAMP_TX_ON) &&
+		if (skb &&
+			(lp->hwtstamp_config.tx_type == HWTSTAMP_TX_ON) &&
 			(ntohs(skb->protocol) == 0x800)) {
 			unsigned ip_proto, dest_port, msg_type;
 
@@ -1319,10 +1743,27 @@ static void xemacps_tx_poll(unsigned long data)
 		}
 #endif /* CONFIG_XILINX_PS_EMAC_HWTSTAMP */
 
-		dma_unmap_single(&lp->pdev->dev, rp->mapping, rp->len,
-			DMA_TO_DEVICE);
-		rp->skb = NULL;
-		dev_kfree_skb(skb);
+		if (rp->persistent)
+			rp->persistent = 0; /* mapping is cached for requeue */
+		else if (rp->mapped_as_page)
+			dma_unmap_page(&lp->pdev->dev, rp->mapping, rp->len,
+				DMA_TO_DEVICE);
+		else
+			dma_unmap_single(&lp->pdev->dev, rp->mapping, rp->len,
+				DMA_TO_DEVICE);
+		/*
+		 * The skb is carried only by the BD of its last fragment.
+		 * Completed skbs are gathered and freed in one bulk pass,
+		 * rather than bouncing through the slab once per packet.
+		 */
+		if (skb) {
+			rp->skb = NULL;
+			skb_batch[skb_count++] = skb;
+			if (skb_count == XEMACPS_TX_FREE_BATCH) {
+				consume_skb_bulk(skb_batch, skb_count);
+				skb_count = 0;
+			}
+		}
 		/* log tx completed packets and bytes, errors logs
 		 * are in other error counters.
 		 */
@@ -1338,7 +1779,7 @@ static void xemacps_tx_poll(unsigned long data)
 					XEMACPS_TXBUF_WRAP_MASK);
 
 		lp->tx_bd_ci++;
-		lp->tx_bd_ci = lp->tx_bd_ci % XEMACPS_SEND_BD_CNT;
+		lp->tx_bd_ci = lp->tx_bd_ci % lp->tx_bd_count;
 		cur_p = &lp->tx_bd[lp->tx_bd_ci];
 		numbdstofree--;
 	}
@@ -1356,6 +1797,25 @@ static void xemacps_tx_poll(unsigned long data)
 
 tx_poll_out:
 	spin_unlock(&lp->tx_lock);
+
+	if (skb_count)
+		consume_skb_bulk(skb_batch, skb_count);
+}
+
+/**
+ * xemacps_rx_coalesce_expiry - RX mitigation timer handler
+ * @timer: pointer to the armed hrtimer
+ *
+ * The frame-received interrupt is already masked; all that is left to
+ * do is kick NAPI to drain whatever accumulated on the RX ring.
+ **/
+static enum hrtimer_restart xemacps_rx_coalesce_expiry(struct hrtimer *timer)
+{
+	struct net_local *lp = container_of(timer, struct net_local,
+					rx_coalesce_timer);
+
+	napi_schedule(&lp->napi);
+	return HRTIMER_NORESTART;
 }
 
 /**
@@ -1378,9 +1838,15 @@ static irqreturn_t xemacps_interrupt(int irq, void *dev_id)
 	xemacps_write(lp->baseaddr, XEMACPS_ISR_OFFSET, regisr);
 
 	while (regisr) {
+		if (regisr & XEMACPS_IXR_MGMNT_MASK)
+			complete(&lp->mdio_done);
+
 		if (regisr & (XEMACPS_IXR_TXCOMPL_MASK |
 				XEMACPS_IXR_TX_ERR_MASK)) {
-			tasklet_schedule(&lp->tx_bdreclaim_tasklet);
+			xemacps_write(lp->baseaddr, XEMACPS_IDR_OFFSET,
+					(XEMACPS_IXR_TXCOMPL_MASK |
+					XEMACPS_IXR_TX_ERR_MASK));
+			napi_schedule(&lp->napi);
 		}
 
 		if (regisr & XEMACPS_IXR_RXUSED_MASK) {
@@ -1396,7 +1862,16 @@ static irqreturn_t xemacps_interrupt(int irq, void *dev_id)
 		if (regisr & XEMACPS_IXR_FRAMERX_MASK) {
 			xemacps_write(lp->baseaddr,
 				XEMACPS_IDR_OFFSET, XEMACPS_IXR_FRAMERX_MASK);
-			napi_schedule(&lp->napi);
+			if (lp->rx_coalesce_usecs) {
+				if (!hrtimer_is_queued(&lp->rx_coalesce_timer))
+					hrtimer_start(&lp->rx_coalesce_timer,
+						ktime_set(0,
+						lp->rx_coalesce_usecs *
+							NSEC_PER_USEC),
+						HRTIMER_MODE_REL);
+			} else {
+				napi_schedule(&lp->napi);
+			}
 		}
 		regisr = xemacps_read(lp->baseaddr, XEMACPS_ISR_OFFSET);
 		xemacps_write(lp->baseaddr, XEMACPS_ISR_OFFSET, regisr);
@@ -1412,31 +1887,99 @@ static void xemacps_clean_rings(struct net_local *lp)
 {
 	int i;
 
-	for (i = 0; i < XEMACPS_RECV_BD_CNT; i++) {
-		if (lp->rx_skb && lp->rx_skb[i].skb) {
+	for (i = 0; i < lp->rx_bd_count; i++) {
+		if (lp->rx_skb && lp->rx_skb[i].frag) {
 			dma_unmap_single(lp->ndev->dev.parent,
 					 lp->rx_skb[i].mapping,
 					 lp->rx_skb[i].len,
 					 DMA_FROM_DEVICE);
 
-			dev_kfree_skb(lp->rx_skb[i].skb);
-			lp->rx_skb[i].skb = NULL;
+			put_page(virt_to_head_page(lp->rx_skb[i].frag));
+			lp->rx_skb[i].frag = NULL;
 			lp->rx_skb[i].mapping = 0;
 		}
 	}
 
-	for (i = 0; i < XEMACPS_SEND_BD_CNT; i++) {
-		if (lp->tx_skb && lp->tx_skb[i].skb) {
-			dma_unmap_single(lp->ndev->dev.parent,
-					 lp->tx_skb[i].mapping,
-					 lp->tx_skb[i].len,
-					 DMA_TO_DEVICE);
-
+	for (i = 0; i < lp->tx_bd_count; i++) {
+		if (!lp->tx_skb)
+			break;
+		if (lp->tx_skb[i].mapping) {
+			/* persistent mappings are unmapped once, below */
+			if (lp->tx_skb[i].persistent)
+				lp->tx_skb[i].persistent = 0;
+			else if (lp->tx_skb[i].mapped_as_page)
+				dma_unmap_page(lp->ndev->dev.parent,
+						lp->tx_skb[i].mapping,
+						lp->tx_skb[i].len,
+						DMA_TO_DEVICE);
+			else
+				dma_unmap_single(lp->ndev->dev.parent,
+						lp->tx_skb[i].mapping,
+						lp->tx_skb[i].len,
+						DMA_TO_DEVICE);
+			lp->tx_skb[i].mapping = 0;
+		}
+		if (lp->tx_skb[i].skb) {
 			dev_kfree_skb(lp->tx_skb[i].skb);
 			lp->tx_skb[i].skb = NULL;
-			lp->tx_skb[i].mapping = 0;
 		}
 	}
+
+	if (lp->txreq_skb) {
+		dma_unmap_single(lp->ndev->dev.parent, lp->txreq_mapping,
+				lp->txreq_len, DMA_TO_DEVICE);
+		lp->txreq_skb = NULL;
+	}
+}
+
+/**
+ * xemacps_bdring_alloc - Allocate a BD ring, preferably in OCM
+ * @lp: local device instance pointer
+ * @size: size of the ring in bytes
+ * @phys: output for the bus address of the ring
+ * @in_ocm: output flag, set when the ring was placed in OCM
+ * return ring virtual address, or NULL on failure
+ *
+ * The on-chip memory has a far lower access latency than DDR and the
+ * controller fetches a BD for every single packet, so place the rings
+ * there when the platform provides an OCM pool. The pool memory is
+ * uncached, making it safe for DMA without further maintenance. Fall
+ * back to ordinary coherent memory when no pool exists or it is full.
+ **/
+static void *xemacps_bdring_alloc(struct net_local *lp, int size,
+		dma_addr_t *phys, bool *in_ocm)
+{
+	struct gen_pool *pool = zynq_ocm_pool_get();
+	unsigned long vaddr;
+
+	if (pool) {
+		vaddr = gen_pool_alloc(pool, size);
+		if (vaddr) {
+			*phys = gen_pool_virt_to_phys(pool, vaddr);
+			*in_ocm = true;
+			return (void *)vaddr;
+		}
+	}
+
+	*in_ocm = false;
+	return dma_alloc_coherent(&lp->pdev->dev, size, phys, GFP_KERNEL);
+}
+
+/**
+ * xemacps_bdring_free - Free a BD ring
+ * @lp: local device instance pointer
+ * @size: size of the ring in bytes
+ * @addr: ring virtual address
+ * @phys: bus address of the ring
+ * @in_ocm: whether the ring was placed in OCM
+ **/
+static void xemacps_bdring_free(struct net_local *lp, int size, void *addr,
+		dma_addr_t phys, bool in_ocm)
+{
+	if (in_ocm)
+		gen_pool_free(zynq_ocm_pool_get(), (unsigned long)addr, size);
+	else
+		dma_free_coherent(&lp->pdev->dev, size, addr, phys);
 }
 
 /**
@@ -1455,17 +1998,17 @@ static void xemacps_descriptor_free(struct net_local *lp)
 	kfree(lp->rx_skb);
 	lp->rx_skb = NULL;
 
-	size = XEMACPS_RECV_BD_CNT * sizeof(struct xemacps_bd);
+	size = lp->rx_bd_count * sizeof(struct xemacps_bd);
 	if (lp->rx_bd) {
-		dma_free_coherent(&lp->pdev->dev, size,
-			lp->rx_bd, lp->rx_bd_dma);
+		xemacps_bdring_free(lp, size, lp->rx_bd, lp->rx_bd_dma,
+			lp->rx_bd_ocm);
 		lp->rx_bd = NULL;
 	}
 
-	size = XEMACPS_SEND_BD_CNT * sizeof(struct xemacps_bd);
+	size = lp->tx_bd_count * sizeof(struct xemacps_bd);
 	if (lp->tx_bd) {
-		dma_free_coherent(&lp->pdev->dev, size,
-			lp->tx_bd, lp->tx_bd_dma);
+		xemacps_bdring_free(lp, size, lp->tx_bd, lp->tx_bd_dma,
+			lp->tx_bd_ocm);
 		lp->tx_bd = NULL;
 	}
 }
@@ -1478,8 +2021,8 @@ static void xemacps_descriptor_free(struct net_local *lp)
 static int xemacps_descriptor_init(struct net_local *lp)
 {
 	int size;
-	struct sk_buff *new_skb;
-	u32 new_skb_baddr;
+	void *new_frag;
+	u32 new_frag_baddr;
 	u32 i;
 	struct xemacps_bd *cur_p;
 
@@ -1488,70 +2031,73 @@ static int xemacps_descriptor_init(struct net_local *lp)
 	lp->tx_bd_tail = 0;
 	lp->rx_bd_ci = 0;
 
-	size = XEMACPS_SEND_BD_CNT * sizeof(struct ring_info);
+	size = lp->tx_bd_count * sizeof(struct ring_info);
 	lp->tx_skb = kzalloc(size, GFP_KERNEL);
 	if (!lp->tx_skb)
 		goto err_out;
-	size = XEMACPS_RECV_BD_CNT * sizeof(struct ring_info);
+	size = lp->rx_bd_count * sizeof(struct ring_info);
 	lp->rx_skb = kzalloc(size, GFP_KERNEL);
 	if (!lp->rx_skb)
 		goto err_out;
 
-	size = XEMACPS_RECV_BD_CNT * sizeof(struct xemacps_bd);
-	lp->rx_bd = dma_alloc_coherent(&lp->pdev->dev, size,
-			&lp->rx_bd_dma, GFP_KERNEL);
+	size = lp->rx_bd_count * sizeof(struct xemacps_bd);
+	lp->rx_bd = xemacps_bdring_alloc(lp, size, &lp->rx_bd_dma,
+			&lp->rx_bd_ocm);
 	if (!lp->rx_bd)
 		goto err_out;
-	dev_dbg(&lp->pdev->dev, "RX ring %d bytes at 0x%x mapped %p\n",
-			size, lp->rx_bd_dma, lp->rx_bd);
+	dev_dbg(&lp->pdev->dev, "RX ring %d bytes at 0x%x mapped %p%s\n",
+			size, lp->rx_bd_dma, lp->rx_bd,
+			lp->rx_bd_ocm ? " (OCM)" : "");
 
-	memset(lp->rx_bd, 0, sizeof(*lp->rx_bd) * XEMACPS_RECV_BD_CNT);
-	for (i = 0; i < XEMACPS_RECV_BD_CNT; i++) {
+	memset(lp->rx_bd, 0, sizeof(*lp->rx_bd) * lp->rx_bd_count);
+	for (i = 0; i < lp->rx_bd_count; i++) {
 		cur_p = &lp->rx_bd[i];
-		new_skb = netdev_alloc_skb(lp->ndev, XEMACPS_RX_BUF_SIZE);
+		new_frag = netdev_alloc_frag(XEMACPS_RX_FRAG_SIZE);
 
-		if (new_skb == NULL) {
-			dev_err(&lp->ndev->dev, "alloc_skb error %d\n", i);
+		if (new_frag == NULL) {
+			dev_err(&lp->ndev->dev, "alloc RX buffer error %d\n",
+					i);
 			goto err_out;
 		}
 
-		/* Get dma handle of skb->data */
-		new_skb_baddr = (u32) dma_map_single(lp->ndev->dev.parent,
-							new_skb->data,
+		/* Get dma handle of the buffer the GEM writes into */
+		new_frag_baddr = (u32) dma_map_single(lp->ndev->dev.parent,
+							new_frag + NET_SKB_PAD,
 							XEMACPS_RX_BUF_SIZE,
 							DMA_FROM_DEVICE);
 		cur_p->addr = (cur_p->addr & ~XEMACPS_RXBUF_ADD_MASK)
-					| (new_skb_baddr);
-		lp->rx_skb[i].skb = new_skb;
-		lp->rx_skb[i].mapping = new_skb_baddr;
+					| (new_frag_baddr);
+		lp->rx_skb[i].frag = new_frag;
+		lp->rx_skb[i].mapping = new_frag_baddr;
 		lp->rx_skb[i].len = XEMACPS_RX_BUF_SIZE;
 		wmb();
 	}
-	cur_p = &lp->rx_bd[XEMACPS_RECV_BD_CNT - 1];
+	cur_p = &lp->rx_bd[lp->rx_bd_count - 1];
 	/* wrap bit set for last BD, bdptr is moved to last here */
 	cur_p->ctrl = 0;
 	cur_p->addr |= XEMACPS_RXBUF_WRAP_MASK;
 
-	size = XEMACPS_SEND_BD_CNT * sizeof(struct xemacps_bd);
-	lp->tx_bd = dma_alloc_coherent(&lp->pdev->dev, size,
-			&lp->tx_bd_dma, GFP_KERNEL);
+	size = lp->tx_bd_count * sizeof(struct xemacps_bd);
+	lp->tx_bd = xemacps_bdring_alloc(lp, size, &lp->tx_bd_dma,
+			&lp->tx_bd_ocm);
 	if (!lp->tx_bd)
 		goto err_out;
-	dev_dbg(&lp->pdev->dev, "TX ring %d bytes at 0x%x mapped %p\n",
-			size, lp->tx_bd_dma, lp->tx_bd);
+	dev_dbg(&lp->pdev->dev, "TX ring %d bytes at 0x%x mapped %p%s\n",
+			size, lp->tx_bd_dma, lp->tx_bd,
+			lp->tx_bd_ocm ? " (OCM)" : "");
 
-	memset(lp->tx_bd, 0, sizeof(*lp->tx_bd) * XEMACPS_SEND_BD_CNT);
-	for (i = 0; i < XEMACPS_SEND_BD_CNT; i++) {
+	memset(lp->tx_bd, 0, sizeof(*lp->tx_bd) * lp->tx_bd_count);
+	for (i = 0; i < lp->tx_bd_count; i++) {
 		cur_p = &lp->tx_bd[i];
 		cur_p->ctrl = XEMACPS_TXBUF_USED_MASK;
 	}
-	cur_p = &lp->tx_bd[XEMACPS_SEND_BD_CNT - 1];
+	cur_p = &lp->tx_bd[lp->tx_bd_count - 1];
 	/* wrap bit set for last BD, bdptr is moved to last here */
 	cur_p->ctrl = (XEMACPS_TXBUF_WRAP_MASK | XEMACPS_TXBUF_USED_MASK);
-	lp->tx_bd_freecnt = XEMACPS_SEND_BD_CNT;
+	lp->tx_bd_freecnt = lp->tx_bd_count;
 
 
-	for (i = 0; i < XEMACPS_RECV_BD_CNT; i++) {
+	for (i = 0; i < lp->rx_bd_count; i++) {
 		cur_p = &lp->rx_bd[i];
 		cur_p->ctrl = 0;
 		/* Assign ownership back to hardware */
@@ -1581,36 +2127,35 @@ err_out:
  */
 static void xemacps_init_tsu(struct net_local *lp)
 {
+	u32 incr = NS_PER_SEC / lp->ptpenetclk;
 
 	memset(&lp->cycles, 0, sizeof(lp->cycles));
 	lp->cycles.read = xemacps_read_clock;
 	lp->cycles.mask = CLOCKSOURCE_MASK(64);
-	lp->cycles.mult = 1;
-	lp->cycles.shift = 0;
+	lp->cycles.shift = XEMACPS_PTP_CC_SHIFT;
+
+	/*
+	 * The increment register only takes whole nanoseconds, so with a
+	 * non-integer tick period the TSU runs off nominal (7ns per 7.5ns
+	 * tick at the default 133MHz).  Fold the ratio between the real
+	 * tick period and the programmed increment into the cyclecounter
+	 * mult, so PHC time advances at nominal rate and adjfreq only has
+	 * to slew residual oscillator drift.
+	 */
+	lp->cycles.mult = div64_u64(NS_PER_SEC << XEMACPS_PTP_CC_SHIFT,
+			(u64)lp->ptpenetclk * incr);
+	lp->ptp_nominal_mult = lp->cycles.mult;
 
-	/* Set registers so that rollover occurs soon to test this. */
 	xemacps_write(lp->baseaddr, XEMACPS_1588NS_OFFSET, 0x00000000);
-	xemacps_write(lp->baseaddr, XEMACPS_1588S_OFFSET, 0xFF800000);
+	xemacps_write(lp->baseaddr, XEMACPS_1588S_OFFSET, 0x00000000);
 
-	/* program the timer increment register with the numer of nanoseconds
-	 * per clock tick.
-	 *
-	 * Note: The value is calculated based on the current operating
-	 * frequency 50MHz
+	/* program the timer increment register with the number of
+	 * nanoseconds per clock tick
 	 */
-	xemacps_write(lp->baseaddr, XEMACPS_1588INC_OFFSET,
-			(NS_PER_SEC/lp->ptpenetclk));
+	xemacps_write(lp->baseaddr, XEMACPS_1588INC_OFFSET, incr);
 
 	timecounter_init(&lp->clock, &lp->cycles,
 				ktime_to_ns(ktime_get_real()));
-	/*
-	 * Synchronize our NIC clock against system wall clock.
-	 */
-	memset(&lp->compare, 0, sizeof(lp->compare));
-	lp->compare.source = &lp->clock;
-	lp->compare.target = ktime_get_real;
-	lp->compare.num_samples = 10;
-	timecompare_update(&lp->compare, 0);
 
 	/* Initialize hwstamp config */
 	lp->hwtstamp_config.rx_filter = HWTSTAMP_FILTER_NONE;
@@ -1626,14 +2171,23 @@ static void xemacps_init_tsu(struct net_local *lp)
 static void xemacps_init_hw(struct net_local *lp)
 {
 	u32 regval;
+	int i;
 
 	xemacps_reset_hw(lp);
 	xemacps_set_hwaddr(lp);
 
+	/* Restore the ethtool EtherType rules lost in the MAC reset */
+	for (i = 0; i < XEMACPS_NUM_TYPEID; i++)
+		if (lp->typeid_active & (1 << i))
+			xemacps_write(lp->baseaddr,
+					XEMACPS_MATCH1_OFFSET + i * 4,
+					lp->typeid_proto[i]);
+
 	/* network configuration */
 	regval  = 0;
 	regval |= XEMACPS_NWCFG_FDEN_MASK;
-	regval |= XEMACPS_NWCFG_RXCHKSUMEN_MASK;
+	if (lp->ndev->features & NETIF_F_RXCSUM)
+		regval |= XEMACPS_NWCFG_RXCHKSUMEN_MASK;
 	regval |= XEMACPS_NWCFG_PAUSECOPYDI_MASK;
 	regval |= XEMACPS_NWCFG_FCSREM_MASK;
 	regval |= XEMACPS_NWCFG_PAUSEEN_MASK;
@@ -1657,7 +2211,8 @@ static void xemacps_init_hw(struct net_local *lp)
 		XEMACPS_DMACR_RXBUF_SHIFT);
 	regval |= XEMACPS_DMACR_RXSIZE_MASK;
 	regval |= XEMACPS_DMACR_TXSIZE_MASK;
-	regval |= XEMACPS_DMACR_TCPCKSUM_MASK;
+	if (lp->ndev->features & NETIF_F_IP_CSUM)
+		regval |= XEMACPS_DMACR_TCPCKSUM_MASK;
 #ifdef __LITTLE_ENDIAN
 	regval &= ~XEMACPS_DMACR_ENDIAN_MASK;
 #endif
@@ -1679,9 +2234,13 @@ static void xemacps_init_hw(struct net_local *lp)
 	xemacps_init_tsu(lp);
 #endif
 
-	/* Enable interrupts */
+	/* Enable interrupts, including PHY management complete so MDIO
+	 * transfers sleep instead of busy-polling while the MAC is up.
+	 */
 	regval  = XEMACPS_IXR_ALL_MASK;
+	regval |= XEMACPS_IXR_MGMNT_MASK;
 	xemacps_write(lp->baseaddr, XEMACPS_IER_OFFSET, regval);
+	lp->mdio_irq_on = true;
 }
 
 /**
@@ -1716,67 +2275,137 @@ static void xemacps_resetrx_for_no_rxdata(unsigned long data)
  * xemacps_update_stats - Update the statistic structure entries from
  * the corresponding emacps hardware statistic registers
  * @data: Used for net_local instance pointer
+ *
+ * The hardware counters clear on read, so every register is read
+ * exactly once per call and accumulated into the 64-bit hw_stats
+ * array; the net_device_stats error fields are derived from the same
+ * per-call deltas. Must be called often enough that no 32-bit counter
+ * can wrap between calls, which the stats timer guarantees.
  **/
 static void xemacps_update_stats(unsigned long data)
 {
 	struct net_local *lp = (struct net_local *)data;
 	struct net_device_stats *nstat = &lp->stats;
-	u32 cnt;
-
-	cnt = xemacps_read(lp->baseaddr, XEMACPS_RXUNDRCNT_OFFSET);
-	nstat->rx_errors += cnt;
-	nstat->rx_length_errors += cnt;
-
-	cnt = xemacps_read(lp->baseaddr, XEMACPS_RXOVRCNT_OFFSET);
-	nstat->rx_errors += cnt;
-	nstat->rx_length_errors += cnt;
-
-	cnt = xemacps_read(lp->baseaddr, XEMACPS_RXJABCNT_OFFSET);
-	nstat->rx_errors += cnt;
-	nstat->rx_length_errors += cnt;
-
-	cnt = xemacps_read(lp->baseaddr, XEMACPS_RXFCSCNT_OFFSET);
-	nstat->rx_errors += cnt;
-	nstat->rx_crc_errors += cnt;
-
-	cnt = xemacps_read(lp->baseaddr, XEMACPS_RXLENGTHCNT_OFFSET);
-	nstat->rx_errors += cnt;
-	nstat->rx_length_errors += cnt;
+	u32 delta[XEMACPS_NUM_HW_STATS];
+	unsigned long flags;
+	u32 offset;
+	int i = 0;
+
+	spin_lock_irqsave(&lp->stats_lock, flags);
+
+	for (offset = XEMACPS_OCTTXL_OFFSET;
+	     offset <= XEMACPS_RXUDPCCNT_OFFSET; offset += 4, i++) {
+		delta[i] = xemacps_read(lp->baseaddr, offset);
+		lp->hw_stats[i] += delta[i];
+		if (offset == XEMACPS_OCTTXL_OFFSET ||
+		    offset == XEMACPS_OCTRXL_OFFSET) {
+			/* 48-bit counter, bits 47:32 in the next register */
+			offset += 4;
+			lp->hw_stats[i] += (u64)
+				xemacps_read(lp->baseaddr, offset) << 32;
+		}
+	}
 
-	cnt = xemacps_read(lp->baseaddr, XEMACPS_RXALIGNCNT_OFFSET);
-	nstat->rx_errors += cnt;
-	nstat->rx_frame_errors += cnt;
+	nstat->rx_errors += delta[XEMACPS_STAT_RXUNDRCNT] +
+			    delta[XEMACPS_STAT_RXOVRCNT] +
+			    delta[XEMACPS_STAT_RXJABCNT] +
+			    delta[XEMACPS_STAT_RXFCSCNT] +
+			    delta[XEMACPS_STAT_RXLENGTHCNT] +
+			    delta[XEMACPS_STAT_RXALIGNCNT] +
+			    delta[XEMACPS_STAT_RXRESERRCNT] +
+			    delta[XEMACPS_STAT_RXORCNT];
+	nstat->rx_length_errors += delta[XEMACPS_STAT_RXUNDRCNT] +
+				   delta[XEMACPS_STAT_RXOVRCNT] +
+				   delta[XEMACPS_STAT_RXJABCNT] +
+				   delta[XEMACPS_STAT_RXLENGTHCNT];
+	nstat->rx_crc_errors += delta[XEMACPS_STAT_RXFCSCNT];
+	nstat->rx_frame_errors += delta[XEMACPS_STAT_RXALIGNCNT];
+	nstat->rx_missed_errors += delta[XEMACPS_STAT_RXRESERRCNT];
+	nstat->rx_fifo_errors += delta[XEMACPS_STAT_RXORCNT];
+
+	nstat->tx_errors += delta[XEMACPS_STAT_TXURUNCNT] +
+			    delta[XEMACPS_STAT_EXCESSCOLLCNT] +
+			    delta[XEMACPS_STAT_LATECOLLCNT] +
+			    delta[XEMACPS_STAT_CSENSECNT];
+	nstat->tx_fifo_errors += delta[XEMACPS_STAT_TXURUNCNT];
+	nstat->tx_aborted_errors += delta[XEMACPS_STAT_EXCESSCOLLCNT];
+	nstat->tx_carrier_errors += delta[XEMACPS_STAT_CSENSECNT];
+	nstat->collisions += delta[XEMACPS_STAT_SNGLCOLLCNT] +
+			     delta[XEMACPS_STAT_MULTICOLLCNT] +
+			     delta[XEMACPS_STAT_EXCESSCOLLCNT] +
+			     delta[XEMACPS_STAT_LATECOLLCNT];
+
+	spin_unlock_irqrestore(&lp->stats_lock, flags);
+}
 
-	cnt = xemacps_read(lp->baseaddr, XEMACPS_RXRESERRCNT_OFFSET);
-	nstat->rx_errors += cnt;
-	nstat->rx_missed_errors += cnt;
+/**
+ * xemacps_eco_link_work - Reprogram the PHY advertisement
+ * @work: eco_work member of the device instance
+ *
+ * Restricts the advertisement to 100 Mbit or restores the saved full
+ * advertisement, depending on the state set by xemacps_eco_set, then
+ * restarts autonegotiation. The link bounces for the duration of the
+ * renegotiation, which is why downshifting requires a long sustained
+ * idle period.
+ **/
+static void xemacps_eco_link_work(struct work_struct *work)
+{
+	struct net_local *lp = container_of(work, struct net_local, eco_work);
+	struct phy_device *phydev = lp->phy_dev;
 
-	cnt = xemacps_read(lp->baseaddr, XEMACPS_RXORCNT_OFFSET);
-	nstat->rx_errors += cnt;
-	nstat->rx_fifo_errors += cnt;
+	if (!phydev)
+		return;
 
-	cnt = xemacps_read(lp->baseaddr, XEMACPS_TXURUNCNT_OFFSET);
-	nstat->tx_errors += cnt;
-	nstat->tx_fifo_errors += cnt;
+	if (lp->eco_down) {
+		lp->eco_full_adv = phydev->advertising;
+		phydev->advertising &= ~(ADVERTISED_1000baseT_Full |
+					 ADVERTISED_1000baseT_Half);
+	} else if (lp->eco_full_adv) {
+		phydev->advertising = lp->eco_full_adv;
+	}
+	phy_start_aneg(phydev);
+}
 
-	cnt = xemacps_read(lp->baseaddr, XEMACPS_SNGLCOLLCNT_OFFSET);
-	nstat->collisions += cnt;
+static void xemacps_eco_set(struct net_local *lp, int down)
+{
+	if (lp->eco_down == down)
+		return;
+	lp->eco_down = down;
+	lp->eco_idle_ticks = 0;
+	schedule_work(&lp->eco_work);
+}
 
-	cnt = xemacps_read(lp->baseaddr, XEMACPS_MULTICOLLCNT_OFFSET);
-	nstat->collisions += cnt;
+/**
+ * xemacps_eco_link_check - Adaptive link speed policy
+ * @lp: local device instance pointer
+ *
+ * Called from the stats timer after the counters have been updated.
+ * Downshift after a sustained idle period on a gigabit link; upshift
+ * as soon as the traffic rate approaches what 100 Mbit can carry. The
+ * transmit path additionally forces an upshift on ring buildup, so a
+ * burst does not have to wait for a timer tick.
+ **/
+static void xemacps_eco_link_check(struct net_local *lp)
+{
+	unsigned long bytes = lp->stats.rx_bytes + lp->stats.tx_bytes;
+	unsigned long delta = bytes - lp->eco_last_bytes;
 
-	cnt = xemacps_read(lp->baseaddr, XEMACPS_EXCESSCOLLCNT_OFFSET);
-	nstat->tx_errors += cnt;
-	nstat->tx_aborted_errors += cnt;
-	nstat->collisions += cnt;
+	lp->eco_last_bytes = bytes;
 
-	cnt = xemacps_read(lp->baseaddr, XEMACPS_LATECOLLCNT_OFFSET);
-	nstat->tx_errors += cnt;
-	nstat->collisions += cnt;
+	if (!ecolink || !lp->link)
+		return;
 
-	cnt = xemacps_read(lp->baseaddr, XEMACPS_CSENSECNT_OFFSET);
-	nstat->tx_errors += cnt;
-	nstat->tx_carrier_errors += cnt;
+	if (!lp->eco_down) {
+		if (lp->speed == SPEED_1000 &&
+				delta < XEMACPS_ECO_DOWN_THRESHOLD) {
+			if (++lp->eco_idle_ticks >= XEMACPS_ECO_IDLE_TICKS)
+				xemacps_eco_set(lp, 1);
+		} else {
+			lp->eco_idle_ticks = 0;
+		}
+	} else if (delta > XEMACPS_ECO_UP_THRESHOLD) {
+		xemacps_eco_set(lp, 0);
+	}
 }
 
 /**
@@ -1795,7 +2424,11 @@ static void xemacps_gen_purpose_timerhandler(unsigned long data)
 	struct net_local *lp = (struct net_local *)data;
 
 	xemacps_update_stats(data);
+	xemacps_eco_link_check(lp);
 	xemacps_resetrx_for_no_rxdata(data);
+#ifdef CONFIG_XILINX_PS_EMAC_HWTSTAMP
+	xemacps_ptp_overflow_check(lp);
+#endif
 	mod_timer(&(lp->gen_purpose_timer),
 		jiffies + msecs_to_jiffies(XEAMCPS_GEN_PURPOSE_TIMER_LOAD));
 }
@@ -1851,6 +2484,12 @@ static int xemacps_open(struct net_device *ndev)
 		goto err_pm_put;
 	}
 
+	INIT_WORK(&lp->eco_work, xemacps_eco_link_work);
+	lp->eco_down = 0;
+	lp->eco_idle_ticks = 0;
+	lp->eco_full_adv = 0;
+	lp->eco_last_bytes = lp->stats.rx_bytes + lp->stats.tx_bytes;
+
 	setup_timer(&(lp->gen_purpose_timer), xemacps_gen_purpose_timerhandler,
 							(unsigned long)lp);
 	mod_timer(&(lp->gen_purpose_timer),
@@ -1858,7 +2497,6 @@ static int xemacps_open(struct net_device *ndev)
 
 	netif_carrier_on(ndev);
 	netif_start_queue(ndev);
-	tasklet_enable(&lp->tx_bdreclaim_tasklet);
 
 	return 0;
 
@@ -1885,9 +2523,10 @@ static int xemacps_close(struct net_device *ndev)
 	struct net_local *lp = netdev_priv(ndev);
 
 	del_timer(&(lp->gen_purpose_timer));
+	cancel_work_sync(&lp->eco_work);
 	netif_stop_queue(ndev);
+	hrtimer_cancel(&lp->rx_coalesce_timer);
 	napi_disable(&lp->napi);
-	tasklet_disable(&lp->tx_bdreclaim_tasklet);
 	netif_carrier_off(ndev);
 	xemacps_reset_hw(lp);
 	if (lp->phy_dev)
@@ -1915,7 +2554,6 @@ static void xemacps_reinit_for_txtimeout(struct work_struct *data)
 
 	netif_stop_queue(lp->ndev);
 	napi_disable(&lp->napi);
-	tasklet_disable(&lp->tx_bdreclaim_tasklet);
 	spin_lock_bh(&lp->tx_lock);
 	xemacps_reset_hw(lp);
 	spin_unlock_bh(&lp->tx_lock);
@@ -1941,7 +2579,6 @@ static void xemacps_reinit_for_txtimeout(struct work_struct *data)
 		phy_start(lp->phy_dev);
 
 	napi_enable(&lp->napi);
-	tasklet_enable(&lp->tx_bdreclaim_tasklet);
 	lp->ndev->trans_start = jiffies;
 	netif_wake_queue(lp->ndev);
 }
@@ -2000,7 +2637,6 @@ static int xemacps_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 	unsigned int nr_frags, len;
 	int i;
 	u32 regval;
-	void       *virt_addr;
 	skb_frag_t *frag;
 	struct xemacps_bd *cur_p;
 	unsigned long flags;
@@ -2010,12 +2646,26 @@ static int xemacps_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 	nr_frags = skb_shinfo(skb)->nr_frags + 1;
 	spin_lock_bh(&lp->tx_lock);
 
+	/* A regular transmit invalidates the requeue mapping cache so a
+	 * recycled skb address can never alias a stale mapping. The
+	 * generator drains the ring before switching payloads.
+	 */
+	if (unlikely(lp->txreq_skb)) {
+		dma_unmap_single(&lp->pdev->dev, lp->txreq_mapping,
+				lp->txreq_len, DMA_TO_DEVICE);
+		lp->txreq_skb = NULL;
+	}
+
 	cur_p = &(lp->tx_bd[lp->tx_bd_tail]);
 	if (nr_frags >= lp->tx_bd_freecnt) {
 		netif_stop_queue(ndev); /* stop send queue */
 		spin_unlock_bh(&lp->tx_lock);
 		return NETDEV_TX_BUSY;
 	}
+
+	/* On a downshifted link, ring buildup means upshift right away */
+	if (lp->eco_down && lp->tx_bd_freecnt < (lp->tx_bd_count >> 1))
+		xemacps_eco_set(lp, 0);
 	lp->tx_bd_freecnt -= nr_frags;
 	frag = &skb_shinfo(skb)->frags[0];
 	bd_tail = lp->tx_bd_tail;
@@ -2024,18 +2674,29 @@ static int xemacps_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 			len = skb_headlen(skb);
 			mapping = dma_map_single(&lp->pdev->dev, skb->data,
 				len, DMA_TO_DEVICE);
+			lp->tx_skb[lp->tx_bd_tail].mapped_as_page = 0;
 		} else {
 			len = skb_frag_size(frag);
-			virt_addr = skb_frag_address(frag);
-			mapping = dma_map_single(&lp->pdev->dev, virt_addr,
+			mapping = skb_frag_dma_map(&lp->pdev->dev, frag, 0,
 				len, DMA_TO_DEVICE);
 			frag++;
-			skb_get(skb);
+			lp->tx_skb[lp->tx_bd_tail].mapped_as_page = 1;
 		}
 
-		lp->tx_skb[lp->tx_bd_tail].skb = skb;
+		if (dma_mapping_error(&lp->pdev->dev, mapping))
+			goto dma_err;
+
+		/* The skb is owned by (and freed from) the BD holding its
+		 * last fragment, so completion of a partially written
+		 * packet can never free a live skb.
+		 */
+		if (i == (nr_frags - 1))
+			lp->tx_skb[lp->tx_bd_tail].skb = skb;
+		else
+			lp->tx_skb[lp->tx_bd_tail].skb = NULL;
 		lp->tx_skb[lp->tx_bd_tail].mapping = mapping;
 		lp->tx_skb[lp->tx_bd_tail].len = len;
+		lp->tx_skb[lp->tx_bd_tail].persistent = 0;
 		cur_p->addr = mapping;
 
 		/* Preserve only critical status bits.  Packet is NOT to be
@@ -2053,7 +2714,7 @@ static int xemacps_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 		cur_p->ctrl = regval;
 
 		lp->tx_bd_tail++;
-		lp->tx_bd_tail = lp->tx_bd_tail % XEMACPS_SEND_BD_CNT;
+		lp->tx_bd_tail = lp->tx_bd_tail % lp->tx_bd_count;
 
 		cur_p = &(lp->tx_bd[lp->tx_bd_tail]);
 	}
@@ -2064,7 +2725,7 @@ static int xemacps_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 	 */
 	temp_bd_index = bd_tail;
 	bd_tail++;
-	bd_tail = bd_tail % XEMACPS_SEND_BD_CNT;
+	bd_tail = bd_tail % lp->tx_bd_count;
 	cur_p = &(lp->tx_bd[bd_tail]);
 	/* Clear the used bits for the BDs for a packet that consists of
 	 *  multiple BDs. For single BD packets, this loop will not execute.
@@ -2076,7 +2737,7 @@ static int xemacps_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 		regval &= ~XEMACPS_TXBUF_USED_MASK;
 		cur_p->ctrl = regval;
 		bd_tail++;
-		bd_tail = bd_tail % XEMACPS_SEND_BD_CNT;
+		bd_tail = bd_tail % lp->tx_bd_count;
 		cur_p = &(lp->tx_bd[bd_tail]);
 	}
 	/* Clear the Used bit. For single BD packets, the clearing of
@@ -2088,6 +2749,8 @@ static int xemacps_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 	regval &= ~XEMACPS_TXBUF_USED_MASK;
 	cur_p->ctrl = regval;
 
+	trace_xemacps_tx(ndev, skb->len, lp->tx_bd_freecnt);
+
 	wmb();
 	spin_lock_irqsave(&lp->nwctrlreg_lock, flags);
 	regval = xemacps_read(lp->baseaddr, XEMACPS_NWCTRL_OFFSET);
@@ -2098,16 +2761,121 @@ static int xemacps_start_xmit(struct sk_buff *skb, struct net_device *ndev)
 	spin_unlock_bh(&lp->tx_lock);
 	ndev->trans_start = jiffies;
 	return 0;
-}
 
-/*
- * Get the MAC Address bit from the specified position
- */
-static unsigned get_bit(u8 *mac, unsigned bit)
-{
-	unsigned byte;
+dma_err:
+	/* Unwind the fragments mapped so far and drop the packet. The Used
+	 * bits of the consumed BDs were never cleared, so the hardware will
+	 * not look at them.
+	 */
+	lp->tx_bd_freecnt += nr_frags;
+	while (i--) {
+		struct ring_info *rp;
+
+		lp->tx_bd_tail = (lp->tx_bd_tail ? lp->tx_bd_tail :
+					lp->tx_bd_count) - 1;
+		rp = &lp->tx_skb[lp->tx_bd_tail];
+		if (rp->mapped_as_page)
+			dma_unmap_page(&lp->pdev->dev, rp->mapping, rp->len,
+				DMA_TO_DEVICE);
+		else
+			dma_unmap_single(&lp->pdev->dev, rp->mapping, rp->len,
+				DMA_TO_DEVICE);
+		rp->skb = NULL;
+		rp->mapping = 0;
+	}
+	spin_unlock_bh(&lp->tx_lock);
+	dev_kfree_skb(skb);
+	lp->stats.tx_dropped++;
+	return NETDEV_TX_OK;
+}
 
-	byte = mac[bit / 8];
+/**
+ * xemacps_tx_requeue - resend a previously transmitted, unmodified skb
+ * @skb: socket buffer
+ * @ndev: network interface device structure
+ * return 0 on success, other value if error
+ *
+ * pktgen fast path: the payload was cleaned to memory when the buffer
+ * was first mapped and has not been touched since, so requeueing it is
+ * reduced to filling one BD and hitting the start bit - no DMA mapping
+ * or cache maintenance per packet. Non-linear skbs take the regular
+ * transmit routine.
+ **/
+static int xemacps_tx_requeue(struct sk_buff *skb, struct net_device *ndev)
+{
+	struct net_local *lp = netdev_priv(ndev);
+	struct xemacps_bd *cur_p;
+	unsigned long flags;
+	u32 regval;
+
+	if (skb_shinfo(skb)->nr_frags)
+		return xemacps_start_xmit(skb, ndev);
+
+	spin_lock_bh(&lp->tx_lock);
+
+	if (!lp->tx_bd_freecnt) {
+		netif_stop_queue(ndev);
+		spin_unlock_bh(&lp->tx_lock);
+		return NETDEV_TX_BUSY;
+	}
+
+	if (lp->txreq_skb != skb) {
+		/* First pass for this buffer, map it once. The generator
+		 * sent it through the regular transmit routine before, so
+		 * a stale mapping cannot be cached here.
+		 */
+		lp->txreq_len = skb_headlen(skb);
+		lp->txreq_mapping = dma_map_single(&lp->pdev->dev, skb->data,
+				lp->txreq_len, DMA_TO_DEVICE);
+		if (dma_mapping_error(&lp->pdev->dev, lp->txreq_mapping)) {
+			spin_unlock_bh(&lp->tx_lock);
+			dev_kfree_skb(skb);
+			lp->stats.tx_dropped++;
+			return NETDEV_TX_OK;
+		}
+		lp->txreq_skb = skb;
+	}
+
+	lp->tx_bd_freecnt--;
+	lp->tx_skb[lp->tx_bd_tail].skb = skb;
+	lp->tx_skb[lp->tx_bd_tail].mapping = lp->txreq_mapping;
+	lp->tx_skb[lp->tx_bd_tail].len = lp->txreq_len;
+	lp->tx_skb[lp->tx_bd_tail].mapped_as_page = 0;
+	lp->tx_skb[lp->tx_bd_tail].persistent = 1;
+
+	cur_p = &(lp->tx_bd[lp->tx_bd_tail]);
+	cur_p->addr = lp->txreq_mapping;
+	regval = cur_p->ctrl;
+	regval &= (XEMACPS_TXBUF_USED_MASK | XEMACPS_TXBUF_WRAP_MASK);
+	regval |= (lp->txreq_len | XEMACPS_TXBUF_LAST_MASK);
+	cur_p->ctrl = regval;
+	wmb();
+	/* Clearing the Used bit commits the BD to hardware */
+	cur_p->ctrl = regval & ~XEMACPS_TXBUF_USED_MASK;
+
+	lp->tx_bd_tail++;
+	lp->tx_bd_tail = lp->tx_bd_tail % lp->tx_bd_count;
+
+	wmb();
+	spin_lock_irqsave(&lp->nwctrlreg_lock, flags);
+	regval = xemacps_read(lp->baseaddr, XEMACPS_NWCTRL_OFFSET);
+	xemacps_write(lp->baseaddr, XEMACPS_NWCTRL_OFFSET,
+			(regval | XEMACPS_NWCTRL_STARTTX_MASK));
+	spin_unlock_irqrestore(&lp->nwctrlreg_lock, flags);
+
+	spin_unlock_bh(&lp->tx_lock);
+	ndev->trans_start = jiffies;
+	return NETDEV_TX_OK;
+}
+
+/*
+ * Get the MAC Address bit from the specified position
+ */
+static unsigned get_bit(u8 *mac, unsigned bit)
+{
+	unsigned byte;
+
+	byte = mac[bit / 8];
 	byte >>= (bit & 0x7);
 	byte &= 1;
 
@@ -2254,6 +3022,40 @@ static void xemacps_set_rx_mode(struct net_device *ndev)
 	xemacps_write(lp->baseaddr, XEMACPS_NWCFG_OFFSET, regval);
 }
 
+/**
+ * xemacps_set_features - toggle hardware offloads at runtime
+ * @ndev: network interface device structure
+ * @features: the feature set requested through ethtool -K
+ * return: 0 always
+ **/
+static int xemacps_set_features(struct net_device *ndev,
+		netdev_features_t features)
+{
+	struct net_local *lp = netdev_priv(ndev);
+	netdev_features_t changed = ndev->features ^ features;
+	u32 regval;
+
+	if (changed & NETIF_F_RXCSUM) {
+		regval = xemacps_read(lp->baseaddr, XEMACPS_NWCFG_OFFSET);
+		if (features & NETIF_F_RXCSUM)
+			regval |= XEMACPS_NWCFG_RXCHKSUMEN_MASK;
+		else
+			regval &= ~XEMACPS_NWCFG_RXCHKSUMEN_MASK;
+		xemacps_write(lp->baseaddr, XEMACPS_NWCFG_OFFSET, regval);
+	}
+
+	if (changed & NETIF_F_IP_CSUM) {
+		regval = xemacps_read(lp->baseaddr, XEMACPS_DMACR_OFFSET);
+		if (features & NETIF_F_IP_CSUM)
+			regval |= XEMACPS_DMACR_TCPCKSUM_MASK;
+		else
+			regval &= ~XEMACPS_DMACR_TCPCKSUM_MASK;
+		xemacps_write(lp->baseaddr, XEMACPS_DMACR_OFFSET, regval);
+	}
+
+	return 0;
+}
+
 #define MIN_MTU 60
 #define MAX_MTU 1500
 /**
@@ -2336,12 +3138,68 @@ xemacps_get_drvinfo(struct net_device *ndev, struct ethtool_drvinfo *ed)
 static void
 xemacps_get_ringparam(struct net_device *ndev, struct ethtool_ringparam *erp)
 {
+	struct net_local *lp = netdev_priv(ndev);
+
 	memset(erp, 0, sizeof(struct ethtool_ringparam));
 
-	erp->rx_max_pending = XEMACPS_RECV_BD_CNT;
-	erp->tx_max_pending = XEMACPS_SEND_BD_CNT;
-	erp->rx_pending = 0;
-	erp->tx_pending = 0;
+	erp->rx_max_pending = XEMACPS_MAX_BD_CNT;
+	erp->tx_max_pending = XEMACPS_MAX_BD_CNT;
+	erp->rx_pending = lp->rx_bd_count;
+	erp->tx_pending = lp->tx_bd_count;
+}
+
+/**
+ * xemacps_set_ringparam - set device dma ring sizes.
+ * Usage: Issue "ethtool -G ethX rx N tx N" under linux prompt
+ * @ndev: network device
+ * @erp: ethtool ring parameter structure
+ * return 0 on success, negative value if error
+ *
+ * A running interface is brought down, the rings are reallocated with
+ * the new sizes and the interface is brought back up again. If the
+ * reallocation fails the old sizes are restored.
+ **/
+static int
+xemacps_set_ringparam(struct net_device *ndev, struct ethtool_ringparam *erp)
+{
+	struct net_local *lp = netdev_priv(ndev);
+	u32 old_rx_count, old_tx_count;
+	int rc = 0;
+
+	if (erp->rx_mini_pending || erp->rx_jumbo_pending)
+		return -EINVAL;
+
+	if (erp->rx_pending < XEMACPS_MIN_BD_CNT ||
+		erp->rx_pending > XEMACPS_MAX_BD_CNT ||
+		erp->tx_pending < XEMACPS_MIN_BD_CNT ||
+		erp->tx_pending > XEMACPS_MAX_BD_CNT)
+		return -EINVAL;
+
+	if (erp->rx_pending == lp->rx_bd_count &&
+		erp->tx_pending == lp->tx_bd_count)
+		return 0;
+
+	old_rx_count = lp->rx_bd_count;
+	old_tx_count = lp->tx_bd_count;
+
+	if (!netif_running(ndev)) {
+		lp->rx_bd_count = erp->rx_pending;
+		lp->tx_bd_count = erp->tx_pending;
+		return 0;
+	}
+
+	xemacps_close(ndev);
+	lp->rx_bd_count = erp->rx_pending;
+	lp->tx_bd_count = erp->tx_pending;
+	rc = xemacps_open(ndev);
+	if (rc) {
+		/* Fall back to the old ring sizes before giving up */
+		lp->rx_bd_count = old_rx_count;
+		lp->tx_bd_count = old_tx_count;
+		rc = xemacps_open(ndev);
+	}
+
+	return rc;
 }
 
 /**
@@ -2462,6 +3320,213 @@ xemacps_set_pauseparam(struct net_device *ndev,
 	return 0;
 }
 
+/**
+ * xemacps_get_coalesce - get device interrupt mitigation settings
+ * Usage: Issue "ethtool -c ethX" under linux prompt
+ * @ndev: network device
+ * @ec: ethtool coalesce structure
+ * return: 0 always
+ **/
+static int
+xemacps_get_coalesce(struct net_device *ndev, struct ethtool_coalesce *ec)
+{
+	struct net_local *lp = netdev_priv(ndev);
+
+	ec->rx_coalesce_usecs = lp->rx_coalesce_usecs;
+	return 0;
+}
+
+/**
+ * xemacps_set_coalesce - set device interrupt mitigation settings
+ * Usage: Issue "ethtool -C ethX rx-usecs N" under linux prompt
+ * @ndev: network device
+ * @ec: ethtool coalesce structure
+ * return: 0 on success, negative value if error
+ *
+ * The GEM has no hardware coalescing support, so the mitigation is
+ * implemented with a timer delaying the NAPI schedule after the first
+ * frame-received interrupt of a burst. rx-usecs 0 disables it.
+ **/
+static int
+xemacps_set_coalesce(struct net_device *ndev, struct ethtool_coalesce *ec)
+{
+	struct net_local *lp = netdev_priv(ndev);
+
+	if (ec->rx_coalesce_usecs > XEMACPS_COALESCE_USECS_MAX)
+		return -EINVAL;
+
+	lp->rx_coalesce_usecs = ec->rx_coalesce_usecs;
+	return 0;
+}
+
+/**
+ * xemacps_insert_typeid_rule - program an EtherType rule into a matcher
+ * @lp: local device instance pointer
+ * @fs: classification rule from userspace
+ * return: 0 on success, negative errno on an unsupportable rule
+ *
+ * The GEM type ID screeners compare the EtherType field only and the
+ * controller has a single receive queue, so the rule must be an
+ * ETHER_FLOW matching on the full protocol field alone and must not ask
+ * for steering. Matched frames are delivered ahead of GRO at control
+ * priority by xemacps_rx.
+ **/
+static int xemacps_insert_typeid_rule(struct net_local *lp,
+				struct ethtool_rx_flow_spec *fs)
+{
+	const struct ethhdr *eth = &fs->h_u.ether_spec;
+	const struct ethhdr *mask = &fs->m_u.ether_spec;
+	u32 loc = fs->location;
+
+	if (fs->flow_type != ETHER_FLOW)
+		return -EOPNOTSUPP;
+	/* Single receive queue; the screeners classify, they cannot steer */
+	if (fs->ring_cookie != 0)
+		return -EINVAL;
+	if (mask->h_proto != htons(0xFFFF) ||
+			!is_zero_ether_addr(mask->h_source) ||
+			!is_zero_ether_addr(mask->h_dest))
+		return -EINVAL;
+
+	if (loc == RX_CLS_LOC_ANY) {
+		for (loc = 0; loc < XEMACPS_NUM_TYPEID; loc++)
+			if (!(lp->typeid_active & (1 << loc)))
+				break;
+		if (loc == XEMACPS_NUM_TYPEID)
+			return -ENOSPC;
+		fs->location = loc;
+	} else if (loc >= XEMACPS_NUM_TYPEID) {
+		return -EINVAL;
+	}
+
+	lp->typeid_proto[loc] = ntohs(eth->h_proto);
+	/* Clocks may be gated while the interface is down; xemacps_init_hw
+	 * programs the stored rules when it comes up.
+	 */
+	if (netif_running(lp->ndev))
+		xemacps_write(lp->baseaddr, XEMACPS_MATCH1_OFFSET + loc * 4,
+				lp->typeid_proto[loc]);
+	lp->typeid_active |= 1 << loc;
+	return 0;
+}
+
+/**
+ * xemacps_get_rxnfc - report RX flow classification rules
+ * @ndev: network device
+ * @cmd: rxnfc command block
+ * @rule_locs: array to fill with active rule locations
+ * return: 0 on success, negative errno otherwise
+ **/
+static int xemacps_get_rxnfc(struct net_device *ndev,
+				struct ethtool_rxnfc *cmd, u32 *rule_locs)
+{
+	struct net_local *lp = netdev_priv(ndev);
+	int cnt = 0;
+	u32 i;
+
+	switch (cmd->cmd) {
+	case ETHTOOL_GRXRINGS:
+		cmd->data = 1;
+		return 0;
+	case ETHTOOL_GRXCLSRLCNT:
+		cmd->rule_cnt = hweight32(lp->typeid_active);
+		cmd->data = XEMACPS_NUM_TYPEID;
+		return 0;
+	case ETHTOOL_GRXCLSRULE:
+		i = cmd->fs.location;
+		if (i >= XEMACPS_NUM_TYPEID ||
+				!(lp->typeid_active & (1 << i)))
+			return -ENOENT;
+		memset(&cmd->fs, 0, sizeof(cmd->fs));
+		cmd->fs.location = i;
+		cmd->fs.flow_type = ETHER_FLOW;
+		cmd->fs.h_u.ether_spec.h_proto = htons(lp->typeid_proto[i]);
+		cmd->fs.m_u.ether_spec.h_proto = htons(0xFFFF);
+		return 0;
+	case ETHTOOL_GRXCLSRLALL:
+		for (i = 0; i < XEMACPS_NUM_TYPEID; i++) {
+			if (!(lp->typeid_active & (1 << i)))
+				continue;
+			if (cnt == cmd->rule_cnt)
+				return -EMSGSIZE;
+			rule_locs[cnt++] = i;
+		}
+		cmd->rule_cnt = cnt;
+		cmd->data = XEMACPS_NUM_TYPEID;
+		return 0;
+	default:
+		return -EOPNOTSUPP;
+	}
+}
+
+/**
+ * xemacps_set_rxnfc - insert or delete an RX flow classification rule
+ * @ndev: network device
+ * @cmd: rxnfc command block
+ * return: 0 on success, negative errno otherwise
+ **/
+static int xemacps_set_rxnfc(struct net_device *ndev,
+				struct ethtool_rxnfc *cmd)
+{
+	struct net_local *lp = netdev_priv(ndev);
+	u32 loc;
+
+	switch (cmd->cmd) {
+	case ETHTOOL_SRXCLSRLINS:
+		return xemacps_insert_typeid_rule(lp, &cmd->fs);
+	case ETHTOOL_SRXCLSRLDEL:
+		loc = cmd->fs.location;
+		if (loc >= XEMACPS_NUM_TYPEID ||
+				!(lp->typeid_active & (1 << loc)))
+			return -ENOENT;
+		lp->typeid_active &= ~(1 << loc);
+		lp->typeid_proto[loc] = 0;
+		if (netif_running(ndev))
+			xemacps_write(lp->baseaddr,
+					XEMACPS_MATCH1_OFFSET + loc * 4, 0);
+		return 0;
+	default:
+		return -EOPNOTSUPP;
+	}
+}
+
+/**
+ * xemacps_get_eee - get the EEE advertisement and status from the PHY
+ * @ndev: network device
+ * @edata: eee structure to fill in
+ * return 0 on success, negative value if error
+ **/
+static int xemacps_get_eee(struct net_device *ndev, struct ethtool_eee *edata)
+{
+	struct net_local *lp = netdev_priv(ndev);
+
+	if (!lp->phy_dev)
+		return -ENODEV;
+
+	return phy_ethtool_get_eee(lp->phy_dev, edata);
+}
+
+/**
+ * xemacps_set_eee - program the EEE advertisement into the PHY
+ * @ndev: network device
+ * @edata: eee parameters to apply
+ * return 0 on success, negative value if error
+ *
+ * The GEM has no LPI request logic, so only the PHY side of EEE is
+ * managed here: with EEE advertised and negotiated, the PHY drops the
+ * receive side into low power whenever the link partner signals LPI,
+ * which on a mostly idle link is most of the time.
+ **/
+static int xemacps_set_eee(struct net_device *ndev, struct ethtool_eee *edata)
+{
+	struct net_local *lp = netdev_priv(ndev);
+
+	if (!lp->phy_dev)
+		return -ENODEV;
+
+	return phy_ethtool_set_eee(lp->phy_dev, edata);
+}
+
 /**
  * xemacps_get_stats - get device statistic raw data in 64bit mode
  * @ndev: network device
@@ -2476,16 +3541,155 @@ static struct net_device_stats
 	return nstat;
 }
 
+/* ethtool -S names, in xemacps_hw_stat order */
+static const char xemacps_hw_stat_names[XEMACPS_NUM_HW_STATS][ETH_GSTRING_LEN] = {
+	"tx_octets",
+	"tx_frames",
+	"tx_broadcast_frames",
+	"tx_multicast_frames",
+	"tx_pause_frames",
+	"tx_64_byte_frames",
+	"tx_65_127_byte_frames",
+	"tx_128_255_byte_frames",
+	"tx_256_511_byte_frames",
+	"tx_512_1023_byte_frames",
+	"tx_1024_1518_byte_frames",
+	"tx_greater_than_1518_byte_frames",
+	"tx_underrun_errors",
+	"tx_single_collision_frames",
+	"tx_multiple_collision_frames",
+	"tx_excessive_collisions",
+	"tx_late_collisions",
+	"tx_deferred_frames",
+	"tx_carrier_sense_errors",
+	"rx_octets",
+	"rx_frames",
+	"rx_broadcast_frames",
+	"rx_multicast_frames",
+	"rx_pause_frames",
+	"rx_64_byte_frames",
+	"rx_65_127_byte_frames",
+	"rx_128_255_byte_frames",
+	"rx_256_511_byte_frames",
+	"rx_512_1023_byte_frames",
+	"rx_1024_1518_byte_frames",
+	"rx_1519_plus_byte_frames",
+	"rx_undersized_frames",
+	"rx_oversized_frames",
+	"rx_jabbers",
+	"rx_fcs_errors",
+	"rx_length_field_errors",
+	"rx_symbol_errors",
+	"rx_alignment_errors",
+	"rx_resource_errors",
+	"rx_overrun_errors",
+	"rx_ip_checksum_errors",
+	"rx_tcp_checksum_errors",
+	"rx_udp_checksum_errors",
+};
+
+/**
+ * xemacps_get_strings - return the string set for a given id
+ * Usage: Issue "ethtool -S ethX" under linux prompt
+ * @ndev: network device
+ * @sset: string set id
+ * @data: buffer to fill the names into
+ **/
+static void xemacps_get_strings(struct net_device *ndev, u32 sset, u8 *data)
+{
+	if (sset == ETH_SS_STATS)
+		memcpy(data, xemacps_hw_stat_names,
+		       sizeof(xemacps_hw_stat_names));
+}
+
+/**
+ * xemacps_get_sset_count - return the number of strings in a string set
+ * @ndev: network device
+ * @sset: string set id
+ * return: number of strings or -EOPNOTSUPP
+ **/
+static int xemacps_get_sset_count(struct net_device *ndev, int sset)
+{
+	if (sset == ETH_SS_STATS)
+		return XEMACPS_NUM_HW_STATS;
+	return -EOPNOTSUPP;
+}
+
+/**
+ * xemacps_get_ethtool_stats - return the accumulated hardware counters
+ * Usage: Issue "ethtool -S ethX" under linux prompt
+ * @ndev: network device
+ * @stats: ethtool stats structure
+ * @data: buffer to fill the counter values into
+ *
+ * The registers are harvested into the 64-bit accumulators first, so
+ * the reported values are current and safe against the 32-bit
+ * hardware counters wrapping.
+ **/
+static void xemacps_get_ethtool_stats(struct net_device *ndev,
+				      struct ethtool_stats *stats, u64 *data)
+{
+	struct net_local *lp = netdev_priv(ndev);
+	unsigned long flags;
+
+	xemacps_update_stats((unsigned long)lp);
+
+	spin_lock_irqsave(&lp->stats_lock, flags);
+	memcpy(data, lp->hw_stats, sizeof(lp->hw_stats));
+	spin_unlock_irqrestore(&lp->stats_lock, flags);
+}
+
+#ifdef CONFIG_XILINX_PS_EMAC_HWTSTAMP
+/**
+ * xemacps_get_ts_info - report timestamping and PHC capabilities
+ * @ndev: network interface device structure
+ * @info: timestamping capability structure to fill in
+ * Return 0 always
+ */
+static int xemacps_get_ts_info(struct net_device *ndev,
+				struct ethtool_ts_info *info)
+{
+	struct net_local *lp = netdev_priv(ndev);
+
+	info->so_timestamping = SOF_TIMESTAMPING_TX_HARDWARE |
+				SOF_TIMESTAMPING_RX_HARDWARE |
+				SOF_TIMESTAMPING_RAW_HARDWARE |
+				SOF_TIMESTAMPING_RX_SOFTWARE |
+				SOF_TIMESTAMPING_SOFTWARE;
+	info->phc_index = lp->ptp_clock ?
+				ptp_clock_index(lp->ptp_clock) : -1;
+	info->tx_types = (1 << HWTSTAMP_TX_OFF) |
+				(1 << HWTSTAMP_TX_ON);
+	info->rx_filters = (1 << HWTSTAMP_FILTER_NONE) |
+				(1 << HWTSTAMP_FILTER_ALL);
+
+	return 0;
+}
+#endif /* CONFIG_XILINX_PS_EMAC_HWTSTAMP */
+
 static struct ethtool_ops xemacps_ethtool_ops = {
 	.get_settings   = xemacps_get_settings,
 	.set_settings   = xemacps_set_settings,
 	.get_drvinfo    = xemacps_get_drvinfo,
 	.get_link       = ethtool_op_get_link, /* ethtool default */
 	.get_ringparam  = xemacps_get_ringparam,
+	.set_ringparam  = xemacps_set_ringparam,
 	.get_wol        = xemacps_get_wol,
 	.set_wol        = xemacps_set_wol,
 	.get_pauseparam = xemacps_get_pauseparam,
 	.set_pauseparam = xemacps_set_pauseparam,
+	.get_coalesce   = xemacps_get_coalesce,
+	.set_coalesce   = xemacps_set_coalesce,
+	.get_rxnfc      = xemacps_get_rxnfc,
+	.set_rxnfc      = xemacps_set_rxnfc,
+	.get_eee        = xemacps_get_eee,
+	.set_eee        = xemacps_set_eee,
+	.get_strings    = xemacps_get_strings,
+	.get_sset_count = xemacps_get_sset_count,
+	.get_ethtool_stats = xemacps_get_ethtool_stats,
+#ifdef CONFIG_XILINX_PS_EMAC_HWTSTAMP
+	.get_ts_info    = xemacps_get_ts_info,
+#endif
 };
 
 #ifdef CONFIG_XILINX_PS_EMAC_HWTSTAMP
@@ -2577,6 +3781,76 @@ static int xemacps_ioctl(struct net_device *ndev, struct ifreq *rq, int cmd)
 
 }
 
+#ifdef CONFIG_RPS
+/**
+ * xemacps_rx_steering_setup - spread the receive work over both cores
+ * @lp: local device instance pointer
+ *
+ * The GEM has a single queue, so by default the whole receive path runs
+ * on the cpu taking the interrupt while the second A9 core idles.
+ * Install a default RPS map that steers protocol processing to the
+ * remaining online cpus: the NAPI poll stays on the interrupt cpu and
+ * hands skb batches to the remote backlog through the normal
+ * netif_receive_skb() path, which also leaves TX completion running
+ * opposite the RX stack work.  The map stays under the usual
+ * /sys/class/net/<dev>/queues/rx-0/rps_cpus control, this only changes
+ * the default.
+ */
+static void xemacps_rx_steering_setup(struct net_local *lp)
+{
+	struct rps_map *map;
+	int irqcpu = cpumask_first(cpu_online_mask);
+	int cpu;
+	int i = 0;
+
+	if (num_online_cpus() < 2)
+		return;
+
+	map = kzalloc(max_t(unsigned int,
+			RPS_MAP_SIZE(num_possible_cpus()), L1_CACHE_BYTES),
+			GFP_KERNEL);
+	if (!map)
+		return;
+
+	for_each_online_cpu(cpu)
+		if (cpu != irqcpu)
+			map->cpus[i++] = cpu;
+	map->len = i;
+
+	irq_set_affinity_hint(lp->ndev->irq, cpumask_of(irqcpu));
+
+	rcu_assign_pointer(lp->ndev->_rx[0].rps_map, map);
+	static_key_slow_inc(&rps_needed);
+}
+
+/**
+ * xemacps_rx_steering_teardown - drop the default RPS map
+ * @lp: local device instance pointer
+ */
+static void xemacps_rx_steering_teardown(struct net_local *lp)
+{
+	struct rps_map *map;
+
+	irq_set_affinity_hint(lp->ndev->irq, NULL);
+
+	map = rcu_dereference_protected(lp->ndev->_rx[0].rps_map, 1);
+	if (!map)
+		return;
+
+	RCU_INIT_POINTER(lp->ndev->_rx[0].rps_map, NULL);
+	kfree_rcu(map, rcu);
+	static_key_slow_dec(&rps_needed);
+}
+#else
+static void xemacps_rx_steering_setup(struct net_local *lp)
+{
+}
+
+static void xemacps_rx_steering_teardown(struct net_local *lp)
+{
+}
+#endif /* CONFIG_RPS */
+
 /**
  * xemacps_probe - Platform driver probe
  * @pdev: Pointer to platform device structure
@@ -2591,6 +3865,9 @@ static int xemacps_probe(struct platform_device *pdev)
 	struct net_local *lp;
 	u32 regval = 0;
 	int rc = -ENXIO;
+#ifdef CONFIG_XILINX_PS_EMAC_HWTSTAMP
+	const void *prop;
+#endif
 
 	r_mem = platform_get_resource(pdev, IORESOURCE_MEM, 0);
 	r_irq = platform_get_resource(pdev, IORESOURCE_IRQ, 0);
@@ -2616,6 +3893,8 @@ static int xemacps_probe(struct platform_device *pdev)
 	spin_lock_init(&lp->tx_lock);
 	spin_lock_init(&lp->rx_lock);
 	spin_lock_init(&lp->nwctrlreg_lock);
+	spin_lock_init(&lp->stats_lock);
+	init_completion(&lp->mdio_done);
 
 	lp->baseaddr = ioremap(r_mem->start, (r_mem->end - r_mem->start + 1));
 	if (!lp->baseaddr) {
@@ -2633,10 +3912,24 @@ static int xemacps_probe(struct platform_device *pdev)
 	ndev->watchdog_timeo = TX_TIMEOUT;
 	ndev->ethtool_ops = &xemacps_ethtool_ops;
 	ndev->base_addr = r_mem->start;
-	ndev->features = NETIF_F_IP_CSUM | NETIF_F_SG;
+	ndev->hw_features = NETIF_F_IP_CSUM | NETIF_F_SG | NETIF_F_RXCSUM;
+	ndev->features = ndev->hw_features;
 	netif_napi_add(ndev, &lp->napi, xemacps_rx_poll, XEMACPS_NAPI_WEIGHT);
 
-	lp->ip_summed = CHECKSUM_UNNECESSARY;
+	hrtimer_init(&lp->rx_coalesce_timer, CLOCK_MONOTONIC,
+			HRTIMER_MODE_REL);
+	lp->rx_coalesce_timer.function = xemacps_rx_coalesce_expiry;
+	lp->rx_coalesce_usecs = 0;
+
+	lp->rx_bd_count = XEMACPS_RECV_BD_CNT;
+	lp->tx_bd_count = XEMACPS_SEND_BD_CNT;
+
+	/* Without TSO a socket needs only enough queued bytes to keep
+	 * the TX BD ring from running dry between completions; the
+	 * 128KB global TSQ default builds tens of ms of queue at a few
+	 * hundred Mbit/s.
+	 */
+	ndev->tsq_limit_output = 32768;
 
 	rc = register_netdev(ndev);
 	if (rc) {
@@ -2692,6 +3985,12 @@ static int xemacps_probe(struct platform_device *pdev)
 		lp->ptpenetclk = (u32)be32_to_cpup(prop);
 	else
 		lp->ptpenetclk = 133333328;
+
+	/* The PHC is usable as soon as it is registered, so bring the
+	 * TSU and the timecounter up before exposing them
+	 */
+	xemacps_init_tsu(lp);
+	xemacps_ptp_register(lp);
 #endif
 
 	lp->phy_node = of_parse_phandle(lp->pdev->dev.of_node,
@@ -2721,9 +4020,6 @@ static int xemacps_probe(struct platform_device *pdev)
 	}
 
 	xemacps_update_hwaddr(lp);
-	tasklet_init(&lp->tx_bdreclaim_tasklet, xemacps_tx_poll,
-		     (unsigned long) ndev);
-	tasklet_disable(&lp->tx_bdreclaim_tasklet);
 
 	lp->txtimeout_handler_wq = create_singlethread_workqueue(DRIVER_NAME);
 	INIT_WORK(&lp->txtimeout_reinit, xemacps_reinit_for_txtimeout);
@@ -2731,6 +4027,8 @@ static int xemacps_probe(struct platform_device *pdev)
 	platform_set_drvdata(pdev, ndev);
 	pm_runtime_set_active(&pdev->dev);
 	pm_runtime_enable(&pdev->dev);
+	/* nothing in the resume chain depends on the MAC being back first */
+	device_enable_async_suspend(&pdev->dev);
 
 	dev_info(&lp->pdev->dev, "pdev->id %d, baseaddr 0x%08lx, irq %d\n",
 		pdev->id, ndev->base_addr, ndev->irq);
@@ -2743,6 +4041,8 @@ static int xemacps_probe(struct platform_device *pdev)
 		goto err_out_unregister_clk_notifier;
 	}
 
+	xemacps_rx_steering_setup(lp);
+
 	return 0;
 
 err_out_unregister_clk_notifier:
@@ -2779,6 +4079,11 @@ static int __exit xemacps_remove(struct platform_device *pdev)
 	if (ndev) {
 		lp = netdev_priv(ndev);
 
+#ifdef CONFIG_XILINX_PS_EMAC_HWTSTAMP
+		if (lp->ptp_clock)
+			ptp_clock_unregister(lp->ptp_clock);
+#endif
+		xemacps_rx_steering_teardown(lp);
 		mdiobus_unregister(lp->mii_bus);
 		kfree(lp->mii_bus->irq);
 		mdiobus_free(lp->mii_bus);
@@ -2803,6 +4108,32 @@ static int __exit xemacps_remove(struct platform_device *pdev)
 	return 0;
 }
 
+/**
+ * xemacps_shutdown - quiesce the MAC for reboot or kexec
+ * @pdev: Pointer to the platform device structure
+ *
+ * Resets the GEM so its BD fetch engines stop writing into memory
+ * before the next kernel takes over without a DDR reset in between.
+ */
+static void xemacps_shutdown(struct platform_device *pdev)
+{
+	struct net_device *ndev = platform_get_drvdata(pdev);
+	struct net_local *lp;
+
+	if (!ndev)
+		return;
+
+	lp = netdev_priv(ndev);
+	rtnl_lock();
+	netif_device_detach(ndev);
+	if (netif_running(ndev)) {
+		netif_stop_queue(ndev);
+		napi_disable(&lp->napi);
+		xemacps_reset_hw(lp);
+	}
+	rtnl_unlock();
+}
+
 #ifdef CONFIG_PM
 #ifdef CONFIG_PM_SLEEP
 /**
@@ -2911,7 +4242,9 @@ static struct net_device_ops netdev_ops = {
 	.ndo_open		= xemacps_open,
 	.ndo_stop		= xemacps_close,
 	.ndo_start_xmit		= xemacps_start_xmit,
+	.ndo_tx_requeue		= xemacps_tx_requeue,
 	.ndo_set_rx_mode	= xemacps_set_rx_mode,
+	.ndo_set_features	= xemacps_set_features,
 	.ndo_set_mac_address    = xemacps_set_mac_address,
 	.ndo_do_ioctl		= xemacps_ioctl,
 	.ndo_change_mtu		= xemacps_change_mtu,
@@ -2928,11 +4261,14 @@ MODULE_DEVICE_TABLE(of, xemacps_of_match);
 static struct platform_driver xemacps_driver = {
 	.probe   = xemacps_probe,
 	.remove  = xemacps_remove,
+	.shutdown = xemacps_shutdown,
 	.driver  = {
 		.name  = DRIVER_NAME,
 		.owner = THIS_MODULE,
 		.of_match_table = xemacps_of_match,
 		.pm = XEMACPS_PM,
+		/* MDIO bus scan dominates probe time */
+		.probe_async = true,
 	},
 };
 
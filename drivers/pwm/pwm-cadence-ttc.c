@@ -0,0 +1,346 @@
+/*
+ * Driver for the PWM outputs of the Cadence Triple Timer Counter (TTC)
+ * found on Xilinx Zynq SoCs.
+ *
+ *  Copyright (C) 2013 Xilinx
+ *
+ * Each TTC block provides three independent 16-bit count-up channels
+ * with a waveform output pin. A channel in interval mode asserts its
+ * output at counter reset and deasserts it when the match register is
+ * hit, giving a PWM with the interval register as period and the match
+ * register as duty cycle.
+ *
+ * The interval and match registers are not shadowed by the hardware,
+ * so reprogramming a running channel directly would glitch the cycle
+ * in flight. Instead, pwm_config() on an enabled channel latches the
+ * new values and arms the channel's interval interrupt; the interrupt
+ * handler applies them right after rollover, when the counter is near
+ * zero. Reconfiguring several channels back to back therefore returns
+ * immediately and each channel switches cleanly at its own period
+ * boundary.
+ *
+ * Use a TTC block that is not claimed by the clocksource driver.
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <linux/clk.h>
+#include <linux/err.h>
+#include <linux/interrupt.h>
+#include <linux/io.h>
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/of.h>
+#include <linux/platform_device.h>
+#include <linux/pwm.h>
+#include <linux/slab.h>
+#include <linux/spinlock.h>
+
+#define TTC_PWM_NR_CHANNELS	3
+
+/*
+ * Register offsets of channel 0; channels 1 and 2 use the same layout
+ * at base + 4 and base + 8.
+ */
+#define TTC_CLK_CNTRL_OFFSET	0x00
+#define TTC_CNT_CNTRL_OFFSET	0x0C
+#define TTC_INTR_VAL_OFFSET	0x24
+#define TTC_MATCH_1_OFFSET	0x30
+#define TTC_ISR_OFFSET		0x54
+#define TTC_IER_OFFSET		0x60
+
+#define TTC_CLK_CNTRL_PS_EN	(1 << 0)
+#define TTC_CLK_CNTRL_PS_VAL(x)	((x) << 1)
+
+#define TTC_CNT_CNTRL_DISABLE	(1 << 0)
+#define TTC_CNT_CNTRL_INTERVAL	(1 << 1)
+#define TTC_CNT_CNTRL_MATCH	(1 << 3)
+#define TTC_CNT_CNTRL_RESET	(1 << 4)
+#define TTC_CNT_CNTRL_WAVE_DIS	(1 << 5)	/* wave output, active low */
+#define TTC_CNT_CNTRL_WAVE_POL	(1 << 6)
+
+#define TTC_IXR_INTERVAL	(1 << 0)
+
+#define TTC_MAX_COUNT		0xffff
+#define TTC_MAX_PS_EXP		16	/* prescaler divides by up to 2^16 */
+
+struct ttc_pwm_chip;
+
+struct ttc_pwm_channel {
+	struct ttc_pwm_chip	*chip;
+	unsigned int		hwpwm;
+	int			irq;
+	u32			clk_ctrl;
+	u32			interval;
+	u32			match;
+	bool			pending;
+};
+
+struct ttc_pwm_chip {
+	struct pwm_chip		chip;
+	struct clk		*clk;
+	void __iomem		*base;
+	spinlock_t		lock;	/* protects channel shadow state */
+	struct ttc_pwm_channel	ch[TTC_PWM_NR_CHANNELS];
+};
+
+#define to_ttc_pwm_chip(_chip) \
+	container_of(_chip, struct ttc_pwm_chip, chip)
+
+static inline u32 ttc_pwm_readl(struct ttc_pwm_chip *ttc, unsigned int hwpwm,
+				unsigned long offset)
+{
+	return readl(ttc->base + (hwpwm << 2) + offset);
+}
+
+static inline void ttc_pwm_writel(struct ttc_pwm_chip *ttc, unsigned int hwpwm,
+				  unsigned long offset, u32 val)
+{
+	writel(val, ttc->base + (hwpwm << 2) + offset);
+}
+
+/* Write the shadowed prescaler, period and duty to the hardware */
+static void ttc_pwm_apply(struct ttc_pwm_chip *ttc,
+			  struct ttc_pwm_channel *ch)
+{
+	ttc_pwm_writel(ttc, ch->hwpwm, TTC_CLK_CNTRL_OFFSET, ch->clk_ctrl);
+	ttc_pwm_writel(ttc, ch->hwpwm, TTC_INTR_VAL_OFFSET, ch->interval);
+	ttc_pwm_writel(ttc, ch->hwpwm, TTC_MATCH_1_OFFSET, ch->match);
+}
+
+static irqreturn_t ttc_pwm_interrupt(int irq, void *dev_id)
+{
+	struct ttc_pwm_channel *ch = dev_id;
+	struct ttc_pwm_chip *ttc = ch->chip;
+	unsigned long flags;
+
+	/* Acknowledge; the status register clears on read */
+	ttc_pwm_readl(ttc, ch->hwpwm, TTC_ISR_OFFSET);
+
+	spin_lock_irqsave(&ttc->lock, flags);
+	if (ch->pending) {
+		ttc_pwm_apply(ttc, ch);
+		ch->pending = false;
+	}
+	ttc_pwm_writel(ttc, ch->hwpwm, TTC_IER_OFFSET, 0);
+	spin_unlock_irqrestore(&ttc->lock, flags);
+
+	return IRQ_HANDLED;
+}
+
+static int ttc_pwm_config(struct pwm_chip *chip, struct pwm_device *pwm,
+			  int duty_ns, int period_ns)
+{
+	struct ttc_pwm_chip *ttc = to_ttc_pwm_chip(chip);
+	struct ttc_pwm_channel *ch = &ttc->ch[pwm->hwpwm];
+	unsigned long long period, duty;
+	unsigned long rate = clk_get_rate(ttc->clk);
+	unsigned int ps_exp = 0;
+	unsigned long flags;
+
+	period = (unsigned long long)rate * period_ns;
+	do_div(period, NSEC_PER_SEC);
+
+	duty = (unsigned long long)rate * duty_ns;
+	do_div(duty, NSEC_PER_SEC);
+
+	/* Smallest prescaler that fits the period into the 16-bit counter */
+	while (period > TTC_MAX_COUNT && ps_exp < TTC_MAX_PS_EXP) {
+		period >>= 1;
+		duty >>= 1;
+		ps_exp++;
+	}
+	if (period > TTC_MAX_COUNT)
+		return -ERANGE;
+	if (!period)
+		period = 1;
+	if (duty > period)
+		duty = period;
+
+	spin_lock_irqsave(&ttc->lock, flags);
+	ch->clk_ctrl = ps_exp ?
+		(TTC_CLK_CNTRL_PS_VAL(ps_exp - 1) | TTC_CLK_CNTRL_PS_EN) : 0;
+	ch->interval = period;
+	ch->match = duty;
+
+	if (test_bit(PWMF_ENABLED, &pwm->flags)) {
+		if (ch->irq > 0) {
+			/* Applied by the interrupt at the next rollover */
+			ch->pending = true;
+			ttc_pwm_writel(ttc, ch->hwpwm, TTC_IER_OFFSET,
+				       TTC_IXR_INTERVAL);
+		} else {
+			ttc_pwm_apply(ttc, ch);
+		}
+	}
+	spin_unlock_irqrestore(&ttc->lock, flags);
+
+	return 0;
+}
+
+static int ttc_pwm_enable(struct pwm_chip *chip, struct pwm_device *pwm)
+{
+	struct ttc_pwm_chip *ttc = to_ttc_pwm_chip(chip);
+	struct ttc_pwm_channel *ch = &ttc->ch[pwm->hwpwm];
+	unsigned long flags;
+	int ret;
+
+	ret = clk_enable(ttc->clk);
+	if (ret)
+		return ret;
+
+	spin_lock_irqsave(&ttc->lock, flags);
+	ttc_pwm_apply(ttc, ch);
+
+	/*
+	 * Interval mode with match and wave output enabled (the wave
+	 * bit is active low). The polarity bit makes the output high
+	 * from counter reset until the match hits.
+	 */
+	ttc_pwm_writel(ttc, ch->hwpwm, TTC_CNT_CNTRL_OFFSET,
+		       TTC_CNT_CNTRL_INTERVAL | TTC_CNT_CNTRL_MATCH |
+		       TTC_CNT_CNTRL_RESET | TTC_CNT_CNTRL_WAVE_POL);
+	spin_unlock_irqrestore(&ttc->lock, flags);
+
+	return 0;
+}
+
+static void ttc_pwm_disable(struct pwm_chip *chip, struct pwm_device *pwm)
+{
+	struct ttc_pwm_chip *ttc = to_ttc_pwm_chip(chip);
+	struct ttc_pwm_channel *ch = &ttc->ch[pwm->hwpwm];
+	unsigned long flags;
+
+	spin_lock_irqsave(&ttc->lock, flags);
+	ch->pending = false;
+	ttc_pwm_writel(ttc, ch->hwpwm, TTC_IER_OFFSET, 0);
+	ttc_pwm_readl(ttc, ch->hwpwm, TTC_ISR_OFFSET);
+	ttc_pwm_writel(ttc, ch->hwpwm, TTC_CNT_CNTRL_OFFSET,
+		       TTC_CNT_CNTRL_DISABLE | TTC_CNT_CNTRL_WAVE_DIS);
+	spin_unlock_irqrestore(&ttc->lock, flags);
+
+	clk_disable(ttc->clk);
+}
+
+static const struct pwm_ops ttc_pwm_ops = {
+	.config = ttc_pwm_config,
+	.enable = ttc_pwm_enable,
+	.disable = ttc_pwm_disable,
+	.owner = THIS_MODULE,
+};
+
+static int ttc_pwm_probe(struct platform_device *pdev)
+{
+	struct ttc_pwm_chip *ttc;
+	struct resource *res;
+	unsigned int i;
+	int ret;
+
+	ttc = devm_kzalloc(&pdev->dev, sizeof(*ttc), GFP_KERNEL);
+	if (!ttc)
+		return -ENOMEM;
+
+	res = platform_get_resource(pdev, IORESOURCE_MEM, 0);
+	if (!res)
+		return -EINVAL;
+
+	ttc->base = devm_ioremap_resource(&pdev->dev, res);
+	if (IS_ERR(ttc->base))
+		return PTR_ERR(ttc->base);
+
+	ttc->clk = devm_clk_get(&pdev->dev, NULL);
+	if (IS_ERR(ttc->clk))
+		return PTR_ERR(ttc->clk);
+
+	ret = clk_prepare(ttc->clk);
+	if (ret)
+		return ret;
+
+	spin_lock_init(&ttc->lock);
+
+	for (i = 0; i < TTC_PWM_NR_CHANNELS; i++) {
+		struct ttc_pwm_channel *ch = &ttc->ch[i];
+
+		ch->chip = ttc;
+		ch->hwpwm = i;
+		ch->interval = 1;
+
+		/*
+		 * Without a per-channel interrupt, reconfiguration of a
+		 * running channel is applied immediately and may glitch
+		 * one cycle.
+		 */
+		ch->irq = platform_get_irq(pdev, i);
+		if (ch->irq < 0)
+			continue;
+
+		ret = devm_request_irq(&pdev->dev, ch->irq,
+				       ttc_pwm_interrupt, 0,
+				       dev_name(&pdev->dev), ch);
+		if (ret) {
+			clk_unprepare(ttc->clk);
+			return ret;
+		}
+	}
+
+	ttc->chip.dev = &pdev->dev;
+	ttc->chip.ops = &ttc_pwm_ops;
+	ttc->chip.npwm = TTC_PWM_NR_CHANNELS;
+	ttc->chip.base = -1;
+
+	ret = pwmchip_add(&ttc->chip);
+	if (ret < 0) {
+		dev_err(&pdev->dev, "failed to add PWM chip, error %d\n", ret);
+		clk_unprepare(ttc->clk);
+		return ret;
+	}
+
+	platform_set_drvdata(pdev, ttc);
+
+	return 0;
+}
+
+static int ttc_pwm_remove(struct platform_device *pdev)
+{
+	struct ttc_pwm_chip *ttc = platform_get_drvdata(pdev);
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < ttc->chip.npwm; i++)
+		pwm_disable(&ttc->chip.pwms[i]);
+
+	ret = pwmchip_remove(&ttc->chip);
+	if (ret)
+		return ret;
+
+	clk_unprepare(ttc->clk);
+
+	return 0;
+}
+
+static struct of_device_id ttc_pwm_dt_ids[] = {
+	{ .compatible = "cdns,ttc-pwm", },
+	{ /* sentinel */ }
+};
+MODULE_DEVICE_TABLE(of, ttc_pwm_dt_ids);
+
+static struct platform_driver ttc_pwm_driver = {
+	.driver = {
+		.name = "cadence-ttc-pwm",
+		.of_match_table = of_match_ptr(ttc_pwm_dt_ids),
+	},
+	.probe = ttc_pwm_probe,
+	.remove = ttc_pwm_remove,
+};
+module_platform_driver(ttc_pwm_driver);
+
+MODULE_ALIAS("platform:cadence-ttc-pwm");
+MODULE_DESCRIPTION("Cadence TTC PWM Driver");
+MODULE_LICENSE("GPL v2");
@@ -572,6 +572,29 @@ static int rproc_handle_carveout(struct rproc *rproc,
 	dev_dbg(dev, "carveout rsc: da %x, pa %x, len %x, flags %x\n",
 			rsc->da, rsc->pa, rsc->len, rsc->flags);
 
+	/*
+	 * A carveout pinned across the last shutdown can be reused as is:
+	 * its contents, including the loaded image, are still in place,
+	 * and the (potentially large) zeroing memset implied by a fresh
+	 * coherent allocation is skipped. Only meaningful without an
+	 * IOMMU, since the iommu mappings were torn down on shutdown.
+	 */
+	if (!rproc->domain) {
+		struct rproc_mem_entry *entry;
+
+		list_for_each_entry(entry, &rproc->pinned_carveouts, node) {
+			if (entry->len == rsc->len && entry->da == rsc->da) {
+				list_move_tail(&entry->node,
+						&rproc->carveouts);
+				rsc->pa = entry->dma;
+				return 0;
+			}
+		}
+	}
+
+	/* a fresh allocation comes back zeroed, so a full load is needed */
+	rproc->image_resident = false;
+
 	carveout = kzalloc(sizeof(*carveout), GFP_KERNEL);
 	if (!carveout) {
 		dev_err(dev, "kzalloc carveout failed\n");
@@ -791,6 +814,26 @@ rproc_handle_virtio_rsc(struct rproc *rproc, struct resource_table *table, int l
 	return ret;
 }
 
+/**
+ * rproc_free_pinned_carveouts() - free carveouts pinned across a restart
+ * @rproc: rproc handle
+ *
+ * Frees pinned carveouts which the current resource table did not claim
+ * (the firmware image or its layout changed), and on final teardown.
+ */
+static void rproc_free_pinned_carveouts(struct rproc *rproc)
+{
+	struct rproc_mem_entry *entry, *tmp;
+	struct device *dev = &rproc->dev;
+
+	list_for_each_entry_safe(entry, tmp, &rproc->pinned_carveouts, node) {
+		dma_free_coherent(dev->parent, entry->len, entry->va,
+								entry->dma);
+		list_del(&entry->node);
+		kfree(entry);
+	}
+}
+
 /**
  * rproc_resource_cleanup() - clean up and free all acquired resources
  * @rproc: rproc handle
@@ -802,6 +845,12 @@ static void rproc_resource_cleanup(struct rproc *rproc)
 {
 	struct rproc_mem_entry *entry, *tmp;
 	struct device *dev = &rproc->dev;
+	/*
+	 * A cleanup after a failed boot (state still offline) may leave a
+	 * partially loaded image behind, so only a running or crashed
+	 * processor gets its carveouts pinned for a fast restart.
+	 */
+	bool pin = rproc->fw_pinned && rproc->state != RPROC_OFFLINE;
 
 	/* clean up debugfs trace entries */
 	list_for_each_entry_safe(entry, tmp, &rproc->traces, node) {
@@ -813,11 +862,18 @@ static void rproc_resource_cleanup(struct rproc *rproc)
 
 	/* clean up carveout allocations */
 	list_for_each_entry_safe(entry, tmp, &rproc->carveouts, node) {
+		if (pin) {
+			list_move_tail(&entry->node, &rproc->pinned_carveouts);
+			continue;
+		}
 		dma_free_coherent(dev->parent, entry->len, entry->va, entry->dma);
 		list_del(&entry->node);
 		kfree(entry);
 	}
 
+	if (pin)
+		rproc->image_resident = true;
+
 	/* clean up iommu mapping entries */
 	list_for_each_entry_safe(entry, tmp, &rproc->mappings, node) {
 		size_t unmapped;
@@ -876,6 +932,9 @@ static int rproc_fw_boot(struct rproc *rproc, const struct firmware *fw)
 		goto clean_up;
 	}
 
+	/* drop pinned carveouts the new resource table did not claim */
+	rproc_free_pinned_carveouts(rproc);
+
 	/* load the ELF segments to memory */
 	ret = rproc_load_segments(rproc, fw);
 	if (ret) {
@@ -1077,16 +1136,26 @@ int rproc_boot(struct rproc *rproc)
 
 	dev_info(dev, "powering up %s\n", rproc->name);
 
-	/* load firmware */
-	ret = request_firmware(&firmware_p, rproc->firmware, dev);
-	if (ret < 0) {
-		dev_err(dev, "request_firmware failed: %d\n", ret);
-		goto downref_rproc;
+	/* load firmware; a pinned image skips the filesystem round trip */
+	if (rproc->cached_fw) {
+		firmware_p = rproc->cached_fw;
+	} else {
+		ret = request_firmware(&firmware_p, rproc->firmware, dev);
+		if (ret < 0) {
+			dev_err(dev, "request_firmware failed: %d\n", ret);
+			goto downref_rproc;
+		}
 	}
 
 	ret = rproc_fw_boot(rproc, firmware_p);
 
-	release_firmware(firmware_p);
+	if (!ret && rproc->fw_pinned) {
+		rproc->cached_fw = firmware_p;
+	} else {
+		/* a failed boot also drops a previously pinned image */
+		release_firmware(firmware_p);
+		rproc->cached_fw = NULL;
+	}
 
 downref_rproc:
 	if (ret) {
@@ -1219,6 +1288,9 @@ static void rproc_type_release(struct device *dev)
 
 	rproc_delete_debug_dir(rproc);
 
+	rproc_free_pinned_carveouts(rproc);
+	release_firmware(rproc->cached_fw);
+
 	idr_destroy(&rproc->notifyids);
 
 	if (rproc->index >= 0)
@@ -1299,6 +1371,7 @@ struct rproc *rproc_alloc(struct device *dev, const char *name,
 	idr_init(&rproc->notifyids);
 
 	INIT_LIST_HEAD(&rproc->carveouts);
+	INIT_LIST_HEAD(&rproc->pinned_carveouts);
 	INIT_LIST_HEAD(&rproc->mappings);
 	INIT_LIST_HEAD(&rproc->traces);
 	INIT_LIST_HEAD(&rproc->rvdevs);
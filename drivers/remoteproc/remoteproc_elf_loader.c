@@ -190,6 +190,15 @@ rproc_elf_load_segments(struct rproc *rproc, const struct firmware *fw)
 			break;
 		}
 
+		/*
+		 * If the image is still resident in carveouts pinned across
+		 * the previous run, read-only segments are untouched and
+		 * need not be copied again; only writable segments must be
+		 * restored and their bss re-zeroed.
+		 */
+		if (rproc->image_resident && !(phdr->p_flags & PF_W))
+			continue;
+
 		/* put the segment where the remote processor expects it */
 		if (phdr->p_filesz)
 			memcpy(ptr, elf_data + phdr->p_offset, filesz);
@@ -197,9 +206,9 @@ rproc_elf_load_segments(struct rproc *rproc, const struct firmware *fw)
 		/*
 		 * Zero out remaining memory for this segment.
 		 *
-		 * This isn't strictly required since dma_alloc_coherent already
-		 * did this for us. albeit harmless, we may consider removing
-		 * this.
+		 * A fresh dma_alloc_coherent allocation is already zeroed,
+		 * but a segment restored on top of a pinned carveout from a
+		 * previous run is not.
 		 */
 		if (memsz > filesz)
 			memset(ptr + filesz, 0, memsz - filesz);
@@ -33,6 +33,9 @@
 #include <asm/cacheflush.h>
 #include <linux/slab.h>
 #include <linux/cpu.h>
+#include <linux/atomic.h>
+#include <linux/kthread.h>
+#include <linux/wait.h>
 
 #include "remoteproc_internal.h"
 
@@ -47,10 +50,17 @@ struct irq_list {
 	struct list_head list;
 };
 
+/* Notifications handled per thread wakeup before yielding the cpu */
+#define ZYNQ_RPROC_BUDGET	64
+
 /* Private data */
 struct zynq_rproc_pdata {
 	struct irq_list mylist;
 	struct rproc *rproc;
+	struct task_struct *vring_task;
+	wait_queue_head_t vring_wq;
+	atomic_t msg_pending;
+	void __iomem *doorbell;
 	u32 ipino;
 	u32 vring0;
 	u32 vring1;
@@ -60,23 +70,52 @@ struct zynq_rproc_pdata {
 
 /* Store rproc for IPI handler */
 static struct platform_device *remoteprocdev;
-static struct work_struct workqueue;
 
-static void handle_event(struct work_struct *work)
+/*
+ * Vring servicing thread. All notification IPIs which arrive while a
+ * drain is in flight collapse into the pending flag, so a burst of
+ * messages costs one cache flush and one pass over the vring instead
+ * of one workqueue item each. After a full budget of drains the
+ * thread yields the cpu before carrying on.
+ */
+static int zynq_rproc_vring_thread(void *arg)
 {
-	struct zynq_rproc_pdata *local = platform_get_drvdata(remoteprocdev);
+	struct zynq_rproc_pdata *local = arg;
+	int handled;
+
+	while (!kthread_should_stop()) {
+		wait_event_interruptible(local->vring_wq,
+				atomic_read(&local->msg_pending) ||
+				kthread_should_stop());
+		if (kthread_should_stop())
+			break;
 
-	flush_cache_all();
-	outer_flush_range(local->mem_start, local->mem_end);
+		handled = 0;
+		while (atomic_xchg(&local->msg_pending, 0)) {
+			flush_cache_all();
+			outer_flush_range(local->mem_start, local->mem_end);
+
+			if (rproc_vq_interrupt(local->rproc, 0) == IRQ_NONE)
+				dev_dbg(&remoteprocdev->dev,
+					"no message found in vqid 0\n");
 
-	if (rproc_vq_interrupt(local->rproc, 0) == IRQ_NONE)
-		dev_dbg(&remoteprocdev->dev, "no message found in vqid 0\n");
+			if (++handled >= ZYNQ_RPROC_BUDGET) {
+				cond_resched();
+				handled = 0;
+			}
+		}
+	}
+
+	return 0;
 }
 
 static void ipi_kick(void)
 {
+	struct zynq_rproc_pdata *local = platform_get_drvdata(remoteprocdev);
+
 	dev_dbg(&remoteprocdev->dev, "KICK Linux because of pending message\n");
-	schedule_work(&workqueue);
+	atomic_set(&local->msg_pending, 1);
+	wake_up_interruptible(&local->vring_wq);
 }
 
 static int zynq_rproc_start(struct rproc *rproc)
@@ -87,7 +126,13 @@ static int zynq_rproc_start(struct rproc *rproc)
 	int ret;
 
 	dev_dbg(dev, "%s\n", __func__);
-	INIT_WORK(&workqueue, handle_event);
+
+	local->vring_task = kthread_run(zynq_rproc_vring_thread, local,
+					"zynq_rproc_vring");
+	if (IS_ERR(local->vring_task)) {
+		dev_err(dev, "Can't start vring thread\n");
+		return PTR_ERR(local->vring_task);
+	}
 
 	flush_cache_all();
 	outer_flush_range(local->mem_start, local->mem_end);
@@ -107,6 +152,21 @@ static void zynq_rproc_kick(struct rproc *rproc, int vqid)
 
 	dev_dbg(dev, "KICK Firmware to start send messages vqid %d\n",
 									vqid);
+	/*
+	 * Doorbell coalescing: one shared memory word per vring,
+	 * written to 1 here and cleared by the firmware before it
+	 * drains the ring. A kick which finds the word still set is
+	 * guaranteed to be picked up by the drain that clears it, so
+	 * the swirq can be skipped.
+	 */
+	if (local->doorbell) {
+		void __iomem *db = local->doorbell + (vqid ? 4 : 0);
+
+		if (__raw_readl(db))
+			return;
+		__raw_writel(1, db);
+	}
+
 	/* Send swirq to firmware */
 	if (!vqid)
 		gic_raise_softirq(cpumask_of(1), local->vring0);
@@ -117,7 +177,16 @@ static void zynq_rproc_kick(struct rproc *rproc, int vqid)
 /* power off the remote processor */
 static int zynq_rproc_stop(struct rproc *rproc)
 {
-	dev_dbg(rproc->dev.parent, "%s\n", __func__);
+	struct device *dev = rproc->dev.parent;
+	struct platform_device *pdev = to_platform_device(dev);
+	struct zynq_rproc_pdata *local = platform_get_drvdata(pdev);
+
+	dev_dbg(dev, "%s\n", __func__);
+
+	if (local->vring_task) {
+		kthread_stop(local->vring_task);
+		local->vring_task = NULL;
+	}
 
 	/* FIXME missing reset option */
 	return 0;
@@ -204,6 +273,9 @@ static int zynq_remoteproc_probe(struct platform_device *pdev)
 	local->mem_start = res->start;
 	local->mem_end = res->end;
 
+	init_waitqueue_head(&local->vring_wq);
+	atomic_set(&local->msg_pending, 0);
+
 	/* Alloc phys addr from 0 to max_addr for firmware */
 	ret = dma_declare_coherent_memory(&pdev->dev, local->mem_start,
 		local->mem_start, local->mem_end - local->mem_start + 1,
@@ -289,6 +361,20 @@ static int zynq_remoteproc_probe(struct platform_device *pdev)
 	}
 	local->vring1 = be32_to_cpup(of_prop);
 
+	/*
+	 * Optional doorbell words for kick coalescing; the offset points
+	 * into the firmware memory region at a location agreed with the
+	 * firmware. Without it every kick raises a swirq as before.
+	 */
+	of_prop = of_get_property(pdev->dev.of_node, "doorbell", NULL);
+	if (of_prop) {
+		local->doorbell = ioremap_nocache(local->mem_start +
+					be32_to_cpup(of_prop), 8);
+		if (!local->doorbell)
+			dev_warn(&pdev->dev,
+				"doorbell mapping failed, swirq per kick\n");
+	}
+
 	/* Module param firmware first */
 	if (firmware)
 		prop = firmware;
@@ -304,6 +390,14 @@ static int zynq_remoteproc_probe(struct platform_device *pdev)
 			goto rproc_fault;
 		}
 
+		/*
+		 * Keep the firmware and the loaded image resident across
+		 * stop/start cycles; fault recovery of cpu1 then skips the
+		 * firmware fetch, the carveout zeroing and the reload of
+		 * read-only sections.
+		 */
+		local->rproc->fw_pinned = true;
+
 		ret = rproc_add(local->rproc);
 		if (ret) {
 			dev_err(&pdev->dev, "rproc registration failed\n");
@@ -316,6 +410,8 @@ static int zynq_remoteproc_probe(struct platform_device *pdev)
 
 rproc_fault:
 	rproc_put(local->rproc);
+	if (local->doorbell)
+		iounmap(local->doorbell);
 ipi_fault:
 	clear_ipi_handler(local->ipino);
 
@@ -346,6 +442,9 @@ static int zynq_remoteproc_remove(struct platform_device *pdev)
 	rproc_del(local->rproc);
 	rproc_put(local->rproc);
 
+	if (local->doorbell)
+		iounmap(local->doorbell);
+
 	/* Cpu can't be power on - for example in nosmp mode */
 	ret = cpu_up(1);
 	if (ret)
@@ -30,6 +30,9 @@
 #include <linux/spinlock.h>
 #include <linux/workqueue.h>
 
+#define CREATE_TRACE_POINTS
+#include <trace/events/xilinx_qspips.h>
+
 /*
  * Name of this driver
  */
@@ -92,14 +95,32 @@
  * It is named Linear Configuration but it controls other modes when not in
  * linear mode also.
  */
+#define XQSPIPS_LCFG_LQ_MODE_MASK	0x80000000 /* LQSPI mode enable Mask */
 #define XQSPIPS_LCFG_TWO_MEM_MASK	0x40000000 /* LQSPI Two memories Mask */
 #define XQSPIPS_LCFG_SEP_BUS_MASK	0x20000000 /* LQSPI Separate bus Mask */
 #define XQSPIPS_LCFG_U_PAGE_MASK	0x10000000 /* LQSPI Upper Page Mask */
 
+#define XQSPIPS_LCFG_MODE_EN_MASK	0x02000000 /* Send mode bits Mask */
+#define XQSPIPS_LCFG_MODE_ON_MASK	0x01000000 /* Mode bits only after first */
+
+#define XQSPIPS_LCFG_MODE_BITS_SHIFT	16
 #define XQSPIPS_LCFG_DUMMY_SHIFT	8
 
+#define XQSPIPS_LCFG_MODE_BITS_CONT	0xA0	/* Continuous read mode bits */
+
 #define XQSPIPS_FAST_READ_QOUT_CODE	0x6B	/* read instruction code */
 
+/*
+ * The linear addressing adapter maps the flash at a fixed AXI address;
+ * reads through the window run at the controller's full bandwidth
+ * without any FIFO servicing by the CPU
+ */
+#define XQSPIPS_LINEAR_BASE		0xFC000000
+#define XQSPIPS_LINEAR_SIZE		0x01000000 /* 16MB per memory */
+
+/* Reads shorter than this are not worth two mode switches */
+#define XQSPIPS_LINEAR_MIN_LEN		256
+
 /*
  * The modebits configurable by the driver to make the SPI support different
  * data formats
@@ -136,8 +157,10 @@
 #define	XQSPIPS_FLASH_OPCODE_ERASE_SUS	0x75	/* Erase suspend */
 #define	XQSPIPS_FLASH_OPCODE_ERASE_RES	0x7A	/* Erase resume */
 #define	XQSPIPS_FLASH_OPCODE_RDID	0x9F	/* Read JEDEC ID */
+#define	XQSPIPS_FLASH_OPCODE_DUAL_IO_READ 0xBB	/* Dual I/O read (x2 addr) */
 #define	XQSPIPS_FLASH_OPCODE_BE		0xC7	/* Erase whole flash block */
 #define	XQSPIPS_FLASH_OPCODE_SE		0xD8	/* Sector erase (usually 64KB)*/
+#define	XQSPIPS_FLASH_OPCODE_QUAD_IO_READ 0xEB	/* Quad I/O read (x4 addr) */
 
 /*
  * Macros for the QSPI controller read/write
@@ -167,6 +190,13 @@
  * @done:		Transfer complete status
  * @is_inst:		Flag to indicate the first message in a Transfer request
  * @is_dual:		Flag to indicate whether dual flash memories are used
+ * @linear_regs:	Virtual address of the linear addressing window
+ * @linear_size:	Size of the linear addressing window
+ * @lqspi_cfg:		Linear configuration register value for I/O mode
+ * @lqspi_cfg_live:	Configuration live while in linear mode, 0 in I/O mode
+ * @cur_msg:		Message being pumped from completion context
+ * @cur_xfer:		Transfer in flight for @cur_msg
+ * @cs_change:		Chip select state carried between pumped transfers
  **/
 struct xqspips {
 	struct workqueue_struct *workqueue;
@@ -189,6 +219,13 @@ struct xqspips {
 	struct completion done;
 	bool is_inst;
 	u32 is_dual;
+	void __iomem *linear_regs;
+	u32 linear_size;
+	u32 lqspi_cfg;
+	u32 lqspi_cfg_live;
+	struct spi_message *cur_msg;
+	struct spi_transfer *cur_xfer;
+	unsigned cs_change;
 };
 
 /**
@@ -225,6 +262,8 @@ static struct xqspips_inst_format flash_inst[] = {
 	{ XQSPIPS_FLASH_OPCODE_FAST_READ, 1, XQSPIPS_TXD_00_01_OFFSET },
 	{ XQSPIPS_FLASH_OPCODE_DUAL_READ, 1, XQSPIPS_TXD_00_01_OFFSET },
 	{ XQSPIPS_FLASH_OPCODE_QUAD_READ, 1, XQSPIPS_TXD_00_01_OFFSET },
+	{ XQSPIPS_FLASH_OPCODE_DUAL_IO_READ, 1, XQSPIPS_TXD_00_01_OFFSET },
+	{ XQSPIPS_FLASH_OPCODE_QUAD_IO_READ, 1, XQSPIPS_TXD_00_01_OFFSET },
 	{ XQSPIPS_FLASH_OPCODE_BRRD, 1, XQSPIPS_TXD_00_01_OFFSET },
 	{ XQSPIPS_FLASH_OPCODE_BRWR, 2, XQSPIPS_TXD_00_10_OFFSET },
 	{ XQSPIPS_FLASH_OPCODE_EXTADRD, 1, XQSPIPS_TXD_00_01_OFFSET },
@@ -503,6 +542,8 @@ static void xqspips_fill_tx_fifo(struct xqspips *xqspi)
 	}
 }
 
+static void xqspips_pump_advance(struct xqspips *xqspi);
+
 /**
  * xqspips_irq - Interrupt service routine of the QSPI controller
  * @irq:	IRQ number
@@ -585,7 +626,10 @@ static irqreturn_t xqspips_irq(int irq, void *dev_id)
 			} else {
 				xqspips_write(xqspi->regs + XQSPIPS_IDIS_OFFSET,
 						XQSPIPS_IXR_RXNEMTY_MASK);
-				complete(&xqspi->done);
+				if (xqspi->cur_msg)
+					xqspips_pump_advance(xqspi);
+				else
+					complete(&xqspi->done);
 			}
 		}
 	}
@@ -594,17 +638,15 @@ static irqreturn_t xqspips_irq(int irq, void *dev_id)
 }
 
 /**
- * xqspips_start_transfer - Initiates the QSPI transfer
+ * xqspips_start_transfer_nowait - Initiates the QSPI transfer
  * @qspi:	Pointer to the spi_device structure
  * @transfer:	Pointer to the spi_transfer structure which provide information
  *		about next transfer parameters
  *
- * This function fills the TX FIFO, starts the QSPI transfer, and waits for the
- * transfer to be completed.
- *
- * returns:	Number of bytes transferred in the last transfer
+ * This function fills the TX FIFO and starts the QSPI transfer; completion is
+ * signalled by the interrupt handler.
  **/
-static int xqspips_start_transfer(struct spi_device *qspi,
+static void xqspips_start_transfer_nowait(struct spi_device *qspi,
 			struct spi_transfer *transfer)
 {
 	struct xqspips *xqspi = spi_master_get_devdata(qspi->master);
@@ -658,7 +700,9 @@ xfer_data:
 	     ((xqspi->bytes_to_transfer >= 4) &&
 	      (instruction != XQSPIPS_FLASH_OPCODE_FAST_READ) &&
 	      (instruction != XQSPIPS_FLASH_OPCODE_DUAL_READ) &&
-	      (instruction != XQSPIPS_FLASH_OPCODE_QUAD_READ)))
+	      (instruction != XQSPIPS_FLASH_OPCODE_QUAD_READ) &&
+	      (instruction != XQSPIPS_FLASH_OPCODE_DUAL_IO_READ) &&
+	      (instruction != XQSPIPS_FLASH_OPCODE_QUAD_IO_READ)))
 		xqspips_fill_tx_fifo(xqspi);
 
 xfer_start:
@@ -670,12 +714,352 @@ xfer_start:
 			XQSPIPS_CONFIG_OFFSET) | XQSPIPS_CONFIG_MANSRT_MASK;
 	xqspips_write(xqspi->regs + XQSPIPS_CONFIG_OFFSET, config_reg);
 	spin_unlock_irqrestore(&xqspi->config_reg_lock, flags);
+}
+
+/**
+ * xqspips_start_transfer - Initiates the QSPI transfer
+ * @qspi:	Pointer to the spi_device structure
+ * @transfer:	Pointer to the spi_transfer structure which provide information
+ *		about next transfer parameters
+ *
+ * This function starts the QSPI transfer and waits for it to be completed.
+ *
+ * returns:	Number of bytes transferred in the last transfer
+ **/
+static int xqspips_start_transfer(struct spi_device *qspi,
+			struct spi_transfer *transfer)
+{
+	struct xqspips *xqspi = spi_master_get_devdata(qspi->master);
+
+	trace_xqspips_start_transfer(transfer->len);
+
+	xqspips_start_transfer_nowait(qspi, transfer);
 
 	wait_for_completion(&xqspi->done);
 
 	return (transfer->len) - (xqspi->bytes_to_transfer);
 }
 
+/**
+ * xqspips_linear_read - Read flash data through the linear window
+ * @qspi:	Pointer to the spi_device structure
+ * @opcode:	Flash read opcode to be used by the adapter
+ * @dummy:	Number of dummy bytes after the address
+ * @addr:	Flash offset to read from
+ * @rxbuf:	Destination buffer
+ * @len:	Number of bytes to read
+ *
+ * Switches the controller into linear addressing mode and copies the
+ * data out of the memory mapped window.  The controller stays in
+ * linear mode afterwards: sequential reads then reuse the mapping and,
+ * for the I/O read variants, the flash stays in continuous read mode
+ * so the opcode phase is skipped on every burst.  The controller must
+ * be disabled while the mode is changed; the linear adapter drives the
+ * chip select by itself.
+ **/
+static void xqspips_linear_read(struct spi_device *qspi, u8 opcode, u32 dummy,
+		u32 addr, void *rxbuf, u32 len)
+{
+	struct xqspips *xqspi = spi_master_get_devdata(qspi->master);
+	u32 lqspi_cfg_reg;
+
+	lqspi_cfg_reg = XQSPIPS_LCFG_LQ_MODE_MASK |
+			(dummy << XQSPIPS_LCFG_DUMMY_SHIFT) | opcode;
+
+	if (opcode == XQSPIPS_FLASH_OPCODE_DUAL_IO_READ ||
+	    opcode == XQSPIPS_FLASH_OPCODE_QUAD_IO_READ)
+		/*
+		 * The x2/x4 address variants carry mode bits after the
+		 * address; 0xAx asks the flash to stay in continuous
+		 * read, letting the adapter drop the opcode from all
+		 * subsequent accesses.
+		 */
+		lqspi_cfg_reg |= XQSPIPS_LCFG_MODE_EN_MASK |
+				XQSPIPS_LCFG_MODE_ON_MASK |
+				(XQSPIPS_LCFG_MODE_BITS_CONT <<
+					XQSPIPS_LCFG_MODE_BITS_SHIFT);
+
+	if (xqspi->is_dual == 1)
+		lqspi_cfg_reg |= XQSPIPS_LCFG_TWO_MEM_MASK |
+				XQSPIPS_LCFG_SEP_BUS_MASK;
+#ifdef CONFIG_SPI_XILINX_PS_QSPI_DUAL_STACKED
+	lqspi_cfg_reg |= XQSPIPS_LCFG_TWO_MEM_MASK;
+	if (qspi->master->flags & SPI_MASTER_U_PAGE)
+		lqspi_cfg_reg |= XQSPIPS_LCFG_U_PAGE_MASK;
+#endif
+
+	if (xqspi->lqspi_cfg_live != lqspi_cfg_reg) {
+		xqspips_write(xqspi->regs + XQSPIPS_ENABLE_OFFSET,
+				~XQSPIPS_ENABLE_ENABLE_MASK);
+		xqspips_write(xqspi->regs + XQSPIPS_LINEAR_CFG_OFFSET,
+				lqspi_cfg_reg);
+		xqspips_write(xqspi->regs + XQSPIPS_ENABLE_OFFSET,
+				XQSPIPS_ENABLE_ENABLE_MASK);
+		xqspi->lqspi_cfg_live = lqspi_cfg_reg;
+	}
+
+	memcpy_fromio(rxbuf, xqspi->linear_regs + addr, len);
+}
+
+/**
+ * xqspips_leave_linear - Restore I/O mode before a FIFO based transfer
+ * @xqspi:	Pointer to the xqspips structure
+ *
+ * Leaving the window mapped between sequential reads is what keeps the
+ * flash in continuous read mode, so the switch back to I/O mode is
+ * deferred until a transfer actually needs the FIFOs.
+ **/
+static void xqspips_leave_linear(struct xqspips *xqspi)
+{
+	if (!xqspi->lqspi_cfg_live)
+		return;
+
+	xqspips_write(xqspi->regs + XQSPIPS_ENABLE_OFFSET,
+			~XQSPIPS_ENABLE_ENABLE_MASK);
+	xqspips_write(xqspi->regs + XQSPIPS_LINEAR_CFG_OFFSET,
+			xqspi->lqspi_cfg);
+	xqspips_write(xqspi->regs + XQSPIPS_ENABLE_OFFSET,
+			XQSPIPS_ENABLE_ENABLE_MASK);
+	xqspi->lqspi_cfg_live = 0;
+}
+
+/**
+ * xqspips_try_linear_read - Service a flash read message via linear mode
+ * @qspi:	Pointer to the spi_device structure
+ * @msg:	Pointer to the spi_message structure
+ *
+ * Recognizes the message shape the MTD layer uses for flash reads: one
+ * transmit-only transfer carrying a 3-byte addressed read instruction
+ * followed by one receive-only data transfer.  Large reads within the
+ * linear window are serviced by xqspips_linear_read(); everything else
+ * falls back to the FIFO based transfer path.
+ *
+ * returns:	true if the message was completed here, false otherwise
+ **/
+static bool xqspips_try_linear_read(struct spi_device *qspi,
+		struct spi_message *msg)
+{
+	struct xqspips *xqspi = spi_master_get_devdata(qspi->master);
+	struct spi_transfer *cmd;
+	struct spi_transfer *data;
+	const u8 *txbuf;
+	u32 addr;
+	u32 dummy;
+
+	if (!xqspi->linear_regs)
+		return false;
+
+	/* Exactly an instruction transfer and a data transfer */
+	cmd = list_first_entry(&msg->transfers, struct spi_transfer,
+				transfer_list);
+	if (list_is_last(&cmd->transfer_list, &msg->transfers))
+		return false;
+
+	data = list_entry(cmd->transfer_list.next, struct spi_transfer,
+				transfer_list);
+	if (!list_is_last(&data->transfer_list, &msg->transfers))
+		return false;
+
+	if (!cmd->tx_buf || cmd->rx_buf || !data->rx_buf || data->tx_buf)
+		return false;
+
+	if (data->len < XQSPIPS_LINEAR_MIN_LEN)
+		return false;
+
+	txbuf = cmd->tx_buf;
+	switch (txbuf[0]) {
+	case XQSPIPS_FLASH_OPCODE_NORM_READ:
+		if (cmd->len != 4)
+			return false;
+		dummy = 0;
+		break;
+	case XQSPIPS_FLASH_OPCODE_FAST_READ:
+	case XQSPIPS_FLASH_OPCODE_DUAL_READ:
+	case XQSPIPS_FLASH_OPCODE_QUAD_READ:
+		/* Opcode, 3 address bytes and a dummy byte */
+		if (cmd->len != 5)
+			return false;
+		dummy = 1;
+		break;
+	case XQSPIPS_FLASH_OPCODE_DUAL_IO_READ:
+	case XQSPIPS_FLASH_OPCODE_QUAD_IO_READ:
+		/*
+		 * Opcode, 3 address bytes, then mode and dummy bytes;
+		 * the adapter regenerates the mode byte itself, the
+		 * rest count as dummies.
+		 */
+		if (cmd->len < 4)
+			return false;
+		dummy = cmd->len - 4;
+		break;
+	default:
+		return false;
+	}
+
+	addr = (txbuf[1] << 16) | (txbuf[2] << 8) | txbuf[3];
+	if (addr + data->len > xqspi->linear_size)
+		return false;
+
+	xqspips_linear_read(qspi, txbuf[0], dummy, addr, data->rx_buf,
+				data->len);
+
+	msg->actual_length = cmd->len + data->len;
+	return true;
+}
+
+/**
+ * xqspips_msg_is_fast - Check whether a message can be pumped from IRQs
+ * @xqspi:	Pointer to the xqspips structure
+ * @msg:	Pointer to the spi_message structure
+ *
+ * A message qualifies for the interrupt driven pump when no transfer
+ * changes the clock setup (reprogramming the baud rate may sleep in the
+ * clock framework) and it is not a linear window read candidate, whose
+ * long memcpy_fromio must not run in completion context.
+ *
+ * returns:	true if the message can be pumped from completion context
+ **/
+static bool xqspips_msg_is_fast(struct xqspips *xqspi, struct spi_message *msg)
+{
+	struct spi_transfer *transfer;
+
+	list_for_each_entry(transfer, &msg->transfers, transfer_list) {
+		if (transfer->bits_per_word || transfer->speed_hz)
+			return false;
+
+		if (!transfer->len ||
+				(!transfer->tx_buf && !transfer->rx_buf))
+			return false;
+
+		/* Possible linear read, keep it on the slow path */
+		if (xqspi->linear_regs && transfer->rx_buf &&
+				!transfer->tx_buf &&
+				transfer->len >= XQSPIPS_LINEAR_MIN_LEN)
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * xqspips_pump_transfer - Start the current transfer of the pumped message
+ * @xqspi:	Pointer to the xqspips structure
+ **/
+static void xqspips_pump_transfer(struct xqspips *xqspi)
+{
+	struct spi_message *msg = xqspi->cur_msg;
+	struct spi_transfer *transfer = xqspi->cur_xfer;
+
+	if (xqspi->cs_change) {
+		xqspips_chipselect(msg->spi, 1);
+		xqspi->is_inst = 1;
+	}
+	xqspi->cs_change = transfer->cs_change;
+
+	xqspips_start_transfer_nowait(msg->spi, transfer);
+	xqspi->is_inst = 0;
+}
+
+/**
+ * xqspips_pump_kick - Start pumping the next queued message
+ * @xqspi:	Pointer to the xqspips structure
+ *
+ * Takes the next message off the queue and starts its first transfer,
+ * all without sleeping.  Messages that cannot be pumped from completion
+ * context are handed to the work queue instead, which then drains the
+ * whole queue.  Must be called with the transfer queue lock held and
+ * the device marked busy; the busy flag is cleared when the queue is
+ * empty or stopped.
+ **/
+static void xqspips_pump_kick(struct xqspips *xqspi)
+{
+	struct spi_message *msg;
+#ifdef CONFIG_SPI_XILINX_PS_QSPI_DUAL_STACKED
+	u32 lqspi_cfg_reg;
+#endif
+
+	if (list_empty(&xqspi->queue) ||
+		xqspi->queue_state == XQSPIPS_QUEUE_STOPPED) {
+		xqspi->dev_busy = 0;
+		return;
+	}
+
+	msg = container_of(xqspi->queue.next, struct spi_message, queue);
+
+	if (!xqspips_msg_is_fast(xqspi, msg)) {
+		queue_work(xqspi->workqueue, &xqspi->work);
+		return;
+	}
+
+	list_del_init(&msg->queue);
+
+	xqspips_leave_linear(xqspi);
+
+#ifdef CONFIG_SPI_XILINX_PS_QSPI_DUAL_STACKED
+	lqspi_cfg_reg = xqspips_read(xqspi->regs +
+				XQSPIPS_LINEAR_CFG_OFFSET);
+	if (msg->spi->master->flags & SPI_MASTER_U_PAGE)
+		lqspi_cfg_reg |= XQSPIPS_LCFG_U_PAGE_MASK;
+	else {
+		lqspi_cfg_reg &= ~XQSPIPS_LCFG_U_PAGE_MASK;
+		xqspips_write(xqspi->regs + XQSPIPS_LINEAR_CFG_OFFSET,
+				lqspi_cfg_reg);
+	}
+#endif
+
+	xqspi->cur_msg = msg;
+	xqspi->cur_xfer = list_first_entry(&msg->transfers,
+				struct spi_transfer, transfer_list);
+	xqspi->cs_change = 1;
+
+	xqspips_pump_transfer(xqspi);
+}
+
+/**
+ * xqspips_pump_advance - Move the pumped message past a finished transfer
+ * @xqspi:	Pointer to the xqspips structure
+ *
+ * Called from the interrupt handler when the transfer in flight has
+ * completed.  Starts the next transfer of the current message, or
+ * completes the message and kicks the next one off the queue.
+ **/
+static void xqspips_pump_advance(struct xqspips *xqspi)
+{
+	struct spi_message *msg = xqspi->cur_msg;
+	struct spi_transfer *transfer = xqspi->cur_xfer;
+	struct spi_device *qspi = msg->spi;
+	unsigned long flags;
+
+	msg->actual_length += transfer->len;
+
+	if (transfer->delay_usecs)
+		udelay(transfer->delay_usecs);
+
+	if (!list_is_last(&transfer->transfer_list, &msg->transfers)) {
+		if (xqspi->cs_change)
+			xqspips_chipselect(qspi, 0);
+
+		xqspi->cur_xfer = list_entry(transfer->transfer_list.next,
+					struct spi_transfer, transfer_list);
+		xqspips_pump_transfer(xqspi);
+		return;
+	}
+
+	/* Message completed */
+	xqspi->cur_msg = NULL;
+	xqspi->cur_xfer = NULL;
+
+	if (!xqspi->cs_change)
+		xqspips_chipselect(qspi, 0);
+
+	msg->status = 0;
+	msg->complete(msg->context);
+
+	spin_lock_irqsave(&xqspi->trans_queue_lock, flags);
+	xqspips_pump_kick(xqspi);
+	spin_unlock_irqrestore(&xqspi->trans_queue_lock, flags);
+}
+
 /**
  * xqspips_work_queue - Get the request from queue to perform transfers
  * @work:	Pointer to the work_struct structure
@@ -725,6 +1109,16 @@ static void xqspips_work_queue(struct work_struct *work)
 		}
 #endif
 
+		/* Large flash reads bypass the FIFOs via the linear window */
+		if (xqspips_try_linear_read(qspi, msg)) {
+			msg->status = 0;
+			msg->complete(msg->context);
+			spin_lock_irqsave(&xqspi->trans_queue_lock, flags);
+			continue;
+		}
+
+		xqspips_leave_linear(xqspi);
+
 		list_for_each_entry(transfer, &msg->transfers, transfer_list) {
 			if (transfer->bits_per_word || transfer->speed_hz) {
 				status = xqspips_setup_transfer(qspi, transfer);
@@ -820,8 +1214,10 @@ xqspips_transfer(struct spi_device *qspi, struct spi_message *message)
 
 	spin_lock_irqsave(&xqspi->trans_queue_lock, flags);
 	list_add_tail(&message->queue, &xqspi->queue);
-	if (!xqspi->dev_busy)
-		queue_work(xqspi->workqueue, &xqspi->work);
+	if (!xqspi->dev_busy) {
+		xqspi->dev_busy = 1;
+		xqspips_pump_kick(xqspi);
+	}
 	spin_unlock_irqrestore(&xqspi->trans_queue_lock, flags);
 
 	return 0;
@@ -987,6 +1383,7 @@ static int xqspips_resume(struct device *_dev)
 	}
 
 	xqspips_init_hw(xqspi->regs, xqspi->is_dual);
+	xqspi->lqspi_cfg_live = 0;
 
 	ret = xqspips_start_queue(xqspi);
 	if (ret != 0) {
@@ -1103,6 +1500,27 @@ static int xqspips_probe(struct platform_device *dev)
 	/* QSPI controller initializations */
 	xqspips_init_hw(xqspi->regs, xqspi->is_dual);
 
+	/* Remember the I/O mode linear configuration set up above */
+	xqspi->lqspi_cfg = xqspips_read(xqspi->regs + XQSPIPS_LINEAR_CFG_OFFSET);
+
+	/*
+	 * Map the linear addressing window; reads fall back to the FIFO
+	 * path if this fails
+	 */
+	xqspi->linear_size = (xqspi->is_dual == 1) ?
+				XQSPIPS_LINEAR_SIZE * 2 : XQSPIPS_LINEAR_SIZE;
+	if (request_mem_region(XQSPIPS_LINEAR_BASE, xqspi->linear_size,
+				DRIVER_NAME "-linear")) {
+		xqspi->linear_regs = ioremap(XQSPIPS_LINEAR_BASE,
+						xqspi->linear_size);
+		if (!xqspi->linear_regs)
+			release_mem_region(XQSPIPS_LINEAR_BASE,
+						xqspi->linear_size);
+	}
+	if (!xqspi->linear_regs)
+		dev_warn(&dev->dev,
+			"linear window not available, using PIO reads\n");
+
 	init_completion(&xqspi->done);
 
 	prop = of_get_property(dev->dev.of_node, "bus-num", NULL);
@@ -1166,6 +1584,10 @@ static int xqspips_probe(struct platform_device *dev)
 remove_queue:
 	(void)xqspips_destroy_queue(xqspi);
 clk_unreg_notif:
+	if (xqspi->linear_regs) {
+		iounmap(xqspi->linear_regs);
+		release_mem_region(XQSPIPS_LINEAR_BASE, xqspi->linear_size);
+	}
 	clk_notifier_unregister(xqspi->devclk, &xqspi->clk_rate_change_nb);
 	clk_disable_unprepare(xqspi->devclk);
 clk_dis_aper:
@@ -1221,6 +1643,11 @@ static int xqspips_remove(struct platform_device *dev)
 	iounmap(xqspi->regs);
 	release_mem_region(r->start, r->end - r->start + 1);
 
+	if (xqspi->linear_regs) {
+		iounmap(xqspi->linear_regs);
+		release_mem_region(XQSPIPS_LINEAR_BASE, xqspi->linear_size);
+	}
+
 	spi_unregister_master(master);
 	spi_master_put(master);
 
@@ -75,6 +75,12 @@
 #define XIPIF_V123B_RESETR_OFFSET	0x40	/* IPIF reset register */
 #define XIPIF_V123B_RESET_MASK		0x0a	/* the value to write */
 
+/* Transfers of at most this many words are completed by polling the
+ * status register; for them the wire time is comparable to the cost of
+ * a single interrupt round trip, so sleeping is a net loss.
+ */
+#define XSPI_POLLED_WORDS	8
+
 struct xilinx_spi {
 	/* bitbang has to be first */
 	struct spi_bitbang bitbang;
@@ -87,6 +93,7 @@ struct xilinx_spi {
 	u8 *rx_ptr;		/* pointer in the Tx buffer */
 	const u8 *tx_ptr;	/* pointer in the Rx buffer */
 	int remaining_bytes;	/* the number of bytes left to transfer */
+	int buffer_size;	/* Tx FIFO depth in words (1 without FIFOs) */
 	u8 bits_per_word;
 	unsigned int (*read_fn) (void __iomem *);
 	void (*write_fn) (u32, void __iomem *);
@@ -159,6 +166,30 @@ static void xspi_rx32(struct xilinx_spi *xspi)
 	}
 }
 
+/* The depth of the transmit FIFO is an IP block design parameter which is
+ * not readable from any register, so measure it: after a core reset the
+ * transmitter is inhibited and words written to the transmit register pile
+ * up (in the FIFO, or in the single transmit register when the core was
+ * built without FIFOs) until the full flag rises.
+ */
+static int xilinx_spi_find_buffer_size(struct xilinx_spi *xspi)
+{
+	int n_words = 0;
+	u8 sr;
+
+	/* Reset the core so nothing goes out on the wire */
+	xspi->write_fn(XIPIF_V123B_RESET_MASK,
+		xspi->regs + XIPIF_V123B_RESETR_OFFSET);
+
+	do {
+		xspi->write_fn(0, xspi->regs + XSPI_TXD_OFFSET);
+		sr = xspi->read_fn(xspi->regs + XSPI_SR_OFFSET);
+		n_words++;
+	} while (!(sr & XSPI_SR_TX_FULL_MASK));
+
+	return n_words;
+}
+
 static void xspi_init_hw(struct xilinx_spi *xspi)
 {
 	void __iomem *regs_base = xspi->regs;
@@ -263,71 +294,131 @@ static void xilinx_spi_fill_tx_fifo(struct xilinx_spi *xspi)
 	}
 }
 
+/* Read out all the data currently held in the Rx FIFO */
+static void xilinx_spi_drain_rx_fifo(struct xilinx_spi *xspi)
+{
+	u8 sr;
+
+	sr = xspi->read_fn(xspi->regs + XSPI_SR_OFFSET);
+	while ((sr & XSPI_SR_RX_EMPTY_MASK) == 0) {
+		xspi->rx_fn(xspi);
+		sr = xspi->read_fn(xspi->regs + XSPI_SR_OFFSET);
+	}
+}
+
+/* Run a transfer that fits into the Tx FIFO in one go by polling the
+ * status register, without touching the interrupt machinery at all.
+ */
+static int xilinx_spi_txrx_polled(struct xilinx_spi *xspi,
+				  struct spi_transfer *t)
+{
+	u16 cr;
+	u8 sr;
+
+	xilinx_spi_fill_tx_fifo(xspi);
+
+	/* Start the transfer by not inhibiting the transmitter any longer */
+	cr = xspi->read_fn(xspi->regs + XSPI_CR_OFFSET) &
+		~XSPI_CR_TRANS_INHIBIT;
+	xspi->write_fn(cr, xspi->regs + XSPI_CR_OFFSET);
+
+	do {
+		sr = xspi->read_fn(xspi->regs + XSPI_SR_OFFSET);
+	} while (!(sr & XSPI_SR_TX_EMPTY_MASK));
+
+	xspi->write_fn(cr | XSPI_CR_TRANS_INHIBIT,
+		xspi->regs + XSPI_CR_OFFSET);
+
+	xilinx_spi_drain_rx_fifo(xspi);
+
+	return t->len;
+}
+
 static int xilinx_spi_txrx_bufs(struct spi_device *spi, struct spi_transfer *t)
 {
 	struct xilinx_spi *xspi = spi_master_get_devdata(spi->master);
+	int n_words = t->len / (xspi->bits_per_word / 8);
 	u32 ipif_ier;
+	u32 intr;
+	u16 cr;
+	u8 sr;
 
 	/* We get here with transmitter inhibited */
 
 	xspi->tx_ptr = t->tx_buf;
 	xspi->rx_ptr = t->rx_buf;
 	xspi->remaining_bytes = t->len;
+
+	if (n_words <= xspi->buffer_size && n_words <= XSPI_POLLED_WORDS)
+		return xilinx_spi_txrx_polled(xspi, t);
+
 	INIT_COMPLETION(xspi->done);
 
+	/* Ack a transmit empty event latched while interrupts were off
+	 * (e.g. by a preceding polled transfer).
+	 */
+	xspi->write_fn(XSPI_INTR_TX_EMPTY,
+		xspi->regs + XIPIF_V123B_IISR_OFFSET);
 
 	/* Enable the transmit empty interrupt, which we use to determine
-	 * progress on the transmission.
+	 * progress on the transmission. For transfers larger than the FIFO
+	 * also take the half empty interrupt, so the FIFO is topped up
+	 * while its lower half is still draining instead of running dry
+	 * between refills.
 	 */
+	intr = XSPI_INTR_TX_EMPTY;
+	if (xspi->buffer_size > 1 && n_words > xspi->buffer_size)
+		intr |= XSPI_INTR_TX_HALF_EMPTY;
 	ipif_ier = xspi->read_fn(xspi->regs + XIPIF_V123B_IIER_OFFSET);
-	xspi->write_fn(ipif_ier | XSPI_INTR_TX_EMPTY,
+	xspi->write_fn(ipif_ier | intr,
 		xspi->regs + XIPIF_V123B_IIER_OFFSET);
 
-	for (;;) {
-		u16 cr;
-		u8 sr;
-
-		xilinx_spi_fill_tx_fifo(xspi);
+	xilinx_spi_fill_tx_fifo(xspi);
 
-		/* Start the transfer by not inhibiting the transmitter any
-		 *longer
-		 */
-		cr = xspi->read_fn(xspi->regs + XSPI_CR_OFFSET) &
-			~XSPI_CR_TRANS_INHIBIT;
-		xspi->write_fn(cr, xspi->regs + XSPI_CR_OFFSET);
+	/* Start the transfer by not inhibiting the transmitter any longer.
+	 * It keeps running across refills; a refill only needs the Rx FIFO
+	 * drained first so the words still in flight have somewhere to go.
+	 */
+	cr = xspi->read_fn(xspi->regs + XSPI_CR_OFFSET) &
+		~XSPI_CR_TRANS_INHIBIT;
+	xspi->write_fn(cr, xspi->regs + XSPI_CR_OFFSET);
 
+	for (;;) {
 		wait_for_completion(&xspi->done);
+		INIT_COMPLETION(xspi->done);
 
-		/* A transmit has just completed. Process received data and
-		 * check for more data to transmit. Always inhibit the
-		 * transmitter while the Isr refills the transmit register/FIFO,
-		 * or make sure it is stopped if we're done.
-		 */
-		cr = xspi->read_fn(xspi->regs + XSPI_CR_OFFSET);
-		xspi->write_fn(cr | XSPI_CR_TRANS_INHIBIT,
-			xspi->regs + XSPI_CR_OFFSET);
+		xilinx_spi_drain_rx_fifo(xspi);
 
-		/* Read out all the data from the Rx FIFO */
-		sr = xspi->read_fn(xspi->regs + XSPI_SR_OFFSET);
-		while ((sr & XSPI_SR_RX_EMPTY_MASK) == 0) {
-			xspi->rx_fn(xspi);
-			sr = xspi->read_fn(xspi->regs + XSPI_SR_OFFSET);
+		if (xspi->remaining_bytes > 0) {
+			xilinx_spi_fill_tx_fifo(xspi);
+			continue;
 		}
 
-		/* See if there is more data to send */
-		if (!xspi->remaining_bytes > 0)
+		/* Everything is queued; stop once the core has drained the
+		 * Tx FIFO. A missed wakeup cannot stall us here: if the
+		 * empty event fired before the completion was reinitialized
+		 * the status register already reads empty.
+		 */
+		sr = xspi->read_fn(xspi->regs + XSPI_SR_OFFSET);
+		if (sr & XSPI_SR_TX_EMPTY_MASK)
 			break;
 	}
 
-	/* Disable the transmit empty interrupt */
+	xspi->write_fn(cr | XSPI_CR_TRANS_INHIBIT,
+		xspi->regs + XSPI_CR_OFFSET);
+
+	/* Pick up the tail of the receive data */
+	xilinx_spi_drain_rx_fifo(xspi);
+
+	/* Restore the interrupt enable register */
 	xspi->write_fn(ipif_ier, xspi->regs + XIPIF_V123B_IIER_OFFSET);
 
 	return t->len - xspi->remaining_bytes;
 }
 
 
-/* This driver supports single master mode only. Hence Tx FIFO Empty
- * is the only interrupt we care about.
+/* This driver supports single master mode only. Hence Tx FIFO Empty and
+ * Tx FIFO Half Empty are the only interrupts we care about.
  * Receive FIFO Overrun, Transmit FIFO Underrun, Mode Fault, and Slave Mode
  * Fault are not to happen.
  */
@@ -340,7 +431,8 @@ static irqreturn_t xilinx_spi_irq(int irq, void *dev_id)
 	ipif_isr = xspi->read_fn(xspi->regs + XIPIF_V123B_IISR_OFFSET);
 	xspi->write_fn(ipif_isr, xspi->regs + XIPIF_V123B_IISR_OFFSET);
 
-	if (ipif_isr & XSPI_INTR_TX_EMPTY) {	/* Transmission completed */
+	if (ipif_isr & (XSPI_INTR_TX_EMPTY | XSPI_INTR_TX_HALF_EMPTY)) {
+		/* Room in the Tx FIFO, or transmission completed */
 		complete(&xspi->done);
 	}
 
@@ -420,6 +512,8 @@ struct spi_master *xilinx_spi_init(struct device *dev, struct resource *mem,
 		goto unmap_io;
 
 
+	xspi->buffer_size = xilinx_spi_find_buffer_size(xspi);
+
 	/* SPI controller initializations */
 	xspi_init_hw(xspi);
 
@@ -434,8 +528,9 @@ struct spi_master *xilinx_spi_init(struct device *dev, struct resource *mem,
 		goto free_irq;
 	}
 
-	dev_info(dev, "at 0x%08llX mapped to 0x%p, irq=%d\n",
-		(unsigned long long)mem->start, xspi->regs, xspi->irq);
+	dev_info(dev, "at 0x%08llX mapped to 0x%p, irq=%d, fifo depth=%d\n",
+		(unsigned long long)mem->start, xspi->regs, xspi->irq,
+		xspi->buffer_size);
 	return master;
 
 free_irq:
@@ -1413,6 +1413,43 @@ static void n_tty_write_wakeup(struct tty_struct *tty)
  *	calls one at a time and in order (or using flush_to_ldisc)
  */
 
+/**
+ *	n_tty_receive_raw_copy	-	bulk insert of raw data
+ *	@ldata: line discipline data
+ *	@cp: buffer
+ *	@count: characters
+ *
+ *	Copy a block of characters straight into the read buffer, taking
+ *	the read lock once for the whole block rather than once per
+ *	character. As with raw per-character insertion, anything that
+ *	does not fit is silently dropped.
+ */
+
+static void n_tty_receive_raw_copy(struct n_tty_data *ldata,
+				   const unsigned char *cp, int count)
+{
+	unsigned long cpuflags;
+	int	i;
+
+	raw_spin_lock_irqsave(&ldata->read_lock, cpuflags);
+	i = min(N_TTY_BUF_SIZE - ldata->read_cnt,
+		N_TTY_BUF_SIZE - ldata->read_head);
+	i = min(count, i);
+	memcpy(ldata->read_buf + ldata->read_head, cp, i);
+	ldata->read_head = (ldata->read_head + i) & (N_TTY_BUF_SIZE-1);
+	ldata->read_cnt += i;
+	cp += i;
+	count -= i;
+
+	i = min(N_TTY_BUF_SIZE - ldata->read_cnt,
+		N_TTY_BUF_SIZE - ldata->read_head);
+	i = min(count, i);
+	memcpy(ldata->read_buf + ldata->read_head, cp, i);
+	ldata->read_head = (ldata->read_head + i) & (N_TTY_BUF_SIZE-1);
+	ldata->read_cnt += i;
+	raw_spin_unlock_irqrestore(&ldata->read_lock, cpuflags);
+}
+
 static void n_tty_receive_buf(struct tty_struct *tty, const unsigned char *cp,
 			      char *fp, int count)
 {
@@ -1421,26 +1458,54 @@ static void n_tty_receive_buf(struct tty_struct *tty, const unsigned char *cp,
 	char *f, flags = TTY_NORMAL;
 	int	i;
 	char	buf[64];
-	unsigned long cpuflags;
 
 	if (ldata->real_raw) {
-		raw_spin_lock_irqsave(&ldata->read_lock, cpuflags);
-		i = min(N_TTY_BUF_SIZE - ldata->read_cnt,
-			N_TTY_BUF_SIZE - ldata->read_head);
-		i = min(count, i);
-		memcpy(ldata->read_buf + ldata->read_head, cp, i);
-		ldata->read_head = (ldata->read_head + i) & (N_TTY_BUF_SIZE-1);
-		ldata->read_cnt += i;
-		cp += i;
-		count -= i;
-
-		i = min(N_TTY_BUF_SIZE - ldata->read_cnt,
-			N_TTY_BUF_SIZE - ldata->read_head);
-		i = min(count, i);
-		memcpy(ldata->read_buf + ldata->read_head, cp, i);
-		ldata->read_head = (ldata->read_head + i) & (N_TTY_BUF_SIZE-1);
-		ldata->read_cnt += i;
-		raw_spin_unlock_irqrestore(&ldata->read_lock, cpuflags);
+		n_tty_receive_raw_copy(ldata, cp, count);
+	} else if (ldata->raw) {
+		/* Raw mode, but the driver may flag receive errors: copy
+		 * runs of clean characters wholesale and only take the
+		 * per-character path for flagged ones. This matches what
+		 * n_tty_receive_char() does in raw mode without paying
+		 * the state machine and read lock per character.
+		 */
+		for (i = count, p = cp, f = fp; i;) {
+			int run = i;
+
+			if (f) {
+				run = 0;
+				while (run < i && f[run] == TTY_NORMAL)
+					run++;
+			}
+			if (run) {
+				n_tty_receive_raw_copy(ldata, p, run);
+				p += run;
+				if (f)
+					f += run;
+				i -= run;
+				continue;
+			}
+			flags = *f++;
+			switch (flags) {
+			case TTY_BREAK:
+				n_tty_receive_break(tty);
+				break;
+			case TTY_PARITY:
+			case TTY_FRAME:
+				n_tty_receive_parity_error(tty, *p);
+				break;
+			case TTY_OVERRUN:
+				n_tty_receive_overrun(tty);
+				break;
+			default:
+				printk(KERN_ERR "%s: unknown flag %d\n",
+				       tty_name(tty, buf), flags);
+				break;
+			}
+			p++;
+			i--;
+		}
+		if (tty->ops->flush_chars)
+			tty->ops->flush_chars(tty);
 	} else {
 		for (i = count, p = cp, f = fp; i; i--, p++) {
 			if (f)
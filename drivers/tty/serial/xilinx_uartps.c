@@ -25,6 +25,7 @@
 #include <linux/tty_flip.h>
 #include <linux/irq.h>
 #include <linux/io.h>
+#include <linux/kfifo.h>
 #include <linux/of.h>
 #include <linux/moduleparam.h>
 #include <linux/module.h>
@@ -163,6 +164,9 @@ MODULE_PARM_DESC (rx_timeout, "Rx timeout, 1-255");
 #define XUARTPS_SR_TXFULL	0x00000010 /* TX FIFO full */
 #define XUARTPS_SR_RXTRIG	0x00000001 /* Rx Trigger */
 
+/* Bytes of console output held back for the TX interrupt to emit */
+#define XUARTPS_CON_FIFO_SIZE	4096
+
 struct xuartps {
 	int			uartnum;
 	struct uart_port	*port;
@@ -170,9 +174,119 @@ struct xuartps {
 	struct clk		*devclk;
 	struct clk		*aperclk;
 	struct notifier_block	clk_rate_change_nb;
+#ifdef CONFIG_SERIAL_XILINX_PS_UART_CONSOLE
+	DECLARE_KFIFO(con_fifo, unsigned char, XUARTPS_CON_FIFO_SIZE);
+	spinlock_t		con_lock;
+	int			con_ready;
+#endif
 };
 #define to_xuartps(_nb) container_of(_nb, struct xuartps, clk_rate_change_nb);
 
+#ifdef CONFIG_SERIAL_XILINX_PS_UART_CONSOLE
+/*
+ * Deferred console path. Synchronous console output spins with
+ * interrupts off until the whole message has left the wire, which at
+ * high baud rates turns verbose logging into milliseconds of blocked
+ * interrupts per message. While the port is up, console_write instead
+ * drops the message into a kfifo and lets the TX empty interrupt
+ * stream it out at line rate, interleaved with tty data. The
+ * synchronous path remains for early boot, oops handling and kfifo
+ * overflow, and drains the kfifo first so output never reorders.
+ */
+
+static void xuartps_console_buf_init(struct xuartps *xuartps)
+{
+	INIT_KFIFO(xuartps->con_fifo);
+	spin_lock_init(&xuartps->con_lock);
+	xuartps->con_ready = 0;
+}
+
+/**
+ * xuartps_console_set_ready - Enable or disable console TX deferral
+ * @port: Handle to the uart port structure
+ * @ready: Non-zero once the interrupt handler can emit deferred bytes
+ *
+ * Deferred bytes are only ever emitted by the TX empty interrupt, so
+ * deferral must be switched off whenever the port interrupt is not
+ * live (before startup and after shutdown).
+ */
+static void xuartps_console_set_ready(struct uart_port *port, int ready)
+{
+	struct xuartps *xuartps = port->private_data;
+	unsigned long flags;
+
+	if (!xuartps)
+		return;
+
+	spin_lock_irqsave(&xuartps->con_lock, flags);
+	xuartps->con_ready = ready;
+	spin_unlock_irqrestore(&xuartps->con_lock, flags);
+}
+
+/**
+ * xuartps_console_emit - Move deferred console bytes into the TX FIFO
+ * @port: Handle to the uart port structure
+ * @budget: Maximum number of bytes to emit
+ *
+ * Called with the port lock held and interrupts disabled. Returns the
+ * number of bytes written to the TX FIFO.
+ */
+static unsigned int xuartps_console_emit(struct uart_port *port,
+					 unsigned int budget)
+{
+	struct xuartps *xuartps = port->private_data;
+	unsigned int numbytes = 0;
+	unsigned char c;
+
+	if (!xuartps)
+		return 0;
+
+	spin_lock(&xuartps->con_lock);
+	while (numbytes < budget &&
+	       !(xuartps_readl(XUARTPS_SR_OFFSET) & XUARTPS_SR_TXFULL) &&
+	       kfifo_get(&xuartps->con_fifo, &c)) {
+		xuartps_writel(c, XUARTPS_FIFO_OFFSET);
+		numbytes++;
+	}
+	spin_unlock(&xuartps->con_lock);
+
+	return numbytes;
+}
+
+/**
+ * xuartps_console_pending - Check for deferred console bytes
+ * @port: Handle to the uart port structure
+ *
+ * Returns non-zero while deferred bytes are waiting for the TX empty
+ * interrupt, so the interrupt must stay enabled.
+ */
+static int xuartps_console_pending(struct uart_port *port)
+{
+	struct xuartps *xuartps = port->private_data;
+
+	return xuartps && !kfifo_is_empty(&xuartps->con_fifo);
+}
+#else
+static inline void xuartps_console_buf_init(struct xuartps *xuartps)
+{
+}
+
+static inline void xuartps_console_set_ready(struct uart_port *port, int ready)
+{
+}
+
+static inline unsigned int xuartps_console_emit(struct uart_port *port,
+						unsigned int budget)
+{
+	return 0;
+}
+
+static inline int xuartps_console_pending(struct uart_port *port)
+{
+	return 0;
+}
+#endif /* CONFIG_SERIAL_XILINX_PS_UART_CONSOLE */
+
 
 /**
  * xuartps_isr - Interrupt handler
@@ -223,6 +337,36 @@ static irqreturn_t xuartps_isr(int irq, void *dev_id)
 
 	if ((isrstatus & XUARTPS_IXR_TOUT) ||
 		(isrstatus & XUARTPS_IXR_RXTRIG)) {
+		/* Fast path: without errors, break handling or sysrq
+		 * processing pending, the FIFO can be drained into the
+		 * tty flip buffer in whole chunks instead of a
+		 * uart_insert_char() call per byte. At high baud rates
+		 * this is what keeps the per-interrupt cost bounded.
+		 */
+		if (!(isrstatus & (XUARTPS_IXR_PARITY | XUARTPS_IXR_FRAMING |
+				XUARTPS_IXR_OVERRUN)) &&
+			!(port->read_status_mask & XUARTPS_IXR_BRK) &&
+			!port->sysrq) {
+			unsigned char chunk[XUARTPS_FIFO_SIZE];
+
+			while ((xuartps_readl(XUARTPS_SR_OFFSET) &
+				XUARTPS_SR_RXEMPTY) != XUARTPS_SR_RXEMPTY) {
+				numbytes = 0;
+				do {
+					chunk[numbytes++] = (unsigned char)
+						xuartps_readl(
+							XUARTPS_FIFO_OFFSET);
+				} while (numbytes < sizeof(chunk) &&
+					(xuartps_readl(XUARTPS_SR_OFFSET) &
+					XUARTPS_SR_RXEMPTY) !=
+					XUARTPS_SR_RXEMPTY);
+
+				port->icount.rx += numbytes;
+				tty_insert_flip_string(&port->state->port,
+							chunk, numbytes);
+			}
+			goto rx_push;
+		}
 		/* Receive Timeout Interrupt */
 		while ((xuartps_readl(XUARTPS_SR_OFFSET) &
 			XUARTPS_SR_RXEMPTY) != XUARTPS_SR_RXEMPTY) {
@@ -265,6 +409,7 @@ static irqreturn_t xuartps_isr(int irq, void *dev_id)
 			uart_insert_char(port, isrstatus, XUARTPS_IXR_OVERRUN,
 					data, status);
 		}
+rx_push:
 		spin_unlock(&port->lock);
 		tty_flip_buffer_push(&port->state->port);
 		spin_lock(&port->lock);
@@ -272,11 +417,17 @@ static irqreturn_t xuartps_isr(int irq, void *dev_id)
 
 	/* Dispatch an appropriate handler */
 	if ((isrstatus & XUARTPS_IXR_TXEMPTY) == XUARTPS_IXR_TXEMPTY) {
+		/* Deferred console bytes go out first, tty data gets
+		 * whatever FIFO space is left.
+		 */
+		numbytes = port->fifosize -
+				xuartps_console_emit(port, port->fifosize);
+
 		if (uart_circ_empty(&port->state->xmit)) {
-			xuartps_writel(XUARTPS_IXR_TXEMPTY,
-						XUARTPS_IDR_OFFSET);
+			if (!xuartps_console_pending(port))
+				xuartps_writel(XUARTPS_IXR_TXEMPTY,
+							XUARTPS_IDR_OFFSET);
 		} else {
-			numbytes = port->fifosize;
 			/* Break if no more data available in the UART buffer */
 			while (numbytes--) {
 				if (uart_circ_empty(&port->state->xmit))
@@ -804,6 +955,9 @@ static int xuartps_startup(struct uart_port *port)
 
 	spin_unlock_irqrestore(&port->lock, flags);
 
+	/* The interrupt handler can emit deferred console bytes now */
+	xuartps_console_set_ready(port, 1);
+
 	return retval;
 }
 
@@ -817,6 +971,9 @@ static void xuartps_shutdown(struct uart_port *port)
 	int status;
 	unsigned long flags;
 
+	/* Console output falls back to the synchronous path */
+	xuartps_console_set_ready(port, 0);
+
 	spin_lock_irqsave(&port->lock, flags);
 
 	/* Disable interrupts */
@@ -1087,13 +1244,80 @@ static void xuartps_console_wait_tx(struct uart_port *port)
  * @port: Handle to the uart port structure
  * @ch: Character to be written
  *
+ * Waits for FIFO space rather than for a completely drained FIFO, so
+ * consecutive characters stream out back to back.
  **/
 static void xuartps_console_putchar(struct uart_port *port, int ch)
 {
-	xuartps_console_wait_tx(port);
+	while (xuartps_readl(XUARTPS_SR_OFFSET) & XUARTPS_SR_TXFULL)
+		barrier();
 	xuartps_writel(ch, XUARTPS_FIFO_OFFSET);
 }
 
+/**
+ * xuartps_console_defer - Queue console output for the TX interrupt
+ * @port: Handle to the uart port structure
+ * @s: Pointer to character array
+ * @count: No of characters
+ *
+ * Buffers the message, primes the TX FIFO and arms the TX empty
+ * interrupt to stream out the rest. Returns non-zero if the whole
+ * message was queued; zero if deferral is off or the kfifo is too
+ * full, in which case nothing was queued and the caller must fall
+ * back to synchronous output.
+ */
+static int xuartps_console_defer(struct uart_port *port, const char *s,
+				unsigned int count)
+{
+	struct xuartps *xuartps = port->private_data;
+	unsigned long flags;
+	unsigned int i, ctrl;
+	int queued = 1;
+
+	if (!xuartps)
+		return 0;
+
+	spin_lock_irqsave(&xuartps->con_lock, flags);
+	if (!xuartps->con_ready ||
+	    kfifo_avail(&xuartps->con_fifo) < 2 * count) {
+		queued = 0;
+	} else {
+		for (i = 0; i < count; i++) {
+			unsigned char c = s[i];
+
+			if (c == '\n') {
+				unsigned char cr = '\r';
+
+				kfifo_put(&xuartps->con_fifo, &cr);
+			}
+			kfifo_put(&xuartps->con_fifo, &c);
+		}
+	}
+	spin_unlock_irqrestore(&xuartps->con_lock, flags);
+
+	if (!queued)
+		return 0;
+
+	spin_lock_irqsave(&port->lock, flags);
+
+	/* Make sure the transmitter is enabled */
+	ctrl = xuartps_readl(XUARTPS_CR_OFFSET);
+	xuartps_writel((ctrl & ~XUARTPS_CR_TX_DIS) | XUARTPS_CR_TX_EN,
+		XUARTPS_CR_OFFSET);
+
+	/* Prime the FIFO; short messages go out with no interrupt at all */
+	xuartps_console_emit(port, port->fifosize);
+
+	if (xuartps_console_pending(port)) {
+		xuartps_writel(XUARTPS_IXR_TXEMPTY, XUARTPS_ISR_OFFSET);
+		xuartps_writel(XUARTPS_IXR_TXEMPTY, XUARTPS_IER_OFFSET);
+	}
+
+	spin_unlock_irqrestore(&port->lock, flags);
+
+	return 1;
+}
+
 /**
  * xuartps_console_write - perform write operation
  * @port: Handle to the uart port structure
@@ -1104,10 +1328,14 @@ static void xuartps_console_write(struct console *co, const char *s,
 				unsigned int count)
 {
 	struct uart_port *port = &xuartps_port[co->index];
+	struct xuartps *xuartps = port->private_data;
 	unsigned long flags;
 	unsigned int imr, ctrl;
 	int locked = 1;
 
+	if (!oops_in_progress && xuartps_console_defer(port, s, count))
+		return;
+
 	if (oops_in_progress)
 		locked = spin_trylock_irqsave(&port->lock, flags);
 	else
@@ -1125,6 +1353,23 @@ static void xuartps_console_write(struct console *co, const char *s,
 	xuartps_writel((ctrl & ~XUARTPS_CR_TX_DIS) | XUARTPS_CR_TX_EN,
 		XUARTPS_CR_OFFSET);
 
+	/* Emit anything still deferred first so output never reorders */
+	if (xuartps) {
+		int con_locked = 1;
+		unsigned char c;
+
+		if (oops_in_progress)
+			con_locked = spin_trylock(&xuartps->con_lock);
+		else
+			spin_lock(&xuartps->con_lock);
+
+		if (con_locked) {
+			while (kfifo_get(&xuartps->con_fifo, &c))
+				xuartps_console_putchar(port, c);
+			spin_unlock(&xuartps->con_lock);
+		}
+	}
+
 	uart_console_write(port, s, count, xuartps_console_putchar);
 	xuartps_console_wait_tx(port);
 
@@ -1248,6 +1493,7 @@ static int xuartps_probe(struct platform_device *pdev)
 
 	port = xuartps_get_port(id);
 	xuartps = kmalloc(sizeof(*xuartps), GFP_KERNEL);
+	xuartps_console_buf_init(xuartps);
 	if (res2->start == 59)
 		xuartps->uartnum = 0;
 	else
@@ -0,0 +1,602 @@
+/*
+ * drivers/uio/uio_dma_streaming.c
+ *
+ * Userspace I/O platform driver exporting a cached streaming-DMA buffer
+ * ring to userspace.
+ *
+ * Based on uio_dmem_genirq.c by Damian Hobson-Garcia
+ *
+ * uio_dmem_genirq hands out coherent - on ARM uncached - memory and
+ * signals one event per read() round trip, which makes the CPU side of
+ * a programmable logic pipeline pay uncached load cost for every result
+ * word.  This driver instead allocates one cached ring of buffers,
+ * keeps it mapped for streaming DMA, and leaves cache maintenance to
+ * explicit sync ioctls so userspace only pays for the ranges it
+ * actually touches.  Buffer completion is communicated through
+ * per-slot ownership flags in the ring header written by the device,
+ * so a single interrupt wakeup can report any number of finished
+ * buffers.  See include/uapi/linux/uio_dma_streaming.h for the ABI.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as published by
+ * the Free Software Foundation.
+ */
+
+#include <linux/platform_device.h>
+#include <linux/uio_driver.h>
+#include <linux/uio_dma_streaming.h>
+#include <linux/spinlock.h>
+#include <linux/bitops.h>
+#include <linux/module.h>
+#include <linux/interrupt.h>
+#include <linux/platform_data/uio_dma_streaming.h>
+#include <linux/stringify.h>
+#include <linux/pm_runtime.h>
+#include <linux/dma-mapping.h>
+#include <linux/slab.h>
+#include <linux/mm.h>
+#include <linux/uaccess.h>
+#include <linux/pipe_fs_i.h>
+#include <linux/splice.h>
+
+#include <linux/of.h>
+#include <linux/of_platform.h>
+#include <linux/of_address.h>
+
+#define DRIVER_NAME "uio_dma_streaming"
+#define DMAS_MAP_ERROR (~0)
+
+struct uio_dmas_platdata {
+	struct uio_info *uioinfo;
+	spinlock_t lock;
+	unsigned long flags;
+	struct platform_device *pdev;
+	unsigned int num_bufs;
+	unsigned int buf_size;
+	unsigned int ring_index;	/* uio mem slot of the ring */
+	size_t ring_size;
+	phys_addr_t ring_base;		/* boot-time carveout, 0 = allocate */
+	bool ring_preserve;		/* keep carveout contents across boots */
+	void *ring_vaddr;
+	dma_addr_t ring_dma;
+	struct mutex alloc_lock;
+	unsigned int refcnt;
+};
+
+static int uio_dmas_open(struct uio_info *info, struct inode *inode)
+{
+	struct uio_dmas_platdata *priv = info->priv;
+	struct uio_mem *uiomem = &info->mem[priv->ring_index];
+	struct device *dev = &priv->pdev->dev;
+
+	mutex_lock(&priv->alloc_lock);
+	if (!priv->refcnt) {
+		struct uio_dmas_ring_hdr *hdr;
+
+		if (priv->ring_base) {
+			/*
+			 * Boot-time carveout: the region was reserved from
+			 * lowmem (e.g. by a /memreserve/ entry), so it is
+			 * still covered by the section-mapped linear map
+			 * and can be larger than the page allocator serves.
+			 * Only the header page needs clearing; the capture
+			 * slots are overwritten by the device anyway.  A
+			 * preserved carveout whose header still matches the
+			 * configuration is left untouched so a warm (kexec)
+			 * boot hands the previous instance's ring straight
+			 * to the new daemon.
+			 */
+			priv->ring_vaddr = phys_to_virt(priv->ring_base);
+			hdr = priv->ring_vaddr;
+			if (!(priv->ring_preserve &&
+			      hdr->num_bufs == priv->num_bufs &&
+			      hdr->buf_size == priv->buf_size))
+				memset(priv->ring_vaddr, 0, PAGE_SIZE);
+		} else {
+			priv->ring_vaddr = alloc_pages_exact(priv->ring_size,
+						GFP_KERNEL | __GFP_ZERO);
+			if (!priv->ring_vaddr)
+				goto out_err;
+		}
+
+		hdr = priv->ring_vaddr;
+		hdr->num_bufs = priv->num_bufs;
+		hdr->buf_size = priv->buf_size;
+		/* all slots start CPU owned; the flag words were cleared */
+
+		priv->ring_dma = dma_map_single(dev, priv->ring_vaddr,
+						priv->ring_size,
+						DMA_BIDIRECTIONAL);
+		if (dma_mapping_error(dev, priv->ring_dma)) {
+			if (!priv->ring_base)
+				free_pages_exact(priv->ring_vaddr,
+						 priv->ring_size);
+			priv->ring_vaddr = NULL;
+			goto out_err;
+		}
+
+		uiomem->addr = virt_to_phys(priv->ring_vaddr);
+	}
+	priv->refcnt++;
+	mutex_unlock(&priv->alloc_lock);
+
+	/* Wait until the Runtime PM code has woken up the device */
+	pm_runtime_get_sync(dev);
+	return 0;
+
+out_err:
+	mutex_unlock(&priv->alloc_lock);
+	return -ENOMEM;
+}
+
+static int uio_dmas_release(struct uio_info *info, struct inode *inode)
+{
+	struct uio_dmas_platdata *priv = info->priv;
+	struct uio_mem *uiomem = &info->mem[priv->ring_index];
+	struct device *dev = &priv->pdev->dev;
+
+	/* Tell the Runtime PM code that the device has become idle */
+	pm_runtime_put_sync(dev);
+
+	mutex_lock(&priv->alloc_lock);
+	priv->refcnt--;
+	if (!priv->refcnt && priv->ring_vaddr) {
+		dma_unmap_single(dev, priv->ring_dma, priv->ring_size,
+				 DMA_BIDIRECTIONAL);
+		if (!priv->ring_base)
+			free_pages_exact(priv->ring_vaddr, priv->ring_size);
+		priv->ring_vaddr = NULL;
+		uiomem->addr = DMAS_MAP_ERROR;
+	}
+	mutex_unlock(&priv->alloc_lock);
+	return 0;
+}
+
+static int uio_dmas_mmap(struct uio_info *info, struct vm_area_struct *vma)
+{
+	struct uio_dmas_platdata *priv = info->priv;
+	unsigned long mi = vma->vm_pgoff;
+
+	/*
+	 * The uio core has already validated the map index and length.
+	 * Register windows get the usual uncached mapping; the ring is
+	 * deliberately left cached, the sync ioctls do the maintenance.
+	 */
+	if (mi != priv->ring_index)
+		vma->vm_page_prot = pgprot_noncached(vma->vm_page_prot);
+
+	return remap_pfn_range(vma, vma->vm_start,
+			       info->mem[mi].addr >> PAGE_SHIFT,
+			       vma->vm_end - vma->vm_start,
+			       vma->vm_page_prot);
+}
+
+static long uio_dmas_ioctl(struct uio_info *info, unsigned int cmd,
+			   unsigned long arg)
+{
+	struct uio_dmas_platdata *priv = info->priv;
+	struct device *dev = &priv->pdev->dev;
+	void __user *uarg = (void __user *)arg;
+
+	switch (cmd) {
+	case UIO_DMAS_SYNC_FOR_CPU:
+	case UIO_DMAS_SYNC_FOR_DEVICE: {
+		struct uio_dmas_sync sync;
+
+		if (copy_from_user(&sync, uarg, sizeof(sync)))
+			return -EFAULT;
+
+		if (sync.offset >= priv->ring_size || !sync.size ||
+		    sync.size > priv->ring_size - sync.offset)
+			return -EINVAL;
+
+		if (cmd == UIO_DMAS_SYNC_FOR_CPU)
+			dma_sync_single_range_for_cpu(dev, priv->ring_dma,
+						      sync.offset, sync.size,
+						      DMA_BIDIRECTIONAL);
+		else
+			dma_sync_single_range_for_device(dev, priv->ring_dma,
+							 sync.offset,
+							 sync.size,
+							 DMA_BIDIRECTIONAL);
+		return 0;
+	}
+	case UIO_DMAS_GET_LAYOUT: {
+		struct uio_dmas_layout layout = {
+			.dma_addr = priv->ring_dma,
+			.num_bufs = priv->num_bufs,
+			.buf_size = priv->buf_size,
+		};
+
+		if (copy_to_user(uarg, &layout, sizeof(layout)))
+			return -EFAULT;
+		return 0;
+	}
+	default:
+		return -ENOTTY;
+	}
+}
+
+/*
+ * The ring lives in linear-map pages (alloc_pages_exact or a lowmem
+ * carveout), so captured buffers can be handed to the pipe machinery by
+ * reference instead of being copied through read()/write().  The pages
+ * are never stolen from the ring; consumers that hold page references
+ * past splice() - a TCP socket until the data is acked, for instance -
+ * keep seeing the slot contents, so userspace must not hand a slot back
+ * to the device before the spliced data has been consumed downstream.
+ */
+static int uio_dmas_pipe_buf_steal(struct pipe_inode_info *pipe,
+				   struct pipe_buffer *buf)
+{
+	return 1;	/* the page stays in the ring */
+}
+
+static const struct pipe_buf_operations uio_dmas_pipe_buf_ops = {
+	.can_merge = 0,
+	.map = generic_pipe_buf_map,
+	.unmap = generic_pipe_buf_unmap,
+	.confirm = generic_pipe_buf_confirm,
+	.release = generic_pipe_buf_release,
+	.steal = uio_dmas_pipe_buf_steal,
+	.get = generic_pipe_buf_get,
+};
+
+static void uio_dmas_spd_release(struct splice_pipe_desc *spd, unsigned int i)
+{
+	put_page(spd->pages[i]);
+}
+
+/*
+ * splice() offsets address bytes within the ring mapping, header page
+ * included, just like the sync ioctls.  The kernel reads through the
+ * linear map, which aliases the cached user mapping at the same colour,
+ * so the usual UIO_DMAS_SYNC_FOR_CPU before harvesting a slot is all
+ * the maintenance a splice needs.
+ */
+static ssize_t uio_dmas_splice_read(struct uio_info *info, loff_t *ppos,
+				    struct pipe_inode_info *pipe, size_t len,
+				    unsigned int flags)
+{
+	struct uio_dmas_platdata *priv = info->priv;
+	struct page *pages[PIPE_DEF_BUFFERS];
+	struct partial_page partial[PIPE_DEF_BUFFERS];
+	struct splice_pipe_desc spd = {
+		.pages = pages,
+		.partial = partial,
+		.nr_pages_max = PIPE_DEF_BUFFERS,
+		.flags = flags,
+		.ops = &uio_dmas_pipe_buf_ops,
+		.spd_release = uio_dmas_spd_release,
+	};
+	loff_t pos = *ppos;
+	ssize_t ret;
+
+	/* the ring exists for as long as the fd behind this call is open */
+	if (!priv->ring_vaddr)
+		return -EINVAL;
+
+	if (pos < 0 || pos >= priv->ring_size)
+		return 0;
+	if (len > priv->ring_size - pos)
+		len = priv->ring_size - pos;
+	if (!len)
+		return 0;
+
+	while (len && spd.nr_pages < PIPE_DEF_BUFFERS) {
+		void *addr = priv->ring_vaddr + pos;
+		unsigned int plen = min_t(size_t, len,
+					  PAGE_SIZE - offset_in_page(addr));
+		struct page *page = virt_to_page(addr);
+
+		get_page(page);
+		pages[spd.nr_pages] = page;
+		partial[spd.nr_pages].offset = offset_in_page(addr);
+		partial[spd.nr_pages].len = plen;
+		spd.nr_pages++;
+		pos += plen;
+		len -= plen;
+	}
+
+	ret = splice_to_pipe(pipe, &spd);
+	if (ret > 0)
+		*ppos += ret;
+
+	return ret;
+}
+
+static irqreturn_t uio_dmas_handler(int irq, struct uio_info *dev_info)
+{
+	struct uio_dmas_platdata *priv = dev_info->priv;
+
+	/* Just disable the interrupt in the interrupt controller, and
+	 * remember the state so we can allow user space to enable it later.
+	 */
+
+	if (!test_and_set_bit(0, &priv->flags))
+		disable_irq_nosync(irq);
+
+	return IRQ_HANDLED;
+}
+
+static int uio_dmas_irqcontrol(struct uio_info *dev_info, s32 irq_on)
+{
+	struct uio_dmas_platdata *priv = dev_info->priv;
+	unsigned long flags;
+
+	/* Allow user space to enable and disable the interrupt
+	 * in the interrupt controller, but keep track of the
+	 * state to prevent per-irq depth damage.
+	 *
+	 * Serialize this operation to support multiple tasks.
+	 */
+
+	spin_lock_irqsave(&priv->lock, flags);
+	if (irq_on) {
+		if (test_and_clear_bit(0, &priv->flags))
+			enable_irq(dev_info->irq);
+	} else {
+		if (!test_and_set_bit(0, &priv->flags))
+			disable_irq(dev_info->irq);
+	}
+	spin_unlock_irqrestore(&priv->lock, flags);
+
+	return 0;
+}
+
+static int uio_dmas_probe(struct platform_device *pdev)
+{
+	struct uio_dma_streaming_pdata *pdata = pdev->dev.platform_data;
+	struct uio_info *uioinfo = NULL;
+	struct uio_dmas_platdata *priv;
+	struct uio_mem *uiomem;
+	unsigned int num_bufs = 0, buf_size = 0;
+	phys_addr_t ring_base = 0;
+	bool ring_preserve = false;
+	int ret = -EINVAL;
+	int i;
+
+	if (pdev->dev.of_node) {
+		u32 base = 0;
+		int irq;
+
+		/* alloc uioinfo for one device */
+		uioinfo = kzalloc(sizeof(*uioinfo), GFP_KERNEL);
+		if (!uioinfo) {
+			ret = -ENOMEM;
+			dev_err(&pdev->dev, "unable to kmalloc\n");
+			goto bad2;
+		}
+		uioinfo->name = pdev->dev.of_node->name;
+		uioinfo->version = "devicetree";
+
+		/* Multiple IRQs are not supported */
+		irq = platform_get_irq(pdev, 0);
+		if (irq == -ENXIO)
+			uioinfo->irq = UIO_IRQ_NONE;
+		else
+			uioinfo->irq = irq;
+
+		of_property_read_u32(pdev->dev.of_node, "uio,num-buffers",
+				     &num_bufs);
+		of_property_read_u32(pdev->dev.of_node, "uio,buffer-size",
+				     &buf_size);
+		/*
+		 * Optional boot-time carveout for the ring, typically a
+		 * /memreserve/ region; lets the ring grow well past what
+		 * the page allocator can hand out in one piece.
+		 */
+		of_property_read_u32(pdev->dev.of_node, "uio,ring-base",
+				     &base);
+		ring_base = base;
+		ring_preserve = of_property_read_bool(pdev->dev.of_node,
+						      "uio,ring-preserve");
+	} else if (pdata) {
+		uioinfo = &pdata->uioinfo;
+		num_bufs = pdata->num_bufs;
+		buf_size = pdata->buf_size;
+		ring_base = pdata->ring_base;
+		ring_preserve = pdata->ring_preserve;
+	}
+
+	if (!uioinfo || !uioinfo->name || !uioinfo->version) {
+		dev_err(&pdev->dev, "missing platform_data\n");
+		goto bad0;
+	}
+
+	if (uioinfo->handler || uioinfo->irqcontrol ||
+	    uioinfo->irq_flags & IRQF_SHARED) {
+		dev_err(&pdev->dev, "interrupt configuration error\n");
+		goto bad0;
+	}
+
+	/* the ownership flags must fit the single header page */
+	if (!num_bufs || !buf_size || buf_size & ~PAGE_MASK ||
+	    sizeof(struct uio_dmas_ring_hdr) +
+	    (size_t)num_bufs * sizeof(u32) > PAGE_SIZE) {
+		dev_err(&pdev->dev, "invalid ring configuration\n");
+		goto bad0;
+	}
+
+	/* a carveout must be reserved lowmem so the linear map covers it */
+	if (ring_base &&
+	    (ring_base & ~PAGE_MASK ||
+	     !pfn_valid(__phys_to_pfn(ring_base)) ||
+	     !pfn_valid(__phys_to_pfn(ring_base + PAGE_SIZE +
+				      (size_t)num_bufs * buf_size - 1)))) {
+		dev_err(&pdev->dev, "invalid ring carveout\n");
+		goto bad0;
+	}
+
+	priv = kzalloc(sizeof(*priv), GFP_KERNEL);
+	if (!priv) {
+		ret = -ENOMEM;
+		dev_err(&pdev->dev, "unable to kmalloc\n");
+		goto bad0;
+	}
+
+	dma_set_coherent_mask(&pdev->dev, DMA_BIT_MASK(32));
+
+	priv->uioinfo = uioinfo;
+	spin_lock_init(&priv->lock);
+	priv->flags = 0; /* interrupt is enabled to begin with */
+	priv->pdev = pdev;
+	priv->num_bufs = num_bufs;
+	priv->buf_size = buf_size;
+	priv->ring_base = ring_base;
+	priv->ring_preserve = ring_preserve && ring_base;
+	priv->ring_size = PAGE_SIZE + (size_t)num_bufs * buf_size;
+	mutex_init(&priv->alloc_lock);
+
+	if (!uioinfo->irq) {
+		ret = platform_get_irq(pdev, 0);
+		if (ret < 0) {
+			dev_err(&pdev->dev, "failed to get IRQ\n");
+			goto bad1;
+		}
+		uioinfo->irq = ret;
+	}
+	uiomem = &uioinfo->mem[0];
+
+	for (i = 0; i < pdev->num_resources; ++i) {
+		struct resource *r = &pdev->resource[i];
+
+		if (r->flags != IORESOURCE_MEM)
+			continue;
+
+		if (uiomem >= &uioinfo->mem[MAX_UIO_MAPS - 1]) {
+			dev_warn(&pdev->dev, "device has more than "
+					__stringify(MAX_UIO_MAPS)
+					" I/O memory resources.\n");
+			break;
+		}
+
+		uiomem->memtype = UIO_MEM_PHYS;
+		uiomem->addr = r->start;
+		uiomem->size = resource_size(r);
+		++uiomem;
+	}
+
+	/* the buffer ring occupies the slot after the register windows */
+	priv->ring_index = uiomem - &uioinfo->mem[0];
+	uiomem->name = "dma-ring";
+	uiomem->memtype = UIO_MEM_PHYS;
+	uiomem->addr = DMAS_MAP_ERROR;
+	uiomem->size = priv->ring_size;
+	++uiomem;
+
+	while (uiomem < &uioinfo->mem[MAX_UIO_MAPS]) {
+		uiomem->size = 0;
+		++uiomem;
+	}
+
+	/* This driver requires no hardware specific kernel code to handle
+	 * interrupts. Instead, the interrupt handler simply disables the
+	 * interrupt in the interrupt controller. User space is responsible
+	 * for performing hardware specific acknowledge and re-enabling of
+	 * the interrupt in the interrupt controller.
+	 *
+	 * Interrupt sharing is not supported.
+	 */
+
+	uioinfo->handler = uio_dmas_handler;
+	uioinfo->irqcontrol = uio_dmas_irqcontrol;
+	uioinfo->open = uio_dmas_open;
+	uioinfo->release = uio_dmas_release;
+	uioinfo->mmap = uio_dmas_mmap;
+	uioinfo->ioctl = uio_dmas_ioctl;
+	uioinfo->splice_read = uio_dmas_splice_read;
+	uioinfo->priv = priv;
+
+	/* Enable Runtime PM for this device:
+	 * The device starts in suspended state to allow the hardware to be
+	 * turned off by default. The Runtime PM bus code should power on the
+	 * hardware and enable clocks at open().
+	 */
+	pm_runtime_enable(&pdev->dev);
+
+	ret = uio_register_device(&pdev->dev, priv->uioinfo);
+	if (ret) {
+		dev_err(&pdev->dev, "unable to register uio device\n");
+		pm_runtime_disable(&pdev->dev);
+		goto bad1;
+	}
+
+	platform_set_drvdata(pdev, priv);
+	return 0;
+ bad1:
+	kfree(priv);
+ bad0:
+	/* kfree uioinfo for OF */
+	if (pdev->dev.of_node)
+		kfree(uioinfo);
+ bad2:
+	return ret;
+}
+
+static int uio_dmas_remove(struct platform_device *pdev)
+{
+	struct uio_dmas_platdata *priv = platform_get_drvdata(pdev);
+
+	uio_unregister_device(priv->uioinfo);
+	pm_runtime_disable(&pdev->dev);
+
+	priv->uioinfo->handler = NULL;
+	priv->uioinfo->irqcontrol = NULL;
+
+	/* kfree uioinfo for OF */
+	if (pdev->dev.of_node)
+		kfree(priv->uioinfo);
+
+	kfree(priv);
+	return 0;
+}
+
+static int uio_dmas_runtime_nop(struct device *dev)
+{
+	/* Runtime PM callback shared between ->runtime_suspend()
+	 * and ->runtime_resume(). Simply returns success.
+	 *
+	 * In this driver pm_runtime_get_sync() and pm_runtime_put_sync()
+	 * are used at open() and release() time. This allows the
+	 * Runtime PM code to turn off power to the device while the
+	 * device is unused, ie before open() and after release().
+	 *
+	 * This Runtime PM callback does not need to save or restore
+	 * any registers since user space is responsbile for hardware
+	 * register reinitialization after open().
+	 */
+	return 0;
+}
+
+static const struct dev_pm_ops uio_dmas_dev_pm_ops = {
+	.runtime_suspend = uio_dmas_runtime_nop,
+	.runtime_resume = uio_dmas_runtime_nop,
+};
+
+#ifdef CONFIG_OF
+static const struct of_device_id uio_dmas_of_match[] = {
+	{ .compatible = "uio,dma-streaming" },
+	{ /* sentinel */ },
+};
+MODULE_DEVICE_TABLE(of, uio_dmas_of_match);
+#else
+# define uio_dmas_of_match NULL
+#endif
+
+static struct platform_driver uio_dma_streaming = {
+	.probe = uio_dmas_probe,
+	.remove = uio_dmas_remove,
+	.driver = {
+		.name = DRIVER_NAME,
+		.owner = THIS_MODULE,
+		.pm = &uio_dmas_dev_pm_ops,
+		.of_match_table = uio_dmas_of_match,
+	},
+};
+
+module_platform_driver(uio_dma_streaming);
+
+MODULE_DESCRIPTION("Userspace I/O platform driver with cached streaming DMA.");
+MODULE_LICENSE("GPL v2");
+MODULE_ALIAS("platform:" DRIVER_NAME);
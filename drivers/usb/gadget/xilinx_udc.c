@@ -132,6 +132,7 @@ Hardware USB controller register map related constants
  * DMA transfer completion.
  */
 #define XUSB_DMA_BRR_CTRL		0x40000000 /**< DMA bufready ctrl bit */
+#define XUSB_DMA_RESET_VALUE		0x00000010 /**< DMA Reset value */
 
 /* Phase States */
 #define SETUP_PHASE			0x0000	/* Setup Phase */
@@ -192,6 +193,10 @@ struct xusb_ep {
  *@base_address the usb device base address
  *@driver pointer to the usb gadget driver instance
  *@dma_enabled flag indicating whether the dma is included in the system
+ *@dma_pending flag indicating a DMA copy is still in flight
+ *@dma_addr the DMA mapping of the in-flight copy
+ *@dma_len the length of the in-flight copy
+ *@dma_dir the direction of the in-flight mapping
  *@status status flag indicating the device cofiguration
  **/
 struct xusb_udc {
@@ -201,6 +206,10 @@ struct xusb_udc {
 	void __iomem *base_address;
 	struct usb_gadget_driver *driver;
 	u8 dma_enabled;
+	u8 dma_pending;
+	dma_addr_t dma_addr;
+	u32 dma_len;
+	enum dma_data_direction dma_dir;
 	u8 status;
 	unsigned int (*read_fn) (void __iomem *);
 	void (*write_fn) (u32, void __iomem *);
@@ -316,6 +325,117 @@ static void ep_configure(struct xusb_ep *ep, struct xusb_udc *udc)
 			(udc->base_address + XUSB_BUFFREADY_OFFSET));
 }
 
+/**
+ * xusb_dma_retire() - Retires the in-flight DMA copy, if there is one.
+ * @udc:	Pointer to the usb peripheral controller structure.
+ *
+ * The DMA engine is run asynchronously: a copy is started and the driver
+ * returns to servicing the endpoints while it completes. This function
+ * waits for the engine to go idle and then releases the buffer mapping
+ * of the copy that was in flight. It is called before a new copy is
+ * started and before a request is handed back to the gadget driver; in
+ * the common streaming case the engine has long finished and the wait
+ * falls through without spinning.
+ *
+ * returns: 0 on success and error value on DMA timeout or error
+ *
+ **/
+static int xusb_dma_retire(struct xusb_udc *udc)
+{
+	unsigned long timeout = jiffies + msecs_to_jiffies(10);
+	u32 status;
+	int rc = 0;
+
+	if (!udc->dma_pending)
+		return 0;
+
+	while ((status = udc->read_fn(udc->base_address +
+			XUSB_DMA_STATUS_OFFSET)) & XUSB_DMA_DMASR_BUSY) {
+		if (time_after(jiffies, timeout)) {
+			rc = -ETIMEDOUT;
+			break;
+		}
+		cpu_relax();
+	}
+
+	if (status & XUSB_DMA_DMASR_ERROR)
+		rc = -EIO;
+
+	if (rc) {
+		dev_err(&udc->gadget.dev, "DMA error, resetting\n");
+		udc->write_fn(XUSB_DMA_RESET_VALUE,
+			(udc->base_address + XUSB_DMA_RESET_OFFSET));
+	}
+
+	dma_unmap_single(udc->gadget.dev.parent, udc->dma_addr, udc->dma_len,
+			udc->dma_dir);
+	udc->dma_pending = 0;
+
+	return rc;
+}
+
+/**
+ * xusb_dma_start() - Starts a DMA copy between memory and the DPRAM.
+ * @ep:		Pointer to the usb endpoint configuration structure.
+ * @bufferptr:	Pointer to the request buffer in system memory.
+ * @bufferlen:	The number of bytes to copy.
+ * @direction:	The direction of data transfer (transmit or receive).
+ * @eprambase:	The endpoint buffer in the DPRAM to copy to/from.
+ * @ctrlword:	The value for the DMA control register.
+ *
+ * Retires the previous copy and kicks off the next one without waiting
+ * for it; the buffer ready bit is set by the hardware when the copy
+ * completes (XUSB_DMA_BRR_CTRL), so the engine copies one ping-pong
+ * buffer while the SIE transfers the other one on the wire.
+ *
+ * returns: 0 on success and error value on failure
+ *
+ **/
+static int xusb_dma_start(struct xusb_ep *ep, u8 *bufferptr, u32 bufferlen,
+			u8 direction, void __iomem *eprambase, u32 ctrlword)
+{
+	struct xusb_udc *udc = ep->udc;
+	u32 srcaddr;
+	u32 dstaddr;
+	int rc;
+
+	rc = xusb_dma_retire(udc);
+	if (rc)
+		return rc;
+
+	if (direction == EP_TRANSMIT) {
+		udc->dma_dir = DMA_TO_DEVICE;
+		udc->dma_addr = dma_map_single(udc->gadget.dev.parent,
+				bufferptr, bufferlen, DMA_TO_DEVICE);
+		srcaddr = udc->dma_addr;
+		dstaddr = virt_to_phys((void __force *)eprambase);
+	} else {
+		udc->dma_dir = DMA_FROM_DEVICE;
+		udc->dma_addr = dma_map_single(udc->gadget.dev.parent,
+				bufferptr, bufferlen, DMA_FROM_DEVICE);
+		srcaddr = virt_to_phys((void __force *)eprambase);
+		dstaddr = udc->dma_addr;
+	}
+	udc->dma_len = bufferlen;
+	udc->dma_pending = 1;
+
+	/*
+	 * Set the addresses in the DMA source and destination registers
+	 * and then set the length into the DMA length register, which
+	 * starts the transfer.
+	 */
+	udc->write_fn(ctrlword,
+		(udc->base_address + XUSB_DMA_CONTROL_OFFSET));
+	udc->write_fn(srcaddr,
+		(udc->base_address + XUSB_DMA_DSAR_ADDR_OFFSET));
+	udc->write_fn(dstaddr,
+		(udc->base_address + XUSB_DMA_DDAR_ADDR_OFFSET));
+	udc->write_fn(bufferlen,
+		(udc->base_address + XUSB_DMA_LENGTH_OFFSET));
+
+	return 0;
+}
+
 /**
  * ep_sendrecv() - Transmits or receives data to or from an endpoint.
  * @ep:		Pointer to the usb endpoint configuration structure.
@@ -335,9 +455,6 @@ static int ep_sendrecv(struct xusb_ep *ep, u8 *bufferptr, u32 bufferlen,
 	u32 *eprambase;
 	u32 bytestosend;
 	u8 *temprambase;
-	unsigned long timeout;
-	u32 srcaddr = 0;
-	u32 dstaddr = 0;
 	int rc = 0;
 	struct xusb_udc *udc = &controller;
 
@@ -351,40 +468,23 @@ static int ep_sendrecv(struct xusb_ep *ep, u8 *bufferptr, u32 bufferlen,
 
 		if (ep->udc->dma_enabled) {
 			if (direction == EP_TRANSMIT) {
-				srcaddr = dma_map_single(
-					ep->udc->gadget.dev.parent,
-					bufferptr, bufferlen, DMA_TO_DEVICE);
-				dstaddr = virt_to_phys(eprambase);
 				udc->write_fn(bufferlen,
 						(ep->udc->base_address +
 						ep->endpointoffset +
 						XUSB_EP_BUF0COUNT_OFFSET));
-				udc->write_fn(XUSB_DMA_BRR_CTRL |
-						(1 << (ep->epnumber)),
-						(ep->udc->base_address +
-						XUSB_DMA_CONTROL_OFFSET));
+				rc = xusb_dma_start(ep, bufferptr, bufferlen,
+					direction, (void __iomem *)eprambase,
+					XUSB_DMA_BRR_CTRL |
+					(1 << (ep->epnumber)));
 			} else {
-				srcaddr = virt_to_phys(eprambase);
-				dstaddr = dma_map_single(
-					ep->udc->gadget.dev.parent,
-					bufferptr, bufferlen, DMA_FROM_DEVICE);
-				udc->write_fn(XUSB_DMA_BRR_CTRL |
+				rc = xusb_dma_start(ep, bufferptr, bufferlen,
+					direction, (void __iomem *)eprambase,
+					XUSB_DMA_BRR_CTRL |
 					XUSB_DMA_READ_FROM_DPRAM |
-					(1 << (ep->epnumber)),
-					(ep->udc->base_address +
-					XUSB_DMA_CONTROL_OFFSET));
+					(1 << (ep->epnumber)));
 			}
-			/*
-			 * Set the addresses in the DMA source and destination
-			 * registers and then set the length into the DMA length
-			 * register.
-			 */
-			udc->write_fn(srcaddr, (ep->udc->base_address +
-				XUSB_DMA_DSAR_ADDR_OFFSET));
-			udc->write_fn(dstaddr, (ep->udc->base_address +
-				XUSB_DMA_DDAR_ADDR_OFFSET));
-			udc->write_fn(bufferlen, (ep->udc->base_address +
-					XUSB_DMA_LENGTH_OFFSET));
+			if (rc)
+				return rc;
 		} else {
 
 			while (bytestosend > 3) {
@@ -426,47 +526,27 @@ static int ep_sendrecv(struct xusb_ep *ep, u8 *bufferptr, u32 bufferlen,
 					ep->rambase + ep->ep.maxpacket);
 			if (ep->udc->dma_enabled) {
 				if (direction == EP_TRANSMIT) {
-					srcaddr = dma_map_single(
-						ep->udc->gadget.dev.parent,
-						bufferptr, bufferlen,
-						DMA_TO_DEVICE);
-					dstaddr = virt_to_phys(eprambase);
 					udc->write_fn(bufferlen,
 						(ep->udc->base_address +
 						ep->endpointoffset +
 						XUSB_EP_BUF1COUNT_OFFSET));
-					udc->write_fn(XUSB_DMA_BRR_CTRL |
+					rc = xusb_dma_start(ep, bufferptr,
+						bufferlen, direction,
+						(void __iomem *)eprambase,
+						XUSB_DMA_BRR_CTRL |
 						(1 << (ep->epnumber +
-						XUSB_STATUS_EP_BUFF2_SHIFT)),
-						(ep->udc->base_address +
-						XUSB_DMA_CONTROL_OFFSET));
+						XUSB_STATUS_EP_BUFF2_SHIFT)));
 				} else {
-					srcaddr = virt_to_phys(eprambase);
-					dstaddr = dma_map_single(
-						ep->udc->gadget.dev.parent,
-						bufferptr, bufferlen,
-						DMA_FROM_DEVICE);
-				udc->write_fn(XUSB_DMA_BRR_CTRL |
+					rc = xusb_dma_start(ep, bufferptr,
+						bufferlen, direction,
+						(void __iomem *)eprambase,
+						XUSB_DMA_BRR_CTRL |
 						XUSB_DMA_READ_FROM_DPRAM |
 						(1 << (ep->epnumber +
-						XUSB_STATUS_EP_BUFF2_SHIFT)),
-						(ep->udc->base_address +
-						XUSB_DMA_CONTROL_OFFSET));
+						XUSB_STATUS_EP_BUFF2_SHIFT)));
 				}
-				/*
-				 * Set the addresses in the DMA source and
-				 * destination registers and then set the length
-				 * into the DMA length register.
-				 */
-				udc->write_fn(srcaddr,
-					(ep->udc->base_address +
-					XUSB_DMA_DSAR_ADDR_OFFSET));
-				udc->write_fn(dstaddr,
-					(ep->udc->base_address +
-					XUSB_DMA_DDAR_ADDR_OFFSET));
-				udc->write_fn(bufferlen,
-					(ep->udc->base_address +
-					XUSB_DMA_LENGTH_OFFSET));
+				if (rc)
+					return rc;
 			} else {
 				while (bytestosend > 3) {
 					if (direction == EP_TRANSMIT)
@@ -509,39 +589,6 @@ static int ep_sendrecv(struct xusb_ep *ep, u8 *bufferptr, u32 bufferlen,
 			 */
 			return 1;
 
-	if (ep->udc->dma_enabled) {
-		/*
-		 * Wait till DMA transaction is complete and
-		 * check whether the DMA transaction was
-		 * successful.
-		 */
-		while ((udc->read_fn(ep->udc->base_address +
-			XUSB_DMA_STATUS_OFFSET) & XUSB_DMA_DMASR_BUSY) ==
-			XUSB_DMA_DMASR_BUSY) {
-			timeout = jiffies + 10000;
-
-			if (time_after(jiffies, timeout)) {
-				rc = -ETIMEDOUT;
-				goto clean;
-			}
-
-		}
-		if ((udc->read_fn(ep->udc->base_address +
-			XUSB_DMA_STATUS_OFFSET) & XUSB_DMA_DMASR_ERROR) ==
-			XUSB_DMA_DMASR_ERROR)
-			dev_dbg(&ep->udc->gadget.dev, "DMA Error\n");
-clean:
-		if (direction == EP_TRANSMIT) {
-
-			dma_unmap_single(ep->udc->gadget.dev.parent,
-				srcaddr, bufferlen, DMA_TO_DEVICE);
-		} else {
-
-			dma_unmap_single(ep->udc->gadget.dev.parent,
-				dstaddr, bufferlen, DMA_FROM_DEVICE);
-		}
-
-	}
 	return rc;
 }
 
@@ -559,6 +606,16 @@ static void done(struct xusb_ep *ep, struct xusb_request *req, int status)
 {
 	u8 stopped = ep->stopped;
 
+	/*
+	 * The last packet of this request may still be in flight on the
+	 * DMA engine; make sure it has landed before the request is
+	 * handed back, as the gadget driver may reuse the buffer right
+	 * away. This is the only point in a request where the DMA engine
+	 * is synchronized with.
+	 */
+	if (ep->udc->dma_enabled)
+		xusb_dma_retire(ep->udc);
+
 	list_del_init(&req->queue);
 
 	if (req->req.status == -EINPROGRESS)
@@ -696,7 +753,7 @@ static int write_fifo(struct xusb_ep *ep, struct xusb_request *req)
 	}
 
 	length = min(length, max);
-	if (ep_sendrecv(ep, buf, length, EP_TRANSMIT) == 1) {
+	if (ep_sendrecv(ep, buf, length, EP_TRANSMIT)) {
 		buf = req->req.buf - req->req.actual;
 		dev_dbg(&ep->udc->gadget.dev, "Send failure\n");
 		return 0;
@@ -1088,8 +1145,18 @@ static int xusb_ep_queue(struct usb_ep *_ep, struct usb_request *_req,
 			if (ep->is_in) {
 				dev_dbg(&ep->udc->gadget.dev,
 					"write_fifo called from queue\n");
-				if (write_fifo(ep, req) == 1)
-					req = NULL;
+				/* Fill both ping-pong buffers up front.*/
+				while (req && !(ep->curbufnum ?
+						ep->buffer1ready :
+						ep->buffer0ready)) {
+					u32 actual = req->req.actual;
+
+					if (write_fifo(ep, req) == 1) {
+						req = NULL;
+					} else if (req->req.actual == actual) {
+						break;
+					}
+				}
 			} else {
 				dev_dbg(&ep->udc->gadget.dev,
 					"read_fifo called from queue\n");
@@ -2022,16 +2089,37 @@ static void noncontrol_ep_intrhandler(void *callbackref, u8 epnum,
 	if (intrstatus & (XUSB_STATUS_EP0_BUFF2_COMP_MASK << epnum))
 		ep->buffer1ready = 0;
 
-	if (list_empty(&ep->queue))
-		req = NULL;
-	else
+	/*
+	 * A single interrupt may signal completion of both ping-pong
+	 * buffers, and completing one request may leave packets for the
+	 * next one already sitting in the buffers. Keep retiring and
+	 * refilling until both buffers are busy again (IN) or drained
+	 * (OUT), so the hardware never idles waiting for the next
+	 * interrupt.
+	 */
+	while (!list_empty(&ep->queue)) {
 		req = list_entry(ep->queue.next, struct xusb_request, queue);
-	if (!req)
-		return;
-	if (ep->is_in)
-		(void)write_fifo(ep, req);
-	else
-		(void)read_fifo(ep, req);
+
+		if (ep->is_in) {
+			u32 actual = req->req.actual;
+
+			/* Stop once the current ping-pong buffer is busy.*/
+			if (ep->curbufnum ? ep->buffer1ready :
+					ep->buffer0ready)
+				break;
+			if (write_fifo(ep, req) == 1)
+				continue;
+			if (req->req.actual == actual)
+				/* No forward progress; wait for the host.*/
+				break;
+		} else {
+			/* Stop when no received packet is pending.*/
+			if (ep->buffer0ready && ep->buffer1ready)
+				break;
+			if (read_fifo(ep, req) != 1)
+				break;
+		}
+	}
 }
 
 /**
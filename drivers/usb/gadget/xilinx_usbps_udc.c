@@ -40,6 +40,7 @@
 #include <linux/xilinx_devices.h>
 #include <linux/dmapool.h>
 #include <linux/delay.h>
+#include <linux/log2.h>
 
 #include <linux/io.h>
 #include <asm/byteorder.h>
@@ -53,6 +54,19 @@
 #define	DRIVER_AUTHOR	"Xilinx, Inc."
 #define	DRIVER_VERSION	"Apr 01, 2011"
 
+/*
+ * Interrupt threshold control, in microframes. The controller raises at
+ * most one transfer interrupt per threshold window, so the completion
+ * interrupts of back-to-back dTD chains coalesce into a single service
+ * pass through dtd_complete_irq(). 0 means interrupt immediately; the
+ * hardware reset default is 8 (one interrupt per millisecond at most).
+ * Values that are not a power of two are rounded down.
+ */
+static unsigned int irq_threshold = 8;
+module_param(irq_threshold, uint, S_IRUGO);
+MODULE_PARM_DESC(irq_threshold,
+	"Transfer interrupt threshold in microframes, 0-64, power of two");
+
 
 /* USB registers */
 #define USB_MAX_CTRL_PAYLOAD		64
@@ -112,6 +126,9 @@ struct usb_dr_device {
 #define  USB_CMD_ASYNC_SCHEDULE_EN            0x00000020
 #define  USB_CMD_SUTW                         0x00002000
 #define  USB_CMD_ATDTW                        0x00004000
+#define  USB_CMD_ITC                          0x00FF0000
+#define  USB_CMD_ITC_SHIFT                    16
+#define  USB_CMD_ITC_MAX                      64
 
 /* USB STS Register Bit Masks */
 #define  USB_STS_INT                          0x00000001
@@ -600,6 +617,14 @@ static int dr_controller_setup(struct xusbps_udc *udc)
 		cpu_relax();
 	}
 
+	/* Set the transfer interrupt threshold */
+	tmp = xusbps_readl(&dr_regs->usbcmd);
+	tmp &= ~USB_CMD_ITC;
+	if (irq_threshold)
+		tmp |= rounddown_pow_of_two(min_t(unsigned int, irq_threshold,
+				USB_CMD_ITC_MAX)) << USB_CMD_ITC_SHIFT;
+	xusbps_writel(tmp, &dr_regs->usbcmd);
+
 	/* Set the controller as device mode */
 	tmp = xusbps_readl(&dr_regs->usbmode);
 	tmp |= USB_MODE_CTRL_MODE_DEVICE;
@@ -1120,7 +1145,13 @@ static struct ep_td_struct *xusbps_build_dtd(struct xusbps_req *req, unsigned
 	/* Fill in the transfer size; set active bit */
 	swap_temp = ((*length << DTD_LENGTH_BIT_POS) | DTD_STATUS_ACTIVE);
 
-	/* Enable interrupt for the last dtd of a request */
+	/*
+	 * Enable interrupt for the last dtd of a request. Streaming
+	 * gadgets can set no_interrupt on all but the final request of
+	 * a burst; the hardware-linked chain then completes with a
+	 * single interrupt and dtd_complete_irq() retires every
+	 * finished request in that one pass.
+	 */
 	if (*is_last && !req->req.no_interrupt)
 		swap_temp |= DTD_IOC;
 
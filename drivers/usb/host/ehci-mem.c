@@ -136,6 +136,16 @@ static void ehci_mem_cleanup (struct ehci_hcd *ehci)
 		ehci->qh_pool = NULL;
 	}
 
+	while (!list_empty(&ehci->itd_reserve)) {
+		struct ehci_itd	*itd;
+
+		itd = list_first_entry(&ehci->itd_reserve, struct ehci_itd,
+				itd_list);
+		list_del(&itd->itd_list);
+		dma_pool_free(ehci->itd_pool, itd, itd->itd_dma);
+	}
+	ehci->itd_reserve_count = 0;
+
 	if (ehci->itd_pool)
 		dma_pool_destroy (ehci->itd_pool);
 	ehci->itd_pool = NULL;
@@ -194,6 +204,19 @@ static int ehci_mem_init (struct ehci_hcd *ehci, gfp_t flags)
 		goto fail;
 	}
 
+	/* optional iTD reserve, for HCDs expecting heavy iso traffic */
+	for (i = 0; i < ehci->itd_prealloc; i++) {
+		struct ehci_itd	*itd;
+		dma_addr_t	itd_dma;
+
+		itd = dma_pool_alloc(ehci->itd_pool, flags, &itd_dma);
+		if (!itd)
+			goto fail;
+		itd->itd_dma = itd_dma;
+		list_add(&itd->itd_list, &ehci->itd_reserve);
+		ehci->itd_reserve_count++;
+	}
+
 	/* SITD for full/low speed split ISO transfers */
 	ehci->sitd_pool = dma_pool_create ("ehci_sitd",
 			ehci_to_hcd(ehci)->self.controller,
@@ -1201,14 +1201,26 @@ itd_urb_transaction (
 			itd_dma = itd->itd_dma;
 		} else {
  alloc_itd:
-			spin_unlock_irqrestore (&ehci->lock, flags);
-			itd = dma_pool_alloc (ehci->itd_pool, mem_flags,
-					&itd_dma);
-			spin_lock_irqsave (&ehci->lock, flags);
-			if (!itd) {
-				iso_sched_free(stream, sched);
-				spin_unlock_irqrestore(&ehci->lock, flags);
-				return -ENOMEM;
+			/* then from the reserve filled at init time, which
+			 * avoids dropping the lock for the dma_pool
+			 */
+			if (!list_empty(&ehci->itd_reserve)) {
+				itd = list_first_entry(&ehci->itd_reserve,
+						struct ehci_itd, itd_list);
+				list_del(&itd->itd_list);
+				ehci->itd_reserve_count--;
+				itd_dma = itd->itd_dma;
+			} else {
+				spin_unlock_irqrestore (&ehci->lock, flags);
+				itd = dma_pool_alloc (ehci->itd_pool, mem_flags,
+						&itd_dma);
+				spin_lock_irqsave (&ehci->lock, flags);
+				if (!itd) {
+					iso_sched_free(stream, sched);
+					spin_unlock_irqrestore(&ehci->lock,
+							flags);
+					return -ENOMEM;
+				}
 			}
 		}
 
@@ -275,7 +275,12 @@ static void end_free_itds(struct ehci_hcd *ehci)
 
 	list_for_each_entry_safe(itd, n, &ehci->cached_itd_list, itd_list) {
 		list_del(&itd->itd_list);
-		dma_pool_free(ehci->itd_pool, itd, itd->itd_dma);
+		if (ehci->itd_reserve_count < ehci->itd_prealloc) {
+			list_add(&itd->itd_list, &ehci->itd_reserve);
+			ehci->itd_reserve_count++;
+		} else {
+			dma_pool_free(ehci->itd_pool, itd, itd->itd_dma);
+		}
 		if (itd == ehci->last_itd_to_free)
 			break;
 	}
@@ -28,6 +28,12 @@
 
 #include "ehci-xilinx-usbps.h"
 
+/* iTDs to keep pre-allocated; enough for several high-bandwidth iso
+ * streams (e.g. USB cameras) without falling back to the dma_pool in
+ * the submission path.
+ */
+#define XUSBPS_ITD_PREALLOC	64
+
 #ifdef CONFIG_USB_XUSBPS_OTG
 /********************************************************************
  * OTG related functions
@@ -391,11 +397,19 @@ static int ehci_xusbps_setup(struct usb_hcd *hcd)
 
 	hcd->has_tt = 1;
 
+	ehci->itd_prealloc = XUSBPS_ITD_PREALLOC;
+
 	/* data structure init */
 	retval = ehci_init(hcd);
 	if (retval)
 		return retval;
 
+	/* The root port is wired straight to the on-board ULPI PHY, so no
+	 * hub shares the bus budget; allow iso reservations beyond the 80%
+	 * USB 2.0 default (same override as via sysfs).
+	 */
+	ehci->uframe_periodic_max = 110;
+
 	retval = ehci_halt(ehci);
 	if (retval)
 		return retval;
@@ -516,6 +530,12 @@ static int ehci_xusbps_drv_probe(struct platform_device *pdev)
 	if (usb_disabled())
 		return -ENODEV;
 
+	/*
+	 * Port resume signalling sleeps for tens of milliseconds; let it
+	 * overlap the rest of the device resume chain.
+	 */
+	device_enable_async_suspend(&pdev->dev);
+
 	/* FIXME we only want one one probe() not two */
 	return usb_hcd_xusbps_probe(&ehci_xusbps_hc_driver, pdev);
 }
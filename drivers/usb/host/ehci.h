@@ -160,6 +160,11 @@ struct ehci_hcd {			/* one per controller */
 	struct list_head	cached_sitd_list;
 	struct ehci_sitd	*last_sitd_to_free;
 
+	/* pre-allocated iTDs, so iso urb setup needn't hit the dma_pool */
+	struct list_head	itd_reserve;
+	unsigned		itd_reserve_count;
+	unsigned		itd_prealloc;	/* reserve target, set by HCD */
+
 	/* per root hub port */
 	unsigned long		reset_done [EHCI_MAX_ROOT_PORTS];
 
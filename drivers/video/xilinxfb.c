@@ -29,6 +29,8 @@
 #include <linux/fb.h>
 #include <linux/init.h>
 #include <linux/dma-mapping.h>
+#include <linux/dmaengine.h>
+#include <linux/sizes.h>
 #include <linux/of_device.h>
 #include <linux/of_platform.h>
 #include <linux/of_address.h>
@@ -66,6 +68,21 @@
 #define REG_CTRL_ENABLE	 0x0001
 #define REG_CTRL_ROTATE	 0x0002
 
+/*
+ * The address register latches only bits 31:21, so every address the
+ * controller scans out from must sit on a 2 MB boundary. Panning is
+ * therefore possible in whole 2 MB steps: with the default 1024 pixel
+ * virtual width that is 512 lines per step, and a "virtual-resolution"
+ * of <1024 1024> gives two flippable frames for a 640x480 panel.
+ */
+#define REG_FB_ADDR_ALIGN	SZ_2M
+
+/*
+ * Rectangles smaller than this many bytes are not worth the descriptor
+ * setup and completion wait of the CDMA engine; the CPU does them.
+ */
+#define BLIT_THRESHOLD		4096
+
 /*
  * The hardware only handles a single mode: 640x480 24 bit true
  * color. Each pixel gets a word (32 bits) of memory.  Within each word,
@@ -134,6 +151,9 @@ struct xilinxfb_drvdata {
 	dma_addr_t	fb_phys;	/* phys. address of the frame buffer */
 	int		fb_alloced;	/* Flag, was the fb memory alloced? */
 
+	struct dma_chan	*blit_chan;	/* CDMA memcpy channel for blits,
+						NULL when none is available */
+
 	u8 		flags;		/* features of the driver */
 
 	u32		reg_ctrl_default;
@@ -213,13 +233,190 @@ xilinx_fb_blank(int blank_mode, struct fb_info *fbi)
 	return 0; /* success */
 }
 
+/*
+ * Repoint the controller at another frame within the virtual buffer.
+ * No copy is involved; the flip takes effect on the next vertical
+ * refresh. The new scanout address must obey the 2 MB granularity of
+ * the address register, so only yoffsets that land on such a boundary
+ * (relative to an aligned buffer) are accepted.
+ */
+static int
+xilinx_fb_pan_display(struct fb_var_screeninfo *var, struct fb_info *fbi)
+{
+	struct xilinxfb_drvdata *drvdata = to_xilinxfb_drvdata(fbi);
+	u32 offset;
+
+	if (var->xoffset)
+		return -EINVAL;
+
+	if (var->yoffset + fbi->var.yres > fbi->var.yres_virtual)
+		return -EINVAL;
+
+	offset = var->yoffset * fbi->fix.line_length;
+	if ((drvdata->fb_phys + offset) & (REG_FB_ADDR_ALIGN - 1))
+		return -EINVAL;
+
+	xilinx_fb_out_be32(drvdata, REG_FB_ADDR, drvdata->fb_phys + offset);
+
+	return 0;
+}
+
+/*
+ * Queue one CDMA copy between two byte offsets within the frame buffer.
+ * Returns the submitted cookie, or a negative error when the engine
+ * cannot take the transfer (unaligned address on a build without the
+ * realignment engine, out of descriptors); the caller then redoes the
+ * whole operation with the CPU.
+ */
+static int xilinx_fb_blit(struct xilinxfb_drvdata *drvdata, u32 dst_off,
+			  u32 src_off, size_t len)
+{
+	struct dma_chan *chan = drvdata->blit_chan;
+	struct dma_async_tx_descriptor *desc;
+	dma_cookie_t cookie;
+
+	desc = chan->device->device_prep_dma_memcpy(chan,
+				drvdata->fb_phys + dst_off,
+				drvdata->fb_phys + src_off, len,
+				DMA_CTRL_ACK);
+	if (!desc)
+		return -ENOMEM;
+
+	cookie = dmaengine_submit(desc);
+	if (dma_submit_error(cookie))
+		return -EIO;
+
+	return cookie;
+}
+
+/*
+ * Wait for the last queued blit to retire. The frame buffer is mapped
+ * uncached, so once the engine is done the pixels are simply there; no
+ * cache maintenance is needed in either direction.
+ */
+static int xilinx_fb_blit_wait(struct xilinxfb_drvdata *drvdata,
+			       dma_cookie_t cookie)
+{
+	dma_async_issue_pending(drvdata->blit_chan);
+
+	if (dma_sync_wait(drvdata->blit_chan, cookie) != DMA_SUCCESS)
+		return -EIO;
+
+	return 0;
+}
+
+static void xilinx_fb_copyarea(struct fb_info *fbi,
+			       const struct fb_copyarea *area)
+{
+	struct xilinxfb_drvdata *drvdata = to_xilinxfb_drvdata(fbi);
+	u32 line = fbi->fix.line_length;
+	u32 width = area->width * BYTES_PER_PIXEL;
+	u32 src = area->sy * line + area->sx * BYTES_PER_PIXEL;
+	u32 dst = area->dy * line + area->dx * BYTES_PER_PIXEL;
+	dma_cookie_t cookie = 0;
+	u32 row;
+	int rc;
+
+	if (!drvdata->blit_chan || width * area->height < BLIT_THRESHOLD)
+		goto fallback;
+
+	/*
+	 * The engine gives no ordering guarantee between reads and
+	 * writes of a single transfer, so overlapping moves (scrolling
+	 * within the region) go to the CPU, which copies in the right
+	 * direction.
+	 */
+	if (area->sx < area->dx + area->width &&
+	    area->dx < area->sx + area->width &&
+	    area->sy < area->dy + area->height &&
+	    area->dy < area->sy + area->height)
+		goto fallback;
+
+	if (width == line) {
+		/* Full-width rows are one contiguous span */
+		rc = xilinx_fb_blit(drvdata, dst, src,
+				    (size_t)line * area->height);
+		if (rc < 0)
+			goto fallback;
+		cookie = rc;
+	} else {
+		for (row = 0; row < area->height; row++) {
+			rc = xilinx_fb_blit(drvdata, dst + row * line,
+					    src + row * line, width);
+			if (rc < 0)
+				goto fallback;
+			cookie = rc;
+		}
+	}
+
+	if (!xilinx_fb_blit_wait(drvdata, cookie))
+		return;
+	goto fallback_cpu;
+
+fallback:
+	/* Drain anything already queued before the CPU takes over */
+	if (cookie > 0)
+		xilinx_fb_blit_wait(drvdata, cookie);
+fallback_cpu:
+	/*
+	 * Safe to redo from scratch; nothing was overlapping, so any
+	 * rows the engine did complete just get written again.
+	 */
+	cfb_copyarea(fbi, area);
+}
+
+static void xilinx_fb_fillrect(struct fb_info *fbi,
+			       const struct fb_fillrect *rect)
+{
+	struct xilinxfb_drvdata *drvdata = to_xilinxfb_drvdata(fbi);
+	u32 line = fbi->fix.line_length;
+	u32 width = rect->width * BYTES_PER_PIXEL;
+	u32 dst = rect->dy * line + rect->dx * BYTES_PER_PIXEL;
+	struct fb_fillrect seed = *rect;
+	dma_cookie_t cookie = 0;
+	u32 row;
+	int rc;
+
+	if (!drvdata->blit_chan || rect->rop != ROP_COPY ||
+	    rect->height < 2 || width * rect->height < BLIT_THRESHOLD)
+		goto fallback;
+
+	/*
+	 * The engine has no fill primitive, so let the CPU paint the
+	 * first row of the rectangle and replicate it downwards with
+	 * copies. The mapping is uncached, so the seed row is visible
+	 * to the engine as soon as the writes have drained.
+	 */
+	seed.height = 1;
+	cfb_fillrect(fbi, &seed);
+	wmb();
+
+	for (row = 1; row < rect->height; row++) {
+		rc = xilinx_fb_blit(drvdata, dst + row * line, dst, width);
+		if (rc < 0)
+			goto fallback;
+		cookie = rc;
+	}
+
+	if (!xilinx_fb_blit_wait(drvdata, cookie))
+		return;
+	goto fallback_cpu;
+
+fallback:
+	if (cookie > 0)
+		xilinx_fb_blit_wait(drvdata, cookie);
+fallback_cpu:
+	cfb_fillrect(fbi, rect);
+}
+
 static struct fb_ops xilinxfb_ops =
 {
 	.owner			= THIS_MODULE,
 	.fb_setcolreg		= xilinx_fb_setcolreg,
 	.fb_blank		= xilinx_fb_blank,
-	.fb_fillrect		= cfb_fillrect,
-	.fb_copyarea		= cfb_copyarea,
+	.fb_pan_display		= xilinx_fb_pan_display,
+	.fb_fillrect		= xilinx_fb_fillrect,
+	.fb_copyarea		= xilinx_fb_copyarea,
 	.fb_imageblit		= cfb_imageblit,
 };
 
@@ -298,8 +495,34 @@ static int xilinxfb_assign(struct device *dev,
 	drvdata->info.fix.smem_len = fbsize;
 	drvdata->info.fix.line_length = pdata->xvirt * BYTES_PER_PIXEL;
 
+	/*
+	 * Panning goes in whole 2 MB steps of the address register; if
+	 * a step is not a whole number of lines there is nothing the
+	 * controller can pan to.
+	 */
+	if (!(REG_FB_ADDR_ALIGN % drvdata->info.fix.line_length))
+		drvdata->info.fix.ypanstep = REG_FB_ADDR_ALIGN /
+					     drvdata->info.fix.line_length;
+
+	/* Grab a CDMA memcpy channel for blits when the FPGA has one */
+	{
+		dma_cap_mask_t mask;
+
+		dma_cap_zero(mask);
+		dma_cap_set(DMA_MEMCPY, mask);
+		drvdata->blit_chan = dma_request_channel(mask, NULL, NULL);
+	}
+	if (drvdata->blit_chan)
+		dev_info(dev, "blits accelerated by %s\n",
+			 dma_chan_name(drvdata->blit_chan));
+
 	drvdata->info.pseudo_palette = drvdata->pseudo_palette;
 	drvdata->info.flags = FBINFO_DEFAULT;
+	if (drvdata->info.fix.ypanstep)
+		drvdata->info.flags |= FBINFO_HWACCEL_YPAN;
+	if (drvdata->blit_chan)
+		drvdata->info.flags |= FBINFO_HWACCEL_COPYAREA |
+				       FBINFO_HWACCEL_FILLRECT;
 	drvdata->info.var = xilinx_fb_var;
 	drvdata->info.var.height = pdata->screen_height_mm;
 	drvdata->info.var.width = pdata->screen_width_mm;
@@ -338,6 +561,8 @@ err_regfb:
 	fb_dealloc_cmap(&drvdata->info.cmap);
 
 err_cmap:
+	if (drvdata->blit_chan)
+		dma_release_channel(drvdata->blit_chan);
 	if (drvdata->fb_alloced)
 		dma_free_coherent(dev, PAGE_ALIGN(fbsize), drvdata->fb_virt,
 			drvdata->fb_phys);
@@ -372,6 +597,9 @@ static int xilinxfb_release(struct device *dev)
 
 	unregister_framebuffer(&drvdata->info);
 
+	if (drvdata->blit_chan)
+		dma_release_channel(drvdata->blit_chan);
+
 	fb_dealloc_cmap(&drvdata->info.cmap);
 
 	if (drvdata->fb_alloced)
@@ -15,8 +15,10 @@
  */
 
 #include <linux/clk.h>
+#include <linux/console.h>
 #include <linux/export.h>
 #include <linux/fs.h>
+#include <linux/hrtimer.h>
 #include <linux/init.h>
 #include <linux/interrupt.h>
 #include <linux/io.h>
@@ -24,6 +26,7 @@
 #include <linux/kernel.h>
 #include <linux/miscdevice.h>
 #include <linux/module.h>
+#include <linux/nmi.h>
 #include <linux/of.h>
 #include <linux/platform_device.h>
 #include <linux/reboot.h>
@@ -38,6 +41,7 @@
 
 static int wdt_timeout = XWDTPS_DEFAULT_TIMEOUT;
 static int nowayout = WATCHDOG_NOWAYOUT;
+static int pretimeout;
 
 module_param(wdt_timeout, int, 0);
 MODULE_PARM_DESC(wdt_timeout,
@@ -49,6 +53,11 @@ MODULE_PARM_DESC(nowayout,
 		 "Watchdog cannot be stopped once started (default="
 		 __MODULE_STRING(WATCHDOG_NOWAYOUT) ")");
 
+module_param(pretimeout, int, 0);
+MODULE_PARM_DESC(pretimeout,
+		 "Seconds before the reset to dump the system state and panic,"
+		 " 0 to disable (default=0)");
+
 /**
  * struct xwdtps - Watchdog device structure.
  * @regs: baseaddress of device.
@@ -64,6 +73,8 @@ struct xwdtps {
 	u32			prescalar;
 	u32			ctrl_clksel;
 	spinlock_t		io_lock;
+	int			pretimeout;	/* Dump window, seconds */
+	struct hrtimer		pretimer;
 };
 static struct xwdtps *wdt;
 
@@ -104,6 +115,51 @@ static struct watchdog_info xwdtps_info = {
  */
 #define XWDTPS_CCR_CRV_MASK	0x00003FFC /* Counter reset value */
 
+/**
+ * xwdtps_pretimeout -  Flight recorder dump ahead of the hardware reset.
+ *
+ * @timer: handle to the pretimeout hrtimer.
+ * Returns HRTIMER_NORESTART (not reached, the system panics).
+ *
+ * Fires in hard interrupt context when the watchdog has not been
+ * reloaded for (timeout - pretimeout) seconds, i.e. pretimeout seconds
+ * before the hardware reset. Dumps backtraces and the ftrace ring to
+ * the console and panics, so the whole dump is captured by any
+ * registered kmsg dumper (e.g. ramoops into persistent RAM via pstore)
+ * and is readable after the reboot. The watchdog is left armed: the
+ * hardware reset still happens even if the panic path itself wedges.
+ */
+static enum hrtimer_restart xwdtps_pretimeout(struct hrtimer *timer)
+{
+	console_verbose();
+	pr_emerg("xwdtps: watchdog not reloaded, reset in %d seconds\n",
+		 wdt->pretimeout);
+	if (!trigger_all_cpu_backtrace())
+		dump_stack();
+	ftrace_dump(DUMP_ALL);
+	panic("watchdog pretimeout");
+	return HRTIMER_NORESTART;
+}
+
+/**
+ * xwdtps_pretimeout_arm -  Rewind the pretimeout timer on a reload.
+ *
+ * @wdd: handle to the watchdog device structure.
+ *
+ * Only armed when the hardware reset is enabled; in interrupt mode the
+ * timeout interrupt itself is the notification. A pretimeout that does
+ * not fit inside the timeout is ignored.
+ */
+static void xwdtps_pretimeout_arm(struct watchdog_device *wdd)
+{
+	if (!wdt->rst || wdt->pretimeout <= 0 ||
+			wdt->pretimeout >= wdd->timeout)
+		return;
+	hrtimer_start(&wdt->pretimer,
+		      ktime_set(wdd->timeout - wdt->pretimeout, 0),
+		      HRTIMER_MODE_REL);
+}
+
 /**
  * xwdtps_stop -  Stop the watchdog.
  *
@@ -116,6 +172,7 @@ static int xwdtps_stop(struct watchdog_device *wdd)
 	xwdtps_writereg((XWDTPS_ZMR_ZKEY_VAL & (~XWDTPS_ZMR_WDEN_MASK)),
 			 XWDTPS_ZMR_OFFSET);
 	spin_unlock(&wdt->io_lock);
+	hrtimer_cancel(&wdt->pretimer);
 	return 0;
 }
 
@@ -129,6 +186,7 @@ static int xwdtps_reload(struct watchdog_device *wdd)
 	spin_lock(&wdt->io_lock);
 	xwdtps_writereg(0x00001999, XWDTPS_RESTART_OFFSET);
 	spin_unlock(&wdt->io_lock);
+	xwdtps_pretimeout_arm(wdd);
 	return 0;
 }
 
@@ -185,6 +243,7 @@ static int xwdtps_start(struct watchdog_device *wdd)
 	xwdtps_writereg(data, XWDTPS_ZMR_OFFSET);
 	spin_unlock(&wdt->io_lock);
 	xwdtps_writereg(0x00001999, XWDTPS_RESTART_OFFSET);
+	xwdtps_pretimeout_arm(wdd);
 	return 0;
 }
 
@@ -346,6 +405,19 @@ static int xwdtps_probe(struct platform_device *pdev)
 		xwdtps_device.timeout = XWDTPS_DEFAULT_TIMEOUT;
 	}
 
+	prop = of_get_property(pdev->dev.of_node, "pretimeout", NULL);
+	if (prop)
+		pretimeout = be32_to_cpup(prop);
+	wdt->pretimeout = pretimeout;
+	hrtimer_init(&wdt->pretimer, CLOCK_MONOTONIC, HRTIMER_MODE_REL);
+	wdt->pretimer.function = xwdtps_pretimeout;
+	if (wdt->pretimeout > 0 && wdt->pretimeout >= xwdtps_device.timeout) {
+		dev_info(&pdev->dev,
+			 "pretimeout %d does not fit in timeout %d, disabled\n",
+			 wdt->pretimeout, xwdtps_device.timeout);
+		wdt->pretimeout = 0;
+	}
+
 	watchdog_set_nowayout(&xwdtps_device, nowayout);
 	watchdog_set_drvdata(&xwdtps_device, &wdt);
 
@@ -0,0 +1,236 @@
+/*
+ * Shared buffer descriptor ring library for Xilinx DMA engines.
+ *
+ * Modern replacement for the descriptor handling of the OS-independent
+ * xdma_channel/XBufDescriptor layer in this directory.  That layer
+ * flushes every descriptor individually; here the ring is either
+ * allocated coherent, or allocated cached and synced in batches - one
+ * maintenance call per contiguous range of descriptors.  The
+ * descriptor layout stays with the driver, the library owns the ring
+ * memory and the alloc/recycle accounting.
+ *
+ *  Copyright (C) 2013 Xilinx
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ */
+
+#include <linux/device.h>
+#include <linux/dma-mapping.h>
+#include <linux/err.h>
+#include <linux/export.h>
+#include <linux/kernel.h>
+#include <linux/mm.h>
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/xilinx_bdring.h>
+
+/**
+ * xilinx_bdring_create() - Allocate and map a descriptor ring
+ * @ring:	Ring to initialize
+ * @dev:	Device doing DMA to/from the ring
+ * @bd_size:	Size of one descriptor in bytes
+ * @num:	Number of descriptors
+ * @cached:	Allocate cached memory and sync in batches
+ *
+ * A cached ring requires @bd_size to be a multiple of the cache line
+ * size so neighbouring descriptors never share a line.  The ring
+ * memory is zeroed.  Returns 0 on success, negative errno otherwise.
+ */
+int xilinx_bdring_create(struct xilinx_bdring *ring, struct device *dev,
+			 u32 bd_size, u32 num, bool cached)
+{
+	size_t size = (size_t)bd_size * num;
+
+	if (!bd_size || !num)
+		return -EINVAL;
+	if (cached && bd_size % dma_get_cache_alignment())
+		return -EINVAL;
+
+	ring->dev = dev;
+	ring->bd_size = bd_size;
+	ring->num = num;
+	ring->cached = cached;
+
+	if (cached) {
+		ring->bd_v = alloc_pages_exact(size, GFP_KERNEL | __GFP_ZERO);
+		if (!ring->bd_v)
+			return -ENOMEM;
+		ring->bd_p = dma_map_single(dev, ring->bd_v, size,
+					    DMA_BIDIRECTIONAL);
+		if (dma_mapping_error(dev, ring->bd_p)) {
+			free_pages_exact(ring->bd_v, size);
+			ring->bd_v = NULL;
+			return -ENOMEM;
+		}
+	} else {
+		ring->bd_v = dma_alloc_coherent(dev, size, &ring->bd_p,
+						GFP_KERNEL);
+		if (!ring->bd_v)
+			return -ENOMEM;
+		memset(ring->bd_v, 0, size);
+	}
+
+	xilinx_bdring_reset(ring);
+	return 0;
+}
+EXPORT_SYMBOL_GPL(xilinx_bdring_create);
+
+/**
+ * xilinx_bdring_destroy() - Unmap and free a descriptor ring
+ * @ring:	Ring from xilinx_bdring_create(), may be unallocated
+ */
+void xilinx_bdring_destroy(struct xilinx_bdring *ring)
+{
+	size_t size = (size_t)ring->bd_size * ring->num;
+
+	if (!ring->bd_v)
+		return;
+
+	if (ring->cached) {
+		dma_unmap_single(ring->dev, ring->bd_p, size,
+				 DMA_BIDIRECTIONAL);
+		free_pages_exact(ring->bd_v, size);
+	} else {
+		dma_free_coherent(ring->dev, size, ring->bd_v, ring->bd_p);
+	}
+	ring->bd_v = NULL;
+}
+EXPORT_SYMBOL_GPL(xilinx_bdring_destroy);
+
+/**
+ * xilinx_bdring_reset() - Reset the alloc/recycle accounting
+ * @ring:	Ring to reset
+ *
+ * All descriptors become available again; their contents are zeroed.
+ * The hardware must be stopped.
+ */
+void xilinx_bdring_reset(struct xilinx_bdring *ring)
+{
+	ring->head = 0;
+	ring->tail = 0;
+	ring->free = ring->num;
+	memset(ring->bd_v, 0, (size_t)ring->bd_size * ring->num);
+}
+EXPORT_SYMBOL_GPL(xilinx_bdring_reset);
+
+/**
+ * xilinx_bdring_link() - Chain the descriptors circularly
+ * @ring:	Ring to chain
+ * @next_offset: Byte offset of the next-descriptor word within a BD
+ *
+ * Writes the bus address of descriptor i+1 (wrapping to 0) into every
+ * descriptor, for engines that follow hardware next pointers.
+ */
+void xilinx_bdring_link(struct xilinx_bdring *ring, u32 next_offset)
+{
+	u32 i;
+
+	for (i = 0; i < ring->num; i++) {
+		u32 *next = xilinx_bdring_bd(ring, i) + next_offset;
+
+		*next = xilinx_bdring_bd_phys(ring,
+					      xilinx_bdring_next(ring, i));
+	}
+	xilinx_bdring_sync_for_device(ring, 0, ring->num);
+}
+EXPORT_SYMBOL_GPL(xilinx_bdring_link);
+
+/**
+ * xilinx_bdring_alloc() - Reserve descriptors at the head of the ring
+ * @ring:	Ring to allocate from
+ * @count:	Number of descriptors
+ *
+ * Returns the index of the first reserved descriptor, or -ENOSPC if
+ * fewer than @count descriptors are free.  The reservation is
+ * contiguous in ring order but may wrap past the end of the ring.
+ */
+int xilinx_bdring_alloc(struct xilinx_bdring *ring, u32 count)
+{
+	u32 first = ring->head;
+
+	if (count > ring->free)
+		return -ENOSPC;
+
+	ring->free -= count;
+	ring->head += count;
+	if (ring->head >= ring->num)
+		ring->head -= ring->num;
+
+	return first;
+}
+EXPORT_SYMBOL_GPL(xilinx_bdring_alloc);
+
+/**
+ * xilinx_bdring_recycle() - Return completed descriptors to the ring
+ * @ring:	Ring the descriptors were allocated from
+ * @count:	Number of descriptors, starting at the ring tail
+ */
+void xilinx_bdring_recycle(struct xilinx_bdring *ring, u32 count)
+{
+	ring->free += count;
+	ring->tail += count;
+	if (ring->tail >= ring->num)
+		ring->tail -= ring->num;
+}
+EXPORT_SYMBOL_GPL(xilinx_bdring_recycle);
+
+/* sync one index range, splitting it where it wraps past the ring end */
+static void xilinx_bdring_sync(struct xilinx_bdring *ring, u32 first,
+			       u32 count, bool for_device)
+{
+	while (count) {
+		u32 n = min(count, ring->num - first);
+		size_t off = (size_t)first * ring->bd_size;
+		size_t len = (size_t)n * ring->bd_size;
+
+		if (for_device)
+			dma_sync_single_range_for_device(ring->dev, ring->bd_p,
+							 off, len,
+							 DMA_BIDIRECTIONAL);
+		else
+			dma_sync_single_range_for_cpu(ring->dev, ring->bd_p,
+						      off, len,
+						      DMA_BIDIRECTIONAL);
+		count -= n;
+		first = 0;
+	}
+}
+
+/**
+ * xilinx_bdring_sync_for_cpu() - Make descriptor writes by the device
+ *	visible to the CPU
+ * @ring:	Ring to sync
+ * @first:	First descriptor index
+ * @count:	Number of descriptors, may wrap past the ring end
+ *
+ * No-op on coherent rings.
+ */
+void xilinx_bdring_sync_for_cpu(struct xilinx_bdring *ring, u32 first,
+				u32 count)
+{
+	if (ring->cached)
+		xilinx_bdring_sync(ring, first, count, false);
+}
+EXPORT_SYMBOL_GPL(xilinx_bdring_sync_for_cpu);
+
+/**
+ * xilinx_bdring_sync_for_device() - Flush descriptor writes by the CPU
+ *	out to the device
+ * @ring:	Ring to sync
+ * @first:	First descriptor index
+ * @count:	Number of descriptors, may wrap past the ring end
+ *
+ * No-op on coherent rings.
+ */
+void xilinx_bdring_sync_for_device(struct xilinx_bdring *ring, u32 first,
+				   u32 count)
+{
+	if (ring->cached)
+		xilinx_bdring_sync(ring, first, count, true);
+}
+EXPORT_SYMBOL_GPL(xilinx_bdring_sync_for_device);
+
+MODULE_DESCRIPTION("Xilinx DMA buffer descriptor ring library");
+MODULE_LICENSE("GPL v2");
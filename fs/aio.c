@@ -437,6 +437,7 @@ static struct kiocb *__aio_get_req(struct kioctx *ctx)
  * times the ctx lock is acquired and released.
  */
 #define KIOCB_BATCH_SIZE	32L
+#define IOCB_PTRS_BATCH_SIZE	64L
 struct kiocb_batch {
 	struct list_head head;
 	long count; /* number of requests left to allocate */
@@ -994,16 +995,21 @@ put_rq:
 EXPORT_SYMBOL(aio_complete);
 
 /* aio_read_evt
- *	Pull an event off of the ioctx's event ring.  Returns the number of 
+ *	Pull an event off of the ioctx's event ring.  Returns the number of
  *	events fetched (0 or 1 ;-)
- *	FIXME: make this use cmpxchg.
- *	TODO: make the ringbuffer user mmap()able (requires FIXME).
+ *
+ *	The ring is mapped into the submitting process and userspace may
+ *	harvest completions from it directly (see the contract next to
+ *	struct aio_ring), so a slot is claimed by advancing head with
+ *	cmpxchg rather than a plain store.  Losing the exchange means a
+ *	user-space harvester consumed that event first; move on to the
+ *	next one.
  */
 static int aio_read_evt(struct kioctx *ioctx, struct io_event *ent)
 {
 	struct aio_ring_info *info = &ioctx->ring_info;
 	struct aio_ring *ring;
-	unsigned long head;
+	unsigned head;
 	int ret = 0;
 
 	ring = kmap_atomic(info->ring_pages[0]);
@@ -1017,14 +1023,18 @@ static int aio_read_evt(struct kioctx *ioctx, struct io_event *ent)
 	spin_lock(&info->ring_lock);
 
 	head = ring->head % info->nr;
-	if (head != ring->tail) {
+	while (head != ring->tail) {
 		struct io_event *evp = aio_ring_event(info, head);
+
+		smp_rmb(); /* read the event only after seeing it published */
 		*ent = *evp;
-		head = (head + 1) % info->nr;
-		smp_mb(); /* finish reading the event before updatng the head */
-		ring->head = head;
-		ret = 1;
 		put_aio_ring_event(evp);
+
+		if (cmpxchg(&ring->head, head, (head + 1) % info->nr) == head) {
+			ret = 1;
+			break;
+		}
+		head = ring->head % info->nr;
 	}
 	spin_unlock(&info->ring_lock);
 
@@ -1641,22 +1651,37 @@ long do_io_submit(aio_context_t ctx_id, long nr,
 	 * AKPM: should this return a partial result if some of the IOs were
 	 * successfully submitted?
 	 */
-	for (i=0; i<nr; i++) {
-		struct iocb __user *user_iocb;
-		struct iocb tmp;
+	while (i < nr) {
+		struct iocb __user *ptrs[IOCB_PTRS_BATCH_SIZE];
+		long n = min(nr - i, IOCB_PTRS_BATCH_SIZE);
+		long j;
 
-		if (unlikely(__get_user(user_iocb, iocbpp + i))) {
+		/*
+		 * Pull the iocb pointer table over in one access instead
+		 * of one __get_user() round trip per entry.
+		 */
+		if (unlikely(copy_from_user(ptrs, iocbpp + i,
+					    n * sizeof(*ptrs)))) {
 			ret = -EFAULT;
 			break;
 		}
 
-		if (unlikely(copy_from_user(&tmp, user_iocb, sizeof(tmp)))) {
-			ret = -EFAULT;
-			break;
-		}
+		for (j = 0; j < n; j++) {
+			struct iocb tmp;
 
-		ret = io_submit_one(ctx, user_iocb, &tmp, &batch, compat);
-		if (ret)
+			if (unlikely(copy_from_user(&tmp, ptrs[j],
+						    sizeof(tmp)))) {
+				ret = -EFAULT;
+				break;
+			}
+
+			ret = io_submit_one(ctx, ptrs[j], &tmp, &batch,
+					    compat);
+			if (ret)
+				break;
+			i++;
+		}
+		if (j < n)
 			break;
 	}
 	blk_finish_plug(&plug);
@@ -34,6 +34,7 @@
 #include <linux/utsname.h>
 #include <linux/coredump.h>
 #include <linux/sched.h>
+#include <linux/workqueue.h>
 #include <asm/uaccess.h>
 #include <asm/param.h>
 #include <asm/page.h>
@@ -563,6 +564,156 @@ static unsigned long randomize_stack_top(unsigned long stack_top)
 #endif
 }
 
+/*
+ * Exec-time segment readahead.
+ *
+ * Demand paging brings a large executable in one fault at a time, which
+ * is especially costly on compressed filesystems where every fault pays
+ * for block decompression.  Queue readahead of the file-backed extents
+ * of all PT_LOAD segments on a worker, so the I/O (and any decompression)
+ * overlaps with the dynamic linker's relocation work instead of being
+ * serialized behind page faults.
+ *
+ * A binary may narrow this to its hot subset by carrying a "PRELOAD"
+ * note (type 1) in a PT_NOTE segment whose descriptor is an array of
+ * { file offset, length } pairs of 64-bit words; without the note the
+ * whole of every loadable segment is read.
+ */
+#define ELF_RA_NOTE_NAME	"PRELOAD"
+#define ELF_RA_NOTE_TYPE	1
+#define ELF_RA_MAX_RANGES	16
+#define ELF_RA_MAX_NOTE_SZ	4096
+
+struct elf_ra_range {
+	__u64 offset;
+	__u64 size;
+};
+
+struct elf_ra_work {
+	struct work_struct work;
+	struct file *file;
+	unsigned int nr;
+	struct elf_ra_range range[ELF_RA_MAX_RANGES];
+};
+
+static void elf_readahead_worker(struct work_struct *work)
+{
+	struct elf_ra_work *ra = container_of(work, struct elf_ra_work, work);
+	struct address_space *mapping = ra->file->f_mapping;
+	unsigned int i;
+
+	for (i = 0; i < ra->nr; i++) {
+		pgoff_t start = ra->range[i].offset >> PAGE_CACHE_SHIFT;
+		pgoff_t end = (ra->range[i].offset + ra->range[i].size +
+			       PAGE_CACHE_SIZE - 1) >> PAGE_CACHE_SHIFT;
+
+		if (end > start)
+			force_page_cache_readahead(mapping, ra->file,
+						   start, end - start);
+	}
+	fput(ra->file);
+	kfree(ra);
+}
+
+static unsigned int elf_readahead_hints(struct file *file,
+					struct elf_phdr *phdr,
+					struct elf_ra_range *range)
+{
+	struct elf_note *note;
+	char *buf, *p;
+	unsigned int nr = 0;
+	int len;
+
+	if (phdr->p_filesz < sizeof(*note) ||
+	    phdr->p_filesz > ELF_RA_MAX_NOTE_SZ)
+		return 0;
+
+	buf = kmalloc(phdr->p_filesz, GFP_KERNEL);
+	if (!buf)
+		return 0;
+	len = kernel_read(file, phdr->p_offset, buf, phdr->p_filesz);
+	if (len != phdr->p_filesz)
+		goto out;
+
+	p = buf;
+	while (p + sizeof(*note) <= buf + len) {
+		size_t namesz, descsz, left;
+
+		note = (struct elf_note *)p;
+		p += sizeof(*note);
+		left = buf + len - p;
+		/*
+		 * Check the raw sizes first: roundup() wraps to 0 for
+		 * values near UINT_MAX, which would pass the rounded
+		 * checks below while n_descsz stays huge.
+		 */
+		if (note->n_namesz > left || note->n_descsz > left)
+			break;
+		namesz = roundup(note->n_namesz, 4);
+		descsz = roundup(note->n_descsz, 4);
+		if (namesz > left || descsz > left - namesz)
+			break;
+		if (note->n_type == ELF_RA_NOTE_TYPE &&
+		    note->n_namesz == sizeof(ELF_RA_NOTE_NAME) &&
+		    memcmp(p, ELF_RA_NOTE_NAME,
+			   sizeof(ELF_RA_NOTE_NAME)) == 0) {
+			struct elf_ra_range *hint =
+				(struct elf_ra_range *)(p + namesz);
+			unsigned int n = note->n_descsz / sizeof(*hint);
+
+			while (n-- && nr < ELF_RA_MAX_RANGES)
+				range[nr++] = *hint++;
+			break;
+		}
+		p += namesz + descsz;
+	}
+out:
+	kfree(buf);
+	return nr;
+}
+
+static void elf_readahead_segments(struct file *file, struct elfhdr *exec,
+				   struct elf_phdr *phdata)
+{
+	struct elf_ra_work *ra;
+	struct elf_phdr *phdr;
+	int i;
+
+	ra = kzalloc(sizeof(*ra), GFP_KERNEL);
+	if (!ra)
+		return;
+
+	/* A note hint trumps the full segment list. */
+	for (i = 0, phdr = phdata; i < exec->e_phnum; i++, phdr++) {
+		if (phdr->p_type != PT_NOTE)
+			continue;
+		ra->nr = elf_readahead_hints(file, phdr, ra->range);
+		if (ra->nr)
+			break;
+	}
+
+	if (!ra->nr) {
+		for (i = 0, phdr = phdata; i < exec->e_phnum; i++, phdr++) {
+			if (phdr->p_type != PT_LOAD || !phdr->p_filesz)
+				continue;
+			if (ra->nr >= ELF_RA_MAX_RANGES)
+				break;
+			ra->range[ra->nr].offset = phdr->p_offset;
+			ra->range[ra->nr].size = phdr->p_filesz;
+			ra->nr++;
+		}
+	}
+
+	if (!ra->nr) {
+		kfree(ra);
+		return;
+	}
+
+	get_file(file);
+	INIT_WORK(&ra->work, elf_readahead_worker);
+	schedule_work(&ra->work);
+}
+
 static int load_elf_binary(struct linux_binprm *bprm)
 {
 	struct file *interpreter = NULL; /* to shut gcc up */
@@ -869,6 +1020,10 @@ static int load_elf_binary(struct linux_binprm *bprm)
 			elf_brk = k;
 	}
 
+	/* Warm the page cache for what was just mapped before the dynamic
+	 * linker starts faulting it in piecemeal. */
+	elf_readahead_segments(bprm->file, &loc->elf_ex, elf_phdata);
+
 	loc->elf_ex.e_entry += load_bias;
 	elf_bss += load_bias;
 	elf_brk += load_bias;
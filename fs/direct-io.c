@@ -1052,8 +1052,10 @@ do_blockdev_direct_IO(int rw, struct kiocb *iocb, struct inode *inode,
 	dio_submit_t submit_io,	int flags)
 {
 	int seg;
+	int trimmed = 0;
 	size_t size;
 	unsigned long addr;
+	struct iovec *iov_copy = NULL;
 	unsigned i_blkbits = ACCESS_ONCE(inode->i_blkbits);
 	unsigned blkbits = i_blkbits;
 	unsigned blocksize_mask = (1 << blkbits) - 1;
@@ -1082,19 +1084,51 @@ do_blockdev_direct_IO(int rw, struct kiocb *iocb, struct inode *inode,
 			goto out;
 	}
 
-	/* Check the memory alignment.  Blocks cannot straddle pages */
+	/*
+	 * Check the memory alignment.  Blocks cannot straddle pages.
+	 *
+	 * A misaligned buffer address cannot be fixed up here, but a
+	 * request whose length merely has a misaligned tail is trimmed
+	 * down to the aligned prefix instead of being failed: the short
+	 * return makes the generic read/write paths complete the tail
+	 * through the page cache, so only the last partial block loses
+	 * zero-copy.
+	 */
 	for (seg = 0; seg < nr_segs; seg++) {
 		addr = (unsigned long)iov[seg].iov_base;
 		size = iov[seg].iov_len;
-		end += size;
 		if (unlikely((addr & blocksize_mask) ||
 			     (size & blocksize_mask))) {
 			if (bdev)
 				blkbits = blksize_bits(
 					 bdev_logical_block_size(bdev));
 			blocksize_mask = (1 << blkbits) - 1;
-			if ((addr & blocksize_mask) || (size & blocksize_mask))
+			if (addr & blocksize_mask)
 				goto out;
+			if (size & blocksize_mask) {
+				size &= ~(size_t)blocksize_mask;
+				end += size;
+				trimmed = 1;
+				nr_segs = seg + (size != 0);
+				break;
+			}
+		}
+		end += size;
+	}
+
+	if (unlikely(trimmed)) {
+		/* nothing left once the misaligned tail is dropped? */
+		if (end == offset)
+			goto out;
+		if (size) {
+			iov_copy = kmemdup(iov, nr_segs * sizeof(*iov),
+					   GFP_KERNEL);
+			if (!iov_copy) {
+				retval = -ENOMEM;
+				goto out;
+			}
+			iov_copy[nr_segs - 1].iov_len = size;
+			iov = iov_copy;
 		}
 	}
 
@@ -1278,6 +1312,7 @@ do_blockdev_direct_IO(int rw, struct kiocb *iocb, struct inode *inode,
 		BUG_ON(retval != -EIOCBQUEUED);
 
 out:
+	kfree(iov_copy);
 	return retval;
 }
 
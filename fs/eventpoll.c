@@ -981,11 +981,18 @@ static int ep_poll_callback(wait_queue_t *wait, unsigned mode, int sync, void *k
 		goto out_unlock;
 	}
 
-	/* If this file is already in the ready list we exit soon */
-	if (!ep_is_linked(&epi->rdllink)) {
-		list_add_tail(&epi->rdllink, &ep->rdllist);
-		__pm_stay_awake(epi->ws);
-	}
+	/*
+	 * If this file is already in the ready list the wakeup issued when
+	 * it got there still stands: a waiter only goes to sleep after
+	 * checking, under ep->lock, that the ready list is empty.  Waking
+	 * again would just hammer the wait queues once per event while the
+	 * dispatcher is busy draining a batch.
+	 */
+	if (ep_is_linked(&epi->rdllink))
+		goto out_unlock;
+
+	list_add_tail(&epi->rdllink, &ep->rdllist);
+	__pm_stay_awake(epi->ws);
 
 	/*
 	 * Wake up ( if active ) both the eventpoll wait list and the ->poll()
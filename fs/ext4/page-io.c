@@ -179,15 +179,49 @@ static int ext4_do_flush_completed_IO(struct inode *inode)
 	spin_unlock_irqrestore(&ei->i_completed_io_lock, flags);
 
 	while (!list_empty(&unwritten)) {
+		LIST_HEAD(batch);
+		ext4_io_end_t *next;
+
 		io = list_entry(unwritten.next, ext4_io_end_t, list);
 		BUG_ON(!(io->flag & EXT4_IO_END_UNWRITTEN));
 		list_del_init(&io->list);
 
+		/*
+		 * Writeback of a long preallocated range completes as a
+		 * train of logically contiguous io_ends.  Fold the train
+		 * into its head, so that the whole range is converted with
+		 * one journal transaction instead of one per bio.  io_ends
+		 * carrying an iocb must complete individually.
+		 */
+		while (!io->iocb && !list_empty(&unwritten)) {
+			next = list_entry(unwritten.next, ext4_io_end_t, list);
+			if (next->iocb ||
+			    next->offset != io->offset + io->size)
+				break;
+			list_move_tail(&next->list, &batch);
+			io->size += next->size;
+		}
+
 		err = ext4_end_io(io);
 		if (unlikely(!ret && err))
 			ret = err;
 		io->flag &= ~EXT4_IO_END_UNWRITTEN;
 		ext4_free_io_end(io);
+
+		/*
+		 * The folded io_ends are finished only now that the merged
+		 * range has been converted.
+		 */
+		while (!list_empty(&batch)) {
+			next = list_entry(batch.next, ext4_io_end_t, list);
+			list_del_init(&next->list);
+			if (atomic_dec_and_test(&ei->i_unwritten))
+				wake_up_all(ext4_ioend_wq(inode));
+			if (next->flag & EXT4_IO_END_DIRECT)
+				inode_dio_done(inode);
+			next->flag &= ~EXT4_IO_END_UNWRITTEN;
+			ext4_free_io_end(next);
+		}
 	}
 	return ret;
 }
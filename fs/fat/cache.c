@@ -15,6 +15,13 @@
 
 /* this must be > 0. */
 #define FAT_MAX_CACHE	8
+/*
+ * Bound for large files, where re-walking the FAT chain costs whole
+ * FAT-sector reads interleaved with the data. 64 entries cap the
+ * per-inode extent map at 2kB.
+ */
+#define FAT_MAX_CACHE_BIG	64
+#define FAT_BIG_FILE_SIZE	(32 << 20)
 
 struct fat_cache {
 	struct list_head cache_list;
@@ -32,6 +39,8 @@ struct fat_cache_id {
 
 static inline int fat_max_cache(struct inode *inode)
 {
+	if (i_size_read(inode) >= FAT_BIG_FILE_SIZE)
+		return FAT_MAX_CACHE_BIG;
 	return FAT_MAX_CACHE;
 }
 
@@ -274,8 +283,17 @@ int fat_get_cluster(struct inode *inode, int cluster, int *fclus, int *dclus)
 		}
 		(*fclus)++;
 		*dclus = nr;
-		if (!cache_contiguous(&cid, *dclus))
+		if (!cache_contiguous(&cid, *dclus)) {
+			/*
+			 * The extent we just walked past is complete; keep
+			 * it, so a later lookup in its range does not have
+			 * to re-walk the chain from the start. The failed
+			 * contiguity check counted one cluster too many.
+			 */
+			cid.nr_contig--;
+			fat_cache_add(inode, &cid);
 			cache_init(&cid, *fclus, *dclus);
+		}
 	}
 	nr = 0;
 	fat_cache_add(inode, &cid);
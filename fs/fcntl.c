@@ -325,6 +325,10 @@ static long do_fcntl(int fd, unsigned int cmd, unsigned long arg,
 		break;
 	case F_SETPIPE_SZ:
 	case F_GETPIPE_SZ:
+	case F_SETPIPE_WAKE_BYTES:
+	case F_GETPIPE_WAKE_BYTES:
+	case F_SETPIPE_WAKE_USECS:
+	case F_GETPIPE_WAKE_USECS:
 		err = pipe_fcntl(filp, cmd, arg);
 		break;
 	default:
@@ -997,6 +997,88 @@ static const struct file_operations jbd2_seq_info_fops = {
 	.release        = jbd2_seq_info_release,
 };
 
+/*
+ * Runtime knobs for the synchronous transaction batching window in
+ * jbd2_journal_stop(). The mount options (min_batch_time etc.) only
+ * take effect on a remount; these let the window be tuned against a
+ * live workload. Values are in microseconds.
+ */
+static int jbd2_seq_min_batch_show(struct seq_file *seq, void *v)
+{
+	journal_t *journal = seq->private;
+
+	seq_printf(seq, "%u\n", journal->j_min_batch_time);
+	return 0;
+}
+
+static int jbd2_seq_min_batch_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, jbd2_seq_min_batch_show, PDE(inode)->data);
+}
+
+static ssize_t jbd2_seq_min_batch_write(struct file *file,
+					const char __user *buf,
+					size_t count, loff_t *ppos)
+{
+	journal_t *journal = ((struct seq_file *)file->private_data)->private;
+	unsigned int val;
+	int err;
+
+	err = kstrtouint_from_user(buf, count, 0, &val);
+	if (err)
+		return err;
+
+	journal->j_min_batch_time = val;
+	return count;
+}
+
+static const struct file_operations jbd2_seq_min_batch_fops = {
+	.owner		= THIS_MODULE,
+	.open		= jbd2_seq_min_batch_open,
+	.read		= seq_read,
+	.write		= jbd2_seq_min_batch_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int jbd2_seq_max_batch_show(struct seq_file *seq, void *v)
+{
+	journal_t *journal = seq->private;
+
+	seq_printf(seq, "%u\n", journal->j_max_batch_time);
+	return 0;
+}
+
+static int jbd2_seq_max_batch_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, jbd2_seq_max_batch_show, PDE(inode)->data);
+}
+
+static ssize_t jbd2_seq_max_batch_write(struct file *file,
+					const char __user *buf,
+					size_t count, loff_t *ppos)
+{
+	journal_t *journal = ((struct seq_file *)file->private_data)->private;
+	unsigned int val;
+	int err;
+
+	err = kstrtouint_from_user(buf, count, 0, &val);
+	if (err)
+		return err;
+
+	journal->j_max_batch_time = val;
+	return count;
+}
+
+static const struct file_operations jbd2_seq_max_batch_fops = {
+	.owner		= THIS_MODULE,
+	.open		= jbd2_seq_max_batch_open,
+	.read		= seq_read,
+	.write		= jbd2_seq_max_batch_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 static struct proc_dir_entry *proc_jbd2_stats;
 
 static void jbd2_stats_proc_init(journal_t *journal)
@@ -1005,11 +1087,19 @@ static void jbd2_stats_proc_init(journal_t *journal)
 	if (journal->j_proc_entry) {
 		proc_create_data("info", S_IRUGO, journal->j_proc_entry,
 				 &jbd2_seq_info_fops, journal);
+		proc_create_data("min_batch_time", S_IRUGO | S_IWUSR,
+				 journal->j_proc_entry,
+				 &jbd2_seq_min_batch_fops, journal);
+		proc_create_data("max_batch_time", S_IRUGO | S_IWUSR,
+				 journal->j_proc_entry,
+				 &jbd2_seq_max_batch_fops, journal);
 	}
 }
 
 static void jbd2_stats_proc_exit(journal_t *journal)
 {
+	remove_proc_entry("max_batch_time", journal->j_proc_entry);
+	remove_proc_entry("min_batch_time", journal->j_proc_entry);
 	remove_proc_entry("info", journal->j_proc_entry);
 	remove_proc_entry(journal->j_devname, proc_jbd2_stats);
 }
@@ -427,6 +427,22 @@ void nfs_advise_use_readdirplus(struct inode *dir)
 	set_bit(NFS_INO_ADVISE_RDPLUS, &NFS_I(dir)->flags);
 }
 
+/*
+ * This function is mainly for use by nfs_getattr().
+ *
+ * If this is an 'ls -l' style readdir() call, then try to force
+ * the readdirplus semantics and flush out the readdir cache, so
+ * that the attributes for the whole directory get refilled by a
+ * handful of READDIRPLUS calls instead of one GETATTR per entry.
+ */
+void nfs_force_use_readdirplus(struct inode *dir)
+{
+	if (!list_empty(&NFS_I(dir)->open_files)) {
+		nfs_advise_use_readdirplus(dir);
+		nfs_zap_mapping(dir, dir->i_mapping);
+	}
+}
+
 static
 void nfs_prime_dcache(struct dentry *parent, struct nfs_entry *entry)
 {
@@ -1298,7 +1314,7 @@ struct dentry *nfs_lookup(struct inode *dir, struct dentry * dentry, unsigned in
 		goto out_unblock_sillyrename;
 
 	/* Success: notify readdir to use READDIRPLUS */
-	nfs_advise_use_readdirplus(dir);
+	nfs_force_use_readdirplus(dir);
 
 no_entry:
 	res = d_materialise_unique(dentry, inode);
@@ -356,6 +356,49 @@ static const struct pipe_buf_operations packet_pipe_buf_ops = {
 	.get = generic_pipe_buf_get,
 };
 
+static enum hrtimer_restart pipe_wake_timer_fn(struct hrtimer *timer)
+{
+	struct pipe_inode_info *pipe =
+		container_of(timer, struct pipe_inode_info, wake_timer);
+
+	wake_up_interruptible_poll(&pipe->wait, POLLIN | POLLRDNORM);
+	kill_fasync(&pipe->fasync_readers, SIGIO, POLL_IN);
+	return HRTIMER_NORESTART;
+}
+
+/*
+ * Reader-wakeup batching: with a byte watermark configured
+ * (F_SETPIPE_WAKE_BYTES), a write defers the reader wakeup until the
+ * pipe holds at least that many bytes, and the wake_timer bounds how
+ * long a sub-watermark batch may sit unannounced.  Wakeups issued
+ * because the writer is about to block, closes the pipe, or fills it
+ * are never deferred.  Called with i_mutex held.
+ */
+static bool pipe_defer_wakeup(struct pipe_inode_info *pipe)
+{
+	unsigned int i, bytes = 0;
+
+	if (!pipe->wake_bytes)
+		return false;
+	if (pipe->nrbufs >= pipe->buffers)
+		return false;
+
+	for (i = 0; i < pipe->nrbufs; i++)
+		bytes += pipe->bufs[(pipe->curbuf + i) &
+				    (pipe->buffers - 1)].len;
+	if (bytes >= pipe->wake_bytes) {
+		hrtimer_try_to_cancel(&pipe->wake_timer);
+		return false;
+	}
+
+	if (pipe->wake_usecs && !hrtimer_active(&pipe->wake_timer))
+		hrtimer_start(&pipe->wake_timer,
+			      ns_to_ktime((u64)pipe->wake_usecs *
+					  NSEC_PER_USEC),
+			      HRTIMER_MODE_REL);
+	return true;
+}
+
 static ssize_t
 pipe_read(struct kiocb *iocb, const struct iovec *_iov,
 	   unsigned long nr_segs, loff_t pos)
@@ -464,6 +507,9 @@ redo:
 		}
 		pipe_wait(pipe);
 	}
+	/* the batch has been consumed, no announcement needed anymore */
+	if (!pipe->nrbufs)
+		hrtimer_try_to_cancel(&pipe->wake_timer);
 	mutex_unlock(&inode->i_mutex);
 
 	/* Signal writers asynchronously that there is more room. */
@@ -649,6 +695,8 @@ redo2:
 		pipe->waiting_writers--;
 	}
 out:
+	if (do_wakeup && pipe_defer_wakeup(pipe))
+		do_wakeup = 0;
 	mutex_unlock(&inode->i_mutex);
 	if (do_wakeup) {
 		wake_up_interruptible_sync_poll(&pipe->wait, POLLIN | POLLRDNORM);
@@ -936,6 +984,9 @@ struct pipe_inode_info * alloc_pipe_info(struct inode *inode)
 			pipe->r_counter = pipe->w_counter = 1;
 			pipe->inode = inode;
 			pipe->buffers = PIPE_DEF_BUFFERS;
+			hrtimer_init(&pipe->wake_timer, CLOCK_MONOTONIC,
+				     HRTIMER_MODE_REL);
+			pipe->wake_timer.function = pipe_wake_timer_fn;
 			return pipe;
 		}
 		kfree(pipe);
@@ -948,6 +999,7 @@ void __free_pipe_info(struct pipe_inode_info *pipe)
 {
 	int i;
 
+	hrtimer_cancel(&pipe->wake_timer);
 	for (i = 0; i < pipe->buffers; i++) {
 		struct pipe_buffer *buf = pipe->bufs + i;
 		if (buf->ops)
@@ -1266,6 +1318,30 @@ long pipe_fcntl(struct file *file, unsigned int cmd, unsigned long arg)
 	case F_GETPIPE_SZ:
 		ret = pipe->buffers * PAGE_SIZE;
 		break;
+	case F_SETPIPE_WAKE_BYTES:
+		if (arg > pipe->buffers * PAGE_SIZE) {
+			ret = -EINVAL;
+			break;
+		}
+		pipe->wake_bytes = arg;
+		if (!arg)
+			hrtimer_try_to_cancel(&pipe->wake_timer);
+		ret = 0;
+		break;
+	case F_GETPIPE_WAKE_BYTES:
+		ret = pipe->wake_bytes;
+		break;
+	case F_SETPIPE_WAKE_USECS:
+		if (arg > UINT_MAX) {
+			ret = -EINVAL;
+			break;
+		}
+		pipe->wake_usecs = arg;
+		ret = 0;
+		break;
+	case F_GETPIPE_WAKE_USECS:
+		ret = pipe->wake_usecs;
+		break;
 	default:
 		ret = -EINVAL;
 		break;
@@ -25,6 +25,8 @@
 #include <linux/mutex.h>
 #include <linux/slab.h>
 #include <linux/buffer_head.h>
+#include <linux/cpumask.h>
+#include <linux/wait.h>
 
 #include "squashfs_fs.h"
 #include "squashfs_fs_sb.h"
@@ -83,10 +85,81 @@ const struct squashfs_decompressor *squashfs_lookup_decompressor(int id)
 }
 
 
+/*
+ * The decompressors keep significant state per stream, so a stream cannot be
+ * shared between concurrent readers. Rather than serializing every read on a
+ * single stream, keep a small pool of pre-allocated streams - one per online
+ * CPU - and let readers take a free one, blocking only when all of them are
+ * busy. On SMP this allows blocks to be decompressed on all CPUs in
+ * parallel.
+ */
+struct squashfs_stream {
+	int			nr;
+	int			avail;
+	spinlock_t		lock;
+	wait_queue_head_t	wait;
+	void			*strm[];
+};
+
+static void *squashfs_get_strm(struct squashfs_stream *stream)
+{
+	void *strm;
+
+	spin_lock(&stream->lock);
+	while (stream->avail == 0) {
+		spin_unlock(&stream->lock);
+		wait_event(stream->wait, stream->avail > 0);
+		spin_lock(&stream->lock);
+	}
+	strm = stream->strm[--stream->avail];
+	spin_unlock(&stream->lock);
+
+	return strm;
+}
+
+static void squashfs_put_strm(struct squashfs_stream *stream, void *strm)
+{
+	spin_lock(&stream->lock);
+	stream->strm[stream->avail++] = strm;
+	spin_unlock(&stream->lock);
+	wake_up(&stream->wait);
+}
+
+int squashfs_decompress(struct squashfs_sb_info *msblk, void **buffer,
+	struct buffer_head **bh, int b, int offset, int length, int srclength,
+	int pages)
+{
+	struct squashfs_stream *stream = msblk->stream;
+	void *strm = squashfs_get_strm(stream);
+	int res;
+
+	res = msblk->decompressor->decompress(msblk, strm, buffer, bh, b,
+		offset, length, srclength, pages);
+
+	squashfs_put_strm(stream, strm);
+
+	return res;
+}
+
+void squashfs_decompressor_free(struct squashfs_sb_info *msblk, void *s)
+{
+	struct squashfs_stream *stream = s;
+	int i;
+
+	if (stream == NULL || msblk->decompressor == NULL)
+		return;
+
+	for (i = 0; i < stream->nr; i++)
+		msblk->decompressor->free(stream->strm[i]);
+	kfree(stream);
+}
+
 void *squashfs_decompressor_init(struct super_block *sb, unsigned short flags)
 {
 	struct squashfs_sb_info *msblk = sb->s_fs_info;
-	void *strm, *buffer = NULL;
+	struct squashfs_stream *stream;
+	void *buffer = NULL;
+	int i, err, nr = num_online_cpus();
 	int length = 0;
 
 	/*
@@ -102,15 +175,41 @@ void *squashfs_decompressor_init(struct super_block *sb, unsigned short flags)
 			PAGE_CACHE_SIZE, 1);
 
 		if (length < 0) {
-			strm = ERR_PTR(length);
-			goto finished;
+			err = length;
+			goto failed;
+		}
+	}
+
+	stream = kzalloc(sizeof(*stream) + nr * sizeof(void *), GFP_KERNEL);
+	if (stream == NULL) {
+		err = -ENOMEM;
+		goto failed;
+	}
+
+	spin_lock_init(&stream->lock);
+	init_waitqueue_head(&stream->wait);
+
+	for (i = 0; i < nr; i++) {
+		void *strm = msblk->decompressor->init(msblk, buffer, length);
+
+		if (IS_ERR(strm)) {
+			err = PTR_ERR(strm);
+			goto failed_free;
 		}
+		stream->strm[i] = strm;
+		stream->nr = stream->avail = i + 1;
 	}
 
-	strm = msblk->decompressor->init(msblk, buffer, length);
+	kfree(buffer);
+
+	return stream;
 
-finished:
+failed_free:
+	while (i-- > 0)
+		msblk->decompressor->free(stream->strm[i]);
+	kfree(stream);
+failed:
 	kfree(buffer);
 
-	return strm;
+	return ERR_PTR(err);
 }
@@ -24,6 +24,21 @@
 #include <linux/syscalls.h>
 #include <linux/compat.h>
 #include <linux/rcupdate.h>
+#include <linux/mutex.h>
+#include <linux/math64.h>
+#include <linux/uaccess.h>
+
+/*
+ * Wakeup-coalescing domain: timers attached to it are aligned to the
+ * shared boundary grid of multiples of @period.  See linux/timerfd.h
+ * for the TFD_IOC_SET_DOMAIN semantics.
+ */
+struct timerfd_domain {
+	struct list_head list;
+	u64 period;
+	int refs;
+	char name[TFD_DOMAIN_NAME_LEN];
+};
 
 struct timerfd_ctx {
 	struct hrtimer tmr;
@@ -33,6 +48,7 @@ struct timerfd_ctx {
 	u64 ticks;
 	int expired;
 	int clockid;
+	struct timerfd_domain *domain;
 	struct rcu_head rcu;
 	struct list_head clist;
 	bool might_cancel;
@@ -41,6 +57,60 @@ struct timerfd_ctx {
 static LIST_HEAD(cancel_list);
 static DEFINE_SPINLOCK(cancel_lock);
 
+static LIST_HEAD(timerfd_domains);
+static DEFINE_MUTEX(timerfd_domains_lock);
+
+static struct timerfd_domain *timerfd_domain_get(const char *name, u64 period)
+{
+	struct timerfd_domain *d;
+
+	mutex_lock(&timerfd_domains_lock);
+	list_for_each_entry(d, &timerfd_domains, list) {
+		if (strcmp(d->name, name))
+			continue;
+		if (d->period != period)
+			d = ERR_PTR(-EBUSY);
+		else
+			d->refs++;
+		mutex_unlock(&timerfd_domains_lock);
+		return d;
+	}
+
+	d = kzalloc(sizeof(*d), GFP_KERNEL);
+	if (!d) {
+		mutex_unlock(&timerfd_domains_lock);
+		return ERR_PTR(-ENOMEM);
+	}
+	strcpy(d->name, name);
+	d->period = period;
+	d->refs = 1;
+	list_add(&d->list, &timerfd_domains);
+	mutex_unlock(&timerfd_domains_lock);
+	return d;
+}
+
+static void timerfd_domain_put(struct timerfd_domain *d)
+{
+	mutex_lock(&timerfd_domains_lock);
+	if (!--d->refs) {
+		list_del(&d->list);
+		kfree(d);
+	}
+	mutex_unlock(&timerfd_domains_lock);
+}
+
+/*
+ * Distance from @expires to the next boundary of the domain grid; used
+ * as the slack window so the requested time stays the early edge.
+ */
+static u64 timerfd_domain_slack(struct timerfd_domain *d, ktime_t expires)
+{
+	u64 t = ktime_to_ns(expires);
+	u64 rem = t - div64_u64(t, d->period) * d->period;
+
+	return rem ? d->period - rem : 0;
+}
+
 /*
  * This gets called when the timer event triggers. We set the "expired"
  * flag, but we do not re-arm the timer (in case it's necessary,
@@ -146,7 +216,24 @@ static int timerfd_setup(struct timerfd_ctx *ctx, int flags,
 	hrtimer_set_expires(&ctx->tmr, texp);
 	ctx->tmr.function = timerfd_tmrproc;
 	if (texp.tv64 != 0) {
-		hrtimer_start(&ctx->tmr, texp, htmode);
+		u64 slack = 0;
+
+		/*
+		 * Stretch the expiration to the next domain boundary; the
+		 * requested time becomes the early edge of the slack
+		 * window, so one hrtimer interrupt on the boundary fires
+		 * every domain member whose window it covers.
+		 */
+		if (ctx->domain) {
+			ktime_t abs = texp;
+
+			if (htmode == HRTIMER_MODE_REL)
+				abs = ktime_add(abs,
+						clockid == CLOCK_REALTIME ?
+						ktime_get_real() : ktime_get());
+			slack = timerfd_domain_slack(ctx->domain, abs);
+		}
+		hrtimer_start_range_ns(&ctx->tmr, texp, slack, htmode);
 		if (timerfd_canceled(ctx))
 			return -ECANCELED;
 	}
@@ -159,6 +246,8 @@ static int timerfd_release(struct inode *inode, struct file *file)
 
 	timerfd_remove_cancel(ctx);
 	hrtimer_cancel(&ctx->tmr);
+	if (ctx->domain)
+		timerfd_domain_put(ctx->domain);
 	kfree_rcu(ctx, rcu);
 	return 0;
 }
@@ -228,10 +317,48 @@ static ssize_t timerfd_read(struct file *file, char __user *buf, size_t count,
 	return res;
 }
 
+static long timerfd_ioctl(struct file *file, unsigned int cmd,
+			  unsigned long arg)
+{
+	struct timerfd_ctx *ctx = file->private_data;
+
+	switch (cmd) {
+	case TFD_IOC_SET_DOMAIN: {
+		struct tfd_domain_req req;
+		struct timerfd_domain *new = NULL, *old;
+
+		if (copy_from_user(&req, (void __user *)arg, sizeof(req)))
+			return -EFAULT;
+		if (req.name[TFD_DOMAIN_NAME_LEN - 1] != '\0')
+			return -EINVAL;
+		if (req.period) {
+			if (!req.name[0])
+				return -EINVAL;
+			new = timerfd_domain_get(req.name, req.period);
+			if (IS_ERR(new))
+				return PTR_ERR(new);
+		}
+
+		/* takes effect when the timer is next programmed */
+		spin_lock_irq(&ctx->wqh.lock);
+		old = ctx->domain;
+		ctx->domain = new;
+		spin_unlock_irq(&ctx->wqh.lock);
+
+		if (old)
+			timerfd_domain_put(old);
+		return 0;
+	}
+	default:
+		return -ENOTTY;
+	}
+}
+
 static const struct file_operations timerfd_fops = {
 	.release	= timerfd_release,
 	.poll		= timerfd_poll,
 	.read		= timerfd_read,
+	.unlocked_ioctl	= timerfd_ioctl,
 	.llseek		= noop_llseek,
 };
 
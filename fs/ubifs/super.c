@@ -1992,6 +1992,13 @@ static struct ubifs_info *alloc_ubifs_info(struct ubi_volume_desc *ubi)
 		INIT_LIST_HEAD(&c->orph_list);
 		INIT_LIST_HEAD(&c->orph_new);
 		c->no_chk_data_crc = 1;
+		/*
+		 * Bulk-read is a clear win on media which read sequentially at
+		 * a higher rate, like SPI NOR flash, and costs little
+		 * elsewhere, so default it to on. The "no_bulk_read" mount
+		 * option turns it off.
+		 */
+		c->bulk_read = 1;
 
 		c->highest_inum = UBIFS_FIRST_INO;
 		c->lhead_lnum = c->ltail_lnum = UBIFS_LOG_LNUM;
@@ -156,8 +156,13 @@
 /* Maximum expected tree height for use by bottom_up_buf */
 #define BOTTOM_UP_HEIGHT 64
 
-/* Maximum number of data nodes to bulk-read */
-#define UBIFS_MAX_BULK_READ 32
+/*
+ * Maximum number of data nodes to bulk-read. Compressed data nodes are much
+ * smaller than %UBIFS_MAX_DATA_NODE_SZ, so make the limit large enough for a
+ * single bulk-read to cover a whole LEB worth of them - the buffer length is
+ * capped at the LEB size anyway (see 'init_constants_early()').
+ */
+#define UBIFS_MAX_BULK_READ 128
 
 /*
  * Lockdep classes for UBIFS inode @ui_mutex.
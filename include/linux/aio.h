@@ -144,6 +144,22 @@ static inline void init_sync_kiocb(struct kiocb *kiocb, struct file *filp)
 #define AIO_RING_MAGIC			0xa10a10a1
 #define AIO_RING_COMPAT_FEATURES	1
 #define AIO_RING_INCOMPAT_FEATURES	0
+/*
+ * The ring starts at the address io_setup() hands back as the context id
+ * and is mapped into the submitting process.  When incompat_features
+ * reads zero, userspace may harvest completions from it directly instead
+ * of calling io_getevents():
+ *
+ *   consumer: read tail, smp_rmb(), copy io_events[head..tail) out, then
+ *   claim each consumed slot by advancing head (mod nr) with a cmpxchg.
+ *   io_getevents() claims slots the same way, so syscall and user-space
+ *   harvesting may be freely mixed on one context.
+ *
+ *   producer (the kernel): fills in the event and issues smp_wmb()
+ *   before publishing the new tail.
+ *
+ * head and tail always hold values already reduced mod nr.
+ */
 struct aio_ring {
 	unsigned	id;	/* kernel internal index number */
 	unsigned	nr;	/* number of io_events */
@@ -29,6 +29,8 @@
 
 #include <linux/dmaengine.h>
 #include <linux/dma-mapping.h>
+#include <linux/ioctl.h>
+#include <linux/types.h>
 
 /* Specific hardware configuration-related constants */
 #define XILINX_DMA_NO_CHANGE	0xFFFF;
@@ -39,6 +41,9 @@
 #define XILINX_DMA_IP_VDMA	0x00400000	/* A Video DMA IP */
 #define XILINX_DMA_IP_MASK	0x00700000	/* DMA IP MASK */
 
+/* Device id of the engine, in the channel match word (chan->private) */
+#define XILINX_DMA_DEVICE_ID_SHIFT	28
+
 /*
  * Device configuration structure
  *
@@ -63,8 +68,30 @@ struct xilinx_vdma_config {
 	int disable_intr;		/* Whether use interrupts */
 	int reset;			/* Reset Channel */
 	int ext_fsync;			/* External Frame Sync */
+	int frame_skip;			/* When parked, follow the source
+					   every Nth frame; 0 disables */
 };
 
+/*
+ * Zero-copy frame ring interface exported by the AXI VDMA driver
+ *
+ * Each S2MM channel in direct register mode exposes a /dev/xvdma_frmN
+ * misc device. Userspace configures the ring with
+ * XILINX_VDMA_FRMRING_SETUP, mmap()s the whole ring in one go, and
+ * poll()s/read()s for the sequence number of the newest completed frame.
+ * Frame i starts at offset i * frm_size; the index of the newest frame
+ * is (seq - 1) % num_frms.
+ */
+struct xilinx_vdma_frmring_config {
+	__u32 hsize;		/* Active line length in bytes */
+	__u32 vsize;		/* Lines per frame */
+	__u32 num_frms;		/* Frames in the ring */
+	__u32 frm_size;		/* Returned: page-aligned bytes per frame */
+};
+
+#define XILINX_VDMA_FRMRING_SETUP \
+	_IOWR('V', 0x30, struct xilinx_vdma_frmring_config)
+
 /* Device configuration structure for DMA */
 struct xilinx_dma_config {
 	enum dma_transfer_direction direction;
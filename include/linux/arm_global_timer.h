@@ -0,0 +1,28 @@
+/*
+ * Cortex-A9 MPCore global timer
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ */
+
+#ifndef __ARM_GLOBAL_TIMER_H
+#define __ARM_GLOBAL_TIMER_H
+
+#include <linux/clk.h>
+#include <linux/types.h>
+
+#ifdef CONFIG_ARM_GLOBAL_TIMER
+void arm_global_timer_init(void __iomem *base, phys_addr_t phys,
+			   struct clk *clk);
+bool arm_global_timer_is_sched_clock(void);
+#else
+static inline void arm_global_timer_init(void __iomem *base, phys_addr_t phys,
+					 struct clk *clk) {}
+static inline bool arm_global_timer_is_sched_clock(void)
+{
+	return false;
+}
+#endif
+
+#endif
@@ -28,6 +28,24 @@ struct clk *clk_register_zynq_d1m(const char *name,
 		void __iomem *clkctrl, const char **pnames, u8 num_parents,
 		spinlock_t *lock);
 
+/*
+ * Fast gate groups: pre-resolved sets of gateable leaf clocks whose
+ * hardware gates can be toggled together from any context, taking only
+ * the register spinlocks.  The group holds prepare_enable references on
+ * its members, so the framework keeps parents running; enable/disable
+ * merely flip the gate bits.  Intended for burst-duty consumers gating
+ * their clocks at frame rate.
+ */
+#define ZYNQ_CLK_GROUP_MAX	4
+
+struct zynq_clk_group;
+
+struct zynq_clk_group *zynq_clk_group_get(struct clk **clks,
+		unsigned int num);
+void zynq_clk_group_put(struct zynq_clk_group *grp);
+void zynq_clk_group_enable(struct zynq_clk_group *grp);
+void zynq_clk_group_disable(struct zynq_clk_group *grp);
+
 struct clk *clk_register_zynq_clk621(const char *name,
 		void __iomem *clkctrl, void __iomem *clk621,
 		unsigned int basediv,
@@ -81,6 +81,15 @@
  */
 #define CRYPTO_ALG_KERN_DRIVER_ONLY	0x00001000
 
+/*
+ * Set by block cipher implementations that accept one request spanning
+ * several 512-byte sectors and derive the IV of every sector after the
+ * first one internally, by incrementing the given IV once per sector.
+ * Lets users such as dm-crypt hand a whole bio to the driver in a
+ * single request instead of one request per sector.
+ */
+#define CRYPTO_ALG_BULK			0x00002000
+
 /*
  * Transform masks and values (for crt_flags).
  */
@@ -190,6 +190,12 @@ extern struct klist *bus_get_device_klist(struct bus_type *bus);
  * @owner:	The module owner.
  * @mod_name:	Used for built-in modules.
  * @suppress_bind_attrs: Disables bind/unbind via sysfs.
+ * @probe_async: Probe matching devices asynchronously.  Set by drivers
+ *		whose probe routine spends most of its time waiting on the
+ *		hardware so the boot process can carry on in the meantime.
+ *		Drivers setting this must not rely on probing order;
+ *		ordering requirements between devices are still honoured
+ *		via -EPROBE_DEFER.
  * @of_match_table: The open firmware table.
  * @acpi_match_table: The ACPI match table.
  * @probe:	Called to query the existence of a specific device,
@@ -223,6 +229,7 @@ struct device_driver {
 	const char		*mod_name;	/* used for built-in modules */
 
 	bool suppress_bind_attrs;	/* disables bind/unbind via sysfs */
+	bool probe_async;		/* probe devices asynchronously */
 
 	const struct of_device_id	*of_match_table;
 	const struct acpi_device_id	*acpi_match_table;
@@ -351,6 +351,20 @@ extern struct page *alloc_pages_vma(gfp_t gfp_mask, int order,
 extern unsigned long __get_free_pages(gfp_t gfp_mask, unsigned int order);
 extern unsigned long get_zeroed_page(gfp_t gfp_mask);
 
+extern unsigned long alloc_pages_bulk(gfp_t gfp_mask, unsigned long count,
+				      struct list_head *list);
+
+#ifdef CONFIG_ALLOC_STALL_STATS
+void alloc_stall_account(unsigned long ip, unsigned int order, u64 usecs,
+			 unsigned int retries, unsigned int compact_tries);
+#else
+static inline void alloc_stall_account(unsigned long ip, unsigned int order,
+				       u64 usecs, unsigned int retries,
+				       unsigned int compact_tries)
+{
+}
+#endif
+
 void *alloc_pages_exact(size_t size, gfp_t gfp_mask);
 void free_pages_exact(void *virt, size_t size);
 /* This is different from alloc_pages_exact_node !!! */
@@ -101,6 +101,7 @@ typedef irqreturn_t (*irq_handler_t)(int, void *);
  * @thread:	thread pointer for threaded interrupts
  * @thread_flags:	flags related to @thread
  * @thread_mask:	bitmask for keeping track of @thread activity
+ * @wake_stamp:	time the hard irq handler woke @thread, for latency stats
  * @dir:	pointer to the proc/irq/NN/name entry
  */
 struct irqaction {
@@ -114,6 +115,9 @@ struct irqaction {
 	unsigned int		flags;
 	unsigned long		thread_flags;
 	unsigned long		thread_mask;
+#ifdef CONFIG_IRQ_THREAD_LATENCY
+	u64			wake_stamp;
+#endif
 	const char		*name;
 	struct proc_dir_entry	*dir;
 } ____cacheline_internodealigned_in_smp;
@@ -343,6 +347,8 @@ static inline void enable_irq_lockdep_irqrestore(unsigned int irq, unsigned long
 
 /* IRQ wakeup (PM) control: */
 extern int irq_set_irq_wake(unsigned int irq, unsigned int on);
+extern int irq_set_priority(unsigned int irq, unsigned int prio);
+extern int irq_get_priority(unsigned int irq);
 
 static inline int enable_irq_wake(unsigned int irq)
 {
@@ -27,6 +27,9 @@ struct irq_desc;
  * @irq_count:		stats field to detect stalled irqs
  * @last_unhandled:	aging timer for unhandled count
  * @irqs_unhandled:	stats field for spurious unhandled interrupts
+ * @thread_priority:	SCHED_FIFO priority for this irq's handler threads
+ * @lat_hist:		log2(usecs) histogram of hard-irq to thread-entry delay
+ * @irq_cycles:		CPU cycles spent in this irq's hard handlers
  * @lock:		locking for SMP
  * @affinity_hint:	hint to user space for preferred irq affinity
  * @affinity_notify:	context for notification of affinity changes
@@ -52,6 +55,14 @@ struct irq_desc {
 	unsigned int		irq_count;	/* For detecting broken IRQs */
 	unsigned long		last_unhandled;	/* Aging timer for unhandled count */
 	unsigned int		irqs_unhandled;
+	unsigned int		thread_priority;
+#ifdef CONFIG_IRQ_THREAD_LATENCY
+#define IRQ_LAT_BUCKETS		16
+	unsigned int		lat_hist[IRQ_LAT_BUCKETS];
+#endif
+#ifdef CONFIG_IRQ_CYCLE_ACCOUNTING
+	u64			irq_cycles;
+#endif
 	raw_spinlock_t		lock;
 	struct cpumask		*percpu_enabled;
 #ifdef CONFIG_SMP
@@ -731,6 +731,14 @@ struct netdev_fcoe_hbainfo {
  *        (can also return NETDEV_TX_LOCKED iff NETIF_F_LLTX)
  *	Required can not be NULL.
  *
+ * netdev_tx_t (*ndo_tx_requeue)(struct sk_buff *skb,
+ *                               struct net_device *dev);
+ *	Optional. Resend an skb that ndo_start_xmit has transmitted before
+ *	and whose data has not been modified since, allowing the driver to
+ *	reuse cached DMA state instead of remapping the buffer. Only used
+ *	by traffic generators (pktgen REQUEUE mode) on dedicated test
+ *	ports; the caller must drain the device before switching payloads.
+ *
  * u16 (*ndo_select_queue)(struct net_device *dev, struct sk_buff *skb);
  *	Called to decide which queue to when device supports multiple
  *	transmit queues.
@@ -912,6 +920,8 @@ struct net_device_ops {
 	int			(*ndo_stop)(struct net_device *dev);
 	netdev_tx_t		(*ndo_start_xmit) (struct sk_buff *skb,
 						   struct net_device *dev);
+	netdev_tx_t		(*ndo_tx_requeue) (struct sk_buff *skb,
+						   struct net_device *dev);
 	u16			(*ndo_select_queue)(struct net_device *dev,
 						    struct sk_buff *skb);
 	void			(*ndo_change_rx_flags)(struct net_device *dev,
@@ -1312,6 +1322,13 @@ struct net_device {
 #define GSO_MAX_SEGS		65535
 	u16			gso_max_segs;
 
+	/* per-socket TCP small queue budget in bytes for sockets sent
+	 * out this device; 0 means use the tcp_limit_output_bytes
+	 * sysctl.  Set by drivers whose TX ring holds much less data
+	 * than the global default assumes.
+	 */
+	unsigned int		tsq_limit_output;
+
 #ifdef CONFIG_DCB
 	/* Data Center Bridging netlink ops */
 	const struct dcbnl_rtnl_ops *dcbnl_ops;
@@ -2185,6 +2202,8 @@ extern int netif_get_num_default_rss_queues(void);
  * disabled.
  */
 extern void dev_kfree_skb_irq(struct sk_buff *skb);
+extern void dev_kfree_skb_irq_bulk(struct sk_buff **skbs,
+				   unsigned int count);
 
 /* Use this variant in places where it could be invoked
  * from either hardware interrupt or other context, with hardware interrupts
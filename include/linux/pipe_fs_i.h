@@ -1,6 +1,8 @@
 #ifndef _LINUX_PIPE_FS_I_H
 #define _LINUX_PIPE_FS_I_H
 
+#include <linux/hrtimer.h>
+
 #define PIPE_DEF_BUFFERS	16
 
 #define PIPE_BUF_FLAG_LRU	0x01	/* page is on the LRU */
@@ -41,6 +43,9 @@ struct pipe_buffer {
  *	@fasync_writers: writer side fasync
  *	@inode: inode this pipe is attached to
  *	@bufs: the circular array of pipe buffers
+ *	@wake_bytes: reader wakeup watermark, 0 = wake on every write
+ *	@wake_usecs: latency bound on deferred reader wakeups
+ *	@wake_timer: enforces @wake_usecs for sub-watermark batches
  **/
 struct pipe_inode_info {
 	wait_queue_head_t wait;
@@ -55,6 +60,9 @@ struct pipe_inode_info {
 	struct fasync_struct *fasync_writers;
 	struct inode *inode;
 	struct pipe_buffer *bufs;
+	unsigned int wake_bytes;
+	unsigned int wake_usecs;
+	struct hrtimer wake_timer;
 };
 
 /*
@@ -0,0 +1,21 @@
+/*
+ * include/linux/platform_data/uio_dma_streaming.h
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as published by
+ * the Free Software Foundation.
+ */
+#ifndef _UIO_DMA_STREAMING_H
+#define _UIO_DMA_STREAMING_H
+
+#include <linux/uio_driver.h>
+
+struct uio_dma_streaming_pdata {
+	struct uio_info uioinfo;
+	unsigned int num_bufs;
+	unsigned int buf_size;		/* bytes, multiple of PAGE_SIZE */
+	phys_addr_t ring_base;		/* boot-time carveout, 0 = allocate */
+	bool ring_preserve;		/* keep carveout contents across boots */
+};
+
+#endif /* _UIO_DMA_STREAMING_H */
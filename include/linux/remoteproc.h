@@ -42,6 +42,8 @@
 #include <linux/completion.h>
 #include <linux/idr.h>
 
+struct firmware;
+
 /**
  * struct resource_table - firmware resource table header
  * @ver: version number
@@ -402,6 +404,12 @@ enum rproc_crash_type {
  * @crash_comp: completion used to sync crash handler and the rproc reload
  * @recovery_disabled: flag that state if recovery was disabled
  * @max_notifyid: largest allocated notify id.
+ * @fw_pinned: platform wants the firmware and carveouts kept resident
+ * across a stop/start cycle, for fast restarts
+ * @image_resident: the loaded image survived the last shutdown in its
+ * pinned carveouts, so clean sections need not be reloaded
+ * @cached_fw: pinned firmware image, reused on restart
+ * @pinned_carveouts: carveouts kept allocated across a stop/start cycle
  */
 struct rproc {
 	struct klist_node node;
@@ -430,6 +438,10 @@ struct rproc {
 	struct completion crash_comp;
 	bool recovery_disabled;
 	int max_notifyid;
+	bool fw_pinned;
+	bool image_resident;
+	const struct firmware *cached_fw;
+	struct list_head pinned_carveouts;
 };
 
 /* we currently support only two vrings per rvdev */
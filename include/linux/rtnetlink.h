@@ -17,6 +17,11 @@ extern int rtnl_put_cacheinfo(struct sk_buff *skb, struct dst_entry *dst,
 
 extern void rtmsg_ifinfo(int type, struct net_device *dev, unsigned change);
 
+#ifdef CONFIG_NET_CLS_ACT
+extern void net_inc_ingress_queue(void);
+extern void net_dec_ingress_queue(void);
+#endif
+
 /* RTNL is used as a global lock for all changes to network configuration  */
 extern void rtnl_lock(void);
 extern void rtnl_unlock(void);
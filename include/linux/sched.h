@@ -8,6 +8,31 @@ struct sched_param {
 	int sched_priority;
 };
 
+/*
+ * Extended scheduling parameters, as needed by SCHED_DEADLINE.
+ *
+ * A periodic task asks the scheduler for @sched_runtime nanoseconds
+ * of execution time every @sched_period nanoseconds, each instance
+ * to be completed within @sched_deadline nanoseconds of its release
+ * (runtime <= deadline <= period; a zero period means period ==
+ * deadline). Admission control refuses parameter sets that would
+ * oversubscribe a CPU, and the bandwidth enforcement throttles any
+ * task trying to run longer than its declared runtime, so an
+ * overrunning reservation cannot steal time from the others.
+ *
+ * The padding makes the structure extensible without breaking the
+ * sched_{set,get}scheduler2()/sched_{set,get}param2() ABI.
+ */
+struct sched_param2 {
+	int sched_priority;
+	unsigned int sched_flags;
+	u64 sched_runtime;
+	u64 sched_deadline;
+	u64 sched_period;
+
+	u64 __unused[12];
+};
+
 #include <asm/param.h>	/* for HZ */
 
 #include <linux/capability.h>
@@ -1036,6 +1061,8 @@ struct sched_domain;
 #define ENQUEUE_WAKING		0
 #endif
 
+#define ENQUEUE_REPLENISH	8
+
 #define DEQUEUE_SLEEP		1
 
 struct sched_class {
@@ -1188,6 +1215,46 @@ struct sched_rt_entity {
 #endif
 };
 
+struct sched_dl_entity {
+	struct rb_node	rb_node;
+
+	/*
+	 * Original scheduling parameters. Copied here from sched_param2
+	 * during sched_setscheduler2(), they will remain the same until
+	 * the next sched_setscheduler2() call.
+	 */
+	u64 dl_runtime;		/* maximum runtime for each instance	*/
+	u64 dl_deadline;	/* relative deadline of each instance	*/
+	u64 dl_period;		/* separation of two instances (period) */
+	u64 dl_bw;		/* dl_runtime / dl_period		*/
+
+	/*
+	 * Actual scheduling parameters. Initialized with the values above,
+	 * they are continously updated during task execution. Note that
+	 * the remaining runtime could be < 0 in case we are in overrun.
+	 */
+	s64 runtime;		/* remaining runtime for this instance	*/
+	u64 deadline;		/* absolute deadline for this instance	*/
+	unsigned int flags;	/* specifying the scheduler behaviour	*/
+
+	/*
+	 * @dl_throttled tells if we exhausted the runtime. If so, the
+	 * task has to wait for a replenishment to be performed at the
+	 * next firing of dl_timer.
+	 *
+	 * @dl_new tells if a new instance arrived. If so we must
+	 * start executing it with full runtime and set its absolute
+	 * deadline.
+	 */
+	int dl_throttled, dl_new;
+
+	/*
+	 * Bandwidth enforcement timer. Each -deadline task has its
+	 * own bandwidth to be enforced, thus we need one timer per task.
+	 */
+	struct hrtimer dl_timer;
+};
+
 
 struct rcu_node;
 
@@ -1216,6 +1283,7 @@ struct task_struct {
 	const struct sched_class *sched_class;
 	struct sched_entity se;
 	struct sched_rt_entity rt;
+	struct sched_dl_entity dl;
 #ifdef CONFIG_CGROUP_SCHED
 	struct task_group *sched_task_group;
 #endif
@@ -2053,6 +2121,8 @@ extern int sched_setscheduler(struct task_struct *, int,
 			      const struct sched_param *);
 extern int sched_setscheduler_nocheck(struct task_struct *, int,
 				      const struct sched_param *);
+extern int sched_setscheduler2(struct task_struct *, int,
+			       const struct sched_param2 *);
 extern struct task_struct *idle_task(int cpu);
 /**
  * is_idle_task - is the specified task an idle task?
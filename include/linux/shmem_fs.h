@@ -9,10 +9,13 @@
 
 /* inode in-kernel data */
 
+struct shmem_contig;
+
 struct shmem_inode_info {
 	spinlock_t		lock;
 	unsigned long		flags;
 	unsigned long		alloced;	/* data pages alloced to file */
+	struct shmem_contig	*contig;	/* stash of split high-order block */
 	union {
 		unsigned long	swapped;	/* subtotal assigned to swap */
 		char		*symlink;	/* unswappable short symlink */
@@ -32,6 +35,7 @@ struct shmem_sb_info {
 	kuid_t uid;		    /* Mount uid for root directory */
 	kgid_t gid;		    /* Mount gid for root directory */
 	umode_t mode;		    /* Mount mode for root directory */
+	unsigned int contig_order;  /* carve data pages from 1<<order blocks */
 	struct mempolicy *mpol;     /* default memory policy for mappings */
 };
 
@@ -10,6 +10,8 @@
 
 /* For O_CLOEXEC and O_NONBLOCK */
 #include <linux/fcntl.h>
+#include <linux/types.h>
+#include <linux/ioctl.h>
 
 /*
  * CAREFUL: Check include/asm-generic/fcntl.h when defining
@@ -29,4 +31,26 @@
 /* Flags for timerfd_settime.  */
 #define TFD_SETTIME_FLAGS (TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET)
 
+/*
+ * Wakeup-coalescing domains.  A timerfd joined to a named domain has
+ * every expiration programmed by timerfd_settime() stretched to the
+ * next multiple of the domain period (the requested time becoming the
+ * early edge of the hrtimer slack window), so all timers in one domain
+ * wake the CPU on a shared boundary grid instead of individually.
+ * Periodic timers keep their requested interval and thus stay on the
+ * grid when the interval is a multiple of the domain period.
+ *
+ * Joining takes effect at the next timerfd_settime(); a period of 0
+ * leaves the current domain.  The first join of a name creates the
+ * domain; later joins must pass the same period or get -EBUSY.
+ */
+#define TFD_DOMAIN_NAME_LEN 32
+
+struct tfd_domain_req {
+	char name[TFD_DOMAIN_NAME_LEN];	/* NUL-terminated domain name */
+	__u64 period;			/* boundary period in ns, 0 = leave */
+};
+
+#define TFD_IOC_SET_DOMAIN	_IOW('T', 0xd0, struct tfd_domain_req)
+
 #endif /* _LINUX_TIMERFD_H */
@@ -69,6 +69,12 @@ struct udp_sock {
 	 */
 	int (*encap_rcv)(struct sock *sk, struct sk_buff *skb);
 	void (*encap_destroy)(struct sock *sk);
+	/*
+	 * For packet reception: skbs are moved here in bulk from
+	 * sk_receive_queue, so readers mostly stay off the lock the
+	 * softirq enqueue path is using.
+	 */
+	struct sk_buff_head	reader_queue ____cacheline_aligned_in_smp;
 };
 
 static inline struct udp_sock *udp_sk(const struct sock *sk)
@@ -80,6 +80,8 @@ struct uio_device;
  * @open:		open operation for this uio device
  * @release:		release operation for this uio device
  * @irqcontrol:		disable/enable irqs when 0/1 is written to /dev/uioX
+ * @ioctl:		optional device specific ioctls on /dev/uioX
+ * @splice_read:	optional splice support for /dev/uioX
  */
 struct uio_info {
 	struct uio_device	*uio_dev;
@@ -95,6 +97,11 @@ struct uio_info {
 	int (*open)(struct uio_info *info, struct inode *inode);
 	int (*release)(struct uio_info *info, struct inode *inode);
 	int (*irqcontrol)(struct uio_info *info, s32 irq_on);
+	long (*ioctl)(struct uio_info *info, unsigned int cmd,
+		      unsigned long arg);
+	ssize_t (*splice_read)(struct uio_info *info, loff_t *ppos,
+			       struct pipe_inode_info *pipe, size_t len,
+			       unsigned int flags);
 };
 
 extern int __must_check
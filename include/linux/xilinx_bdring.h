@@ -0,0 +1,81 @@
+/*
+ * Shared buffer descriptor ring library for Xilinx DMA engines.
+ *
+ *  Copyright (C) 2013 Xilinx
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ */
+#ifndef _LINUX_XILINX_BDRING_H
+#define _LINUX_XILINX_BDRING_H
+
+#include <linux/types.h>
+#include <linux/dma-mapping.h>
+
+struct device;
+
+/**
+ * struct xilinx_bdring - ring of hardware buffer descriptors
+ * @dev:	device doing DMA to/from the ring
+ * @bd_v:	ring base, CPU view
+ * @bd_p:	ring base, bus address
+ * @bd_size:	size of one descriptor in bytes
+ * @num:	number of descriptors in the ring
+ * @free:	descriptors available to xilinx_bdring_alloc()
+ * @head:	index of the next descriptor to allocate
+ * @tail:	index of the oldest outstanding descriptor
+ * @cached:	ring memory is cached and synced in batches
+ *
+ * The library owns the ring memory and the alloc/recycle accounting;
+ * the descriptor layout stays with the driver, which accesses
+ * descriptors through xilinx_bdring_bd().  With @cached rings the
+ * driver brackets its descriptor accesses with the batch sync helpers,
+ * one call per contiguous index range instead of one flush per
+ * descriptor.
+ */
+struct xilinx_bdring {
+	struct device *dev;
+	void *bd_v;
+	dma_addr_t bd_p;
+	u32 bd_size;
+	u32 num;
+	u32 free;
+	u32 head;
+	u32 tail;
+	bool cached;
+};
+
+int xilinx_bdring_create(struct xilinx_bdring *ring, struct device *dev,
+			 u32 bd_size, u32 num, bool cached);
+void xilinx_bdring_destroy(struct xilinx_bdring *ring);
+void xilinx_bdring_reset(struct xilinx_bdring *ring);
+void xilinx_bdring_link(struct xilinx_bdring *ring, u32 next_offset);
+int xilinx_bdring_alloc(struct xilinx_bdring *ring, u32 count);
+void xilinx_bdring_recycle(struct xilinx_bdring *ring, u32 count);
+void xilinx_bdring_sync_for_cpu(struct xilinx_bdring *ring, u32 first,
+				u32 count);
+void xilinx_bdring_sync_for_device(struct xilinx_bdring *ring, u32 first,
+				   u32 count);
+
+/* CPU view of descriptor @index */
+static inline void *xilinx_bdring_bd(const struct xilinx_bdring *ring,
+				     u32 index)
+{
+	return ring->bd_v + (size_t)index * ring->bd_size;
+}
+
+/* bus address of descriptor @index, for tail/current pointer registers */
+static inline dma_addr_t xilinx_bdring_bd_phys(const struct xilinx_bdring *ring,
+					       u32 index)
+{
+	return ring->bd_p + (dma_addr_t)index * ring->bd_size;
+}
+
+static inline u32 xilinx_bdring_next(const struct xilinx_bdring *ring,
+				     u32 index)
+{
+	return index + 1 < ring->num ? index + 1 : 0;
+}
+
+#endif /* _LINUX_XILINX_BDRING_H */
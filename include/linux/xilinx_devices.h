@@ -66,5 +66,11 @@ struct xusbps_usb2_platform_data {
 #define XUSBPS_USB2_PORT0_ENABLED	0x00000001
 #define XUSBPS_USB2_PORT1_ENABLED	0x00000002
 
+/*- PS GPIO Controller -*/
+
+/* Lock-free banked pin update via the maskable data registers; safe
+ * from any context, including hrtimer callbacks */
+int xgpiops_bank_write(unsigned int bank, u32 mask, u32 value);
+
 #endif /* _XILINX_DEVICE_H_ */
 #endif /* __KERNEL__ */
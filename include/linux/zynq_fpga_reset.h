@@ -0,0 +1,48 @@
+/*
+ * Per-line control of the Zynq SLCR FPGA (PL) reset register.
+ *
+ *  Copyright (C) 2013 Xilinx
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __LINUX_ZYNQ_FPGA_RESET_H_
+#define __LINUX_ZYNQ_FPGA_RESET_H_
+
+/*
+ * Reset lines are bit positions in the FPGA_RST_CTRL register. Only the
+ * lines a driver has claimed with zynq_fpga_reset_request() may be
+ * toggled, so unrelated PL partitions keep running.
+ */
+#define ZYNQ_FPGA_RST_FCLK0	0
+#define ZYNQ_FPGA_RST_FCLK1	1
+#define ZYNQ_FPGA_RST_FCLK2	2
+#define ZYNQ_FPGA_RST_FCLK3	3
+#define ZYNQ_FPGA_RST_DMA0	8
+#define ZYNQ_FPGA_RST_DMA1	9
+#define ZYNQ_FPGA_RST_DMA2	10
+#define ZYNQ_FPGA_RST_DMA3	11
+#define ZYNQ_FPGA_RST_FMSW0	12
+#define ZYNQ_FPGA_RST_FMSW1	13
+#define ZYNQ_FPGA_RST_FSSW0	16
+#define ZYNQ_FPGA_RST_FSSW1	17
+#define ZYNQ_FPGA_RST_AXDS0	20
+#define ZYNQ_FPGA_RST_AXDS1	21
+#define ZYNQ_FPGA_RST_AXDS2	22
+#define ZYNQ_FPGA_RST_AXDS3	23
+#define ZYNQ_FPGA_RST_ACP	24
+
+int zynq_fpga_reset_request(unsigned int line);
+void zynq_fpga_reset_release(unsigned int line);
+int zynq_fpga_reset_assert(unsigned int line);
+int zynq_fpga_reset_deassert(unsigned int line);
+int zynq_fpga_reset_pulse(unsigned int line);
+
+#endif
@@ -0,0 +1,30 @@
+/*
+ * Zynq on-chip memory allocation pool
+ *
+ *  Copyright (C) 2013 Xilinx
+ *
+ * This software is licensed under the terms of the GNU General Public
+ * License version 2, as published by the Free Software Foundation, and
+ * may be copied, distributed, and modified under those terms.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#ifndef __LINUX_ZYNQ_OCM_H__
+#define __LINUX_ZYNQ_OCM_H__
+
+struct gen_pool;
+
+#ifdef CONFIG_ARCH_ZYNQ
+struct gen_pool *zynq_ocm_pool_get(void);
+#else
+static inline struct gen_pool *zynq_ocm_pool_get(void)
+{
+	return NULL;
+}
+#endif
+
+#endif /* __LINUX_ZYNQ_OCM_H__ */
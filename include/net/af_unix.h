@@ -52,6 +52,8 @@ struct unix_sock {
 	struct unix_address     *addr;
 	struct path		path;
 	struct mutex		readlock;
+	/* datagrams spliced off sk_receive_queue in bulk, consumer only */
+	struct sk_buff_head	prequeue;
 	struct sock		*peer;
 	struct list_head	link;
 	atomic_long_t		inflight;
@@ -220,6 +220,41 @@ TRACE_EVENT(mm_page_alloc,
 		show_gfp_flags(__entry->gfp_flags))
 );
 
+TRACE_EVENT(mm_page_alloc_stall,
+
+	TP_PROTO(unsigned long ip, unsigned int order, gfp_t gfp_flags,
+			u64 usecs, unsigned int retries,
+			unsigned int compact_tries),
+
+	TP_ARGS(ip, order, gfp_flags, usecs, retries, compact_tries),
+
+	TP_STRUCT__entry(
+		__field(	unsigned long,	ip		)
+		__field(	unsigned int,	order		)
+		__field(	gfp_t,		gfp_flags	)
+		__field(	u64,		usecs		)
+		__field(	unsigned int,	retries		)
+		__field(	unsigned int,	compact_tries	)
+	),
+
+	TP_fast_assign(
+		__entry->ip		= ip;
+		__entry->order		= order;
+		__entry->gfp_flags	= gfp_flags;
+		__entry->usecs		= usecs;
+		__entry->retries	= retries;
+		__entry->compact_tries	= compact_tries;
+	),
+
+	TP_printk("ip=%pf order=%u usecs=%llu retries=%u compact_tries=%u gfp_flags=%s",
+		(void *)__entry->ip,
+		__entry->order,
+		__entry->usecs,
+		__entry->retries,
+		__entry->compact_tries,
+		show_gfp_flags(__entry->gfp_flags))
+);
+
 DECLARE_EVENT_CLASS(mm_page,
 
 	TP_PROTO(struct page *page, unsigned int order, int migratetype),
@@ -0,0 +1,59 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM xilinx_dma
+
+#if !defined(_TRACE_XILINX_DMA_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TRACE_XILINX_DMA_H
+
+#include <linux/tracepoint.h>
+
+/*
+ * Hot-edge events of the AXI DMA engine: one when a chain of BDs is
+ * handed to the hardware, one when a cleanup pass retires completed
+ * descriptors.  Gaps between the two are where BD-ring stalls live.
+ */
+
+TRACE_EVENT(xilinx_dma_start_transfer,
+
+	TP_PROTO(int id, int direction, u32 head_phys),
+
+	TP_ARGS(id, direction, head_phys),
+
+	TP_STRUCT__entry(
+		__field(int, id)
+		__field(int, direction)
+		__field(u32, head_phys)
+	),
+
+	TP_fast_assign(
+		__entry->id = id;
+		__entry->direction = direction;
+		__entry->head_phys = head_phys;
+	),
+
+	TP_printk("chan=%d dir=%d head=%#x",
+		  __entry->id, __entry->direction, __entry->head_phys)
+);
+
+TRACE_EVENT(xilinx_chan_desc_cleanup,
+
+	TP_PROTO(int id, unsigned int count),
+
+	TP_ARGS(id, count),
+
+	TP_STRUCT__entry(
+		__field(int, id)
+		__field(unsigned int, count)
+	),
+
+	TP_fast_assign(
+		__entry->id = id;
+		__entry->count = count;
+	),
+
+	TP_printk("chan=%d completed=%u", __entry->id, __entry->count)
+);
+
+#endif /* _TRACE_XILINX_DMA_H */
+
+/* This part must be outside protection */
+#include <trace/define_trace.h>
@@ -0,0 +1,66 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM xilinx_emacps
+
+#if !defined(_TRACE_XILINX_EMACPS_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TRACE_XILINX_EMACPS_H
+
+#include <linux/netdevice.h>
+#include <linux/tracepoint.h>
+
+/*
+ * Hot-edge events of the Zynq GEM driver, for production tracing of
+ * BD-ring stalls.  The free/index fields record the ring state at the
+ * time of the event so a flight recorder can spot starvation without
+ * extra register reads.
+ */
+
+TRACE_EVENT(xemacps_tx,
+
+	TP_PROTO(struct net_device *ndev, unsigned int len,
+		 unsigned int bd_free),
+
+	TP_ARGS(ndev, len, bd_free),
+
+	TP_STRUCT__entry(
+		__string(name, ndev->name)
+		__field(unsigned int, len)
+		__field(unsigned int, bd_free)
+	),
+
+	TP_fast_assign(
+		__assign_str(name, ndev->name);
+		__entry->len = len;
+		__entry->bd_free = bd_free;
+	),
+
+	TP_printk("dev=%s len=%u bd_free=%u",
+		  __get_str(name), __entry->len, __entry->bd_free)
+);
+
+TRACE_EVENT(xemacps_rx,
+
+	TP_PROTO(struct net_device *ndev, unsigned int len,
+		 unsigned int bd_index),
+
+	TP_ARGS(ndev, len, bd_index),
+
+	TP_STRUCT__entry(
+		__string(name, ndev->name)
+		__field(unsigned int, len)
+		__field(unsigned int, bd_index)
+	),
+
+	TP_fast_assign(
+		__assign_str(name, ndev->name);
+		__entry->len = len;
+		__entry->bd_index = bd_index;
+	),
+
+	TP_printk("dev=%s len=%u bd_index=%u",
+		  __get_str(name), __entry->len, __entry->bd_index)
+);
+
+#endif /* _TRACE_XILINX_EMACPS_H */
+
+/* This part must be outside protection */
+#include <trace/define_trace.h>
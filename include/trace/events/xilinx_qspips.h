@@ -0,0 +1,29 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM xilinx_qspips
+
+#if !defined(_TRACE_XILINX_QSPIPS_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _TRACE_XILINX_QSPIPS_H
+
+#include <linux/tracepoint.h>
+
+TRACE_EVENT(xqspips_start_transfer,
+
+	TP_PROTO(unsigned int len),
+
+	TP_ARGS(len),
+
+	TP_STRUCT__entry(
+		__field(unsigned int, len)
+	),
+
+	TP_fast_assign(
+		__entry->len = len;
+	),
+
+	TP_printk("len=%u", __entry->len)
+);
+
+#endif /* _TRACE_XILINX_QSPIPS_H */
+
+/* This part must be outside protection */
+#include <trace/define_trace.h>
@@ -27,6 +27,19 @@
 #define F_SETPIPE_SZ	(F_LINUX_SPECIFIC_BASE + 7)
 #define F_GETPIPE_SZ	(F_LINUX_SPECIFIC_BASE + 8)
 
+/*
+ * Reader-wakeup batching for pipes.  With a byte watermark set, writes
+ * defer the reader wakeup until the pipe holds at least that many
+ * bytes; the microsecond bound limits how long a sub-watermark batch
+ * may sit unannounced (0 means only the watermark, a full pipe, or the
+ * writer blocking or closing triggers a wakeup).  A watermark of 0
+ * restores wake-on-every-write.
+ */
+#define F_SETPIPE_WAKE_BYTES	(F_LINUX_SPECIFIC_BASE + 9)
+#define F_GETPIPE_WAKE_BYTES	(F_LINUX_SPECIFIC_BASE + 10)
+#define F_SETPIPE_WAKE_USECS	(F_LINUX_SPECIFIC_BASE + 11)
+#define F_GETPIPE_WAKE_USECS	(F_LINUX_SPECIFIC_BASE + 12)
+
 /*
  * Types of directory notifications that may be requested.
  */
@@ -149,4 +149,11 @@
 
 #define PR_GET_TID_ADDRESS	40
 
+/*
+ * Opt-in private futex hash for the calling process; arg2 is the number
+ * of buckets (a power of two) or 0 to go back to the global table.
+ */
+#define PR_SET_FUTEX_HASH	41
+#define PR_GET_FUTEX_HASH	42
+
 #endif /* _LINUX_PRCTL_H */
@@ -0,0 +1,64 @@
+#ifndef _UAPI_LINUX_TELEMETRY_H
+#define _UAPI_LINUX_TELEMETRY_H
+
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
+#define TELEMETRY_VERSION	1
+
+/* Upper bound on the per-task array a single snapshot may request. */
+#define TELEMETRY_MAX_TASKS	4096
+
+/* Per-CPU times in USER_HZ ticks, same units as /proc/stat. */
+struct telemetry_cpu {
+	__u64 user;
+	__u64 nice;
+	__u64 system;
+	__u64 idle;
+	__u64 iowait;
+	__u64 irq;
+	__u64 softirq;
+};
+
+/* Memory counters in kilobytes, same units as /proc/meminfo. */
+struct telemetry_mem {
+	__u64 total;
+	__u64 free;
+	__u64 buffers;
+	__u64 cached;
+	__u64 swap_total;
+	__u64 swap_free;
+};
+
+/*
+ * Per-task counters.  @pid is filled in by the caller; the remaining
+ * fields are written by the kernel.  A task that no longer exists gets
+ * @state set to (__u32)-1 and its counters zeroed.
+ */
+struct telemetry_task {
+	__s32 pid;
+	__u32 state;
+	__u64 utime;		/* USER_HZ ticks */
+	__u64 stime;		/* USER_HZ ticks */
+	__u64 vsize;		/* bytes */
+	__u64 rss;		/* pages */
+};
+
+/*
+ * Snapshot request header.  It is followed in the caller's buffer by
+ * @nr_cpu struct telemetry_cpu and then @nr_task struct telemetry_task.
+ * The caller sets @nr_cpu and @nr_task to the array capacities (which
+ * fix the buffer layout); the kernel rewrites them to the number of
+ * entries it actually filled, which is never more than the capacity.
+ */
+struct telemetry_snap {
+	__u32 version;		/* must be TELEMETRY_VERSION */
+	__u32 nr_cpu;
+	__u32 nr_task;
+	__u32 __pad;
+	struct telemetry_mem mem;
+};
+
+#define TELEMETRY_IOC_SNAP	_IOWR(0xF5, 0x01, struct telemetry_snap)
+
+#endif /* _UAPI_LINUX_TELEMETRY_H */
@@ -0,0 +1,62 @@
+/*
+ * include/uapi/linux/uio_dma_streaming.h
+ *
+ * Userspace ABI of the uio_dma_streaming driver.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as published by
+ * the Free Software Foundation.
+ */
+#ifndef _UAPI_LINUX_UIO_DMA_STREAMING_H
+#define _UAPI_LINUX_UIO_DMA_STREAMING_H
+
+#include <linux/types.h>
+#include <linux/ioctl.h>
+
+/*
+ * The ring mapping starts with one page holding this header, followed by
+ * num_bufs buffers of buf_size bytes each.  The whole mapping is cached;
+ * userspace owns cache maintenance via the sync ioctls below.
+ *
+ * The ownership flags are a convention between userspace and the device:
+ * the driver initializes every slot to UIO_DMAS_OWNER_CPU and never
+ * touches them again.  The programmable logic flips a slot to
+ * UIO_DMAS_OWNER_CPU when it has filled the buffer, so after one
+ * interrupt wakeup userspace can harvest every completed slot in one
+ * sweep; the event counter read from /dev/uioX tells it how many
+ * interrupts that wakeup coalesced.
+ *
+ * Completed slots can also be pushed zero-copy into a pipe (and from
+ * there to a file or socket) with splice(2) on /dev/uioX; the splice
+ * offset counts bytes from the start of the ring mapping, header page
+ * included.  Sync a slot for the CPU before splicing it, and do not
+ * return it to the device until the spliced data has been consumed
+ * downstream.
+ */
+struct uio_dmas_ring_hdr {
+	__u32 num_bufs;
+	__u32 buf_size;			/* bytes, multiple of the page size */
+	__u32 reserved[2];
+	__u32 flags[0];			/* one UIO_DMAS_OWNER_* per buffer */
+};
+
+#define UIO_DMAS_OWNER_CPU	0
+#define UIO_DMAS_OWNER_DEV	1
+
+/* Byte range within the ring mapping (header page included) */
+struct uio_dmas_sync {
+	__u64 offset;
+	__u64 size;
+};
+
+struct uio_dmas_layout {
+	__u64 dma_addr;			/* bus address of the ring */
+	__u32 num_bufs;
+	__u32 buf_size;
+};
+
+#define UIO_DMAS_SYNC_FOR_CPU		_IOW('U', 0xc0, struct uio_dmas_sync)
+#define UIO_DMAS_SYNC_FOR_DEVICE	_IOW('U', 0xc1, struct uio_dmas_sync)
+#define UIO_DMAS_GET_LAYOUT		_IOR('U', 0xc2, struct uio_dmas_layout)
+
+#endif /* _UAPI_LINUX_UIO_DMA_STREAMING_H */
@@ -0,0 +1,56 @@
+/*
+ * Xilinx Zynq Device Config driver ioctl interface
+ *
+ * Copyright (c) 2013 Xilinx Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version
+ * 2 of the License, or (at your option) any later version.
+ */
+#ifndef _UAPI_LINUX_XILINX_DEVCFG_H
+#define _UAPI_LINUX_XILINX_DEVCFG_H
+
+#include <linux/ioctl.h>
+#include <linux/types.h>
+
+/* Number of bitstream slots the driver can cache */
+#define XDEVCFG_MAX_SLOTS	8
+
+/**
+ * struct xdevcfg_slot - Bitstream slot registration
+ * @addr: Userspace address of the bitstream data
+ * @len: Length of the bitstream in bytes
+ * @slot: Slot index to register, 0 to XDEVCFG_MAX_SLOTS - 1
+ */
+struct xdevcfg_slot {
+	__u64 addr;
+	__u32 len;
+	__u32 slot;
+};
+
+/**
+ * struct xdevcfg_readback - In-kernel configuration readback with CRC
+ * @len: Number of bytes to read back, must be a multiple of 4
+ * @crc: CRC-32 of the readback data (IEEE polynomial, same format as
+ *	 zlib's crc32()), filled in by the driver
+ */
+struct xdevcfg_readback {
+	__u64 len;
+	__u32 crc;
+};
+
+#define XDEVCFG_IOC_MAGIC		'X'
+
+/* Copy a bitstream into a cached DMA-ready slot */
+#define XDEVCFG_IOC_REGISTER_SLOT	_IOW(XDEVCFG_IOC_MAGIC, 0, \
+						struct xdevcfg_slot)
+/* Free a previously registered slot */
+#define XDEVCFG_IOC_UNREGISTER_SLOT	_IOW(XDEVCFG_IOC_MAGIC, 1, __u32)
+/* Configure the PL from a registered slot */
+#define XDEVCFG_IOC_LOAD_SLOT		_IOW(XDEVCFG_IOC_MAGIC, 2, __u32)
+/* Read configuration back and return its CRC-32 without copying it out */
+#define XDEVCFG_IOC_READBACK_CRC	_IOWR(XDEVCFG_IOC_MAGIC, 3, \
+						struct xdevcfg_readback)
+
+#endif /* _UAPI_LINUX_XILINX_DEVCFG_H */
@@ -0,0 +1,40 @@
+/*
+ * Xilinx AXI GPIO batched change-event user interface
+ *
+ * Copyright (c) 2013 Xilinx, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ */
+
+#ifndef _UAPI__XILINX_GPIO_H__
+#define _UAPI__XILINX_GPIO_H__
+
+#include <linux/types.h>
+
+/**
+ * struct xgpio_event - one batch of input line changes
+ * @timestamp:	CLOCK_MONOTONIC time of the change interrupt, in nanoseconds
+ * @values:	state of all input lines of the channel after the change
+ * @changed:	lines that changed since the previous record
+ *
+ * A GPIO channel with a change interrupt exposes a misc device named
+ * xgpio<N>-events, where <N> is the gpiochip base of the channel.
+ * Reading it returns whole records, one per change interrupt; edges on
+ * several lines that arrive within one interrupt share a record. Reads
+ * block until a record is available unless O_NONBLOCK is set, and the
+ * device supports poll(). Only one reader may hold the device open.
+ *
+ * The records sit in a fixed-size kernel ring; if the reader falls
+ * behind, the oldest records are dropped so that @values of the newest
+ * record always reflects the current line state.
+ */
+struct xgpio_event {
+	__u64 timestamp;
+	__u32 values;
+	__u32 changed;
+};
+
+#endif /* _UAPI__XILINX_GPIO_H__ */
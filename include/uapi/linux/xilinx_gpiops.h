@@ -0,0 +1,47 @@
+/*
+ * Xilinx Zynq PS GPIO banked fast-path user interface
+ *
+ * Copyright (c) 2013 Xilinx, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2 of the License, or (at your
+ * option) any later version.
+ */
+
+#ifndef _UAPI__XILINX_GPIOPS_H__
+#define _UAPI__XILINX_GPIOPS_H__
+
+#include <linux/ioctl.h>
+#include <linux/types.h>
+
+#define XGPIOPS_NR_BANKS	4
+
+/**
+ * struct xgpiops_bank_update - one banked mask/value update
+ * @bank:	bank number, 0 to XGPIOPS_NR_BANKS - 1
+ * @mask:	pins to touch; all other pins keep their state
+ * @value:	new pin states, only bits within @mask are applied
+ */
+struct xgpiops_bank_update {
+	__u32 bank;
+	__u32 mask;
+	__u32 value;
+};
+
+#define XGPIOPS_IOC_MAGIC	'G'
+
+#define XGPIOPS_IOC_BANK_WRITE	_IOW(XGPIOPS_IOC_MAGIC, 0, \
+					struct xgpiops_bank_update)
+
+/*
+ * mmap() of the device maps the controller register page uncached.
+ * Offset 0x0 holds the MASK_DATA_0_LSW register of bank 0, with the
+ * other maskable data registers following at 4-byte strides (MSW of a
+ * bank after its LSW, banks at 8-byte strides). Each 32-bit store of
+ * {~mask << 16 | data} updates up to 16 pins of a bank atomically
+ * without a system call. The mapping exposes the whole register page,
+ * so it requires CAP_SYS_RAWIO.
+ */
+
+#endif /* _UAPI__XILINX_GPIOPS_H__ */
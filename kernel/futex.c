@@ -58,6 +58,8 @@
 #include <linux/export.h>
 #include <linux/magic.h>
 #include <linux/pid.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
 #include <linux/nsproxy.h>
 #include <linux/ptrace.h>
 #include <linux/sched/rt.h>
@@ -151,6 +153,24 @@ struct futex_hash_bucket {
 
 static struct futex_hash_bucket futex_queues[1<<FUTEX_HASHBITS];
 
+#ifdef CONFIG_DEBUG_FS
+static atomic_long_t futex_stat_waits;
+static atomic_long_t futex_stat_wakes;
+
+static inline void futex_stat_wait(void)
+{
+	atomic_long_inc(&futex_stat_waits);
+}
+
+static inline void futex_stat_wake(void)
+{
+	atomic_long_inc(&futex_stat_wakes);
+}
+#else
+static inline void futex_stat_wait(void) { }
+static inline void futex_stat_wake(void) { }
+#endif
+
 /*
  * We hash on the keys returned from get_futex_key (see below).
  */
@@ -159,9 +179,86 @@ static struct futex_hash_bucket *hash_futex(union futex_key *key)
 	u32 hash = jhash2((u32*)&key->both.word,
 			  (sizeof(key->both.word)+sizeof(key->both.ptr))/4,
 			  key->both.offset);
+
+	/*
+	 * Process-private futexes can only ever be keyed by tasks sharing
+	 * the mm, so hashing them in an opt-in per-mm table (installed
+	 * with PR_SET_FUTEX_HASH) is consistent between the wait and wake
+	 * sides and keeps unrelated processes out of our bucket chains.
+	 */
+	if (!(key->both.offset & (FUT_OFF_INODE|FUT_OFF_MMSHARED)) &&
+	    key->private.mm && key->private.mm->futex_hash)
+		return &key->private.mm->futex_hash[hash &
+					key->private.mm->futex_hash_mask];
+
 	return &futex_queues[hash & ((1 << FUTEX_HASHBITS)-1)];
 }
 
+#define FUTEX_PRIVATE_HASH_MAX	4096UL
+
+static void futex_hash_table_init(struct futex_hash_bucket *table,
+				  unsigned long slots)
+{
+	unsigned long i;
+
+	for (i = 0; i < slots; i++) {
+		plist_head_init(&table[i].chain);
+		spin_lock_init(&table[i].lock);
+	}
+}
+
+/**
+ * futex_set_private_hash() - install a private futex hash for current->mm
+ * @slots:	number of hash buckets, a power of two, or 0 to go back to
+ *		the global table
+ *
+ * The table may only be changed while no other user of the mm exists:
+ * with a single user there can be no waiters queued under keys of this
+ * mm, so the old table is guaranteed empty and can be freed without a
+ * transition scheme.  Callers that already spawned threads get -EBUSY;
+ * install the table first.
+ */
+long futex_set_private_hash(unsigned long slots)
+{
+	struct mm_struct *mm = current->mm;
+	struct futex_hash_bucket *table = NULL;
+
+	if (slots > FUTEX_PRIVATE_HASH_MAX || (slots & (slots - 1)))
+		return -EINVAL;
+
+	if (slots) {
+		table = kcalloc(slots, sizeof(*table), GFP_KERNEL);
+		if (!table)
+			return -ENOMEM;
+		futex_hash_table_init(table, slots);
+	}
+
+	if (atomic_read(&mm->mm_users) > 1) {
+		kfree(table);
+		return -EBUSY;
+	}
+
+	kfree(mm->futex_hash);
+	mm->futex_hash_mask = slots ? slots - 1 : 0;
+	mm->futex_hash = table;
+
+	return 0;
+}
+
+long futex_get_private_hash(void)
+{
+	struct mm_struct *mm = current->mm;
+
+	return mm->futex_hash ? (long)mm->futex_hash_mask + 1 : 0;
+}
+
+/* Called when the last reference to the mm is dropped */
+void futex_mm_free(struct mm_struct *mm)
+{
+	kfree(mm->futex_hash);
+	mm->futex_hash = NULL;
+}
+
 /*
  * Return 1 if two futex_keys are equal, 0 otherwise.
  */
@@ -848,6 +945,8 @@ static void wake_futex(struct futex_q *q)
 	if (WARN(q->pi_state || q->rt_waiter, "refusing to wake PI futex\n"))
 		return;
 
+	futex_stat_wake();
+
 	/*
 	 * We set q->lock_ptr = NULL _before_ we wake up the task. If
 	 * a non-futex wake up happens on another CPU then the task
@@ -1527,6 +1626,7 @@ static inline void queue_me(struct futex_q *q, struct futex_hash_bucket *hb)
 	plist_node_init(&q->list, prio);
 	plist_add(&q->list, &hb->chain);
 	q->task = current;
+	futex_stat_wait();
 	spin_unlock(&hb->lock);
 }
 
@@ -2728,6 +2828,73 @@ SYSCALL_DEFINE6(futex, u32 __user *, uaddr, int, op, u32, val,
 	return do_futex(uaddr, op, val, tp, uaddr2, val2, val3);
 }
 
+#ifdef CONFIG_DEBUG_FS
+static void futex_hash_stats_table(struct seq_file *m, const char *name,
+				   struct futex_hash_bucket *table,
+				   unsigned long slots)
+{
+	unsigned long i, used = 0, waiters = 0, max_chain = 0;
+
+	for (i = 0; i < slots; i++) {
+		struct futex_hash_bucket *hb = &table[i];
+		struct plist_node *node;
+		unsigned long chain = 0;
+
+		spin_lock(&hb->lock);
+		plist_for_each(node, &hb->chain)
+			chain++;
+		spin_unlock(&hb->lock);
+
+		if (!chain)
+			continue;
+		used++;
+		waiters += chain;
+		if (chain > max_chain)
+			max_chain = chain;
+	}
+
+	seq_printf(m, "%s: slots %lu used %lu waiters %lu max_chain %lu\n",
+		   name, slots, used, waiters, max_chain);
+}
+
+static int futex_hash_stats_show(struct seq_file *m, void *v)
+{
+	seq_printf(m, "waits %ld\nwakes %ld\n",
+		   atomic_long_read(&futex_stat_waits),
+		   atomic_long_read(&futex_stat_wakes));
+
+	futex_hash_stats_table(m, "global", futex_queues,
+			       1UL << FUTEX_HASHBITS);
+
+	/* the private table, if any, of the process reading the file */
+	if (current->mm && current->mm->futex_hash)
+		futex_hash_stats_table(m, "private", current->mm->futex_hash,
+				       (unsigned long)current->mm->futex_hash_mask + 1);
+
+	return 0;
+}
+
+static int futex_hash_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, futex_hash_stats_show, NULL);
+}
+
+static const struct file_operations futex_hash_stats_fops = {
+	.open		= futex_hash_stats_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init futex_debugfs_init(void)
+{
+	debugfs_create_file("futex_hash_stats", S_IRUGO, NULL, NULL,
+			    &futex_hash_stats_fops);
+	return 0;
+}
+late_initcall(futex_debugfs_init);
+#endif
+
 static int __init futex_init(void)
 {
 	u32 curval;
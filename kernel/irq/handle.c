@@ -126,6 +126,9 @@ static void irq_wake_thread(struct irq_desc *desc, struct irqaction *action)
 	 */
 	atomic_inc(&desc->threads_active);
 
+#ifdef CONFIG_IRQ_THREAD_LATENCY
+	action->wake_stamp = local_clock();
+#endif
 	wake_up_process(action->thread);
 }
 
@@ -134,6 +137,7 @@ handle_irq_event_percpu(struct irq_desc *desc, struct irqaction *action)
 {
 	irqreturn_t retval = IRQ_NONE;
 	unsigned int flags = 0, irq = desc->irq_data.irq;
+	u32 cycles = irq_cycles_start();
 
 	do {
 		irqreturn_t res;
@@ -172,6 +176,7 @@ handle_irq_event_percpu(struct irq_desc *desc, struct irqaction *action)
 		action = action->next;
 	} while (action);
 
+	irq_cycles_commit(desc, cycles);
 	add_interrupt_randomness(irq, flags);
 
 	if (!noirqdebug)
@@ -179,3 +179,26 @@ static inline bool irqd_has_set(struct irq_data *d, unsigned int mask)
 {
 	return d->state_use_accessors & mask;
 }
+
+/*
+ * Per-IRQ cycle accounting: charge the cycles spent in the hard
+ * handler chain to the descriptor.  Only the handling CPU writes
+ * desc->irq_cycles, so no locking is needed beyond the in-progress
+ * exclusion the core already provides.
+ */
+#ifdef CONFIG_IRQ_CYCLE_ACCOUNTING
+#include <asm/irq_cycles.h>
+
+static inline u32 irq_cycles_start(void)
+{
+	return arch_irq_cycle_count();
+}
+
+static inline void irq_cycles_commit(struct irq_desc *desc, u32 start)
+{
+	desc->irq_cycles += (u32)(arch_irq_cycle_count() - start);
+}
+#else
+static inline u32 irq_cycles_start(void) { return 0; }
+static inline void irq_cycles_commit(struct irq_desc *desc, u32 start) { }
+#endif
@@ -14,6 +14,7 @@
 #include <linux/kernel_stat.h>
 #include <linux/radix-tree.h>
 #include <linux/bitmap.h>
+#include <linux/sched/rt.h>
 
 #include "internals.h"
 
@@ -86,6 +87,7 @@ static void desc_set_defaults(unsigned int irq, struct irq_desc *desc, int node,
 	desc->depth = 1;
 	desc->irq_count = 0;
 	desc->irqs_unhandled = 0;
+	desc->thread_priority = MAX_USER_RT_PRIO/2;
 	desc->name = NULL;
 	desc->owner = owner;
 	for_each_possible_cpu(cpu)
@@ -0,0 +1,68 @@
+/*
+ * Debugfs reporting of irq thread wakeup latency histograms.
+ *
+ * The histograms are filled in by the irq thread code in manage.c;
+ * this file only presents them. One line per irq with a threaded
+ * handler, one column per log2(usecs) bucket.
+ */
+#include <linux/irq.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/interrupt.h>
+#include <linux/kernel_stat.h>
+
+#include "internals.h"
+
+static int irq_latency_show(struct seq_file *m, void *v)
+{
+	struct irq_desc *desc;
+	unsigned long flags;
+	int irq, i;
+
+	seq_printf(m, "# wakeup-to-run latency, bucket i counts delays in [2^(i-1), 2^i) usecs\n");
+	seq_printf(m, "%4s", "irq");
+	for (i = 0; i < IRQ_LAT_BUCKETS; i++)
+		seq_printf(m, " %8dus", 1 << i);
+	seq_putc(m, '\n');
+
+	for_each_irq_desc(irq, desc) {
+		unsigned int hist[IRQ_LAT_BUCKETS];
+		unsigned long total = 0;
+
+		raw_spin_lock_irqsave(&desc->lock, flags);
+		for (i = 0; i < IRQ_LAT_BUCKETS; i++) {
+			hist[i] = desc->lat_hist[i];
+			total += hist[i];
+		}
+		raw_spin_unlock_irqrestore(&desc->lock, flags);
+
+		if (!total)
+			continue;
+
+		seq_printf(m, "%4d", irq);
+		for (i = 0; i < IRQ_LAT_BUCKETS; i++)
+			seq_printf(m, " %10u", hist[i]);
+		seq_putc(m, '\n');
+	}
+	return 0;
+}
+
+static int irq_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, irq_latency_show, NULL);
+}
+
+static const struct file_operations irq_latency_fops = {
+	.open		= irq_latency_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init irq_latency_debugfs_init(void)
+{
+	debugfs_create_file("irq_thread_latency", 0444, NULL, NULL,
+			    &irq_latency_fops);
+	return 0;
+}
+__initcall(irq_latency_debugfs_init);
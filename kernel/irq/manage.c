@@ -540,6 +540,54 @@ int irq_set_irq_wake(unsigned int irq, unsigned int on)
 }
 EXPORT_SYMBOL(irq_set_irq_wake);
 
+/**
+ *	irq_set_priority - set the hardware arbitration priority of an irq
+ *	@irq:	interrupt to control
+ *	@prio:	chip specific priority value, lower means more urgent
+ *
+ *	Program the interrupt controller's per-interrupt priority, on
+ *	controllers that arbitrate between pending interrupts (e.g. the
+ *	ARM GIC).  The value range and its meaning are chip specific;
+ *	returns -ENOSYS when the chip does not support priorities.
+ */
+int irq_set_priority(unsigned int irq, unsigned int prio)
+{
+	unsigned long flags;
+	struct irq_desc *desc = irq_get_desc_buslock(irq, &flags, 0);
+	int ret = -ENOSYS;
+
+	if (!desc)
+		return -EINVAL;
+	if (desc->irq_data.chip->irq_set_priority)
+		ret = desc->irq_data.chip->irq_set_priority(&desc->irq_data,
+							    prio);
+	irq_put_desc_busunlock(desc, flags);
+	return ret;
+}
+EXPORT_SYMBOL_GPL(irq_set_priority);
+
+/**
+ *	irq_get_priority - read back the hardware priority of an irq
+ *	@irq:	interrupt to query
+ *
+ *	Returns the chip specific priority value, or a negative error
+ *	code when the chip does not support priorities.
+ */
+int irq_get_priority(unsigned int irq)
+{
+	unsigned long flags;
+	struct irq_desc *desc = irq_get_desc_buslock(irq, &flags, 0);
+	int ret = -ENOSYS;
+
+	if (!desc)
+		return -EINVAL;
+	if (desc->irq_data.chip->irq_get_priority)
+		ret = desc->irq_data.chip->irq_get_priority(&desc->irq_data);
+	irq_put_desc_busunlock(desc, flags);
+	return ret;
+}
+EXPORT_SYMBOL_GPL(irq_get_priority);
+
 /*
  * Internal function that tells the architecture code whether a
  * particular irq has been exclusively allocated or is available
@@ -834,17 +882,40 @@ static void irq_thread_dtor(struct callback_head *unused)
 	irq_finalize_oneshot(desc, action);
 }
 
+#ifdef CONFIG_IRQ_THREAD_LATENCY
+/*
+ * Account the delay between the hard irq handler waking the thread and
+ * the thread starting to run, in a log2(usecs) histogram. The increment
+ * is racy on shared irqs, but this is statistics only and not worth a
+ * lock in the handler path.
+ */
+static void irq_note_thread_latency(struct irq_desc *desc,
+				    struct irqaction *action)
+{
+	u64 delta = local_clock() - action->wake_stamp;
+	unsigned int us = delta >> 10;
+	unsigned int bucket = us ? fls(us) : 0;
+
+	if (bucket >= IRQ_LAT_BUCKETS)
+		bucket = IRQ_LAT_BUCKETS - 1;
+	desc->lat_hist[bucket]++;
+}
+#else
+static inline void irq_note_thread_latency(struct irq_desc *desc,
+					   struct irqaction *action) { }
+#endif
+
 /*
  * Interrupt handler thread
  */
 static int irq_thread(void *data)
 {
 	struct callback_head on_exit_work;
-	static const struct sched_param param = {
-		.sched_priority = MAX_USER_RT_PRIO/2,
-	};
 	struct irqaction *action = data;
 	struct irq_desc *desc = irq_to_desc(action->irq);
+	struct sched_param param = {
+		.sched_priority = desc->thread_priority,
+	};
 	irqreturn_t (*handler_fn)(struct irq_desc *desc,
 			struct irqaction *action);
 
@@ -864,6 +935,7 @@ static int irq_thread(void *data)
 	while (!irq_wait_for_interrupt(action)) {
 		irqreturn_t action_ret;
 
+		irq_note_thread_latency(desc, action);
 		irq_thread_check_affinity(desc, action);
 
 		action_ret = handler_fn(desc, action);
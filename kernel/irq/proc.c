@@ -12,6 +12,8 @@
 #include <linux/seq_file.h>
 #include <linux/interrupt.h>
 #include <linux/kernel_stat.h>
+#include <linux/sched.h>
+#include <linux/sched/rt.h>
 
 #include "internals.h"
 
@@ -244,6 +246,103 @@ static const struct file_operations irq_node_proc_fops = {
 };
 #endif
 
+static int irq_priority_proc_show(struct seq_file *m, void *v)
+{
+	int prio = irq_get_priority((long)m->private);
+
+	if (prio < 0)
+		return prio;
+	seq_printf(m, "%d\n", prio);
+	return 0;
+}
+
+static int irq_priority_proc_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, irq_priority_proc_show, PDE(inode)->data);
+}
+
+static ssize_t irq_priority_proc_write(struct file *file,
+		const char __user *buffer, size_t count, loff_t *pos)
+{
+	unsigned int irq = (int)(long)PDE(file_inode(file))->data;
+	unsigned int prio;
+	int err;
+
+	err = kstrtouint_from_user(buffer, count, 0, &prio);
+	if (err)
+		return err;
+
+	err = irq_set_priority(irq, prio);
+	if (err)
+		return err;
+	return count;
+}
+
+static const struct file_operations irq_priority_proc_fops = {
+	.open		= irq_priority_proc_open,
+	.read		= seq_read,
+	.write		= irq_priority_proc_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int irq_thread_prio_proc_show(struct seq_file *m, void *v)
+{
+	struct irq_desc *desc = irq_to_desc((long)m->private);
+
+	seq_printf(m, "%u\n", desc->thread_priority);
+	return 0;
+}
+
+static int irq_thread_prio_proc_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, irq_thread_prio_proc_show, PDE(inode)->data);
+}
+
+static ssize_t irq_thread_prio_proc_write(struct file *file,
+		const char __user *buffer, size_t count, loff_t *pos)
+{
+	unsigned int irq = (int)(long)PDE(file_inode(file))->data;
+	struct irq_desc *desc = irq_to_desc(irq);
+	struct irqaction *action;
+	struct sched_param param;
+	unsigned long flags;
+	unsigned int prio;
+	int err;
+
+	err = kstrtouint_from_user(buffer, count, 0, &prio);
+	if (err)
+		return err;
+
+	if (prio < 1 || prio >= MAX_USER_RT_PRIO)
+		return -EINVAL;
+
+	/*
+	 * Update the descriptor and all existing handler threads under
+	 * desc->lock, so that the threads of a shared irq never run at
+	 * mixed priorities. Threads created later pick the new value up
+	 * from desc->thread_priority.
+	 */
+	param.sched_priority = prio;
+	raw_spin_lock_irqsave(&desc->lock, flags);
+	desc->thread_priority = prio;
+	for (action = desc->action; action; action = action->next) {
+		if (action->thread)
+			sched_setscheduler_nocheck(action->thread, SCHED_FIFO,
+						   &param);
+	}
+	raw_spin_unlock_irqrestore(&desc->lock, flags);
+	return count;
+}
+
+static const struct file_operations irq_thread_prio_proc_fops = {
+	.open		= irq_thread_prio_proc_open,
+	.read		= seq_read,
+	.write		= irq_thread_prio_proc_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
 static int irq_spurious_proc_show(struct seq_file *m, void *v)
 {
 	struct irq_desc *desc = irq_to_desc((long) m->private);
@@ -266,6 +365,52 @@ static const struct file_operations irq_spurious_proc_fops = {
 	.release	= single_release,
 };
 
+#ifdef CONFIG_IRQ_CYCLE_ACCOUNTING
+static int irq_cycles_proc_show(struct seq_file *m, void *v)
+{
+	struct irq_desc *desc;
+	unsigned long flags;
+	int irq;
+
+	for_each_irq_desc(irq, desc) {
+		struct irqaction *action;
+		u64 cycles;
+
+		raw_spin_lock_irqsave(&desc->lock, flags);
+		cycles = desc->irq_cycles;
+		if (!cycles || !desc->action) {
+			raw_spin_unlock_irqrestore(&desc->lock, flags);
+			continue;
+		}
+		seq_printf(m, "%3d: %20llu", irq, (unsigned long long)cycles);
+		for (action = desc->action; action; action = action->next)
+			seq_printf(m, "  %s", action->name);
+		raw_spin_unlock_irqrestore(&desc->lock, flags);
+		seq_putc(m, '\n');
+	}
+	return 0;
+}
+
+static int irq_cycles_proc_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, irq_cycles_proc_show, NULL);
+}
+
+static const struct file_operations irq_cycles_proc_fops = {
+	.open		= irq_cycles_proc_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static void register_irq_cycles_proc(void)
+{
+	proc_create("irq_cycles", 0444, NULL, &irq_cycles_proc_fops);
+}
+#else
+static inline void register_irq_cycles_proc(void) { }
+#endif
+
 #define MAX_NAMELEN 128
 
 static int name_unique(unsigned int irq, struct irqaction *new_action)
@@ -341,6 +486,15 @@ void register_irq_proc(unsigned int irq, struct irq_desc *desc)
 
 	proc_create_data("spurious", 0444, desc->dir,
 			 &irq_spurious_proc_fops, (void *)(long)irq);
+
+	/* create /proc/irq/<irq>/thread_priority */
+	proc_create_data("thread_priority", 0600, desc->dir,
+			 &irq_thread_prio_proc_fops, (void *)(long)irq);
+
+	/* create /proc/irq/<irq>/priority for chips with priority support */
+	if (desc->irq_data.chip && desc->irq_data.chip->irq_set_priority)
+		proc_create_data("priority", 0600, desc->dir,
+				 &irq_priority_proc_fops, (void *)(long)irq);
 }
 
 void unregister_irq_proc(unsigned int irq, struct irq_desc *desc)
@@ -356,6 +510,9 @@ void unregister_irq_proc(unsigned int irq, struct irq_desc *desc)
 	remove_proc_entry("node", desc->dir);
 #endif
 	remove_proc_entry("spurious", desc->dir);
+	remove_proc_entry("thread_priority", desc->dir);
+	if (desc->irq_data.chip && desc->irq_data.chip->irq_set_priority)
+		remove_proc_entry("priority", desc->dir);
 
 	memset(name, 0, MAX_NAMELEN);
 	sprintf(name, "%u", irq);
@@ -392,6 +549,7 @@ void init_irq_proc(void)
 		return;
 
 	register_default_affinity_proc();
+	register_irq_cycles_proc();
 
 	/*
 	 * Create entries for all existing IRQs.
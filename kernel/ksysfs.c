@@ -140,7 +140,7 @@ static ssize_t fscaps_show(struct kobject *kobj,
 }
 KERNEL_ATTR_RO(fscaps);
 
-int rcu_expedited;
+int rcu_expedited = IS_ENABLED(CONFIG_RCU_EXPEDITED_DEFAULT);
 static ssize_t rcu_expedited_show(struct kobject *kobj,
 				  struct kobj_attribute *attr, char *buf)
 {
@@ -179,6 +179,11 @@ struct load_info {
 	struct _ddebug *debug;
 	unsigned int num_debug;
 	bool sig_ok;
+	/* Exporting modules this load already took a reference on; lets
+	 * later symbols from the same exporter resolve without taking
+	 * module_mutex again.  Private to the loading task. */
+	struct module *ref_cache[16];
+	unsigned int ref_cache_n;
 	struct {
 		unsigned int sym, str, mod, vers, info, pcpu;
 	} index;
@@ -1251,9 +1256,21 @@ static inline int same_magic(const char *amagic, const char *bmagic,
 }
 #endif /* CONFIG_MODVERSIONS */
 
+/* Did this load already take a reference on @owner? */
+static bool resolve_ref_cached(const struct load_info *info,
+			       const struct module *owner)
+{
+	unsigned int i;
+
+	for (i = 0; i < info->ref_cache_n; i++)
+		if (info->ref_cache[i] == owner)
+			return true;
+	return false;
+}
+
 /* Resolve a symbol for this module.  I.e. if we find one, record usage. */
 static const struct kernel_symbol *resolve_symbol(struct module *mod,
-						  const struct load_info *info,
+						  struct load_info *info,
 						  const char *name,
 						  char ownername[])
 {
@@ -1262,6 +1279,29 @@ static const struct kernel_symbol *resolve_symbol(struct module *mod,
 	const unsigned long *crc;
 	int err;
 
+	/*
+	 * The common case needs no locking: symbols exported by the
+	 * kernel proper cannot go away, and an exporting module this
+	 * load has already recorded a use on cannot be unloaded under
+	 * us either.  find_symbol() only needs preemption disabled.
+	 * This keeps concurrent loads from serializing on module_mutex
+	 * for every undefined symbol.
+	 */
+	preempt_disable();
+	sym = find_symbol(name, &owner, &crc,
+			  !(mod->taints & (1 << TAINT_PROPRIETARY_MODULE)), true);
+	if (sym && (owner == NULL || resolve_ref_cached(info, owner))) {
+		if (!check_version(info->sechdrs, info->index.vers, name, mod,
+				   crc, owner))
+			sym = ERR_PTR(-EINVAL);
+		else
+			strncpy(ownername, module_name(owner),
+				MODULE_NAME_LEN);
+		preempt_enable();
+		return sym;
+	}
+	preempt_enable();
+
 	mutex_lock(&module_mutex);
 	sym = find_symbol(name, &owner, &crc,
 			  !(mod->taints & (1 << TAINT_PROPRIETARY_MODULE)), true);
@@ -1280,6 +1320,11 @@ static const struct kernel_symbol *resolve_symbol(struct module *mod,
 		goto getname;
 	}
 
+	/* Remember the exporter: our use ref pins it, so further symbols
+	 * from it can be resolved on the lockless path above. */
+	if (owner && info->ref_cache_n < ARRAY_SIZE(info->ref_cache))
+		info->ref_cache[info->ref_cache_n++] = owner;
+
 getname:
 	/* We must make copy under the lock if we failed to get ref. */
 	strncpy(ownername, module_name(owner), MODULE_NAME_LEN);
@@ -1290,7 +1335,7 @@ unlock:
 
 static const struct kernel_symbol *
 resolve_symbol_wait(struct module *mod,
-		    const struct load_info *info,
+		    struct load_info *info,
 		    const char *name)
 {
 	const struct kernel_symbol *ksym;
@@ -1951,7 +1996,7 @@ static int verify_export_symbols(struct module *mod)
 }
 
 /* Change all symbols so that st_value encodes the pointer directly. */
-static int simplify_symbols(struct module *mod, const struct load_info *info)
+static int simplify_symbols(struct module *mod, struct load_info *info)
 {
 	Elf_Shdr *symsec = &info->sechdrs[info->index.sym];
 	Elf_Sym *sym = (void *)symsec->sh_addr;
@@ -2419,23 +2419,48 @@ late_initcall(printk_late_init);
 
 #if defined CONFIG_PRINTK
 /*
- * Delayed printk version, for scheduler-internal messages:
+ * Deferred printk, for callers which cannot afford logbuf_lock: the
+ * message is formatted into a per-CPU staging buffer with interrupts
+ * briefly disabled and fed into the log later from irq_work context,
+ * where extending the lock hold time does not hurt anyone.  Records
+ * are stored back to back as NUL terminated strings; a record that
+ * does not fit is counted and reported when the buffer drains.
  */
-#define PRINTK_BUF_SIZE		512
+#define PRINTK_STAGE_SIZE	4096
 
 #define PRINTK_PENDING_WAKEUP	0x01
-#define PRINTK_PENDING_SCHED	0x02
+#define PRINTK_PENDING_OUTPUT	0x02
+
+struct printk_stage {
+	unsigned int len;
+	unsigned int dropped;
+	char buf[PRINTK_STAGE_SIZE];
+};
 
 static DEFINE_PER_CPU(int, printk_pending);
-static DEFINE_PER_CPU(char [PRINTK_BUF_SIZE], printk_sched_buf);
+static DEFINE_PER_CPU(struct printk_stage, printk_stage);
 
 static void wake_up_klogd_work_func(struct irq_work *irq_work)
 {
 	int pending = __this_cpu_xchg(printk_pending, 0);
 
-	if (pending & PRINTK_PENDING_SCHED) {
-		char *buf = __get_cpu_var(printk_sched_buf);
-		printk(KERN_WARNING "[sched_delayed] %s", buf);
+	if (pending & PRINTK_PENDING_OUTPUT) {
+		struct printk_stage *stage = &__get_cpu_var(printk_stage);
+		unsigned int pos = 0;
+
+		/*
+		 * irq_work runs with interrupts disabled, so no new
+		 * record can be staged on this CPU underneath us.
+		 */
+		while (pos < stage->len) {
+			printk("%s", stage->buf + pos);
+			pos += strlen(stage->buf + pos) + 1;
+		}
+		if (stage->dropped)
+			printk(KERN_WARNING "printk_deferred: %u messages dropped\n",
+			       stage->dropped);
+		stage->len = 0;
+		stage->dropped = 0;
 	}
 
 	if (pending & PRINTK_PENDING_WAKEUP)
@@ -2457,26 +2482,34 @@ void wake_up_klogd(void)
 	preempt_enable();
 }
 
-int printk_sched(const char *fmt, ...)
+int printk_deferred(const char *fmt, ...)
 {
+	struct printk_stage *stage;
 	unsigned long flags;
+	unsigned int avail;
 	va_list args;
-	char *buf;
-	int r;
+	int r = 0;
 
 	local_irq_save(flags);
-	buf = __get_cpu_var(printk_sched_buf);
+	stage = &__get_cpu_var(printk_stage);
 
-	va_start(args, fmt);
-	r = vsnprintf(buf, PRINTK_BUF_SIZE, fmt, args);
-	va_end(args);
+	avail = PRINTK_STAGE_SIZE - stage->len;
+	if (likely(avail > 1)) {
+		va_start(args, fmt);
+		r = vscnprintf(stage->buf + stage->len, avail, fmt, args);
+		va_end(args);
+		stage->len += r + 1;	/* keep the terminating NUL */
+	} else {
+		stage->dropped++;
+	}
 
-	__this_cpu_or(printk_pending, PRINTK_PENDING_SCHED);
+	__this_cpu_or(printk_pending, PRINTK_PENDING_OUTPUT);
 	irq_work_queue(&__get_cpu_var(wake_up_klogd_work));
 	local_irq_restore(flags);
 
 	return r;
 }
+EXPORT_SYMBOL(printk_deferred);
 
 /*
  * printk rate limiting, lifted from the networking subsystem.
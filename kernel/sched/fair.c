@@ -3170,6 +3170,23 @@ static int wake_affine(struct sched_domain *sd, struct task_struct *p, int sync)
 	return 0;
 }
 
+/*
+ * Wakeups issued from interrupt context pull the woken task towards the
+ * CPU handling the interrupt: the data the task is being woken for (DMA
+ * descriptors, fresh skbs pushed up by NAPI) is hot in this CPU's
+ * caches, and following the interrupt beats following the task's stale
+ * footprint on its previous CPU.  Only do so while this CPU is not
+ * saturated - at most the current task is running - so a busy CPU does
+ * not turn into a dumping ground for every device consumer.
+ */
+static int wake_irq_affine(int cpu)
+{
+	if (!in_interrupt())
+		return 0;
+
+	return cpu_rq(cpu)->nr_running <= 1;
+}
+
 /*
  * find_idlest_group finds and returns the least busy CPU group within the
  * domain.
@@ -3342,6 +3359,15 @@ select_task_rq_fair(struct task_struct *p, int sd_flag, int wake_flags)
 	}
 
 	if (affine_sd) {
+		/*
+		 * Interrupt wakeups stay put on the interrupt's CPU; an
+		 * idle sibling has none of the just-DMAed data cached.
+		 */
+		if (cpu != prev_cpu && wake_irq_affine(cpu)) {
+			new_cpu = cpu;
+			goto unlock;
+		}
+
 		if (cpu != prev_cpu && wake_affine(affine_sd, p, sync))
 			prev_cpu = cpu;
 
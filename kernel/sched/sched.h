@@ -2,6 +2,7 @@
 #include <linux/sched.h>
 #include <linux/sched/sysctl.h>
 #include <linux/sched/rt.h>
+#include <linux/sched/deadline.h>
 #include <linux/mutex.h>
 #include <linux/spinlock.h>
 #include <linux/stop_machine.h>
@@ -57,6 +58,28 @@ static inline int task_has_rt_policy(struct task_struct *p)
 	return rt_policy(p->policy);
 }
 
+static inline int dl_policy(int policy)
+{
+	return policy == SCHED_DEADLINE;
+}
+
+static inline int task_has_dl_policy(struct task_struct *p)
+{
+	return dl_policy(p->policy);
+}
+
+static inline int dl_time_before(u64 a, u64 b)
+{
+	return (s64)(a - b) < 0;
+}
+
+/*
+ * Resolution of the bandwidth ratios used by the -deadline admission
+ * control and by dl_entity_overflow().
+ */
+#define DL_SCALE	(10)
+#define BW_SHIFT	20
+
 /*
  * This is the priority-queue data structure of the RT scheduling class:
  */
@@ -324,6 +347,23 @@ struct rt_rq {
 #endif
 };
 
+/* Deadline class' related fields in a runqueue */
+struct dl_rq {
+	/* runqueue is an rbtree, ordered by deadline */
+	struct rb_root rb_root;
+	struct rb_node *rb_leftmost;
+
+	unsigned long dl_nr_running;
+
+	/*
+	 * Bandwidth admitted on this CPU, in (runtime << BW_SHIFT) /
+	 * period units. -deadline tasks are pinned to one CPU, so the
+	 * admission test is purely local: total_bw may not exceed the
+	 * global RT bandwidth ratio.
+	 */
+	u64 total_bw;
+};
+
 #ifdef CONFIG_SMP
 
 /*
@@ -385,6 +425,7 @@ struct rq {
 
 	struct cfs_rq cfs;
 	struct rt_rq rt;
+	struct dl_rq dl;
 
 #ifdef CONFIG_FAIR_GROUP_SCHED
 	/* list of leaf cfs_rq on this cpu: */
@@ -870,6 +911,7 @@ enum cpuacct_stat_index {
    for (class = sched_class_highest; class; class = class->next)
 
 extern const struct sched_class stop_sched_class;
+extern const struct sched_class dl_sched_class;
 extern const struct sched_class rt_sched_class;
 extern const struct sched_class fair_sched_class;
 extern const struct sched_class idle_sched_class;
@@ -1180,6 +1222,9 @@ extern void print_rt_stats(struct seq_file *m, int cpu);
 
 extern void init_cfs_rq(struct cfs_rq *cfs_rq);
 extern void init_rt_rq(struct rt_rq *rt_rq, struct rq *rq);
+extern void init_dl_rq(struct dl_rq *dl_rq, struct rq *rq);
+extern void init_dl_task_timer(struct sched_dl_entity *dl_se);
+extern void dl_task_dead(struct task_struct *p);
 
 extern void account_cfs_bandwidth_used(int enabled, int was_enabled);
 
@@ -25,6 +25,7 @@
 #include <linux/smp.h>
 #include <linux/smpboot.h>
 #include <linux/tick.h>
+#include <linux/kobject.h>
 
 #define CREATE_TRACE_POINTS
 #include <trace/events/irq.h>
@@ -62,6 +63,16 @@ char *softirq_to_name[NR_SOFTIRQS] = {
 	"TASKLET", "SCHED", "HRTIMER", "RCU"
 };
 
+/*
+ * Bit n set in this cpu's softirq_thread_only means softirq n is never
+ * run from hardirq exit or local_bh_enable() here - it stays pending
+ * until ksoftirqd picks it up. ksoftirqd runs at normal thread
+ * priority, so a realtime task bound to such a CPU preempts the
+ * deferred work instead of being preempted by it. Configured through
+ * /sys/kernel/softirq/, empty by default.
+ */
+static DEFINE_PER_CPU(__u32, softirq_thread_only);
+
 /*
  * we cannot loop indefinitely here to avoid userspace starvation,
  * but we also don't want to introduce a worst case 1/HZ latency
@@ -195,23 +206,25 @@ void local_bh_enable_ip(unsigned long ip)
 EXPORT_SYMBOL(local_bh_enable_ip);
 
 /*
- * We restart softirq processing for at most 2 ms,
+ * We restart softirq processing for at most softirq_budget_usecs,
  * and if need_resched() is not set.
  *
- * These limits have been established via experimentation.
- * The two things to balance is latency against fairness -
- * we want to handle softirqs as soon as possible, but they
- * should not be able to lock up the box.
+ * The default has been established via experimentation. The two
+ * things to balance is latency against fairness - we want to handle
+ * softirqs as soon as possible, but they should not be able to lock
+ * up the box. Writable through /sys/kernel/softirq/budget_usecs for
+ * setups that need a tighter bound.
  */
-#define MAX_SOFTIRQ_TIME  msecs_to_jiffies(2)
+static unsigned int __read_mostly softirq_budget_usecs = 2000;
 
 asmlinkage void __do_softirq(void)
 {
 	struct softirq_action *h;
-	__u32 pending;
-	unsigned long end = jiffies + MAX_SOFTIRQ_TIME;
+	__u32 pending, deferred = 0;
+	u64 end = local_clock() + (u64)softirq_budget_usecs * NSEC_PER_USEC;
 	int cpu;
 	unsigned long old_flags = current->flags;
+	bool in_ksoftirqd;
 
 	/*
 	 * Mask out PF_MEMALLOC s current task context is borrowed for the
@@ -228,9 +241,13 @@ asmlinkage void __do_softirq(void)
 	lockdep_softirq_enter();
 
 	cpu = smp_processor_id();
+	in_ksoftirqd = (current == __this_cpu_read(ksoftirqd));
+	if (!in_ksoftirqd)
+		deferred = pending & __this_cpu_read(softirq_thread_only);
 restart:
-	/* Reset the pending bitmask before enabling irqs */
-	set_softirq_pending(0);
+	/* Leave thread-only vectors pending for ksoftirqd, clear the rest */
+	set_softirq_pending(deferred);
+	pending &= ~deferred;
 
 	local_irq_enable();
 
@@ -265,7 +282,11 @@ restart:
 
 	pending = local_softirq_pending();
 	if (pending) {
-		if (time_before(jiffies, end) && !need_resched())
+		if (!in_ksoftirqd)
+			deferred = pending & __this_cpu_read(softirq_thread_only);
+
+		if ((pending & ~deferred) &&
+		    local_clock() < end && !need_resched())
 			goto restart;
 
 		wakeup_softirqd();
@@ -854,6 +875,139 @@ static __init int spawn_ksoftirqd(void)
 }
 early_initcall(spawn_ksoftirqd);
 
+#ifdef CONFIG_SYSFS
+/*
+ * Per-softirq CPU steering.
+ *
+ * /sys/kernel/softirq/<NAME> holds a cpulist of CPUs on which softirq
+ * NAME is handled only by ksoftirqd. The raising side is untouched -
+ * NET_RX and friends keep their per-cpu state and still run on the CPU
+ * that raised them - only the context they execute in changes, from
+ * hardirq exit to a schedulable thread. Combined with interrupt
+ * affinity this keeps softirq bursts from preempting a realtime task
+ * on an isolated core.
+ */
+static cpumask_var_t softirq_thread_mask[NR_SOFTIRQS];
+static DEFINE_MUTEX(softirq_steer_mutex);
+
+static ssize_t budget_usecs_show(struct kobject *kobj,
+				 struct kobj_attribute *attr, char *buf)
+{
+	return sprintf(buf, "%u\n", softirq_budget_usecs);
+}
+
+static ssize_t budget_usecs_store(struct kobject *kobj,
+				  struct kobj_attribute *attr,
+				  const char *buf, size_t count)
+{
+	unsigned int val;
+	int err;
+
+	err = kstrtouint(buf, 0, &val);
+	if (err)
+		return err;
+
+	softirq_budget_usecs = val;
+	return count;
+}
+
+static struct kobj_attribute budget_usecs_attr =
+	__ATTR(budget_usecs, 0644, budget_usecs_show, budget_usecs_store);
+
+struct softirq_steer_attr {
+	struct kobj_attribute kattr;
+	unsigned int nr;
+};
+
+static struct softirq_steer_attr softirq_steer_attrs[NR_SOFTIRQS];
+
+static ssize_t softirq_steer_show(struct kobject *kobj,
+				  struct kobj_attribute *attr, char *buf)
+{
+	struct softirq_steer_attr *sa =
+		container_of(attr, struct softirq_steer_attr, kattr);
+	int n;
+
+	mutex_lock(&softirq_steer_mutex);
+	n = cpulist_scnprintf(buf, PAGE_SIZE - 2, softirq_thread_mask[sa->nr]);
+	mutex_unlock(&softirq_steer_mutex);
+	buf[n++] = '\n';
+	buf[n] = '\0';
+	return n;
+}
+
+static ssize_t softirq_steer_store(struct kobject *kobj,
+				   struct kobj_attribute *attr,
+				   const char *buf, size_t count)
+{
+	struct softirq_steer_attr *sa =
+		container_of(attr, struct softirq_steer_attr, kattr);
+	cpumask_var_t new_mask;
+	int cpu, err;
+
+	if (!alloc_cpumask_var(&new_mask, GFP_KERNEL))
+		return -ENOMEM;
+
+	err = cpulist_parse(buf, new_mask);
+	if (err) {
+		free_cpumask_var(new_mask);
+		return err;
+	}
+
+	mutex_lock(&softirq_steer_mutex);
+	cpumask_copy(softirq_thread_mask[sa->nr], new_mask);
+	for_each_possible_cpu(cpu) {
+		__u32 bits = 0;
+		unsigned int i;
+
+		for (i = 0; i < NR_SOFTIRQS; i++)
+			if (cpumask_test_cpu(cpu, softirq_thread_mask[i]))
+				bits |= 1 << i;
+		per_cpu(softirq_thread_only, cpu) = bits;
+	}
+	mutex_unlock(&softirq_steer_mutex);
+
+	free_cpumask_var(new_mask);
+	return count;
+}
+
+static int __init softirq_sysfs_init(void)
+{
+	struct kobject *kobj;
+	unsigned int i;
+	int err;
+
+	for (i = 0; i < NR_SOFTIRQS; i++)
+		if (!zalloc_cpumask_var(&softirq_thread_mask[i], GFP_KERNEL))
+			return -ENOMEM;
+
+	kobj = kobject_create_and_add("softirq", kernel_kobj);
+	if (!kobj)
+		return -ENOMEM;
+
+	err = sysfs_create_file(kobj, &budget_usecs_attr.attr);
+	if (err)
+		return err;
+
+	for (i = 0; i < NR_SOFTIRQS; i++) {
+		struct softirq_steer_attr *sa = &softirq_steer_attrs[i];
+
+		sysfs_attr_init(&sa->kattr.attr);
+		sa->kattr.attr.name = softirq_to_name[i];
+		sa->kattr.attr.mode = 0644;
+		sa->kattr.show = softirq_steer_show;
+		sa->kattr.store = softirq_steer_store;
+		sa->nr = i;
+		err = sysfs_create_file(kobj, &sa->kattr.attr);
+		if (err)
+			return err;
+	}
+
+	return 0;
+}
+device_initcall(softirq_sysfs_init);
+#endif /* CONFIG_SYSFS */
+
 /*
  * [ These __weak aliases are kept in a separate compilation unit, so that
  *   GCC does not inline them incorrectly. ]
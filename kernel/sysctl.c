@@ -129,6 +129,7 @@ static int __maybe_unused one = 1;
 static int __maybe_unused two = 2;
 static int __maybe_unused three = 3;
 static unsigned long one_ul = 1;
+static int __maybe_unused sixteen = 16;
 static int one_hundred = 100;
 #ifdef CONFIG_PRINTK
 static int ten_thousand = 10000;
@@ -1275,6 +1276,15 @@ static struct ctl_table vm_table[] = {
 		.extra1		= &min_percpu_pagelist_fract,
 	},
 #ifdef CONFIG_MMU
+	{
+		.procname	= "anon_fault_around_pages",
+		.data		= &sysctl_anon_fault_around_pages,
+		.maxlen		= sizeof(sysctl_anon_fault_around_pages),
+		.mode		= 0644,
+		.proc_handler	= proc_dointvec_minmax,
+		.extra1		= &zero,
+		.extra2		= &sixteen,
+	},
 	{
 		.procname	= "max_map_count",
 		.data		= &sysctl_max_map_count,
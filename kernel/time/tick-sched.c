@@ -813,6 +813,82 @@ void tick_check_idle(int cpu)
 	tick_check_nohz(cpu);
 }
 
+#ifdef CONFIG_NO_HZ_EXTENDED
+/*
+ * CPUs which may stretch their tick while running a single SCHED_FIFO
+ * task, set up with the "nohz_extended=" boot option.
+ */
+static cpumask_var_t nohz_extended_mask;
+static int have_nohz_extended;
+
+/* Longest stretch between two ticks on an extended-nohz CPU */
+#define NOHZ_EXTENDED_PERIOD_NS	NSEC_PER_SEC
+
+static int __init tick_nohz_extended_setup(char *str)
+{
+	alloc_bootmem_cpumask_var(&nohz_extended_mask);
+	if (cpulist_parse(str, nohz_extended_mask) < 0)
+		pr_warning("NOHZ: Incorrect nohz_extended cpumask\n");
+	else
+		have_nohz_extended = 1;
+	return 1;
+}
+early_param("nohz_extended", tick_nohz_extended_setup);
+
+/*
+ * Figure out how far the tick of this CPU may be stretched. Returns
+ * zero when the tick has to keep its regular period: the CPU is not in
+ * the extended-nohz set, it carries the do_timer duty, more than the
+ * lone SCHED_FIFO task is runnable, CPU timers are armed, or a timer
+ * wheel timer expires within the next jiffy.
+ *
+ * The tick is stretched, not stopped: the residual tick still reports
+ * quiescent states to RCU and runs deferrable per-cpu work, so no
+ * context tracking is needed - grace periods this CPU participates in
+ * just take up to NOHZ_EXTENDED_PERIOD_NS longer.
+ */
+static ktime_t tick_nohz_defer_period(void)
+{
+	int cpu = smp_processor_id();
+	unsigned long basejiff, nextevt;
+	u64 delta;
+
+	if (!have_nohz_extended ||
+	    !cpumask_test_cpu(cpu, nohz_extended_mask))
+		return ktime_set(0, 0);
+
+	/* Somebody has to keep jiffies and the timekeeper moving */
+	if (tick_do_timer_cpu == cpu)
+		return ktime_set(0, 0);
+
+	if (!sched_can_defer_tick())
+		return ktime_set(0, 0);
+
+	/* POSIX CPU timers are expired from the regular tick */
+	if (current->cputime_expires.prof_exp ||
+	    current->cputime_expires.virt_exp ||
+	    current->cputime_expires.sched_exp ||
+	    current->signal->cputime_expires.prof_exp ||
+	    current->signal->cputime_expires.virt_exp ||
+	    current->signal->cputime_expires.sched_exp)
+		return ktime_set(0, 0);
+
+	/* Do not run past the next timer wheel expiry */
+	basejiff = jiffies;
+	nextevt = get_next_timer_interrupt(basejiff);
+	if (time_before_eq(nextevt, basejiff + 1))
+		return ktime_set(0, 0);
+
+	delta = (u64)(nextevt - basejiff) * TICK_NSEC;
+	return ns_to_ktime(min_t(u64, delta, NOHZ_EXTENDED_PERIOD_NS));
+}
+#else
+static inline ktime_t tick_nohz_defer_period(void)
+{
+	return ktime_set(0, 0);
+}
+#endif /* CONFIG_NO_HZ_EXTENDED */
+
 /*
  * High resolution timer specific code
  */
@@ -834,9 +910,22 @@ static enum hrtimer_restart tick_sched_timer(struct hrtimer *timer)
 	 * Do not call, when we are not in irq context and have
 	 * no valid regs pointer
 	 */
-	if (regs)
+	if (regs) {
+		ktime_t period;
+
 		tick_sched_handle(ts, regs);
 
+		/*
+		 * A CPU dedicated to a single realtime task may stretch
+		 * its tick, see tick_nohz_defer_period().
+		 */
+		period = tick_nohz_defer_period();
+		if (period.tv64) {
+			hrtimer_forward(timer, now, period);
+			return HRTIMER_RESTART;
+		}
+	}
+
 	hrtimer_forward(timer, now, tick_period);
 
 	return HRTIMER_RESTART;
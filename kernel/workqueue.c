@@ -42,6 +42,10 @@
 #include <linux/lockdep.h>
 #include <linux/idr.h>
 #include <linux/hashtable.h>
+#include <linux/moduleparam.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/math64.h>
 
 #include "workqueue_internal.h"
 
@@ -169,6 +173,14 @@ struct pool_workqueue {
 	int			nr_active;	/* L: nr of active works */
 	int			max_active;	/* L: max active works */
 	struct list_head	delayed_works;	/* L: delayed works */
+#ifdef CONFIG_WORKQUEUE_DEBUGFS
+	u64			stats_queued_ts; /* L: first pending work */
+	u64			stats_exec_cnt;	/* L: works executed */
+	u64			stats_wait_total; /* L: queue-to-run, ns */
+	u64			stats_wait_max;	/* L: worst queue-to-run */
+	u64			stats_run_total; /* L: execution time, ns */
+	u64			stats_run_max;	/* L: worst execution time */
+#endif
 };
 
 /*
@@ -422,6 +434,29 @@ static inline void debug_work_deactivate(struct work_struct *work) { }
 /* Serializes the accesses to the list of workqueues. */
 static DEFINE_SPINLOCK(workqueue_lock);
 static LIST_HEAD(workqueues);
+
+/*
+ * On small SMP systems the scheduler tends to bounce the floating
+ * unbound workers - and everything their work items touch in the
+ * caches - between the few CPUs. With workqueue.compact=1 every new
+ * unbound worker is instead pinned to one CPU, chosen round-robin,
+ * and stays there. Not meant for machines with CPU hotplug churn;
+ * a worker whose home CPU goes away falls back to the scheduler.
+ */
+static bool wq_compact;
+module_param_named(compact, wq_compact, bool, 0444);
+
+static int wq_compact_next_cpu(void)
+{
+	static int last_cpu = -1;
+	int cpu;
+
+	cpu = cpumask_next(last_cpu, cpu_online_mask);
+	if (cpu >= nr_cpu_ids)
+		cpu = cpumask_first(cpu_online_mask);
+	last_cpu = cpu;
+	return cpu;
+}
 static bool workqueue_freezing;		/* W: have wqs started freezing? */
 
 /*
@@ -961,6 +996,49 @@ static void move_linked_works(struct work_struct *work, struct list_head *head,
 		*nextp = n;
 }
 
+#ifdef CONFIG_WORKQUEUE_DEBUGFS
+/*
+ * Queue-to-run latency is sampled per burst: the timestamp is taken
+ * when the pwq goes from idle to one active work and consumed by the
+ * worker picking that work up. All three helpers run under
+ * pool->lock.
+ */
+static void wq_stats_activated(struct pool_workqueue *pwq)
+{
+	if (pwq->nr_active == 1 && !pwq->stats_queued_ts)
+		pwq->stats_queued_ts = local_clock();
+}
+
+static u64 wq_stats_exec_start(struct pool_workqueue *pwq)
+{
+	u64 now = local_clock();
+
+	if (pwq->stats_queued_ts) {
+		u64 delay = now - pwq->stats_queued_ts;
+
+		pwq->stats_queued_ts = 0;
+		pwq->stats_wait_total += delay;
+		if (delay > pwq->stats_wait_max)
+			pwq->stats_wait_max = delay;
+	}
+	return now;
+}
+
+static void wq_stats_exec_end(struct pool_workqueue *pwq, u64 start)
+{
+	u64 runtime = local_clock() - start;
+
+	pwq->stats_exec_cnt++;
+	pwq->stats_run_total += runtime;
+	if (runtime > pwq->stats_run_max)
+		pwq->stats_run_max = runtime;
+}
+#else
+static inline void wq_stats_activated(struct pool_workqueue *pwq) { }
+static inline u64 wq_stats_exec_start(struct pool_workqueue *pwq) { return 0; }
+static inline void wq_stats_exec_end(struct pool_workqueue *pwq, u64 start) { }
+#endif /* CONFIG_WORKQUEUE_DEBUGFS */
+
 static void pwq_activate_delayed_work(struct work_struct *work)
 {
 	struct pool_workqueue *pwq = get_work_pwq(work);
@@ -969,6 +1047,7 @@ static void pwq_activate_delayed_work(struct work_struct *work)
 	move_linked_works(work, &pwq->pool->worklist, NULL);
 	__clear_bit(WORK_STRUCT_DELAYED_BIT, work_data_bits(work));
 	pwq->nr_active++;
+	wq_stats_activated(pwq);
 }
 
 static void pwq_activate_first_delayed(struct pool_workqueue *pwq)
@@ -1247,6 +1326,7 @@ static void __queue_work(unsigned int cpu, struct workqueue_struct *wq,
 	if (likely(pwq->nr_active < pwq->max_active)) {
 		trace_workqueue_activate_work(work);
 		pwq->nr_active++;
+		wq_stats_activated(pwq);
 		worklist = &pwq->pool->worklist;
 	} else {
 		work_flags |= WORK_STRUCT_DELAYED;
@@ -1748,6 +1828,17 @@ static struct worker *create_worker(struct worker_pool *pool)
 	if (!(pool->flags & POOL_DISASSOCIATED)) {
 		kthread_bind(worker->task, pool->cpu);
 	} else {
+		/*
+		 * In compact mode give each truly unbound worker a fixed
+		 * home CPU instead of letting it float.  This has to
+		 * happen before setting %PF_THREAD_BOUND, which makes the
+		 * affinity read-only.  Per-cpu pools which are merely
+		 * disassociated during CPU hotplug keep floating so that
+		 * rebind_workers() can take them home again.
+		 */
+		if (wq_compact && pool->cpu == WORK_CPU_UNBOUND)
+			set_cpus_allowed_ptr(worker->task,
+					     cpumask_of(wq_compact_next_cpu()));
 		worker->task->flags |= PF_THREAD_BOUND;
 		worker->flags |= WORKER_UNBOUND;
 	}
@@ -2085,6 +2176,7 @@ __acquires(&pool->lock)
 	bool cpu_intensive = pwq->wq->flags & WQ_CPU_INTENSIVE;
 	int work_color;
 	struct worker *collision;
+	u64 stats_start;
 #ifdef CONFIG_LOCKDEP
 	/*
 	 * It is permissible to free the struct work_struct from
@@ -2150,6 +2242,8 @@ __acquires(&pool->lock)
 	 */
 	set_work_pool_and_clear_pending(work, pool->id);
 
+	stats_start = wq_stats_exec_start(pwq);
+
 	spin_unlock_irq(&pool->lock);
 
 	lock_map_acquire_read(&pwq->wq->lockdep_map);
@@ -2175,6 +2269,8 @@ __acquires(&pool->lock)
 
 	spin_lock_irq(&pool->lock);
 
+	wq_stats_exec_end(pwq, stats_start);
+
 	/* clear cpu intensive status */
 	if (unlikely(cpu_intensive))
 		worker_clr_flags(worker, WORKER_CPU_INTENSIVE);
@@ -3726,6 +3822,70 @@ out_unlock:
 }
 #endif /* CONFIG_FREEZER */
 
+#ifdef CONFIG_WORKQUEUE_DEBUGFS
+static int wq_stats_show(struct seq_file *m, void *v)
+{
+	struct workqueue_struct *wq;
+	unsigned int cpu;
+
+	seq_printf(m, "%-24s %10s %12s %12s %11s %11s\n", "workqueue",
+		   "executed", "avg_wait_us", "max_wait_us", "avg_run_us",
+		   "max_run_us");
+
+	spin_lock(&workqueue_lock);
+	list_for_each_entry(wq, &workqueues, list) {
+		u64 cnt = 0, wait = 0, wait_max = 0, run = 0, run_max = 0;
+
+		/*
+		 * The counters are updated under pool->lock which we
+		 * don't hold; slightly stale debug statistics are fine.
+		 */
+		for_each_pwq_cpu(cpu, wq) {
+			struct pool_workqueue *pwq = get_pwq(cpu, wq);
+
+			cnt += pwq->stats_exec_cnt;
+			wait += pwq->stats_wait_total;
+			if (pwq->stats_wait_max > wait_max)
+				wait_max = pwq->stats_wait_max;
+			run += pwq->stats_run_total;
+			if (pwq->stats_run_max > run_max)
+				run_max = pwq->stats_run_max;
+		}
+
+		if (!cnt)
+			cnt = 1;
+		seq_printf(m, "%-24s %10llu %12llu %12llu %11llu %11llu\n",
+			   wq->name, (unsigned long long)cnt,
+			   div64_u64(wait, cnt * NSEC_PER_USEC),
+			   div64_u64(wait_max, NSEC_PER_USEC),
+			   div64_u64(run, cnt * NSEC_PER_USEC),
+			   div64_u64(run_max, NSEC_PER_USEC));
+	}
+	spin_unlock(&workqueue_lock);
+
+	return 0;
+}
+
+static int wq_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, wq_stats_show, NULL);
+}
+
+static const struct file_operations wq_stats_fops = {
+	.open		= wq_stats_open,
+	.read		= seq_read,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init wq_debugfs_init(void)
+{
+	debugfs_create_file("workqueues", 0444, NULL, NULL, &wq_stats_fops);
+	return 0;
+}
+late_initcall(wq_debugfs_init);
+#endif /* CONFIG_WORKQUEUE_DEBUGFS */
+
 static int __init init_workqueues(void)
 {
 	unsigned int cpu;
@@ -28,6 +28,7 @@
 
 #include <linux/crc32.h>
 #include <linux/module.h>
+#include <linux/prefetch.h>
 #include <linux/types.h>
 #include "crc32defs.h"
 
@@ -101,6 +102,12 @@ crc32_body(u32 crc, unsigned char const *buf, size_t len, const u32 (*tab)[256])
 # else
 	for (--b; len; --len) {
 # endif
+		/* stay a cache line ahead; cores without an aggressive
+		 * hardware prefetcher otherwise stall on every line of a
+		 * large buffer, and repeat hints to a line already in
+		 * flight cost nothing
+		 */
+		prefetch(b + 16);
 		q = crc ^ *++b; /* use pre increment for speed */
 # if CRC_LE_BITS == 32
 		crc = DO_CRC4;
@@ -0,0 +1,116 @@
+/*
+ * LZ4 decompressor for the kernel, the preboot environment and
+ * initramfs unpacking.
+ *
+ * Copyright (C) 2013, LG Electronics, Kyungsik Lee <kyungsik.lee@lge.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#ifndef STATIC
+#include <linux/module.h>
+#include <linux/kernel.h>
+#endif
+#include <linux/lz4.h>
+
+#include <asm/unaligned.h>
+
+#include "lz4defs.h"
+
+/*
+ * Decode one LZ4 block.  Every read of the input and every write of
+ * the output is bounds checked, so a corrupted stream fails cleanly
+ * instead of scribbling outside the buffers.
+ */
+static int lz4_uncompress_safe(const u8 *src, const u8 *src_end,
+			       u8 *dest, u8 *dest_end, size_t *dest_used)
+{
+	const u8 *ip = src;
+	u8 *op = dest;
+
+	while (1) {
+		const u8 *match;
+		size_t offset;
+		size_t len;
+		unsigned int token, s;
+
+		if (ip >= src_end)
+			goto err;
+		token = *ip++;
+
+		/* copy the literal run */
+		len = token >> ML_BITS;
+		if (len == RUN_MASK) {
+			do {
+				if (ip >= src_end)
+					goto err;
+				s = *ip++;
+				len += s;
+			} while (s == 255);
+		}
+		if (len > (size_t)(src_end - ip) ||
+		    len > (size_t)(dest_end - op))
+			goto err;
+		memcpy(op, ip, len);
+		ip += len;
+		op += len;
+
+		/* the last sequence carries literals only */
+		if (ip == src_end)
+			break;
+
+		if (src_end - ip < 2)
+			goto err;
+		offset = get_unaligned_le16(ip);
+		ip += 2;
+		match = op - offset;
+		if (!offset || match < dest)
+			goto err;
+
+		len = token & ML_MASK;
+		if (len == ML_MASK) {
+			do {
+				if (ip >= src_end)
+					goto err;
+				s = *ip++;
+				len += s;
+			} while (s == 255);
+		}
+		len += MINMATCH;
+		if (len > (size_t)(dest_end - op))
+			goto err;
+		/*
+		 * The match may overlap the output being produced
+		 * (offset < len encodes a repeating pattern), so this
+		 * must copy forwards a byte at a time.
+		 */
+		while (len--)
+			*op++ = *match++;
+	}
+
+	*dest_used = op - dest;
+	return 0;
+err:
+	return -1;
+}
+
+int lz4_decompress_unknownoutputsize(const unsigned char *src, size_t src_len,
+		unsigned char *dest, size_t *dest_len)
+{
+	size_t out;
+
+	if (lz4_uncompress_safe(src, src + src_len,
+				dest, dest + *dest_len, &out) < 0)
+		return -1;
+
+	*dest_len = out;
+	return 0;
+}
+#ifndef STATIC
+EXPORT_SYMBOL(lz4_decompress_unknownoutputsize);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("LZ4 Decompressor");
+#endif
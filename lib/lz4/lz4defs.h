@@ -0,0 +1,23 @@
+/*
+ * lz4defs.h -- common defines for the LZ4 block format
+ *
+ * Copyright (C) 2013, LG Electronics, Kyungsik Lee <kyungsik.lee@lge.com>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+/*
+ * A sequence starts with a token: the high nibble is the literal run
+ * length, the low nibble the match length minus MINMATCH.  A nibble
+ * of 15 means the length continues in subsequent bytes, 255 meaning
+ * "add 255 and keep reading".  The match offset is a two byte little
+ * endian value between the literals and the match length extension.
+ */
+#define MINMATCH	4
+
+#define ML_BITS		4
+#define ML_MASK		((1U << ML_BITS) - 1)
+#define RUN_BITS	(8 - ML_BITS)
+#define RUN_MASK	((1U << RUN_BITS) - 1)
@@ -0,0 +1,141 @@
+/*
+ * Per-call-site page allocation stall statistics.
+ *
+ * The page allocator slow path and the CMA allocator report every trip
+ * through alloc_stall_account(); the table below keeps one latency
+ * histogram per call site, with retry and direct-compaction counts, so
+ * a deadline miss can be pinned on the allocation that caused it and
+ * reserved pools can be sized from real numbers instead of guesses.
+ *
+ * Readable from <debugfs>/alloc_stall; write anything to reset.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ */
+
+#include <linux/debugfs.h>
+#include <linux/gfp.h>
+#include <linux/kernel.h>
+#include <linux/math64.h>
+#include <linux/seq_file.h>
+#include <linux/spinlock.h>
+
+#define ALLOC_STALL_SITES	64
+#define ALLOC_STALL_BUCKETS	16	/* bucket n holds [2^n, 2^(n+1)) us */
+
+struct alloc_stall_site {
+	unsigned long ip;
+	u64 count;
+	u64 total_us;
+	u64 max_us;
+	u64 retries;
+	u64 compact_tries;
+	unsigned int max_order;
+	u64 hist[ALLOC_STALL_BUCKETS];
+};
+
+static struct alloc_stall_site stall_sites[ALLOC_STALL_SITES];
+/* everything that no longer fits in the table lands here */
+static struct alloc_stall_site stall_overflow;
+static DEFINE_SPINLOCK(stall_lock);
+
+void alloc_stall_account(unsigned long ip, unsigned int order, u64 usecs,
+			 unsigned int retries, unsigned int compact_tries)
+{
+	struct alloc_stall_site *site = &stall_overflow;
+	unsigned long flags;
+	int bucket;
+	int i;
+
+	bucket = usecs ? min(fls64(usecs) - 1, ALLOC_STALL_BUCKETS - 1) : 0;
+
+	spin_lock_irqsave(&stall_lock, flags);
+	for (i = 0; i < ALLOC_STALL_SITES; i++) {
+		if (stall_sites[i].ip == ip || !stall_sites[i].ip) {
+			site = &stall_sites[i];
+			site->ip = ip;
+			break;
+		}
+	}
+	site->count++;
+	site->total_us += usecs;
+	site->max_us = max(site->max_us, usecs);
+	site->retries += retries;
+	site->compact_tries += compact_tries;
+	site->max_order = max(site->max_order, order);
+	site->hist[bucket]++;
+	spin_unlock_irqrestore(&stall_lock, flags);
+}
+
+static void alloc_stall_print(struct seq_file *m,
+			      const struct alloc_stall_site *site)
+{
+	int i;
+
+	if (site->ip)
+		seq_printf(m, "%pf", (void *)site->ip);
+	else
+		seq_puts(m, "<other>");
+	seq_printf(m, " count=%llu avg_us=%llu max_us=%llu retries=%llu compact=%llu max_order=%u hist:",
+		   site->count,
+		   div64_u64(site->total_us, site->count),
+		   site->max_us, site->retries, site->compact_tries,
+		   site->max_order);
+	for (i = 0; i < ALLOC_STALL_BUCKETS; i++)
+		seq_printf(m, " %llu", site->hist[i]);
+	seq_putc(m, '\n');
+}
+
+static int alloc_stall_show(struct seq_file *m, void *v)
+{
+	struct alloc_stall_site site;
+	unsigned long flags;
+	int i;
+
+	for (i = 0; i <= ALLOC_STALL_SITES; i++) {
+		/* snapshot each entry so the lock never covers seq output */
+		spin_lock_irqsave(&stall_lock, flags);
+		site = (i < ALLOC_STALL_SITES) ? stall_sites[i]
+					       : stall_overflow;
+		spin_unlock_irqrestore(&stall_lock, flags);
+
+		if (site.count)
+			alloc_stall_print(m, &site);
+	}
+	return 0;
+}
+
+static int alloc_stall_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, alloc_stall_show, NULL);
+}
+
+static ssize_t alloc_stall_write(struct file *file, const char __user *buf,
+				 size_t count, loff_t *ppos)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&stall_lock, flags);
+	memset(stall_sites, 0, sizeof(stall_sites));
+	memset(&stall_overflow, 0, sizeof(stall_overflow));
+	spin_unlock_irqrestore(&stall_lock, flags);
+
+	return count;
+}
+
+static const struct file_operations alloc_stall_fops = {
+	.open		= alloc_stall_open,
+	.read		= seq_read,
+	.write		= alloc_stall_write,
+	.llseek		= seq_lseek,
+	.release	= single_release,
+};
+
+static int __init alloc_stall_init(void)
+{
+	debugfs_create_file("alloc_stall", S_IRUGO | S_IWUSR, NULL, NULL,
+			    &alloc_stall_fops);
+	return 0;
+}
+late_initcall(alloc_stall_init);
@@ -3214,6 +3214,73 @@ static inline int check_stack_guard_page(struct vm_area_struct *vma, unsigned lo
  * but allow concurrent faults), and pte mapped but not yet locked.
  * We return with mmap_sem still held, but pte unmapped and unlocked.
  */
+/*
+ * Number of extra zeroed pages to map behind a write fault on anonymous
+ * memory.  Zero (the default) disables fault-around; daemons that mmap
+ * a large buffer and then stream through it can raise it to amortize
+ * the fault entry/exit and zeroing cost over a batch.
+ */
+int sysctl_anon_fault_around_pages __read_mostly;
+
+/*
+ * Opportunistically map extra zeroed pages after the one at @address
+ * has been handled, so a sequential writer takes one fault per batch
+ * instead of one per page.  Best effort only: the batch stops at the
+ * vma end, at the end of the page table page, at the first pte that is
+ * no longer none, or at the first failed allocation, all silently.
+ *
+ * Called with mmap_sem held for read and the pte unmapped; stack vmas
+ * are skipped so the guard-page logic stays the business of the real
+ * fault path.
+ */
+static void do_anon_fault_around(struct mm_struct *mm,
+		struct vm_area_struct *vma, unsigned long address, pmd_t *pmd)
+{
+	unsigned int nr = ACCESS_ONCE(sysctl_anon_fault_around_pages);
+	unsigned long addr = address + PAGE_SIZE;
+	unsigned long end;
+	spinlock_t *ptl;
+	pte_t *pte;
+
+	if (nr <= 1 || vma->vm_flags & (VM_GROWSDOWN | VM_GROWSUP))
+		return;
+
+	end = min(vma->vm_end, (address & PMD_MASK) + PMD_SIZE);
+	end = min(end, address + (unsigned long)nr * PAGE_SIZE);
+
+	for (; addr < end; addr += PAGE_SIZE) {
+		struct page *page;
+		pte_t entry;
+
+		page = alloc_zeroed_user_highpage_movable(vma, addr);
+		if (!page)
+			return;
+		__SetPageUptodate(page);
+
+		if (mem_cgroup_newpage_charge(page, mm, GFP_KERNEL)) {
+			page_cache_release(page);
+			return;
+		}
+
+		entry = mk_pte(page, vma->vm_page_prot);
+		if (vma->vm_flags & VM_WRITE)
+			entry = pte_mkwrite(pte_mkdirty(entry));
+
+		pte = pte_offset_map_lock(mm, pmd, addr, &ptl);
+		if (!pte_none(*pte)) {
+			pte_unmap_unlock(pte, ptl);
+			mem_cgroup_uncharge_page(page);
+			page_cache_release(page);
+			return;
+		}
+		inc_mm_counter_fast(mm, MM_ANONPAGES);
+		page_add_new_anon_rmap(page, vma, addr);
+		set_pte_at(mm, addr, pte, entry);
+		update_mmu_cache(vma, addr, pte);
+		pte_unmap_unlock(pte, ptl);
+	}
+}
+
 static int do_anonymous_page(struct mm_struct *mm, struct vm_area_struct *vma,
 		unsigned long address, pte_t *page_table, pmd_t *pmd,
 		unsigned int flags)
@@ -3264,6 +3331,11 @@ setpte:
 
 	/* No need to invalidate - it was non-present before */
 	update_mmu_cache(vma, address, page_table);
+	pte_unmap_unlock(page_table, ptl);
+
+	if (flags & FAULT_FLAG_WRITE)
+		do_anon_fault_around(mm, vma, address, pmd);
+	return 0;
 unlock:
 	pte_unmap_unlock(page_table, ptl);
 	return 0;
@@ -36,6 +36,7 @@
 #include <linux/pagevec.h>
 #include <linux/timer.h>
 #include <linux/sched/rt.h>
+#include <linux/ioprio.h>
 #include <trace/events/writeback.h>
 
 /*
@@ -247,14 +248,33 @@ static unsigned long global_dirtyable_memory(void)
 	return x + 1;	/* Ensure that we never return 0 */
 }
 
+/*
+ * tsk_less_throttled - whether @tsk gets extra headroom over the dirty limits
+ *
+ * This is the case for PF_LESS_THROTTLE tasks (ie. nfsd), tasks with a
+ * real-time scheduling policy, and tasks which have put themselves into the
+ * real-time I/O priority class (ionice -c 1). The latter gives a
+ * latency-sensitive control process a way of dirtying a handful of pages
+ * without being throttled behind a bulk writer which has pushed the device
+ * up to its limits.
+ */
+static bool tsk_less_throttled(struct task_struct *tsk)
+{
+	if (tsk->flags & PF_LESS_THROTTLE || rt_task(tsk))
+		return true;
+
+	return tsk->io_context &&
+	       IOPRIO_PRIO_CLASS(tsk->io_context->ioprio) == IOPRIO_CLASS_RT;
+}
+
 /*
  * global_dirty_limits - background-writeback and dirty-throttling thresholds
  *
  * Calculate the dirty thresholds based on sysctl parameters
  * - vm.dirty_background_ratio  or  vm.dirty_background_bytes
  * - vm.dirty_ratio             or  vm.dirty_bytes
- * The dirty limits will be lifted by 1/4 for PF_LESS_THROTTLE (ie. nfsd) and
- * real-time tasks.
+ * The dirty limits will be lifted by 1/4 for less throttled tasks, see
+ * tsk_less_throttled().
  */
 void global_dirty_limits(unsigned long *pbackground, unsigned long *pdirty)
 {
@@ -279,7 +299,7 @@ void global_dirty_limits(unsigned long *pbackground, unsigned long *pdirty)
 	if (background >= dirty)
 		background = dirty / 2;
 	tsk = current;
-	if (tsk->flags & PF_LESS_THROTTLE || rt_task(tsk)) {
+	if (tsk_less_throttled(tsk)) {
 		background += background / 4;
 		dirty += dirty / 4;
 	}
@@ -333,7 +353,7 @@ static unsigned long zone_dirty_limit(struct zone *zone)
 	else
 		dirty = vm_dirty_ratio * zone_memory / 100;
 
-	if (tsk->flags & PF_LESS_THROTTLE || rt_task(tsk))
+	if (tsk_less_throttled(tsk))
 		dirty += dirty / 4;
 
 	return dirty;
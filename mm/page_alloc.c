@@ -58,7 +58,9 @@
 #include <linux/prefetch.h>
 #include <linux/migrate.h>
 #include <linux/page-debug-flags.h>
+#include <linux/sched.h>
 #include <linux/sched/rt.h>
+#include <linux/math64.h>
 
 #include <asm/tlbflush.h>
 #include <asm/div64.h>
@@ -2365,7 +2367,7 @@ static inline struct page *
 __alloc_pages_slowpath(gfp_t gfp_mask, unsigned int order,
 	struct zonelist *zonelist, enum zone_type high_zoneidx,
 	nodemask_t *nodemask, struct zone *preferred_zone,
-	int migratetype)
+	int migratetype, unsigned long ip)
 {
 	const gfp_t wait = gfp_mask & __GFP_WAIT;
 	struct page *page = NULL;
@@ -2375,6 +2377,10 @@ __alloc_pages_slowpath(gfp_t gfp_mask, unsigned int order,
 	bool sync_migration = false;
 	bool deferred_compaction = false;
 	bool contended_compaction = false;
+	unsigned int stall_retries = 0;
+	unsigned int stall_compact = 0;
+	u64 stall_start = local_clock();
+	u64 stall_us;
 
 	/*
 	 * In the slowpath, we sanity check order to avoid ever trying to
@@ -2460,6 +2466,7 @@ rebalance:
 	 * Try direct compaction. The first pass is asynchronous. Subsequent
 	 * attempts after direct reclaim are synchronous
 	 */
+	stall_compact++;
 	page = __alloc_pages_direct_compact(gfp_mask, order,
 					zonelist, high_zoneidx,
 					nodemask,
@@ -2528,6 +2535,7 @@ rebalance:
 					goto nopage;
 			}
 
+			stall_retries++;
 			goto restart;
 		}
 	}
@@ -2538,6 +2546,7 @@ rebalance:
 						pages_reclaimed)) {
 		/* Wait for some write requests to complete then retry */
 		wait_iff_congested(preferred_zone, BLK_RW_ASYNC, HZ/50);
+		stall_retries++;
 		goto rebalance;
 	} else {
 		/*
@@ -2545,6 +2554,7 @@ rebalance:
 		 * direct reclaim and reclaim/compaction depends on compaction
 		 * being called after reclaim so call directly if necessary
 		 */
+		stall_compact++;
 		page = __alloc_pages_direct_compact(gfp_mask, order,
 					zonelist, high_zoneidx,
 					nodemask,
@@ -2559,11 +2569,15 @@ rebalance:
 
 nopage:
 	warn_alloc_failed(gfp_mask, order, NULL);
-	return page;
+	goto out;
 got_pg:
 	if (kmemcheck_enabled)
 		kmemcheck_pagealloc_alloc(page, order, gfp_mask);
-
+out:
+	stall_us = div_u64(local_clock() - stall_start, NSEC_PER_USEC);
+	trace_mm_page_alloc_stall(ip, order, gfp_mask, stall_us,
+				  stall_retries, stall_compact);
+	alloc_stall_account(ip, order, stall_us, stall_retries, stall_compact);
 	return page;
 }
 
@@ -2633,7 +2647,7 @@ retry_cpuset:
 		gfp_mask = memalloc_noio_flags(gfp_mask);
 		page = __alloc_pages_slowpath(gfp_mask, order,
 				zonelist, high_zoneidx, nodemask,
-				preferred_zone, migratetype);
+				preferred_zone, migratetype, _RET_IP_);
 	}
 
 	trace_mm_page_alloc(page, order, gfp_mask, migratetype);
@@ -2654,6 +2668,82 @@ out:
 }
 EXPORT_SYMBOL(__alloc_pages_nodemask);
 
+/**
+ * alloc_pages_bulk - allocate a number of order-0 pages onto a list
+ * @gfp_mask: GFP flags for the allocation
+ * @count: number of pages wanted
+ * @list: empty list head the allocated pages are linked onto via page->lru
+ *
+ * Fills @list from the per-cpu free lists of the preferred zone of the
+ * local node, refilling them from the buddy lists at most once per
+ * batch instead of taking the zone lock once per page.  The bulk path
+ * is best effort: it only serves whole order-0 pages, stops at the low
+ * watermark rather than digging into the reserves, and never enters
+ * reclaim.  Callers fall back to alloc_page() for whatever it did not
+ * provide.
+ *
+ * Returns the number of pages placed on @list, which may be fewer than
+ * @count, including none at all.
+ */
+unsigned long alloc_pages_bulk(gfp_t gfp_mask, unsigned long count,
+			       struct list_head *list)
+{
+	struct zonelist *zonelist = node_zonelist(numa_node_id(), gfp_mask);
+	int migratetype = allocflags_to_migratetype(gfp_mask);
+	struct per_cpu_pages *pcp;
+	struct list_head *pcplist;
+	struct page *page, *next;
+	unsigned long allocated = 0;
+	unsigned long flags;
+	struct zone *zone;
+
+	first_zones_zonelist(zonelist, gfp_zone(gfp_mask), NULL, &zone);
+	if (!zone)
+		return 0;
+
+	if (!zone_watermark_ok(zone, 0, low_wmark_pages(zone) + count,
+			       zone_idx(zone), 0))
+		return 0;
+
+	local_irq_save(flags);
+	pcp = &this_cpu_ptr(zone->pageset)->pcp;
+	pcplist = &pcp->lists[migratetype];
+
+	while (allocated < count) {
+		if (list_empty(pcplist)) {
+			pcp->count += rmqueue_bulk(zone, 0,
+					max_t(unsigned long, count - allocated,
+					      pcp->batch),
+					pcplist, migratetype,
+					!!(gfp_mask & __GFP_COLD));
+			if (unlikely(list_empty(pcplist)))
+				break;
+		}
+
+		page = list_entry(pcplist->next, struct page, lru);
+		list_del(&page->lru);
+		pcp->count--;
+		list_add_tail(&page->lru, list);
+		allocated++;
+	}
+
+	__count_zone_vm_events(PGALLOC, zone, allocated);
+	zone_statistics(zone, zone, gfp_mask);
+	local_irq_restore(flags);
+
+	/* prep_new_page() may zero the pages, do that with interrupts on */
+	list_for_each_entry_safe(page, next, list, lru) {
+		if (unlikely(prep_new_page(page, 0, gfp_mask))) {
+			/* bad page, already taken out of circulation */
+			list_del(&page->lru);
+			allocated--;
+		}
+	}
+
+	return allocated;
+}
+EXPORT_SYMBOL(alloc_pages_bulk);
+
 /*
  * Common helper functions.
  */
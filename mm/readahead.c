@@ -402,6 +402,17 @@ ondemand_readahead(struct address_space *mapping,
 {
 	unsigned long max = max_sane_readahead(ra->ra_pages);
 
+	/*
+	 * The default window is sized for the fastest devices around.
+	 * When the device cannot keep up, its request queue congests;
+	 * use that as feedback and scale the window down, so that slow
+	 * devices are not flooded with speculative I/O they will take
+	 * ages to retire.  The window ramps up again via the regular
+	 * get_next_ra_size() path once the queue has drained.
+	 */
+	if (bdi_read_congested(mapping->backing_dev_info))
+		max = (max + 3) / 4;
+
 	/*
 	 * start of file
 	 */
@@ -113,6 +113,7 @@ static unsigned long shmem_default_max_inodes(void)
 static bool shmem_should_replace_page(struct page *page, gfp_t gfp);
 static int shmem_replace_page(struct page **pagep, gfp_t gfp,
 				struct shmem_inode_info *info, pgoff_t index);
+static void shmem_drop_contig(struct shmem_inode_info *info);
 static int shmem_getpage_gfp(struct inode *inode, pgoff_t index,
 	struct page **pagep, enum sgp_type sgp, gfp_t gfp, int *fault_type);
 
@@ -632,6 +633,7 @@ static void shmem_evict_inode(struct inode *inode)
 	if (inode->i_mapping->a_ops == &shmem_aops) {
 		shmem_unacct_size(info->flags, inode->i_size);
 		inode->i_size = 0;
+		shmem_drop_contig(info);
 		shmem_truncate_range(inode, 0, (loff_t)-1);
 		if (!list_empty(&info->swaplist)) {
 			mutex_lock(&shmem_swaplist_mutex);
@@ -974,6 +976,185 @@ static inline struct mempolicy *shmem_get_sbmpol(struct shmem_sb_info *sbinfo)
 }
 #endif
 
+/*
+ * With the "contig_order" mount option, data pages are carved out of
+ * higher-order blocks, so that pages which are contiguous in the file
+ * are usually also physically contiguous.  Shared rings mapped from
+ * such a tmpfs then cover far fewer TLB entries (via overlapping
+ * section mappings on the read side, or simply better locality), and
+ * bus masters that address physical memory see grouped buffers.
+ *
+ * The remainder of each block is stashed on the inode and handed out
+ * as neighbouring indices are faulted in; whatever is left over is
+ * freed when a different block is carved or the inode is evicted.
+ * Contiguity is only a hint: if a high-order block cannot be had
+ * cheaply, allocation falls back to single pages.
+ */
+#define SHMEM_CONTIG_MAX_ORDER	8
+
+struct shmem_contig {
+	pgoff_t base;			/* file index of pages[0] */
+	unsigned int order;
+	struct page *pages[0];		/* NULL once handed out */
+};
+
+/*
+ * Stashed pages must remain visible to the size= mount limit and to
+ * memcg, exactly as if they were already mapped: the stash is just
+ * pages the file will soon use.  Each stash page holds one unit of
+ * block accounting and a memcg cache charge; both are released when
+ * the page is handed out (the caller in shmem_getpage_gfp() charges
+ * it again through the normal path) or when the stash is freed.
+ */
+static int shmem_contig_charge(struct shmem_inode_info *info,
+			       struct shmem_contig *contig, gfp_t gfp)
+{
+	struct shmem_sb_info *sbinfo = SHMEM_SB(info->vfs_inode.i_sb);
+	long pages = (1 << contig->order) - 1;	/* one is handed out */
+	int i;
+
+	if ((info->flags & VM_NORESERVE) &&
+	    security_vm_enough_memory_mm(current->mm,
+					pages * VM_ACCT(PAGE_CACHE_SIZE)))
+		return -ENOSPC;
+	if (sbinfo->max_blocks) {
+		if (percpu_counter_compare(&sbinfo->used_blocks,
+					sbinfo->max_blocks - pages) > 0) {
+			shmem_unacct_blocks(info->flags, pages);
+			return -ENOSPC;
+		}
+		percpu_counter_add(&sbinfo->used_blocks, pages);
+	}
+
+	for (i = 0; i < (1 << contig->order); i++) {
+		if (!contig->pages[i])
+			continue;
+		if (mem_cgroup_cache_charge(contig->pages[i], current->mm,
+					    gfp & GFP_RECLAIM_MASK))
+			goto uncharge;
+	}
+	return 0;
+
+uncharge:
+	while (--i >= 0)
+		if (contig->pages[i])
+			mem_cgroup_uncharge_cache_page(contig->pages[i]);
+	if (sbinfo->max_blocks)
+		percpu_counter_add(&sbinfo->used_blocks, -pages);
+	shmem_unacct_blocks(info->flags, pages);
+	return -ENOSPC;
+}
+
+static void shmem_contig_unaccount(struct shmem_inode_info *info, long pages)
+{
+	struct shmem_sb_info *sbinfo = SHMEM_SB(info->vfs_inode.i_sb);
+
+	if (!pages)
+		return;
+	if (sbinfo->max_blocks)
+		percpu_counter_add(&sbinfo->used_blocks, -pages);
+	shmem_unacct_blocks(info->flags, pages);
+}
+
+static void shmem_free_contig(struct shmem_inode_info *info,
+			      struct shmem_contig *contig)
+{
+	long remaining = 0;
+	int i;
+
+	for (i = 0; i < (1 << contig->order); i++)
+		if (contig->pages[i]) {
+			mem_cgroup_uncharge_cache_page(contig->pages[i]);
+			__free_page(contig->pages[i]);
+			remaining++;
+		}
+	shmem_contig_unaccount(info, remaining);
+	kfree(contig);
+}
+
+static void shmem_drop_contig(struct shmem_inode_info *info)
+{
+	struct shmem_contig *contig;
+
+	spin_lock(&info->lock);
+	contig = info->contig;
+	info->contig = NULL;
+	spin_unlock(&info->lock);
+
+	if (contig)
+		shmem_free_contig(info, contig);
+}
+
+static struct page *shmem_alloc_page_contig(gfp_t gfp,
+			struct shmem_inode_info *info, pgoff_t index,
+			unsigned int order)
+{
+	pgoff_t base = index & ~((pgoff_t)(1 << order) - 1);
+	struct shmem_contig *contig, *old;
+	struct page *head, *page;
+	int i, nr = 1 << order;
+
+	spin_lock(&info->lock);
+	contig = info->contig;
+	if (contig && index - contig->base < (pgoff_t)(1 << contig->order)) {
+		page = contig->pages[index - contig->base];
+		contig->pages[index - contig->base] = NULL;
+		spin_unlock(&info->lock);
+		if (page) {
+			/* the caller accounts it through the normal path */
+			shmem_contig_unaccount(info, 1);
+			mem_cgroup_uncharge_cache_page(page);
+			return page;
+		}
+		/* this index was already handed out and truncated */
+		return shmem_alloc_page(gfp, info, index);
+	}
+	spin_unlock(&info->lock);
+
+	/*
+	 * Carve a fresh block.  Don't try hard: a ring which cannot get
+	 * contiguous memory is still a working ring.
+	 */
+	head = alloc_pages(gfp | __GFP_NORETRY | __GFP_NOWARN, order);
+	if (!head)
+		return shmem_alloc_page(gfp, info, index);
+
+	split_page(head, order);
+
+	contig = kmalloc(sizeof(*contig) + nr * sizeof(struct page *),
+			 gfp & GFP_RECLAIM_MASK);
+	if (!contig) {
+		for (i = 1; i < nr; i++)
+			__free_page(head + i);
+		return head;
+	}
+
+	contig->base = base;
+	contig->order = order;
+	for (i = 0; i < nr; i++)
+		contig->pages[i] = head + i;
+	page = contig->pages[index - base];
+	contig->pages[index - base] = NULL;
+
+	if (shmem_contig_charge(info, contig, gfp)) {
+		for (i = 0; i < nr; i++)
+			if (contig->pages[i])
+				__free_page(contig->pages[i]);
+		kfree(contig);
+		return page;
+	}
+
+	spin_lock(&info->lock);
+	old = info->contig;
+	info->contig = contig;
+	spin_unlock(&info->lock);
+
+	if (old)
+		shmem_free_contig(info, old);
+
+	return page;
+}
+
 /*
  * When a page is moved from swapcache to shmem filecache (either by the
  * usual swapin of shmem_getpage_gfp(), or by the less common swapoff of
@@ -1191,7 +1372,11 @@ repeat:
 			percpu_counter_inc(&sbinfo->used_blocks);
 		}
 
-		page = shmem_alloc_page(gfp, info, index);
+		if (sbinfo->contig_order)
+			page = shmem_alloc_page_contig(gfp, info, index,
+						       sbinfo->contig_order);
+		else
+			page = shmem_alloc_page(gfp, info, index);
 		if (!page) {
 			error = -ENOMEM;
 			goto decused;
@@ -2462,6 +2647,11 @@ static int shmem_parse_options(char *options, struct shmem_sb_info *sbinfo,
 			sbinfo->gid = make_kgid(current_user_ns(), gid);
 			if (!gid_valid(sbinfo->gid))
 				goto bad_val;
+		} else if (!strcmp(this_char,"contig_order")) {
+			sbinfo->contig_order = simple_strtoul(value, &rest, 0);
+			if (*rest ||
+			    sbinfo->contig_order > SHMEM_CONTIG_MAX_ORDER)
+				goto bad_val;
 		} else if (!strcmp(this_char,"mpol")) {
 			mpol_put(mpol);
 			mpol = NULL;
@@ -2516,6 +2706,7 @@ static int shmem_remount_fs(struct super_block *sb, int *flags, char *data)
 	sbinfo->max_blocks  = config.max_blocks;
 	sbinfo->max_inodes  = config.max_inodes;
 	sbinfo->free_inodes = config.max_inodes - inodes;
+	sbinfo->contig_order = config.contig_order;
 
 	/*
 	 * Preserve previous mempolicy unless mpol remount option was specified.
@@ -2546,6 +2737,8 @@ static int shmem_show_options(struct seq_file *seq, struct dentry *root)
 	if (!gid_eq(sbinfo->gid, GLOBAL_ROOT_GID))
 		seq_printf(seq, ",gid=%u",
 				from_kgid_munged(&init_user_ns, sbinfo->gid));
+	if (sbinfo->contig_order)
+		seq_printf(seq, ",contig_order=%u", sbinfo->contig_order);
 	shmem_show_mpol(seq, sbinfo->mpol);
 	return 0;
 }
@@ -2270,6 +2270,12 @@ load_freelist:
 	VM_BUG_ON(!c->page->frozen);
 	c->freelist = get_freepointer(s, freelist);
 	c->tid = next_tid(c->tid);
+	/*
+	 * The next allocation will take the fastpath and immediately
+	 * chase the freepointer of the object we just queued; start
+	 * pulling it in now, as the fastpath prefetch does.
+	 */
+	prefetch_freepointer(s, c->freelist);
 	local_irq_restore(flags);
 	return freelist;
 
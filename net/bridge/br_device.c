@@ -89,6 +89,12 @@ static int br_dev_init(struct net_device *dev)
 	if (!br->stats)
 		return -ENOMEM;
 
+	br->fdb_cache = alloc_percpu(struct br_fdb_cache);
+	if (!br->fdb_cache) {
+		free_percpu(br->stats);
+		return -ENOMEM;
+	}
+
 	return 0;
 }
 
@@ -324,6 +330,7 @@ static void br_dev_free(struct net_device *dev)
 {
 	struct net_bridge *br = netdev_priv(dev);
 
+	free_percpu(br->fdb_cache);
 	free_percpu(br->stats);
 	free_netdev(dev);
 }
@@ -85,6 +85,7 @@ static void fdb_rcu_free(struct rcu_head *head)
 static void fdb_delete(struct net_bridge *br, struct net_bridge_fdb_entry *f)
 {
 	hlist_del_rcu(&f->hlist);
+	br->fdb_gen++;		/* invalidate the per-CPU lookup caches */
 	fdb_notify(br, f, RTM_DELNEIGH);
 	call_rcu(&f->rcu, fdb_rcu_free);
 }
@@ -281,6 +282,33 @@ struct net_bridge_fdb_entry *__br_fdb_get(struct net_bridge *br,
 	return NULL;
 }
 
+/* Hot-path variant of __br_fdb_get for the forwarding path: remembers
+ * the last hit per CPU, so back-to-back frames of a flow skip the hash
+ * walk entirely.  The cached entry is only dereferenced while
+ * br->fdb_gen is unchanged, which guarantees no fdb has been deleted
+ * since it was cached.  Softirq context, caller has rcu_read_lock.
+ */
+struct net_bridge_fdb_entry *br_fdb_get_cached(struct net_bridge *br,
+					       const unsigned char *addr,
+					       __u16 vid)
+{
+	struct br_fdb_cache *cache = this_cpu_ptr(br->fdb_cache);
+	unsigned long gen = ACCESS_ONCE(br->fdb_gen);
+	struct net_bridge_fdb_entry *fdb = cache->fdb;
+
+	if (fdb && cache->gen == gen &&
+	    ether_addr_equal(fdb->addr.addr, addr) &&
+	    fdb->vlan_id == vid && !has_expired(br, fdb))
+		return fdb;
+
+	fdb = __br_fdb_get(br, addr, vid);
+	if (fdb) {
+		cache->fdb = fdb;
+		cache->gen = gen;
+	}
+	return fdb;
+}
+
 #if IS_ENABLED(CONFIG_ATM_LANE)
 /* Interface used by ATM LANE hook to test
  * if an addr is on some other bridge port */
@@ -110,7 +110,7 @@ int br_handle_frame_finish(struct sk_buff *skb)
 			skb2 = skb;
 
 		br->dev->stats.multicast++;
-	} else if ((dst = __br_fdb_get(br, dest, vid)) &&
+	} else if ((dst = br_fdb_get_cached(br, dest, vid)) &&
 			dst->is_local) {
 		skb2 = skb;
 		/* Do not forward the packet since it's local. */
@@ -93,6 +93,14 @@ struct net_bridge_fdb_entry
 	__u16				vlan_id;
 };
 
+/* per-CPU cache of the last forwarding-path fdb lookup; any removal
+ * from the table bumps br->fdb_gen and so invalidates it
+ */
+struct br_fdb_cache {
+	struct net_bridge_fdb_entry	*fdb;
+	unsigned long			gen;
+};
+
 struct net_bridge_port_group {
 	struct net_bridge_port		*port;
 	struct net_bridge_port_group __rcu *next;
@@ -212,6 +220,8 @@ struct net_bridge
 	struct br_cpu_netstats __percpu *stats;
 	spinlock_t			hash_lock;
 	struct hlist_head		hash[BR_HASH_SIZE];
+	struct br_fdb_cache __percpu	*fdb_cache;
+	unsigned long			fdb_gen;
 #ifdef CONFIG_BRIDGE_NETFILTER
 	struct rtable 			fake_rtable;
 	bool				nf_call_iptables;
@@ -379,6 +389,9 @@ extern void br_fdb_delete_by_port(struct net_bridge *br,
 extern struct net_bridge_fdb_entry *__br_fdb_get(struct net_bridge *br,
 						 const unsigned char *addr,
 						 __u16 vid);
+extern struct net_bridge_fdb_entry *br_fdb_get_cached(struct net_bridge *br,
+						      const unsigned char *addr,
+						      __u16 vid);
 extern int br_fdb_test_addr(struct net_device *dev, unsigned char *addr);
 extern int br_fdb_fillbuf(struct net_bridge *br, void *buf,
 			  unsigned long count, unsigned long off);
@@ -80,7 +80,7 @@ static int receiver_wake_function(wait_queue_t *wait, unsigned int mode, int syn
 /*
  * Wait for a packet..
  */
-static int wait_for_packet(struct sock *sk, int *err, long *timeo_p)
+int __skb_wait_for_packet(struct sock *sk, int *err, long *timeo_p)
 {
 	int error;
 	DEFINE_WAIT_FUNC(wait, receiver_wake_function);
@@ -126,6 +126,7 @@ out_noerr:
 	error = 1;
 	goto out;
 }
+EXPORT_SYMBOL(__skb_wait_for_packet);
 
 /**
  *	__skb_recv_datagram - Receive a datagram skbuff
@@ -206,7 +207,7 @@ struct sk_buff *__skb_recv_datagram(struct sock *sk, unsigned int flags,
 		if (!timeo)
 			goto no_packet;
 
-	} while (!wait_for_packet(sk, err, &timeo));
+	} while (!__skb_wait_for_packet(sk, err, &timeo));
 
 	return NULL;
 
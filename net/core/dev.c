@@ -2101,6 +2101,46 @@ void dev_kfree_skb_irq(struct sk_buff *skb)
 }
 EXPORT_SYMBOL(dev_kfree_skb_irq);
 
+/**
+ *	dev_kfree_skb_irq_bulk - defer freeing a batch of skbs
+ *	@skbs: array of buffers to free, entries may be NULL
+ *	@count: number of entries in the array
+ *
+ *	Functions as dev_kfree_skb_irq() for every buffer in the batch,
+ *	but the whole batch is spliced onto the completion queue under a
+ *	single irq-save/restore with one softirq raise, instead of
+ *	paying that cost per skb.
+ */
+void dev_kfree_skb_irq_bulk(struct sk_buff **skbs, unsigned int count)
+{
+	struct sk_buff *head = NULL, *tail = NULL;
+	struct softnet_data *sd;
+	unsigned long flags;
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		struct sk_buff *skb = skbs[i];
+
+		if (!skb || !atomic_dec_and_test(&skb->users))
+			continue;
+		skb->next = head;
+		head = skb;
+		if (!tail)
+			tail = skb;
+	}
+
+	if (!head)
+		return;
+
+	local_irq_save(flags);
+	sd = &__get_cpu_var(softnet_data);
+	tail->next = sd->completion_queue;
+	sd->completion_queue = head;
+	raise_softirq_irqoff(NET_TX_SOFTIRQ);
+	local_irq_restore(flags);
+}
+EXPORT_SYMBOL(dev_kfree_skb_irq_bulk);
+
 void dev_kfree_skb_any(struct sk_buff *skb)
 {
 	if (in_irq() || irqs_disabled())
@@ -2839,6 +2879,7 @@ struct rps_sock_flow_table __rcu *rps_sock_flow_table __read_mostly;
 EXPORT_SYMBOL(rps_sock_flow_table);
 
 struct static_key rps_needed __read_mostly;
+EXPORT_SYMBOL(rps_needed);
 
 static struct rps_dev_flow *
 set_rps_cpu(struct net_device *dev, struct sk_buff *skb,
@@ -3232,6 +3273,20 @@ EXPORT_SYMBOL_GPL(br_fdb_test_addr_hook);
 #endif
 
 #ifdef CONFIG_NET_CLS_ACT
+static struct static_key ingress_needed __read_mostly;
+
+void net_inc_ingress_queue(void)
+{
+	static_key_slow_inc(&ingress_needed);
+}
+EXPORT_SYMBOL_GPL(net_inc_ingress_queue);
+
+void net_dec_ingress_queue(void)
+{
+	static_key_slow_dec(&ingress_needed);
+}
+EXPORT_SYMBOL_GPL(net_dec_ingress_queue);
+
 /* TODO: Maybe we should just force sch_ingress to be compiled in
  * when CONFIG_NET_CLS_ACT is? otherwise some useless instructions
  * a compare and 2 stores extra right now if we dont have it on
@@ -3424,9 +3479,13 @@ another_round:
 
 skip_taps:
 #ifdef CONFIG_NET_CLS_ACT
-	skb = handle_ing(skb, &pt_prev, &ret, orig_dev);
-	if (!skb)
-		goto unlock;
+	if (static_key_false(&ingress_needed)) {
+		skb = handle_ing(skb, &pt_prev, &ret, orig_dev);
+		if (!skb)
+			goto unlock;
+	}
+
+	skb->tc_verd = 0;
 ncls:
 #endif
 
@@ -198,6 +198,7 @@
 #define F_QUEUE_MAP_RND (1<<13)	/* queue map Random */
 #define F_QUEUE_MAP_CPU (1<<14)	/* queue map mirrors smp_processor_id() */
 #define F_NODE          (1<<15)	/* Node memory alloc*/
+#define F_REQUEUE       (1<<16)	/* Resend clones via ndo_tx_requeue */
 
 /* Thread control flag bits */
 #define T_STOP        (1<<0)	/* Stop run */
@@ -667,6 +668,9 @@ static int pktgen_if_show(struct seq_file *seq, void *v)
 	if (pkt_dev->flags & F_NODE)
 		seq_printf(seq, "NODE_ALLOC  ");
 
+	if (pkt_dev->flags & F_REQUEUE)
+		seq_printf(seq, "REQUEUE  ");
+
 	seq_puts(seq, "\n");
 
 	/* not really stopped, more like last-running-at */
@@ -1228,12 +1232,18 @@ static ssize_t pktgen_if_write(struct file *file,
 		else if (strcmp(f, "!NODE_ALLOC") == 0)
 			pkt_dev->flags &= ~F_NODE;
 
+		else if (strcmp(f, "REQUEUE") == 0)
+			pkt_dev->flags |= F_REQUEUE;
+
+		else if (strcmp(f, "!REQUEUE") == 0)
+			pkt_dev->flags &= ~F_REQUEUE;
+
 		else {
 			sprintf(pg_result,
 				"Flag -:%s:- unknown\nAvailable flags, (prepend ! to un-set flag):\n%s",
 				f,
 				"IPSRC_RND, IPDST_RND, UDPSRC_RND, UDPDST_RND, "
-				"MACSRC_RND, MACDST_RND, TXSIZE_RND, IPV6, MPLS_RND, VID_RND, SVID_RND, FLOW_SEQ, IPSEC, NODE_ALLOC\n");
+				"MACSRC_RND, MACDST_RND, TXSIZE_RND, IPV6, MPLS_RND, VID_RND, SVID_RND, FLOW_SEQ, IPSEC, NODE_ALLOC, REQUEUE\n");
 			return count;
 		}
 		sprintf(pg_result, "OK: flags=0x%x", pkt_dev->flags);
@@ -3241,6 +3251,15 @@ static void pktgen_xmit(struct pktgen_dev *pkt_dev)
 	if (pkt_dev->delay && pkt_dev->last_ok)
 		spin(pkt_dev, pkt_dev->next_tx);
 
+	/* Clone rounds resend the same payload untouched. When the driver
+	 * provides the requeue hook, everything after the first transmit of
+	 * an skb can skip the per-packet DMA mapping and cache maintenance
+	 * and is reduced to refilling the hardware descriptor ring.
+	 */
+	if ((pkt_dev->flags & F_REQUEUE) && pkt_dev->clone_count > 0 &&
+	    odev->netdev_ops->ndo_tx_requeue)
+		xmit = odev->netdev_ops->ndo_tx_requeue;
+
 	queue_map = skb_get_queue_mapping(pkt_dev->skb);
 	txq = netdev_get_tx_queue(odev, queue_map);
 
@@ -338,9 +338,14 @@ struct netdev_alloc_cache {
 	 * containing page->_count every time we allocate a fragment.
 	 */
 	unsigned int		pagecnt_bias;
+	/* order-0 spares, bulk allocated once high order pages run out */
+	struct list_head	spare_pages;
 };
 static DEFINE_PER_CPU(struct netdev_alloc_cache, netdev_alloc_cache);
 
+/* how many order-0 pages to pull from the allocator in one trip */
+#define NETDEV_FRAG_SPARE_BULK	8
+
 static void *__netdev_alloc_frag(unsigned int fragsz, gfp_t gfp_mask)
 {
 	struct netdev_alloc_cache *nc;
@@ -350,17 +355,34 @@ static void *__netdev_alloc_frag(unsigned int fragsz, gfp_t gfp_mask)
 
 	local_irq_save(flags);
 	nc = &__get_cpu_var(netdev_alloc_cache);
+	if (unlikely(!nc->spare_pages.next))
+		INIT_LIST_HEAD(&nc->spare_pages);
 	if (unlikely(!nc->frag.page)) {
 refill:
-		for (order = NETDEV_FRAG_PAGE_MAX_ORDER; ;) {
-			gfp_t gfp = gfp_mask;
-
-			if (order)
-				gfp |= __GFP_COMP | __GFP_NOWARN;
-			nc->frag.page = alloc_pages(gfp, order);
+		for (order = NETDEV_FRAG_PAGE_MAX_ORDER; order; order--) {
+			nc->frag.page = alloc_pages(gfp_mask | __GFP_COMP |
+						    __GFP_NOWARN, order);
 			if (likely(nc->frag.page))
 				break;
-			if (--order < 0)
+		}
+		if (!nc->frag.page) {
+			/*
+			 * Memory is too fragmented for a big frag page and
+			 * every buffer now costs an order-0 allocation, so
+			 * amortize the zone lock over a batch of spares.
+			 */
+			if (list_empty(&nc->spare_pages) &&
+			    !alloc_pages_bulk(gfp_mask | __GFP_NOWARN,
+					      NETDEV_FRAG_SPARE_BULK,
+					      &nc->spare_pages))
+				nc->frag.page = alloc_pages(gfp_mask, 0);
+			if (!list_empty(&nc->spare_pages)) {
+				nc->frag.page = list_entry(
+						nc->spare_pages.next,
+						struct page, lru);
+				list_del(&nc->frag.page->lru);
+			}
+			if (!nc->frag.page)
 				goto end;
 		}
 		nc->frag.size = PAGE_SIZE << order;
@@ -664,6 +686,48 @@ void consume_skb(struct sk_buff *skb)
 }
 EXPORT_SYMBOL(consume_skb);
 
+/**
+ *	consume_skb_bulk - free a batch of skbuffs
+ *	@skbs: array of buffers to free, entries may be NULL
+ *	@count: number of entries in the array
+ *
+ *	Functions as consume_skb() for every buffer in the batch. The
+ *	attached state of all buffers is released first and the plain
+ *	heads then go back to the skbuff cache back to back, so the
+ *	cache's per-cpu structures are touched once per batch instead of
+ *	once per packet. Intended for TX completion paths that reclaim
+ *	whole rings at a time. Must not be called from hard interrupt
+ *	context; use dev_kfree_skb_irq_bulk() there.
+ */
+void consume_skb_bulk(struct sk_buff **skbs, unsigned int count)
+{
+	unsigned int heads = 0;
+	unsigned int i;
+
+	for (i = 0; i < count; i++) {
+		struct sk_buff *skb = skbs[i];
+
+		if (unlikely(!skb))
+			continue;
+		if (likely(atomic_read(&skb->users) == 1))
+			smp_rmb();
+		else if (likely(!atomic_dec_and_test(&skb->users)))
+			continue;
+		trace_consume_skb(skb);
+		skb_release_all(skb);
+
+		/* Clones and fclones take the stateful slow path */
+		if (likely(skb->fclone == SKB_FCLONE_UNAVAILABLE))
+			skbs[heads++] = skb;
+		else
+			kfree_skbmem(skb);
+	}
+
+	for (i = 0; i < heads; i++)
+		kmem_cache_free(skbuff_head_cache, skbs[i]);
+}
+EXPORT_SYMBOL(consume_skb_bulk);
+
 static void __copy_skb_header(struct sk_buff *new, const struct sk_buff *old)
 {
 	new->tstamp		= old->tstamp;
@@ -52,6 +52,7 @@
 
 #include <asm/uaccess.h>
 #include <linux/bitops.h>
+#include <linux/hash.h>
 #include <linux/types.h>
 #include <linux/kernel.h>
 #include <linux/mm.h>
@@ -1411,6 +1412,98 @@ static int check_leaf(struct fib_table *tb, struct trie *t, struct leaf *l,
 	return 1;
 }
 
+/* Small per-cpu cache of recent lookup results, indexed by destination.
+ * Entries carry the rt_genid they were filled under and go stale on the
+ * same genid bump that route changes already issue, so no new
+ * invalidation hooks are needed; fib_free_table() drops everything so a
+ * cached table or netns pointer can never outlive its owner.  Cached
+ * results hold no reference of their own: a hit is only served when the
+ * genid still matches, in which case the fib_info is pinned by the table
+ * (and by RCU against a racing delete), exactly like a fresh trie walk.
+ *
+ * A route change racing an in-flight lookup can leave one entry stale
+ * until the next genid bump, which is the same window the old route
+ * cache had.
+ */
+#define FIB_RES_CACHE_SHIFT	3
+#define FIB_RES_CACHE_SIZE	(1 << FIB_RES_CACHE_SHIFT)
+
+struct fib_res_cache_ent {
+	struct fib_table	*tb;
+	struct net		*net;
+	int			genid;
+	__be32			daddr;
+	int			oif;
+	u8			tos;
+	u8			scope;
+	struct fib_result	res;
+};
+
+static DEFINE_PER_CPU(struct fib_res_cache_ent, fib_res_cache[FIB_RES_CACHE_SIZE]);
+
+static struct fib_res_cache_ent *fib_res_cache_slot(__be32 daddr)
+{
+	return this_cpu_ptr(&fib_res_cache[hash_32((__force u32)daddr,
+						   FIB_RES_CACHE_SHIFT)]);
+}
+
+/* Caller must hold rcu_read_lock() */
+static bool fib_res_cache_lookup(struct fib_table *tb, const struct flowi4 *flp,
+				 struct fib_result *res, int fib_flags)
+{
+	struct fib_res_cache_ent *ent;
+	bool hit = false;
+
+	local_bh_disable();
+	ent = fib_res_cache_slot(flp->daddr);
+	if (ent->tb == tb && ent->daddr == flp->daddr &&
+	    ent->oif == flp->flowi4_oif && ent->tos == flp->flowi4_tos &&
+	    ent->scope == flp->flowi4_scope &&
+	    ent->genid == rt_genid(ent->net)) {
+		*res = ent->res;
+		if (!(fib_flags & FIB_LOOKUP_NOREF))
+			atomic_inc(&res->fi->fib_clntref);
+		hit = true;
+	}
+	local_bh_enable();
+	return hit;
+}
+
+static void fib_res_cache_insert(struct fib_table *tb, const struct flowi4 *flp,
+				 const struct fib_result *res)
+{
+	struct fib_res_cache_ent *ent;
+	struct net *net;
+
+	if (!res->fi)
+		return;
+	net = res->fi->fib_net;
+
+	local_bh_disable();
+	ent = fib_res_cache_slot(flp->daddr);
+	ent->tb = tb;
+	ent->net = net;
+	ent->genid = rt_genid(net);
+	ent->daddr = flp->daddr;
+	ent->oif = flp->flowi4_oif;
+	ent->tos = flp->flowi4_tos;
+	ent->scope = flp->flowi4_scope;
+	ent->res = *res;
+	local_bh_enable();
+}
+
+static void fib_res_cache_flush(void)
+{
+	int cpu, i;
+
+	for_each_possible_cpu(cpu) {
+		struct fib_res_cache_ent *ent = per_cpu(fib_res_cache, cpu);
+
+		for (i = 0; i < FIB_RES_CACHE_SIZE; i++)
+			ent[i].tb = NULL;
+	}
+}
+
 int fib_table_lookup(struct fib_table *tb, const struct flowi4 *flp,
 		     struct fib_result *res, int fib_flags)
 {
@@ -1428,6 +1521,11 @@ int fib_table_lookup(struct fib_table *tb, const struct flowi4 *flp,
 
 	rcu_read_lock();
 
+	if (fib_res_cache_lookup(tb, flp, res, fib_flags)) {
+		rcu_read_unlock();
+		return 0;
+	}
+
 	n = rcu_dereference(t->trie);
 	if (!n)
 		goto failed;
@@ -1471,6 +1569,15 @@ int fib_table_lookup(struct fib_table *tb, const struct flowi4 *flp,
 
 		cn = (struct tnode *)n;
 
+		/* Overlap the validation work below with fetching the child
+		 * we will most likely descend to next, hiding part of the
+		 * dependent-miss chain of the descent.  If the validation
+		 * backtracks instead, the prefetch is merely wasted.
+		 */
+		prefetch(tnode_get_child_rcu(cn,
+				tkey_extract_bits(mask_pfx(key, current_prefix_length),
+						  cn->pos, cn->bits)));
+
 		/*
 		 * It's a tnode, and we can do some extra checks here if we
 		 * like, to avoid descending into a dead-end branch.
@@ -1600,6 +1707,8 @@ backtrace:
 failed:
 	ret = 1;
 found:
+	if (!ret)
+		fib_res_cache_insert(tb, flp, res);
 	rcu_read_unlock();
 	return ret;
 }
@@ -1848,6 +1957,7 @@ int fib_table_flush(struct fib_table *tb)
 
 void fib_free_table(struct fib_table *tb)
 {
+	fib_res_cache_flush();
 	kfree(tb);
 }
 
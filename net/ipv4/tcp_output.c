@@ -979,6 +979,18 @@ static void tcp_wfree(struct sk_buff *skb)
 	}
 }
 
+/* TSQ budget for this socket: the output device may provide its own,
+ * sized to its TX ring, otherwise the sysctl applies.
+ */
+static u32 tcp_limit_output_bytes(const struct sock *sk)
+{
+	const struct dst_entry *dst = __sk_dst_get(sk);
+
+	if (dst && dst->dev && dst->dev->tsq_limit_output)
+		return dst->dev->tsq_limit_output;
+	return sysctl_tcp_limit_output_bytes;
+}
+
 /* This routine actually transmits TCP packets queued in by
  * tcp_do_sendmsg().  This is used by both the initial
  * transmission and possible later retransmissions.
@@ -1043,7 +1055,7 @@ static int tcp_transmit_skb(struct sock *sk, struct sk_buff *skb, int clone_it,
 
 	skb_orphan(skb);
 	skb->sk = sk;
-	skb->destructor = (sysctl_tcp_limit_output_bytes > 0) ?
+	skb->destructor = (tcp_limit_output_bytes(sk) > 0) ?
 			  tcp_wfree : sock_wfree;
 	atomic_add(skb->truesize, &sk->sk_wmem_alloc);
 
@@ -2015,7 +2027,7 @@ static bool tcp_write_xmit(struct sock *sk, unsigned int mss_now, int nonagle,
 		/* TSQ : sk_wmem_alloc accounts skb truesize,
 		 * including skb overhead. But thats OK.
 		 */
-		if (atomic_read(&sk->sk_wmem_alloc) >= sysctl_tcp_limit_output_bytes) {
+		if (atomic_read(&sk->sk_wmem_alloc) >= tcp_limit_output_bytes(sk)) {
 			set_bit(TSQ_THROTTLED, &tp->tsq_flags);
 			break;
 		}
@@ -77,6 +77,11 @@ EXPORT_PER_CPU_SYMBOL(nf_conntrack_untracked);
 unsigned int nf_conntrack_hash_rnd __read_mostly;
 EXPORT_SYMBOL_GPL(nf_conntrack_hash_rnd);
 
+/* Invalidates the per-cpu lookup cache below; bumped under
+ * nf_conntrack_lock whenever an entry leaves the hash.
+ */
+static atomic_t nf_ct_cache_gen = ATOMIC_INIT(0);
+
 static u32 hash_conntrack_raw(const struct nf_conntrack_tuple *tuple, u16 zone)
 {
 	unsigned int n;
@@ -189,6 +194,8 @@ clean_from_lists(struct nf_conn *ct)
 	pr_debug("clean_from_lists(%p)\n", ct);
 	hlist_nulls_del_rcu(&ct->tuplehash[IP_CT_DIR_ORIGINAL].hnnode);
 	hlist_nulls_del_rcu(&ct->tuplehash[IP_CT_DIR_REPLY].hnnode);
+	/* stop the per-cpu lookup cache from serving this entry */
+	atomic_inc(&nf_ct_cache_gen);
 
 	/* Destroy all pending expectations */
 	nf_ct_remove_expectations(ct);
@@ -361,6 +368,105 @@ __nf_conntrack_find(struct net *net, u16 zone,
 }
 EXPORT_SYMBOL_GPL(__nf_conntrack_find);
 
+/* Per-cpu cache of recently used entries.  Bursty flows take their
+ * conntrack straight from here and skip the hash bucket walk.  Each
+ * slot pins its entry with a reference and records the value of a
+ * global generation counter; the counter is bumped whenever an entry
+ * leaves the hash, so a slot stamped before any deletion simply stops
+ * matching and a deleted flow (possibly re-linked onto the dying list
+ * for destroy-event retransmission, with IPS_DYING still clear) can
+ * never be resurrected from the cache.  A hit additionally repeats
+ * the tuple/zone recheck the hash walk does; nothing on the hit path
+ * takes a lock.  Stale slots are evicted lazily by replacement and
+ * dropped wholesale on netns cleanup.
+ */
+#define NF_CT_CACHE_SIZE	8
+#define NF_CT_CACHE_MASK	(NF_CT_CACHE_SIZE - 1)
+
+struct nf_ct_cache_ent {
+	u32				hash;
+	int				gen;
+	struct nf_conntrack_tuple_hash	*h;
+};
+
+static DEFINE_PER_CPU(struct nf_ct_cache_ent, nf_ct_cache[NF_CT_CACHE_SIZE]);
+
+/* Caller must hold rcu_read_lock(): a remote flush may drop the cached
+ * reference under us, and only SLAB_DESTROY_BY_RCU plus the
+ * atomic_inc_not_zero()/recheck dance keeps the dereference safe.
+ */
+static struct nf_conntrack_tuple_hash *
+nf_ct_cache_lookup(struct net *net, u16 zone,
+		   const struct nf_conntrack_tuple *tuple, u32 hash)
+{
+	struct nf_ct_cache_ent *ent;
+	struct nf_conntrack_tuple_hash *h;
+	struct nf_conn *ct;
+
+	local_bh_disable();
+	ent = this_cpu_ptr(&nf_ct_cache[hash & NF_CT_CACHE_MASK]);
+	h = ACCESS_ONCE(ent->h);
+	if (!h || ent->hash != hash ||
+	    ent->gen != atomic_read(&nf_ct_cache_gen))
+		goto miss;
+	ct = nf_ct_tuplehash_to_ctrack(h);
+	if (unlikely(nf_ct_is_dying(ct) ||
+		     !atomic_inc_not_zero(&ct->ct_general.use)))
+		goto miss;
+	if (unlikely(!nf_ct_tuple_equal(tuple, &h->tuple) ||
+		     nf_ct_zone(ct) != zone ||
+		     !net_eq(net, nf_ct_net(ct)))) {
+		nf_ct_put(ct);
+		goto miss;
+	}
+	NF_CT_STAT_INC(net, found);
+	local_bh_enable();
+	return h;
+miss:
+	local_bh_enable();
+	return NULL;
+}
+
+/* Slot replacement uses xchg() so the owning cpu and a remote flusher
+ * can never drop the same cached reference twice.  Lookup and insert
+ * only touch the local cpu's slots with BHs off, so the hash hint and
+ * the pointer cannot be seen mispaired.
+ */
+static void nf_ct_cache_insert(struct nf_conntrack_tuple_hash *h, u32 hash)
+{
+	struct nf_ct_cache_ent *ent;
+	struct nf_conntrack_tuple_hash *old;
+
+	nf_conntrack_get(&nf_ct_tuplehash_to_ctrack(h)->ct_general);
+	local_bh_disable();
+	ent = this_cpu_ptr(&nf_ct_cache[hash & NF_CT_CACHE_MASK]);
+	ent->hash = hash;
+	/* A deletion between this read and the packet that hits the slot
+	 * invalidates it, which errs on the side of a spurious miss.
+	 */
+	ent->gen = atomic_read(&nf_ct_cache_gen);
+	old = xchg(&ent->h, h);
+	local_bh_enable();
+	if (old)
+		nf_ct_put(nf_ct_tuplehash_to_ctrack(old));
+}
+
+static void nf_ct_cache_flush(void)
+{
+	struct nf_conntrack_tuple_hash *old;
+	int cpu, i;
+
+	for_each_possible_cpu(cpu) {
+		struct nf_ct_cache_ent *ent = per_cpu(nf_ct_cache, cpu);
+
+		for (i = 0; i < NF_CT_CACHE_SIZE; i++) {
+			old = xchg(&ent[i].h, NULL);
+			if (old)
+				nf_ct_put(nf_ct_tuplehash_to_ctrack(old));
+		}
+	}
+}
+
 /* Find a connection corresponding to a tuple. */
 static struct nf_conntrack_tuple_hash *
 __nf_conntrack_find_get(struct net *net, u16 zone,
@@ -370,6 +476,11 @@ __nf_conntrack_find_get(struct net *net, u16 zone,
 	struct nf_conn *ct;
 
 	rcu_read_lock();
+	h = nf_ct_cache_lookup(net, zone, tuple, hash);
+	if (h) {
+		rcu_read_unlock();
+		return h;
+	}
 begin:
 	h = ____nf_conntrack_find(net, zone, tuple, hash);
 	if (h) {
@@ -383,6 +494,7 @@ begin:
 				nf_ct_put(ct);
 				goto begin;
 			}
+			nf_ct_cache_insert(h, hash);
 		}
 	}
 	rcu_read_unlock();
@@ -924,6 +1036,21 @@ resolve_normal_ct(struct net *net, struct nf_conn *tmpl,
 	return ct;
 }
 
+/* Controlled by the bridged_exempt module parameter.  When enabled,
+ * frames that reach conntrack through br_netfilter bypass connection
+ * tracking entirely and are handed back untracked, so loading NAT
+ * rules for the uplink does not tax bridged LAN forwarding.  Keying
+ * on skb->nf_bridge is the only reliable test: by PRE_ROUTING,
+ * br_netfilter's setup_pre_routing() has already replaced skb->dev
+ * with the bridge master, so the port device flags are out of reach.
+ * Note the bypass covers everything arriving on a bridge port,
+ * including traffic that will be routed or delivered locally, so it
+ * is only for setups whose uplink is a separate non-bridged
+ * interface.  Traffic entering elsewhere is unaffected.
+ */
+static struct static_key nf_ct_bridged_exempt_key = STATIC_KEY_INIT_FALSE;
+static unsigned int nf_ct_bridged_exempt __read_mostly;
+
 unsigned int
 nf_conntrack_in(struct net *net, u_int8_t pf, unsigned int hooknum,
 		struct sk_buff *skb)
@@ -938,6 +1065,17 @@ nf_conntrack_in(struct net *net, u_int8_t pf, unsigned int hooknum,
 	int set_reply = 0;
 	int ret;
 
+#ifdef CONFIG_BRIDGE_NETFILTER
+	if (static_key_false(&nf_ct_bridged_exempt_key) && !skb->nfct &&
+	    skb->nf_bridge) {
+		skb->nfct = &nf_ct_untracked_get()->ct_general;
+		skb->nfctinfo = IP_CT_NEW;
+		nf_conntrack_get(skb->nfct);
+		NF_CT_STAT_INC_ATOMIC(net, ignore);
+		return NF_ACCEPT;
+	}
+#endif
+
 	if (skb->nfct) {
 		/* Previously seen (loopback or untracked)?  Ignore. */
 		tmpl = (struct nf_conn *)skb->nfct;
@@ -1371,6 +1509,7 @@ void nf_conntrack_cleanup_net(struct net *net)
 	 */
 	synchronize_net();
  i_see_dead_people:
+	nf_ct_cache_flush();
 	nf_ct_iterate_cleanup(net, kill_all, NULL);
 	nf_ct_release_dying_list(net);
 	if (atomic_read(&net->ct.count) != 0) {
@@ -1471,6 +1610,31 @@ EXPORT_SYMBOL_GPL(nf_conntrack_set_hashsize);
 module_param_call(hashsize, nf_conntrack_set_hashsize, param_get_uint,
 		  &nf_conntrack_htable_size, 0600);
 
+static int nf_conntrack_set_bridged_exempt(const char *val,
+					   struct kernel_param *kp)
+{
+	unsigned int on;
+	int rc;
+
+	rc = kstrtouint(val, 0, &on);
+	if (rc)
+		return rc;
+	if (on > 1)
+		return -EINVAL;
+
+	if (on == nf_ct_bridged_exempt)
+		return 0;
+	if (on)
+		static_key_slow_inc(&nf_ct_bridged_exempt_key);
+	else
+		static_key_slow_dec(&nf_ct_bridged_exempt_key);
+	nf_ct_bridged_exempt = on;
+	return 0;
+}
+
+module_param_call(bridged_exempt, nf_conntrack_set_bridged_exempt,
+		  param_get_uint, &nf_ct_bridged_exempt, 0600);
+
 void nf_ct_untracked_status_or(unsigned long bits)
 {
 	int cpu;
@@ -340,9 +340,13 @@ static void unix_write_space(struct sock *sk)
  * may receive messages only from that peer. */
 static void unix_dgram_disconnected(struct sock *sk, struct sock *other)
 {
-	if (!skb_queue_empty(&sk->sk_receive_queue)) {
+	struct unix_sock *u = unix_sk(sk);
+
+	if (!skb_queue_empty(&sk->sk_receive_queue) ||
+	    !skb_queue_empty(&u->prequeue)) {
 		skb_queue_purge(&sk->sk_receive_queue);
-		wake_up_interruptible_all(&unix_sk(sk)->peer_wait);
+		skb_queue_purge(&u->prequeue);
+		wake_up_interruptible_all(&u->peer_wait);
 
 		/* If one link of bidirectional dgram pipe is disconnected,
 		 * we signal error. Messages are lost. Do not make this,
@@ -360,6 +364,7 @@ static void unix_sock_destructor(struct sock *sk)
 	struct unix_sock *u = unix_sk(sk);
 
 	skb_queue_purge(&sk->sk_receive_queue);
+	skb_queue_purge(&u->prequeue);
 
 	WARN_ON(atomic_read(&sk->sk_wmem_alloc));
 	WARN_ON(!sk_unhashed(sk));
@@ -424,6 +429,9 @@ static void unix_release_sock(struct sock *sk, int embrion)
 
 	/* Try to flush out this socket. Throw out buffers at least */
 
+	/* the prequeue only ever holds datagrams, never embryos */
+	skb_queue_purge(&u->prequeue);
+
 	while ((skb = skb_dequeue(&sk->sk_receive_queue)) != NULL) {
 		if (state == TCP_LISTEN)
 			unix_release_sock(skb->sk, 1);
@@ -646,6 +654,7 @@ static struct sock *unix_create1(struct net *net, struct socket *sock)
 	atomic_long_set(&u->inflight, 0);
 	INIT_LIST_HEAD(&u->link);
 	mutex_init(&u->readlock); /* single task reading lock */
+	skb_queue_head_init(&u->prequeue);
 	init_waitqueue_head(&u->peer_wait);
 	unix_insert_socket(unix_sockets_unbound(sk), sk);
 out:
@@ -1759,6 +1768,55 @@ static void unix_copy_addr(struct msghdr *msg, struct sock *sk)
 	}
 }
 
+/*
+ * Pull one datagram off the socket, amortising the receive-queue lock
+ * over whole-queue drains.  u->readlock guarantees a single consumer,
+ * so pending datagrams can be spliced wholesale onto the private
+ * prequeue in one lock round trip and then served from there without
+ * contending with producers again until the batch is exhausted.  The
+ * walk mirrors __skb_recv_datagram() so MSG_PEEK and SO_PEEK_OFF keep
+ * their exact semantics (the prequeue is logically the front of the
+ * receive queue); an empty prequeue falls back to __skb_recv_datagram()
+ * which handles blocking and error reporting.
+ *
+ * Spliced datagrams no longer count against sk_max_ack_backlog, so
+ * peak buffering between a send burst and the draining reader can
+ * transiently reach twice the configured backlog.
+ */
+static struct sk_buff *unix_dgram_dequeue(struct sock *sk, unsigned int flags,
+					  int *peeked, int *off, int *err)
+{
+	struct sk_buff_head *pq = &unix_sk(sk)->prequeue;
+	unsigned long cpu_flags;
+	struct sk_buff *skb;
+
+	spin_lock_irqsave(&pq->lock, cpu_flags);
+	if (skb_queue_empty(pq)) {
+		/* nests inside the prequeue lock; the receive queue has
+		 * its own lock class (see unix_create1()) */
+		spin_lock(&sk->sk_receive_queue.lock);
+		skb_queue_splice_tail_init(&sk->sk_receive_queue, pq);
+		spin_unlock(&sk->sk_receive_queue.lock);
+	}
+	skb_queue_walk(pq, skb) {
+		*peeked = skb->peeked;
+		if (flags & MSG_PEEK) {
+			if (*off >= skb->len && skb->len) {
+				*off -= skb->len;
+				continue;
+			}
+			skb->peeked = 1;
+			atomic_inc(&skb->users);
+		} else
+			__skb_unlink(skb, pq);
+		spin_unlock_irqrestore(&pq->lock, cpu_flags);
+		return skb;
+	}
+	spin_unlock_irqrestore(&pq->lock, cpu_flags);
+
+	return __skb_recv_datagram(sk, flags, peeked, off, err);
+}
+
 static int unix_dgram_recvmsg(struct kiocb *iocb, struct socket *sock,
 			      struct msghdr *msg, size_t size,
 			      int flags)
@@ -1786,7 +1844,7 @@ static int unix_dgram_recvmsg(struct kiocb *iocb, struct socket *sock,
 
 	skip = sk_peek_offset(sk, flags);
 
-	skb = __skb_recv_datagram(sk, flags, &peeked, &skip, &err);
+	skb = unix_dgram_dequeue(sk, flags, &peeked, &skip, &err);
 	if (!skb) {
 		unix_state_lock(sk);
 		/* Signal EOF on disconnected non-blocking SEQPACKET socket. */
@@ -2103,17 +2161,26 @@ long unix_inq_len(struct sock *sk)
 	if (sk->sk_state == TCP_LISTEN)
 		return -EINVAL;
 
+	/* the prequeue is logically the front of the receive queue and
+	 * its lock nests outside sk_receive_queue.lock, see
+	 * unix_dgram_dequeue() */
+	spin_lock(&unix_sk(sk)->prequeue.lock);
 	spin_lock(&sk->sk_receive_queue.lock);
 	if (sk->sk_type == SOCK_STREAM ||
 	    sk->sk_type == SOCK_SEQPACKET) {
+		skb_queue_walk(&unix_sk(sk)->prequeue, skb)
+			amount += skb->len;
 		skb_queue_walk(&sk->sk_receive_queue, skb)
 			amount += skb->len;
 	} else {
-		skb = skb_peek(&sk->sk_receive_queue);
+		skb = skb_peek(&unix_sk(sk)->prequeue);
+		if (!skb)
+			skb = skb_peek(&sk->sk_receive_queue);
 		if (skb)
 			amount = skb->len;
 	}
 	spin_unlock(&sk->sk_receive_queue.lock);
+	spin_unlock(&unix_sk(sk)->prequeue.lock);
 
 	return amount;
 }
@@ -2203,7 +2270,8 @@ static unsigned int unix_dgram_poll(struct file *file, struct socket *sock,
 		mask |= POLLHUP;
 
 	/* readable? */
-	if (!skb_queue_empty(&sk->sk_receive_queue))
+	if (!skb_queue_empty(&sk->sk_receive_queue) ||
+	    !skb_queue_empty(&unix_sk(sk)->prequeue))
 		mask |= POLLIN | POLLRDNORM;
 
 	/* Connection-based need to check for termination and startup */
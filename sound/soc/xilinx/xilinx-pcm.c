@@ -0,0 +1,253 @@
+/*
+ * Xilinx ASoC platform (PCM DMA) driver
+ *
+ * Copyright (C) 2013 Xilinx, Inc.
+ *
+ * Streams audio between system memory and an AXI-Stream audio core in
+ * the PL through the cyclic mode of the AXI DMA engine. The DMA hardware
+ * recirculates a closed buffer descriptor ring over the ALSA ring buffer,
+ * so the period interrupt comes straight out of the per-period DMA
+ * completion and no data is ever copied in the kernel.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+
+#include <linux/device.h>
+#include <linux/dma-mapping.h>
+#include <linux/dmaengine.h>
+#include <linux/init.h>
+#include <linux/module.h>
+#include <linux/of.h>
+#include <linux/platform_device.h>
+#include <linux/slab.h>
+#include <linux/amba/xilinx_dma.h>
+
+#include <sound/core.h>
+#include <sound/pcm.h>
+#include <sound/pcm_params.h>
+#include <sound/soc.h>
+#include <sound/dmaengine_pcm.h>
+
+/*
+ * One AXI DMA engine feeds the I2S transmitter (MM2S) and one drains the
+ * receiver (S2MM); both are found through the match word the DMA driver
+ * leaves in chan->private: direction, IP type and the xlnx,device-id of
+ * the engine.
+ */
+struct xilinx_pcm_data {
+	u32 match[SNDRV_PCM_STREAM_LAST + 1];
+};
+
+static const struct snd_pcm_hardware xilinx_pcm_hardware = {
+	.info			= SNDRV_PCM_INFO_MMAP |
+				  SNDRV_PCM_INFO_MMAP_VALID |
+				  SNDRV_PCM_INFO_PAUSE |
+				  SNDRV_PCM_INFO_RESUME |
+				  SNDRV_PCM_INFO_INTERLEAVED |
+				  SNDRV_PCM_INFO_BATCH,
+	.formats		= SNDRV_PCM_FMTBIT_S16_LE |
+				  SNDRV_PCM_FMTBIT_S24_LE |
+				  SNDRV_PCM_FMTBIT_S32_LE,
+	.channels_min		= 2,
+	.channels_max		= 8,
+	.period_bytes_min	= 512,
+	.period_bytes_max	= 64 * 1024,
+	.periods_min		= 2,
+	.periods_max		= 64,
+	.buffer_bytes_max	= 512 * 1024,
+	.fifo_size		= 32,
+};
+
+static bool xilinx_pcm_filter(struct dma_chan *chan, void *param)
+{
+	return chan->private && *(u32 *)chan->private == *(u32 *)param;
+}
+
+static int xilinx_pcm_hw_params(struct snd_pcm_substream *substream,
+				struct snd_pcm_hw_params *params)
+{
+	snd_pcm_set_runtime_buffer(substream, &substream->dma_buffer);
+
+	return 0;
+}
+
+static int xilinx_pcm_open(struct snd_pcm_substream *substream)
+{
+	struct snd_soc_pcm_runtime *rtd = substream->private_data;
+	struct xilinx_pcm_data *pcm_data =
+		snd_soc_platform_get_drvdata(rtd->platform);
+	int ret;
+
+	ret = snd_dmaengine_pcm_open(substream, xilinx_pcm_filter,
+				&pcm_data->match[substream->stream]);
+	if (ret)
+		return ret;
+
+	snd_soc_set_runtime_hwparams(substream, &xilinx_pcm_hardware);
+
+	return 0;
+}
+
+static int xilinx_pcm_close(struct snd_pcm_substream *substream)
+{
+	snd_dmaengine_pcm_close(substream);
+
+	return 0;
+}
+
+static int xilinx_pcm_mmap(struct snd_pcm_substream *substream,
+			struct vm_area_struct *vma)
+{
+	struct snd_pcm_runtime *runtime = substream->runtime;
+
+	return dma_mmap_writecombine(substream->pcm->card->dev, vma,
+					runtime->dma_area,
+					runtime->dma_addr,
+					runtime->dma_bytes);
+}
+
+static struct snd_pcm_ops xilinx_pcm_ops = {
+	.open		= xilinx_pcm_open,
+	.close		= xilinx_pcm_close,
+	.ioctl		= snd_pcm_lib_ioctl,
+	.hw_params	= xilinx_pcm_hw_params,
+	.trigger	= snd_dmaengine_pcm_trigger,
+	/* The BD ring completes whole periods, the pointer moves in steps */
+	.pointer	= snd_dmaengine_pcm_pointer_no_residue,
+	.mmap		= xilinx_pcm_mmap,
+};
+
+static int xilinx_pcm_preallocate_dma_buffer(struct snd_pcm *pcm, int stream)
+{
+	struct snd_pcm_substream *substream = pcm->streams[stream].substream;
+	struct snd_dma_buffer *buf = &substream->dma_buffer;
+	size_t size = xilinx_pcm_hardware.buffer_bytes_max;
+
+	buf->dev.type = SNDRV_DMA_TYPE_DEV;
+	buf->dev.dev = pcm->card->dev;
+	buf->private_data = NULL;
+	buf->area = dma_alloc_writecombine(pcm->card->dev, size,
+					   &buf->addr, GFP_KERNEL);
+	if (!buf->area)
+		return -ENOMEM;
+	buf->bytes = size;
+
+	return 0;
+}
+
+static u64 xilinx_pcm_dmamask = DMA_BIT_MASK(32);
+
+static int xilinx_pcm_new(struct snd_soc_pcm_runtime *rtd)
+{
+	struct snd_card *card = rtd->card->snd_card;
+	struct snd_pcm *pcm = rtd->pcm;
+	int ret;
+
+	if (!card->dev->dma_mask)
+		card->dev->dma_mask = &xilinx_pcm_dmamask;
+	if (!card->dev->coherent_dma_mask)
+		card->dev->coherent_dma_mask = DMA_BIT_MASK(32);
+
+	if (pcm->streams[SNDRV_PCM_STREAM_PLAYBACK].substream) {
+		ret = xilinx_pcm_preallocate_dma_buffer(pcm,
+			SNDRV_PCM_STREAM_PLAYBACK);
+		if (ret)
+			return ret;
+	}
+
+	if (pcm->streams[SNDRV_PCM_STREAM_CAPTURE].substream) {
+		ret = xilinx_pcm_preallocate_dma_buffer(pcm,
+			SNDRV_PCM_STREAM_CAPTURE);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+static void xilinx_pcm_free(struct snd_pcm *pcm)
+{
+	struct snd_pcm_substream *substream;
+	struct snd_dma_buffer *buf;
+	int stream;
+
+	for (stream = 0; stream < 2; stream++) {
+		substream = pcm->streams[stream].substream;
+		if (!substream)
+			continue;
+
+		buf = &substream->dma_buffer;
+		if (!buf->area)
+			continue;
+
+		dma_free_writecombine(pcm->card->dev, buf->bytes,
+				      buf->area, buf->addr);
+		buf->area = NULL;
+	}
+}
+
+static struct snd_soc_platform_driver xilinx_soc_platform = {
+	.ops		= &xilinx_pcm_ops,
+	.pcm_new	= xilinx_pcm_new,
+	.pcm_free	= xilinx_pcm_free,
+};
+
+static int xilinx_pcm_probe(struct platform_device *pdev)
+{
+	struct xilinx_pcm_data *pcm_data;
+	u32 device_id = 0;
+
+	pcm_data = devm_kzalloc(&pdev->dev, sizeof(*pcm_data), GFP_KERNEL);
+	if (!pcm_data)
+		return -ENOMEM;
+
+	/* The id of the DMA engines serving the audio core */
+	of_property_read_u32(pdev->dev.of_node, "xlnx,device-id", &device_id);
+
+	pcm_data->match[SNDRV_PCM_STREAM_PLAYBACK] =
+		(DMA_MEM_TO_DEV & 0xFF) | XILINX_DMA_IP_DMA |
+		(device_id << XILINX_DMA_DEVICE_ID_SHIFT);
+	pcm_data->match[SNDRV_PCM_STREAM_CAPTURE] =
+		(DMA_DEV_TO_MEM & 0xFF) | XILINX_DMA_IP_DMA |
+		(device_id << XILINX_DMA_DEVICE_ID_SHIFT);
+
+	dev_set_drvdata(&pdev->dev, pcm_data);
+
+	return snd_soc_register_platform(&pdev->dev, &xilinx_soc_platform);
+}
+
+static int xilinx_pcm_remove(struct platform_device *pdev)
+{
+	snd_soc_unregister_platform(&pdev->dev);
+
+	return 0;
+}
+
+static const struct of_device_id xilinx_pcm_of_match[] = {
+	{ .compatible = "xlnx,pcm-audio-1.00.a", },
+	{},
+};
+MODULE_DEVICE_TABLE(of, xilinx_pcm_of_match);
+
+static struct platform_driver xilinx_pcm_driver = {
+	.probe = xilinx_pcm_probe,
+	.remove = xilinx_pcm_remove,
+	.driver = {
+		.name = "xilinx-pcm-audio",
+		.owner = THIS_MODULE,
+		.of_match_table = xilinx_pcm_of_match,
+	},
+};
+module_platform_driver(xilinx_pcm_driver);
+
+MODULE_AUTHOR("Xilinx Inc");
+MODULE_DESCRIPTION("Xilinx AXI DMA ASoC platform driver");
+MODULE_LICENSE("GPL");